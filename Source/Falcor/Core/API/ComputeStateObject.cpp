@@ -61,6 +61,7 @@ ComputeStateObject::ComputeStateObject(ref<Device> pDevice, const Desc& desc) :
             mDesc.mpD3D12RootSignatureOverride ? (void*)mDesc.mpD3D12RootSignatureOverride->getApiHandle().GetInterfacePtr() : nullptr;
     }
 #endif
+    auto slangLock = mDesc.mpProgram->getProgramVersion()->lockSlangSession();
     FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createComputePipelineState(computePipelineDesc, mGfxPipelineState.writeRef()));
 }
 
@@ -317,17 +317,22 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
 }
 
 std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+{
+    std::vector<uint8_t> result(getDataSize());
+    getData(result.data());
+    return result;
+}
+
+void CopyContext::ReadTextureTask::getData(void* pData)
 {
     mpFence->syncCpu();
     // Get buffer data
-    std::vector<uint8_t> result;
-    result.resize((size_t)mRowCount * mActualRowSize);
-    uint8_t* pData = reinterpret_cast<uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
+    const uint8_t* pSrcData = reinterpret_cast<const uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
 
     for (uint32_t z = 0; z < mDepth; z++)
     {
-        const uint8_t* pSrcZ = pData + z * (size_t)mRowSize * mRowCount;
-        uint8_t* pDstZ = result.data() + z * (size_t)mActualRowSize * mRowCount;
+        const uint8_t* pSrcZ = pSrcData + z * (size_t)mRowSize * mRowCount;
+        uint8_t* pDstZ = reinterpret_cast<uint8_t*>(pData) + z * (size_t)mActualRowSize * mRowCount;
         for (uint32_t y = 0; y < mRowCount; y++)
         {
             const uint8_t* pSrc = pSrcZ + y * (size_t)mRowSize;
@@ -337,7 +342,6 @@ std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
     }
 
     mpBuffer->unmap();
-    return result;
 }
 
 bool CopyContext::textureBarrier(const Texture* pTexture, Resource::State newState)
@@ -51,6 +51,15 @@ public:
         static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
         std::vector<uint8_t> getData();
 
+        /**
+         * Wait for the read to complete and copy the texture data into a caller-provided buffer.
+         * @param[in] pData Destination buffer of at least getDataSize() bytes.
+         */
+        void getData(void* pData);
+
+        /// Get the size of the texture data in bytes.
+        size_t getDataSize() const { return (size_t)mRowCount * mActualRowSize * mDepth; }
+
     private:
         ReadTextureTask() = default;
         ref<GpuFence> mpFence;
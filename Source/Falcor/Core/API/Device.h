@@ -104,6 +104,10 @@ public:
         /// The full path to the root directory for the shader cache. An empty string will disable the cache.
         std::string shaderCachePath = (getRuntimeDirectory() / ".shadercache").string();
 
+        /// The maximum total size in bytes of the persistent kernel cache stored in the "kernels" subdirectory of the shader cache.
+        /// A value of 0 indicates no limit.
+        uint64_t maxKernelCacheSize = 1024ull * 1024 * 1024;
+
 #if FALCOR_HAS_D3D12
         /// GUID list for experimental features
         std::vector<GUID> experimentalFeatures;
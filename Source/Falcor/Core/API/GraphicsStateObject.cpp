@@ -454,6 +454,7 @@ GraphicsStateObject::GraphicsStateObject(ref<Device> pDevice, const Desc& desc)
     gfxDesc.primitiveType = getGFXPrimitiveType(mDesc.getPrimitiveType());
     gfxDesc.program = mDesc.getProgramKernels()->getGfxProgram();
 
+    auto slangLock = mDesc.getProgramKernels()->getProgramVersion()->lockSlangSession();
     FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createGraphicsPipelineState(gfxDesc, mGfxPipelineState.writeRef()));
 }
 
@@ -264,9 +264,11 @@ ParameterBlock::~ParameterBlock() {}
 ParameterBlock::ParameterBlock(ref<Device> pDevice, const ref<const ProgramReflection>& pReflector)
     : mpDevice(pDevice.get()), mpProgramVersion(pReflector->getProgramVersion()), mpReflector(pReflector->getDefaultParameterBlock())
 {
-    FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createMutableRootShaderObject(
-        pReflector->getProgramVersion()->getKernels(mpDevice, nullptr)->getGfxProgram(), mpShaderObject.writeRef()
-    ));
+    auto pKernels = pReflector->getProgramVersion()->getKernels(mpDevice, nullptr);
+    {
+        auto slangLock = pKernels->getProgramVersion()->lockSlangSession();
+        FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createMutableRootShaderObject(pKernels->getGfxProgram(), mpShaderObject.writeRef()));
+    }
     initializeResourceBindings();
     createConstantBuffers(getRootVar());
 }
@@ -278,9 +280,14 @@ ParameterBlock::ParameterBlock(
 )
     : mpDevice(pDevice.get()), mpProgramVersion(pProgramVersion), mpReflector(pReflection)
 {
-    FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createMutableShaderObjectFromTypeLayout(
-        pReflection->getElementType()->getSlangTypeLayout(), mpShaderObject.writeRef()
-    ));
+    {
+        std::unique_lock<std::recursive_mutex> slangLock;
+        if (pProgramVersion)
+            slangLock = pProgramVersion->lockSlangSession();
+        FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createMutableShaderObjectFromTypeLayout(
+            pReflection->getElementType()->getSlangTypeLayout(), mpShaderObject.writeRef()
+        ));
+    }
     initializeResourceBindings();
     createConstantBuffers(getRootVar());
 }
@@ -75,7 +75,10 @@ RtStateObject::RtStateObject(ref<Device> pDevice, const Desc& desc) : mpDevice(p
     rtpDesc.maxAttributeSizeInBytes = rtProgram->getRtDesc().getMaxAttributeSize();
     rtpDesc.program = mDesc.pKernels->getGfxProgram();
 
-    FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createRayTracingPipelineState(rtpDesc, mGfxPipelineState.writeRef()));
+    {
+        auto slangLock = mDesc.pKernels->getProgramVersion()->lockSlangSession();
+        FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createRayTracingPipelineState(rtpDesc, mGfxPipelineState.writeRef()));
+    }
 
     // Get shader identifiers.
     // In GFX, a shader identifier is just the entry point group name.
@@ -37,6 +37,7 @@
 #include "Utils/Logger.h"
 #include "Utils/Threading.h"
 #include "Utils/Math/Common.h"
+#include "Utils/Image/AsyncImageWriter.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Core/Pass/FullScreenPass.h"
@@ -505,13 +506,19 @@ ref<ShaderResourceView> Texture::getSRV(uint32_t mostDetailedMip, uint32_t mipCo
     return findViewCommon<ShaderResourceView>(this, mostDetailedMip, mipCount, firstArraySlice, arraySize, mSrvs, createFunc);
 }
 
-void Texture::captureToFile(
+namespace
+{
+/**
+ * Read back a mip level of a 2D texture into a pooled buffer for saving to an image file.
+ * HDR textures with less than 3 channels are converted to RGBA32Float first.
+ */
+AsyncImageWriter::Image readImage(
+    Texture* pTexture,
     uint32_t mipLevel,
     uint32_t arraySlice,
     const std::filesystem::path& path,
     Bitmap::FileFormat format,
-    Bitmap::ExportFlags exportFlags,
-    bool async
+    Bitmap::ExportFlags exportFlags
 )
 {
     if (format == Bitmap::FileFormat::DdsFile)
@@ -519,37 +526,67 @@ void Texture::captureToFile(
         throw RuntimeError("Texture::captureToFile does not yet support saving to DDS.");
     }
 
-    if (mType != Type::Texture2D)
+    if (pTexture->getType() != Texture::Type::Texture2D)
         throw RuntimeError("Texture::captureToFile only supported for 2D textures.");
 
-    RenderContext* pContext = mpDevice->getRenderContext();
+    RenderContext* pContext = pTexture->getDevice()->getRenderContext();
+
+    AsyncImageWriter::Image image;
+    image.path = path;
+    image.width = pTexture->getWidth(mipLevel);
+    image.height = pTexture->getHeight(mipLevel);
+    image.fileFormat = format;
+    image.exportFlags = exportFlags;
+    image.resourceFormat = pTexture->getFormat();
 
     // Handle the special case where we have an HDR texture with less then 3 channels.
-    FormatType type = getFormatType(mFormat);
-    uint32_t channels = getFormatChannelCount(mFormat);
-    std::vector<uint8_t> textureData;
-    ResourceFormat resourceFormat = mFormat;
+    FormatType type = getFormatType(image.resourceFormat);
+    uint32_t channels = getFormatChannelCount(image.resourceFormat);
+    CopyContext::ReadTextureTask::SharedPtr pTask;
 
     if (type == FormatType::Float && channels < 3)
     {
         ref<Texture> pOther = Texture::create2D(
-            mpDevice, getWidth(mipLevel), getHeight(mipLevel), ResourceFormat::RGBA32Float, 1, 1, nullptr,
+            pTexture->getDevice(), image.width, image.height, ResourceFormat::RGBA32Float, 1, 1, nullptr,
             ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
         );
-        pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
-        textureData = pContext->readTextureSubresource(pOther.get(), 0);
-        resourceFormat = ResourceFormat::RGBA32Float;
+        pContext->blit(pTexture->getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
+        pTask = pContext->asyncReadTextureSubresource(pOther.get(), 0);
+        image.resourceFormat = ResourceFormat::RGBA32Float;
     }
     else
     {
-        uint32_t subresource = getSubresourceIndex(arraySlice, mipLevel);
-        textureData = pContext->readTextureSubresource(this, subresource);
+        uint32_t subresource = pTexture->getSubresourceIndex(arraySlice, mipLevel);
+        pTask = pContext->asyncReadTextureSubresource(pTexture, subresource);
     }
 
-    uint32_t width = getWidth(mipLevel);
-    uint32_t height = getHeight(mipLevel);
+    image.dataSize = pTask->getDataSize();
+    image.pData = BitmapBufferPool::get().acquire(image.dataSize);
+    pTask->getData(image.pData.get());
 
-    auto func = [=]() { Bitmap::saveImage(path, width, height, format, exportFlags, resourceFormat, true, (void*)textureData.data()); };
+    return image;
+}
+} // namespace
+
+void Texture::captureToFile(
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    const std::filesystem::path& path,
+    Bitmap::FileFormat format,
+    Bitmap::ExportFlags exportFlags,
+    bool async
+)
+{
+    // The image is shared so that the pixel data is moved into the task rather than copied.
+    auto pImage = std::make_shared<AsyncImageWriter::Image>(readImage(this, mipLevel, arraySlice, path, format, exportFlags));
+
+    auto func = [pImage]()
+    {
+        Bitmap::saveImage(
+            pImage->path, pImage->width, pImage->height, pImage->fileFormat, pImage->exportFlags, pImage->resourceFormat, true,
+            pImage->pData.get()
+        );
+    };
 
     if (async)
         Threading::dispatchTask(func);
@@ -557,6 +594,19 @@ void Texture::captureToFile(
         func();
 }
 
+void Texture::captureToFile(
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    const std::filesystem::path& path,
+    Bitmap::FileFormat format,
+    Bitmap::ExportFlags exportFlags,
+    AsyncImageWriter& writer,
+    std::function<void(const std::filesystem::path& path, uint64_t fileSize)> callback
+)
+{
+    writer.write(readImage(this, mipLevel, arraySlice, path, format, exportFlags), std::move(callback));
+}
+
 void Texture::uploadInitData(RenderContext* pRenderContext, const void* pData, bool autoGenMips)
 {
     if (autoGenMips)
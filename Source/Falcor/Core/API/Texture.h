@@ -34,12 +34,14 @@
 #include "Core/Macros.h"
 #include "Utils/Image/Bitmap.h"
 #include <filesystem>
+#include <functional>
 #include <fstd/span.h>
 
 namespace Falcor
 {
 class Sampler;
 class RenderContext;
+class AsyncImageWriter;
 
 /**
  * Abstracts the API texture objects
@@ -356,6 +358,27 @@ public:
         bool async = true
     );
 
+    /**
+     * Capture the texture to an image file using an asynchronous image writer.
+     * The texture is read back into a pooled buffer which is handed over to the writer. Blocks while the writer's queue is full.
+     * @param[in] mipLevel Requested mip-level
+     * @param[in] arraySlice Requested array-slice
+     * @param[in] path Path of the file to save.
+     * @param[in] fileFormat Destination image file format (e.g., PNG, PFM, etc.)
+     * @param[in] exportFlags Save flags, see Bitmap::ExportFlags
+     * @param[in] writer Image writer to use.
+     * @param[in] callback Function called from a writer thread after the image has been written.
+     */
+    void captureToFile(
+        uint32_t mipLevel,
+        uint32_t arraySlice,
+        const std::filesystem::path& path,
+        Bitmap::FileFormat format,
+        Bitmap::ExportFlags exportFlags,
+        AsyncImageWriter& writer,
+        std::function<void(const std::filesystem::path& path, uint64_t fileSize)> callback = {}
+    );
+
     /**
      * Generates mipmaps for a specified texture object.
      * @param[in] pContext Used render context.
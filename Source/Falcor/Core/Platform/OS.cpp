@@ -28,6 +28,7 @@
 #include "OS.h"
 #include "SearchDirectories.h"
 #include "Core/Errors.h"
+#include "Utils/FileDependencies.h"
 #include "Utils/StringUtils.h"
 #include "Utils/StringFormatters.h"
 #include <backward/backward.hpp> // TODO: Replace with C++20 <stacktrace> when available.
@@ -156,7 +157,24 @@ bool isSamePath(const std::filesystem::path& lhs, const std::filesystem::path& r
 
 bool findFileInDataDirectories(const std::filesystem::path& path, std::filesystem::path& fullPath)
 {
-    return findFileInDirectories(path, fullPath, getDataDirectoriesList());
+    const auto& directories = getDataDirectoriesList();
+    bool found = findFileInDirectories(path, fullPath, directories);
+
+    // Data files are inputs of the asset being loaded, report them to the active dependency recorder. The candidates that
+    // were searched before the file was found are reported as well, creating one of them changes the result of the lookup.
+    if (FileDependencyRecorder::isRecording())
+    {
+        for (const auto& dir : directories)
+        {
+            auto candidate = dir / path; // Equal to path if path is absolute.
+            if (found && std::filesystem::exists(candidate))
+                break;
+            FileDependencyRecorder::record(candidate);
+        }
+        if (found)
+            FileDependencyRecorder::record(fullPath);
+    }
+    return found;
 }
 
 bool findFileInDirectories(const std::filesystem::path& path, std::filesystem::path& fullPath, const SearchDirectories& directories)
@@ -155,6 +155,8 @@ FALCOR_API bool isSamePath(const std::filesystem::path& lhs, const std::filesyst
 
 /**
  * Finds a file in one of the data search directories.
+ * Found files are reported to the active file dependency recorder (see FileDependencyRecorder), together with the
+ * candidate paths that were searched before the file was found, or all candidates if the file was not found.
  * @param[in] path The file path to look for.
  * @param[in] fullPath If the file was found, the full path to the file. If the file wasn't found, this is invalid.
  * @return Returns true if the file was found, false otherwise.
@@ -192,6 +192,9 @@ Program::Program(ref<Device> pDevice, const Desc& desc, const DefineList& define
 
 Program::~Program()
 {
+    // Background compilation refers to the program, wait for it to finish first.
+    waitForPendingProgramVersions();
+
     mpDevice->getProgramManager()->unregisterProgramForReload(this);
 
     // Invalidate program versions.
@@ -379,6 +382,7 @@ bool Program::checkIfFilesChanged()
     }
 
     // Have any of the files we depend on changed?
+    std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
     for (auto& entry : mFileTimeMap)
     {
         auto& path = entry.first;
@@ -396,8 +400,12 @@ const ref<const ProgramVersion>& Program::getActiveVersion() const
 {
     if (mLinkRequired)
     {
-        const auto& it = mProgramVersions.find(ProgramVersionKey{mDefineList, mTypeConformanceList});
-        if (it == mProgramVersions.end())
+        ProgramVersionKey key{mDefineList, mTypeConformanceList};
+        if (auto pVersion = findProgramVersion(key))
+        {
+            mpActiveVersion = pVersion;
+        }
+        else
         {
             // Note that link() updates mActiveProgram only if the operation was successful.
             // On error we get false, and mActiveProgram points to the last successfully compiled version.
@@ -407,13 +415,10 @@ const ref<const ProgramVersion>& Program::getActiveVersion() const
             }
             else
             {
-                mProgramVersions[ProgramVersionKey{mDefineList, mTypeConformanceList}] = mpActiveVersion;
+                std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+                mProgramVersions[key] = mpActiveVersion;
             }
         }
-        else
-        {
-            mpActiveVersion = it->second;
-        }
         mLinkRequired = false;
     }
     FALCOR_ASSERT(mpActiveVersion);
@@ -449,8 +454,59 @@ bool Program::link() const
     }
 }
 
+ref<const ProgramVersion> Program::findProgramVersion(const ProgramVersionKey& key) const
+{
+    std::unique_lock<std::mutex> lock(mProgramVersionsMutex);
+    if (auto it = mProgramVersions.find(key); it != mProgramVersions.end())
+        return it->second;
+
+    auto it = mPendingProgramVersions.find(key);
+    if (it == mPendingProgramVersions.end())
+        return nullptr;
+
+    // Wait for the background compilation. The calling thread helps executing queued tasks while waiting.
+    PendingProgramVersion pending = it->second;
+    lock.unlock();
+    if (pending.task.isValid())
+        pending.task.finish();
+    return pending.future.get();
+}
+
+void Program::addProgramVersion(const ProgramVersionKey& key, const ref<const ProgramVersion>& pVersion, const string_time_map& fileTimeMap)
+    const
+{
+    std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+    mPendingProgramVersions.erase(key);
+    if (pVersion)
+    {
+        mProgramVersions[key] = pVersion;
+        mFileTimeMap.insert(fileTimeMap.begin(), fileTimeMap.end());
+    }
+}
+
+void Program::waitForPendingProgramVersions() const
+{
+    while (true)
+    {
+        PendingProgramVersion pending;
+        {
+            std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+            if (mPendingProgramVersions.empty())
+                break;
+            pending = mPendingProgramVersions.begin()->second;
+        }
+        if (pending.task.isValid())
+            pending.task.finish();
+        else
+            pending.future.wait();
+    }
+}
+
 void Program::reset()
 {
+    waitForPendingProgramVersions();
+
+    std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
     mpActiveVersion = nullptr;
     mProgramVersions.clear();
     mFileTimeMap.clear();
@@ -32,8 +32,11 @@
 #include "Core/Object.h"
 #include "Core/API/fwd.h"
 #include "Core/API/ShaderType.h"
+#include "Utils/Threading.h"
 #include <filesystem>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string_view>
 #include <string>
 #include <map>
@@ -485,6 +488,8 @@ protected:
     DefineList mDefineList;
     TypeConformanceList mTypeConformanceList;
 
+    using string_time_map = std::unordered_map<std::string, time_t>;
+
     struct ProgramVersionKey
     {
         DefineList defineList;
@@ -496,15 +501,35 @@ protected:
         }
     };
 
+    /// Program version that is being compiled in the background, see ProgramManager::compileProgramVersionsAsync().
+    struct PendingProgramVersion
+    {
+        Threading::Task task;
+        std::shared_future<ref<const ProgramVersion>> future;
+    };
+
     // We are doing lazy compilation, so these are mutable
     mutable bool mLinkRequired = true;
     mutable std::map<ProgramVersionKey, ref<const ProgramVersion>> mProgramVersions;
+    mutable std::map<ProgramVersionKey, PendingProgramVersion> mPendingProgramVersions;
+    mutable std::mutex mProgramVersionsMutex; ///< Protects the program versions and the file time map during background compilation.
     mutable ref<const ProgramVersion> mpActiveVersion;
     void markDirty() { mLinkRequired = true; }
 
+    /**
+     * Find a compiled program version. If the version is being compiled in the background, this waits for it to finish.
+     * @return The program version or nullptr if it has not been compiled or failed to compile.
+     */
+    ref<const ProgramVersion> findProgramVersion(const ProgramVersionKey& key) const;
+
+    /// Add a program version compiled in the background and the files it depends on.
+    void addProgramVersion(const ProgramVersionKey& key, const ref<const ProgramVersion>& pVersion, const string_time_map& fileTimeMap) const;
+
+    /// Wait for all program versions being compiled in the background to finish.
+    void waitForPendingProgramVersions() const;
+
     std::string getProgramDescString() const;
 
-    using string_time_map = std::unordered_map<std::string, time_t>;
     mutable string_time_map mFileTimeMap;
 
     bool checkIfFilesChanged();
@@ -0,0 +1,281 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ProgramKernelCache.h"
+#include "Core/Errors.h"
+#include "Core/Platform/LockFile.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+
+namespace
+{
+const uint32_t kMagic = 0x45434b46; // "FKCE"
+const uint32_t kVersion = 1;
+const char kEntryExtension[] = ".bin";
+const char kLockFileName[] = "kernels.lock";
+
+struct EntryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    SHA1::MD digest;
+};
+
+/// Returns the total size of all entries in the given directory.
+uint64_t computeDirectorySize(const std::filesystem::path& directory)
+{
+    uint64_t size = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        if (entry.path().extension() == kEntryExtension)
+        {
+            uint64_t fileSize = entry.file_size(ec);
+            if (!ec)
+                size += fileSize;
+        }
+    }
+    return size;
+}
+
+/// Returns a unique path for writing a temporary file in the given directory.
+std::filesystem::path getUniqueTempPath(const std::filesystem::path& directory)
+{
+    static std::mutex mutex;
+    static std::mt19937_64 rng{std::random_device{}()};
+    std::lock_guard<std::mutex> lock(mutex);
+    return directory / fmt::format("{:016x}.tmp", rng());
+}
+} // namespace
+
+ProgramKernelCache::ProgramKernelCache(const std::filesystem::path& directory, uint64_t maxSize)
+    : mDirectory(directory), mLockFilePath(directory / kLockFileName), mMaxSize(maxSize)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(mDirectory, ec);
+    if (!std::filesystem::is_directory(mDirectory))
+        throw RuntimeError("Failed to create kernel cache directory '{}'.", mDirectory);
+
+    LockFile lockFile(mLockFilePath);
+    if (lockFile.isOpen() && lockFile.lock(LockFile::LockType::Shared))
+        mSize = computeDirectorySize(mDirectory);
+}
+
+std::optional<std::vector<uint8_t>> ProgramKernelCache::get(const Key& key)
+{
+    auto countLookup = [this](bool hit)
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        (hit ? mStats.hitCount : mStats.missCount)++;
+    };
+
+    LockFile lockFile(mLockFilePath);
+    if (!lockFile.isOpen() || !lockFile.lock(LockFile::LockType::Shared))
+    {
+        countLookup(false);
+        return {};
+    }
+
+    const auto path = getEntryPath(key);
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        countLookup(false);
+        return {};
+    }
+
+    // Validate the entry. Truncated or corrupted entries are treated as misses and overwritten on the next write.
+    EntryHeader header;
+    std::vector<uint8_t> data;
+    bool valid = false;
+    if (stream.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == kMagic && header.version == kVersion)
+    {
+        data.resize(header.size);
+        if (stream.read(reinterpret_cast<char*>(data.data()), data.size()) && SHA1::compute(data.data(), data.size()) == header.digest)
+            valid = true;
+    }
+    stream.close();
+
+    if (!valid)
+    {
+        logWarning("Ignoring invalid kernel cache entry '{}'.", path);
+        countLookup(false);
+        return {};
+    }
+
+    // Mark the entry as recently used. Failing to do so only affects the eviction order.
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    countLookup(true);
+    return data;
+}
+
+void ProgramKernelCache::put(const Key& key, const void* data, size_t size)
+{
+    // Write the entry to a temporary file first, so other processes never see a partially written entry.
+    const auto tempPath = getUniqueTempPath(mDirectory);
+    {
+        EntryHeader header;
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.size = size;
+        header.digest = SHA1::compute(data, size);
+
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(data), size);
+        if (!stream)
+        {
+            logWarning("Failed to write kernel cache entry '{}'.", tempPath);
+            stream.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    LockFile lockFile(mLockFilePath);
+    if (!lockFile.isOpen() || !lockFile.lock(LockFile::LockType::Exclusive))
+    {
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    // Account for the entry being replaced, if any.
+    const auto path = getEntryPath(key);
+    std::error_code ec;
+    uint64_t replacedSize = std::filesystem::file_size(path, ec);
+    if (ec)
+        replacedSize = 0;
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        logWarning("Failed to store kernel cache entry '{}': {}", path, ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    // The replaced entry may have been written by another process and not be included in the tracked size yet.
+    mSize = std::max(mSize.load(), replacedSize) - replacedSize + sizeof(EntryHeader) + size;
+
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mStats.writeCount++;
+    }
+
+    if (mMaxSize > 0 && mSize > mMaxSize)
+        evict(mMaxSize);
+}
+
+void ProgramKernelCache::clear()
+{
+    LockFile lockFile(mLockFilePath);
+    if (!lockFile.isOpen() || !lockFile.lock(LockFile::LockType::Exclusive))
+        throw RuntimeError("Failed to lock kernel cache directory '{}'.", mDirectory);
+
+    evict(0);
+}
+
+ProgramKernelCache::Stats ProgramKernelCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mStats;
+}
+
+void ProgramKernelCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mStats = {};
+}
+
+std::filesystem::path ProgramKernelCache::getEntryPath(const Key& key) const
+{
+    return mDirectory / (SHA1::toString(key) + kEntryExtension);
+}
+
+void ProgramKernelCache::evict(uint64_t targetSize)
+{
+    // Note: The caller is responsible for holding the exclusive lock.
+    struct Entry
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+        uint64_t size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(mDirectory, ec))
+    {
+        if (entry.path().extension() != kEntryExtension)
+            continue;
+        uint64_t size = entry.file_size(ec);
+        if (ec)
+            continue;
+        entries.push_back({entry.path(), entry.last_write_time(ec), size});
+        totalSize += size;
+    }
+
+    if (totalSize <= targetSize)
+    {
+        mSize = totalSize;
+        return;
+    }
+
+    // Remove least recently used entries first.
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+
+    size_t evictionCount = 0;
+    for (const auto& entry : entries)
+    {
+        if (totalSize <= targetSize)
+            break;
+        if (std::filesystem::remove(entry.path, ec))
+        {
+            totalSize -= entry.size;
+            evictionCount++;
+        }
+    }
+    mSize = totalSize;
+
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mStats.evictionCount += evictionCount;
+}
+
+} // namespace Falcor
@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/CryptoUtils.h"
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+namespace Falcor
+{
+
+/**
+ * Persistent on-disk cache for compiled shader kernels.
+ *
+ * Entries are content addressed, i.e. the key is a hash over everything that affects the compiled code
+ * (source contents, defines, type conformances, compiler flags etc.). Each entry is stored as a separate file
+ * in the cache directory. Access is synchronized across processes using a lock file, so multiple processes
+ * can share the same cache directory. The total size of the cache is bounded, the least recently used entries
+ * are evicted when the limit is exceeded.
+ *
+ * The total size is computed when the cache is opened and then tracked incrementally, so storing an entry
+ * does not need to scan the cache directory. Entries written by other processes are accounted for when the
+ * directory is scanned again, which happens on eviction.
+ */
+class FALCOR_API ProgramKernelCache : public Object
+{
+    FALCOR_OBJECT(ProgramKernelCache)
+public:
+    using Key = SHA1::MD;
+
+    struct Stats
+    {
+        size_t hitCount = 0;      ///< Number of lookups that found a valid entry.
+        size_t missCount = 0;     ///< Number of lookups that did not find a valid entry.
+        size_t writeCount = 0;    ///< Number of entries written.
+        size_t evictionCount = 0; ///< Number of entries evicted.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] directory Cache directory. Created if it doesn't exist.
+     * @param[in] maxSize Maximum total size of the cache in bytes. A value of 0 indicates no limit.
+     */
+    ProgramKernelCache(const std::filesystem::path& directory, uint64_t maxSize);
+
+    /**
+     * Look up an entry.
+     * @param[in] key Key.
+     * @return Returns the cached data or an empty optional if the entry does not exist or is invalid.
+     */
+    std::optional<std::vector<uint8_t>> get(const Key& key);
+
+    /**
+     * Store an entry. Evicts least recently used entries if the cache exceeds its maximum size.
+     * @param[in] key Key.
+     * @param[in] data Data to store.
+     * @param[in] size Size of the data in bytes.
+     */
+    void put(const Key& key, const void* data, size_t size);
+
+    /// Remove all entries from the cache.
+    void clear();
+
+    /// Return the total size of all entries in bytes, as tracked by this instance.
+    uint64_t getSize() const { return mSize; }
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+    uint64_t getMaxSize() const { return mMaxSize; }
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    std::filesystem::path getEntryPath(const Key& key) const;
+    void evict(uint64_t targetSize);
+
+    std::filesystem::path mDirectory;
+    std::filesystem::path mLockFilePath;
+    uint64_t mMaxSize;
+    std::atomic<uint64_t> mSize{0}; ///< Total size of all entries in bytes. Only modified while holding the exclusive lock.
+
+    mutable std::mutex mStatsMutex;
+    Stats mStats;
+};
+
+} // namespace Falcor
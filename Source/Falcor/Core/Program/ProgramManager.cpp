@@ -29,10 +29,14 @@
 #include "Core/API/Device.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/CpuTimer.h"
 
 #include <slang.h>
 
+#include <algorithm>
+#include <atomic>
+
 namespace Falcor
 {
 
@@ -100,14 +104,55 @@ inline bool doSlangReflection(
     return true;
 }
 
-ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice) {}
+/// Version of the kernel cache keys. Increment to invalidate existing cache entries.
+const uint32_t kKernelCacheVersion = 1;
+
+/// Update a hash with a string. The string is terminated so that consecutive strings hash unambiguously.
+inline void updateHash(SHA1& sha1, std::string_view str)
+{
+    sha1.update(str);
+    sha1.update(uint8_t(0));
+}
+
+ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice)
+{
+    // Setup the persistent kernel cache next to the GFX shader cache.
+    const auto& desc = mpDevice->getDesc();
+    if (!desc.shaderCachePath.empty())
+    {
+        try
+        {
+            mpKernelCache = make_ref<ProgramKernelCache>(std::filesystem::path(desc.shaderCachePath) / "kernels", desc.maxKernelCacheSize);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("Persistent kernel cache is disabled: {}", e.what());
+        }
+    }
+}
 
 ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& program, std::string& log) const
+{
+    Program::string_time_map fileTimeMap;
+    auto pVersion = createProgramVersion(program, program.getDefineList(), program.mTypeConformanceList, fileTimeMap, log);
+
+    std::lock_guard<std::mutex> lock(program.mProgramVersionsMutex);
+    program.mFileTimeMap.insert(fileTimeMap.begin(), fileTimeMap.end());
+    return pVersion;
+}
+
+ref<const ProgramVersion> ProgramManager::createProgramVersion(
+    const Program& program,
+    const DefineList& defineList,
+    const Program::TypeConformanceList& typeConformances,
+    Program::string_time_map& fileTimeMap,
+    std::string& log
+) const
 {
     CpuTimer timer;
     timer.update();
 
-    auto pSlangRequest = createSlangCompileRequest(program);
+    auto pSlangRequest = createSlangCompileRequest(program, defineList);
     if (pSlangRequest == nullptr)
         return nullptr;
 
@@ -154,7 +199,7 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
     {
         std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
         if (std::filesystem::exists(depFilePath))
-            program.mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            fileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
     }
 
     // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -169,6 +214,7 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
     //
     // TODO @skallweit remove const cast
     ref<ProgramVersion> pVersion = ProgramVersion::createEmpty(const_cast<Program*>(&program), pSlangGlobalScope);
+    pVersion->mpSlangSessionMutex = getSlangGlobalSession().pMutex;
 
     // Note: Because of interactions between how `SV_Target` outputs
     // and `u` register bindings work in Slang today (as a compatibility
@@ -189,44 +235,18 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
         return nullptr;
     }
 
-    auto descStr = program.getProgramDescString();
-    pVersion->init(program.getDefineList(), pReflector, descStr, pSlangEntryPoints);
-
-    timer.update();
-    double time = timer.delta();
-    mCompilationStats.programVersionCount++;
-    mCompilationStats.programVersionTotalTime += time;
-    mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
-    logDebug("Created program version in {:.3f} s: {}", timer.delta(), descStr);
-
-    return pVersion;
-}
-
-ref<const ProgramKernels> ProgramManager::createProgramKernels(
-    const Program& program,
-    const ProgramVersion& programVersion,
-    const ProgramVars& programVars,
-    std::string& log
-) const
-{
-    CpuTimer timer;
-    timer.update();
-
-    auto pSlangGlobalScope = programVersion.getSlangGlobalScope();
-    auto pSlangSession = pSlangGlobalScope->getSession();
-
-    slang::IComponentType* pSpecializedSlangGlobalScope = pSlangGlobalScope;
-
     // Create a composite component type that represents all type conformances
     // linked into the `ProgramVersion`.
-    auto createTypeConformanceComponentList = [&](const Program::TypeConformanceList& typeConformances
+    // The type conformances are the ones of the permutation being compiled, not the current ones of the program,
+    // which may change while a permutation is compiled in the background.
+    auto createTypeConformanceComponentList = [&](const Program::TypeConformanceList& typeConformanceList
                                               ) -> std::optional<Slang::ComPtr<slang::IComponentType>>
     {
         Slang::ComPtr<slang::IComponentType> pTypeConformancesCompositeComponent;
         std::vector<Slang::ComPtr<slang::ITypeConformance>> typeConformanceComponentList;
         std::vector<slang::IComponentType*> typeConformanceComponentRawPtrList;
 
-        for (auto& typeConformance : typeConformances)
+        for (auto& typeConformance : typeConformanceList)
         {
             Slang::ComPtr<slang::IBlob> pSlangDiagnostics;
             Slang::ComPtr<slang::ITypeConformance> pTypeConformanceComponent;
@@ -288,14 +308,50 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
     typeConformancesCompositeComponents.reserve(program.getEntryPointGroupCount());
     for (const auto& group : program.mDesc.mGroups)
     {
-        Program::TypeConformanceList typeConformances = program.mTypeConformanceList;
-        typeConformances.add(group.typeConformances);
-        if (auto typeConformanceComponentList = createTypeConformanceComponentList(typeConformances))
+        Program::TypeConformanceList groupTypeConformances = typeConformances;
+        groupTypeConformances.add(group.typeConformances);
+        if (auto typeConformanceComponentList = createTypeConformanceComponentList(groupTypeConformances))
             typeConformancesCompositeComponents.emplace_back(*typeConformanceComponentList);
         else
             return nullptr;
     }
 
+    auto descStr = program.getProgramDescString();
+    pVersion->init(defineList, pReflector, descStr, pSlangEntryPoints);
+    pVersion->mpSlangTypeConformanceComponents = std::move(typeConformancesCompositeComponents);
+
+    // Hash the inputs of this compilation for the kernel cache keys, including the files Slang reported as dependencies.
+    if (mpKernelCache)
+        pVersion->mKernelCacheProgramHash = computeProgramHash(program, defineList, typeConformances, fileTimeMap);
+
+    timer.update();
+    double time = timer.delta();
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats.programVersionCount++;
+        mCompilationStats.programVersionTotalTime += time;
+        mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
+    }
+    logDebug("Created program version in {:.3f} s: {}", timer.delta(), descStr);
+
+    return pVersion;
+}
+
+ref<const ProgramKernels> ProgramManager::createProgramKernels(
+    const Program& program,
+    const ProgramVersion& programVersion,
+    const ProgramVars* pVars,
+    std::string& log
+) const
+{
+    CpuTimer timer;
+    timer.update();
+
+    auto pSlangGlobalScope = programVersion.getSlangGlobalScope();
+    auto pSlangSession = pSlangGlobalScope->getSession();
+
+    slang::IComponentType* pSpecializedSlangGlobalScope = pSlangGlobalScope;
+
     // Create a `IComponentType` for each entry point.
     uint32_t allEntryPointCount = uint32_t(program.mDesc.mEntryPoints.size());
 
@@ -308,14 +364,14 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
         auto pSlangEntryPoint = programVersion.getSlangEntryPoint(ee);
 
         int32_t groupIndex = program.mDesc.mEntryPoints[ee].groupIndex;
-        FALCOR_ASSERT(groupIndex >= 0 && groupIndex < typeConformancesCompositeComponents.size());
+        FALCOR_ASSERT(groupIndex >= 0 && groupIndex < programVersion.mpSlangTypeConformanceComponents.size());
 
         Slang::ComPtr<slang::IBlob> pSlangDiagnostics;
 
         Slang::ComPtr<slang::IComponentType> pTypeComformanceSpecializedEntryPoint;
-        if (typeConformancesCompositeComponents[groupIndex])
+        if (const auto& pTypeConformancesComposite = programVersion.mpSlangTypeConformanceComponents[groupIndex])
         {
-            slang::IComponentType* componentTypes[] = {pSlangEntryPoint, typeConformancesCompositeComponents[groupIndex]};
+            slang::IComponentType* componentTypes[] = {pSlangEntryPoint, pTypeConformancesComposite};
             auto res = pSlangSession->createCompositeComponentType(
                 componentTypes, 2, pTypeComformanceSpecializedEntryPoint.writeRef(), pSlangDiagnostics.writeRef()
             );
@@ -405,7 +461,7 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
 
         // Add type conformances for all entry point groups.
         // TODO: Is it correct to put all these in the global scope?
-        for (auto pTypeConformancesComposite : typeConformancesCompositeComponents)
+        for (const auto& pTypeConformancesComposite : programVersion.mpSlangTypeConformanceComponents)
         {
             if (pTypeConformancesComposite)
             {
@@ -426,6 +482,9 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
     ref<const ProgramReflection> pReflector;
     doSlangReflection(programVersion, pSpecializedSlangProgram, pLinkedEntryPoints, pReflector, log);
 
+    // The kernel code of each entry point is identified by the program hash of the version and the entry point description.
+    const ProgramKernelCache::Key& programHash = programVersion.mKernelCacheProgramHash;
+
     // Create kernel objects for each entry point and cache them here.
     std::vector<ref<EntryPointKernel>> allKernels;
     for (uint32_t i = 0; i < allEntryPointCount; i++)
@@ -433,7 +492,23 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
         auto pLinkedEntryPoint = pLinkedEntryPoints[i];
         auto entryPointDesc = program.mDesc.mEntryPoints[i];
 
-        ref<EntryPointKernel> kernel = EntryPointKernel::create(pLinkedEntryPoint, entryPointDesc.stage, entryPointDesc.exportName);
+        ProgramKernelCache::Key kernelCacheKey = {};
+        if (mpKernelCache)
+        {
+            SHA1 sha1;
+            sha1.update(programHash.data(), programHash.size());
+            updateHash(sha1, entryPointDesc.name);
+            updateHash(sha1, entryPointDesc.exportName);
+            sha1.update((uint32_t)entryPointDesc.stage);
+            sha1.update(entryPointDesc.sourceIndex);
+            sha1.update(entryPointDesc.groupIndex);
+            kernelCacheKey = sha1.finalize();
+        }
+
+        ref<EntryPointKernel> kernel = EntryPointKernel::create(
+            pLinkedEntryPoint, entryPointDesc.stage, entryPointDesc.exportName, mpKernelCache, kernelCacheKey,
+            programVersion.mpSlangSessionMutex
+        );
         if (!kernel)
             return nullptr;
 
@@ -476,9 +551,12 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
 
     timer.update();
     double time = timer.delta();
-    mCompilationStats.programKernelsCount++;
-    mCompilationStats.programKernelsTotalTime += time;
-    mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats.programKernelsCount++;
+        mCompilationStats.programKernelsTotalTime += time;
+        mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    }
     logDebug("Created program kernels in {:.3f} s: {}", time, descStr);
 
     return pProgramKernels;
@@ -524,13 +602,155 @@ ref<const EntryPointGroupKernels> ProgramManager::createEntryPointGroupKernels(
     return nullptr;
 }
 
+std::vector<ProgramManager::ProgramVersionFuture> ProgramManager::compileProgramVersionsAsync(
+    const std::vector<ProgramPermutation>& permutations
+)
+{
+    // Shared state of the batch used for measuring the wall-clock time of the whole batch.
+    // The pending count starts at one and is released after all tasks are dispatched, so that the batch
+    // is not considered finished while tasks are still being dispatched.
+    struct Batch
+    {
+        CpuTimer timer;
+        std::atomic<size_t> pendingCount{1};
+    };
+    auto pBatch = std::make_shared<Batch>();
+    pBatch->timer.update();
+
+    auto releaseBatch = [this](Batch& batch)
+    {
+        if (--batch.pendingCount == 0)
+        {
+            batch.timer.update();
+            std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+            mCompilationStats.asyncProgramVersionWallTime += batch.timer.delta();
+        }
+    };
+
+    std::vector<ProgramVersionFuture> futures;
+    futures.reserve(permutations.size());
+
+    for (const auto& permutation : permutations)
+    {
+        checkArgument(permutation.pProgram != nullptr, "'pProgram' is missing");
+        const Program* pProgram = permutation.pProgram.get();
+        Program::ProgramVersionKey key{permutation.defines, permutation.typeConformances};
+
+        // Skip permutations that are already compiled or being compiled.
+        auto pPromise = std::make_shared<std::promise<ref<const ProgramVersion>>>();
+        {
+            std::lock_guard<std::mutex> lock(pProgram->mProgramVersionsMutex);
+            if (auto it = pProgram->mProgramVersions.find(key); it != pProgram->mProgramVersions.end())
+            {
+                pPromise->set_value(it->second);
+                futures.push_back(pPromise->get_future().share());
+                continue;
+            }
+            if (auto it = pProgram->mPendingProgramVersions.find(key); it != pProgram->mPendingProgramVersions.end())
+            {
+                futures.push_back(it->second.future);
+                continue;
+            }
+
+            // Register the pending version before dispatching, as the task may execute immediately.
+            futures.push_back(pPromise->get_future().share());
+            pProgram->mPendingProgramVersions[key] = {Threading::Task(), futures.back()};
+        }
+
+        pBatch->pendingCount++;
+        auto task = Threading::dispatchTask(
+            [this, pProgram, key, pPromise, pBatch, releaseBatch]()
+            {
+                CpuTimer timer;
+                timer.update();
+
+                std::string log;
+                Program::string_time_map fileTimeMap;
+                ref<const ProgramVersion> pVersion;
+                try
+                {
+                    // All Slang objects of the version are created with the global session of this thread.
+                    // Hold its lock while compiling, so that the render thread can safely use versions compiled earlier.
+                    auto slangGlobalSession = getSlangGlobalSession();
+                    std::unique_lock<std::recursive_mutex> slangLock;
+                    if (slangGlobalSession.pMutex)
+                        slangLock = std::unique_lock<std::recursive_mutex>(*slangGlobalSession.pMutex);
+
+                    pVersion = createProgramVersion(*pProgram, key.defineList, key.typeConformanceList, fileTimeMap, log);
+
+                    // Link the kernels for programs without specialization arguments here as well. Creating the GFX program
+                    // generates their code. The kernels are added before the version is published, so
+                    // ProgramVersion::getKernels() finds them.
+                    if (pVersion)
+                    {
+                        if (auto pKernels = createProgramKernels(*pProgram, *pVersion, nullptr, log))
+                            pVersion->mpKernels[""] = pKernels;
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    log += e.what();
+                }
+
+                // Failed permutations are not added to the program. If the program switches to the permutation later,
+                // it is compiled again on the calling thread, which reports the error.
+                if (!pVersion)
+                    logWarning("Failed to compile program in the background:\n{}\n\n{}", pProgram->getProgramDescString(), log);
+                else if (!log.empty())
+                    logWarning("Warnings in program:\n{}\n{}", pProgram->getProgramDescString(), log);
+
+                pProgram->addProgramVersion(key, pVersion, fileTimeMap);
+
+                timer.update();
+                {
+                    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+                    mCompilationStats.asyncProgramVersionCount++;
+                    mCompilationStats.asyncProgramVersionSerialTime += timer.delta();
+                }
+                releaseBatch(*pBatch);
+
+                pPromise->set_value(pVersion);
+            }
+        );
+
+        std::lock_guard<std::mutex> lock(pProgram->mProgramVersionsMutex);
+        if (auto it = pProgram->mPendingProgramVersions.find(key); it != pProgram->mPendingProgramVersions.end())
+            it->second.task = task;
+    }
+
+    releaseBatch(*pBatch);
+
+    return futures;
+}
+
+std::vector<ProgramManager::ProgramVersionFuture> ProgramManager::warmUpLoadedPrograms()
+{
+    std::vector<ProgramPermutation> permutations;
+    {
+        std::lock_guard<std::mutex> lock(mLoadedProgramsMutex);
+        for (auto program : mLoadedPrograms)
+        {
+            // A program with no references is being destroyed and unregisters itself after its destructor has waited for
+            // pending compiles. Taking a reference here would resurrect it.
+            if (program->refCount() == 0)
+                continue;
+            permutations.push_back({ref<Program>(program), program->getDefineList(), program->mTypeConformanceList});
+        }
+    }
+
+    logInfo("Compiling {} programs in the background.", permutations.size());
+    return compileProgramVersionsAsync(permutations);
+}
+
 void ProgramManager::registerProgramForReload(Program* program)
 {
+    std::lock_guard<std::mutex> lock(mLoadedProgramsMutex);
     mLoadedPrograms.push_back(program);
 }
 
 void ProgramManager::unregisterProgramForReload(Program* program)
 {
+    std::lock_guard<std::mutex> lock(mLoadedProgramsMutex);
     mLoadedPrograms.erase(std::remove(mLoadedPrograms.begin(), mLoadedPrograms.end(), program), mLoadedPrograms.end());
 }
 
@@ -538,7 +758,13 @@ bool ProgramManager::reloadAllPrograms(bool forceReload)
 {
     bool hasReloaded = false;
 
-    for (auto program : mLoadedPrograms)
+    std::vector<Program*> loadedPrograms;
+    {
+        std::lock_guard<std::mutex> lock(mLoadedProgramsMutex);
+        loadedPrograms = mLoadedPrograms;
+    }
+
+    for (auto program : loadedPrograms)
     {
         if (program->checkIfFilesChanged() || forceReload)
         {
@@ -583,9 +809,137 @@ ProgramManager::ForcedCompilerFlags ProgramManager::getForcedCompilerFlags()
     return mForcedCompilerFlags;
 }
 
-SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program) const
+const ProgramManager::CompilationStats& ProgramManager::getCompilationStats()
+{
+    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+    if (mpKernelCache)
+    {
+        auto kernelCacheStats = mpKernelCache->getStats();
+        mCompilationStats.kernelCacheHitCount = kernelCacheStats.hitCount;
+        mCompilationStats.kernelCacheMissCount = kernelCacheStats.missCount;
+    }
+    return mCompilationStats;
+}
+
+void ProgramManager::resetCompilationStats()
+{
+    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+    mCompilationStats = {};
+    if (mpKernelCache)
+        mpKernelCache->resetStats();
+}
+
+ProgramKernelCache::Key ProgramManager::computeProgramHash(
+    const Program& program,
+    const DefineList& defineList,
+    const Program::TypeConformanceList& typeConformances,
+    const Program::string_time_map& fileTimeMap
+) const
 {
-    slang::IGlobalSession* pSlangGlobalSession = mpDevice->getSlangGlobalSession();
+    SHA1 sha1;
+    sha1.update(kKernelCacheVersion);
+    updateHash(sha1, spGetBuildTagString());
+    sha1.update((uint32_t)mpDevice->getType());
+    updateHash(sha1, program.mDesc.mShaderModel);
+
+    // Compiler flags including the forced flags.
+    Program::CompilerFlags compilerFlags = program.mDesc.getCompilerFlags();
+    compilerFlags &= ~mForcedCompilerFlags.disabled;
+    compilerFlags |= mForcedCompilerFlags.enabled;
+    sha1.update((uint32_t)compilerFlags);
+    sha1.update(mGenerateDebugInfo);
+    for (const auto& arg : program.mDesc.mCompilerArguments)
+        updateHash(sha1, arg);
+    updateHash(sha1, program.mDesc.mLanguagePrelude);
+
+    // Global followed by program specific defines.
+    sha1.update((uint64_t)mGlobalDefineList.size());
+    for (const auto& [name, value] : mGlobalDefineList)
+    {
+        updateHash(sha1, name);
+        updateHash(sha1, value);
+    }
+    sha1.update((uint64_t)defineList.size());
+    for (const auto& [name, value] : defineList)
+    {
+        updateHash(sha1, name);
+        updateHash(sha1, value);
+    }
+
+    // Global and per-group type conformances.
+    auto hashTypeConformances = [&](const Program::TypeConformanceList& typeConformanceList)
+    {
+        sha1.update((uint64_t)typeConformanceList.size());
+        for (const auto& [typeConformance, id] : typeConformanceList)
+        {
+            updateHash(sha1, typeConformance.mTypeName);
+            updateHash(sha1, typeConformance.mInterfaceName);
+            sha1.update(id);
+        }
+    };
+    hashTypeConformances(typeConformances);
+    for (const auto& group : program.mDesc.mGroups)
+    {
+        hashTypeConformances(group.typeConformances);
+        updateHash(sha1, group.nameSuffix);
+    }
+
+    // Source modules. String modules are hashed by their contents, file modules are covered by the dependencies below.
+    for (const auto& src : program.mDesc.mSources)
+    {
+        sha1.update((uint32_t)src.getType());
+        sha1.update(src.source.createTranslationUnit);
+        updateHash(sha1, src.source.filePath.string());
+        updateHash(sha1, src.source.str);
+        updateHash(sha1, src.source.moduleName);
+        updateHash(sha1, src.source.modulePath);
+    }
+
+    // Contents of all files this compilation depends on in a deterministic order.
+    std::vector<std::pair<std::string, time_t>> dependencies(fileTimeMap.begin(), fileTimeMap.end());
+    std::sort(dependencies.begin(), dependencies.end());
+    for (const auto& [path, modifiedTime] : dependencies)
+    {
+        updateHash(sha1, path);
+        auto fileHash = computeFileHash(path, modifiedTime);
+        sha1.update(fileHash.data(), fileHash.size());
+    }
+
+    return sha1.finalize();
+}
+
+SHA1::MD ProgramManager::computeFileHash(const std::filesystem::path& path, time_t modifiedTime) const
+{
+    std::lock_guard<std::mutex> lock(mFileHashesMutex);
+    auto it = mFileHashes.find(path.string());
+    if (it != mFileHashes.end() && it->second.first == modifiedTime)
+        return it->second.second;
+
+    std::string contents = readFile(path);
+    auto hash = SHA1::compute(contents.data(), contents.size());
+    mFileHashes[path.string()] = {modifiedTime, hash};
+    return hash;
+}
+
+ProgramManager::SlangGlobalSession ProgramManager::getSlangGlobalSession() const
+{
+    if (Threading::getCurrentThreadIndex() < 0)
+        return {mpDevice->getSlangGlobalSession(), nullptr};
+
+    struct ThreadSlangGlobalSession
+    {
+        Slang::ComPtr<slang::IGlobalSession> pGlobalSession;
+        std::shared_ptr<std::recursive_mutex> pMutex = std::make_shared<std::recursive_mutex>();
+    };
+    thread_local ThreadSlangGlobalSession threadSession;
+    if (!threadSession.pGlobalSession)
+        slang::createGlobalSession(threadSession.pGlobalSession.writeRef());
+    return {threadSession.pGlobalSession, threadSession.pMutex};
+}
+
+SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program, const DefineList& defineList) const
+{
+    slang::IGlobalSession* pSlangGlobalSession = getSlangGlobalSession().pGlobalSession;
     FALCOR_ASSERT(pSlangGlobalSession);
 
     slang::SessionDesc sessionDesc;
@@ -666,7 +1020,7 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     // Add global followed by program specific defines.
     for (const auto& shaderDefine : mGlobalDefineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
-    for (const auto& shaderDefine : program.getDefineList())
+    for (const auto& shaderDefine : defineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
 
     // Add a `#define`s based on the target and shader model.
@@ -692,8 +1046,6 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     pSlangGlobalSession->createSession(sessionDesc, pSlangSession.writeRef());
     FALCOR_ASSERT(pSlangSession);
 
-    program.mFileTimeMap.clear(); // TODO @skallweit
-
     if (!program.mDesc.mLanguagePrelude.empty())
     {
         if (targetDesc.format == SLANG_DXIL)
@@ -27,10 +27,16 @@
  **************************************************************************/
 #pragma once
 #include "Program.h"
+#include "ProgramKernelCache.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 
+#include <algorithm>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace Falcor
 {
@@ -58,8 +64,28 @@ public:
         double programKernelsMaxTime = 0.0;
         double programVersionTotalTime = 0.0;
         double programKernelsTotalTime = 0.0;
+        size_t kernelCacheHitCount = 0;  ///< Number of kernels loaded from the persistent kernel cache.
+        size_t kernelCacheMissCount = 0; ///< Number of kernels not found in the persistent kernel cache.
+        size_t asyncProgramVersionCount = 0;   ///< Number of program versions compiled in the background.
+        double asyncProgramVersionSerialTime = 0.0; ///< Sum of the compile times of all background compilations.
+        double asyncProgramVersionWallTime = 0.0;   ///< Wall-clock time spent on background compilation batches.
+
+        /// Compile time saved by background compilation compared to compiling the same program versions serially.
+        double getAsyncTimeSaved() const { return std::max(0.0, asyncProgramVersionSerialTime - asyncProgramVersionWallTime); }
     };
 
+    /**
+     * A program permutation to compile in the background.
+     */
+    struct ProgramPermutation
+    {
+        ref<Program> pProgram;                         ///< Program to compile the permutation for.
+        DefineList defines;                            ///< Full list of macro definitions, as set by Program::setDefines().
+        Program::TypeConformanceList typeConformances; ///< Full list of type conformances, as set by Program::setTypeConformances().
+    };
+
+    using ProgramVersionFuture = std::shared_future<ref<const ProgramVersion>>;
+
     Program::Desc applyForcedCompilerFlags(Program::Desc desc) const;
     void registerProgramForReload(Program* program);
     void unregisterProgramForReload(Program* program);
@@ -69,10 +95,29 @@ public:
     ref<const ProgramKernels> createProgramKernels(
         const Program& program,
         const ProgramVersion& programVersion,
-        const ProgramVars& programVars,
+        const ProgramVars* pVars,
         std::string& log
     ) const;
 
+    /**
+     * Compile program permutations concurrently on the thread pool.
+     * Besides the program versions, this links their kernels and generates the kernel code on the worker threads.
+     * The compiled program versions are added to their programs, so switching a program to one of the permutations
+     * does not trigger a compilation. If a program switches to a permutation that is still being compiled, it waits for
+     * the background compilation to finish. Permutations that are already compiled or being compiled are not compiled again.
+     * The programs need to be kept alive by the caller, and global compiler settings must not be changed while compiling.
+     * @param[in] permutations List of permutations.
+     * @return Futures for the program versions, in the same order as the permutations. A future holds nullptr if compilation failed.
+     */
+    std::vector<ProgramVersionFuture> compileProgramVersionsAsync(const std::vector<ProgramPermutation>& permutations);
+
+    /**
+     * Compile the current permutation of all loaded programs that have not been compiled yet concurrently on the thread pool.
+     * This is useful for warming up all programs used by a render graph before rendering the first frame.
+     * @return Futures for the program versions.
+     */
+    std::vector<ProgramVersionFuture> warmUpLoadedPrograms();
+
     ref<const EntryPointGroupKernels> createEntryPointGroupKernels(
         const std::vector<ref<EntryPointKernel>>& kernels,
         const ref<EntryPointBaseReflection>& pReflector
@@ -123,16 +168,68 @@ public:
      */
     ForcedCompilerFlags getForcedCompilerFlags();
 
-    const CompilationStats& getCompilationStats() { return mCompilationStats; }
-    void resetCompilationStats() { mCompilationStats = {}; }
+    const CompilationStats& getCompilationStats();
+    void resetCompilationStats();
+
+    /**
+     * Get the persistent kernel cache.
+     * @return Returns the kernel cache or nullptr if the cache is disabled.
+     */
+    ProgramKernelCache* getKernelCache() const { return mpKernelCache.get(); }
 
 private:
-    SlangCompileRequest* createSlangCompileRequest(const Program& program) const;
+    ref<const ProgramVersion> createProgramVersion(
+        const Program& program,
+        const DefineList& defineList,
+        const Program::TypeConformanceList& typeConformances,
+        Program::string_time_map& fileTimeMap,
+        std::string& log
+    ) const;
+
+    SlangCompileRequest* createSlangCompileRequest(const Program& program, const DefineList& defineList) const;
+
+    struct SlangGlobalSession
+    {
+        slang::IGlobalSession* pGlobalSession = nullptr;
+        /// Serializes access to the global session. Not set for the device's global session, which is only used by the render thread.
+        std::shared_ptr<std::recursive_mutex> pMutex;
+    };
+
+    /**
+     * Get the Slang global session to use on the calling thread.
+     * Slang global sessions are not thread safe, so worker threads of the thread pool use their own global session.
+     * Program versions compiled with it keep its mutex, so that the render thread can serialize its accesses with the worker.
+     */
+    SlangGlobalSession getSlangGlobalSession() const;
+
+    /**
+     * Compute the hash over everything that affects the compiled code of a program version, excluding the entry points.
+     * @param[in] program Program.
+     * @param[in] defineList Defines of the program version.
+     * @param[in] typeConformances Type conformances of the program version.
+     * @param[in] fileTimeMap Files the compilation of the program version depends on, as reported by Slang.
+     * @return The hash.
+     */
+    ProgramKernelCache::Key computeProgramHash(
+        const Program& program,
+        const DefineList& defineList,
+        const Program::TypeConformanceList& typeConformances,
+        const Program::string_time_map& fileTimeMap
+    ) const;
+
+    /// Compute the hash of the contents of a source file. The hash is memoized using the file modification time.
+    SHA1::MD computeFileHash(const std::filesystem::path& path, time_t modifiedTime) const;
 
     Device* mpDevice;
 
     std::vector<Program*> mLoadedPrograms;
+    std::mutex mLoadedProgramsMutex;
     mutable CompilationStats mCompilationStats;
+    mutable std::mutex mCompilationStatsMutex;
+
+    ref<ProgramKernelCache> mpKernelCache;
+    mutable std::map<std::string, std::pair<time_t, SHA1::MD>> mFileHashes;
+    mutable std::mutex mFileHashesMutex;
 
     DefineList mGlobalDefineList;
     bool mGenerateDebugInfo = false;
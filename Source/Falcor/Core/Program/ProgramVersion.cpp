@@ -40,6 +40,48 @@
 namespace Falcor
 {
 
+//
+// EntryPointKernel
+//
+
+EntryPointKernel::BlobData EntryPointKernel::getBlobData() const
+{
+    if (!mpBlob && !mCachedCode)
+    {
+        if (mpKernelCache)
+            mCachedCode = mpKernelCache->get(mKernelCacheKey);
+
+        if (!mCachedCode)
+        {
+            std::unique_lock<std::recursive_mutex> slangLock;
+            if (mpSlangSessionMutex)
+                slangLock = std::unique_lock<std::recursive_mutex>(*mpSlangSessionMutex);
+
+            Slang::ComPtr<ISlangBlob> pDiagnostics;
+            if (SLANG_FAILED(mLinkedSlangEntryPoint->getEntryPointCode(0, 0, mpBlob.writeRef(), pDiagnostics.writeRef())))
+            {
+                throw RuntimeError(std::string("Shader compilation failed. \n") + (const char*)pDiagnostics->getBufferPointer());
+            }
+
+            if (mpKernelCache)
+                mpKernelCache->put(mKernelCacheKey, mpBlob->getBufferPointer(), mpBlob->getBufferSize());
+        }
+    }
+
+    BlobData result;
+    if (mCachedCode)
+    {
+        result.data = mCachedCode->data();
+        result.size = mCachedCode->size();
+    }
+    else
+    {
+        result.data = mpBlob->getBufferPointer();
+        result.size = mpBlob->getBufferSize();
+    }
+    return result;
+}
+
 //
 // EntryPointGroupKernels
 //
@@ -225,7 +267,11 @@ ref<const ProgramKernels> ProgramVersion::getKernels(Device* pDevice, ProgramVar
     for (;;)
     {
         std::string log;
-        auto pKernels = pDevice->getProgramManager()->createProgramKernels(*mpProgram, *this, *pVars, log);
+        ref<const ProgramKernels> pKernels;
+        {
+            auto slangLock = lockSlangSession();
+            pKernels = pDevice->getProgramManager()->createProgramKernels(*mpProgram, *this, pVars, log);
+        }
         if (pKernels)
         {
             // Success
@@ -251,6 +297,13 @@ ref<const ProgramKernels> ProgramVersion::getKernels(Device* pDevice, ProgramVar
     }
 }
 
+std::unique_lock<std::recursive_mutex> ProgramVersion::lockSlangSession() const
+{
+    if (!mpSlangSessionMutex)
+        return {};
+    return std::unique_lock<std::recursive_mutex>(*mpSlangSessionMutex);
+}
+
 slang::ISession* ProgramVersion::getSlangSession() const
 {
     return getSlangGlobalScope()->getSession();
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "ProgramReflection.h"
+#include "ProgramKernelCache.h"
 #include "DefineList.h"
 #include "Core/Macros.h"
 #include "Core/Object.h"
@@ -34,6 +35,8 @@
 #include "Core/API/ShaderType.h"
 #include "Core/API/Handles.h"
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -73,15 +76,23 @@ public:
      * Create a shader object
      * @param[in] linkedSlangEntryPoint The Slang IComponentType that defines the shader entry point.
      * @param[in] type The Type of the shader
+     * @param[in] pKernelCache Optional persistent kernel cache used for storing/retrieving the kernel code.
+     * @param[in] kernelCacheKey Key of the kernel in the kernel cache.
+     * @param[in] pSlangSessionMutex Optional mutex serializing access to the Slang global session of the entry point.
      * @return If success, a new shader object, otherwise nullptr
      */
     static ref<EntryPointKernel> create(
         Slang::ComPtr<slang::IComponentType> linkedSlangEntryPoint,
         ShaderType type,
-        const std::string& entryPointName
+        const std::string& entryPointName,
+        ref<ProgramKernelCache> pKernelCache = nullptr,
+        const ProgramKernelCache::Key& kernelCacheKey = {},
+        std::shared_ptr<std::recursive_mutex> pSlangSessionMutex = nullptr
     )
     {
-        return ref<EntryPointKernel>(new EntryPointKernel(linkedSlangEntryPoint, type, entryPointName));
+        return ref<EntryPointKernel>(
+            new EntryPointKernel(linkedSlangEntryPoint, type, entryPointName, pKernelCache, kernelCacheKey, std::move(pSlangSessionMutex))
+        );
     }
 
     /**
@@ -94,32 +105,37 @@ public:
      */
     const std::string& getEntryPointName() const { return mEntryPointName; }
 
-    BlobData getBlobData() const
-    {
-        if (!mpBlob)
-        {
-            Slang::ComPtr<ISlangBlob> pDiagnostics;
-            if (SLANG_FAILED(mLinkedSlangEntryPoint->getEntryPointCode(0, 0, mpBlob.writeRef(), pDiagnostics.writeRef())))
-            {
-                throw RuntimeError(std::string("Shader compilation failed. \n") + (const char*)pDiagnostics->getBufferPointer());
-            }
-        }
-
-        BlobData result;
-        result.data = mpBlob->getBufferPointer();
-        result.size = mpBlob->getBufferSize();
-        return result;
-    }
+    /**
+     * Get the compiled kernel code.
+     * If a kernel cache is used, the code is loaded from the cache if available, otherwise it is compiled and stored in the cache.
+     */
+    BlobData getBlobData() const;
 
 protected:
-    EntryPointKernel(Slang::ComPtr<slang::IComponentType> linkedSlangEntryPoint, ShaderType type, const std::string& entryPointName)
-        : mLinkedSlangEntryPoint(linkedSlangEntryPoint), mType(type), mEntryPointName(entryPointName)
+    EntryPointKernel(
+        Slang::ComPtr<slang::IComponentType> linkedSlangEntryPoint,
+        ShaderType type,
+        const std::string& entryPointName,
+        ref<ProgramKernelCache> pKernelCache,
+        const ProgramKernelCache::Key& kernelCacheKey,
+        std::shared_ptr<std::recursive_mutex> pSlangSessionMutex
+    )
+        : mLinkedSlangEntryPoint(linkedSlangEntryPoint)
+        , mType(type)
+        , mEntryPointName(entryPointName)
+        , mpKernelCache(pKernelCache)
+        , mKernelCacheKey(kernelCacheKey)
+        , mpSlangSessionMutex(std::move(pSlangSessionMutex))
     {}
 
     Slang::ComPtr<slang::IComponentType> mLinkedSlangEntryPoint;
     ShaderType mType;
     std::string mEntryPointName;
+    ref<ProgramKernelCache> mpKernelCache;
+    ProgramKernelCache::Key mKernelCacheKey;
+    std::shared_ptr<std::recursive_mutex> mpSlangSessionMutex;
     mutable Slang::ComPtr<ISlangBlob> mpBlob;
+    mutable std::optional<std::vector<uint8_t>> mCachedCode;
 };
 
 /**
@@ -150,6 +166,7 @@ public:
 
     Type getType() const { return mType; }
     const EntryPointKernel* getKernel(ShaderType type) const;
+    size_t getKernelCount() const { return mKernels.size(); }
     const EntryPointKernel* getKernelByIndex(size_t index) const { return mKernels[index].get(); }
     const std::string& getExportName() const { return mExportName; }
 
@@ -280,6 +297,14 @@ public:
     slang::IComponentType* getSlangGlobalScope() const;
     slang::IComponentType* getSlangEntryPoint(uint32_t index) const;
 
+    /**
+     * Lock the Slang global session this version was compiled with.
+     * Program versions compiled in the background use a global session of the compiling worker thread, which is not thread safe.
+     * Calls into Slang (including through GFX) that use the Slang objects of this version need to hold the lock.
+     * @return Lock of the global session, or an empty lock if the version was compiled with the device's global session.
+     */
+    std::unique_lock<std::recursive_mutex> lockSlangSession() const;
+
 protected:
     friend class Program;
     friend class RtProgram;
@@ -302,6 +327,11 @@ protected:
     std::string mName;
     Slang::ComPtr<slang::IComponentType> mpSlangGlobalScope;
     std::vector<Slang::ComPtr<slang::IComponentType>> mpSlangEntryPoints;
+    std::shared_ptr<std::recursive_mutex> mpSlangSessionMutex; ///< Mutex of the Slang global session, only set for versions compiled on worker threads.
+    /// Composite of the type conformances of each entry point group, or nullptr for groups without type conformances.
+    std::vector<Slang::ComPtr<slang::IComponentType>> mpSlangTypeConformanceComponents;
+    /// Hash of the inputs of the compilation, used for the kernel cache keys. Only set if the kernel cache is enabled.
+    ProgramKernelCache::Key mKernelCacheProgramHash = {};
 
     // Cached version of compiled kernels for this program version
     mutable std::unordered_map<std::string, ref<const ProgramKernels>> mpKernels;
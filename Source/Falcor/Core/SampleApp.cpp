@@ -37,6 +37,7 @@
 #include "Utils/Scripting/Console.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/Timing/TraceRecorder.h"
 #include "Utils/UI/TextRenderer.h"
 #include "Utils/Settings.h"
 #include "Utils/StringUtils.h"
@@ -53,6 +54,7 @@ SampleApp::SampleApp(const SampleAppConfig& config)
 
     OSServices::start();
     Threading::start();
+    TraceRecorder::setThreadName("Main");
 
     mShowUI = config.showUI;
     mVsyncOn = config.windowDesc.enableVSync;
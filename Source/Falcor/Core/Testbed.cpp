@@ -32,6 +32,7 @@
 #include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Timing/ProfilerUI.h"
+#include "Utils/Timing/TraceRecorder.h"
 #include "Utils/UI/Gui.h"
 #include "Utils/UI/InputTypes.h"
 #include "RenderGraph/RenderPassStandardFlags.h"
@@ -264,6 +265,7 @@ void Testbed::internalInit(const Options& options)
 {
     OSServices::start();
     Threading::start();
+    TraceRecorder::setThreadName("Main");
 
     // Populate the data search paths from the config file, only adding those that aren't in already
     auto searchDirectories = Settings::getGlobalSettings().getSearchDirectories("media");
@@ -651,6 +651,20 @@ bool canFieldsConnect(const RenderPassReflection::Field& src, const RenderPassRe
            src.getType() == dst.getType() && src.getSampleCount() == dst.getSampleCount();
 }
 
+void RenderGraph::setResourceAliasingEnabled(bool enabled)
+{
+    if (mCompilerDeps.enableResourceAliasing != enabled)
+    {
+        mCompilerDeps.enableResourceAliasing = enabled;
+        mRecompile = true;
+    }
+}
+
+ResourceCache::MemoryReport RenderGraph::getMemoryReport() const
+{
+    return mpExe ? mpExe->getMemoryReport() : ResourceCache::MemoryReport();
+}
+
 void RenderGraph::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget)
 {
     if (mpExe)
@@ -705,6 +719,21 @@ FALCOR_SCRIPT_BINDING(RenderGraph)
     // RenderGraph
     pybind11::class_<RenderGraph, ref<RenderGraph>> renderGraph(m, "RenderGraph");
     renderGraph.def_property("name", &RenderGraph::getName, &RenderGraph::setName);
+    renderGraph.def_property("resource_aliasing", &RenderGraph::isResourceAliasingEnabled, &RenderGraph::setResourceAliasingEnabled);
+    renderGraph.def_property_readonly(
+        "memory_report",
+        [](const RenderGraph& graph)
+        {
+            auto report = graph.getMemoryReport();
+            pybind11::dict d;
+            d["field_count"] = report.fieldCount;
+            d["resource_count"] = report.resourceCount;
+            d["naive_size"] = report.naiveSize;
+            d["allocated_size"] = report.allocatedSize;
+            d["peak_live_size"] = report.peakLiveSize;
+            return d;
+        }
+    );
 
     renderGraph.def(
         "create_pass",
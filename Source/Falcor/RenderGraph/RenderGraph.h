@@ -250,6 +250,23 @@ public:
      */
     std::vector<std::string> getUnmarkedOutputs() const;
 
+    /**
+     * Enable/disable resource aliasing. If enabled, transient resources with disjoint lifetimes in the execution order share memory.
+     * Changing this triggers a recompilation of the graph.
+     */
+    void setResourceAliasingEnabled(bool enabled);
+
+    /**
+     * Check if resource aliasing is enabled.
+     */
+    bool isResourceAliasingEnabled() const { return mCompilerDeps.enableResourceAliasing; }
+
+    /**
+     * Get memory statistics of the resources allocated for the graph.
+     * Returns an empty report if the graph is not compiled.
+     */
+    ResourceCache::MemoryReport getMemoryReport() const;
+
     /**
      * Render the graph UI.
      */
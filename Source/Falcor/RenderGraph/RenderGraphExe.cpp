@@ -108,4 +108,10 @@ void RenderGraphExe::setInput(const std::string& name, const ref<Resource>& pRes
 {
     mpResourceCache->registerExternalResource(name, pResource);
 }
+
+const ResourceCache::MemoryReport& RenderGraphExe::getMemoryReport() const
+{
+    FALCOR_ASSERT(mpResourceCache);
+    return mpResourceCache->getMemoryReport();
+}
 } // namespace Falcor
@@ -94,6 +94,11 @@ public:
      */
     void setInput(const std::string& name, const ref<Resource>& pResource);
 
+    /**
+     * Get memory statistics of the resources allocated for the graph.
+     */
+    const ResourceCache::MemoryReport& getMemoryReport() const;
+
 private:
     friend class RenderGraphCompiler;
 
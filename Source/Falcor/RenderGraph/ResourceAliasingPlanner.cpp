@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ResourceAliasingPlanner.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace Falcor
+{
+ResourceAliasingPlanner::Plan ResourceAliasingPlanner::plan(const std::vector<Request>& requests)
+{
+    for (const auto& request : requests)
+        checkArgument(request.firstUse <= request.lastUse, "Invalid request lifetime [{}, {}].", request.firstUse, request.lastUse);
+
+    Plan plan;
+    plan.resourceIndices.resize(requests.size());
+
+    // Process requests in order of first use. Larger requests go first so that they seed the physical resources.
+    std::vector<uint32_t> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&](uint32_t a, uint32_t b)
+        {
+            if (requests[a].firstUse != requests[b].firstUse)
+                return requests[a].firstUse < requests[b].firstUse;
+            return requests[a].size > requests[b].size;
+        }
+    );
+
+    // Physical resources available for aliasing per compatibility class, with the last time point they are in use.
+    struct Slot
+    {
+        uint32_t resourceIndex;
+        uint32_t lastUse;
+    };
+    std::unordered_map<uint32_t, std::vector<Slot>> slotsPerClass;
+
+    for (uint32_t requestIndex : order)
+    {
+        const auto& request = requests[requestIndex];
+        plan.naiveSize += request.size;
+
+        Slot* pBestSlot = nullptr;
+        if (request.aliasable)
+        {
+            // Pick a free slot, preferring the smallest one that fits the request and otherwise the largest one.
+            auto isBetter = [&](uint64_t size, uint64_t bestSize)
+            {
+                bool fits = size >= request.size;
+                bool bestFits = bestSize >= request.size;
+                if (fits != bestFits)
+                    return fits;
+                return fits ? size < bestSize : size > bestSize;
+            };
+
+            auto& slots = slotsPerClass[request.compatibilityClass];
+            for (auto& slot : slots)
+            {
+                if (slot.lastUse >= request.firstUse)
+                    continue;
+                if (!pBestSlot || isBetter(plan.resourceSizes[slot.resourceIndex], plan.resourceSizes[pBestSlot->resourceIndex]))
+                    pBestSlot = &slot;
+            }
+
+            if (!pBestSlot)
+            {
+                slots.push_back({plan.getResourceCount(), request.lastUse});
+                plan.resourceSizes.push_back(0);
+                pBestSlot = &slots.back();
+            }
+            pBestSlot->lastUse = request.lastUse;
+        }
+
+        uint32_t resourceIndex = pBestSlot ? pBestSlot->resourceIndex : plan.getResourceCount();
+        if (resourceIndex == plan.getResourceCount())
+            plan.resourceSizes.push_back(0);
+        plan.resourceSizes[resourceIndex] = std::max(plan.resourceSizes[resourceIndex], request.size);
+        plan.resourceIndices[requestIndex] = resourceIndex;
+    }
+
+    plan.plannedSize = std::accumulate(plan.resourceSizes.begin(), plan.resourceSizes.end(), uint64_t(0));
+    plan.peakLiveSize = computePeakLiveSize(requests);
+    return plan;
+}
+
+uint64_t ResourceAliasingPlanner::computePeakLiveSize(const std::vector<Request>& requests)
+{
+    // Sweep over the lifetime end points. A request stops being live at lastUse + 1.
+    struct Event
+    {
+        uint64_t time;
+        int64_t delta;
+    };
+    std::vector<Event> events;
+    events.reserve(requests.size() * 2);
+    for (const auto& request : requests)
+    {
+        events.push_back({request.firstUse, int64_t(request.size)});
+        events.push_back({uint64_t(request.lastUse) + 1, -int64_t(request.size)});
+    }
+
+    // Process removals before additions at the same time point.
+    std::sort(
+        events.begin(), events.end(), [](const Event& a, const Event& b) { return a.time != b.time ? a.time < b.time : a.delta < b.delta; }
+    );
+
+    int64_t liveSize = 0;
+    int64_t peakLiveSize = 0;
+    for (const auto& event : events)
+    {
+        liveSize += event.delta;
+        peakLiveSize = std::max(peakLiveSize, liveSize);
+    }
+    return uint64_t(peakLiveSize);
+}
+} // namespace Falcor
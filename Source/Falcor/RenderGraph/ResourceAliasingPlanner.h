@@ -0,0 +1,83 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Plans which render graph resources can share memory.
+ *
+ * Each request describes a resource by its lifetime in the compiled execution order, its size and a compatibility class.
+ * Requests with disjoint lifetimes and matching compatibility classes are assigned to the same physical resource.
+ * The lifetimes form an interval graph, which is colored greedily in order of first use. This uses the minimal number
+ * of physical resources per compatibility class.
+ *
+ * The planner is a pure CPU component and does not create any resources.
+ */
+class FALCOR_API ResourceAliasingPlanner
+{
+public:
+    struct Request
+    {
+        uint32_t firstUse = 0;           ///< First time point (index into the execution order) at which the resource is used.
+        uint32_t lastUse = 0;            ///< Last time point at which the resource is used (inclusive).
+        uint64_t size = 0;               ///< Size in bytes.
+        uint32_t compatibilityClass = 0; ///< Requests can only share a physical resource if their classes match.
+        bool aliasable = true;           ///< If false, the request always gets a dedicated physical resource.
+    };
+
+    struct Plan
+    {
+        std::vector<uint32_t> resourceIndices; ///< Physical resource index for each request.
+        std::vector<uint64_t> resourceSizes;   ///< Size of each physical resource in bytes (maximum over its requests).
+        uint64_t naiveSize = 0;                ///< Total size in bytes when allocating one resource per request.
+        uint64_t plannedSize = 0;              ///< Total size in bytes of the planned physical resources.
+        uint64_t peakLiveSize = 0;             ///< Maximum total size in bytes of requests live at the same time point.
+
+        uint32_t getResourceCount() const { return (uint32_t)resourceSizes.size(); }
+    };
+
+    /**
+     * Assign requests to physical resources.
+     * @param[in] requests List of requests.
+     * @return The plan.
+     */
+    static Plan plan(const std::vector<Request>& requests);
+
+    /**
+     * Compute the maximum total size of requests live at the same time point.
+     * This is a lower bound for the memory required by any aliasing scheme, including placing resources in shared heaps.
+     * @param[in] requests List of requests.
+     * @return Peak live size in bytes.
+     */
+    static uint64_t computePeakLiveSize(const std::vector<Request>& requests);
+};
+} // namespace Falcor
@@ -26,10 +26,17 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "ResourceCache.h"
+#include "ResourceAliasingPlanner.h"
 #include "Core/API/Device.h"
 #include "Core/API/Texture.h"
 #include "Core/API/Buffer.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -37,6 +44,7 @@ void ResourceCache::reset()
 {
     mNameToIndex.clear();
     mResourceData.clear();
+    mMemoryReport = {};
 }
 
 const ref<Resource>& ResourceCache::getResource(const std::string& name) const
@@ -106,7 +114,8 @@ void ResourceCache::registerField(
         FALCOR_ASSERT(mNameToIndex.count(name) == 0);
         mNameToIndex[name] = (uint32_t)mResourceData.size();
         bool resolveBindFlags = (field.getBindFlags() == ResourceBindFlags::None);
-        mResourceData.push_back({field, {timePoint, timePoint}, nullptr, resolveBindFlags, name});
+        bool persistent = is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent);
+        mResourceData.push_back({field, {timePoint, timePoint}, nullptr, resolveBindFlags, name, persistent});
     }
     else // Add alias
     {
@@ -116,30 +125,53 @@ void ResourceCache::registerField(
         mergeTimePoint(mResourceData[index].lifetime, timePoint);
         mResourceData[index].pResource = nullptr;
         mResourceData[index].resolveBindFlags = mResourceData[index].resolveBindFlags || (field.getBindFlags() == ResourceBindFlags::None);
+        mResourceData[index].persistent =
+            mResourceData[index].persistent || is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent);
     }
 }
 
-inline ref<Resource> createResourceForPass(
+namespace
+{
+/**
+ * Fully resolved properties of a resource to create for a field.
+ */
+struct ResourceDesc
+{
+    RenderPassReflection::Field::Type type;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t sampleCount;
+    uint32_t arraySize;
+    uint32_t mipLevels;
+    ResourceFormat format;
+    ResourceBindFlags bindFlags;
+
+    auto toTuple() const { return std::make_tuple(type, width, height, depth, sampleCount, arraySize, mipLevels, format, bindFlags); }
+    bool operator<(const ResourceDesc& other) const { return toTuple() < other.toTuple(); }
+};
+
+ResourceDesc resolveResourceDesc(
     ref<Device> pDevice,
     const ResourceCache::DefaultProperties& params,
     const RenderPassReflection::Field& field,
-    bool resolveBindFlags,
-    const std::string& resourceName
+    bool resolveBindFlags
 )
 {
-    uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-    uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-    uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-    uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-    auto bindFlags = field.getBindFlags();
-    auto arraySize = field.getArraySize();
-    auto mipLevels = field.getMipCount();
-
-    ResourceFormat format = ResourceFormat::Unknown;
+    ResourceDesc desc;
+    desc.type = field.getType();
+    desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+    desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+    desc.depth = field.getDepth() ? field.getDepth() : 1;
+    desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+    desc.arraySize = field.getArraySize();
+    desc.mipLevels = field.getMipCount();
+    desc.format = ResourceFormat::Unknown;
+    desc.bindFlags = field.getBindFlags();
 
     if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
     {
-        format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+        desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
         if (resolveBindFlags)
         {
             ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
@@ -147,41 +179,92 @@ inline ref<Resource> createResourceForPass(
             bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
             if (isOutput || isInternal)
                 mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
-            auto supported = pDevice->getFormatBindFlags(format);
+            auto supported = pDevice->getFormatBindFlags(desc.format);
             mask &= supported;
-            bindFlags |= mask;
+            desc.bindFlags |= mask;
         }
     }
     else // RawBuffer
     {
         if (resolveBindFlags)
-            bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            desc.bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+    }
+
+    return desc;
+}
+
+/**
+ * Estimate the memory footprint of a resource, ignoring placement alignment and padding.
+ */
+uint64_t estimateResourceSize(const ResourceDesc& desc)
+{
+    if (desc.type == RenderPassReflection::Field::Type::RawBuffer)
+        return desc.width;
+    if (desc.format == ResourceFormat::Unknown)
+        return 0;
+
+    uint32_t width = desc.width;
+    uint32_t height = desc.type == RenderPassReflection::Field::Type::Texture1D ? 1 : desc.height;
+    uint32_t depth = desc.type == RenderPassReflection::Field::Type::Texture3D ? desc.depth : 1;
+    uint32_t layerCount = std::max(desc.arraySize, 1u) * (desc.type == RenderPassReflection::Field::Type::TextureCube ? 6 : 1);
+
+    uint32_t mipLevels = std::max(desc.mipLevels, 1u);
+    if (desc.mipLevels == Texture::kMaxPossible)
+    {
+        uint32_t dims = std::max(width, std::max(height, depth));
+        mipLevels = 1;
+        while (dims >>= 1)
+            mipLevels++;
+    }
+
+    const uint32_t blockWidth = getFormatWidthCompressionRatio(desc.format);
+    const uint32_t blockHeight = getFormatHeightCompressionRatio(desc.format);
+    const uint32_t bytesPerBlock = getFormatBytesPerBlock(desc.format);
+
+    uint64_t size = 0;
+    for (uint32_t mip = 0; mip < mipLevels; mip++)
+    {
+        size += uint64_t(div_round_up(width, blockWidth)) * div_round_up(height, blockHeight) * depth * bytesPerBlock;
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        depth = std::max(depth / 2, 1u);
     }
+    return size * layerCount * desc.sampleCount;
+}
+
+ref<Resource> createResource(ref<Device> pDevice, const ResourceDesc& desc, const std::string& resourceName)
+{
     ref<Resource> pResource;
 
-    switch (field.getType())
+    switch (desc.type)
     {
     case RenderPassReflection::Field::Type::RawBuffer:
-        pResource = Buffer::create(pDevice, width, bindFlags, Buffer::CpuAccess::None);
+        pResource = Buffer::create(pDevice, desc.width, desc.bindFlags, Buffer::CpuAccess::None);
         break;
     case RenderPassReflection::Field::Type::Texture1D:
-        pResource = Texture::create1D(pDevice, width, format, arraySize, mipLevels, nullptr, bindFlags);
+        pResource = Texture::create1D(pDevice, desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     case RenderPassReflection::Field::Type::Texture2D:
-        if (sampleCount > 1)
+        if (desc.sampleCount > 1)
         {
-            pResource = Texture::create2DMS(pDevice, width, height, format, sampleCount, arraySize, bindFlags);
+            pResource =
+                Texture::create2DMS(pDevice, desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
         }
         else
         {
-            pResource = Texture::create2D(pDevice, width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+            pResource = Texture::create2D(
+                pDevice, desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags
+            );
         }
         break;
     case RenderPassReflection::Field::Type::Texture3D:
-        pResource = Texture::create3D(pDevice, width, height, depth, format, mipLevels, nullptr, bindFlags);
+        pResource =
+            Texture::create3D(pDevice, desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     case RenderPassReflection::Field::Type::TextureCube:
-        pResource = Texture::createCube(pDevice, width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+        pResource = Texture::createCube(
+            pDevice, desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags
+        );
         break;
     default:
         FALCOR_UNREACHABLE();
@@ -190,15 +273,102 @@ inline ref<Resource> createResourceForPass(
     pResource->setName(resourceName);
     return pResource;
 }
+} // namespace
+
+bool ResourceCache::isTransient(const ResourceData& data) const
+{
+    // Graph outputs are registered with a lifetime extending to the end of graph execution.
+    // Internal and persistent resources must keep their contents between executions.
+    if (data.lifetime.second == uint32_t(-1))
+        return false;
+    if (is_set(data.field.getVisibility(), RenderPassReflection::Field::Visibility::Internal))
+        return false;
+    return !data.persistent;
+}
 
 void ResourceCache::allocateResources(ref<Device> pDevice, const DefaultProperties& params)
 {
-    for (auto& data : mResourceData)
+    // Resolve the properties of all resources that need to be created.
+    std::vector<uint32_t> dataIndices;
+    std::vector<ResourceDesc> descs;
+    for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
     {
+        const auto& data = mResourceData[i];
         if ((data.pResource == nullptr) && (data.field.isValid()))
         {
-            data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
+            dataIndices.push_back(i);
+            descs.push_back(resolveResourceDesc(pDevice, params, data.field, data.resolveBindFlags));
         }
     }
+
+    // Plan which fields share a resource. Only fields with identical resource properties can share a resource.
+    std::map<ResourceDesc, uint32_t> descToClass;
+    std::vector<ResourceAliasingPlanner::Request> requests(dataIndices.size());
+    for (size_t i = 0; i < dataIndices.size(); i++)
+    {
+        auto& data = mResourceData[dataIndices[i]];
+        data.size = estimateResourceSize(descs[i]);
+
+        auto& request = requests[i];
+        request.firstUse = data.lifetime.first;
+        request.lastUse = data.lifetime.second;
+        request.size = data.size;
+        request.compatibilityClass = descToClass.emplace(descs[i], (uint32_t)descToClass.size()).first->second;
+        request.aliasable = mAliasingEnabled && isTransient(data);
+    }
+    auto plan = ResourceAliasingPlanner::plan(requests);
+
+    // Create the resources. Shared resources are named after all fields using them.
+    std::vector<std::string> names(plan.getResourceCount());
+    for (size_t i = 0; i < dataIndices.size(); i++)
+    {
+        auto& name = names[plan.resourceIndices[i]];
+        name += (name.empty() ? "" : ", ") + mResourceData[dataIndices[i]].name;
+    }
+
+    std::vector<ref<Resource>> resources(plan.getResourceCount());
+    for (size_t i = 0; i < dataIndices.size(); i++)
+    {
+        uint32_t resourceIndex = plan.resourceIndices[i];
+        if (!resources[resourceIndex])
+            resources[resourceIndex] = createResource(pDevice, descs[i], names[resourceIndex]);
+        mResourceData[dataIndices[i]].pResource = resources[resourceIndex];
+    }
+
+    updateMemoryReport();
+    logDebug(
+        "ResourceCache: Allocated {} resources for {} fields ({} allocated, {} without aliasing, {} peak live).",
+        mMemoryReport.resourceCount, mMemoryReport.fieldCount, formatByteSize(mMemoryReport.allocatedSize),
+        formatByteSize(mMemoryReport.naiveSize), formatByteSize(mMemoryReport.peakLiveSize)
+    );
+}
+
+void ResourceCache::updateMemoryReport()
+{
+    mMemoryReport = {};
+
+    std::unordered_map<const Resource*, uint64_t> resourceSizes;
+    std::vector<ResourceAliasingPlanner::Request> requests;
+    for (const auto& data : mResourceData)
+    {
+        if (!data.pResource)
+            continue;
+
+        mMemoryReport.fieldCount++;
+        mMemoryReport.naiveSize += data.size;
+        auto& resourceSize = resourceSizes[data.pResource.get()];
+        resourceSize = std::max(resourceSize, data.size);
+
+        ResourceAliasingPlanner::Request request;
+        request.firstUse = data.lifetime.first;
+        request.lastUse = data.lifetime.second;
+        request.size = data.size;
+        requests.push_back(request);
+    }
+
+    mMemoryReport.resourceCount = (uint32_t)resourceSizes.size();
+    for (const auto& [pResource, size] : resourceSizes)
+        mMemoryReport.allocatedSize += size;
+    mMemoryReport.peakLiveSize = ResourceAliasingPlanner::computePeakLiveSize(requests);
 }
 } // namespace Falcor
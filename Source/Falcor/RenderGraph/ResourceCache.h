@@ -51,6 +51,18 @@ public:
         ResourceFormat format = ResourceFormat::Unknown; ///< Format to use for texture creation
     };
 
+    /**
+     * Memory statistics of the resources allocated by the cache. Sizes are estimates based on the resource descriptions.
+     */
+    struct MemoryReport
+    {
+        uint32_t fieldCount = 0;    ///< Number of fields (after merging aliases) with an allocated resource.
+        uint32_t resourceCount = 0; ///< Number of allocated resources.
+        uint64_t naiveSize = 0;     ///< Size in bytes when allocating a dedicated resource per field.
+        uint64_t allocatedSize = 0; ///< Size in bytes of the allocated resources.
+        uint64_t peakLiveSize = 0;  ///< Peak size in bytes of the fields live at the same time in the execution order.
+    };
+
     /**
      * Add/Remove reference to a graph input resource not owned by the cache
      * @param[in] name The resource's name
@@ -86,9 +98,26 @@ public:
     /**
      * Allocate all resources that need to be created/updated.
      * This includes new resources, resources whose properties have been updated since last allocation call.
+     * If aliasing is enabled, transient fields with identical resource properties and disjoint lifetimes share a single resource.
      */
     void allocateResources(ref<Device> pDevice, const DefaultProperties& params);
 
+    /**
+     * Enable/disable resource aliasing. Takes effect on the next call to allocateResources().
+     * Fields that are graph outputs, internal or marked as persistent are never aliased.
+     */
+    void setAliasingEnabled(bool enabled) { mAliasingEnabled = enabled; }
+
+    /**
+     * Check if resource aliasing is enabled.
+     */
+    bool isAliasingEnabled() const { return mAliasingEnabled; }
+
+    /**
+     * Get memory statistics of the resources allocated by the last call to allocateResources().
+     */
+    const MemoryReport& getMemoryReport() const { return mMemoryReport; }
+
     /**
      * Clears all registered field/resource properties and allocated resources.
      */
@@ -102,14 +131,22 @@ private:
         ref<Resource> pResource;                // The resource
         bool resolveBindFlags;                  // Whether or not we should resolve the field's bind-flags before creating the resource
         std::string name;                       // Full name of the resource, including the pass name
+        bool persistent;                        // Whether any of the merged fields is marked as persistent
+        uint64_t size = 0;                      // Estimated size of the resource in bytes
     };
 
+    bool isTransient(const ResourceData& data) const;
+    void updateMemoryReport();
+
     // Resources and properties for fields within (and therefore owned by) a render graph
     std::unordered_map<std::string, uint32_t> mNameToIndex;
     std::vector<ResourceData> mResourceData;
 
     // References to output resources not to be allocated by the render graph
     ResourcesMap mExternalResources;
+
+    bool mAliasingEnabled = true;
+    MemoryReport mMemoryReport;
 };
 
 } // namespace Falcor
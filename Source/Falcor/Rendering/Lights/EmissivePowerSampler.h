@@ -29,7 +29,6 @@
 #include "EmissiveLightSampler.h"
 #include "Core/Macros.h"
 #include "Scene/Lights/LightCollection.h"
-#include <random>
 #include <vector>
 
 namespace Falcor
@@ -80,7 +79,6 @@ namespace Falcor
 
         ref<const LightCollection>      mpLightCollection;
 
-        std::mt19937                    mAliasTableRng;
         AliasTable                      mTriangleTable;
     };
 }
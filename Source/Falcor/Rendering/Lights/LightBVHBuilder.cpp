@@ -29,9 +29,11 @@
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Math/MathConstants.slangh"
 #include <algorithm>
+#include <numeric>
 
 namespace
 {
@@ -45,6 +47,104 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Nodes with at least this many triangles are binned and reordered with multiple threads.
+    const uint32_t kParallelBinningThreshold = 1 << 16;
+    // Number of triangles per chunk when binning in parallel.
+    const uint32_t kBinningChunkSize = 1 << 13;
+    // Nodes with at least this many triangles build their right subtree as a separate task.
+    const uint32_t kParallelSubtreeThreshold = 1 << 12;
+    // Internal nodes with a left subtree of at least this many nodes compute its lighting cones as a separate task.
+    const uint32_t kParallelConeNodeThreshold = 1 << 12;
+
+    /** Calls func(first, last) on a range of triangles.
+        The range is split into chunks that are processed in parallel if it is large enough.
+    */
+    template<typename Func>
+    void forTriangleRange(uint32_t begin, uint32_t end, bool parallel, Func func)
+    {
+        if (parallel && end - begin >= kParallelBinningThreshold)
+        {
+            Threading::parallelFor(begin, end, [&func](size_t first, size_t last) { func((uint32_t)first, (uint32_t)last); }, kBinningChunkSize);
+        }
+        else
+        {
+            func(begin, end);
+        }
+    }
+
+    /** Calls func(binId, index) for all triangles in the range [begin, end).
+        Large ranges are first grouped by bin id so that the bins can be filled in parallel.
+        Each bin still sees its triangles in increasing order, so floating-point sums are
+        identical to the ones of a serial loop over the range.
+        \param[in] pScratch Scratch memory for the triangle indices of the range.
+    */
+    template<typename GetBinId, typename Func>
+    void forEachTriangleInBins(uint32_t begin, uint32_t end, uint32_t binCount, bool parallel, uint32_t* pScratch, GetBinId getBinId, Func func)
+    {
+        if (!parallel || end - begin < kParallelBinningThreshold)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                func(getBinId(i), i);
+            }
+            return;
+        }
+
+        // Count the triangles per chunk and bin.
+        const uint32_t chunkCount = (end - begin + kBinningChunkSize - 1) / kBinningChunkSize;
+        std::vector<uint32_t> offsets((size_t)chunkCount * binCount, 0);
+        const auto getChunkRange = [&](size_t chunk)
+        {
+            uint32_t first = begin + (uint32_t)chunk * kBinningChunkSize;
+            return std::make_pair(first, std::min(first + kBinningChunkSize, end));
+        };
+        Threading::parallelFor(0, chunkCount, [&](size_t firstChunk, size_t lastChunk)
+        {
+            for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+            {
+                uint32_t* pCounts = offsets.data() + chunk * binCount;
+                auto [first, last] = getChunkRange(chunk);
+                for (uint32_t i = first; i < last; ++i) pCounts[getBinId(i)]++;
+            }
+        }, 1);
+
+        // Turn the counts into output offsets. Bins are stored one after another, with the chunks in order within each bin.
+        std::vector<uint32_t> binOffsets(binCount + 1);
+        uint32_t offset = 0;
+        for (uint32_t bin = 0; bin < binCount; ++bin)
+        {
+            binOffsets[bin] = offset;
+            for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                uint32_t count = offsets[(size_t)chunk * binCount + bin];
+                offsets[(size_t)chunk * binCount + bin] = offset;
+                offset += count;
+            }
+        }
+        binOffsets[binCount] = offset;
+        FALCOR_ASSERT(offset == end - begin);
+
+        // Group the triangle indices by bin.
+        Threading::parallelFor(0, chunkCount, [&](size_t firstChunk, size_t lastChunk)
+        {
+            for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+            {
+                uint32_t* pOffsets = offsets.data() + chunk * binCount;
+                auto [first, last] = getChunkRange(chunk);
+                for (uint32_t i = first; i < last; ++i) pScratch[pOffsets[getBinId(i)]++] = i;
+            }
+        }, 1);
+
+        // Fill the bins in parallel.
+        Threading::parallelFor(0, binCount, [&](size_t firstBin, size_t lastBin)
+        {
+            for (size_t bin = firstBin; bin < lastBin; ++bin)
+            {
+                for (uint32_t j = binOffsets[bin]; j < binOffsets[bin + 1]; ++j) func((uint32_t)bin, pScratch[j]);
+            }
+        }, 1);
+    }
+
     inline float safeACos(float v)
     {
         return std::acos(std::clamp(v, -1.0f, 1.0f));
@@ -236,77 +336,120 @@ namespace Falcor
         // Get global list of emissive triangles.
         FALCOR_ASSERT(bvh.mpLightCollection);
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
+
+        std::vector<uint32_t> triangleIndices;
+        std::vector<uint64_t> triangleBitmasks;
+        buildNodes(triangles, bvh.mNodes, triangleIndices, triangleBitmasks);
+
+        // If there are no non-culled triangles, we're done.
+        if (bvh.mNodes.empty()) return;
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.uploadCPUBuffers(triangleIndices, triangleBitmasks);
+
+        // Computate metadata.
+        bvh.finalize();
+    }
+
+    void LightBVHBuilder::buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, bool parallel)
+    {
+        nodes.clear();
+        triangleIndices.clear();
+        triangleBitmasks.clear();
         if (triangles.empty()) return;
 
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
-        data.trianglesData.reserve(triangles.size());
+        BuildingData data(nodes);
+        data.parallel = parallel;
+        TriangleSortData& trianglesData = data.trianglesData;
 
         for (size_t i = 0; i < triangles.size(); i++)
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                trianglesData.triangleIndex.push_back(static_cast<uint32_t>(i));
             }
         }
 
         // If there are no non-culled triangles, we're done.
-        if (data.trianglesData.empty()) return;
+        if (trianglesData.empty()) return;
 
         // Validate options.
         if (mOptions.maxTriangleCountPerLeaf > kMaxLeafTriangleCount)
         {
             throw RuntimeError("Max triangle count per leaf exceeds the maximum supported ({})", kMaxLeafTriangleCount);
         }
-        if (data.trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
+        if (trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
         {
             throw RuntimeError("Emissive triangle count exceeds the maximum supported ({})", kMaxLeafTriangleOffset + kMaxLeafTriangleCount);
         }
 
+        const uint32_t triangleCount = static_cast<uint32_t>(trianglesData.size());
+        trianglesData.boundsMin.resize(triangleCount);
+        trianglesData.boundsMax.resize(triangleCount);
+        for (auto& centroid : trianglesData.centroid) centroid.resize(triangleCount);
+        trianglesData.coneDirection.resize(triangleCount);
+        trianglesData.cosConeAngle.resize(triangleCount);
+        trianglesData.flux.resize(triangleCount);
+
+        forTriangleRange(0, triangleCount, parallel, [&](uint32_t first, uint32_t last)
+        {
+            for (uint32_t i = first; i < last; ++i)
+            {
+                const auto& triangle = triangles[trianglesData.triangleIndex[i]];
+                AABB bounds;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    bounds |= triangle.vtx[j].pos;
+                }
+                const float3 center = bounds.center();
+                trianglesData.boundsMin[i] = bounds.minPoint;
+                trianglesData.boundsMax[i] = bounds.maxPoint;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    trianglesData.centroid[j][i] = center[j];
+                }
+                trianglesData.coneDirection[i] = triangle.normal;
+                trianglesData.cosConeAngle[i] = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+                trianglesData.flux[i] = triangle.flux;
+            }
+        });
+
         // Allocate temporary memory for the BVH build.
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
-        data.nodes.reserve(2 * data.trianglesData.size());
-        data.triangleIndices.reserve(data.trianglesData.size());
+        data.nodes.reserve(2 * triangleCount);
+        data.indexScratch.resize(triangleCount);
+        data.uintScratch.resize(triangleCount);
+        data.floatScratch.resize(triangleCount);
+        data.float3Scratch.resize(triangleCount);
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
         data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, triangleCount), data, data.nodes);
         FALCOR_ASSERT(!data.nodes.empty());
 
         size_t numValid = 0;
         for (auto mask : data.triangleBitmasks)
             if (mask != invalidBitmask) numValid++;
-        FALCOR_ASSERT(numValid == data.trianglesData.size());
+        FALCOR_ASSERT(numValid == triangleCount);
+
+        // The leaf nodes cover the triangle list in order, so the sorted triangle indices are the final triangle order.
+        data.triangleIndices = std::move(trianglesData.triangleIndex);
 
         // Compute per-node light bounding cones.
         float cosConeAngle;
         computeLightingConesInternal(0, data, cosConeAngle);
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
-
-        // Computate metadata.
-        bvh.finalize();
+        triangleIndices = std::move(data.triangleIndices);
+        triangleBitmasks = std::move(data.triangleBitmasks);
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -350,24 +493,44 @@ namespace Falcor
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
+        const TriangleSortData& trianglesData = data.trianglesData;
 
         // Compute the AABB and total flux of the node.
-        float nodeFlux = 0.f;
+        // The flux is summed in triangle order to get the same result regardless of threading.
+        const auto computeBounds = [&trianglesData](uint32_t first, uint32_t last)
+        {
+            AABB bounds;
+            for (uint32_t dataIndex = first; dataIndex < last; ++dataIndex)
+            {
+                bounds.minPoint = min(bounds.minPoint, trianglesData.boundsMin[dataIndex]);
+                bounds.maxPoint = max(bounds.maxPoint, trianglesData.boundsMax[dataIndex]);
+            }
+            return bounds;
+        };
         AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        if (data.parallel && triangleRange.length() >= kParallelBinningThreshold)
+        {
+            nodeBounds = Threading::parallelReduce(triangleRange.begin, triangleRange.end, AABB(),
+                [&](size_t first, size_t last) { return computeBounds((uint32_t)first, (uint32_t)last); },
+                [](AABB a, const AABB& b) { return a |= b; }, kBinningChunkSize);
+        }
+        else
         {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
+            nodeBounds = computeBounds(triangleRange.begin, triangleRange.end);
         }
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
+        float nodeFlux = 0.f;
+        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        {
+            nodeFlux += trianglesData.flux[dataIndex];
+        }
 
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -375,13 +538,18 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.begin < splitResult.triangleIndex && splitResult.triangleIndex < triangleRange.end);
 
             // Sort the centroids and update the lists accordingly.
-            auto comp = [dim = splitResult.axis](const TriangleSortData& d1, const TriangleSortData& d2) { return d1.bounds.center()[dim] < d2.bounds.center()[dim]; };
-            std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
+            // The permutation is computed on indices first and then applied to all triangle arrays.
+            uint32_t* pPermutation = data.indexScratch.data() + triangleRange.begin;
+            std::iota(pPermutation, pPermutation + triangleRange.length(), 0u);
+            const float* pCentroid = trianglesData.centroid[splitResult.axis].data() + triangleRange.begin;
+            auto comp = [pCentroid](uint32_t i1, uint32_t i2) { return pCentroid[i1] < pCentroid[i2]; };
+            std::nth_element(pPermutation, pPermutation + (splitResult.triangleIndex - triangleRange.begin), pPermutation + triangleRange.length(), comp);
+            permuteTriangles(triangleRange, pPermutation, data);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -395,13 +563,37 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftIndex, rightIndex;
+            if (data.parallel && triangleRange.length() >= kParallelSubtreeThreshold)
+            {
+                // Build the right subtree concurrently into its own node list and append it once the left subtree is done.
+                std::vector<PackedNode> rightNodes;
+                Threading::TaskGroup group;
+                group.run([&]() { buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, rightNodes); });
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes);
+                group.finish();
+
+                // Offset the right child indices of the appended internal nodes. For internal nodes, the index is stored in the first dword.
+                FALCOR_ASSERT(nodes.size() + rightNodes.size() < std::numeric_limits<uint32_t>::max());
+                rightIndex = (uint32_t)nodes.size();
+                for (PackedNode& rightNode : rightNodes)
+                {
+                    if (!rightNode.isLeaf()) rightNode.data[0].x += rightIndex;
+                }
+                nodes.insert(nodes.end(), rightNodes.begin(), rightNodes.end());
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, nodes);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -409,9 +601,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -420,24 +612,47 @@ namespace Falcor
             node.attribs.coneDirection = computeLightingCone(triangleRange, data, cosTheta);
             node.attribs.cosConeAngle = cosTheta;
 
+            // Leaves are created in triangle order, so the leaf's triangle indices are stored at the start of its range.
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = triangleRange.begin;
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
-            for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
+            for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
             {
-                uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                uint32_t globalTriangleIndex = trianglesData.triangleIndex[triangleIdx];
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
 
+    void LightBVHBuilder::permuteTriangles(const Range& triangleRange, const uint32_t* pPermutation, BuildingData& data)
+    {
+        const auto permute = [&](auto& values, auto& scratch)
+        {
+            forTriangleRange(triangleRange.begin, triangleRange.end, data.parallel, [&](uint32_t first, uint32_t last)
+            {
+                for (uint32_t i = first; i < last; ++i) scratch[i] = values[triangleRange.begin + pPermutation[i - triangleRange.begin]];
+            });
+            forTriangleRange(triangleRange.begin, triangleRange.end, data.parallel, [&](uint32_t first, uint32_t last)
+            {
+                std::copy(scratch.begin() + first, scratch.begin() + last, values.begin() + first);
+            });
+        };
+
+        TriangleSortData& trianglesData = data.trianglesData;
+        permute(trianglesData.boundsMin, data.float3Scratch);
+        permute(trianglesData.boundsMax, data.float3Scratch);
+        for (auto& centroid : trianglesData.centroid) permute(centroid, data.floatScratch);
+        permute(trianglesData.coneDirection, data.float3Scratch);
+        permute(trianglesData.cosConeAngle, data.floatScratch);
+        permute(trianglesData.flux, data.floatScratch);
+        permute(trianglesData.triangleIndex, data.uintScratch);
+    }
+
     float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
     {
         if (!data.nodes[nodeIndex].isLeaf())
@@ -448,9 +663,23 @@ namespace Falcor
             uint32_t rightIndex = node.rightChildIdx;
 
             float leftNodeCosConeAngle = kInvalidCosConeAngle;
-            float3 leftNodeConeDirection = computeLightingConesInternal(leftIndex, data, leftNodeCosConeAngle);
+            float3 leftNodeConeDirection;
             float rightNodeCosConeAngle = kInvalidCosConeAngle;
-            float3 rightNodeConeDirection = computeLightingConesInternal(rightIndex, data, rightNodeCosConeAngle);
+            float3 rightNodeConeDirection;
+
+            // The subtrees write to disjoint nodes, so large ones are processed concurrently.
+            if (data.parallel && rightIndex - leftIndex >= kParallelConeNodeThreshold)
+            {
+                Threading::TaskGroup group;
+                group.run([&]() { leftNodeConeDirection = computeLightingConesInternal(leftIndex, data, leftNodeCosConeAngle); });
+                rightNodeConeDirection = computeLightingConesInternal(rightIndex, data, rightNodeCosConeAngle);
+                group.finish();
+            }
+            else
+            {
+                leftNodeConeDirection = computeLightingConesInternal(leftIndex, data, leftNodeCosConeAngle);
+                rightNodeConeDirection = computeLightingConesInternal(rightIndex, data, rightNodeCosConeAngle);
+            }
 
             // TODO: Asserts in coneUnion
             //float3 coneDirection = coneUnion(leftNodeConeDirection, leftNodeCosConeAngle,
@@ -483,7 +712,7 @@ namespace Falcor
         float3 coneDirectionSum = float3(0.0f);
         for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
         {
-            coneDirectionSum += data.trianglesData[triangleIdx].coneDirection;
+            coneDirectionSum += data.trianglesData.coneDirection[triangleIdx];
         }
         if (length(coneDirectionSum) >= FLT_MIN)
         {
@@ -491,14 +720,13 @@ namespace Falcor
             cosTheta = 1.f;
             for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
             {
-                const TriangleSortData& td = data.trianglesData[triangleIdx];
-                cosTheta = computeCosConeAngle(coneDirection, cosTheta, td.coneDirection, td.cosConeAngle);
+                cosTheta = computeCosConeAngle(coneDirection, cosTheta, data.trianglesData.coneDirection[triangleIdx], data.trianglesData.cosConeAngle[triangleIdx]);
             }
         }
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -525,7 +753,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -536,7 +764,6 @@ namespace Falcor
             uint32_t triangleCount = 0;
 
             Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1) {}
             Bin& operator|= (const Bin& rhs)
             {
                 bounds |= rhs.bounds;
@@ -556,25 +783,29 @@ namespace Falcor
         const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
         {
             // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
+            const float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
+            FALCOR_ASSERT(bmin < bmax);
+            const float scale = (float)parameters.binCount / (bmax - bmin);
+            const uint32_t lastBin = parameters.binCount - 1;
+            const float* pCentroid = data.trianglesData.centroid[dimension].data();
+            auto getBinId = [=](uint32_t triangleIdx)
             {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                FALCOR_ASSERT(bmin < bmax);
-                float scale = (float)parameters.binCount / (bmax - bmin);
-                float p = td.bounds.center()[dimension];
+                float p = pCentroid[triangleIdx];
                 FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
+                return std::min((uint32_t)((p - bmin) * scale), lastBin);
             };
 
             // Reset the bins.
             for (Bin& bin : bins) bin = Bin();
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            forEachTriangleInBins(triangleRange.begin, triangleRange.end, parameters.binCount, data.parallel, data.indexScratch.data() + triangleRange.begin, getBinId,
+                [&bins, &data](uint32_t binId, uint32_t triangleIdx)
+                {
+                    Bin& bin = bins[binId];
+                    bin.bounds |= data.trianglesData.getBounds(triangleIdx);
+                    bin.triangleCount++;
+                });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -638,7 +869,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -680,7 +911,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -699,7 +930,6 @@ namespace Falcor
             float cosConeAngle = 1.0f;
 
             Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1), flux(tri.flux), coneDirection(tri.coneDirection), cosConeAngle(tri.cosConeAngle) {}
             Bin& operator|= (const Bin& rhs)
             {
                 bounds |= rhs.bounds;
@@ -725,26 +955,34 @@ namespace Falcor
         const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
         {
             // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
+            const float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
+            const float w = bmax - bmin;
+            FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
+            const float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
+            const uint32_t lastBin = parameters.binCount - 1;
+            const float* pCentroid = data.trianglesData.centroid[dimension].data();
+            auto getBinId = [=](uint32_t triangleIdx)
             {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                float w = bmax - bmin;
-                FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
-                float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
-                float p = td.bounds.center()[dimension];
+                float p = pCentroid[triangleIdx];
                 FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
+                return std::min((uint32_t)((p - bmin) * scale), lastBin);
             };
 
             // Reset the bins.
             for (Bin& bin : bins) bin = Bin();
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            const TriangleSortData& trianglesData = data.trianglesData;
+            uint32_t* pScratch = data.indexScratch.data() + triangleRange.begin;
+            forEachTriangleInBins(triangleRange.begin, triangleRange.end, parameters.binCount, data.parallel, pScratch, getBinId,
+                [&bins, &trianglesData](uint32_t binId, uint32_t triangleIdx)
+                {
+                    Bin& bin = bins[binId];
+                    bin.bounds |= trianglesData.getBounds(triangleIdx);
+                    bin.triangleCount++;
+                    bin.flux += trianglesData.flux[triangleIdx];
+                    bin.coneDirection += trianglesData.coneDirection[triangleIdx];
+                });
 
             // Compute the lighting cones for each bin.
             // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
@@ -755,12 +993,12 @@ namespace Falcor
                 bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            forEachTriangleInBins(triangleRange.begin, triangleRange.end, parameters.binCount, data.parallel, pScratch, getBinId,
+                [&bins, &trianglesData](uint32_t binId, uint32_t triangleIdx)
+                {
+                    Bin& bin = bins[binId];
+                    bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, trianglesData.coneDirection[triangleIdx], trianglesData.cosConeAngle[triangleIdx]);
+                });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -849,7 +1087,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -859,7 +1097,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
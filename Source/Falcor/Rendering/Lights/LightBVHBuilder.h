@@ -106,6 +106,18 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Build the BVH nodes on the CPU.
+            This runs the same build as build(), but writes the result to the given arrays instead of uploading it.
+            The upper levels of the tree are built with parallel binning, the lower levels as independent subtree tasks.
+            The result is identical to the single threaded build.
+            \param[in] triangles Emissive triangles to build the BVH over.
+            \param[out] nodes BVH nodes in depth-first order. Empty if no triangle is included in the build.
+            \param[out] triangleIndices Triangle indices sorted by leaf node.
+            \param[out] triangleBitmasks Per triangle bit pattern retracing the tree traversal. Indexed by global triangle index.
+            \param[in] parallel Set to false to build on the calling thread only.
+        */
+        void buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, bool parallel = true);
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -133,23 +145,38 @@ namespace Falcor
             }
         };
 
+        /** Per triangle data used during the build, stored as structure of arrays.
+            The binning loops only touch the arrays they need, which keeps them cache friendly and lets them vectorize.
+        */
         struct TriangleSortData
         {
-            AABB bounds;                                    ///< World-space bounding box for the light source(s).
-            float3 center = {};                             ///< Center point.
-            float3 coneDirection = {};                      ///< Light emission normal direction.
-            float cosConeAngle = 1.f;                       ///< Cosine normal bounding cone (half) angle.
-            float flux = 0.f;                               ///< Precomputed triangle flux (note, this takes doublesidedness into account).
-            uint32_t triangleIndex = MeshLightData::kInvalidIndex; ///< Index into global triangle list.
+            std::vector<float3> boundsMin;                  ///< World-space bounding box minimum for the light source(s).
+            std::vector<float3> boundsMax;                  ///< World-space bounding box maximum for the light source(s).
+            std::vector<float> centroid[3];                 ///< Bounding box center along each axis. Used for binning and partitioning.
+            std::vector<float3> coneDirection;              ///< Light emission normal direction.
+            std::vector<float> cosConeAngle;                ///< Cosine normal bounding cone (half) angle.
+            std::vector<float> flux;                        ///< Precomputed triangle flux (note, this takes doublesidedness into account).
+            std::vector<uint32_t> triangleIndex;            ///< Index into global triangle list.
+
+            size_t size() const { return triangleIndex.size(); }
+            bool empty() const { return triangleIndex.empty(); }
+            AABB getBounds(uint32_t index) const { return AABB(boundsMin[index], boundsMax[index]); }
         };
 
         struct BuildingData
         {
             std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
-            std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
+            TriangleSortData trianglesData;                 ///< Compact list of triangles to include in build.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
+            bool parallel = true;                           ///< Build on multiple threads.
+
+            // Scratch memory with one element per triangle. A node only uses the elements of its own triangle range,
+            // so subtrees built concurrently never overlap.
+            mutable std::vector<uint32_t> indexScratch;     ///< Partitioning permutation and bin grouping.
+            std::vector<uint32_t> uintScratch;              ///< Temporary storage for reordering uint arrays.
+            std::vector<float> floatScratch;                ///< Temporary storage for reordering float arrays.
+            std::vector<float3> float3Scratch;              ///< Temporary storage for reordering float3 arrays.
 
             BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
         };
@@ -158,23 +185,33 @@ namespace Falcor
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
             \param[in] nodeBounds Bounds for the node to be splitted.
+            \param[in] nodeFlux Total flux of the node to be splitted.
             \param[in] parameters Various parameters defining how the building should occur.
         */
-        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)>;
+        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)>;
 
         /** Renders the UI with builder options.
         */
         bool renderOptions(Gui::Widgets& widget, Options& options) const;
 
         /** Recursive BVH build.
+            Large subtrees are built concurrently into separate node lists, which are appended in depth-first order afterwards.
             \param[in] splitHeuristic The splitting heuristic to be used.
             \param[in] bitmask Bit pattern retracing the tree traversal to reach the node to be built: 0=left child, 1=right child.
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
+            \param[in,out] nodes Node list to append the subtree to. Child indices are relative to the start of this list.
             \return Index of the allocated node.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes);
+
+        /** Reorder the triangles in a range.
+            \param[in] triangleRange Range of triangles to reorder.
+            \param[in] pPermutation New order of the triangles, relative to the start of the range.
+            \param[in,out] data Prepared light data.
+        */
+        static void permuteTriangles(const Range& triangleRange, const uint32_t* pPermutation, BuildingData& data);
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
@@ -193,9 +230,9 @@ namespace Falcor
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
         // See the documentation of SplitHeuristicFunction.
-        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
-        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
-        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
+        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/);
+        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
+        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
@@ -30,7 +30,9 @@
 #include "Utils/ObjectIDPython.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/Threading.h"
 #include "Scene/Transform.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -111,32 +113,32 @@ namespace Falcor
         , mDuration(duration)
     {}
 
-    float4x4 Animation::animate(double currentTime)
+    float4x4 Animation::animate(double currentTime) const
     {
         // Calculate the sample time.
         double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+        if (time < mTimes.front() || time > mTimes.back())
         {
             time = calcSampleTime(currentTime);
         }
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > mTimes.back() && this->getPostInfinityBehavior() == Behavior::Linear;
+        bool isLinearPreInfinity = time < mTimes.front() && this->getPreInfinityBehavior() == Behavior::Linear;
 
         Keyframe interpolated;
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        if (isLinearPreInfinity && mTimes.size() > 1)
         {
-            const auto& k0 = mKeyframes.front();
+            const auto k0 = getKeyframeAt(0);
             auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
             interpolated = interpolateLinear(k0, k1, t);
         }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+        else if (isLinearPostInfinity && mTimes.size() > 1)
         {
-            const auto& k1 = mKeyframes.back();
+            const auto k1 = getKeyframeAt(mTimes.size() - 1);
             auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
@@ -155,38 +157,42 @@ namespace Falcor
         return transform;
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    void Animation::animate(const std::vector<ref<Animation>>& animations, double currentTime, std::vector<float4x4>& transforms)
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
+        transforms.resize(animations.size());
+        Threading::parallelFor(0, animations.size(), [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i) transforms[i] = animations[i]->animate(currentTime);
+        });
+    }
 
-        // Validate cached frame index.
-        size_t frameIndex = std::clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
+    size_t Animation::findKeyframeIndex(double time) const
+    {
+        // Find the last keyframe with a time less or equal to the given time, or the first keyframe if there is none.
+        auto it = std::upper_bound(mTimes.begin(), mTimes.end(), time);
+        return it == mTimes.begin() ? 0 : (size_t)(it - mTimes.begin()) - 1;
+    }
 
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
-        {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
-        }
+    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    {
+        FALCOR_ASSERT(!mTimes.empty());
 
-        // Cache frame index;
-        mCachedFrameIndex = frameIndex;
+        size_t frameIndex = findKeyframeIndex(time);
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
         {
-            size_t count = mKeyframes.size();
+            size_t count = mTimes.size();
             return mEnableWarping ? (frame + count + offset) % count : std::clamp(frame + offset, (size_t)0, count - 1);
         };
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+        if (mode == InterpolationMode::Linear || mTimes.size() < 4)
         {
             size_t i0 = frameIndex;
             size_t i1 = adjacentFrame(i0);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
 
             double segmentDuration = k1.time - k0.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -201,10 +207,10 @@ namespace Falcor
             size_t i2 = adjacentFrame(i1, 1);
             size_t i3 = adjacentFrame(i1, 2);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
+            const Keyframe k2 = getKeyframeAt(i2);
+            const Keyframe k3 = getKeyframeAt(i3);
 
             double segmentDuration = k2.time - k1.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -222,11 +228,11 @@ namespace Falcor
     // the animation does not behave linearly. If the animation behaves linearly, then the
     // current time is returned. This function should not be used if the current time lies
     // within the range of defined keyframe times.
-    double Animation::calcSampleTime(double currentTime)
+    double Animation::calcSampleTime(double currentTime) const
     {
         double modifiedTime = currentTime;
-        double firstKeyframeTime = mKeyframes.front().time;
-        double lastKeyframeTime = mKeyframes.back().time;
+        double firstKeyframeTime = mTimes.front();
+        double lastKeyframeTime = mTimes.back();
         double duration = lastKeyframeTime - firstKeyframeTime;
 
         FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
@@ -257,59 +263,34 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
-        {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
-        }
-        else if (mKeyframes.back().time < keyframe.time)
-        {
-            mKeyframes.push_back(keyframe);
-        }
-        else
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), keyframe.time);
+        size_t index = it - mTimes.begin();
+
+        // If we already have a keyframe at the same time, replace it.
+        if (it != mTimes.end() && *it == keyframe.time)
         {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
-
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
-
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
+            mTranslations[index] = keyframe.translation;
+            mScalings[index] = keyframe.scaling;
+            mRotations[index] = keyframe.rotation;
+            return;
         }
+
+        mTimes.insert(it, keyframe.time);
+        mTranslations.insert(mTranslations.begin() + index, keyframe.translation);
+        mScalings.insert(mScalings.begin() + index, keyframe.scaling);
+        mRotations.insert(mRotations.begin() + index, keyframe.rotation);
     }
 
-    const Animation::Keyframe& Animation::getKeyframe(double time) const
+    Animation::Keyframe Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+        if (it == mTimes.end() || *it != time) throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        return getKeyframeAt(it - mTimes.begin());
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mTimes.begin(), mTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
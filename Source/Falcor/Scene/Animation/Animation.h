@@ -135,7 +135,11 @@ namespace Falcor
             \param[in] time Time of the keyframe.
             \return Returns the keyframe.
         */
-        const Keyframe& getKeyframe(double time) const;
+        Keyframe getKeyframe(double time) const;
+
+        /** Get the number of keyframes.
+        */
+        size_t getKeyframeCount() const { return mTimes.size(); }
 
         /** Check if a keyframe exists at the specified time.
             \param[in] time Time of the keyframe.
@@ -144,18 +148,28 @@ namespace Falcor
         bool doesKeyframeExists(double time) const;
 
         /** Compute the animation.
+            This function is thread-safe.
             \param time The current time in seconds. This can be larger then the animation time, in which case the animation will loop.
             \return Returns the animation's transform matrix for the specified time.
         */
-        float4x4 animate(double currentTime);
+        float4x4 animate(double currentTime) const;
+
+        /** Compute a batch of animations in parallel.
+            \param[in] animations Animations to compute.
+            \param[in] currentTime The current time in seconds.
+            \param[out] transforms The animations' transform matrices for the specified time. Resized to the number of animations.
+        */
+        static void animate(const std::vector<ref<Animation>>& animations, double currentTime, std::vector<float4x4>& transforms);
 
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
 
     private:
+        Keyframe getKeyframeAt(size_t index) const { return Keyframe{mTimes[index], mTranslations[index], mScalings[index], mRotations[index]}; }
+        size_t findKeyframeIndex(double time) const;
         Keyframe interpolate(InterpolationMode mode, double time) const;
-        double calcSampleTime(double currentTime);
+        double calcSampleTime(double currentTime) const;
 
         std::string mName;
         NodeID mNodeID;
@@ -167,8 +181,11 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
-        mutable size_t mCachedFrameIndex = 0;
+        // Keyframes sorted by time. Stored as separate arrays to keep the time lookup cache friendly.
+        std::vector<double> mTimes;
+        std::vector<float3> mTranslations;
+        std::vector<float3> mScalings;
+        std::vector<quatf> mRotations;
 
         friend class SceneCache;
     };
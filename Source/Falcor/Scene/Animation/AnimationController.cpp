@@ -27,9 +27,12 @@
  **************************************************************************/
 #include "AnimationController.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
+#include <algorithm>
 #include <fstream>
+#include <limits>
 
 namespace Falcor
 {
@@ -39,6 +42,9 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        // Minimum number of matrices processed per task.
+        const size_t kMatrixGrainSize = 256;
     }
 
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
@@ -49,6 +55,7 @@ namespace Falcor
         , mGlobalMatrices(pScene->mSceneGraph.size())
         , mInvTransposeGlobalMatrices(pScene->mSceneGraph.size())
         , mMatricesChanged(pScene->mSceneGraph.size())
+        , mNodesDirty(pScene->mSceneGraph.size())
         , mpScene(pScene)
     {
         // Create GPU resources.
@@ -85,6 +92,8 @@ namespace Falcor
 
         createSkinningPass(staticVertexData, skinningVertexData);
 
+        initSceneGraphLevels();
+
         // Determine length of global animation loop.
         for (const auto& pAnimation : mAnimations)
         {
@@ -182,6 +191,60 @@ namespace Falcor
         }
     }
 
+    void AnimationController::initSceneGraphLevels()
+    {
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const size_t nodeCount = sceneGraph.size();
+        FALCOR_ASSERT(nodeCount <= std::numeric_limits<uint32_t>::max());
+
+        // Compute the level of each node. Nodes are not required to be ordered parent first.
+        const uint32_t kUnknown = std::numeric_limits<uint32_t>::max();
+        mNodeLevels.assign(nodeCount, kUnknown);
+        std::vector<uint32_t> path;
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            uint32_t node = (uint32_t)i;
+            while (mNodeLevels[node] == kUnknown && sceneGraph[node].parent != NodeID::Invalid())
+            {
+                path.push_back(node);
+                node = sceneGraph[node].parent.get();
+                FALCOR_ASSERT(path.size() <= nodeCount);
+            }
+            uint32_t level = mNodeLevels[node] == kUnknown ? 0 : mNodeLevels[node];
+            mNodeLevels[node] = level;
+            while (!path.empty())
+            {
+                mNodeLevels[path.back()] = ++level;
+                path.pop_back();
+            }
+        }
+
+        // Sort nodes by level.
+        uint32_t levelCount = nodeCount > 0 ? *std::max_element(mNodeLevels.begin(), mNodeLevels.end()) + 1 : 0;
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t level : mNodeLevels) mLevelOffsets[level + 1]++;
+        for (size_t i = 0; i < levelCount; ++i) mLevelOffsets[i + 1] += mLevelOffsets[i];
+        mNodesByLevel.resize(nodeCount);
+        std::vector<uint32_t> levelFill(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        for (size_t i = 0; i < nodeCount; ++i) mNodesByLevel[levelFill[mNodeLevels[i]]++] = (uint32_t)i;
+
+        // Build child lists.
+        mChildOffsets.assign(nodeCount + 1, 0);
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            if (sceneGraph[i].parent != NodeID::Invalid()) mChildOffsets[sceneGraph[i].parent.get() + 1]++;
+        }
+        for (size_t i = 0; i < nodeCount; ++i) mChildOffsets[i + 1] += mChildOffsets[i];
+        mChildren.resize(mChildOffsets.back());
+        std::vector<uint32_t> childFill(mChildOffsets.begin(), mChildOffsets.end() - 1);
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            if (sceneGraph[i].parent != NodeID::Invalid()) mChildren[childFill[sceneGraph[i].parent.get()]++] = (uint32_t)i;
+        }
+
+        mDirtyNodesByLevel.resize(levelCount);
+    }
+
     void AnimationController::initLocalMatrices()
     {
         for (size_t i = 0; i < mLocalMatrices.size(); i++)
@@ -194,7 +257,7 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "animate");
 
-        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), 0);
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
@@ -205,7 +268,7 @@ namespace Falcor
             {
                 mLocalMatrices[i] = sceneGraph[i].transform;
                 mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
+                setMatrixChanged(i);
                 edited = true;
             }
         }
@@ -286,14 +349,28 @@ namespace Falcor
         return changed;
     }
 
+    void AnimationController::setMatrixChanged(size_t nodeID)
+    {
+        mMatricesChanged[nodeID] = true;
+        if (!mNodesDirty[nodeID])
+        {
+            mNodesDirty[nodeID] = true;
+            mChangedNodes.push_back((uint32_t)nodeID);
+        }
+    }
+
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        // Evaluate all animations in parallel.
+        Animation::animate(mAnimations, time, mAnimatedMatrices);
+
+        // Scatter the results in order, so the last animation wins if several animations target the same node.
+        for (size_t i = 0; i < mAnimations.size(); ++i)
         {
-            NodeID nodeID = pAnimation->getNodeID();
+            NodeID nodeID = mAnimations[i]->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
-            mMatricesChanged[nodeID.get()] = true;
+            mLocalMatrices[nodeID.get()] = mAnimatedMatrices[i];
+            setMatrixChanged(nodeID.get());
         }
     }
 
@@ -301,31 +378,85 @@ namespace Falcor
     {
         const auto& sceneGraph = mpScene->mSceneGraph;
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        // Process the scene graph level by level. All nodes within a level are independent and updated in parallel,
+        // as their parents have already been updated.
+        if (updateAll)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            for (size_t level = 0; level + 1 < mLevelOffsets.size(); ++level)
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
+                Threading::parallelFor(mLevelOffsets[level], mLevelOffsets[level + 1], [&](size_t first, size_t last)
+                {
+                    for (size_t j = first; j < last; ++j)
+                    {
+                        uint32_t i = mNodesByLevel[j];
+                        // Propagate matrix change flag to children.
+                        if (sceneGraph[i].parent != NodeID::Invalid()) mMatricesChanged[i] |= mMatricesChanged[sceneGraph[i].parent.get()];
+                        updateWorldMatrix(i);
+                    }
+                }, kMatrixGrainSize);
             }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
-
-            mGlobalMatrices[i] = mLocalMatrices[i];
+            for (uint32_t i : mChangedNodes) mNodesDirty[i] = false;
+        }
+        else
+        {
+            // Only update the subtrees below changed nodes.
+            for (uint32_t i : mChangedNodes) mDirtyNodesByLevel[mNodeLevels[i]].push_back(i);
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
+            for (size_t level = 0; level < mDirtyNodesByLevel.size(); ++level)
             {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
-            }
+                auto& dirtyNodes = mDirtyNodesByLevel[level];
+                if (dirtyNodes.empty()) continue;
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+                Threading::parallelFor(0, dirtyNodes.size(), [&](size_t first, size_t last)
+                {
+                    for (size_t j = first; j < last; ++j) updateWorldMatrix(dirtyNodes[j]);
+                }, kMatrixGrainSize);
 
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
+                // Propagate matrix change flag to children. Children that changed themselves are already in the next level's list.
+                if (level + 1 < mDirtyNodesByLevel.size())
+                {
+                    auto& nextDirtyNodes = mDirtyNodesByLevel[level + 1];
+                    for (uint32_t i : dirtyNodes)
+                    {
+                        for (uint32_t c = mChildOffsets[i]; c < mChildOffsets[i + 1]; ++c)
+                        {
+                            uint32_t child = mChildren[c];
+                            mMatricesChanged[child] = true;
+                            if (!mNodesDirty[child])
+                            {
+                                mNodesDirty[child] = true;
+                                nextDirtyNodes.push_back(child);
+                            }
+                        }
+                    }
+                }
+                for (uint32_t i : dirtyNodes) mNodesDirty[i] = false;
+                dirtyNodes.clear();
             }
         }
+
+        mChangedNodes.clear();
+    }
+
+    void AnimationController::updateWorldMatrix(size_t nodeID)
+    {
+        const auto& node = mpScene->mSceneGraph[nodeID];
+
+        mGlobalMatrices[nodeID] = mLocalMatrices[nodeID];
+
+        if (node.parent != NodeID::Invalid())
+        {
+            mGlobalMatrices[nodeID] = mul(mGlobalMatrices[node.parent.get()], mGlobalMatrices[nodeID]);
+        }
+
+        mInvTransposeGlobalMatrices[nodeID] = transpose(inverse(mGlobalMatrices[nodeID]));
+
+        if (mpSkinningPass)
+        {
+            mSkinningMatrices[nodeID] = mul(mGlobalMatrices[nodeID], node.localToBindSpace);
+            mInvTransposeSkinningMatrices[nodeID] = transpose(inverse(mSkinningMatrices[nodeID]));
+        }
     }
 
     void AnimationController::uploadWorldMatrices(bool uploadAll)
@@ -108,7 +108,7 @@ namespace Falcor
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()] != 0; }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -145,9 +145,12 @@ namespace Falcor
     private:
         friend class SceneBuilder;
 
+        void initSceneGraphLevels();
         void initLocalMatrices();
+        void setMatrixChanged(size_t nodeID);
         void updateLocalMatrices(double time);
         void updateWorldMatrices(bool updateAll = false);
+        void updateWorldMatrix(size_t nodeID);
         void uploadWorldMatrices(bool uploadAll = false);
 
         void bindBuffers();
@@ -163,7 +166,18 @@ namespace Falcor
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint8_t> mMatricesChanged;      ///< Flag per matrix, true if matrix changed since last frame. Stored as bytes to allow concurrent updates.
+        std::vector<float4x4> mAnimatedMatrices;    ///< Scratch buffer for the results of the animations.
+
+        // Scene graph hierarchy for propagating world matrices level by level.
+        std::vector<uint32_t> mNodeLevels;          ///< Level (depth) of each scene graph node.
+        std::vector<uint32_t> mNodesByLevel;        ///< Scene graph nodes sorted by level.
+        std::vector<uint32_t> mLevelOffsets;        ///< Offsets into mNodesByLevel for each level (level count + 1 entries).
+        std::vector<uint32_t> mChildOffsets;        ///< Offsets into mChildren for each node (node count + 1 entries).
+        std::vector<uint32_t> mChildren;            ///< Child nodes of all scene graph nodes.
+        std::vector<uint32_t> mChangedNodes;        ///< Nodes whose local matrices changed since last update.
+        std::vector<uint8_t> mNodesDirty;           ///< Flag per node, true if the node is queued for the next world matrix update. Cleared when the update consumes it.
+        std::vector<std::vector<uint32_t>> mDirtyNodesByLevel; ///< Scratch lists of nodes to update per level.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -0,0 +1,171 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasGroupPlanner.h"
+#include "Core/Assert.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <queue>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGroupTypeCount = 3;
+
+        struct Bin
+        {
+            uint64_t load = 0;
+            std::vector<uint32_t> blasIndices;
+        };
+
+        /** Bin-pack BLASes of one group type into groups that fit the memory budget.
+            The number of groups starts at the lower bound given by the total size. BLASes are assigned largest first
+            to the least loaded group, and a new group is opened if it does not fit.
+        */
+        std::vector<Bin> packBlases(const std::vector<BlasGroupPlanner::BlasDesc>& blases, std::vector<uint32_t> indices, uint64_t memoryBudget)
+        {
+            auto blasSize = [&](uint32_t index) { return blases[index].resultByteSize + blases[index].scratchByteSize; };
+
+            std::sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b)
+            {
+                uint64_t sizeA = blasSize(a);
+                uint64_t sizeB = blasSize(b);
+                return sizeA != sizeB ? sizeA > sizeB : a < b;
+            });
+
+            // Oversized BLASes are placed in groups of their own and do not count towards the lower bound.
+            uint64_t totalSize = 0;
+            size_t fittingCount = 0;
+            for (uint32_t index : indices)
+            {
+                if (blasSize(index) > memoryBudget) continue;
+                totalSize += blasSize(index);
+                fittingCount++;
+            }
+            size_t binCount = std::max<size_t>(1, (size_t)div_round_up(totalSize, std::max<uint64_t>(1, memoryBudget)));
+            binCount = std::min(binCount, std::max<size_t>(1, fittingCount));
+
+            std::vector<Bin> bins(binCount);
+
+            // Min-heap of bins by load. Ties are broken by bin index to keep the plan deterministic.
+            auto compare = [&](size_t a, size_t b) { return bins[a].load != bins[b].load ? bins[a].load > bins[b].load : a > b; };
+            std::priority_queue<size_t, std::vector<size_t>, decltype(compare)> queue(compare);
+            for (size_t i = 0; i < binCount; i++) queue.push(i);
+
+            for (uint32_t index : indices)
+            {
+                const uint64_t size = blasSize(index);
+
+                // Oversized BLASes get a group of their own.
+                if (size > memoryBudget)
+                {
+                    bins.push_back({ size, { index } });
+                    continue;
+                }
+
+                size_t binIndex = queue.top();
+                if (bins[binIndex].load + size <= memoryBudget)
+                {
+                    queue.pop();
+                }
+                else
+                {
+                    // The least loaded group is full, so all of them are.
+                    binIndex = bins.size();
+                    bins.push_back({});
+                }
+
+                bins[binIndex].load += size;
+                bins[binIndex].blasIndices.push_back(index);
+                queue.push(binIndex);
+            }
+
+            bins.erase(std::remove_if(bins.begin(), bins.end(), [](const Bin& bin) { return bin.blasIndices.empty(); }), bins.end());
+            for (auto& bin : bins) std::sort(bin.blasIndices.begin(), bin.blasIndices.end());
+            std::sort(bins.begin(), bins.end(), [](const Bin& a, const Bin& b) { return a.blasIndices.front() < b.blasIndices.front(); });
+
+            return bins;
+        }
+    }
+
+    BlasGroupPlanner::GroupType BlasGroupPlanner::getGroupType(const BlasDesc& blas)
+    {
+        if (blas.isDynamic) return GroupType::Dynamic;
+        return blas.useCompaction ? GroupType::StaticCompacted : GroupType::Static;
+    }
+
+    BlasGroupPlanner::Plan BlasGroupPlanner::plan(const std::vector<BlasDesc>& blases, uint64_t memoryBudget)
+    {
+        Plan plan;
+        plan.placements.resize(blases.size());
+
+        std::vector<uint32_t> indicesPerType[kGroupTypeCount];
+        for (uint32_t i = 0; i < (uint32_t)blases.size(); i++)
+        {
+            indicesPerType[(uint32_t)getGroupType(blases[i])].push_back(i);
+        }
+
+        for (uint32_t type = 0; type < kGroupTypeCount; type++)
+        {
+            if (indicesPerType[type].empty()) continue;
+
+            for (auto& bin : packBlases(blases, std::move(indicesPerType[type]), memoryBudget))
+            {
+                const uint32_t groupIndex = (uint32_t)plan.groups.size();
+                Group group;
+                group.type = (GroupType)type;
+                group.blasIndices = std::move(bin.blasIndices);
+
+                for (uint32_t blasIndex : group.blasIndices)
+                {
+                    const auto& blas = blases[blasIndex];
+                    auto& placement = plan.placements[blasIndex];
+                    placement.groupIndex = groupIndex;
+                    placement.resultByteOffset = group.resultByteSize;
+                    placement.scratchByteOffset = group.scratchByteSize;
+                    group.resultByteSize += blas.resultByteSize;
+                    group.scratchByteSize += blas.scratchByteSize;
+                }
+
+                plan.resultBufferByteSize = std::max(plan.resultBufferByteSize, group.resultByteSize);
+                plan.scratchBufferByteSize = std::max(plan.scratchBufferByteSize, group.scratchByteSize);
+                if (group.type == GroupType::Dynamic)
+                {
+                    plan.retainedScratchByteSize = std::max(plan.retainedScratchByteSize, group.scratchByteSize);
+                }
+
+                plan.groups.push_back(std::move(group));
+            }
+        }
+
+        plan.peakBuildMemory = plan.resultBufferByteSize + plan.scratchBufferByteSize;
+        plan.submitCount = (uint32_t)plan.groups.size();
+
+        return plan;
+    }
+}
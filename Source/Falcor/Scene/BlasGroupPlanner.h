@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Plans how the BLASes of a scene are split into groups for building.
+
+        All BLASes in a group are built together into a shared result buffer, using a shared scratch buffer,
+        followed by a readback of their final sizes. Both buffers are reused by all groups, so they are sized
+        for the largest group.
+
+        The planner separates BLASes by type (static compacted, static non-compacted, dynamic) so that updates
+        only touch groups with dynamic BLASes, and so that only the scratch memory of dynamic groups needs to
+        be retained after the build. Within each type, BLASes are bin-packed by result + scratch size into the
+        smallest number of groups that fit the memory budget, assigning the largest BLASes first to the least
+        loaded group. This keeps the groups balanced, which minimizes the size of the shared buffers.
+
+        The planner only operates on sizes and has no GPU dependencies.
+    */
+    class FALCOR_API BlasGroupPlanner
+    {
+    public:
+        /** Build requirements of a single BLAS. Sizes are expected to include padding for alignment.
+        */
+        struct BlasDesc
+        {
+            uint64_t resultByteSize = 0;        ///< Maximum result data size for the BLAS build.
+            uint64_t scratchByteSize = 0;       ///< Maximum scratch data size for the BLAS build or update.
+            bool isDynamic = false;             ///< True if the BLAS is updated or rebuilt after the initial build.
+            bool useCompaction = false;         ///< True if the BLAS is compacted after the build.
+        };
+
+        enum class GroupType : uint32_t
+        {
+            StaticCompacted,
+            Static,
+            Dynamic,
+        };
+
+        struct Group
+        {
+            GroupType type = GroupType::Static;
+            std::vector<uint32_t> blasIndices;  ///< Indices of the BLASes in the group, in ascending order.
+            uint64_t resultByteSize = 0;        ///< Result data size for all BLASes in the group.
+            uint64_t scratchByteSize = 0;       ///< Scratch data size for all BLASes in the group.
+        };
+
+        /** Location of a BLAS in the plan.
+        */
+        struct Placement
+        {
+            uint32_t groupIndex = 0;            ///< Index of the group containing the BLAS.
+            uint64_t resultByteOffset = 0;      ///< Offset into the result buffer.
+            uint64_t scratchByteOffset = 0;     ///< Offset into the scratch buffer.
+        };
+
+        struct Plan
+        {
+            std::vector<Group> groups;          ///< Groups ordered by type.
+            std::vector<Placement> placements;  ///< Placement per BLAS.
+
+            uint64_t resultBufferByteSize = 0;  ///< Size of the result buffer shared by all groups.
+            uint64_t scratchBufferByteSize = 0; ///< Size of the scratch buffer shared by all groups.
+            uint64_t retainedScratchByteSize = 0; ///< Size of the scratch buffer needed for updates after the build, zero if there are no dynamic BLASes.
+            uint64_t peakBuildMemory = 0;       ///< Peak memory of the intermediate build buffers (result + scratch).
+            uint32_t submitCount = 0;           ///< Number of GPU submits. Each group waits for the readback of its final BLAS sizes.
+        };
+
+        /** Create a plan.
+            \param[in] blases Build requirements per BLAS.
+            \param[in] memoryBudget Target for the result + scratch size of a group. BLASes larger than the budget are placed in groups of their own.
+            \return The plan.
+        */
+        static Plan plan(const std::vector<BlasDesc>& blases, uint64_t memoryBudget);
+
+        /** Get the type of group a BLAS is placed in.
+        */
+        static GroupType getGroupType(const BlasDesc& blas);
+    };
+}
@@ -33,6 +33,7 @@
 #include "Core/Program/ProgramVars.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Color/ColorHelpers.slang"
 #include "Utils/Scripting/ScriptBindings.h"
 
@@ -608,6 +609,41 @@ namespace Falcor
         return true;
     }
 
+    uint64_t BasicMaterial::computeHash() const
+    {
+        // Hash the fields compared by operator==. Samplers are only compared.
+        FNVHash64 hash;
+        uint64_t baseHash = computeBaseHash();
+        hash.insert(&baseHash, sizeof(baseHash));
+        hash.insert(&mData.flags, sizeof(mData.flags));
+
+        // Floats are hashed by value so that values that compare equal (0 and -0) have the same hash.
+        auto hashFloat = [&hash](float value)
+        {
+            if (value == 0.f) value = 0.f;
+            hash.insert(&value, sizeof(value));
+        };
+
+#define hash_field(_a) hashFloat((float)mData._a)
+#define hash_vec_field(_a) for (int i = 0; i < mData._a.length(); i++) hashFloat((float)mData._a[i])
+        hash_field(displacementScale);
+        hash_field(displacementOffset);
+        hash_vec_field(baseColor);
+        hash_vec_field(specular);
+        hash_vec_field(emissive);
+        hash_field(emissiveFactor);
+        hash_field(diffuseTransmission);
+        hash_field(specularTransmission);
+        hash_vec_field(transmission);
+        hash_vec_field(volumeAbsorption);
+        hash_field(volumeAnisotropy);
+        hash_vec_field(volumeScattering);
+#undef hash_field
+#undef hash_vec_field
+
+        return hash.get();
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
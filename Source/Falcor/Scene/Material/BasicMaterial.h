@@ -66,6 +66,10 @@ namespace Falcor
         */
         bool isEqual(const ref<Material>& pOther) const override;
 
+        /** Compute a hash of the material properties *except* the name.
+        */
+        uint64_t computeHash() const override;
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
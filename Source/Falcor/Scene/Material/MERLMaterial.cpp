@@ -28,6 +28,7 @@
 #include "MERLMaterial.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
 #include "Scene/Material/MERLFile.h"
@@ -145,6 +146,16 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        uint64_t baseHash = computeBaseHash();
+        hash.insert(&baseHash, sizeof(baseHash));
+        const std::string path = mPath.string();
+        hash.insert(path.data(), path.size());
+        return hash.get();
+    }
+
     Program::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -28,6 +28,7 @@
 #include "MERLMixMaterial.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/BufferAllocator.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
@@ -235,6 +236,21 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMixMaterial::computeHash() const
+    {
+        // Hash the list of loaded BRDFs. Samplers are only compared.
+        FNVHash64 hash;
+        uint64_t baseHash = computeBaseHash();
+        hash.insert(&baseHash, sizeof(baseHash));
+        for (const auto& brdf : mBRDFs)
+        {
+            const std::string path = brdf.path.string();
+            hash.insert(brdf.name.data(), brdf.name.size());
+            hash.insert(path.data(), path.size());
+        }
+        return hash.get();
+    }
+
     Program::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
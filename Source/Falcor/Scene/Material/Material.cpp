@@ -30,6 +30,7 @@
 #include "MaterialSystem.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Rendering/Materials/LobeType.slang"
 
@@ -318,6 +319,31 @@ namespace Falcor
         return true;
     }
 
+    uint64_t Material::computeBaseHash() const
+    {
+        // This function hashes the data in the base class that is compared by isBaseEqual().
+        // Textures are hashed by source path and dimensions rather than by pointer to keep the hash stable between runs.
+        FNVHash64 hash;
+        hash.insert(&mHeader.packedData, sizeof(mHeader.packedData));
+
+        for (size_t i = 0; i < mTextureSlotData.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            bool hasTexture = hasTextureSlot(slot) && mTextureSlotData[i].pTexture;
+            hash.insert(&hasTexture, sizeof(hasTexture));
+            if (hasTexture)
+            {
+                const auto& pTexture = mTextureSlotData[i].pTexture;
+                const std::string path = pTexture->getSourcePath().string();
+                const uint32_t desc[] = { pTexture->getWidth(), pTexture->getHeight(), pTexture->getDepth(), (uint32_t)pTexture->getFormat() };
+                hash.insert(path.data(), path.size());
+                hash.insert(desc, sizeof(desc));
+            }
+        }
+
+        return hash.get();
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
@@ -155,6 +155,13 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material properties *except* the name.
+            Materials that are equal according to isEqual() have the same hash, so the hash can be used to find candidate duplicates.
+            The hash only depends on the material properties and is stable between runs.
+            \return 64-bit hash.
+        */
+        virtual uint64_t computeHash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -338,6 +345,7 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
+        uint64_t computeBaseHash() const;
 
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
@@ -30,8 +30,14 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Threading.h"
+#include "Utils/Algorithm/UniqueItems.h"
+#include "Utils/Math/FNVHash.h"
 #include "MaterialTypeRegistry.h"
+#include <algorithm>
 #include <numeric>
+#include <set>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -58,6 +64,27 @@ namespace Falcor
             }
             return false;
         }
+
+        // Helpers to find textures that were loaded from the same file more than once.
+        // Textures are considered identical if they are the same object or were loaded from the same file with the same layout and format.
+        uint64_t computeTextureHash(const ref<Texture>& pTexture)
+        {
+            FNVHash64 hash;
+            const std::string path = pTexture->getSourcePath().string();
+            const uint32_t desc[] = { pTexture->getWidth(), pTexture->getHeight(), pTexture->getDepth(), pTexture->getArraySize(), pTexture->getMipCount(), (uint32_t)pTexture->getFormat() };
+            hash.insert(path.data(), path.size());
+            hash.insert(desc, sizeof(desc));
+            return hash.get();
+        }
+
+        bool isSameTexture(const ref<Texture>& pA, const ref<Texture>& pB)
+        {
+            if (pA == pB) return true;
+            if (pA->getSourcePath().empty() || pA->getSourcePath() != pB->getSourcePath()) return false;
+            return pA->getType() == pB->getType() &&
+                pA->getWidth() == pB->getWidth() && pA->getHeight() == pB->getHeight() && pA->getDepth() == pB->getDepth() &&
+                pA->getArraySize() == pB->getArraySize() && pA->getMipCount() == pB->getMipCount() && pA->getFormat() == pB->getFormat();
+        }
     }
 
     MaterialSystem::MaterialSystem(ref<Device> pDevice)
@@ -302,23 +329,28 @@ namespace Falcor
 
     size_t MaterialSystem::removeDuplicateMaterials(std::vector<MaterialID>& idMap)
     {
-        std::vector<ref<Material>> uniqueMaterials;
-        idMap.resize(mMaterials.size());
+        // Hash all materials in parallel. Only materials with identical hashes are compared.
+        std::vector<uint64_t> hashes(mMaterials.size());
+        Threading::parallelFor(0, mMaterials.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) hashes[i] = mMaterials[i]->computeHash();
+        }, 256);
 
         // Find unique set of materials.
-        for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
+        std::vector<size_t> uniqueMap;
+        auto uniqueIndices = findUniqueItems(hashes, [&](size_t uniqueIndex, size_t index) { return mMaterials[uniqueIndex]->isEqual(mMaterials[index]); }, uniqueMap);
+
+        std::vector<ref<Material>> uniqueMaterials;
+        uniqueMaterials.reserve(uniqueIndices.size());
+        for (size_t index : uniqueIndices) uniqueMaterials.push_back(mMaterials[index]);
+
+        idMap.resize(mMaterials.size());
+        for (size_t i = 0; i < mMaterials.size(); i++)
         {
-            const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            idMap[i] = MaterialID{ uniqueMap[i] };
+            if (uniqueIndices[uniqueMap[i]] != i)
             {
-                idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
-                uniqueMaterials.push_back(pMaterial);
-            }
-            else
-            {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", mMaterials[i]->getName(), uniqueMaterials[uniqueMap[i]]->getName());
             }
         }
 
@@ -327,6 +359,14 @@ namespace Falcor
         {
             mMaterials = uniqueMaterials;
             mMaterialsChanged = true;
+
+            // Remap the materials in use to the remaining materials.
+            if (mMaterialsInUse)
+            {
+                std::set<MaterialID> materialsInUse;
+                for (const auto& materialID : *mMaterialsInUse) materialsInUse.insert(idMap[materialID.get()]);
+                mMaterialsInUse = std::vector<MaterialID>(materialsInUse.begin(), materialsInUse.end());
+            }
         }
 
         return removed;
@@ -356,6 +396,31 @@ namespace Falcor
 
         if (textures.empty()) return;
 
+        // Find the unique textures. Slots referencing a texture that was loaded from the same file more than once
+        // are rebound to a single texture object, and each unique texture is only analyzed once.
+        std::vector<uint64_t> textureHashes(textures.size());
+        for (size_t i = 0; i < textures.size(); i++) textureHashes[i] = computeTextureHash(textures[i]);
+
+        std::vector<size_t> uniqueMap;
+        auto uniqueIndices = findUniqueItems(textureHashes, [&](size_t uniqueIndex, size_t index) { return isSameTexture(textures[uniqueIndex], textures[index]); }, uniqueMap);
+
+        std::set<Texture*> replacedTextures;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            const auto& pUniqueTexture = textures[uniqueIndices[uniqueMap[i]]];
+            if (textures[i] != pUniqueTexture)
+            {
+                replacedTextures.insert(textures[i].get());
+                materialSlots[i].first->setTexture(materialSlots[i].second, pUniqueTexture);
+            }
+        }
+        if (!replacedTextures.empty()) logInfo("Optimized materials by removing {} duplicate textures.", replacedTextures.size());
+
+        std::vector<ref<Texture>> uniqueTextures;
+        uniqueTextures.reserve(uniqueIndices.size());
+        for (size_t index : uniqueIndices) uniqueTextures.push_back(textures[index]);
+        textures = std::move(uniqueTextures);
+
         // Analyze the textures.
         logInfo("Analyzing {} material textures.", textures.size());
 
@@ -378,9 +443,9 @@ namespace Falcor
         const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
         Material::TextureOptimizationStats stats = {};
 
-        for (size_t i = 0; i < textures.size(); i++)
+        for (size_t i = 0; i < materialSlots.size(); i++)
         {
-            materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
+            materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[uniqueMap[i]], stats);
         }
 
         pResultsStaging->unmap();
@@ -404,6 +469,9 @@ namespace Falcor
     {
         Material::UpdateFlags flags = Material::UpdateFlags::None;
 
+        // The textures in use depend on the materials and their texture slots.
+        if (forceUpdate || mMaterialsChanged || mMaterialUpdates != Material::UpdateFlags::None) mUsedTexturesChanged = true;
+
         // If materials were added/removed since last update, we update all metadata
         // and trigger re-creation of the parameter block.
         if (forceUpdate || mMaterialsChanged)
@@ -417,6 +485,15 @@ namespace Falcor
 
         mMaterialsUpdateFlags.resize(mMaterials.size());
 
+        // Textures of the materials in use are rendered every frame. Mark them as used so that they are reduced only if
+        // the budget can't be met otherwise, and streamed back in once they fit.
+        if (mUsedTexturesChanged) updateUsedTextureHandles();
+        for (const auto& handle : mUsedTextureHandles) mpTextureManager->markTextureUsed(handle);
+
+        // Apply texture residency changes. Materials referencing replaced textures are switched to the new
+        // texture objects, which marks them for update below and releases the old textures.
+        replaceTextures(mpTextureManager->updateResidency());
+
         // Update all materials.
         if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
         {
@@ -531,6 +608,73 @@ namespace Falcor
         return flags;
     }
 
+    void MaterialSystem::setMaterialsInUse(const std::vector<MaterialID>& materialIDs)
+    {
+        for (const auto& materialID : materialIDs)
+        {
+            checkArgument(materialID.get() < mMaterials.size(), "MaterialID is out of range.");
+        }
+        mMaterialsInUse = materialIDs;
+        mUsedTexturesChanged = true;
+    }
+
+    void MaterialSystem::updateUsedTextureHandles()
+    {
+        mUsedTextureHandles.clear();
+
+        auto addMaterialTextures = [&](const Material& material)
+        {
+            for (uint32_t i = 0; i < (uint32_t)Material::TextureSlot::Count; i++)
+            {
+                // Replaced texture objects keep their handle, so the list stays valid across residency updates.
+                if (auto pTexture = material.getTexture((Material::TextureSlot)i))
+                {
+                    mUsedTextureHandles.push_back(mpTextureManager->addTexture(pTexture));
+                }
+            }
+        };
+
+        if (mMaterialsInUse)
+        {
+            for (const auto& materialID : *mMaterialsInUse) addMaterialTextures(*mMaterials[materialID.get()]);
+        }
+        else
+        {
+            for (const auto& pMaterial : mMaterials) addMaterialTextures(*pMaterial);
+        }
+
+        std::sort(mUsedTextureHandles.begin(), mUsedTextureHandles.end(), [](const auto& lhs, const auto& rhs) { return lhs.getID() < rhs.getID(); });
+        mUsedTextureHandles.erase(std::unique(mUsedTextureHandles.begin(), mUsedTextureHandles.end()), mUsedTextureHandles.end());
+        mUsedTexturesChanged = false;
+    }
+
+    void MaterialSystem::replaceTextures(const std::vector<TextureManager::TextureReplacement>& replacements)
+    {
+        if (replacements.empty()) return;
+
+        // A texture can be replaced more than once per update (e.g. reloaded and then reduced again), so follow the chain.
+        std::unordered_map<const Texture*, ref<Texture>> replacementMap;
+        for (const auto& r : replacements) replacementMap[r.pOldTexture.get()] = r.pNewTexture;
+
+        for (const auto& pMaterial : mMaterials)
+        {
+            for (uint32_t i = 0; i < (uint32_t)Material::TextureSlot::Count; i++)
+            {
+                auto slot = (Material::TextureSlot)i;
+                auto pTexture = pMaterial->getTexture(slot);
+                if (!pTexture) continue;
+
+                bool replaced = false;
+                for (auto it = replacementMap.find(pTexture.get()); it != replacementMap.end(); it = replacementMap.find(pTexture.get()))
+                {
+                    pTexture = it->second;
+                    replaced = true;
+                }
+                if (replaced) pMaterial->setTexture(slot, pTexture);
+            }
+        }
+    }
+
     void MaterialSystem::updateMetadata()
     {
         mTextureDescCount = 0;
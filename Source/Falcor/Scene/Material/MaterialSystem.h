@@ -37,6 +37,7 @@
 #include "Utils/Image/TextureManager.h"
 #include "Utils/UI/Gui.h"
 #include <memory>
+#include <optional>
 #include <vector>
 #include <set>
 
@@ -225,12 +226,21 @@ namespace Falcor
         */
         TextureManager& getTextureManager() { return *mpTextureManager; }
 
+        /** Set the materials in use for rendering.
+            The textures of materials in use are marked as used in every update. They are reduced to stay within the
+            texture residency budget only after all textures not in use. By default all materials are in use.
+            \param[in] materialIDs IDs of the materials in use.
+        */
+        void setMaterialsInUse(const std::vector<MaterialID>& materialIDs);
+
 
     private:
         void updateMetadata();
         void updateUI();
         void createParameterBlock();
         void uploadMaterial(const uint32_t materialID);
+        void replaceTextures(const std::vector<TextureManager::TextureReplacement>& replacements);
+        void updateUsedTextureHandles();
 
         ref<Device> mpDevice;
 
@@ -256,6 +266,11 @@ namespace Falcor
 
         Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
 
+        // Texture residency
+        std::optional<std::vector<MaterialID>> mMaterialsInUse;     ///< IDs of the materials in use, or all materials if not set.
+        std::vector<TextureManager::TextureHandle> mUsedTextureHandles; ///< Handles of the textures of all materials in use.
+        bool mUsedTexturesChanged = true;                           ///< Flag indicating if the materials in use changed since last update.
+
         // GPU resources
         ref<GpuFence> mpFence;
         ref<ParameterBlock> mpMaterialsBlock;                       ///< Parameter block for binding all material resources.
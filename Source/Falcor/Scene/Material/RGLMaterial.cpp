@@ -30,6 +30,7 @@
 #include "RGLCommon.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
@@ -133,6 +134,16 @@ namespace Falcor
         return true;
     }
 
+    uint64_t RGLMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        uint64_t baseHash = computeBaseHash();
+        hash.insert(&baseHash, sizeof(baseHash));
+        const std::string path = mFilePath.string();
+        hash.insert(path.data(), path.size());
+        return hash.get();
+    }
+
     Program::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
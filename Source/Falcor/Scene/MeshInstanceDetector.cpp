@@ -0,0 +1,233 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshInstanceDetector.h"
+#include "Core/Assert.h"
+#include "Utils/Threading.h"
+#include "Utils/Algorithm/UniqueItems.h"
+#include "Utils/Math/FNVHash.h"
+#include "Utils/Math/Vector.h"
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        /// Maximum length of the difference of two unit vectors (normals, tangents) that are considered equal (about 0.06 degrees).
+        const float kDirectionTolerance = 1e-3f;
+
+        /// Number of mantissa bits of the RMS radius used in the fingerprint. Meshes whose radii differ by more than the
+        /// quantization step are never compared, which is far coarser than the tolerance of the final comparison.
+        const uint32_t kRadiusMantissaBits = 6;
+
+        /** Per-mesh data computed once for matching.
+            The reference frame is spanned by two vertices: the vertex farthest from the centroid and the vertex that
+            maximizes the area of the triangle with the centroid and the first vertex.
+        */
+        struct MeshInfo
+        {
+            uint64_t fingerprint = 0;
+            float3 centroid = float3(0.f);
+            float radius = 0.f;             ///< Maximum distance of a vertex from the centroid.
+            uint32_t frameVertex0 = 0;
+            uint32_t frameVertex1 = 0;
+            bool hasFrame = false;          ///< False if all vertices are collinear (only translations are detected).
+        };
+
+        MeshInfo computeMeshInfo(const MeshInstanceDetector::MeshDesc& mesh)
+        {
+            MeshInfo info;
+
+            double sum[3] = {};
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                for (int j = 0; j < 3; j++) sum[j] += mesh.pVertices[i].position[j];
+            }
+            if (mesh.vertexCount > 0)
+            {
+                for (int j = 0; j < 3; j++) info.centroid[j] = (float)(sum[j] / mesh.vertexCount);
+            }
+
+            double sumSquaredDistance = 0.0;
+            float maxSquaredDistance = -1.f;
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const float3 v = mesh.pVertices[i].position - info.centroid;
+                const float d = dot(v, v);
+                sumSquaredDistance += d;
+                if (d > maxSquaredDistance)
+                {
+                    maxSquaredDistance = d;
+                    info.frameVertex0 = i;
+                }
+            }
+            info.radius = std::sqrt(std::max(maxSquaredDistance, 0.f));
+
+            if (mesh.vertexCount > 0)
+            {
+                const float3 a = mesh.pVertices[info.frameVertex0].position - info.centroid;
+                float maxArea = 0.f;
+                for (uint32_t i = 0; i < mesh.vertexCount; i++)
+                {
+                    float area = length(cross(a, mesh.pVertices[i].position - info.centroid));
+                    if (area > maxArea)
+                    {
+                        maxArea = area;
+                        info.frameVertex1 = i;
+                    }
+                }
+                info.hasFrame = maxArea > 1e-3f * info.radius * info.radius;
+            }
+
+            // Fingerprint of all data that is invariant under rigid transforms.
+            FNVHash64 hash;
+            auto insert = [&hash](const auto& value) { hash.insert(&value, sizeof(value)); };
+            insert(mesh.materialID);
+            insert(mesh.topology);
+            insert(mesh.isFrontFaceCW);
+            insert(mesh.use16BitIndices);
+            insert(mesh.indexCount);
+            insert(mesh.vertexCount);
+            hash.insert(mesh.pIndexData, mesh.indexDataSize * sizeof(uint32_t));
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                insert(mesh.pVertices[i].texCrd);
+                insert(mesh.pVertices[i].tangent.w);
+            }
+            float rmsRadius = mesh.vertexCount > 0 ? (float)std::sqrt(sumSquaredDistance / mesh.vertexCount) : 0.f;
+            uint32_t quantizedRadius;
+            std::memcpy(&quantizedRadius, &rmsRadius, sizeof(rmsRadius));
+            quantizedRadius >>= 23 - kRadiusMantissaBits;
+            insert(quantizedRadius);
+            info.fingerprint = hash.get();
+
+            return info;
+        }
+
+        /** Build an orthonormal frame (as matrix columns) from two non-collinear vectors.
+        */
+        float3x3 buildFrame(const float3& a, const float3& b)
+        {
+            float3 e0 = normalize(a);
+            float3 e1 = normalize(b - dot(b, e0) * e0);
+            float3 e2 = cross(e0, e1);
+            return float3x3({ e0.x, e1.x, e2.x, e0.y, e1.y, e2.y, e0.z, e1.z, e2.z });
+        }
+
+        /** Try to find a rigid transform that maps the reference mesh onto the mesh.
+        */
+        bool matchMesh(const MeshInstanceDetector::MeshDesc& ref, const MeshInfo& refInfo, const MeshInstanceDetector::MeshDesc& mesh, const MeshInfo& meshInfo, float tolerance, float4x4& transform)
+        {
+            // Compare the data that is invariant under rigid transforms. Only needed to resolve fingerprint collisions.
+            if (ref.materialID != mesh.materialID || ref.topology != mesh.topology || ref.isFrontFaceCW != mesh.isFrontFaceCW) return false;
+            if (ref.use16BitIndices != mesh.use16BitIndices || ref.indexCount != mesh.indexCount || ref.vertexCount != mesh.vertexCount) return false;
+            if (ref.indexDataSize != mesh.indexDataSize) return false;
+            if (ref.indexDataSize > 0 && std::memcmp(ref.pIndexData, mesh.pIndexData, ref.indexDataSize * sizeof(uint32_t)) != 0) return false;
+
+            // Identical meshes are the common case.
+            if (ref.vertexCount > 0 && std::memcmp(ref.pVertices, mesh.pVertices, ref.vertexCount * sizeof(StaticVertexData)) == 0)
+            {
+                transform = float4x4::identity();
+                return true;
+            }
+
+            // Compute the rotation from the reference frames. Without a frame (degenerate mesh) only translations are detected.
+            float3x3 rotation = float3x3::identity();
+            if (refInfo.hasFrame)
+            {
+                auto frameVectors = [](const MeshInstanceDetector::MeshDesc& m, const MeshInfo& info, const MeshInfo& refInfo)
+                {
+                    return std::make_pair(m.pVertices[refInfo.frameVertex0].position - info.centroid, m.pVertices[refInfo.frameVertex1].position - info.centroid);
+                };
+                auto [refA, refB] = frameVectors(ref, refInfo, refInfo);
+                auto [meshA, meshB] = frameVectors(mesh, meshInfo, refInfo);
+                if (length(cross(meshA, meshB)) <= 0.f) return false;
+                rotation = mul(buildFrame(meshA, meshB), transpose(buildFrame(refA, refB)));
+            }
+            const float3 translation = meshInfo.centroid - transformVector(rotation, refInfo.centroid);
+
+            // Verify all vertices.
+            const float positionTolerance = tolerance * std::max(refInfo.radius, meshInfo.radius);
+            for (uint32_t i = 0; i < ref.vertexCount; i++)
+            {
+                const auto& r = ref.pVertices[i];
+                const auto& v = mesh.pVertices[i];
+                if (any(r.texCrd != v.texCrd) || r.tangent.w != v.tangent.w) return false;
+                if (std::abs(r.curveRadius - v.curveRadius) > positionTolerance) return false;
+                if (length(transformVector(rotation, r.position) + translation - v.position) > positionTolerance) return false;
+                if (length(transformVector(rotation, r.normal) - v.normal) > kDirectionTolerance) return false;
+                if (r.tangent.w != 0.f && length(transformVector(rotation, r.tangent.xyz()) - v.tangent.xyz()) > kDirectionTolerance) return false;
+            }
+
+            transform = float4x4(rotation);
+            transform[0][3] = translation.x;
+            transform[1][3] = translation.y;
+            transform[2][3] = translation.z;
+            return true;
+        }
+    }
+
+    std::vector<MeshInstanceDetector::Match> MeshInstanceDetector::findInstances(const std::vector<MeshDesc>& meshes, float tolerance)
+    {
+        // Skipped meshes are left out of the bucketing altogether, so they can neither match nor be matched.
+        std::vector<size_t> candidates;
+        candidates.reserve(meshes.size());
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            if (!meshes[i].skip) candidates.push_back(i);
+        }
+
+        std::vector<MeshInfo> infos(meshes.size());
+        Threading::parallelFor(0, candidates.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) infos[candidates[i]] = computeMeshInfo(meshes[candidates[i]]);
+        }, 1);
+
+        std::vector<uint64_t> fingerprints(candidates.size());
+        for (size_t i = 0; i < candidates.size(); i++) fingerprints[i] = infos[candidates[i]].fingerprint;
+
+        // Meshes are compared in order, so the transform of the last successful comparison belongs to the matched mesh.
+        std::vector<Match> matches(meshes.size());
+        std::vector<size_t> uniqueMap;
+        auto uniqueItems = findUniqueItems(fingerprints, [&](size_t refItem, size_t item)
+        {
+            const size_t refIndex = candidates[refItem];
+            const size_t index = candidates[item];
+            return matchMesh(meshes[refIndex], infos[refIndex], meshes[index], infos[index], tolerance, matches[index].transform);
+        }, uniqueMap);
+
+        for (size_t i = 0; i < meshes.size(); i++) matches[i].meshIndex = (uint32_t)i;
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            auto& match = matches[candidates[i]];
+            match.meshIndex = (uint32_t)candidates[uniqueItems[uniqueMap[i]]];
+            if (match.meshIndex == candidates[i]) match.transform = float4x4::identity();
+        }
+
+        return matches;
+    }
+}
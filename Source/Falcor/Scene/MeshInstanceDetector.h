@@ -0,0 +1,84 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SceneTypes.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/Matrix.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Detects meshes that are identical up to a rigid transform (rotation and translation).
+
+        Meshes are fingerprinted by hashing their material, index data, texture coordinates and a coarsely quantized
+        rigid-invariant measure of their size. Only meshes with the same fingerprint are compared. Two meshes match if
+        there is a rigid transform that maps the vertices of one mesh onto the vertices of the other, vertex by vertex,
+        within the given tolerance. The transform is computed from two reference vertices and verified on all vertices.
+
+        The detector only operates on CPU vertex data and has no GPU dependencies.
+    */
+    class FALCOR_API MeshInstanceDetector
+    {
+    public:
+        static constexpr float kDefaultTolerance = 1e-5f;
+
+        /** Mesh data. All pointers must stay valid while the detector runs.
+        */
+        struct MeshDesc
+        {
+            uint32_t materialID = 0;                    ///< Material ID. Only meshes with the same material can match.
+            uint32_t topology = 0;                      ///< Primitive topology. Only meshes with the same topology can match.
+            bool isFrontFaceCW = false;                 ///< Winding order. Only meshes with the same winding order can match.
+            bool use16BitIndices = false;               ///< True if the index data is in 16-bit format.
+            uint32_t indexCount = 0;                    ///< Number of indices, or zero if non-indexed.
+            const uint32_t* pIndexData = nullptr;       ///< Packed index data.
+            size_t indexDataSize = 0;                   ///< Size of the packed index data in 32-bit words.
+            const StaticVertexData* pVertices = nullptr;///< Vertex data.
+            uint32_t vertexCount = 0;                   ///< Number of vertices.
+            bool skip = false;                          ///< True if the mesh is excluded from matching. Skipped meshes are always unique and never referenced by other meshes.
+        };
+
+        /** Result for a single mesh.
+        */
+        struct Match
+        {
+            uint32_t meshIndex = 0;                     ///< Index of the mesh this mesh is an instance of. Unique meshes refer to themselves.
+            float4x4 transform = float4x4::identity();  ///< Rigid transform from the object space of the matched mesh to the object space of this mesh.
+        };
+
+        /** Find meshes that are instances of other meshes.
+            Each mesh is matched against the unique meshes preceding it, so the first occurrence of a mesh is always the unique one.
+            Meshes with the skip flag set are not compared and map to themselves.
+            \param[in] meshes List of meshes.
+            \param[in] tolerance Maximum position error relative to the mesh size. Directions (normals, tangents) are compared with a fixed angular tolerance.
+            \return List of matches, one per mesh.
+        */
+        static std::vector<Match> findInstances(const std::vector<MeshDesc>& meshes, float tolerance = kDefaultTolerance);
+    };
+}
@@ -0,0 +1,586 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PLYReader.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/FileDependencies.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+#include <fast_float/fast_float.h>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        enum class Format
+        {
+            Ascii,
+            BinaryLittleEndian,
+            BinaryBigEndian,
+        };
+
+        enum class Type
+        {
+            Int8,
+            UInt8,
+            Int16,
+            UInt16,
+            Int32,
+            UInt32,
+            Float32,
+            Float64,
+        };
+
+        struct Property
+        {
+            std::string name;
+            Type type = Type::Float32;
+            bool isList = false;
+            Type countType = Type::UInt8;
+        };
+
+        struct Element
+        {
+            std::string name;
+            size_t count = 0;
+            std::vector<Property> properties;
+
+            std::optional<size_t> findProperty(std::initializer_list<std::string_view> names) const
+            {
+                for (auto name : names)
+                {
+                    for (size_t i = 0; i < properties.size(); ++i)
+                        if (properties[i].name == name) return i;
+                }
+                return {};
+            }
+        };
+
+        struct Header
+        {
+            Format format = Format::Ascii;
+            std::vector<Element> elements;
+            size_t dataOffset = 0;
+        };
+
+        size_t getTypeSize(Type type)
+        {
+            switch (type)
+            {
+            case Type::Int8: case Type::UInt8: return 1;
+            case Type::Int16: case Type::UInt16: return 2;
+            case Type::Int32: case Type::UInt32: case Type::Float32: return 4;
+            case Type::Float64: return 8;
+            }
+            FALCOR_UNREACHABLE();
+            return 0;
+        }
+
+        Type parseType(std::string_view name)
+        {
+            if (name == "char" || name == "int8") return Type::Int8;
+            if (name == "uchar" || name == "uint8") return Type::UInt8;
+            if (name == "short" || name == "int16") return Type::Int16;
+            if (name == "ushort" || name == "uint16") return Type::UInt16;
+            if (name == "int" || name == "int32") return Type::Int32;
+            if (name == "uint" || name == "uint32") return Type::UInt32;
+            if (name == "float" || name == "float32") return Type::Float32;
+            if (name == "double" || name == "float64") return Type::Float64;
+            throw RuntimeError("Unknown property type '{}'.", name);
+        }
+
+        std::vector<std::string_view> splitWhitespace(std::string_view line)
+        {
+            std::vector<std::string_view> tokens;
+            size_t pos = 0;
+            while (pos < line.size())
+            {
+                while (pos < line.size() && std::isspace((unsigned char)line[pos])) ++pos;
+                size_t start = pos;
+                while (pos < line.size() && !std::isspace((unsigned char)line[pos])) ++pos;
+                if (pos > start) tokens.push_back(line.substr(start, pos - start));
+            }
+            return tokens;
+        }
+
+        size_t parseCount(std::string_view str)
+        {
+            size_t value = 0;
+            auto result = std::from_chars(str.data(), str.data() + str.size(), value);
+            if (result.ec != std::errc() || result.ptr != str.data() + str.size()) throw RuntimeError("Invalid element count '{}'.", str);
+            return value;
+        }
+
+        Header parseHeader(std::string_view data)
+        {
+            Header header;
+            size_t pos = 0;
+
+            auto nextLine = [&]() -> std::optional<std::string_view>
+            {
+                if (pos >= data.size()) return {};
+                size_t end = data.find('\n', pos);
+                if (end == std::string_view::npos) end = data.size();
+                std::string_view line = data.substr(pos, end - pos);
+                pos = end + 1;
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                return line;
+            };
+
+            auto magic = nextLine();
+            if (!magic || *magic != "ply") throw RuntimeError("Missing 'ply' magic number.");
+
+            bool hasFormat = false;
+            while (auto line = nextLine())
+            {
+                auto tokens = splitWhitespace(*line);
+                if (tokens.empty()) continue;
+                const auto& keyword = tokens[0];
+
+                if (keyword == "format")
+                {
+                    if (tokens.size() < 2) throw RuntimeError("Invalid format line.");
+                    if (tokens[1] == "ascii") header.format = Format::Ascii;
+                    else if (tokens[1] == "binary_little_endian") header.format = Format::BinaryLittleEndian;
+                    else if (tokens[1] == "binary_big_endian") header.format = Format::BinaryBigEndian;
+                    else throw RuntimeError("Unknown format '{}'.", tokens[1]);
+                    hasFormat = true;
+                }
+                else if (keyword == "comment" || keyword == "obj_info")
+                {
+                    continue;
+                }
+                else if (keyword == "element")
+                {
+                    if (tokens.size() != 3) throw RuntimeError("Invalid element line.");
+                    header.elements.push_back({std::string(tokens[1]), parseCount(tokens[2]), {}});
+                }
+                else if (keyword == "property")
+                {
+                    if (header.elements.empty()) throw RuntimeError("Property defined outside of an element.");
+                    Property property;
+                    if (tokens.size() == 5 && tokens[1] == "list")
+                    {
+                        property.isList = true;
+                        property.countType = parseType(tokens[2]);
+                        property.type = parseType(tokens[3]);
+                        property.name = tokens[4];
+                    }
+                    else if (tokens.size() == 3)
+                    {
+                        property.type = parseType(tokens[1]);
+                        property.name = tokens[2];
+                    }
+                    else
+                    {
+                        throw RuntimeError("Invalid property line.");
+                    }
+                    header.elements.back().properties.push_back(std::move(property));
+                }
+                else if (keyword == "end_header")
+                {
+                    if (!hasFormat) throw RuntimeError("Missing format line.");
+                    header.dataOffset = std::min(pos, data.size());
+                    return header;
+                }
+                else
+                {
+                    throw RuntimeError("Unknown header keyword '{}'.", keyword);
+                }
+            }
+
+            throw RuntimeError("Missing 'end_header'.");
+        }
+
+        template<typename T>
+        T load(const uint8_t* p, bool swap)
+        {
+            T value;
+            if (!swap)
+            {
+                std::memcpy(&value, p, sizeof(T));
+            }
+            else
+            {
+                uint8_t bytes[sizeof(T)];
+                for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = p[sizeof(T) - 1 - i];
+                std::memcpy(&value, bytes, sizeof(T));
+            }
+            return value;
+        }
+
+        double loadValue(const uint8_t* p, Type type, bool swap)
+        {
+            switch (type)
+            {
+            case Type::Int8: return load<int8_t>(p, swap);
+            case Type::UInt8: return load<uint8_t>(p, swap);
+            case Type::Int16: return load<int16_t>(p, swap);
+            case Type::UInt16: return load<uint16_t>(p, swap);
+            case Type::Int32: return load<int32_t>(p, swap);
+            case Type::UInt32: return load<uint32_t>(p, swap);
+            case Type::Float32: return load<float>(p, swap);
+            case Type::Float64: return load<double>(p, swap);
+            }
+            FALCOR_UNREACHABLE();
+            return 0.0;
+        }
+
+        /** Reads values from binary PLY data.
+        */
+        class BinaryReader
+        {
+        public:
+            BinaryReader(const uint8_t* pData, size_t size, bool swap) : mpPos(pData), mpEnd(pData + size), mSwap(swap) {}
+
+            /** Consume a number of bytes and return a pointer to them.
+            */
+            const uint8_t* take(size_t size)
+            {
+                if ((size_t)(mpEnd - mpPos) < size) throw RuntimeError("Unexpected end of data.");
+                const uint8_t* p = mpPos;
+                mpPos += size;
+                return p;
+            }
+
+            double readValue(Type type) { return loadValue(take(getTypeSize(type)), type, mSwap); }
+            void skipValues(Type type, size_t count) { take(getTypeSize(type) * count); }
+            bool swap() const { return mSwap; }
+
+        private:
+            const uint8_t* mpPos;
+            const uint8_t* mpEnd;
+            bool mSwap;
+        };
+
+        /** Reads values from ASCII PLY data.
+        */
+        class AsciiReader
+        {
+        public:
+            AsciiReader(const uint8_t* pData, size_t size) : mpPos((const char*)pData), mpEnd((const char*)pData + size) {}
+
+            double readValue(Type type)
+            {
+                auto token = nextToken();
+                double value;
+                auto result = fast_float::from_chars(token.data(), token.data() + token.size(), value);
+                if (result.ec != std::errc() || result.ptr != token.data() + token.size()) throw RuntimeError("Invalid number '{}'.", token);
+                return value;
+            }
+
+            void skipValues(Type type, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i) nextToken();
+            }
+
+        private:
+            std::string_view nextToken()
+            {
+                while (mpPos < mpEnd && std::isspace((unsigned char)*mpPos)) ++mpPos;
+                if (mpPos == mpEnd) throw RuntimeError("Unexpected end of data.");
+                const char* start = mpPos;
+                while (mpPos < mpEnd && !std::isspace((unsigned char)*mpPos)) ++mpPos;
+                return std::string_view(start, mpPos - start);
+            }
+
+            const char* mpPos;
+            const char* mpEnd;
+        };
+
+        /** Maps the properties of the vertex element to vertex attributes.
+        */
+        struct VertexLayout
+        {
+            std::optional<size_t> position[3];
+            std::optional<size_t> normal[3];
+            std::optional<size_t> texCoord[2];
+            bool hasNormals = false;
+            bool hasTexCoords = false;
+
+            VertexLayout(const Element& element)
+            {
+                position[0] = element.findProperty({"x"});
+                position[1] = element.findProperty({"y"});
+                position[2] = element.findProperty({"z"});
+                if (!position[0] || !position[1] || !position[2]) throw RuntimeError("Vertex element is missing positions.");
+                normal[0] = element.findProperty({"nx"});
+                normal[1] = element.findProperty({"ny"});
+                normal[2] = element.findProperty({"nz"});
+                hasNormals = normal[0] && normal[1] && normal[2];
+                texCoord[0] = element.findProperty({"u", "s", "texture_u", "texture_s"});
+                texCoord[1] = element.findProperty({"v", "t", "texture_v", "texture_t"});
+                hasTexCoords = texCoord[0] && texCoord[1];
+
+                for (const auto& index : getUsedProperties())
+                {
+                    if (element.properties[index].isList) throw RuntimeError("Vertex property '{}' must not be a list.", element.properties[index].name);
+                }
+            }
+
+            std::vector<size_t> getUsedProperties() const
+            {
+                std::vector<size_t> used = {*position[0], *position[1], *position[2]};
+                if (hasNormals) used.insert(used.end(), {*normal[0], *normal[1], *normal[2]});
+                if (hasTexCoords) used.insert(used.end(), {*texCoord[0], *texCoord[1]});
+                return used;
+            }
+
+            /** Create a vertex from the property values. Texture coordinates are flipped to match TriangleMesh::createFromFile().
+            */
+            TriangleMesh::Vertex makeVertex(const float* values) const
+            {
+                TriangleMesh::Vertex vertex{};
+                vertex.position = float3(values[*position[0]], values[*position[1]], values[*position[2]]);
+                if (hasNormals) vertex.normal = float3(values[*normal[0]], values[*normal[1]], values[*normal[2]]);
+                if (hasTexCoords) vertex.texCoord = float2(values[*texCoord[0]], 1.f - values[*texCoord[1]]);
+                return vertex;
+            }
+        };
+
+        template<typename Reader>
+        void skipElement(Reader& reader, const Element& element)
+        {
+            for (size_t i = 0; i < element.count; ++i)
+            {
+                for (const auto& property : element.properties)
+                {
+                    size_t count = property.isList ? (size_t)reader.readValue(property.countType) : 1;
+                    reader.skipValues(property.type, count);
+                }
+            }
+        }
+
+        template<typename Reader>
+        void readVertices(Reader& reader, const Element& element, const VertexLayout& layout, TriangleMesh::VertexList& vertices)
+        {
+            std::vector<float> values(element.properties.size(), 0.f);
+            vertices.resize(element.count);
+            for (size_t i = 0; i < element.count; ++i)
+            {
+                for (size_t p = 0; p < element.properties.size(); ++p)
+                {
+                    const auto& property = element.properties[p];
+                    if (property.isList) reader.skipValues(property.type, (size_t)reader.readValue(property.countType));
+                    else values[p] = (float)reader.readValue(property.type);
+                }
+                vertices[i] = layout.makeVertex(values.data());
+            }
+        }
+
+        /** Fast path for binary vertex elements without list properties.
+            Only the used properties are loaded at precomputed offsets within the fixed size vertex records.
+        */
+        void readVertices(BinaryReader& reader, const Element& element, const VertexLayout& layout, TriangleMesh::VertexList& vertices)
+        {
+            size_t stride = 0;
+            std::vector<size_t> offsets(element.properties.size());
+            for (size_t p = 0; p < element.properties.size(); ++p)
+            {
+                if (element.properties[p].isList) return readVertices<BinaryReader>(reader, element, layout, vertices);
+                offsets[p] = stride;
+                stride += getTypeSize(element.properties[p].type);
+            }
+
+            if (element.count > 0 && stride > std::numeric_limits<size_t>::max() / element.count) throw RuntimeError("Too many vertices.");
+            const uint8_t* pData = reader.take(stride * element.count);
+            const auto used = layout.getUsedProperties();
+            std::vector<float> values(element.properties.size(), 0.f);
+            vertices.resize(element.count);
+            for (size_t i = 0; i < element.count; ++i)
+            {
+                const uint8_t* pVertex = pData + i * stride;
+                for (size_t p : used) values[p] = (float)loadValue(pVertex + offsets[p], element.properties[p].type, reader.swap());
+                vertices[i] = layout.makeVertex(values.data());
+            }
+        }
+
+        template<typename Reader>
+        void readFaces(Reader& reader, const Element& element, size_t vertexCount, TriangleMesh::IndexList& indices)
+        {
+            auto indicesProperty = element.findProperty({"vertex_indices", "vertex_index"});
+            if (!indicesProperty || !element.properties[*indicesProperty].isList) throw RuntimeError("Face element is missing vertex indices.");
+
+            indices.reserve(indices.size() + element.count * 3);
+            std::vector<uint32_t> polygon;
+            for (size_t i = 0; i < element.count; ++i)
+            {
+                for (size_t p = 0; p < element.properties.size(); ++p)
+                {
+                    const auto& property = element.properties[p];
+                    size_t count = property.isList ? (size_t)reader.readValue(property.countType) : 1;
+                    if (p != *indicesProperty)
+                    {
+                        reader.skipValues(property.type, count);
+                        continue;
+                    }
+
+                    polygon.resize(count);
+                    for (size_t j = 0; j < count; ++j)
+                    {
+                        double index = reader.readValue(property.type);
+                        if (index < 0.0 || index >= (double)vertexCount) throw RuntimeError("Vertex index {} is out of bounds.", index);
+                        polygon[j] = (uint32_t)index;
+                    }
+
+                    // Triangulate polygon as a fan. Faces with less than 3 vertices are ignored.
+                    for (size_t j = 1; j + 1 < count; ++j)
+                    {
+                        indices.push_back(polygon[0]);
+                        indices.push_back(polygon[j]);
+                        indices.push_back(polygon[j + 1]);
+                    }
+                }
+            }
+        }
+
+        template<typename Reader>
+        void readBody(Reader& reader, const Header& header, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices, bool& hasNormals)
+        {
+            bool hasVertices = false;
+            for (const auto& element : header.elements)
+            {
+                if (element.name == "vertex")
+                {
+                    if (hasVertices) throw RuntimeError("Multiple vertex elements.");
+                    VertexLayout layout(element);
+                    readVertices(reader, element, layout, vertices);
+                    hasNormals = layout.hasNormals;
+                    hasVertices = true;
+                }
+                else if (element.name == "face")
+                {
+                    if (!hasVertices) throw RuntimeError("Face element defined before vertex element.");
+                    readFaces(reader, element, vertices.size(), indices);
+                }
+                else
+                {
+                    skipElement(reader, element);
+                }
+            }
+            if (!hasVertices) throw RuntimeError("Missing vertex element.");
+        }
+
+        /** Un-index the mesh and assign facet normals to all vertices.
+            This matches the normals generated by TriangleMesh::createFromFile() for meshes without normals.
+        */
+        void generateFacetNormals(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+        {
+            TriangleMesh::VertexList facetVertices(indices.size());
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                TriangleMesh::Vertex v[3] = {vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]};
+                float3 n = cross(v[1].position - v[0].position, v[2].position - v[0].position);
+                float len = length(n);
+                n = len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    v[j].normal = n;
+                    facetVertices[i + j] = v[j];
+                    indices[i + j] = (uint32_t)(i + j);
+                }
+            }
+            vertices = std::move(facetVertices);
+        }
+    }
+
+    void PLYReader::read(const std::filesystem::path& path, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+    {
+        FileDependencyRecorder::record(path);
+
+        try
+        {
+            if (hasExtension(path, "gz"))
+            {
+                std::string data = decompressFile(path);
+                readFromMemory(data.data(), data.size(), vertices, indices);
+                return;
+            }
+
+            MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+            if (!file.isOpen()) throw RuntimeError("Failed to open file.");
+            readFromMemory(file.getData(), file.getMappedSize(), vertices, indices);
+        }
+        catch (const RuntimeError& e)
+        {
+            throw RuntimeError("Failed to read PLY file '{}': {}", path, e.what());
+        }
+    }
+
+    void PLYReader::readFromMemory(const void* pData, size_t size, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+    {
+        vertices.clear();
+        indices.clear();
+
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        Header header = parseHeader(std::string_view(reinterpret_cast<const char*>(pBytes), size));
+        pBytes += header.dataOffset;
+        size -= header.dataOffset;
+
+        bool hasNormals = false;
+        if (header.format == Format::Ascii)
+        {
+            AsciiReader reader(pBytes, size);
+            readBody(reader, header, vertices, indices, hasNormals);
+        }
+        else
+        {
+            // All supported platforms are little endian.
+            bool swap = header.format == Format::BinaryBigEndian;
+            BinaryReader reader(pBytes, size, swap);
+            readBody(reader, header, vertices, indices, hasNormals);
+        }
+
+        if (!hasNormals) generateFacetNormals(vertices, indices);
+    }
+
+    ref<TriangleMesh> PLYReader::createTriangleMesh(const std::filesystem::path& path)
+    {
+        TriangleMesh::VertexList vertices;
+        TriangleMesh::IndexList indices;
+        try
+        {
+            read(path, vertices, indices);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("Failed to load triangle mesh: {}", e.what());
+            return nullptr;
+        }
+        return TriangleMesh::create(std::move(vertices), std::move(indices));
+    }
+}
@@ -0,0 +1,76 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "TriangleMesh.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Fast reader for triangle meshes stored in the PLY (polygon file) format.
+
+        This is a lightweight alternative to TriangleMesh::createFromFile() for scenes referencing
+        large numbers of PLY files (e.g. pbrt-v4 exports). It reads directly from a memory mapped file
+        without setting up an ASSIMP importer for each file.
+
+        Supported are ASCII and binary (little and big endian) encodings and gzip compressed files (.ply.gz).
+        Vertex positions, normals and texture coordinates are read, polygonal faces are triangulated as fans.
+        Other elements and properties are skipped. The result matches TriangleMesh::createFromFile():
+        texture coordinates are flipped vertically and meshes without normals get facet normals,
+        which requires the vertices to be un-indexed.
+
+        All functions are thread-safe, i.e. multiple files can be loaded concurrently.
+    */
+    class FALCOR_API PLYReader
+    {
+    public:
+        /** Read a triangle mesh from a PLY file.
+            \param[in] path File path (.ply or .ply.gz).
+            \param[out] vertices Vertex list.
+            \param[out] indices Index list.
+            Throws a RuntimeError if the file cannot be read or is malformed.
+        */
+        static void read(const std::filesystem::path& path, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices);
+
+        /** Read a triangle mesh from PLY data in memory.
+            \param[in] pData PLY data.
+            \param[in] size Size of PLY data in bytes.
+            \param[out] vertices Vertex list.
+            \param[out] indices Index list.
+            Throws a RuntimeError if the data is malformed.
+        */
+        static void readFromMemory(const void* pData, size_t size, TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices);
+
+        /** Create a triangle mesh from a PLY file.
+            \param[in] path File path (.ply or .ply.gz).
+            \return Returns the triangle mesh or nullptr if the mesh failed to load.
+        */
+        static ref<TriangleMesh> createTriangleMesh(const std::filesystem::path& path);
+    };
+}
@@ -289,6 +289,7 @@ namespace Falcor
         }
 
         mGridWidth = gridWidth;
+        mValuesPath.clear();
 
         setValuesInternal(cornerValues);
     }
@@ -312,6 +313,7 @@ namespace Falcor
                 file.close();
                 setValues(cornerValues, gridWidth);
 
+                mValuesPath = fullPath;
                 mInitializedWithPrimitives = false;
                 return true;
             }
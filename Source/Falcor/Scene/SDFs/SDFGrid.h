@@ -259,6 +259,7 @@ namespace Falcor
         bool                    mInitializedWithPrimitives = false; ///< True if the grid was initialized with primitives.
 
         ref<Texture>            mpSDFGridTexture;                   ///< A texture on the GPU holding the value representation.
+        std::filesystem::path   mValuesPath;                        ///< Path of the .sdfg file the values were loaded from, empty if the values were not loaded from a file.
         ref<ComputePass>        mpEvaluatePrimitivesPass;
 
         friend class Scene;
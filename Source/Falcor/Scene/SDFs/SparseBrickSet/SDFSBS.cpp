@@ -29,6 +29,7 @@
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
 #include "Core/API/IndirectCommands.h"
+#include "Utils/Logger.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/Math/MathConstants.slangh"
 #include "Utils/SharedCache.h"
@@ -117,13 +118,17 @@ namespace Falcor
         FALCOR_ASSERT(pRenderContext);
 
         // Update grid texture, if user loads an sdf-file.
+        // The grid texture is also created when the bricks are built on the CPU, as it is needed when the grid is edited.
         if (!mSDField.empty())
         {
             createSDFGridTexture(pRenderContext, mSDField);
-            mSDField.clear();
         }
 
-        if (!mPrimitives.empty())
+        if (!mSDField.empty() && mPrimitives.empty() && mCpuBuildEnabled)
+        {
+            createResourcesFromBrickData(loadOrBuildBrickData());
+        }
+        else if (!mPrimitives.empty())
         {
             createResourcesFromPrimitivesAndSDField(pRenderContext, deleteScratchData);
         }
@@ -144,6 +149,7 @@ namespace Falcor
             createResourcesFromPrimitivesAndSDField(pRenderContext, deleteScratchData);
         }
 
+        mSDField.clear();
         allocatePrimitiveBits();
     }
 
@@ -279,17 +285,11 @@ namespace Falcor
                 mpCreateBricksFromSDFieldPass = ComputePass::create(mpDevice, desc, { {"COMPRESS_BRICKS", mCompressed ? "1" : "0"} });
             }
 
-            // TextureWidth = kBrickWidthInValues * kBrickWidthInValues * BricksAlongX
-            // TextureHeight = kBrickWidthInValues * BricksAlongY
-            // TotalBrickCount = BricksAlongX * BricksAlongY
-            // Set TextureWidth = TextureHeight and solve for BricksAlongX.
-            // This gives: BricksAlongX = ceil(sqrt(TotalNumBricks / kBrickWidthInValues).
-            // And: BricksAlongY = ceil(TotalNumBricks / BricksAlongX).
-            // This should give TextureWidth ~= TextureHeight.
-
+            // Use the same brick layout as the CPU builder, which gives a roughly square brick texture.
             uint32_t brickWidthInValues = mBrickWidth + 1;
-            uint32_t bricksAlongX = (uint32_t)std::ceil(std::sqrt((float)mBrickCount / brickWidthInValues));
-            uint32_t bricksAlongY = (uint32_t)std::ceil((float)mBrickCount / bricksAlongX);
+            uint2 bricksPerAxis = SDFSBSBuilder::getBricksPerAxis(mBrickCount, mBrickWidth);
+            uint32_t bricksAlongX = bricksPerAxis.x;
+            uint32_t bricksAlongY = bricksPerAxis.y;
 
             // Create brick texture.
             if (!mpBrickTexture || mBricksPerAxis.x < bricksAlongX || mBricksPerAxis.y < bricksAlongY)
@@ -354,6 +354,69 @@ namespace Falcor
         mWasEmpty = false;
     }
 
+    void SDFSBS::createResourcesFromBrickData(const SDFSBSBrickData& data)
+    {
+        FALCOR_ASSERT(data.gridWidth == mGridWidth && data.brickWidth == mBrickWidth && data.compressed == mCompressed);
+
+        mVirtualBricksPerAxis = data.virtualBricksPerAxis;
+        mBrickCount = data.brickCount;
+        mBricksPerAxis = data.bricksPerAxis;
+        mBrickTextureDimensions = data.brickTextureDimensions;
+
+        mpIndirectionTexture = Texture::create3D(mpDevice, mVirtualBricksPerAxis, mVirtualBricksPerAxis, mVirtualBricksPerAxis, ResourceFormat::R32Uint, 1, data.indirection.data(), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        mpIndirectionTexture->setName("SDFSBS::IndirectionTextureValues");
+
+        if (mCompressed)
+        {
+            mpBrickTexture = Texture::create2D(mpDevice, mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::BC4Snorm, 1, 1, data.brickTexels.data());
+        }
+        else
+        {
+            mpBrickTexture = Texture::create2D(mpDevice, mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::R8Snorm, 1, 1, data.brickTexels.data(), ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+        }
+
+        mpBrickAABBsBuffer = Buffer::createStructured(mpDevice, sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.brickAABBs.data(), false);
+
+        mWasEmpty = false;
+    }
+
+    SDFSBSBrickData SDFSBS::loadOrBuildBrickData() const
+    {
+        FALCOR_ASSERT(!mSDField.empty());
+
+        // Prebuilt bricks are stored next to the .sdfg file and are matched to the values using a hash of the values.
+        std::filesystem::path brickFilePath;
+        if (!mValuesPath.empty()) brickFilePath = SDFSBSBuilder::getBrickFilePath(mValuesPath, mBrickWidth, mCompressed);
+
+        SDFSBSBrickData data;
+        if (!brickFilePath.empty() && SDFSBSBuilder::readFromFile(brickFilePath, data))
+        {
+            if (data.gridWidth == mGridWidth && data.brickWidth == mBrickWidth && data.compressed == mCompressed && data.sdFieldHash == SDFSBSBuilder::hashSDField(mSDField))
+            {
+                logDebug("Loaded SDF sparse brick set from '{}'.", brickFilePath);
+                return data;
+            }
+            logDebug("SDF sparse brick set '{}' does not match the values of '{}'.", brickFilePath, mValuesPath);
+        }
+
+        data = SDFSBSBuilder::build(mSDField, mGridWidth, mBrickWidth, mCompressed);
+
+        if (!brickFilePath.empty())
+        {
+            // The file is written to a temporary file and renamed, readers never see a partially written file.
+            try
+            {
+                SDFSBSBuilder::writeToFile(brickFilePath, data);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to write SDF sparse brick set '{}': {}", brickFilePath, e.what());
+            }
+        }
+
+        return data;
+    }
+
     SDFGrid::UpdateFlags SDFSBS::createResourcesFromPrimitivesAndSDField(RenderContext* pRenderContext, bool deleteScratchData)
     {
         // Assume AABBs will change.
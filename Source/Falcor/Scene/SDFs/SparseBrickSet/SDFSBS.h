@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 
+#include "SDFSBSBuilder.h"
 #include "Core/Pass/ComputePass.h"
 #include "Scene/SDFs/SDFGrid.h"
 #include "Utils/Algorithm/PrefixSum.h"
@@ -55,6 +56,15 @@ namespace Falcor
         uint32_t getBrickLocalVoxelCoordsBrickCount() const { return mBrickLocalVoxelCoordsBitCount; }
         bool isCompressed() const { return mCompressed; }
 
+        /** Select if bricks created from a signed distance field without primitives are built on the CPU (default) or using compute passes.
+            Bricks built on the CPU are stored in a .sbs file next to the .sdfg file the values were loaded from, so later loads skip the build.
+        */
+        void setCpuBuildEnabled(bool enabled) { mCpuBuildEnabled = enabled; }
+        bool isCpuBuildEnabled() const { return mCpuBuildEnabled; }
+
+        const ref<Texture>& getIndirectionTexture() const { return mpIndirectionTexture; }
+        const ref<Texture>& getBrickTexture() const { return mpBrickTexture; }
+
         virtual size_t getSize() const override;
         virtual uint32_t getMaxPrimitiveIDBits() const override;
         virtual Type getType() const override { return Type::SparseBrickSet; }
@@ -71,6 +81,8 @@ namespace Falcor
 
     protected:
         void createResourcesFromSDField(RenderContext* pRenderContext, bool deleteScratchData);
+        void createResourcesFromBrickData(const SDFSBSBrickData& data);
+        SDFSBSBrickData loadOrBuildBrickData() const;
         SDFGrid::UpdateFlags createResourcesFromPrimitivesAndSDField(RenderContext* pRenderContext, bool deleteScratchData);
 
         void expandSDFGridTexture(RenderContext* pRenderContext, bool deleteScratchData, uint32_t oldGridWidthInSDField, uint32_t gridWidthInSDField);
@@ -101,6 +113,7 @@ namespace Falcor
         uint32_t mBrickLocalVoxelCoordsBitCount = 0;
         uint32_t mBrickWidth = 0;
         bool mCompressed = false;
+        bool mCpuBuildEnabled = true;
         bool mSDFieldUpdated = false;
         float mResolutionScalingFactor = 1.0f;
         uint32_t mCurrentBakedPrimitiveCount = 0;
@@ -0,0 +1,487 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFSBSBuilder.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/ChunkedFile.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/FNVHash.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kFileMagic[] = "FSDFSBS";
+        const uint32_t kFileVersion = 1;
+
+        // Bricks are compressed in blocks of 4x4 texels.
+        const uint32_t kCompressionWidth = 4;
+
+        const size_t kHashBlockSize = 1 << 20;
+
+        enum class Chunk : uint32_t
+        {
+            Header = 0,
+            Indirection = 1,
+            AABBs = 2,
+            Bricks = 3,
+        };
+
+        struct FileHeader
+        {
+            uint32_t gridWidth;
+            uint32_t brickWidth;
+            uint32_t compressed;
+            uint32_t virtualBricksPerAxis;
+            uint32_t brickCount;
+            uint32_t bricksPerAxis[2];
+            uint32_t brickTextureDimensions[2];
+            uint32_t pad;
+            uint64_t sdFieldHash;
+        };
+
+        size_t getBrickTexelByteSize(const uint2& dimensions, bool compressed)
+        {
+            // BC4 stores 8 bytes per 4x4 block.
+            if (compressed) return size_t(dimensions.x / kCompressionWidth) * (dimensions.y / kCompressionWidth) * 8;
+            return size_t(dimensions.x) * dimensions.y;
+        }
+
+        // The functions below are a CPU port of BC4Encode.slang and produce the exact same BC4Snorm blocks.
+
+        void fixRange(int& minValue, int& maxValue, int steps)
+        {
+            if (maxValue - minValue < steps)
+            {
+                maxValue = std::min(minValue + steps, 127);
+                minValue = maxValue - minValue < steps ? std::max(-128, maxValue - steps) : minValue;
+            }
+        }
+
+        int fitCodes(const int block[16], const int codes[8], uint32_t indices[16])
+        {
+            // Fit each value to the codebook.
+            int err = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                // Find the least error and corresponding index.
+                int least = std::numeric_limits<int>::max();
+                uint32_t index = 0;
+                for (uint32_t j = 0; j < 8; ++j)
+                {
+                    int dist = block[i] - codes[j];
+                    dist *= dist;
+                    if (dist < least)
+                    {
+                        least = dist;
+                        index = j;
+                    }
+                }
+
+                indices[i] = index;
+                err += least;
+            }
+            return err;
+        }
+
+        uint64_t writeAlphaBlock(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            uint64_t compressedBlock = uint64_t(alpha0 & 0xff) | (uint64_t(alpha1 & 0xff) << 8);
+
+            // Pack the indices with 3 bits each.
+            for (int i = 0; i < 16; ++i)
+            {
+                compressedBlock |= uint64_t(indices[i] & 0x7) << (3 * (i % 8) + 24 * (i / 8) + 16);
+            }
+            return compressedBlock;
+        }
+
+        uint64_t writeAlphaBlock5(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            if (alpha0 <= alpha1) return writeAlphaBlock(alpha0, alpha1, indices);
+
+            // Swap the endpoints and remap the indices.
+            uint32_t swapped[16];
+            for (int i = 0; i < 16; ++i)
+            {
+                uint32_t index = indices[i];
+                if (index == 0) swapped[i] = 1;
+                else if (index == 1) swapped[i] = 0;
+                else if (index <= 5) swapped[i] = 7 - index;
+                else swapped[i] = index;
+            }
+            return writeAlphaBlock(alpha1, alpha0, swapped);
+        }
+
+        uint64_t writeAlphaBlock7(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            if (alpha0 >= alpha1) return writeAlphaBlock(alpha0, alpha1, indices);
+
+            // Swap the endpoints and remap the indices.
+            uint32_t swapped[16];
+            for (int i = 0; i < 16; ++i)
+            {
+                uint32_t index = indices[i];
+                if (index == 0) swapped[i] = 1;
+                else if (index == 1) swapped[i] = 0;
+                else swapped[i] = 9 - index;
+            }
+            return writeAlphaBlock(alpha1, alpha0, swapped);
+        }
+
+        /** Compresses a 4x4 block of 8-bit snorm values.
+        */
+        uint64_t compressBlock(const int block[16])
+        {
+            // Get the range for 5-alpha and 7-alpha interpolation.
+            int min5 = 127;
+            int max5 = -128;
+            int min7 = 127;
+            int max7 = -128;
+            for (int i = 0; i < 16; ++i)
+            {
+                int v = block[i];
+                min7 = std::min(min7, v);
+                max7 = std::max(max7, v);
+                if (v != -128 && v < min5) min5 = v;
+                if (v != 127 && v > max5) max5 = v;
+            }
+
+            min5 = std::min(min5, max5);
+            min7 = std::min(min7, max7);
+
+            // Fix the range to be the minimum in each case.
+            fixRange(min5, max5, 5);
+            fixRange(min7, max7, 7);
+
+            // Set up the 5-alpha and 7-alpha code books.
+            int codes5[8];
+            codes5[0] = min5;
+            codes5[1] = max5;
+            for (int i = 1; i < 5; ++i) codes5[1 + i] = ((5 - i) * min5 + i * max5) / 5;
+            codes5[6] = -128;
+            codes5[7] = 127;
+
+            int codes7[8];
+            codes7[0] = min7;
+            codes7[1] = max7;
+            for (int i = 1; i < 7; ++i) codes7[1 + i] = ((7 - i) * min7 + i * max7) / 7;
+
+            // Fit the data to both code books and use the one with least error.
+            uint32_t indices5[16];
+            uint32_t indices7[16];
+            int err5 = fitCodes(block, codes5, indices5);
+            int err7 = fitCodes(block, codes7, indices7);
+            return err5 <= err7 ? writeAlphaBlock5(min5, max5, indices5) : writeAlphaBlock7(min7, max7, indices7);
+        }
+
+        /** Check if any voxel in a brick contains surface, i.e., if its corner values contain both values <= 0 and >= 0.
+            The corner values of each voxel row are reduced across y and z first, so the inner loops are simple min/max loops
+            over contiguous values that the compiler vectorizes.
+        */
+        bool brickContainsSurface(const int8_t* pSDField, uint32_t gridWidth, uint3 voxelMin, uint3 voxelMax, std::vector<int8_t>& rowMin, std::vector<int8_t>& rowMax)
+        {
+            const size_t gridWidthInValues = gridWidth + 1;
+            const uint32_t valueCount = voxelMax.x - voxelMin.x + 1;
+            const uint32_t voxelCount = voxelMax.x - voxelMin.x;
+
+            for (uint32_t z = voxelMin.z; z < voxelMax.z; ++z)
+            {
+                for (uint32_t y = voxelMin.y; y < voxelMax.y; ++y)
+                {
+                    const int8_t* pRow00 = pSDField + voxelMin.x + gridWidthInValues * (y + gridWidthInValues * z);
+                    const int8_t* pRow01 = pRow00 + gridWidthInValues;
+                    const int8_t* pRow10 = pRow00 + gridWidthInValues * gridWidthInValues;
+                    const int8_t* pRow11 = pRow10 + gridWidthInValues;
+
+                    int8_t* pMin = rowMin.data();
+                    int8_t* pMax = rowMax.data();
+                    for (uint32_t x = 0; x < valueCount; ++x)
+                    {
+                        pMin[x] = std::min(std::min(pRow00[x], pRow01[x]), std::min(pRow10[x], pRow11[x]));
+                        pMax[x] = std::max(std::max(pRow00[x], pRow01[x]), std::max(pRow10[x], pRow11[x]));
+                    }
+
+                    bool found = false;
+                    for (uint32_t x = 0; x < voxelCount; ++x)
+                    {
+                        found |= std::min(pMin[x], pMin[x + 1]) <= 0 && std::max(pMax[x], pMax[x + 1]) >= 0;
+                    }
+                    if (found) return true;
+                }
+            }
+
+            return false;
+        }
+    }
+
+    SDFSBSBrickData SDFSBSBuilder::build(const std::vector<int8_t>& sdField, uint32_t gridWidth, uint32_t brickWidth, bool compressed)
+    {
+        const size_t gridWidthInValues = gridWidth + 1;
+        checkArgument(gridWidth > 0 && brickWidth > 0, "'gridWidth' ({}) and 'brickWidth' ({}) must be larger than zero", gridWidth, brickWidth);
+        checkArgument(sdField.size() == gridWidthInValues * gridWidthInValues * gridWidthInValues, "'sdField' must contain (gridWidth + 1)^3 values");
+        checkArgument(!compressed || (brickWidth + 1) % kCompressionWidth == 0, "'brickWidth' ({}) must be a multiple of 4 minus 1 for compressed SDFSBSs", brickWidth);
+
+        SDFSBSBrickData data;
+        data.gridWidth = gridWidth;
+        data.brickWidth = brickWidth;
+        data.compressed = compressed;
+        data.sdFieldHash = hashSDField(sdField);
+        data.virtualBricksPerAxis = (uint32_t)std::ceil(float(gridWidth) / brickWidth);
+
+        const uint32_t bricksPerAxis = data.virtualBricksPerAxis;
+        const size_t virtualBrickCount = size_t(bricksPerAxis) * bricksPerAxis * bricksPerAxis;
+        auto getVirtualBrickCoords = [bricksPerAxis](size_t virtualBrickID)
+        {
+            return uint3(uint32_t(virtualBrickID % bricksPerAxis), uint32_t((virtualBrickID / bricksPerAxis) % bricksPerAxis), uint32_t(virtualBrickID / (size_t(bricksPerAxis) * bricksPerAxis)));
+        };
+
+        // Find the bricks that contain surface.
+        std::vector<uint32_t> validity(virtualBrickCount);
+        Threading::parallelFor(0, virtualBrickCount, [&](size_t begin, size_t end)
+        {
+            std::vector<int8_t> rowMin(brickWidth + 1);
+            std::vector<int8_t> rowMax(brickWidth + 1);
+            for (size_t virtualBrickID = begin; virtualBrickID < end; ++virtualBrickID)
+            {
+                uint3 voxelMin = getVirtualBrickCoords(virtualBrickID) * brickWidth;
+                uint3 voxelMax = min(voxelMin + brickWidth, uint3(gridWidth));
+                validity[virtualBrickID] = brickContainsSurface(sdField.data(), gridWidth, voxelMin, voxelMax, rowMin, rowMax) ? 1 : 0;
+            }
+        });
+
+        // Assign brick IDs to valid bricks in virtual brick order.
+        data.indirection.resize(virtualBrickCount);
+        uint32_t brickCount = 0;
+        for (size_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; ++virtualBrickID)
+        {
+            data.indirection[virtualBrickID] = validity[virtualBrickID] ? brickCount++ : std::numeric_limits<uint32_t>::max();
+        }
+
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        data.brickCount = brickCount;
+        data.bricksPerAxis = getBricksPerAxis(brickCount, brickWidth);
+        data.brickTextureDimensions = uint2(brickWidthInValues * brickWidthInValues * data.bricksPerAxis.x, brickWidthInValues * data.bricksPerAxis.y);
+        data.brickAABBs.resize(brickCount);
+        data.brickTexels.resize(getBrickTexelByteSize(data.brickTextureDimensions, compressed));
+
+        // Create the bricks and brick AABBs. Each brick writes a disjoint region of the brick texture.
+        const float oneOverGridWidth = 1.0f / float(gridWidth);
+        const uint32_t textureWidth = data.brickTextureDimensions.x;
+        Threading::parallelFor(0, virtualBrickCount, [&](size_t begin, size_t end)
+        {
+            for (size_t virtualBrickID = begin; virtualBrickID < end; ++virtualBrickID)
+            {
+                uint32_t brickID = data.indirection[virtualBrickID];
+                if (brickID == std::numeric_limits<uint32_t>::max()) continue;
+
+                uint3 brickGridCoords = getVirtualBrickCoords(virtualBrickID) * brickWidth;
+
+                AABB& aabb = data.brickAABBs[brickID];
+                for (int i = 0; i < 3; ++i)
+                {
+                    aabb.minPoint[i] = -0.5f + float(brickGridCoords[i]) * oneOverGridWidth;
+                    aabb.maxPoint[i] = std::min(aabb.minPoint[i] + float(brickWidth) * oneOverGridWidth, 0.5f);
+                }
+
+                // Values outside of the grid are set to the maximum distance. -128 is stored as -127 as snorm values are clamped to [-1, 1].
+                auto getValue = [&](uint32_t x, uint32_t y, uint32_t z) -> int
+                {
+                    if (x >= gridWidth || y >= gridWidth || z >= gridWidth) return 127;
+                    return std::max<int>(sdField[x + gridWidthInValues * (y + gridWidthInValues * z)], -127);
+                };
+
+                uint2 brickTextureCoords = uint2(brickID % data.bricksPerAxis.x, brickID / data.bricksPerAxis.x) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+
+                for (uint32_t z = 0; z < brickWidthInValues; ++z)
+                {
+                    if (compressed)
+                    {
+                        for (uint32_t y = 0; y < brickWidthInValues; y += kCompressionWidth)
+                        {
+                            for (uint32_t x = 0; x < brickWidthInValues; x += kCompressionWidth)
+                            {
+                                int block[16];
+                                for (uint32_t bY = 0; bY < kCompressionWidth; ++bY)
+                                {
+                                    for (uint32_t bX = 0; bX < kCompressionWidth; ++bX)
+                                    {
+                                        block[bY * kCompressionWidth + bX] = getValue(brickGridCoords.x + x + bX, brickGridCoords.y + y + bY, brickGridCoords.z + z);
+                                    }
+                                }
+
+                                uint2 blockTextureCoords = (brickTextureCoords + uint2(x + z * brickWidthInValues, y)) / kCompressionWidth;
+                                uint64_t compressedBlock = compressBlock(block);
+                                size_t offset = (size_t(blockTextureCoords.y) * (textureWidth / kCompressionWidth) + blockTextureCoords.x) * sizeof(uint64_t);
+                                std::memcpy(data.brickTexels.data() + offset, &compressedBlock, sizeof(uint64_t));
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for (uint32_t y = 0; y < brickWidthInValues; ++y)
+                        {
+                            uint8_t* pDst = data.brickTexels.data() + size_t(brickTextureCoords.y + y) * textureWidth + brickTextureCoords.x + z * brickWidthInValues;
+                            for (uint32_t x = 0; x < brickWidthInValues; ++x)
+                            {
+                                pDst[x] = uint8_t(int8_t(getValue(brickGridCoords.x + x, brickGridCoords.y + y, brickGridCoords.z + z)));
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        return data;
+    }
+
+    uint2 SDFSBSBuilder::getBricksPerAxis(uint32_t brickCount, uint32_t brickWidth)
+    {
+        if (brickCount == 0) return uint2(0);
+
+        // TextureWidth = kBrickWidthInValues * kBrickWidthInValues * BricksAlongX
+        // TextureHeight = kBrickWidthInValues * BricksAlongY
+        // TotalBrickCount = BricksAlongX * BricksAlongY
+        // Set TextureWidth = TextureHeight and solve for BricksAlongX.
+        // This gives: BricksAlongX = ceil(sqrt(TotalNumBricks / kBrickWidthInValues).
+        // And: BricksAlongY = ceil(TotalNumBricks / BricksAlongX).
+        // This should give TextureWidth ~= TextureHeight.
+        uint32_t brickWidthInValues = brickWidth + 1;
+        uint32_t bricksAlongX = (uint32_t)std::ceil(std::sqrt((float)brickCount / brickWidthInValues));
+        uint32_t bricksAlongY = (uint32_t)std::ceil((float)brickCount / bricksAlongX);
+        return uint2(bricksAlongX, bricksAlongY);
+    }
+
+    uint64_t SDFSBSBuilder::hashSDField(const std::vector<int8_t>& sdField)
+    {
+        // Hash blocks of the field in parallel and combine the block hashes.
+        const size_t blockCount = (sdField.size() + kHashBlockSize - 1) / kHashBlockSize;
+        std::vector<uint64_t> blockHashes(blockCount);
+        Threading::parallelFor(0, blockCount, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                size_t offset = i * kHashBlockSize;
+                blockHashes[i] = fnvHashArray64(sdField.data() + offset, std::min(kHashBlockSize, sdField.size() - offset));
+            }
+        }, 1);
+
+        FNVHash64 hash;
+        uint64_t size = sdField.size();
+        hash.insert(&size, sizeof(size));
+        hash.insert(blockHashes.data(), blockHashes.size() * sizeof(uint64_t));
+        return hash.get();
+    }
+
+    std::filesystem::path SDFSBSBuilder::getBrickFilePath(const std::filesystem::path& valuesPath, uint32_t brickWidth, bool compressed)
+    {
+        std::filesystem::path path = valuesPath;
+        path.replace_filename(fmt::format("{}_b{}{}.sbs", valuesPath.stem().string(), brickWidth, compressed ? "_bc4" : ""));
+        return path;
+    }
+
+    bool SDFSBSBuilder::readFromFile(const std::filesystem::path& path, SDFSBSBrickData& data)
+    {
+        if (!ChunkedFileReader::isValid(path, kFileMagic, kFileVersion)) return false;
+
+        try
+        {
+            ChunkedFileReader reader(path, kFileMagic, kFileVersion);
+
+            auto headerChunk = reader.getChunk((uint32_t)Chunk::Header);
+            FileHeader header;
+            if (headerChunk.size != sizeof(header)) throw RuntimeError("Invalid header size {}.", headerChunk.size);
+            std::memcpy(&header, headerChunk.pData, sizeof(header));
+
+            SDFSBSBrickData result;
+            result.gridWidth = header.gridWidth;
+            result.brickWidth = header.brickWidth;
+            result.compressed = header.compressed != 0;
+            result.sdFieldHash = header.sdFieldHash;
+            result.virtualBricksPerAxis = header.virtualBricksPerAxis;
+            result.brickCount = header.brickCount;
+            result.bricksPerAxis = uint2(header.bricksPerAxis[0], header.bricksPerAxis[1]);
+            result.brickTextureDimensions = uint2(header.brickTextureDimensions[0], header.brickTextureDimensions[1]);
+
+            const size_t virtualBrickCount = size_t(result.virtualBricksPerAxis) * result.virtualBricksPerAxis * result.virtualBricksPerAxis;
+            auto readChunk = [&](Chunk id, void* pDst, size_t size)
+            {
+                auto chunk = reader.getChunk((uint32_t)id);
+                if (chunk.size != size) throw RuntimeError("Invalid size {} of chunk {}, expected {}.", chunk.size, (uint32_t)id, size);
+                if (size > 0) std::memcpy(pDst, chunk.pData, size);
+            };
+
+            result.indirection.resize(virtualBrickCount);
+            readChunk(Chunk::Indirection, result.indirection.data(), virtualBrickCount * sizeof(uint32_t));
+            result.brickAABBs.resize(result.brickCount);
+            readChunk(Chunk::AABBs, result.brickAABBs.data(), result.brickCount * sizeof(AABB));
+            result.brickTexels.resize(getBrickTexelByteSize(result.brickTextureDimensions, result.compressed));
+            readChunk(Chunk::Bricks, result.brickTexels.data(), result.brickTexels.size());
+
+            data = std::move(result);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to read SDF sparse brick set '{}': {}", path, e.what());
+            return false;
+        }
+
+        return true;
+    }
+
+    void SDFSBSBuilder::writeToFile(const std::filesystem::path& path, const SDFSBSBrickData& data)
+    {
+        FALCOR_ASSERT(data.indirection.size() == size_t(data.virtualBricksPerAxis) * data.virtualBricksPerAxis * data.virtualBricksPerAxis);
+        FALCOR_ASSERT(data.brickAABBs.size() == data.brickCount);
+
+        FileHeader header = {};
+        header.gridWidth = data.gridWidth;
+        header.brickWidth = data.brickWidth;
+        header.compressed = data.compressed ? 1 : 0;
+        header.virtualBricksPerAxis = data.virtualBricksPerAxis;
+        header.brickCount = data.brickCount;
+        header.bricksPerAxis[0] = data.bricksPerAxis.x;
+        header.bricksPerAxis[1] = data.bricksPerAxis.y;
+        header.brickTextureDimensions[0] = data.brickTextureDimensions.x;
+        header.brickTextureDimensions[1] = data.brickTextureDimensions.y;
+        header.sdFieldHash = data.sdFieldHash;
+
+        ChunkedFileWriter writer(path, kFileMagic, kFileVersion);
+        writer.addChunk((uint32_t)Chunk::Header, &header, sizeof(header), ChunkedFileWriter::Compression::None);
+        writer.addChunk((uint32_t)Chunk::Indirection, data.indirection.data(), data.indirection.size() * sizeof(uint32_t));
+        writer.addChunk((uint32_t)Chunk::AABBs, data.brickAABBs.data(), data.brickAABBs.size() * sizeof(AABB));
+        writer.addChunk((uint32_t)Chunk::Bricks, data.brickTexels.data(), data.brickTexels.size());
+        writer.close();
+    }
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU-side data of an SDF sparse brick set.
+        The layout is identical to the GPU resources created by SDFSBS from a signed distance field.
+    */
+    struct SDFSBSBrickData
+    {
+        uint32_t gridWidth = 0;                 ///< Width of the grid in voxels.
+        uint32_t brickWidth = 0;                ///< Width of a brick in voxels.
+        bool compressed = false;                ///< True if the brick texels are BC4Snorm compressed, otherwise they are R8Snorm.
+        uint64_t sdFieldHash = 0;               ///< Hash of the signed distance field the bricks were built from.
+        uint32_t virtualBricksPerAxis = 0;
+        uint32_t brickCount = 0;
+        uint2 bricksPerAxis = uint2(0);         ///< Number of bricks along x and y in the brick texture.
+        uint2 brickTextureDimensions = uint2(0);
+        std::vector<uint32_t> indirection;      ///< Brick ID per virtual brick, or UINT32_MAX for empty bricks.
+        std::vector<AABB> brickAABBs;           ///< AABB per brick.
+        std::vector<uint8_t> brickTexels;       ///< Brick texture data, BC4 blocks or 8-bit snorm texels in row-major order.
+    };
+
+    /** Builds SDF sparse brick sets on the CPU and serializes them to .sbs files.
+        The builder produces the same bricks as the GPU build of SDFSBS from a signed distance field, so that prebuilt
+        brick sets can be loaded without running the build passes.
+    */
+    class FALCOR_API SDFSBSBuilder
+    {
+    public:
+        /** Build a sparse brick set from a signed distance field.
+            \param[in] sdField Normalized 8-bit snorm distances at the voxel corners, (gridWidth + 1)^3 values.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] brickWidth The width of a brick in voxels.
+            \param[in] compressed Selects if bricks should be BC4 compressed. brickWidth + 1 must be a multiple of 4 to enable compression.
+            \return The brick set.
+        */
+        static SDFSBSBrickData build(const std::vector<int8_t>& sdField, uint32_t gridWidth, uint32_t brickWidth, bool compressed);
+
+        /** Compute the number of bricks along x and y in the brick texture, chosen so that the texture is roughly square.
+        */
+        static uint2 getBricksPerAxis(uint32_t brickCount, uint32_t brickWidth);
+
+        /** Compute the hash of a signed distance field that is used to match .sbs files to their source.
+        */
+        static uint64_t hashSDField(const std::vector<int8_t>& sdField);
+
+        /** Get the path of the .sbs file belonging to a .sdfg file.
+        */
+        static std::filesystem::path getBrickFilePath(const std::filesystem::path& valuesPath, uint32_t brickWidth, bool compressed);
+
+        /** Read a brick set from a .sbs file.
+            \param[in] path The path of the .sbs file.
+            \param[out] data The brick set.
+            \return true if the file could be read, otherwise false.
+        */
+        static bool readFromFile(const std::filesystem::path& path, SDFSBSBrickData& data);
+
+        /** Write a brick set to a .sbs file. Throws a RuntimeError if the file could not be written.
+            \param[in] path The path of the .sbs file.
+            \param[in] data The brick set.
+        */
+        static void writeToFile(const std::filesystem::path& path, const SDFSBSBrickData& data);
+    };
+}
@@ -29,6 +29,7 @@
 #include "SceneDefines.slangh"
 #include "SceneBuilder.h"
 #include "Importer.h"
+#include "BlasGroupPlanner.h"
 #include "Curves/CurveConfig.h"
 #include "SDFs/SDFGrid.h"
 #include "SDFs/NormalizedDenseSDFGrid/NDSDFGrid.h"
@@ -49,6 +50,7 @@
 
 #include <fstream>
 #include <numeric>
+#include <set>
 #include <sstream>
 
 namespace Falcor
@@ -184,6 +186,13 @@ namespace Falcor
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.curveInstanceData), std::end(sceneData.curveInstanceData));
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.sdfGridInstances), std::end(sceneData.sdfGridInstances));
 
+        // All geometry instances are rendered every frame, so the textures of their materials are in use.
+        std::set<uint32_t> materialIDsInUse;
+        for (const auto& instance : mGeometryInstanceData) materialIDsInUse.insert(instance.materialID);
+        std::vector<MaterialID> materialsInUse;
+        for (uint32_t materialID : materialIDsInUse) materialsInUse.push_back(MaterialID(materialID));
+        mpMaterials->setMaterialsInUse(materialsInUse);
+
         mMeshDesc = std::move(sceneData.meshDesc);
         mMeshNames = std::move(sceneData.meshNames);
         mMeshBBs = std::move(sceneData.meshBBs);
@@ -3033,36 +3042,44 @@ namespace Falcor
 
     void Scene::computeBlasGroups()
     {
-        mBlasGroups.clear();
-        uint64_t groupSize = 0;
-
-        for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        std::vector<BlasGroupPlanner::BlasDesc> blasDescs(mBlasData.size());
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
         {
-            auto& blas = mBlasData[blasId];
-            size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
-
-            // Start new BLAS group on first iteration or if group size would exceed the target.
-            if (groupSize == 0 || groupSize + blasSize > kMaxBLASBuildMemory)
-            {
-                mBlasGroups.push_back({});
-                groupSize = 0;
-            }
+            const auto& blas = mBlasData[blasId];
+            auto& desc = blasDescs[blasId];
+            desc.resultByteSize = blas.resultByteSize;
+            desc.scratchByteSize = blas.scratchByteSize;
+            desc.isDynamic = blas.hasDynamicGeometry() || blas.hasProceduralPrimitives;
+            desc.useCompaction = blas.useCompaction;
+        }
 
-            // Add BLAS to current group.
-            FALCOR_ASSERT(mBlasGroups.size() > 0);
-            auto& group = mBlasGroups.back();
-            group.blasIndices.push_back(blasId);
-            blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
+        auto plan = BlasGroupPlanner::plan(blasDescs, kMaxBLASBuildMemory);
 
-            // Update data offsets and sizes.
-            blas.resultByteOffset = group.resultByteSize;
-            blas.scratchByteOffset = group.scratchByteSize;
-            group.resultByteSize += blas.resultByteSize;
-            group.scratchByteSize += blas.scratchByteSize;
+        mBlasGroups.clear();
+        mBlasGroups.resize(plan.groups.size());
+        for (size_t blasGroupIndex = 0; blasGroupIndex < plan.groups.size(); blasGroupIndex++)
+        {
+            auto& planGroup = plan.groups[blasGroupIndex];
+            auto& group = mBlasGroups[blasGroupIndex];
+            group.blasIndices = std::move(planGroup.blasIndices);
+            group.resultByteSize = planGroup.resultByteSize;
+            group.scratchByteSize = planGroup.scratchByteSize;
+            group.isDynamic = planGroup.type == BlasGroupPlanner::GroupType::Dynamic;
+        }
 
-            groupSize += blasSize;
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            auto& blas = mBlasData[blasId];
+            const auto& placement = plan.placements[blasId];
+            blas.blasGroupIndex = placement.groupIndex;
+            blas.resultByteOffset = placement.resultByteOffset;
+            blas.scratchByteOffset = placement.scratchByteOffset;
         }
 
+        logInfo("BLAS build split into {} groups ({} submits), peak build memory: {} (result {}, scratch {})",
+            mBlasGroups.size(), plan.submitCount, formatByteSize(plan.peakBuildMemory),
+            formatByteSize(plan.resultBufferByteSize), formatByteSize(plan.scratchBufferByteSize));
+
         // Validation that all offsets and sizes are correct.
         uint64_t totalResultSize = 0;
         uint64_t totalScratchSize = 0;
@@ -3180,8 +3197,6 @@ namespace Falcor
                 preparePrebuildInfo(pRenderContext);
                 computeBlasGroups();
 
-                logInfo("BLAS build split into {} groups", mBlasGroups.size());
-
                 // Compute the required maximum size of the result and scratch buffers.
                 uint64_t resultByteSize = 0;
                 uint64_t scratchByteSize = 0;
@@ -3200,7 +3215,6 @@ namespace Falcor
 
                 // Allocate result and scratch buffers.
                 // The scratch buffer we'll retain because it's needed for subsequent rebuilds and updates.
-                // TODO: Save memory by reducing the scratch buffer to the minimum required for the dynamic objects.
                 if (mpBlasScratch == nullptr || mpBlasScratch->getSize() < scratchByteSize)
                 {
                     mpBlasScratch = Buffer::create(mpDevice, scratchByteSize, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
@@ -3221,9 +3235,6 @@ namespace Falcor
                 currentSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
                 ref<RtAccelerationStructurePostBuildInfoPool> currentSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(mpDevice.get(), currentSizeInfoPoolDesc);
 
-                bool hasDynamicGeometry = false;
-                bool hasProceduralPrimitives = false;
-
                 mBlasObjects.resize(mBlasData.size());
 
                 // Iterate over BLAS groups. For each group build and compact all BLASes.
@@ -3249,9 +3260,6 @@ namespace Falcor
                         const uint32_t blasId = group.blasIndices[i];
                         const auto& blas = mBlasData[blasId];
 
-                        hasDynamicGeometry |= blas.hasDynamicGeometry();
-                        hasProceduralPrimitives |= blas.hasProceduralPrimitives;
-
                         RtAccelerationStructure::Desc createDesc = {};
                         createDesc.setBuffer(pResultBuffer, blas.resultByteOffset, blas.resultByteSize);
                         createDesc.setKind(RtAccelerationStructureKind::BottomLevel);
@@ -3353,8 +3361,23 @@ namespace Falcor
                     pRenderContext->uavBarrier(pBlas.get());
                 }
 
-                // Release scratch buffer if there is no animated content. We will not need it.
-                if (!hasDynamicGeometry && !hasProceduralPrimitives) mpBlasScratch.reset();
+                // Updates only use the scratch memory of groups with dynamic BLASes.
+                // Release the scratch buffer if there is no animated content, or shrink it to what updates need.
+                uint64_t retainedScratchByteSize = 0;
+                for (const auto& group : mBlasGroups)
+                {
+                    if (group.isDynamic) retainedScratchByteSize = std::max(retainedScratchByteSize, group.scratchByteSize);
+                }
+
+                if (retainedScratchByteSize == 0)
+                {
+                    mpBlasScratch.reset();
+                }
+                else if (mpBlasScratch->getSize() > retainedScratchByteSize)
+                {
+                    mpBlasScratch = Buffer::create(mpDevice, retainedScratchByteSize, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+                    mpBlasScratch->setName("Scene::mpBlasScratch");
+                }
             }
 
             updateRaytracingBLASStats();
@@ -3371,6 +3394,8 @@ namespace Falcor
 
         for (const auto& group : mBlasGroups)
         {
+            if (!group.isDynamic) continue;
+
             // Determine if any BLAS in the group needs to be updated.
             bool needsUpdate = false;
             for (uint32_t blasId : group.blasIndices)
@@ -1432,6 +1432,7 @@ namespace Falcor
             uint64_t resultByteSize = 0;                    ///< Maximum result data size for all BLASes in the group, including padding.
             uint64_t scratchByteSize = 0;                   ///< Maximum scratch data size for all BLASes in the group, including padding.
             uint64_t finalByteSize = 0;                     ///< Size of the final BLASes in the group post-compaction, including padding.
+            bool isDynamic = false;                         ///< True if the group contains BLASes that are updated or rebuilt after the initial build.
 
             ref<Buffer> pBlas;                              ///< Buffer containing all final BLASes in the group.
         };
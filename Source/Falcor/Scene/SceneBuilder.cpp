@@ -28,16 +28,21 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MeshInstanceDetector.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Threading.h"
 #include "Utils/ObjectIDPython.h"
 #include <mikktspace.h>
+#include <atomic>
 #include <filesystem>
 #include <cmath>
 
@@ -189,6 +194,9 @@ namespace Falcor
             return indexData;
         }
 
+        /** Compute the scene cache key. The key identifies the cache entry, changes to the scene's input files
+            are detected by the dependency manifest stored with the cache (see SceneCache::hasValidCache()).
+        */
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
             SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
@@ -241,6 +249,9 @@ namespace Falcor
             }
         }
 
+        // Record all files read during import to detect changes of the scene's inputs.
+        if (mWriteSceneCache) mpDependencyRecorder = std::make_unique<FileDependencyRecorder>();
+
         import(path);
     }
 
@@ -302,6 +313,9 @@ namespace Falcor
             }
         }
 
+        // Record all files read during import to detect changes of the scene's inputs.
+        if (mWriteSceneCache) mpDependencyRecorder = std::make_unique<FileDependencyRecorder>();
+
         for (const auto& path : pathList)
         {
             std::filesystem::path fullPath;
@@ -360,6 +374,7 @@ namespace Falcor
         prepareSceneGraph();
         prepareMeshes();
         removeUnusedMeshes();
+        detectMeshInstancing();
         flattenStaticMeshInstances();
         pretransformStaticMeshes();
         unifyTriangleWinding();
@@ -400,9 +415,12 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            std::vector<std::filesystem::path> dependencies;
+            if (mpDependencyRecorder) dependencies = mpDependencyRecorder->getFiles();
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, dependencies);
             timeReport.measure("Writing cache");
         }
+        mpDependencyRecorder.reset();
 
         // Create the scene object.
         mpScene = Scene::create(mpDevice, std::move(mSceneData));
@@ -421,37 +439,77 @@ namespace Falcor
         return addProcessedMesh(processMesh(mesh));
     }
 
-    MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial)
+    std::vector<MeshID> SceneBuilder::addMeshes(const std::vector<Mesh>& meshes)
     {
-        checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
-        checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
-
-        Mesh mesh;
+        // Pre-process the meshes in parallel.
+        std::vector<ProcessedMesh> processedMeshes(meshes.size());
+        Threading::parallelFor(0, meshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) processedMeshes[i] = processMesh(meshes[i]);
+        }, 1);
 
-        const auto& indices = pTriangleMesh->getIndices();
-        const auto& vertices = pTriangleMesh->getVertices();
+        // Add the meshes sequentially to retain a deterministic order in the global scene buffers.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (const auto& mesh : processedMeshes) meshIDs.push_back(addProcessedMesh(mesh));
+        return meshIDs;
+    }
 
-        mesh.name = pTriangleMesh->getName();
-        mesh.faceCount = (uint32_t)(indices.size() / 3);
-        mesh.vertexCount = (uint32_t)vertices.size();
-        mesh.indexCount = (uint32_t)indices.size();
-        mesh.pIndices = indices.data();
-        mesh.topology = Vao::Topology::TriangleList;
-        mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
-        mesh.pMaterial = pMaterial;
+    MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial)
+    {
+        return addTriangleMeshes({ { pTriangleMesh, pMaterial } })[0];
+    }
 
-        std::vector<float3> positions(vertices.size());
-        std::vector<float3> normals(vertices.size());
-        std::vector<float2> texCoords(vertices.size());
-        std::transform(vertices.begin(), vertices.end(), positions.begin(), [] (const auto& v) { return v.position; });
-        std::transform(vertices.begin(), vertices.end(), normals.begin(), [] (const auto& v) { return v.normal; });
-        std::transform(vertices.begin(), vertices.end(), texCoords.begin(), [] (const auto& v) { return v.texCoord; });
+    std::vector<MeshID> SceneBuilder::addTriangleMeshes(const std::vector<std::pair<ref<TriangleMesh>, ref<Material>>>& triangleMeshes)
+    {
+        for (const auto& [pTriangleMesh, pMaterial] : triangleMeshes)
+        {
+            checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
+            checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
+        }
 
-        mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
-        mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
-        mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+        // Pre-process the meshes in parallel. The vertex attributes are split into separate arrays first.
+        std::vector<ProcessedMesh> processedMeshes(triangleMeshes.size());
+        Threading::parallelFor(0, triangleMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto& [pTriangleMesh, pMaterial] = triangleMeshes[i];
+
+                Mesh mesh;
+
+                const auto& indices = pTriangleMesh->getIndices();
+                const auto& vertices = pTriangleMesh->getVertices();
+
+                mesh.name = pTriangleMesh->getName();
+                mesh.faceCount = (uint32_t)(indices.size() / 3);
+                mesh.vertexCount = (uint32_t)vertices.size();
+                mesh.indexCount = (uint32_t)indices.size();
+                mesh.pIndices = indices.data();
+                mesh.topology = Vao::Topology::TriangleList;
+                mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
+                mesh.pMaterial = pMaterial;
+
+                std::vector<float3> positions(vertices.size());
+                std::vector<float3> normals(vertices.size());
+                std::vector<float2> texCoords(vertices.size());
+                std::transform(vertices.begin(), vertices.end(), positions.begin(), [] (const auto& v) { return v.position; });
+                std::transform(vertices.begin(), vertices.end(), normals.begin(), [] (const auto& v) { return v.normal; });
+                std::transform(vertices.begin(), vertices.end(), texCoords.begin(), [] (const auto& v) { return v.texCoord; });
+
+                mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+
+                processedMeshes[i] = processMesh(mesh);
+            }
+        }, 1);
 
-        return addMesh(mesh);
+        // Add the meshes sequentially to retain a deterministic order in the global scene buffers.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (const auto& mesh : processedMeshes) meshIDs.push_back(addProcessedMesh(mesh));
+        return meshIDs;
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
@@ -1372,51 +1430,133 @@ namespace Falcor
         if (unusedCount > 0)
         {
             logWarning("Scene has {} unused meshes that will be removed.", unusedCount);
+            removeMeshesWithoutInstances();
+        }
+    }
 
-            const size_t meshCount = mMeshes.size();
-            MeshList meshes;
-            meshes.reserve(meshCount);
+    void SceneBuilder::removeMeshesWithoutInstances()
+    {
+        const size_t meshCount = mMeshes.size();
+        MeshList meshes;
+        meshes.reserve(meshCount);
 
-            for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
-            {
-                auto& mesh = mMeshes[meshID.get()];
-                if (mesh.instances.empty()) continue; // Skip unused meshes
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
+        {
+            auto& mesh = mMeshes[meshID.get()];
+            if (mesh.instances.empty()) continue; // Skip unused meshes
+
+            // Get new mesh ID.
+            const MeshID newMeshID(meshes.size());
 
-                // Get new mesh ID.
-                const MeshID newMeshID(meshes.size());
+            // Update the mesh IDs in the scene graph nodes.
+            for (const auto& nodeID : mesh.instances)
+            {
+                FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
+                auto& node = mSceneGraph[nodeID.get()];
+                std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+            }
 
-                // Update the mesh IDs in the scene graph nodes.
-                for (const auto& nodeID : mesh.instances)
+            // Update the mesh IDs of cached meshes.
+            for (auto &cachedMesh : mSceneData.cachedMeshes)
+            {
+                if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+            }
+            for (auto& cache : mSceneData.cachedCurves)
+            {
+                if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
                 {
-                    FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
-                    auto& node = mSceneGraph[nodeID.get()];
-                    std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+                    if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
                 }
+            }
+
+            meshes.push_back(std::move(mesh));
+        }
 
-                // Update the mesh IDs of cached meshes.
-                for (auto &cachedMesh : mSceneData.cachedMeshes)
+        mMeshes = std::move(meshes);
+
+        // Validate scene graph.
+        for (const auto& node : mSceneGraph)
+        {
+            for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+        }
+    }
+
+    void SceneBuilder::detectMeshInstancing()
+    {
+        // This function optionally finds static meshes that are identical to another mesh up to a rigid transform,
+        // and replaces them by instances of that mesh. The instances are picked up by createMeshGroups() like any
+        // other instanced mesh. The pass is disabled by default.
+
+        if (!is_set(mFlags, Flags::DetectMeshInstancing)) return;
+
+        if (is_set(mFlags, Flags::FlattenStaticMeshInstances))
+        {
+            logWarning("SceneBuilder::detectMeshInstancing() - Mesh instancing detection is ignored when flattening static mesh instances.");
+            return;
+        }
+
+        // Dynamic meshes (skinned or vertex-animated) are skipped, so they never match or are matched by another mesh.
+        std::vector<MeshInstanceDetector::MeshDesc> descs(mMeshes.size());
+        for (size_t i = 0; i < mMeshes.size(); i++)
+        {
+            const auto& mesh = mMeshes[i];
+            auto& desc = descs[i];
+            desc.skip = mesh.isDynamic();
+            if (desc.skip) continue;
+            desc.materialID = mesh.materialId.get();
+            desc.topology = (uint32_t)mesh.topology;
+            desc.isFrontFaceCW = mesh.isFrontFaceCW;
+            desc.use16BitIndices = mesh.use16BitIndices;
+            desc.indexCount = mesh.indexCount;
+            desc.pIndexData = mesh.indexData.data();
+            desc.indexDataSize = mesh.indexData.size();
+            desc.pVertices = mesh.staticData.data();
+            desc.vertexCount = (uint32_t)mesh.staticData.size();
+        }
+
+        auto matches = MeshInstanceDetector::findInstances(descs);
+
+        size_t instancedMeshCount = 0;
+        size_t savedByteSize = 0;
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
+        {
+            const auto& match = matches[meshID.get()];
+            if (match.meshIndex == meshID.get()) continue;
+
+            const MeshID refMeshID{ match.meshIndex };
+            const bool isIdentity = match.transform == float4x4::identity();
+            const std::set<NodeID> instances = std::move(mMeshes[meshID.get()].instances);
+            mMeshes[meshID.get()].instances.clear();
+
+            // Move all instances over to the matching mesh. Note that addNode() may invalidate references into the scene graph.
+            for (NodeID nodeID : instances)
+            {
+                auto& nodeMeshes = mSceneGraph[nodeID.get()].meshes;
+                nodeMeshes.erase(std::remove(nodeMeshes.begin(), nodeMeshes.end(), meshID), nodeMeshes.end());
+
+                NodeID instanceNodeID = nodeID;
+                if (!isIdentity)
                 {
-                    if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+                    instanceNodeID = addNode(Node{ mMeshes[meshID.get()].name, match.transform, float4x4::identity(), float4x4::identity(), nodeID });
                 }
-                for (auto& cache : mSceneData.cachedCurves)
+
+                auto& instanceNodeMeshes = mSceneGraph[instanceNodeID.get()].meshes;
+                if (std::find(instanceNodeMeshes.begin(), instanceNodeMeshes.end(), refMeshID) == instanceNodeMeshes.end())
                 {
-                    if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
-                    {
-                        if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
-                    }
+                    instanceNodeMeshes.push_back(refMeshID);
                 }
-
-                meshes.push_back(std::move(mesh));
+                mMeshes[refMeshID.get()].instances.insert(instanceNodeID);
             }
 
-            mMeshes = std::move(meshes);
+            const auto& mesh = mMeshes[meshID.get()];
+            savedByteSize += mesh.staticData.size() * sizeof(PackedStaticVertexData) + mesh.indexData.size() * sizeof(uint32_t);
+            instancedMeshCount++;
+        }
 
-            // Validate scene graph.
-            FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
-            for (const auto& node : mSceneGraph)
-            {
-                for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
-            }
+        if (instancedMeshCount > 0)
+        {
+            removeMeshesWithoutInstances();
+            logInfo("Replaced {} duplicate meshes by instances, saving {} of vertex and index data.", instancedMeshCount, formatByteSize(savedByteSize));
         }
     }
 
@@ -1615,7 +1755,7 @@ namespace Falcor
         NodeID identityNodeID = addNode(Node{ "Identity", float4x4::identity(), float4x4::identity() });
         auto& identityNode = mSceneGraph[identityNodeID.get()];
 
-        size_t transformedMeshCount = 0;
+        std::vector<std::pair<MeshID, float4x4>> transformedMeshes;
         for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
         {
             auto& mesh = mMeshes[meshID.get()];
@@ -1643,28 +1783,16 @@ namespace Falcor
             // Flip triangle winding flag if the transform flips the coordinate system handedness (negative determinant).
             bool flippedWinding = determinant(float3x3(transform)) < 0.f;
             if (flippedWinding) mesh.isFrontFaceCW = !mesh.isFrontFaceCW;
+            // TODO: We should flip the sign of v.tangent.w if flippedWinding is true.
+            // Leaving that out for now for consistency with the shader code that needs the same fix.
 
             // Transform vertices to world space if not already identity transform.
+            // The vertices of all meshes are transformed in parallel below.
             if (transform != float4x4::identity())
             {
                 FALCOR_ASSERT(!mesh.staticData.empty());
                 FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
-
-                float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
-                float3x3 transform3x3 = float3x3(transform);
-
-                for (auto& v : mesh.staticData)
-                {
-                    v.position = transformPoint(transform, v.position);
-                    v.normal = normalize(transformVector(invTranspose3x3, v.normal));
-                    v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
-                    // TODO: We should flip the sign of v.tangent.w if flippedWinding is true.
-                    // Leaving that out for now for consistency with the shader code that needs the same fix.
-
-                    v.curveRadius = length(transformVector(transform3x3, float3(v.curveRadius, 0.f, 0.f)));
-                }
-
-                transformedMeshCount++;
+                transformedMeshes.emplace_back(meshID, transform);
             }
 
             // Unlink mesh from its previous transform node.
@@ -1681,7 +1809,27 @@ namespace Falcor
             mesh.instances.insert(identityNodeID);
         }
 
-        if (transformedMeshCount > 0) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshCount);
+        Threading::parallelFor(0, transformedMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto& [meshID, transform] = transformedMeshes[i];
+                auto& mesh = mMeshes[meshID.get()];
+
+                float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
+                float3x3 transform3x3 = float3x3(transform);
+
+                for (auto& v : mesh.staticData)
+                {
+                    v.position = transformPoint(transform, v.position);
+                    v.normal = normalize(transformVector(invTranspose3x3, v.normal));
+                    v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
+                    v.curveRadius = length(transformVector(transform3x3, float3(v.curveRadius, 0.f, 0.f)));
+                }
+            }
+        }, 1);
+
+        if (!transformedMeshes.empty()) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshes.size());
     }
 
     void SceneBuilder::flipTriangleWinding(MeshSpec& mesh)
@@ -1749,38 +1897,45 @@ namespace Falcor
         // Note that this pass needs to run *after* pre-transformation of static meshes to world space,
         // as those transforms may flip the winding.
 
-        size_t flippedMeshCount = 0;
-        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        std::atomic<size_t> flippedMeshCount = 0;
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
         {
-            auto& mesh = mMeshes[meshID];
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                auto& mesh = mMeshes[meshID];
 
-            // Skip meshes that are already front face counter-clockwise.
-            if (mesh.isFrontFaceCW == false) continue;
+                // Skip meshes that are already front face counter-clockwise.
+                if (mesh.isFrontFaceCW == false) continue;
 
-            flipTriangleWinding(mesh);
-            FALCOR_ASSERT(!mesh.isFrontFaceCW);
+                flipTriangleWinding(mesh);
+                FALCOR_ASSERT(!mesh.isFrontFaceCW);
 
-            flippedMeshCount++;
-        }
+                flippedMeshCount++;
+            }
+        });
 
-        if (flippedMeshCount > 0) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshCount, mMeshes.size());
+        if (flippedMeshCount > 0) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshCount.load(), mMeshes.size());
     }
 
     void SceneBuilder::calculateMeshBoundingBoxes()
     {
-        for (auto& mesh : mMeshes)
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
         {
-            FALCOR_ASSERT(!mesh.staticData.empty());
-            FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
-
-            AABB meshBB;
-            for (auto& v : mesh.staticData)
+            for (size_t i = begin; i < end; ++i)
             {
-                meshBB.include(v.position);
-            }
+                auto& mesh = mMeshes[i];
+                FALCOR_ASSERT(!mesh.staticData.empty());
+                FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
 
-            mesh.boundingBox = meshBB;
-        }
+                AABB meshBB;
+                for (auto& v : mesh.staticData)
+                {
+                    meshBB.include(v.position);
+                }
+
+                mesh.boundingBox = meshBB;
+            }
+        });
     }
 
     void SceneBuilder::createMeshGroups()
@@ -1932,7 +2087,7 @@ namespace Falcor
         }
     }
 
-    std::pair<std::optional<MeshID>, std::optional<MeshID>> SceneBuilder::splitMesh(const MeshID meshID, const int axis, const float pos)
+    SceneBuilder::MeshSplit SceneBuilder::computeMeshSplit(const MeshID meshID, const int axis, const float pos) const
     {
         // Splits a mesh by an axis-aligned plane.
         // Each triangle is placed on either the left or right side of the plane with respect to its centroid.
@@ -1954,8 +2109,17 @@ namespace Falcor
         }
 
         // Early out if mesh is fully on either side of the splitting plane.
-        if (mesh.boundingBox.maxPoint[axis] < pos) return { meshID, std::nullopt };
-        else if (mesh.boundingBox.minPoint[axis] >= pos) return { std::nullopt, meshID };
+        MeshSplit split;
+        if (mesh.boundingBox.maxPoint[axis] < pos)
+        {
+            split.hasLeft = true;
+            return split;
+        }
+        else if (mesh.boundingBox.minPoint[axis] >= pos)
+        {
+            split.hasRight = true;
+            return split;
+        }
 
         // Setup mesh specs.
         auto createSpec = [](const MeshSpec& mesh, const std::string& name)
@@ -1972,8 +2136,10 @@ namespace Falcor
             return spec;
         };
 
-        MeshSpec leftMesh = createSpec(mesh, mesh.name + ".0");
-        MeshSpec rightMesh = createSpec(mesh, mesh.name + ".1");
+        split.leftMesh = createSpec(mesh, mesh.name + ".0");
+        split.rightMesh = createSpec(mesh, mesh.name + ".1");
+        MeshSpec& leftMesh = split.leftMesh;
+        MeshSpec& rightMesh = split.rightMesh;
 
         if (mesh.indexCount > 0) splitIndexedMesh(mesh, leftMesh, rightMesh, axis, pos);
         else splitNonIndexedMesh(mesh, leftMesh, rightMesh, axis, pos);
@@ -1982,9 +2148,27 @@ namespace Falcor
         FALCOR_ASSERT(leftMesh.getTriangleCount() + rightMesh.getTriangleCount() == mesh.getTriangleCount());
 
         // It is possible all triangles ended up on either side of the splitting plane.
-        // In that case, there is no need to modify the original mesh and we'll just return.
-        if (leftMesh.getTriangleCount() == 0) return { std::nullopt, meshID };
-        else if (rightMesh.getTriangleCount() == 0) return { meshID, std::nullopt };
+        // In that case, there is no need to modify the original mesh.
+        split.hasLeft = leftMesh.getTriangleCount() > 0;
+        split.hasRight = rightMesh.getTriangleCount() > 0;
+        if (!split.hasLeft || !split.hasRight)
+        {
+            split.leftMesh = {};
+            split.rightMesh = {};
+        }
+        return split;
+    }
+
+    std::pair<std::optional<MeshID>, std::optional<MeshID>> SceneBuilder::splitMesh(const MeshID meshID, MeshSplit&& split)
+    {
+        FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+        FALCOR_ASSERT(split.hasLeft || split.hasRight);
+        if (!split.hasLeft) return { std::nullopt, meshID };
+        else if (!split.hasRight) return { meshID, std::nullopt };
+
+        const auto& mesh = mMeshes[meshID.get()];
+        MeshSpec& leftMesh = split.leftMesh;
+        MeshSpec& rightMesh = split.rightMesh;
 
         logDebug(
             "Mesh '{}' with {} triangles was split into two meshes with '{}' and '{}' triangles, respectively.",
@@ -1995,19 +2179,19 @@ namespace Falcor
         // The left mesh replaces the existing mesh.
         // The right mesh is appended at the end of the mesh list and linked to the instances.
         FALCOR_ASSERT(leftMesh.vertexCount > 0 && rightMesh.vertexCount > 0);
-        mMeshes[meshID.get()] = std::move(leftMesh);
-
         MeshID rightMeshID(mMeshes.size());
         for (auto nodeID : mesh.instances)
         {
             mSceneGraph.at(nodeID.get()).meshes.push_back(rightMeshID);
         }
+
+        mMeshes[meshID.get()] = std::move(leftMesh);
         mMeshes.push_back(std::move(rightMesh));
 
         return { meshID, rightMeshID };
     }
 
-    void SceneBuilder::splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos)
+    void SceneBuilder::splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const
     {
         FALCOR_ASSERT(mesh.indexCount > 0 && !mesh.indexData.empty());
 
@@ -2068,7 +2252,7 @@ namespace Falcor
         finalizeMesh(rightMesh);
     }
 
-    void SceneBuilder::splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos)
+    void SceneBuilder::splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const
     {
         FALCOR_ASSERT(mesh.indexCount == 0 && mesh.indexData.empty());
         throw RuntimeError("SceneBuilder::splitNonIndexedMesh() not implemented");
@@ -2240,11 +2424,18 @@ namespace Falcor
         const float pos = bb.center()[axis];
 
         // Partition all meshes by the splitting plane.
-        std::vector<MeshID> leftMeshes, rightMeshes;
+        // The splits are computed in parallel and applied in order, so that new mesh IDs are deterministic.
+        const auto& meshList = meshGroup.meshList;
+        std::vector<MeshSplit> splits(meshList.size());
+        Threading::parallelFor(0, meshList.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) splits[i] = computeMeshSplit(meshList[i], axis, pos);
+        }, 1);
 
-        for (auto meshID : meshGroup.meshList)
+        std::vector<MeshID> leftMeshes, rightMeshes;
+        for (size_t i = 0; i < meshList.size(); ++i)
         {
-            auto result = splitMesh(meshID, axis, pos);
+            auto result = splitMesh(meshList[i], std::move(splits[i]));
             if (auto leftMeshID = result.first) leftMeshes.push_back(*leftMeshID);
             if (auto rightMeshID = result.second) rightMeshes.push_back(*rightMeshID);
         }
@@ -2374,44 +2565,68 @@ namespace Falcor
             throw RuntimeError("Trying to build a scene that exceeds supported mesh data size.");
         }
 
-        mSceneData.meshIndexData.reserve(totalIndexDataCount);
-        mSceneData.meshStaticData.reserve(totalStaticVertexCount);
-        mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
-
-        // Copy all vertex and index data into the global buffers.
+        // Compute the offsets of all meshes into the global buffers.
+        uint32_t indexOffset = 0;
+        uint32_t staticVertexOffset = 0;
+        uint32_t skinningVertexOffset = 0;
         for (auto& mesh : mMeshes)
         {
-            mesh.staticVertexOffset = (uint32_t)mSceneData.meshStaticData.size();
-            mesh.skinningVertexOffset = (uint32_t)mSceneData.meshSkinningData.size();
+            mesh.staticVertexOffset = staticVertexOffset;
+            mesh.skinningVertexOffset = skinningVertexOffset;
             mesh.prevVertexOffset = mesh.skinningVertexOffset;
-
-            // Insert the static vertex data in the global array.
-            // The vertices are automatically converted to their packed format in this step.
-            mSceneData.meshStaticData.insert(mSceneData.meshStaticData.end(), mesh.staticData.begin(), mesh.staticData.end());
+            staticVertexOffset += (uint32_t)mesh.staticData.size();
 
             if (isIndexed)
             {
-                mesh.indexOffset = (uint32_t)mSceneData.meshIndexData.size();
-                mSceneData.meshIndexData.insert(mSceneData.meshIndexData.end(), mesh.indexData.begin(), mesh.indexData.end());
+                mesh.indexOffset = indexOffset;
+                indexOffset += (uint32_t)mesh.indexData.size();
             }
 
             if (mesh.isSkinned())
             {
                 FALCOR_ASSERT(!mesh.skinningData.empty());
-                mSceneData.meshSkinningData.insert(mSceneData.meshSkinningData.end(), mesh.skinningData.begin(), mesh.skinningData.end());
+                skinningVertexOffset += (uint32_t)mesh.skinningData.size();
+            }
+        }
+
+        mSceneData.meshIndexData.resize(indexOffset);
+        mSceneData.meshStaticData.resize(staticVertexOffset);
+        mSceneData.meshSkinningData.resize(skinningVertexOffset);
 
-                // Patch vertex index references.
-                for (uint32_t i = 0; i < mesh.skinningData.size(); ++i)
+        // Copy all vertex and index data into the global buffers.
+        // Each mesh writes to its own range, so the meshes are copied in parallel.
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto& mesh = mMeshes[i];
+
+                // Insert the static vertex data in the global array.
+                // The vertices are automatically converted to their packed format in this step.
+                std::copy(mesh.staticData.begin(), mesh.staticData.end(), mSceneData.meshStaticData.begin() + mesh.staticVertexOffset);
+
+                if (isIndexed)
                 {
-                    mSceneData.meshSkinningData[mesh.skinningVertexOffset + i].staticIndex += mesh.staticVertexOffset;
+                    std::copy(mesh.indexData.begin(), mesh.indexData.end(), mSceneData.meshIndexData.begin() + mesh.indexOffset);
                 }
-            }
 
-            // Free the mesh local data.
-            mesh.indexData.clear();
-            mesh.staticData.clear();
-            mesh.skinningData.clear();
-        }
+                if (mesh.isSkinned())
+                {
+                    // Patch vertex index references.
+                    for (uint32_t j = 0; j < mesh.skinningData.size(); ++j)
+                    {
+                        auto& skinningData = mSceneData.meshSkinningData[mesh.skinningVertexOffset + j];
+                        skinningData = mesh.skinningData[j];
+                        skinningData.staticIndex += mesh.staticVertexOffset;
+                    }
+                }
+
+                // Free the mesh local data.
+                mesh.indexData.clear();
+                mesh.staticData.clear();
+                mesh.skinningData.clear();
+            }
+        });
 
         // Initialize offsets for prev vertex data for vertex-animated meshes
         uint32_t prevOffset = (uint32_t)mSceneData.meshSkinningData.size();
@@ -2532,51 +2747,73 @@ namespace Falcor
         // Match texture coordinate quantization for textured emissives to format of PackedEmissiveTriangle.
         // This is to avoid mismatch when sampling and evaluating emissive triangles.
         // Note that non-emissive meshes are unmodified and use full precision texcoords.
-        for (auto& mesh : mMeshes)
+        // The meshes are processed in parallel. Warnings are collected per mesh and logged in mesh order.
+        std::vector<std::string> warnings(mMeshes.size());
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
         {
-            const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
-            if (pMaterial && pMaterial->getEmissiveTexture() != nullptr)
+            for (size_t meshIndex = begin; meshIndex < end; ++meshIndex)
             {
-                // Quantize texture coordinates to fp16. Also track the bounds and max error.
-                float2 minTexCrd = float2(std::numeric_limits<float>::infinity());
-                float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
-                float2 maxError = float2(0);
-
-                for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
+                const auto& mesh = mMeshes[meshIndex];
+                const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
+                if (pMaterial && pMaterial->getEmissiveTexture() != nullptr)
                 {
-                    auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + i];
-                    float2 texCrd = v.texCrd;
-                    minTexCrd = min(minTexCrd, texCrd);
-                    maxTexCrd = max(maxTexCrd, texCrd);
-                    v.texCrd = f16tof32(f32tof16(texCrd));
-                    maxError = max(maxError, abs(v.texCrd - texCrd));
-                }
+                    // Quantize texture coordinates to fp16. Also track the bounds and max error.
+                    float2 minTexCrd = float2(std::numeric_limits<float>::infinity());
+                    float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
+                    float2 maxError = float2(0);
+
+                    // The texture coordinates are gathered to use the bulk conversion, which is bit-exact with f16tof32(f32tof16()).
+                    std::vector<float2> texCrds(mesh.staticVertexCount);
+                    std::vector<uint16_t> halfs(2 * texCrds.size());
+                    for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
+                    {
+                        texCrds[i] = mSceneData.meshStaticData[mesh.staticVertexOffset + i].texCrd;
+                        minTexCrd = min(minTexCrd, texCrds[i]);
+                        maxTexCrd = max(maxTexCrd, texCrds[i]);
+                    }
 
-                // Issue warning if quantization errors are too large.
-                float2 maxAbsCrd = max(abs(minTexCrd), abs(maxTexCrd));
-                if (maxAbsCrd.x > HLF_MAX || maxAbsCrd.y > HLF_MAX)
-                {
-                    logWarning("Texture coordinates for emissive textured mesh '{}' are outside the representable range, expect rendering errors.", mesh.name);
-                }
-                else
-                {
-                    // Compute maximum quantization error in texels.
-                    // The texcoords are used for all texture channels so taking the maximum dimensions.
-                    uint2 maxTexDim = pMaterial->getMaxTextureDimensions();
-                    maxError *= float2(maxTexDim);
-                    float maxTexelError = std::max(maxError.x, maxError.y);
+                    const fstd::span<float> texCrdComponents(reinterpret_cast<float*>(texCrds.data()), halfs.size());
+                    math::float32ToFloat16(texCrdComponents, halfs);
+                    math::float16ToFloat32(halfs, texCrdComponents);
 
-                    if (maxTexelError > kMaxTexelError)
+                    for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
                     {
-                        logWarning(
-                            "Texture coordinates for emissive textured mesh '{}' have a large quantization error of {} texels."
-                            "The coordinate range is [{},{}] x [{},{}] for maximum texture dimensions ({},{}).",
-                            mesh.name, maxTexelError,
-                            minTexCrd.x, maxTexCrd.x, minTexCrd.y, maxTexCrd.y, maxTexDim.x, maxTexDim.y
-                        );
+                        auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + i];
+                        maxError = max(maxError, abs(texCrds[i] - v.texCrd));
+                        v.texCrd = texCrds[i];
+                    }
+
+                    // Issue warning if quantization errors are too large.
+                    float2 maxAbsCrd = max(abs(minTexCrd), abs(maxTexCrd));
+                    if (maxAbsCrd.x > HLF_MAX || maxAbsCrd.y > HLF_MAX)
+                    {
+                        warnings[meshIndex] = fmt::format("Texture coordinates for emissive textured mesh '{}' are outside the representable range, expect rendering errors.", mesh.name);
+                    }
+                    else
+                    {
+                        // Compute maximum quantization error in texels.
+                        // The texcoords are used for all texture channels so taking the maximum dimensions.
+                        uint2 maxTexDim = pMaterial->getMaxTextureDimensions();
+                        maxError *= float2(maxTexDim);
+                        float maxTexelError = std::max(maxError.x, maxError.y);
+
+                        if (maxTexelError > kMaxTexelError)
+                        {
+                            warnings[meshIndex] = fmt::format(
+                                "Texture coordinates for emissive textured mesh '{}' have a large quantization error of {} texels."
+                                "The coordinate range is [{},{}] x [{},{}] for maximum texture dimensions ({},{}).",
+                                mesh.name, maxTexelError,
+                                minTexCrd.x, maxTexCrd.x, minTexCrd.y, maxTexCrd.y, maxTexDim.x, maxTexDim.y
+                            );
+                        }
                     }
                 }
             }
+        });
+
+        for (const auto& warning : warnings)
+        {
+            if (!warning.empty()) logWarning(warning);
         }
     }
 
@@ -2900,6 +3137,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("DetectMeshInstancing", SceneBuilder::Flags::DetectMeshInstancing);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2918,6 +3156,7 @@ namespace Falcor
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
         sceneBuilder.def("importScene", &SceneBuilder::import, "path"_a, "dict"_a = pybind11::dict());
         sceneBuilder.def("addTriangleMesh", &SceneBuilder::addTriangleMesh, "triangleMesh"_a, "material"_a);
+        sceneBuilder.def("addTriangleMeshes", &SceneBuilder::addTriangleMeshes, "triangleMeshes"_a);
         sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
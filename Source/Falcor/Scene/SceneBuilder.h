@@ -40,6 +40,7 @@
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
+#include "Utils/FileDependencies.h"
 #include "Utils/Settings.h"
 
 #include <pybind11/pytypes.h>
@@ -76,6 +77,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            DetectMeshInstancing            = 0x20000,  ///< Detect static meshes that are identical up to a rigid transform and replace them by instances of a single mesh. Ignored if FlattenStaticMeshInstances is set.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -408,6 +410,14 @@ namespace Falcor
         */
         MeshID addMesh(const Mesh& mesh);
 
+        /** Add multiple meshes.
+            The meshes are pre-processed in parallel and then added in order, so the mesh IDs are the same as when calling addMesh() for each mesh.
+            Throws an exception if something went wrong.
+            \param meshes The meshes to add.
+            \return The IDs of the meshes in the scene, in the same order as the input meshes.
+        */
+        std::vector<MeshID> addMeshes(const std::vector<Mesh>& meshes);
+
         /** Add a triangle mesh.
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
@@ -415,6 +425,13 @@ namespace Falcor
         */
         MeshID addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial);
 
+        /** Add multiple triangle meshes.
+            The meshes are pre-processed in parallel, see addMeshes().
+            \param triangleMeshes The triangle meshes to add, each paired with the material to use.
+            \return The IDs of the meshes in the scene, in the same order as the input meshes.
+        */
+        std::vector<MeshID> addTriangleMeshes(const std::vector<std::pair<ref<TriangleMesh>, ref<Material>>>& triangleMeshes);
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
@@ -760,6 +777,7 @@ namespace Falcor
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        std::unique_ptr<FileDependencyRecorder> mpDependencyRecorder; ///< Records the files read during import (only if the scene cache is written).
 
         SceneGraph mSceneGraph;
 
@@ -779,13 +797,29 @@ namespace Falcor
         void flipTriangleWinding(MeshSpec& mesh);
         void updateSDFGridID(SdfGridID oldID, SdfGridID newID);
 
-        /** Split a mesh by the given axis-aligned splitting plane.
+        /** Result of splitting a mesh by an axis-aligned splitting plane.
+            If the mesh has triangles on both sides, it is split into the left and right meshes.
+        */
+        struct MeshSplit
+        {
+            bool hasLeft = false;       ///< True if the mesh has triangles on the left side.
+            bool hasRight = false;      ///< True if the mesh has triangles on the right side.
+            MeshSpec leftMesh;          ///< Left part of the mesh. Only valid if the mesh has triangles on both sides.
+            MeshSpec rightMesh;         ///< Right part of the mesh. Only valid if the mesh has triangles on both sides.
+        };
+
+        /** Compute the split of a mesh by the given axis-aligned splitting plane without modifying the scene.
+            This function is thread safe.
+        */
+        MeshSplit computeMeshSplit(MeshID meshID, const int axis, const float pos) const;
+
+        /** Apply a split computed by computeMeshSplit(). The left mesh replaces the mesh, the right mesh is appended to the mesh list.
             \return Pair of optional mesh IDs for the meshes on the left and right side, respectively.
         */
-        std::pair<std::optional<MeshID>, std::optional<MeshID>> splitMesh(MeshID meshID, const int axis, const float pos);
+        std::pair<std::optional<MeshID>, std::optional<MeshID>> splitMesh(MeshID meshID, MeshSplit&& split);
 
-        void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
-        void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
+        void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const;
+        void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const;
 
         // Mesh group helpers
         size_t countTriangles(const MeshGroup& meshGroup) const;
@@ -800,6 +834,8 @@ namespace Falcor
         void prepareSceneGraph();
         void prepareMeshes();
         void removeUnusedMeshes();
+        void removeMeshesWithoutInstances();
+        void detectMeshInstancing();
         void flattenStaticMeshInstances();
         void optimizeSceneGraph();
         void pretransformStaticMeshes();
@@ -30,11 +30,11 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Utils/FileDependencies.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
-#include <lz4_stream/lz4_stream.h>
-
-#include <fstream>
+#include <cstring>
 
 namespace Falcor
 {
@@ -43,37 +43,49 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 27;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
-
         const char* kMagic = "FalcorS$";
-        struct Header
-        {
-            uint8_t magic[8]{};
-            uint32_t version{};
 
-            bool isValid() const
-            {
-                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
-            }
+        /** Chunks stored in the cache file.
+            Chunks are compressed independently and decompressed in parallel when loading.
+        */
+        enum class Chunk : uint32_t
+        {
+            Scene,              ///< Path, render settings, cameras, lights, scene graph, animations and metadata.
+            Grids,              ///< Grids and grid volumes.
+            EnvMap,             ///< Environment map.
+            Materials,          ///< Materials.
+            Meshes,             ///< Mesh descriptors, instances and groups.
+            MeshIndexData,      ///< Mesh index buffer (stored uncompressed).
+            MeshStaticData,     ///< Mesh vertex buffer (stored uncompressed).
+            MeshSkinningData,   ///< Mesh skinning data (stored uncompressed).
+            CachedMeshes,       ///< Vertex cache for vertex-animated meshes.
+            Curves,             ///< Curve descriptors, instances and buffers.
+            CachedCurves,       ///< Vertex cache for dynamic curves.
+            CustomPrimitives,   ///< Custom primitives.
         };
     }
 
-    /** Wrapper around std::ostream to ease serialization of basic types.
+    /** Helper to serialize basic types into a chunk of the cache file.
+        The data is streamed to the file as it is written.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        OutputStream(ChunkedFileWriter& writer, Chunk chunk, ChunkedFileWriter::Compression compression = ChunkedFileWriter::Compression::LZ4)
+            : mWriter(writer)
+        {
+            mWriter.beginChunk((uint32_t)chunk, compression);
+        }
 
         void write(const void* data, size_t len)
         {
-            mStream.write(reinterpret_cast<const char*>(data), len);
+            mWriter.write(data, len);
         }
 
         template<typename T>
@@ -118,19 +130,22 @@ namespace Falcor
         }
 
     private:
-        std::ostream& mStream;
+        ChunkedFileWriter& mWriter;
     };
 
-    /** Wrapper around std::istream to ease serialization of basic types.
+    /** Helper to deserialize basic types from a chunk of the cache file.
+        Data is read directly from the memory mapped (or decompressed) chunk, large arrays are copied straight into their destination.
     */
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(const ChunkedFileReader::ChunkView& chunk) : mpData(chunk.pData), mSize(chunk.size) {}
 
         void read(void* data, size_t len)
         {
-            mStream.read(reinterpret_cast<char*>(data), len);
+            if (len > mSize - mOffset) throw RuntimeError("Unexpected end of scene cache chunk.");
+            std::memcpy(data, mpData + mOffset, len);
+            mOffset += len;
         }
 
         template<typename T>
@@ -165,13 +180,15 @@ namespace Falcor
         void read(std::vector<T>& vec)
         {
             uint64_t len = read<uint64_t>();
-            vec.resize(len);
             if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
             {
+                if (len > (mSize - mOffset) / sizeof(T)) throw RuntimeError("Unexpected end of scene cache chunk.");
+                vec.resize(len);
                 read(vec.data(), len * sizeof(T));
             }
             else
             {
+                vec.resize(len);
                 for (auto& item : vec) read(item);
             }
         }
@@ -189,48 +206,72 @@ namespace Falcor
         }
 
     private:
-        std::istream& mStream;
+        const uint8_t* mpData;
+        size_t mSize;
+        size_t mOffset = 0;
     };
 
     bool SceneCache::hasValidCache(const Key& key)
     {
         auto cachePath = getCachePath(key);
-        if (!std::filesystem::exists(cachePath)) return false;
+        auto manifestPath = getManifestPath(key);
+        if (!std::filesystem::exists(cachePath) || !std::filesystem::exists(manifestPath)) return false;
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) return false;
+        if (!ChunkedFileReader::isValid(cachePath, kMagic, kVersion)) return false;
 
-        // Verify header.
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        // Check that none of the scene's input files have changed.
+        try
+        {
+            auto manifest = FileDependencyManifest::read(manifestPath);
+            bool updated = false;
+            if (!manifest.validate(updated))
+            {
+                logInfo("Scene cache '{}' is out of date.", cachePath);
+                return false;
+            }
+            if (updated) manifest.write(manifestPath);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("Failed to validate scene cache: {}", e.what());
+            return false;
+        }
+
+        return true;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies)
     {
         auto cachePath = getCachePath(key);
+        auto manifestPath = getManifestPath(key);
 
         logInfo("Writing scene cache to '{}'.", cachePath);
 
         // Create directories if not existing.
         std::filesystem::create_directories(cachePath.parent_path());
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
+        // Reuse hashes of unchanged files from the previous manifest. The old manifest is removed first,
+        // so the cache is not considered valid if writing fails midway.
+        std::optional<FileDependencyManifest> previousManifest;
+        if (std::filesystem::exists(manifestPath))
+        {
+            try
+            {
+                previousManifest = FileDependencyManifest::read(manifestPath);
+            }
+            catch (const RuntimeError&)
+            {
+                // Without a previous manifest all files are hashed.
+            }
+            std::filesystem::remove(manifestPath);
+        }
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ChunkedFileWriter writer(cachePath, kMagic, kVersion);
+        writeSceneData(writer, sceneData);
+        writer.close();
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+        auto manifest = FileDependencyManifest::create(dependencies, previousManifest ? &previousManifest.value() : nullptr);
+        manifest.write(manifestPath);
     }
 
     Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
@@ -239,21 +280,9 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
-
-        // Read header (uncompressed).
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
-
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        // Open the file and decompress all chunks in parallel.
+        ChunkedFileReader reader(cachePath, kMagic, kVersion);
+        return readSceneData(reader, pDevice);
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -261,153 +290,362 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    std::filesystem::path SceneCache::getManifestPath(const Key& key)
+    {
+        auto path = getCachePath(key);
+        path += ".deps";
+        return path;
+    }
+
     // SceneData
 
-    void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
+    void SceneCache::writeSceneData(ChunkedFileWriter& writer, const Scene::SceneData& sceneData)
     {
-        writeMarker(stream, "Path");
-        stream.write(sceneData.path);
+        auto endChunk = [&writer](OutputStream& stream)
+        {
+            writeMarker(stream, "End");
+            writer.endChunk();
+        };
 
-        writeMarker(stream, "RenderSettings");
-        stream.write(sceneData.renderSettings);
+        // Large vertex/index buffers are stored uncompressed so they can be copied straight from the memory mapped file.
+        auto addArrayChunk = [&writer, &endChunk](Chunk chunk, const auto& vec)
+        {
+            OutputStream stream(writer, chunk, ChunkedFileWriter::Compression::None);
+            stream.write(vec);
+            endChunk(stream);
+        };
 
-        writeMarker(stream, "Cameras");
-        stream.write((uint32_t)sceneData.cameras.size());
-        for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
-        stream.write(sceneData.selectedCamera);
-        stream.write(sceneData.cameraSpeed);
+        {
+            OutputStream stream(writer, Chunk::Scene);
 
-        writeMarker(stream, "Lights");
-        stream.write((uint32_t)sceneData.lights.size());
-        for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
+            writeMarker(stream, "Path");
+            stream.write(sceneData.path);
 
-        writeMarker(stream, "Grids");
-        stream.write((uint32_t)sceneData.grids.size());
-        for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+            writeMarker(stream, "RenderSettings");
+            stream.write(sceneData.renderSettings);
 
-        writeMarker(stream, "GridVolumes");
-        stream.write((uint32_t)sceneData.gridVolumes.size());
-        for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
+            writeMarker(stream, "Cameras");
+            stream.write((uint32_t)sceneData.cameras.size());
+            for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
+            stream.write(sceneData.selectedCamera);
+            stream.write(sceneData.cameraSpeed);
 
-        writeMarker(stream, "EnvMap");
-        bool hasEnvMap = sceneData.pEnvMap != nullptr;
-        stream.write(hasEnvMap);
-        if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+            writeMarker(stream, "Lights");
+            stream.write((uint32_t)sceneData.lights.size());
+            for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
 
-        writeMarker(stream, "Materials");
-        writeMaterials(stream, *sceneData.pMaterials);
+            writeMarker(stream, "SceneGraph");
+            stream.write((uint32_t)sceneData.sceneGraph.size());
+            for (const auto& node : sceneData.sceneGraph)
+            {
+                stream.write(node.name);
+                stream.write(node.parent);
+                stream.write(node.transform);
+                stream.write(node.meshBind);
+                stream.write(node.localToBindSpace);
+            }
 
-        writeMarker(stream, "SceneGraph");
-        stream.write((uint32_t)sceneData.sceneGraph.size());
-        for (const auto& node : sceneData.sceneGraph)
-        {
-            stream.write(node.name);
-            stream.write(node.parent);
-            stream.write(node.transform);
-            stream.write(node.meshBind);
-            stream.write(node.localToBindSpace);
+            writeMarker(stream, "Animations");
+            stream.write((uint32_t)sceneData.animations.size());
+            for (const auto& pAnimation : sceneData.animations)
+            {
+                writeAnimation(stream, pAnimation);
+            }
+
+            writeMarker(stream, "Metadata");
+            writeMetadata(stream, sceneData.metadata);
+
+            endChunk(stream);
         }
 
-        writeMarker(stream, "Animations");
-        stream.write((uint32_t)sceneData.animations.size());
-        for (const auto& pAnimation : sceneData.animations)
         {
-            writeAnimation(stream, pAnimation);
+            OutputStream stream(writer, Chunk::Grids);
+
+            writeMarker(stream, "Grids");
+            stream.write((uint32_t)sceneData.grids.size());
+            for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+
+            writeMarker(stream, "GridVolumes");
+            stream.write((uint32_t)sceneData.gridVolumes.size());
+            for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
+
+            endChunk(stream);
         }
 
-        writeMarker(stream, "Metadata");
-        writeMetadata(stream, sceneData.metadata);
+        {
+            OutputStream stream(writer, Chunk::EnvMap);
+
+            writeMarker(stream, "EnvMap");
+            bool hasEnvMap = sceneData.pEnvMap != nullptr;
+            stream.write(hasEnvMap);
+            if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+
+            endChunk(stream);
+        }
 
-        writeMarker(stream, "Meshes");
-        stream.write(sceneData.meshDesc);
-        stream.write(sceneData.meshNames);
-        stream.write(sceneData.meshBBs);
-        stream.write(sceneData.meshInstanceData);
-        stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
-        for (const auto& item : sceneData.meshIdToInstanceIds)
         {
-            stream.write(item);
+            OutputStream stream(writer, Chunk::Materials);
+
+            writeMarker(stream, "Materials");
+            writeMaterials(stream, *sceneData.pMaterials);
+
+            endChunk(stream);
         }
-        stream.write((uint32_t)sceneData.meshGroups.size());
-        for (const auto& group : sceneData.meshGroups)
+
         {
-            stream.write(group.meshList);
-            stream.write(group.isStatic);
-            stream.write(group.isDisplaced);
+            OutputStream stream(writer, Chunk::Meshes);
+
+            writeMarker(stream, "Meshes");
+            stream.write(sceneData.meshDesc);
+            stream.write(sceneData.meshNames);
+            stream.write(sceneData.meshBBs);
+            stream.write(sceneData.meshInstanceData);
+            stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
+            for (const auto& item : sceneData.meshIdToInstanceIds)
+            {
+                stream.write(item);
+            }
+            stream.write((uint32_t)sceneData.meshGroups.size());
+            for (const auto& group : sceneData.meshGroups)
+            {
+                stream.write(group.meshList);
+                stream.write(group.isStatic);
+                stream.write(group.isDisplaced);
+            }
+            stream.write(sceneData.useCompressedHitInfo);
+            stream.write(sceneData.has16BitIndices);
+            stream.write(sceneData.has32BitIndices);
+            stream.write(sceneData.meshDrawCount);
+
+            endChunk(stream);
         }
-        stream.write((uint32_t)sceneData.cachedMeshes.size());
-        for (const auto& cachedMesh : sceneData.cachedMeshes)
+
+        addArrayChunk(Chunk::MeshIndexData, sceneData.meshIndexData);
+        addArrayChunk(Chunk::MeshStaticData, sceneData.meshStaticData);
+        addArrayChunk(Chunk::MeshSkinningData, sceneData.meshSkinningData);
+
         {
-            stream.write(cachedMesh.meshID);
-            stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            OutputStream stream(writer, Chunk::CachedMeshes);
+
+            writeMarker(stream, "CachedMeshes");
+            stream.write((uint32_t)sceneData.cachedMeshes.size());
+            for (const auto& cachedMesh : sceneData.cachedMeshes)
+            {
+                stream.write(cachedMesh.meshID);
+                stream.write(cachedMesh.timeSamples);
+                stream.write((uint32_t)cachedMesh.vertexData.size());
+                for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            }
+
+            endChunk(stream);
         }
-        stream.write(sceneData.useCompressedHitInfo);
-        stream.write(sceneData.has16BitIndices);
-        stream.write(sceneData.has32BitIndices);
-        stream.write(sceneData.meshDrawCount);
-        stream.write(sceneData.meshIndexData);
-        stream.write(sceneData.meshStaticData);
-        stream.write(sceneData.meshSkinningData);
 
-        writeMarker(stream, "Curves");
-        stream.write(sceneData.curveDesc);
-        stream.write(sceneData.curveBBs);
-        stream.write(sceneData.curveInstanceData);
-        stream.write(sceneData.curveIndexData);
-        stream.write(sceneData.curveStaticData);
+        {
+            OutputStream stream(writer, Chunk::Curves);
+
+            writeMarker(stream, "Curves");
+            stream.write(sceneData.curveDesc);
+            stream.write(sceneData.curveBBs);
+            stream.write(sceneData.curveInstanceData);
+            stream.write(sceneData.curveIndexData);
+            stream.write(sceneData.curveStaticData);
+
+            endChunk(stream);
+        }
 
-        stream.write((uint32_t)sceneData.cachedCurves.size());
-        for (const auto& cachedCurve : sceneData.cachedCurves)
         {
-            stream.write(cachedCurve.tessellationMode);
-            stream.write(cachedCurve.geometryID);
-            stream.write(cachedCurve.timeSamples);
-            stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            OutputStream stream(writer, Chunk::CachedCurves);
+
+            writeMarker(stream, "CachedCurves");
+            stream.write((uint32_t)sceneData.cachedCurves.size());
+            for (const auto& cachedCurve : sceneData.cachedCurves)
+            {
+                stream.write(cachedCurve.tessellationMode);
+                stream.write(cachedCurve.geometryID);
+                stream.write(cachedCurve.timeSamples);
+                stream.write(cachedCurve.indexData);
+                stream.write((uint32_t)cachedCurve.vertexData.size());
+                for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            }
+
+            endChunk(stream);
         }
 
-        writeMarker(stream, "CustomPrimitives");
-        stream.write(sceneData.customPrimitiveDesc);
-        stream.write(sceneData.customPrimitiveAABBs);
+        {
+            OutputStream stream(writer, Chunk::CustomPrimitives);
+
+            writeMarker(stream, "CustomPrimitives");
+            stream.write(sceneData.customPrimitiveDesc);
+            stream.write(sceneData.customPrimitiveAABBs);
 
-        writeMarker(stream, "End");
+            endChunk(stream);
+        }
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(const ChunkedFileReader& reader, ref<Device> pDevice)
     {
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
 
-        readMarker(stream, "Path");
-        stream.read(sceneData.path);
+        auto readChunk = [&reader](Chunk chunk, auto readFunc)
+        {
+            InputStream stream(reader.getChunk((uint32_t)chunk));
+            readFunc(stream);
+            readMarker(stream, "End");
+        };
 
-        readMarker(stream, "RenderSettings");
-        stream.read(sceneData.renderSettings);
+        auto readArrayChunk = [&readChunk](Chunk chunk, auto& vec)
+        {
+            readChunk(chunk, [&vec](InputStream& stream) { stream.read(vec); });
+        };
 
-        readMarker(stream, "Cameras");
-        sceneData.cameras.resize(stream.read<uint32_t>());
-        for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
-        stream.read(sceneData.selectedCamera);
-        stream.read(sceneData.cameraSpeed);
+        // Geometry chunks only contain plain data and are deserialized on the thread pool
+        // while the chunks holding GPU resources are deserialized on the calling thread below.
+        Threading::TaskGroup geometryTasks;
 
-        readMarker(stream, "Lights");
-        sceneData.lights.resize(stream.read<uint32_t>());
-        for (auto& pLight : sceneData.lights) pLight = readLight(stream);
+        geometryTasks.run([&]()
+        {
+            readChunk(Chunk::Meshes, [&sceneData](InputStream& stream)
+            {
+                readMarker(stream, "Meshes");
+                stream.read(sceneData.meshDesc);
+                stream.read(sceneData.meshNames);
+                stream.read(sceneData.meshBBs);
+                stream.read(sceneData.meshInstanceData);
+                sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
+                for (auto& item : sceneData.meshIdToInstanceIds)
+                {
+                    stream.read(item);
+                }
+                sceneData.meshGroups.resize(stream.read<uint32_t>());
+                for (auto& group : sceneData.meshGroups)
+                {
+                    stream.read(group.meshList);
+                    stream.read(group.isStatic);
+                    stream.read(group.isDisplaced);
+                }
+                stream.read(sceneData.useCompressedHitInfo);
+                stream.read(sceneData.has16BitIndices);
+                stream.read(sceneData.has32BitIndices);
+                stream.read(sceneData.meshDrawCount);
+            });
+        });
+
+        geometryTasks.run([&]() { readArrayChunk(Chunk::MeshIndexData, sceneData.meshIndexData); });
+        geometryTasks.run([&]() { readArrayChunk(Chunk::MeshStaticData, sceneData.meshStaticData); });
+        geometryTasks.run([&]() { readArrayChunk(Chunk::MeshSkinningData, sceneData.meshSkinningData); });
+
+        geometryTasks.run([&]()
+        {
+            readChunk(Chunk::CachedMeshes, [&sceneData](InputStream& stream)
+            {
+                readMarker(stream, "CachedMeshes");
+                sceneData.cachedMeshes.resize(stream.read<uint32_t>());
+                for (auto& cachedMesh : sceneData.cachedMeshes)
+                {
+                    stream.read(cachedMesh.meshID);
+                    stream.read(cachedMesh.timeSamples);
+                    cachedMesh.vertexData.resize(stream.read<uint32_t>());
+                    for (auto& data : cachedMesh.vertexData) stream.read(data);
+                }
+            });
+        });
+
+        geometryTasks.run([&]()
+        {
+            readChunk(Chunk::Curves, [&sceneData](InputStream& stream)
+            {
+                readMarker(stream, "Curves");
+                stream.read(sceneData.curveDesc);
+                stream.read(sceneData.curveBBs);
+                stream.read(sceneData.curveInstanceData);
+                stream.read(sceneData.curveIndexData);
+                stream.read(sceneData.curveStaticData);
+            });
+        });
+
+        geometryTasks.run([&]()
+        {
+            readChunk(Chunk::CachedCurves, [&sceneData](InputStream& stream)
+            {
+                readMarker(stream, "CachedCurves");
+                sceneData.cachedCurves.resize(stream.read<uint32_t>());
+                for (auto& cachedCurve : sceneData.cachedCurves)
+                {
+                    stream.read(cachedCurve.tessellationMode);
+                    stream.read(cachedCurve.geometryID);
+                    stream.read(cachedCurve.timeSamples);
+                    stream.read(cachedCurve.indexData);
+                    cachedCurve.vertexData.resize(stream.read<uint32_t>());
+                    for (auto& data : cachedCurve.vertexData) stream.read(data);
+                }
+            });
+        });
+
+        geometryTasks.run([&]()
+        {
+            readChunk(Chunk::CustomPrimitives, [&sceneData](InputStream& stream)
+            {
+                readMarker(stream, "CustomPrimitives");
+                stream.read(sceneData.customPrimitiveDesc);
+                stream.read(sceneData.customPrimitiveAABBs);
+            });
+        });
 
-        readMarker(stream, "Grids");
-        sceneData.grids.resize(stream.read<uint32_t>());
-        for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+        readChunk(Chunk::Scene, [&sceneData](InputStream& stream)
+        {
+            readMarker(stream, "Path");
+            stream.read(sceneData.path);
+
+            readMarker(stream, "RenderSettings");
+            stream.read(sceneData.renderSettings);
+
+            readMarker(stream, "Cameras");
+            sceneData.cameras.resize(stream.read<uint32_t>());
+            for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
+            stream.read(sceneData.selectedCamera);
+            stream.read(sceneData.cameraSpeed);
+
+            readMarker(stream, "Lights");
+            sceneData.lights.resize(stream.read<uint32_t>());
+            for (auto& pLight : sceneData.lights) pLight = readLight(stream);
+
+            readMarker(stream, "SceneGraph");
+            sceneData.sceneGraph.resize(stream.read<uint32_t>());
+            for (auto &node : sceneData.sceneGraph)
+            {
+                stream.read(node.name);
+                stream.read(node.parent);
+                stream.read(node.transform);
+                stream.read(node.meshBind);
+                stream.read(node.localToBindSpace);
+            }
 
-        readMarker(stream, "GridVolumes");
-        sceneData.gridVolumes.resize(stream.read<uint32_t>());
-        for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+            readMarker(stream, "Animations");
+            sceneData.animations.resize(stream.read<uint32_t>());
+            for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
 
-        readMarker(stream, "EnvMap");
-        auto hasEnvMap = stream.read<bool>();
-        if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+            readMarker(stream, "Metadata");
+            sceneData.metadata = readMetadata(stream);
+        });
+
+        readChunk(Chunk::Grids, [&sceneData, &pDevice](InputStream& stream)
+        {
+            readMarker(stream, "Grids");
+            sceneData.grids.resize(stream.read<uint32_t>());
+            for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+
+            readMarker(stream, "GridVolumes");
+            sceneData.gridVolumes.resize(stream.read<uint32_t>());
+            for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+        });
+
+        readChunk(Chunk::EnvMap, [&sceneData, &pDevice](InputStream& stream)
+        {
+            readMarker(stream, "EnvMap");
+            auto hasEnvMap = stream.read<bool>();
+            if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+        });
 
         // Material textures are loaded asynchronously to allow loading other data
         // in parallel while loading textures from files and uploading them to the GPU.
@@ -418,83 +656,13 @@ namespace Falcor
         // further down which blocks until all textures are loaded.
         auto pMaterialTextureLoader = std::make_unique<MaterialTextureLoader>(sceneData.pMaterials->getTextureManager(), true);
 
-        readMarker(stream, "Materials");
-        readMaterials(stream, *sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
-
-        readMarker(stream, "SceneGraph");
-        sceneData.sceneGraph.resize(stream.read<uint32_t>());
-        for (auto &node : sceneData.sceneGraph)
-        {
-            stream.read(node.name);
-            stream.read(node.parent);
-            stream.read(node.transform);
-            stream.read(node.meshBind);
-            stream.read(node.localToBindSpace);
-        }
-
-        readMarker(stream, "Animations");
-        sceneData.animations.resize(stream.read<uint32_t>());
-        for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
-
-        readMarker(stream, "Metadata");
-        sceneData.metadata = readMetadata(stream);
-
-        readMarker(stream, "Meshes");
-        stream.read(sceneData.meshDesc);
-        stream.read(sceneData.meshNames);
-        stream.read(sceneData.meshBBs);
-        stream.read(sceneData.meshInstanceData);
-        sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
-        for (auto& item : sceneData.meshIdToInstanceIds)
-        {
-            stream.read(item);
-        }
-        sceneData.meshGroups.resize(stream.read<uint32_t>());
-        for (auto& group : sceneData.meshGroups)
-        {
-            stream.read(group.meshList);
-            stream.read(group.isStatic);
-            stream.read(group.isDisplaced);
-        }
-        sceneData.cachedMeshes.resize(stream.read<uint32_t>());
-        for (auto& cachedMesh : sceneData.cachedMeshes)
-        {
-            stream.read(cachedMesh.meshID);
-            stream.read(cachedMesh.timeSamples);
-            cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
-        }
-        stream.read(sceneData.useCompressedHitInfo);
-        stream.read(sceneData.has16BitIndices);
-        stream.read(sceneData.has32BitIndices);
-        stream.read(sceneData.meshDrawCount);
-        stream.read(sceneData.meshIndexData);
-        stream.read(sceneData.meshStaticData);
-        stream.read(sceneData.meshSkinningData);
-
-        readMarker(stream, "Curves");
-        stream.read(sceneData.curveDesc);
-        stream.read(sceneData.curveBBs);
-        stream.read(sceneData.curveInstanceData);
-        stream.read(sceneData.curveIndexData);
-        stream.read(sceneData.curveStaticData);
-
-        sceneData.cachedCurves.resize(stream.read<uint32_t>());
-        for (auto& cachedCurve : sceneData.cachedCurves)
+        readChunk(Chunk::Materials, [&](InputStream& stream)
         {
-            stream.read(cachedCurve.tessellationMode);
-            stream.read(cachedCurve.geometryID);
-            stream.read(cachedCurve.timeSamples);
-            stream.read(cachedCurve.indexData);
-            cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
-        }
-
-        readMarker(stream, "CustomPrimitives");
-        stream.read(sceneData.customPrimitiveDesc);
-        stream.read(sceneData.customPrimitiveAABBs);
+            readMarker(stream, "Materials");
+            readMaterials(stream, *sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
+        });
 
-        readMarker(stream, "End");
+        geometryTasks.finish();
 
         pMaterialTextureLoader.reset();
 
@@ -918,7 +1086,10 @@ namespace Falcor
         stream.write(pAnimation->mPostInfinityBehavior);
         stream.write(pAnimation->mInterpolationMode);
         stream.write(pAnimation->mEnableWarping);
-        stream.write(pAnimation->mKeyframes);
+        stream.write(pAnimation->mTimes);
+        stream.write(pAnimation->mTranslations);
+        stream.write(pAnimation->mScalings);
+        stream.write(pAnimation->mRotations);
     }
 
     ref<Animation> SceneCache::readAnimation(InputStream& stream)
@@ -931,7 +1102,10 @@ namespace Falcor
         stream.read(pAnimation->mPostInfinityBehavior);
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
-        stream.read(pAnimation->mKeyframes);
+        stream.read(pAnimation->mTimes);
+        stream.read(pAnimation->mTranslations);
+        stream.read(pAnimation->mScalings);
+        stream.read(pAnimation->mRotations);
         return pAnimation;
     }
 
@@ -39,6 +39,7 @@
 
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
+#include "Utils/ChunkedFile.h"
 #include "Utils/CryptoUtils.h"
 
 #include <filesystem>
@@ -50,6 +51,7 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        The data is split into independently compressed chunks (see `ChunkedFileWriter`) which are decompressed in parallel when loading.
     */
     class FALCOR_API SceneCache
     {
@@ -57,6 +59,7 @@ namespace Falcor
         using Key = SHA1::MD;
 
         /** Check if there is a valid scene cache for a given cache key.
+            The cache is valid if none of the files the scene was imported from have changed (see FileDependencyManifest).
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
@@ -65,8 +68,9 @@ namespace Falcor
         /** Write a scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Files the scene was imported from. These are stored in a manifest next to the cache.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies);
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -80,9 +84,10 @@ namespace Falcor
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getManifestPath(const Key& key);
 
-        static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
+        static void writeSceneData(ChunkedFileWriter& writer, const Scene::SceneData& sceneData);
+        static Scene::SceneData readSceneData(const ChunkedFileReader& reader, ref<Device> pDevice);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
@@ -0,0 +1,205 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BrickedGrid.h"
+#include "Core/Errors.h"
+#include "Core/API/Device.h"
+#include "Utils/ChunkedFile.h"
+#include "Utils/Logger.h"
+#include <cctype>
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kCacheMagic[] = "FBRICKS";
+        const uint32_t kCacheVersion = 1;
+        const char kCacheExtension[] = ".bricks";
+
+        enum class Chunk : uint32_t
+        {
+            Header = 0,
+            Range = 1,
+            Indirection = 2,
+            Atlas = 3,
+        };
+
+        struct CacheHeader
+        {
+            uint64_t sourceSize;        ///< Size of the source file in bytes.
+            int64_t sourceWriteTime;    ///< Last write time of the source file.
+            uint32_t rangeSize[3];
+            uint32_t atlasSize[3];
+            uint32_t atlasFormat;
+            uint32_t gridnameLength;    ///< Length of the grid name stored after the header.
+        };
+
+        bool getSourceStamp(const std::filesystem::path& sourcePath, uint64_t& size, int64_t& writeTime)
+        {
+            std::error_code ec;
+            size = std::filesystem::file_size(sourcePath, ec);
+            if (ec) return false;
+            auto time = std::filesystem::last_write_time(sourcePath, ec);
+            if (ec) return false;
+            writeTime = (int64_t)time.time_since_epoch().count();
+            return true;
+        }
+
+        size_t getAtlasByteSize(const uint3& atlasSize, ResourceFormat format)
+        {
+            const uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+            const uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+            return size_t(atlasSize.x / blockWidth) * (atlasSize.y / blockHeight) * atlasSize.z * getFormatBytesPerBlock(format);
+        }
+
+        template<typename T>
+        void addChunk(ChunkedFileWriter& writer, Chunk chunk, const std::vector<T>& v)
+        {
+            writer.addChunk((uint32_t)chunk, v.data(), v.size() * sizeof(T));
+        }
+
+        template<typename T>
+        void fromChunk(const ChunkedFileReader::ChunkView& chunk, std::vector<T>& v)
+        {
+            if (chunk.size % sizeof(T) != 0) throw RuntimeError("Invalid chunk size {}.", chunk.size);
+            v.resize(chunk.size / sizeof(T));
+            if (chunk.size > 0) std::memcpy(v.data(), chunk.pData, chunk.size);
+        }
+    }
+
+    BrickedGrid BrickedGridData::createTextures(ref<Device> pDevice) const
+    {
+        BrickedGrid bricks;
+        bricks.range = Texture::create3D(pDevice, rangeSize.x, rangeSize.y, rangeSize.z, ResourceFormat::RG16Float, 4, range.data(), ResourceBindFlags::ShaderResource, false);
+        bricks.indirection = Texture::create3D(pDevice, rangeSize.x, rangeSize.y, rangeSize.z, ResourceFormat::RGBA8Uint, 1, indirection.data(), ResourceBindFlags::ShaderResource, false);
+        bricks.atlas = Texture::create3D(pDevice, atlasSize.x, atlasSize.y, atlasSize.z, atlasFormat, 1, atlas.data(), ResourceBindFlags::ShaderResource, false);
+        return bricks;
+    }
+
+    std::filesystem::path BrickedGridCache::getCachePath(const std::filesystem::path& sourcePath, const std::string& gridname)
+    {
+        // Grid names can contain arbitrary characters, only keep the ones that are safe in file names.
+        std::string name = gridname;
+        for (char& c : name)
+        {
+            if (!std::isalnum((unsigned char)c) && c != '-' && c != '_') c = '_';
+        }
+
+        std::filesystem::path cachePath = sourcePath;
+        cachePath += "." + name + kCacheExtension;
+        return cachePath;
+    }
+
+    bool BrickedGridCache::read(const std::filesystem::path& sourcePath, const std::string& gridname, BrickedGridData& data)
+    {
+        const auto cachePath = getCachePath(sourcePath, gridname);
+
+        uint64_t sourceSize;
+        int64_t sourceWriteTime;
+        std::error_code ec;
+        if (!std::filesystem::exists(cachePath, ec) || !getSourceStamp(sourcePath, sourceSize, sourceWriteTime)) return false;
+        if (!ChunkedFileReader::isValid(cachePath, kCacheMagic, kCacheVersion)) return false;
+
+        try
+        {
+            ChunkedFileReader reader(cachePath, kCacheMagic, kCacheVersion);
+
+            // Check that the cache entry belongs to the current version of the source grid.
+            auto headerChunk = reader.getChunk((uint32_t)Chunk::Header);
+            CacheHeader header;
+            if (headerChunk.size < sizeof(header)) return false;
+            std::memcpy(&header, headerChunk.pData, sizeof(header));
+            if (headerChunk.size != sizeof(header) + header.gridnameLength) return false;
+            std::string cachedGridname((const char*)headerChunk.pData + sizeof(header), header.gridnameLength);
+            if (header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime || cachedGridname != gridname)
+            {
+                logDebug("Bricked grid cache '{}' is out of date.", cachePath);
+                return false;
+            }
+
+            BrickedGridData cached;
+            cached.rangeSize = uint3(header.rangeSize[0], header.rangeSize[1], header.rangeSize[2]);
+            cached.atlasSize = uint3(header.atlasSize[0], header.atlasSize[1], header.atlasSize[2]);
+            cached.atlasFormat = (ResourceFormat)header.atlasFormat;
+            fromChunk(reader.getChunk((uint32_t)Chunk::Range), cached.range);
+            fromChunk(reader.getChunk((uint32_t)Chunk::Indirection), cached.indirection);
+            fromChunk(reader.getChunk((uint32_t)Chunk::Atlas), cached.atlas);
+
+            const size_t brickCount = size_t(cached.rangeSize.x) * cached.rangeSize.y * cached.rangeSize.z;
+            if (cached.indirection.size() != brickCount || cached.range.size() < brickCount ||
+                cached.atlas.size() != getAtlasByteSize(cached.atlasSize, cached.atlasFormat))
+            {
+                throw RuntimeError("Inconsistent data sizes.");
+            }
+
+            data = std::move(cached);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to read bricked grid cache '{}': {}", cachePath, e.what());
+            return false;
+        }
+
+        logDebug("Loaded bricked grid '{}' from cache '{}'.", gridname, cachePath);
+        return true;
+    }
+
+    void BrickedGridCache::write(const std::filesystem::path& sourcePath, const std::string& gridname, const BrickedGridData& data)
+    {
+        const auto cachePath = getCachePath(sourcePath, gridname);
+
+        CacheHeader header = {};
+        if (!getSourceStamp(sourcePath, header.sourceSize, header.sourceWriteTime)) return;
+        for (int i = 0; i < 3; ++i)
+        {
+            header.rangeSize[i] = data.rangeSize[i];
+            header.atlasSize[i] = data.atlasSize[i];
+        }
+        header.atlasFormat = (uint32_t)data.atlasFormat;
+        header.gridnameLength = (uint32_t)gridname.size();
+
+        // The writer goes through a temporary file so that readers never see a partially written cache.
+        try
+        {
+            ChunkedFileWriter writer(cachePath, kCacheMagic, kCacheVersion);
+            writer.beginChunk((uint32_t)Chunk::Header, ChunkedFileWriter::Compression::None);
+            writer.write(&header, sizeof(header));
+            writer.write(gridname.data(), gridname.size());
+            writer.endChunk();
+            addChunk(writer, Chunk::Range, data.range);
+            addChunk(writer, Chunk::Indirection, data.indirection);
+            addChunk(writer, Chunk::Atlas, data.atlas);
+            writer.close();
+            logDebug("Wrote bricked grid '{}' to cache '{}'.", gridname, cachePath);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write bricked grid cache '{}': {}", cachePath, e.what());
+        }
+    }
+}
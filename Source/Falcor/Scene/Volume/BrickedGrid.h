@@ -26,7 +26,13 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
 #include "Core/API/Texture.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <string>
+#include <vector>
 
 namespace Falcor
 {
@@ -36,4 +42,53 @@ namespace Falcor
         ref<Texture> indirection;
         ref<Texture> atlas;
     };
+
+    /** CPU-side data of a bricked grid.
+        This is produced by the NanoVDB converter and used to create the textures of a BrickedGrid and to cache converted grids on disk.
+    */
+    struct FALCOR_API BrickedGridData
+    {
+        uint3 rangeSize = uint3(0);                     ///< Size of the range and indirection textures in bricks (mip 0).
+        uint3 atlasSize = uint3(0);                     ///< Size of the atlas texture in texels.
+        ResourceFormat atlasFormat = ResourceFormat::Unknown; ///< Format of the atlas texture.
+        std::vector<uint32_t> range;                    ///< Packed fp16 majorant/minorant per brick for all 4 mip levels.
+        std::vector<uint32_t> indirection;              ///< Packed atlas brick coordinates per brick.
+        std::vector<uint8_t> atlas;                     ///< Atlas texel data.
+
+        /** Create the GPU textures.
+            \param[in] pDevice GPU device.
+            \return The bricked grid.
+        */
+        BrickedGrid createTextures(ref<Device> pDevice) const;
+    };
+
+    /** On-disk cache for converted bricked grids.
+        Cache files are stored next to the source grid file and are invalidated when the source file changes.
+    */
+    class FALCOR_API BrickedGridCache
+    {
+    public:
+        /** Get the path of the cache file for a grid.
+            \param[in] sourcePath Path of the source grid file.
+            \param[in] gridname Name of the grid.
+            \return Path of the cache file.
+        */
+        static std::filesystem::path getCachePath(const std::filesystem::path& sourcePath, const std::string& gridname);
+
+        /** Read a converted grid from the cache.
+            \param[in] sourcePath Path of the source grid file.
+            \param[in] gridname Name of the grid.
+            \param[out] data Converted grid data.
+            \return True if a valid cache entry was found and read.
+        */
+        static bool read(const std::filesystem::path& sourcePath, const std::string& gridname, BrickedGridData& data);
+
+        /** Write a converted grid to the cache.
+            Failures are logged but not reported to the caller, as the cache is only an optimization.
+            \param[in] sourcePath Path of the source grid file.
+            \param[in] gridname Name of the grid.
+            \param[in] data Converted grid data.
+        */
+        static void write(const std::filesystem::path& sourcePath, const std::string& gridname, const BrickedGridData& data);
+    };
 }
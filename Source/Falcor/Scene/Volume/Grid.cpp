@@ -203,7 +203,7 @@ namespace Falcor
         return math::translate(float4x4(invAffine), -translation);
     }
 
-    Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, const std::filesystem::path& sourcePath, const std::string& gridname)
         : mpDevice(pDevice)
         , mGridHandle(std::move(gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
@@ -224,7 +224,16 @@ namespace Falcor
             mGridHandle.data()
         );
         using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
+
+        // Converting large grids to bricks is expensive, so the result is cached next to the source file.
+        BrickedGridData bricks;
+        bool cached = !sourcePath.empty() && BrickedGridCache::read(sourcePath, gridname, bricks) && bricks.atlasFormat == NanoVDBGridConverter::getAtlasFormat();
+        if (!cached)
+        {
+            bricks = NanoVDBGridConverter(mpFloatGrid).convertToData();
+            if (!sourcePath.empty()) BrickedGridCache::write(sourcePath, gridname, bricks);
+        }
+        mBrickedGrid = bricks.createTextures(mpDevice);
     }
 
     ref<Grid> Grid::createFromNanoVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
@@ -255,7 +264,7 @@ namespace Falcor
             return nullptr;
         }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return ref<Grid>(new Grid(pDevice, std::move(handle), path, gridname));
     }
 
     ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
@@ -298,7 +307,7 @@ namespace Falcor
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
         auto handle = nanovdb::openToNanoVDB(floatGrid);
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return ref<Grid>(new Grid(pDevice, std::move(handle), path, gridname));
     }
 
 
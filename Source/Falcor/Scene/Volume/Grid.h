@@ -145,7 +145,9 @@ namespace Falcor
         float4x4 getInvTransform() const;
 
     private:
-        Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        /** Create a grid. If a source path is given, the converted brick textures are cached next to the source file.
+        */
+        Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, const std::filesystem::path& sourcePath = {}, const std::string& gridname = {});
 
         static ref<Grid> createFromNanoVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
         static ref<Grid> createFromOpenVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
@@ -31,7 +31,7 @@
 #include "Core/API/Formats.h"
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/CpuTimer.h"
 
@@ -45,8 +45,6 @@
 #endif
 
 #include <algorithm>
-#include <atomic>
-#include <execution>
 #include <vector>
 
 namespace Falcor
@@ -63,28 +61,38 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
+        /** Convert the grid and create the GPU textures.
+        */
         BrickedGrid convert(ref<Device> pDevice);
 
+        /** Convert the grid to CPU-side data. The converter can only be used once.
+            Bricks are placed in the atlas in scan order, so the result does not depend on the number of threads.
+            \param[in] parallel Convert rows of bricks in parallel. If false, the grid is converted on the calling thread.
+        */
+        BrickedGridData convertToData(bool parallel = true);
+
+        static ResourceFormat getAtlasFormat() {
+            switch (kBitsPerTexel) {
+            case 4: return ResourceFormat::BC4Unorm;
+            case 8: return ResourceFormat::R8Unorm;
+            case 16: return ResourceFormat::R16Unorm;
+            default: throw RuntimeError("Unsupported bitdepth in NanoVDBToBricksConverter");
+            }
+        }
+
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
 
-        void convertSlice(int z);
+        uint32_t computeRowRanges(nanovdb::FloatGrid::AccessorType& a, int y, int z);
+        void writeRowBricks(nanovdb::FloatGrid::AccessorType& a, int y, int z, uint32_t firstBrick);
         void computeMip(int mip);
+        void expandHalo(nanovdb::FloatGrid::AccessorType& a, const nanovdb::Coord& ijk, float& minorant, float& majorant);
 
         inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
         inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
         inline uint32_t getAtlasMaxBrick() const { return mAtlasSizeBricks.x * mAtlasSizeBricks.y * mAtlasSizeBricks.z; }
 
-        inline ResourceFormat getAtlasFormat() {
-            switch (kBitsPerTexel) {
-            case 4: return ResourceFormat::BC4Unorm;
-            case 8: return ResourceFormat::R8Unorm;
-            case 16: return ResourceFormat::R16Unorm;
-            default: throw RuntimeError("Unsupported bitdepth in NanoVDBToBricksConverter");
-            }
-        }
-
         inline float2 combineMajMin(float2 a, float2 b)
         {
             return float2(std::max(a.x, b.x), std::min(a.y, b.y));
@@ -109,14 +117,13 @@ namespace Falcor
         uint32_t mLeafCount[4];
         std::vector<uint32_t> mRangeData;
         std::vector<uint32_t> mPtrData;
-        std::vector<TexelType> mAtlasData;
-        std::atomic_uint32_t mNonEmptyCount;
+        std::vector<uint8_t> mAtlasData; // Stored as bytes so it can be handed to BrickedGridData without a copy.
+        uint32_t mNonEmptyCount = 0;
     };
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid)
     {
-        mNonEmptyCount.store(0);
         mpFloatGrid = grid;
         auto& voxelbox = mpFloatGrid->indexBBox();
         mBBMin = (int3(voxelbox.min().x(), voxelbox.min().y(), voxelbox.min().z())) & (~7);
@@ -136,115 +143,171 @@ namespace Falcor
         uint leafTexelCount = atlasSizePixels.x * atlasSizePixels.y * atlasSizePixels.z;
         mRangeData.resize(mLeafCount[3]);
         mPtrData.resize(mLeafCount[0]);
-        mAtlasData.resize(kBC4Compress ? (leafTexelCount / 16) : leafTexelCount);
+        mAtlasData.resize((kBC4Compress ? (leafTexelCount / 16) : leafTexelCount) * sizeof(TexelType));
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::expandHalo(nanovdb::FloatGrid::AccessorType& a, const nanovdb::Coord& ijk, float& minorant, float& majorant)
+    {
+        // Expand the range by the 1-voxel halo around the brick at ijk. The halo is gathered from the buffers of the 26 neighbouring
+        // leaves. A missing neighbour leaf is covered by a tile of constant value, which is fetched with a single accessor lookup.
+        const int kLast = kBrickSize - 1;
+        for (int dz = -1; dz <= 1; ++dz)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    if (dx == 0 && dy == 0 && dz == 0) continue;
+
+                    const nanovdb::Coord neighbour = ijk + nanovdb::Coord(dx * kBrickSize, dy * kBrickSize, dz * kBrickSize);
+                    const auto* leaf = a.probeLeaf(neighbour);
+                    if (!leaf)
+                    {
+                        expandMinorantMajorant(a.getValue(neighbour), minorant, majorant);
+                        continue;
+                    }
+
+                    // Voxels of the neighbour leaf adjacent to the brick: the far side along offset axes, all voxels along the others.
+                    const int x0 = dx < 0 ? kLast : 0, x1 = dx > 0 ? 0 : kLast;
+                    const int y0 = dy < 0 ? kLast : 0, y1 = dy > 0 ? 0 : kLast;
+                    const int z0 = dz < 0 ? kLast : 0, z1 = dz > 0 ? 0 : kLast;
+                    const float* data = leaf->data()->mValues;
+                    for (int x = x0; x <= x1; ++x)
+                    {
+                        for (int y = y0; y <= y1; ++y)
+                        {
+                            const float* row = data + x * kBrickSize * kBrickSize + y * kBrickSize;
+                            for (int z = z0; z <= z1; ++z) expandMinorantMajorant(row[z], minorant, majorant);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    uint32_t NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeRowRanges(nanovdb::FloatGrid::AccessorType& a, int y, int z)
+    {
+        // Compute the range of each brick in the row. Non-empty bricks are marked with a non-zero indirection entry, they are
+        // assigned their atlas location by writeRowBricks().
+        size_t offset = (z * mLeafDim[0].y + y) * mLeafDim[0].x;
+        uint32_t* rangedst = mRangeData.data() + offset;
+        uint32_t* ptrdst = mPtrData.data() + offset;
+        uint32_t nonEmptyCount = 0;
+        for (int x = 0; x < mLeafDim[0].x; ++x)
+        {
+            nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
+            auto val = a.getValue(ijk);
+            auto leaf = a.probeLeaf(ijk);
+            float minorant = val, majorant = val;
+            if (leaf)
+            {
+                // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
+                const float* data = leaf->data()->mValues;
+                for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
+                // We also need the 1-halo from neighbouring bricks.
+                expandHalo(a, ijk, minorant, majorant);
+            }
+            if (majorant == minorant || leaf == nullptr)
+            {
+                *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
+                *ptrdst++ = 0;
+            }
+            else
+            {
+                majorant = f16tof32(f32tof16(majorant) + 1);
+                minorant = f16tof32(f32tof16(minorant));
+                *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
+                *ptrdst++ = 1;
+                ++nonEmptyCount;
+            }
+        } // x brick loop
+        return nonEmptyCount;
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeRowBricks(nanovdb::FloatGrid::AccessorType& a, int y, int z, uint32_t firstBrick)
     {
         uint3 atlasSizePixels = getAtlasSizePixels();
         uint brickMax = getAtlasMaxBrick();
         uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
         uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
 
-        size_t offset = z * mLeafDim[0].x * mLeafDim[0].y;
+        size_t offset = (z * mLeafDim[0].y + y) * mLeafDim[0].x;
         uint32_t* rangedst = mRangeData.data() + offset;
         uint32_t* ptrdst = mPtrData.data() + offset;
-        auto a = mpFloatGrid->getAccessor();
-        for (int y = 0; y < mLeafDim[0].y; ++y)
+        uint myleaf = firstBrick;
+        for (int x = 0; x < mLeafDim[0].x; ++x, ++rangedst, ++ptrdst)
         {
-            for (int x = 0; x < mLeafDim[0].x; ++x)
+            if (*ptrdst == 0) continue;
+
+            // The range of a non-empty brick is exactly representable in fp16, so unpacking it gives the values computeRowRanges() used.
+            float2 majmin = unpackMajMin(rangedst);
+            float majorant = majmin.x, minorant = majmin.y;
+            if (myleaf >= brickMax)
             {
-                nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
-                auto val = a.getValue(ijk);
-                auto leaf = a.probeLeaf(ijk);
-                float minorant = val, majorant = val;
-                uint myleaf = 0;
-                if (leaf)
-                {
-                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
-                    const float* data = leaf->data()->mValues;
-                    for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
-                    // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
-                    if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
-                }
-                if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
+                *rangedst = f32tof16(majorant) + (f32tof16(majorant) << 16); // out of atlas space, force identical major and minor
+                *ptrdst = 0;
+                continue;
+            }
+
+            nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
+            const float* data = a.probeLeaf(ijk)->data()->mValues;
+            uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
+            uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+            uint32_t atlasz = myleaf / bricksPerSlice;
+            *ptrdst = (atlasx + (atlasy << 8) + (atlasz << 16));
+            ++myleaf;
+
+            if (!kBC4Compress) {
+                float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
+                TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
+                for (int pixz = 0; pixz < kBrickSize; ++pixz)
                 {
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
-                    *ptrdst++ = 0;
+                    for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                    {
+                        for (int pixx = 0; pixx < kBrickSize; ++pixx)
+                        {
+                            float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
+                            *atlasdst++ = TexelType((f - minorant) * invRange);
+                        }
+                        atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
+                    }
+                    atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
                 }
-                else
+            }
+            else {
+                // BC4 compression:
+                float invRange = (255.f) / (majorant - minorant);
+                uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
+                for (int pixz = 0; pixz < kBrickSize; ++pixz)
                 {
-                    const float* data = leaf->data()->mValues;
-                    majorant = f16tof32(f32tof16(majorant) + 1);
-                    minorant = f16tof32(f32tof16(minorant));
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
-                    uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
-                    uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
-                    uint32_t atlasz = myleaf / bricksPerSlice;
-                    *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
-
-                    if (!kBC4Compress) {
-                        float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
-                        TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                    for (int tiley = 0; tiley < kBrickSize; tiley += 4)
+                    {
+                        for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
+                            uint8_t tilevals[4][4];
+                            uint8_t tileminorant = 255, tilemajorant = 0;
+                            for (int pixy = 0; pixy < 4; ++pixy)
                             {
-                                for (int pixx = 0; pixx < kBrickSize; ++pixx)
+                                for (int pixx = 0; pixx < 4; ++pixx)
                                 {
-                                    float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
-                                    *atlasdst++ = TexelType((f - minorant) * invRange);
+                                    float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
+                                    uint8_t voxel = uint8_t((f - minorant) * invRange);
+                                    tileminorant = std::min(tileminorant, voxel);
+                                    tilemajorant = std::max(tilemajorant, voxel);
+                                    tilevals[pixy][pixx] = voxel;
                                 }
-                                atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
                             }
-                            atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
+                            CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
+                            atlasdst++;
                         }
+                        atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
                     }
-                    else {
-                        // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
-                        uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
-                                    {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
-                                    }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
-                                }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
-                            }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
-                    } // bc4 compress?
-                } // non empty brick?
-            } // x brick loop
-        } // y brick loop
+                    atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+                } // z slice loop
+            } // bc4 compress?
+        } // x brick loop
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
@@ -284,19 +347,50 @@ namespace Falcor
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
+    {
+        return convertToData().createTextures(pDevice);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGridData NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertToData(bool parallel)
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
+
+        // Process rows of bricks in parallel. Each task uses its own accessor, so the accessor's node cache is reused across the
+        // rows of a task and there is no sharing between threads. A single chunk runs all rows in order.
+        const size_t rowCount = size_t(mLeafDim[0].y) * mLeafDim[0].z;
+        const size_t grainSize = parallel ? 0 : std::max<size_t>(rowCount, 1);
+        auto forEachRow = [&](auto func)
+        {
+            Threading::parallelFor(0, rowCount, [&](size_t begin, size_t end)
+            {
+                auto a = mpFloatGrid->getAccessor();
+                for (size_t row = begin; row < end; ++row) func(a, row, int(row % mLeafDim[0].y), int(row / mLeafDim[0].y));
+            }, grainSize);
+        };
+
+        // Compute the brick ranges first, then assign atlas locations to the non-empty bricks in scan order.
+        std::vector<uint32_t> rowBrickOffsets(rowCount);
+        forEachRow([&](auto& a, size_t row, int y, int z) { rowBrickOffsets[row] = computeRowRanges(a, y, z); });
+        for (size_t row = 0; row < rowCount; ++row)
+        {
+            uint32_t count = rowBrickOffsets[row];
+            rowBrickOffsets[row] = mNonEmptyCount;
+            mNonEmptyCount += count;
+        }
+        forEachRow([&](auto& a, size_t row, int y, int z) { writeRowBricks(a, y, z, rowBrickOffsets[row]); });
         for (int mip = 1; mip < 4; ++mip) computeMip(mip);
 
-        BrickedGrid bricks;
-        bricks.range = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.indirection = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.atlas = Texture::create3D(pDevice, getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
+        BrickedGridData data;
+        data.rangeSize = uint3(mLeafDim[0]);
+        data.atlasSize = getAtlasSizePixels();
+        data.atlasFormat = getAtlasFormat();
+        data.range = std::move(mRangeData);
+        data.indirection = std::move(mPtrData);
+        data.atlas = std::move(mAtlasData);
 
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
-        return bricks;
+        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount, getAtlasMaxBrick());
+        return data;
     }
 }
@@ -42,13 +42,18 @@
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <pugixml.hpp>
+#include <nlohmann/json.hpp>
 #include <BS_thread_pool_light.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <regex>
 #include <cstdint>
 
+using json = nlohmann::json;
+
 namespace Falcor
 {
 namespace unittest
@@ -61,6 +66,8 @@ struct TestDesc
     unittest::Options options;
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    BenchmarkFunc benchmarkFunc;
+    bool benchmarkUsesDevice = false;
 };
 
 struct TestResult
@@ -76,8 +83,12 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    std::vector<BenchmarkResult> benchmarks;
 };
 
+/// Median times of benchmark measurements from a baseline report, indexed by benchmark key.
+using BenchmarkBaseline = std::map<std::string, double>;
+
 static std::vector<TestDesc>& getTestRegistry()
 {
     static std::vector<TestDesc> registry;
@@ -154,6 +165,27 @@ void registerGPUTest(std::filesystem::path path, std::string name, unittest::Opt
     getTestRegistry().push_back(desc);
 }
 
+void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, BenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.benchmarkFunc = std::move(func);
+    getTestRegistry().push_back(desc);
+}
+
+void registerGPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, BenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.benchmarkFunc = std::move(func);
+    desc.benchmarkUsesDevice = true;
+    getTestRegistry().push_back(desc);
+}
+
 /// Prints the UnitTest report line, making sure it is always printed to the console once.
 template<typename... Args>
 void reportLine(const std::string_view format, Args&&... args)
@@ -222,19 +254,128 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
-inline TestResult runTest(const Test& test, DevicePool& devicePool)
+inline std::string getBenchmarkKey(const std::string& suiteName, const std::string& testName, const std::string& measurementName)
+{
+    return fmt::format("{}:{}/{}", suiteName, testName, measurementName);
+}
+
+inline std::string formatThroughput(const BenchmarkResult& result)
+{
+    if (result.throughput.countPerIteration <= 0.0 || result.medianMs <= 0.0)
+        return "";
+
+    double perSecond = result.throughput.countPerIteration * 1000.0 / result.medianMs;
+    const char* unit = result.throughput.unit == Throughput::Unit::Bytes ? "B/s" : " items/s";
+    if (perSecond >= 1e9)
+        return fmt::format(", {:.2f} G{}", perSecond * 1e-9, unit);
+    if (perSecond >= 1e6)
+        return fmt::format(", {:.2f} M{}", perSecond * 1e-6, unit);
+    if (perSecond >= 1e3)
+        return fmt::format(", {:.2f} k{}", perSecond * 1e-3, unit);
+    return fmt::format(", {:.2f} {}", perSecond, unit);
+}
+
+inline void reportBenchmarkResults(const TestResult& result)
+{
+    for (const auto& benchmark : result.benchmarks)
+    {
+        reportLine(
+            "[  BENCH   ] {}: median {:.3f} ms, mean {:.3f} ms, min {:.3f} ms, max {:.3f} ms, stddev {:.3f} ms ({} repetition{}){}", benchmark.name,
+            benchmark.medianMs, benchmark.meanMs, benchmark.minMs, benchmark.maxMs, benchmark.stdDevMs, benchmark.repetitions,
+            plural(benchmark.repetitions, "s"), formatThroughput(benchmark)
+        );
+    }
+}
+
+/**
+ * Write benchmark results in JSON format. The file can be used as a baseline in later runs.
+ * @param[in] path File path.
+ * @param[in] report List of tests/results.
+ */
+inline void writeBenchmarkReport(const std::filesystem::path& path, const std::vector<std::pair<Test, TestResult>>& report)
+{
+    json benchmarks = json::array();
+    for (const auto& [test, result] : report)
+    {
+        for (const auto& benchmark : result.benchmarks)
+        {
+            json entry;
+            entry["key"] = getBenchmarkKey(test.suiteName, test.name, benchmark.name);
+            entry["suite"] = test.suiteName;
+            entry["test"] = test.name;
+            entry["name"] = benchmark.name;
+            entry["repetitions"] = benchmark.repetitions;
+            entry["minMs"] = benchmark.minMs;
+            entry["maxMs"] = benchmark.maxMs;
+            entry["meanMs"] = benchmark.meanMs;
+            entry["medianMs"] = benchmark.medianMs;
+            entry["stdDevMs"] = benchmark.stdDevMs;
+            if (benchmark.throughput.countPerIteration > 0.0)
+            {
+                entry["throughputPerSecond"] = benchmark.throughput.countPerIteration * 1000.0 / benchmark.medianMs;
+                entry["throughputUnit"] = benchmark.throughput.unit == Throughput::Unit::Bytes ? "bytes" : "items";
+            }
+            benchmarks.push_back(std::move(entry));
+        }
+    }
+
+    json doc;
+    doc["version"] = getLongVersionString();
+    doc["benchmarks"] = std::move(benchmarks);
+
+    std::ofstream file(path);
+    if (!file.good())
+        throw RuntimeError("Failed to open benchmark report '{}' for writing.", path);
+    file << doc.dump(4);
+}
+
+/**
+ * Load a baseline written by writeBenchmarkReport().
+ * If a benchmark is listed multiple times (e.g. when running with repeats), the fastest median is used.
+ * @param[in] path File path.
+ * @return The median time of each benchmark measurement.
+ */
+inline BenchmarkBaseline loadBenchmarkBaseline(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file.good())
+        throw RuntimeError("Failed to open benchmark baseline '{}'.", path);
+
+    BenchmarkBaseline baseline;
+    try
+    {
+        json doc = json::parse(file);
+        for (const auto& entry : doc.at("benchmarks"))
+        {
+            std::string key = entry.at("key").get<std::string>();
+            double medianMs = entry.at("medianMs").get<double>();
+            auto it = baseline.find(key);
+            baseline[key] = it == baseline.end() ? medianMs : std::min(it->second, medianMs);
+        }
+    }
+    catch (const json::exception& e)
+    {
+        throw RuntimeError("Failed to parse benchmark baseline '{}': {}", path, e.what());
+    }
+
+    return baseline;
+}
+
+inline TestResult runTest(const Test& test, DevicePool& devicePool, const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     if (!test.skipMessage.empty())
         return {TestResult::Status::Skipped, {test.skipMessage}};
 
     TestResult result{TestResult::Status::Passed};
 
+    // GPU tests and GPU benchmarks have their device type set.
     ref<Device> pDevice;
-    if (test.gpuFunc)
+    if (test.deviceType != Device::Type::Default)
         pDevice = devicePool.acquireDevice(test.deviceType);
 
     CPUUnitTestContext cpuCtx;
     GPUUnitTestContext gpuCtx(pDevice);
+    BenchmarkContext benchmarkCtx(options.benchmarkWarmup, options.benchmarkRepetitions, pDevice);
 
     auto startTime = std::chrono::steady_clock::now();
 
@@ -242,6 +383,8 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     {
         if (test.cpuFunc)
             test.cpuFunc(cpuCtx);
+        else if (test.benchmarkFunc)
+            test.benchmarkFunc(benchmarkCtx);
         else
             test.gpuFunc(gpuCtx);
     }
@@ -271,7 +414,32 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
         result.extraMessage = e.what();
     }
 
-    result.messages = test.cpuFunc ? cpuCtx.getFailureMessages() : gpuCtx.getFailureMessages();
+    if (test.cpuFunc)
+        result.messages = cpuCtx.getFailureMessages();
+    else if (test.benchmarkFunc)
+        result.messages = benchmarkCtx.getFailureMessages();
+    else
+        result.messages = gpuCtx.getFailureMessages();
+
+    // Compare benchmark results against the baseline. Measurements missing in the baseline are not checked.
+    result.benchmarks = benchmarkCtx.getResults();
+    if (result.status == TestResult::Status::Passed)
+    {
+        for (const auto& benchmark : result.benchmarks)
+        {
+            auto it = baseline.find(getBenchmarkKey(test.suiteName, test.name, benchmark.name));
+            if (it == baseline.end())
+                continue;
+            double limitMs = it->second * (1.0 + options.benchmarkThreshold);
+            if (benchmark.medianMs > limitMs)
+            {
+                result.messages.push_back(fmt::format(
+                    "Benchmark '{}' regressed: median {:.3f} ms, baseline {:.3f} ms (+{:.1f}%, threshold {:.1f}%)", benchmark.name,
+                    benchmark.medianMs, it->second, (benchmark.medianMs / it->second - 1.0) * 100.0, options.benchmarkThreshold * 100.0
+                ));
+            }
+        }
+    }
 
     if (!result.messages.empty())
         result.status = TestResult::Status::Failed;
@@ -293,7 +461,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     return result;
 }
 
-inline int32_t runTestsParallel(const RunOptions& options)
+inline int32_t runTestsParallel(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -319,44 +487,54 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
     reportLine("[==========] Running {} test{}.", tests.size(), plural(tests.size(), "s"));
 
-    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
+    auto runAndReport = [&abort, &tests, &results, &devicePool, &options, &baseline](size_t testIndex)
     {
-        threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
-            {
-                if (abort)
-                    return;
+        if (abort)
+            return;
 
-                const Test& test = tests[testIndex];
-                TestResult& result = results[testIndex];
-                std::string repeats;
+        const Test& test = tests[testIndex];
+        TestResult& result = results[testIndex];
+        std::string repeats;
 
-                reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
+        reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+        result = runTest(test, devicePool, options, baseline);
 
-                std::string statusTag;
-                switch (result.status)
-                {
-                case TestResult::Status::Passed:
-                    statusTag = "[       OK ]";
-                    break;
-                case TestResult::Status::Failed:
-                    statusTag = "[  FAILED  ]";
-                    break;
-                case TestResult::Status::Skipped:
-                    statusTag = "[  SKIPPED ]";
-                    break;
-                }
-                if (!result.extraMessage.empty())
-                    reportLine("{}", result.extraMessage);
-                reportLine("{} {}:{}{} ({} ms)", statusTag, test.suiteName, test.name, repeats, result.elapsedMS);
-            }
-        );
+        std::string statusTag;
+        switch (result.status)
+        {
+        case TestResult::Status::Passed:
+            statusTag = "[       OK ]";
+            break;
+        case TestResult::Status::Failed:
+            statusTag = "[  FAILED  ]";
+            break;
+        case TestResult::Status::Skipped:
+            statusTag = "[  SKIPPED ]";
+            break;
+        }
+        reportBenchmarkResults(result);
+        if (!result.extraMessage.empty())
+            reportLine("{}", result.extraMessage);
+        reportLine("{} {}:{}{} ({} ms)", statusTag, test.suiteName, test.name, repeats, result.elapsedMS);
+    };
+
+    // Benchmarks are not run in the pool, as timings are distorted by other tests running concurrently.
+    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
+    {
+        if (!tests[testIndex].benchmarkFunc)
+            threadPool.push_task(runAndReport, testIndex);
     }
 
     threadPool.wait_for_tasks();
 
+    // Run benchmarks one at a time after all other tests have finished.
+    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
+    {
+        if (tests[testIndex].benchmarkFunc)
+            runAndReport(testIndex);
+    }
+
     if (abort)
     {
         reportLine("[ ABORTED  ]");
@@ -366,6 +544,14 @@ inline int32_t runTestsParallel(const RunOptions& options)
     auto endTime = std::chrono::steady_clock::now();
     uint64_t totalMS = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
+    if (!options.benchmarkReportPath.empty())
+    {
+        std::vector<std::pair<Test, TestResult>> report;
+        for (size_t i = 0; i < tests.size(); ++i)
+            report.emplace_back(tests[i], results[i]);
+        writeBenchmarkReport(options.benchmarkReportPath, report);
+    }
+
     int32_t failureCount = 0;
     for (const auto& result : results)
         failureCount += result.status == TestResult::Status::Failed ? 1 : 0;
@@ -385,7 +571,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     return failureCount;
 }
 
-inline int32_t runTestsSerial(const RunOptions& options)
+inline int32_t runTestsSerial(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -441,7 +627,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 if (options.repeat > 1)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
-                TestResult result = runTest(test, devicePool);
+                TestResult result = runTest(test, devicePool, options, baseline);
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -457,6 +643,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
                     statusTag = "[  SKIPPED ]";
                     break;
                 }
+                reportBenchmarkResults(result);
                 if (!result.extraMessage.empty())
                     reportLine("{}", result.extraMessage);
                 reportLine("{} {}:{}{} ({} ms)", statusTag, suiteName, test.name, repeats, result.elapsedMS);
@@ -484,6 +671,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
+    if (!options.benchmarkReportPath.empty())
+        writeBenchmarkReport(options.benchmarkReportPath, report);
 
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)", testCount, plural(testCount, "s"), suiteCount,
@@ -514,7 +703,11 @@ int32_t runTests(const RunOptions& options)
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    BenchmarkBaseline baseline;
+    if (!options.benchmarkBaselinePath.empty())
+        baseline = loadBenchmarkBaseline(options.benchmarkBaselinePath);
+
+    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options, baseline) : runTestsSerial(options, baseline);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -538,12 +731,13 @@ std::vector<Test> enumerateTests()
         test.deviceType = Device::Type::Default;
         test.cpuFunc = desc.cpuFunc;
         test.gpuFunc = desc.gpuFunc;
+        test.benchmarkFunc = desc.benchmarkFunc;
 
-        if (test.cpuFunc)
+        if (test.cpuFunc || (test.benchmarkFunc && !desc.benchmarkUsesDevice))
         {
             tests.push_back(test);
         }
-        else if (test.gpuFunc)
+        else
         {
 #if FALCOR_HAS_D3D12
             if (desc.options.deviceTypes.empty() || desc.options.deviceTypes.count(Device::Type::D3D12))
@@ -648,6 +842,46 @@ void UnitTestContext::reportFailure(const std::string& message)
 
 ///////////////////////////////////////////////////////////////////////////
 
+void BenchmarkContext::measure(std::string name, const std::function<void()>& func, Throughput throughput)
+{
+    for (uint32_t i = 0; i < mWarmupIterations; ++i)
+        func();
+
+    std::vector<double> times(std::max(1u, mRepetitions));
+    for (double& time : times)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        func();
+        auto endTime = std::chrono::steady_clock::now();
+        time = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    }
+
+    BenchmarkResult result;
+    result.name = std::move(name);
+    result.repetitions = (uint32_t)times.size();
+    result.throughput = throughput;
+
+    double sum = 0.0;
+    for (double time : times)
+        sum += time;
+    result.meanMs = sum / times.size();
+
+    double sumSquares = 0.0;
+    for (double time : times)
+        sumSquares += (time - result.meanMs) * (time - result.meanMs);
+    result.stdDevMs = times.size() > 1 ? std::sqrt(sumSquares / (times.size() - 1)) : 0.0;
+
+    std::sort(times.begin(), times.end());
+    result.minMs = times.front();
+    result.maxMs = times.back();
+    size_t mid = times.size() / 2;
+    result.medianMs = times.size() % 2 == 1 ? times[mid] : 0.5 * (times[mid - 1] + times[mid]);
+
+    mResults.push_back(std::move(result));
+}
+
+///////////////////////////////////////////////////////////////////////////
+
 void GPUUnitTestContext::createProgram(
     const std::filesystem::path& path,
     const std::string& entry,
@@ -797,4 +1031,14 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_BENCHMARK(TestBenchmark)
+{
+    uint32_t count = 0;
+    ctx.measure("increment", [&]() { ++count; }, Throughput::items(1));
+    EXPECT_GE(count, 1u);
+    EXPECT_EQ(ctx.getResults().size(), 1);
+    EXPECT_LE(ctx.getResults()[0].minMs, ctx.getResults()[0].medianMs);
+    EXPECT_LE(ctx.getResults()[0].medianMs, ctx.getResults()[0].maxMs);
+}
+
 } // namespace Falcor
@@ -94,15 +94,24 @@ struct RunOptions
     std::filesystem::path xmlReportPath;
     uint32_t parallel = 1;
     uint32_t repeat = 1;
+
+    // Benchmark options.
+    uint32_t benchmarkWarmup = 1;                   ///< Number of untimed warmup iterations per benchmark measurement.
+    uint32_t benchmarkRepetitions = 5;              ///< Number of timed repetitions per benchmark measurement.
+    std::filesystem::path benchmarkReportPath;      ///< If set, benchmark results are written to this JSON file.
+    std::filesystem::path benchmarkBaselinePath;    ///< If set, benchmark results are compared against this JSON file.
+    double benchmarkThreshold = 0.1;                ///< Allowed relative increase of the median time over the baseline before a benchmark fails.
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
 
 class CPUUnitTestContext;
 class GPUUnitTestContext;
+class BenchmarkContext;
 
 using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
 using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
+using BenchmarkFunc = std::function<void(BenchmarkContext& ctx)>;
 
 struct Test
 {
@@ -110,10 +119,11 @@ struct Test
     std::string name;
     std::set<std::string> tags;
     std::string skipMessage;
-    Device::Type deviceType;
+    Device::Type deviceType; ///< Device type of GPU tests and GPU benchmarks, Default for CPU tests.
 
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    BenchmarkFunc benchmarkFunc;
 };
 
 /// Enumerate all tests.
@@ -154,6 +164,64 @@ private:
 class FALCOR_API CPUUnitTestContext : public UnitTestContext
 {};
 
+/// Amount of work done per iteration of a benchmark measurement, used to report throughput.
+struct Throughput
+{
+    enum class Unit
+    {
+        Items,
+        Bytes,
+    };
+
+    double countPerIteration = 0.0;
+    Unit unit = Unit::Items;
+
+    static Throughput items(double count) { return {count, Unit::Items}; }
+    static Throughput bytes(double count) { return {count, Unit::Bytes}; }
+};
+
+/// Statistics of a benchmark measurement. Times are per iteration.
+struct BenchmarkResult
+{
+    std::string name;
+    uint32_t repetitions = 0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double meanMs = 0.0;
+    double medianMs = 0.0;
+    double stdDevMs = 0.0;
+    Throughput throughput;
+};
+
+class FALCOR_API BenchmarkContext : public UnitTestContext
+{
+public:
+    BenchmarkContext(uint32_t warmupIterations, uint32_t repetitions, ref<Device> pDevice = nullptr)
+        : mWarmupIterations(warmupIterations), mRepetitions(repetitions), mpDevice(pDevice)
+    {}
+
+    /// Returns the GPU device. Only available in GPU benchmarks.
+    ref<Device> getDevice() const { return mpDevice; }
+
+    /**
+     * Measure the run time of a function.
+     * The function is called for the configured number of warmup iterations and is then timed for the configured
+     * number of repetitions. The statistics over the repetitions are added to the benchmark results.
+     * @param[in] name Name of the measurement, must be unique within the benchmark.
+     * @param[in] func Function to measure.
+     * @param[in] throughput Optional amount of work done per call, used to report throughput.
+     */
+    void measure(std::string name, const std::function<void()>& func, Throughput throughput = {});
+
+    const std::vector<BenchmarkResult>& getResults() const { return mResults; }
+
+private:
+    uint32_t mWarmupIterations;
+    uint32_t mRepetitions;
+    ref<Device> mpDevice;
+    std::vector<BenchmarkResult> mResults;
+};
+
 class FALCOR_API GPUUnitTestContext : public UnitTestContext
 {
 public:
@@ -350,6 +418,8 @@ void applyArgs(Options& options, Args&&... args)
 
 FALCOR_API void registerCPUTest(std::filesystem::path path, std::string name, unittest::Options options, CPUTestFunc func);
 FALCOR_API void registerGPUTest(std::filesystem::path path, std::string name, unittest::Options options, GPUTestFunc func);
+FALCOR_API void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, BenchmarkFunc func);
+FALCOR_API void registerGPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, BenchmarkFunc func);
 
 /**
  * StreamSink is a utility class used by the testing framework that either
@@ -524,6 +594,8 @@ inline std::optional<std::string> createBinaryMessage(std::string_view lhsStr, s
 using UnitTestContext = unittest::UnitTestContext;
 using CPUUnitTestContext = unittest::CPUUnitTestContext;
 using GPUUnitTestContext = unittest::GPUUnitTestContext;
+using BenchmarkContext = unittest::BenchmarkContext;
+using Throughput = unittest::Throughput;
 
 /**
  * Macro to define a CPU unit test. The optional arguments include:
@@ -559,6 +631,63 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterCPUTest##name;                                                    \
     static void CPUUnitTest##name(CPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macro to define a CPU benchmark. Takes the same optional arguments as CPU_TEST.
+ *
+ * A benchmark runs its setup code once and times one or more functions using
+ * BenchmarkContext::measure(). The test macros (EXPECT etc.) can be used to validate results:
+ *
+ * CPU_BENCHMARK(Sort)
+ * {
+ *     std::vector<int> data = generateData();
+ *     std::vector<int> copy;
+ *     ctx.measure("std::sort", [&]() { copy = data; std::sort(copy.begin(), copy.end()); }, Throughput::items(data.size()));
+ *     EXPECT(std::is_sorted(copy.begin(), copy.end()));
+ * }
+ *
+ * Benchmarks are run like CPU tests. The number of repetitions, the JSON report and the comparison against a
+ * baseline are controlled by the benchmark options in RunOptions.
+ *
+ * Note: All benchmarks are implicitly tagged with "cpu" and "benchmark".
+ */
+#define CPU_BENCHMARK(name, ...)                                                      \
+    static void CPUBenchmark##name(BenchmarkContext& ctx);                            \
+    struct CPUBenchmarkRegisterer##name                                               \
+    {                                                                                 \
+        CPUBenchmarkRegisterer##name()                                                \
+        {                                                                             \
+            std::filesystem::path path = __FILE__;                                    \
+            unittest::Options options;                                                \
+            applyArgs(options, ##__VA_ARGS__);                                        \
+            options.tags.insert("cpu");                                               \
+            options.tags.insert("benchmark");                                         \
+            unittest::registerCPUBenchmark(path, #name, options, CPUBenchmark##name); \
+        }                                                                             \
+    } RegisterCPUBenchmark##name;                                                     \
+    static void CPUBenchmark##name(BenchmarkContext& ctx) /* over to the user for the braces */
+
+/**
+ * Macro to define a GPU benchmark. Takes the same optional arguments as GPU_TEST.
+ * Like GPU tests, GPU benchmarks run once for each device type. The device is available through BenchmarkContext::getDevice().
+ *
+ * Note: All GPU benchmarks are implicitly tagged with "gpu" and "benchmark".
+ */
+#define GPU_BENCHMARK(name, ...)                                                      \
+    static void GPUBenchmark##name(BenchmarkContext& ctx);                            \
+    struct GPUBenchmarkRegisterer##name                                               \
+    {                                                                                 \
+        GPUBenchmarkRegisterer##name()                                                \
+        {                                                                             \
+            std::filesystem::path path = __FILE__;                                    \
+            unittest::Options options;                                                \
+            applyArgs(options, ##__VA_ARGS__);                                        \
+            options.tags.insert("gpu");                                               \
+            options.tags.insert("benchmark");                                         \
+            unittest::registerGPUBenchmark(path, #name, options, GPUBenchmark##name); \
+        }                                                                             \
+    } RegisterGPUBenchmark##name;                                                     \
+    static void GPUBenchmark##name(BenchmarkContext& ctx) /* over to the user for the braces */
+
 /**
  * Macro to define a GPU unit test. The optional arguments include:
  *
@@ -0,0 +1,76 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+
+/**
+ * Find the unique items in a list, using hashes to find candidate duplicates.
+ * Items are bucketed by hash and only items with the same hash are compared, which takes expected linear time
+ * instead of the quadratic time of comparing each item against all unique items found so far. The result is identical
+ * to the quadratic search as long as equal items have equal hashes.
+ * @param[in] hashes Hash of each item.
+ * @param[in] isEqual Function bool(size_t uniqueItem, size_t item) returning true if two items (given by index) are equal.
+ * @param[out] uniqueMap For each item, the index of the item it maps to in the returned list of unique items.
+ * @return Returns the indices of the unique items, in order of first occurrence.
+ */
+template<typename EqualFunc>
+std::vector<size_t> findUniqueItems(const std::vector<uint64_t>& hashes, EqualFunc isEqual, std::vector<size_t>& uniqueMap)
+{
+    std::vector<size_t> uniqueItems;
+    uniqueMap.resize(hashes.size());
+
+    // Map from hash to the unique items with that hash (as indices into uniqueItems).
+    std::unordered_map<uint64_t, std::vector<size_t>> buckets;
+    buckets.reserve(hashes.size());
+
+    for (size_t i = 0; i < hashes.size(); ++i)
+    {
+        auto& bucket = buckets[hashes[i]];
+        auto it = std::find_if(bucket.begin(), bucket.end(), [&](size_t uniqueIndex) { return isEqual(uniqueItems[uniqueIndex], i); });
+        if (it == bucket.end())
+        {
+            uniqueMap[i] = uniqueItems.size();
+            bucket.push_back(uniqueItems.size());
+            uniqueItems.push_back(i);
+        }
+        else
+        {
+            uniqueMap[i] = *it;
+        }
+    }
+
+    return uniqueItems;
+}
+
+} // namespace Falcor
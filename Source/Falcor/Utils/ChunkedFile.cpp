@@ -0,0 +1,424 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ChunkedFile.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Common.h"
+#include "Utils/StringFormatters.h"
+
+#include <lz4.h>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Version of the chunked container layout (independent of the user version).
+const uint32_t kContainerVersion = 2;
+
+/// Size of uncompressed blocks. Blocks are the unit of parallel compression/decompression.
+const uint32_t kBlockSize = 4 * 1024 * 1024;
+
+/// Alignment of chunk data in the file. Uncompressed chunks are page aligned for efficient memory mapping.
+const uint64_t kChunkAlignment = 4096;
+
+struct FileHeader
+{
+    char magic[8]{};
+    uint32_t version{};
+    uint32_t containerVersion{};
+    uint32_t chunkCount{};
+    uint32_t reserved{};
+    uint64_t tocOffset{}; ///< Offset of the table of contents from the start of the file.
+};
+
+struct ChunkDesc
+{
+    uint32_t id;
+    uint32_t compression;
+    uint64_t offset;           ///< Offset of the chunk data from the start of the file.
+    uint64_t storedSize;       ///< Size of the chunk data in the file (including the block sizes).
+    uint64_t uncompressedSize; ///< Size of the uncompressed chunk data.
+    uint32_t blockCount;       ///< Number of compressed blocks (0 for uncompressed chunks).
+    uint32_t blockSize;        ///< Uncompressed size of each block (except the last one).
+};
+
+struct BlockJob
+{
+    const uint8_t* pSrc;
+    size_t srcSize;
+    uint8_t* pDst;
+    size_t dstSize;
+};
+
+FileHeader makeHeader(std::string_view magic, uint32_t version)
+{
+    checkArgument(magic.size() <= sizeof(FileHeader::magic), "File magic '{}' is longer than {} characters.", magic, sizeof(FileHeader::magic));
+    FileHeader header;
+    std::memcpy(header.magic, magic.data(), magic.size());
+    header.version = version;
+    header.containerVersion = kContainerVersion;
+    return header;
+}
+
+/// Returns a unique path for writing a temporary file next to the given file.
+/// Concurrent writers of the same file (e.g. from several processes) each get their own temporary file.
+std::filesystem::path getUniqueTempPath(const std::filesystem::path& path)
+{
+    static std::mutex mutex;
+    static std::mt19937_64 rng{std::random_device{}()};
+    std::lock_guard<std::mutex> lock(mutex);
+    std::filesystem::path tempPath = path;
+    tempPath += fmt::format(".{:016x}.tmp", rng());
+    return tempPath;
+}
+
+bool isHeaderValid(const FileHeader& header, std::string_view magic, uint32_t version)
+{
+    FileHeader expected = makeHeader(magic, version);
+    return std::memcmp(header.magic, expected.magic, sizeof(FileHeader::magic)) == 0 && header.version == expected.version &&
+           header.containerVersion == expected.containerVersion;
+}
+} // namespace
+
+ChunkedFileWriter::ChunkedFileWriter(const std::filesystem::path& path, std::string_view magic, uint32_t version)
+    : mPath(path), mMagic(magic), mVersion(version)
+{
+    // Check the magic before creating the file.
+    makeHeader(magic, version);
+
+    // Write to a temporary file first and rename it, so that readers never see a partially written file.
+    mTempPath = getUniqueTempPath(path);
+    mStream.open(mTempPath, std::ios_base::binary | std::ios_base::trunc);
+    if (!mStream.good())
+        throw RuntimeError("Failed to create file '{}'.", mTempPath);
+
+    // The header is filled in by close(), once the table of contents is known.
+    FileHeader header;
+    writeToFile(&header, sizeof(header));
+    padToAlignment(kChunkAlignment);
+
+    mBlocks.resize(Threading::getLogicalThreadCount());
+    mCompressedBlocks.resize(mBlocks.size());
+}
+
+ChunkedFileWriter::~ChunkedFileWriter()
+{
+    if (!mClosed)
+    {
+        mStream.close();
+        std::error_code ec;
+        std::filesystem::remove(mTempPath, ec);
+    }
+}
+
+void ChunkedFileWriter::beginChunk(uint32_t id, Compression compression)
+{
+    checkArgument(!mClosed, "File '{}' is already closed.", mPath);
+    checkArgument(!mInChunk, "Chunk {} is not ended.", mChunks.empty() ? 0 : mChunks.back().id);
+    for (const auto& chunk : mChunks)
+        checkArgument(chunk.id != id, "Chunk with ID {} already exists.", id);
+
+    if (compression == Compression::None)
+        padToAlignment(kChunkAlignment);
+
+    Chunk chunk;
+    chunk.id = id;
+    chunk.compression = compression;
+    chunk.offset = mOffset;
+    mChunks.push_back(chunk);
+    mInChunk = true;
+}
+
+void ChunkedFileWriter::write(const void* pData, size_t size)
+{
+    FALCOR_ASSERT(mInChunk);
+    Chunk& chunk = mChunks.back();
+    chunk.uncompressedSize += size;
+
+    if (chunk.compression != Compression::LZ4)
+    {
+        writeToFile(pData, size);
+        chunk.storedSize += size;
+        return;
+    }
+
+    // Gather the data into blocks. Once all block buffers are full, they are compressed in parallel and written.
+    const uint8_t* pSrc = static_cast<const uint8_t*>(pData);
+    while (size > 0)
+    {
+        if (mPendingBlockCount == 0 || mBlocks[mPendingBlockCount - 1].size() == kBlockSize)
+        {
+            if (mPendingBlockCount == mBlocks.size())
+                compressPendingBlocks();
+            mBlocks[mPendingBlockCount++].clear();
+        }
+        std::vector<uint8_t>& block = mBlocks[mPendingBlockCount - 1];
+        size_t count = std::min<size_t>(size, kBlockSize - block.size());
+        block.insert(block.end(), pSrc, pSrc + count);
+        pSrc += count;
+        size -= count;
+    }
+}
+
+void ChunkedFileWriter::endChunk()
+{
+    checkArgument(mInChunk, "No chunk to end.");
+    if (mPendingBlockCount > 0)
+        compressPendingBlocks();
+    mInChunk = false;
+}
+
+void ChunkedFileWriter::addChunk(uint32_t id, const void* pData, size_t size, Compression compression)
+{
+    beginChunk(id, compression);
+    write(pData, size);
+    endChunk();
+}
+
+void ChunkedFileWriter::close()
+{
+    checkArgument(!mClosed, "File '{}' is already closed.", mPath);
+    checkArgument(!mInChunk, "Chunk {} is not ended.", mChunks.empty() ? 0 : mChunks.back().id);
+
+    // Write the table of contents after the chunks, then fill in the header.
+    std::vector<ChunkDesc> toc(mChunks.size());
+    for (size_t i = 0; i < mChunks.size(); ++i)
+    {
+        const Chunk& chunk = mChunks[i];
+        ChunkDesc& desc = toc[i];
+        desc.id = chunk.id;
+        desc.compression = (uint32_t)chunk.compression;
+        desc.offset = chunk.offset;
+        desc.storedSize = chunk.storedSize;
+        desc.uncompressedSize = chunk.uncompressedSize;
+        desc.blockCount = chunk.blockCount;
+        desc.blockSize = chunk.compression == Compression::LZ4 ? kBlockSize : 0;
+    }
+
+    FileHeader header = makeHeader(mMagic, mVersion);
+    header.chunkCount = (uint32_t)toc.size();
+    padToAlignment(alignof(ChunkDesc));
+    header.tocOffset = mOffset;
+    writeToFile(toc.data(), toc.size() * sizeof(ChunkDesc));
+
+    mStream.seekp(0);
+    mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    mStream.close();
+    mClosed = true;
+
+    std::error_code ec;
+    if (mStream.fail())
+    {
+        std::filesystem::remove(mTempPath, ec);
+        throw RuntimeError("Failed to write file '{}'.", mTempPath);
+    }
+
+    std::filesystem::rename(mTempPath, mPath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(mTempPath, ec);
+        throw RuntimeError("Failed to write file '{}'.", mPath);
+    }
+}
+
+void ChunkedFileWriter::writeToFile(const void* pData, size_t size)
+{
+    mStream.write(reinterpret_cast<const char*>(pData), size);
+    if (mStream.fail())
+        throw RuntimeError("Failed to write file '{}'.", mTempPath);
+    mOffset += size;
+}
+
+void ChunkedFileWriter::padToAlignment(uint64_t alignment)
+{
+    static const char zeros[kChunkAlignment] = {};
+    FALCOR_ASSERT(alignment <= kChunkAlignment);
+    writeToFile(zeros, align_to(alignment, mOffset) - mOffset);
+}
+
+void ChunkedFileWriter::compressPendingBlocks()
+{
+    // Each compressed block is stored with its compressed size in front of it.
+    Threading::parallelFor(
+        0, mPendingBlockCount,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const std::vector<uint8_t>& src = mBlocks[i];
+                std::vector<uint8_t>& dst = mCompressedBlocks[i];
+                dst.resize(sizeof(uint32_t) + LZ4_compressBound((int)src.size()));
+                int compressedSize = LZ4_compress_default(
+                    reinterpret_cast<const char*>(src.data()), reinterpret_cast<char*>(dst.data() + sizeof(uint32_t)), (int)src.size(),
+                    (int)(dst.size() - sizeof(uint32_t))
+                );
+                if (compressedSize <= 0)
+                    throw RuntimeError("Failed to compress block.");
+                uint32_t size = (uint32_t)compressedSize;
+                std::memcpy(dst.data(), &size, sizeof(size));
+                dst.resize(sizeof(uint32_t) + size);
+            }
+        },
+        1
+    );
+
+    Chunk& chunk = mChunks.back();
+    for (size_t i = 0; i < mPendingBlockCount; ++i)
+    {
+        writeToFile(mCompressedBlocks[i].data(), mCompressedBlocks[i].size());
+        chunk.storedSize += mCompressedBlocks[i].size();
+    }
+    chunk.blockCount += (uint32_t)mPendingBlockCount;
+    mPendingBlockCount = 0;
+}
+
+ChunkedFileReader::ChunkedFileReader(const std::filesystem::path& path, std::string_view magic, uint32_t version) : mPath(path)
+{
+    if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan))
+        throw RuntimeError("Failed to open file '{}'.", path);
+
+    const uint8_t* pFileData = static_cast<const uint8_t*>(mFile.getData());
+    const size_t fileSize = mFile.getMappedSize();
+
+    FileHeader header;
+    if (fileSize < sizeof(header))
+        throw RuntimeError("File '{}' is truncated.", path);
+    std::memcpy(&header, pFileData, sizeof(header));
+    if (!isHeaderValid(header, magic, version))
+        throw RuntimeError("Invalid header in file '{}'.", path);
+
+    if (header.tocOffset > fileSize || (fileSize - header.tocOffset) / sizeof(ChunkDesc) < header.chunkCount)
+        throw RuntimeError("File '{}' is truncated.", path);
+    std::vector<ChunkDesc> toc(header.chunkCount);
+    std::memcpy(toc.data(), pFileData + header.tocOffset, toc.size() * sizeof(ChunkDesc));
+
+    // Validate table of contents and gather decompression jobs.
+    std::vector<BlockJob> jobs;
+    for (const auto& desc : toc)
+    {
+        if (desc.offset > fileSize || desc.storedSize > fileSize - desc.offset)
+            throw RuntimeError("Chunk {} in file '{}' is out of bounds.", desc.id, path);
+
+        const uint8_t* pChunk = pFileData + desc.offset;
+        ChunkView view;
+
+        switch ((ChunkedFileWriter::Compression)desc.compression)
+        {
+        case ChunkedFileWriter::Compression::None:
+            if (desc.storedSize != desc.uncompressedSize)
+                throw RuntimeError("Chunk {} in file '{}' is corrupt.", desc.id, path);
+            view = {pChunk, desc.uncompressedSize};
+            break;
+        case ChunkedFileWriter::Compression::LZ4:
+        {
+            // The block count must match the uncompressed size exactly, otherwise the blocks would be decompressed out of bounds.
+            if (desc.blockSize == 0 || desc.blockSize > (uint32_t)std::numeric_limits<int>::max() ||
+                desc.blockCount != div_round_up(desc.uncompressedSize, (uint64_t)desc.blockSize))
+                throw RuntimeError("Chunk {} in file '{}' is corrupt.", desc.id, path);
+
+            // Each block is stored with its compressed size in front of it.
+            auto pData = std::make_unique<uint8_t[]>(desc.uncompressedSize);
+            const uint8_t* pSrc = pChunk;
+            const uint8_t* pSrcEnd = pChunk + desc.storedSize;
+            for (uint32_t i = 0; i < desc.blockCount; ++i)
+            {
+                uint32_t compressedSize;
+                if ((uint64_t)(pSrcEnd - pSrc) < sizeof(uint32_t))
+                    throw RuntimeError("Chunk {} in file '{}' is corrupt.", desc.id, path);
+                std::memcpy(&compressedSize, pSrc, sizeof(uint32_t));
+                pSrc += sizeof(uint32_t);
+                uint64_t dstOffset = (uint64_t)i * desc.blockSize;
+                if (compressedSize > (uint64_t)(pSrcEnd - pSrc) || compressedSize > (uint32_t)std::numeric_limits<int>::max() ||
+                    dstOffset >= desc.uncompressedSize)
+                    throw RuntimeError("Chunk {} in file '{}' is corrupt.", desc.id, path);
+                jobs.push_back({pSrc, compressedSize, pData.get() + dstOffset, std::min<size_t>(desc.blockSize, desc.uncompressedSize - dstOffset)});
+                pSrc += compressedSize;
+            }
+            if (pSrc != pSrcEnd)
+                throw RuntimeError("Chunk {} in file '{}' is corrupt.", desc.id, path);
+            view = {pData.get(), desc.uncompressedSize};
+            mDecompressedData.push_back(std::move(pData));
+            break;
+        }
+        default:
+            throw RuntimeError("Chunk {} in file '{}' has unknown compression mode {}.", desc.id, path, desc.compression);
+        }
+
+        if (!mChunks.emplace(desc.id, view).second)
+            throw RuntimeError("Duplicate chunk {} in file '{}'.", desc.id, path);
+    }
+
+    // Decompress all blocks in parallel.
+    std::atomic<bool> failed{false};
+    Threading::parallelFor(
+        0, jobs.size(),
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const BlockJob& job = jobs[i];
+                int size = LZ4_decompress_safe(
+                    reinterpret_cast<const char*>(job.pSrc), reinterpret_cast<char*>(job.pDst), (int)job.srcSize, (int)job.dstSize
+                );
+                if (size != (int)job.dstSize)
+                    failed = true;
+            }
+        },
+        1
+    );
+    if (failed)
+        throw RuntimeError("Failed to decompress file '{}'.", path);
+}
+
+bool ChunkedFileReader::isValid(const std::filesystem::path& path, std::string_view magic, uint32_t version)
+{
+    std::ifstream fs(path, std::ios_base::binary);
+    if (!fs.good())
+        return false;
+
+    FileHeader header;
+    fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+    return fs.good() && isHeaderValid(header, magic, version);
+}
+
+ChunkedFileReader::ChunkView ChunkedFileReader::getChunk(uint32_t id) const
+{
+    auto it = mChunks.find(id);
+    if (it == mChunks.end())
+        throw RuntimeError("Chunk {} does not exist in file '{}'.", id, mPath);
+    return it->second;
+}
+} // namespace Falcor
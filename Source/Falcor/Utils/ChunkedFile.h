@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Writer for chunked binary files.
+ *
+ * A chunked file consists of a small header, a list of independently stored chunks and a table of contents.
+ * Each chunk is identified by a user-defined 32-bit ID. Chunks are either stored uncompressed at page aligned
+ * offsets (so they can be read directly from a memory mapping) or split into independently LZ4 compressed blocks.
+ *
+ * Chunks are streamed to disk as they are written. Only a bounded number of blocks is held in memory, which are
+ * compressed in parallel on the global thread pool. The data is written to a temporary file next to the destination,
+ * which replaces the destination in close(). A failed or interrupted write therefore never leaves a truncated file
+ * at the destination path.
+ */
+class FALCOR_API ChunkedFileWriter
+{
+public:
+    enum class Compression : uint32_t
+    {
+        None = 0, ///< Chunk is stored uncompressed.
+        LZ4 = 1,  ///< Chunk is split into LZ4 compressed blocks.
+    };
+
+    /**
+     * Create a chunked file. Throws a RuntimeError if the file cannot be created.
+     * @param[in] path File path.
+     * @param[in] magic File magic (at most 8 characters).
+     * @param[in] version File version.
+     */
+    ChunkedFileWriter(const std::filesystem::path& path, std::string_view magic, uint32_t version);
+
+    /// Destructor. Discards the file if it was not closed.
+    ~ChunkedFileWriter();
+
+    /**
+     * Begin a chunk. The chunk data is written with write() until endChunk() is called.
+     * @param[in] id Chunk ID. Must be unique within the file.
+     * @param[in] compression Compression mode.
+     */
+    void beginChunk(uint32_t id, Compression compression = Compression::LZ4);
+
+    /**
+     * Append data to the current chunk.
+     * @param[in] pData Data.
+     * @param[in] size Size of the data in bytes.
+     */
+    void write(const void* pData, size_t size);
+
+    /// End the current chunk.
+    void endChunk();
+
+    /**
+     * Add a chunk from a single buffer.
+     * @param[in] id Chunk ID. Must be unique within the file.
+     * @param[in] pData Uncompressed chunk data.
+     * @param[in] size Size of the data in bytes.
+     * @param[in] compression Compression mode.
+     */
+    void addChunk(uint32_t id, const void* pData, size_t size, Compression compression = Compression::LZ4);
+
+    /**
+     * Write the table of contents and move the file to its destination. Throws a RuntimeError if writing fails.
+     */
+    void close();
+
+private:
+    ChunkedFileWriter(const ChunkedFileWriter&) = delete;
+    ChunkedFileWriter& operator=(const ChunkedFileWriter&) = delete;
+
+    struct Chunk
+    {
+        uint32_t id = 0;
+        Compression compression = Compression::None;
+        uint64_t offset = 0;
+        uint64_t storedSize = 0;
+        uint64_t uncompressedSize = 0;
+        uint32_t blockCount = 0;
+    };
+
+    void writeToFile(const void* pData, size_t size);
+    void padToAlignment(uint64_t alignment);
+    void compressPendingBlocks();
+
+    std::filesystem::path mPath;
+    std::filesystem::path mTempPath;
+    std::ofstream mStream;
+    uint64_t mOffset = 0;
+    std::string mMagic;
+    uint32_t mVersion;
+    bool mClosed = false;
+
+    std::vector<Chunk> mChunks;
+    bool mInChunk = false;
+
+    std::vector<std::vector<uint8_t>> mBlocks;           ///< Uncompressed blocks of the current chunk that are not written yet.
+    std::vector<std::vector<uint8_t>> mCompressedBlocks; ///< Scratch memory for compressing blocks.
+    size_t mPendingBlockCount = 0;                       ///< Number of blocks in use. All but the last one are full.
+};
+
+/**
+ * Reader for chunked binary files written with ChunkedFileWriter.
+ * The file is memory mapped. Uncompressed chunks are returned as views into the mapping without copying, compressed
+ * chunks are decompressed in parallel when the file is opened.
+ */
+class FALCOR_API ChunkedFileReader
+{
+public:
+    /// View of the uncompressed data of a chunk. Borrowed from the reader and valid for its lifetime.
+    struct ChunkView
+    {
+        const uint8_t* pData = nullptr;
+        size_t size = 0;
+    };
+
+    /**
+     * Open a chunked file and decompress all compressed chunks.
+     * Throws a RuntimeError if the file cannot be opened, has a different magic or version or is corrupt.
+     * @param[in] path File path.
+     * @param[in] magic Expected file magic (at most 8 characters).
+     * @param[in] version Expected file version.
+     */
+    ChunkedFileReader(const std::filesystem::path& path, std::string_view magic, uint32_t version);
+
+    /**
+     * Check if a file is a chunked file with the given magic and version.
+     * Only the file header is read.
+     */
+    static bool isValid(const std::filesystem::path& path, std::string_view magic, uint32_t version);
+
+    /// Returns true if the file contains a chunk with the given ID.
+    bool hasChunk(uint32_t id) const { return mChunks.find(id) != mChunks.end(); }
+
+    /// Get the data of a chunk. Throws a RuntimeError if the chunk does not exist.
+    ChunkView getChunk(uint32_t id) const;
+
+private:
+    ChunkedFileReader(const ChunkedFileReader&) = delete;
+    ChunkedFileReader& operator=(const ChunkedFileReader&) = delete;
+
+    std::filesystem::path mPath;
+    MemoryMappedFile mFile;
+    std::map<uint32_t, ChunkView> mChunks;
+    std::vector<std::unique_ptr<uint8_t[]>> mDecompressedData;
+};
+} // namespace Falcor
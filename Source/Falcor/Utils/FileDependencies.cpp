@@ -0,0 +1,530 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FileDependencies.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Threading.h"
+#include "Utils/StringFormatters.h"
+
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+/// Version of the manifest file format.
+const uint32_t kManifestVersion = 2;
+
+/// Size of blocks that are hashed independently. Blocks are the unit of parallel hashing.
+const uint64_t kBlockSize = 4 * 1024 * 1024;
+
+/// Recording context of the calling thread.
+thread_local FileDependencyRecorder::Context tContext;
+
+// 64-bit hash of a memory block. This is the xxHash64 algorithm, which hashes at close to memory bandwidth.
+const uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t kPrime3 = 0x165667B19E3779F9ull;
+const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+const uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t hashMergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= hashRound(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+uint64_t hashBlock(const void* data, size_t size, uint64_t seed = 0)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        for (; end - p >= 32; p += 32)
+        {
+            v1 = hashRound(v1, read64(p));
+            v2 = hashRound(v2, read64(p + 8));
+            v3 = hashRound(v3, read64(p + 16));
+            v4 = hashRound(v4, read64(p + 24));
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = hashMergeRound(h, v1);
+        h = hashMergeRound(h, v2);
+        h = hashMergeRound(h, v3);
+        h = hashMergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + kPrime5;
+    }
+
+    h += (uint64_t)size;
+
+    for (; end - p >= 8; p += 8)
+    {
+        h ^= hashRound(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+    }
+    if (end - p >= 4)
+    {
+        h ^= (uint64_t)read32(p) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; p++)
+    {
+        h ^= (*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * Hash a list of files in parallel.
+ * Each file is split into blocks that are hashed independently on the thread pool. The file hash is the hash of the
+ * file size and the list of block hashes, so the result does not depend on the number of threads.
+ * Throws a RuntimeError if a file cannot be read.
+ */
+std::vector<uint64_t> hashFiles(const std::vector<std::filesystem::path>& paths, const std::vector<uint64_t>& sizes)
+{
+    FALCOR_ASSERT(paths.size() == sizes.size());
+
+    struct Block
+    {
+        size_t fileIndex;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    std::vector<size_t> firstBlock(paths.size() + 1);
+    std::vector<Block> blocks;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        firstBlock[i] = blocks.size();
+        for (uint64_t offset = 0; offset < sizes[i]; offset += kBlockSize)
+            blocks.push_back({i, offset, std::min(kBlockSize, sizes[i] - offset)});
+    }
+    firstBlock[paths.size()] = blocks.size();
+
+    std::vector<uint64_t> blockHashes(blocks.size());
+    Threading::parallelFor(
+        0, blocks.size(),
+        [&](size_t begin, size_t end)
+        {
+            std::vector<char> buffer;
+            for (size_t i = begin; i < end; i++)
+            {
+                const Block& block = blocks[i];
+                const auto& path = paths[block.fileIndex];
+                std::ifstream stream(path, std::ios::binary);
+                buffer.resize(block.size);
+                if (!stream.seekg(block.offset) || !stream.read(buffer.data(), block.size))
+                    throw RuntimeError("Failed to read file '{}'.", path);
+                blockHashes[i] = hashBlock(buffer.data(), buffer.size());
+            }
+        },
+        1
+    );
+
+    std::vector<uint64_t> hashes(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        std::vector<uint64_t> data;
+        data.reserve(1 + firstBlock[i + 1] - firstBlock[i]);
+        data.push_back(sizes[i]);
+        data.insert(data.end(), blockHashes.begin() + firstBlock[i], blockHashes.begin() + firstBlock[i + 1]);
+        hashes[i] = hashBlock(data.data(), data.size() * sizeof(uint64_t));
+    }
+    return hashes;
+}
+
+/// Query size and last write time of a file. Returns false if the file does not exist.
+bool statFile(const std::filesystem::path& path, uint64_t& size, int64_t& lastWriteTime)
+{
+    std::error_code ec;
+    size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+    lastWriteTime = (int64_t)time.time_since_epoch().count();
+    return true;
+}
+
+/// Returns a unique path for writing a temporary file next to the given file.
+std::filesystem::path getUniqueTempPath(const std::filesystem::path& path)
+{
+    static std::mutex mutex;
+    static std::mt19937_64 rng{std::random_device{}()};
+    std::lock_guard<std::mutex> lock(mutex);
+    std::filesystem::path tempPath = path;
+    tempPath += fmt::format(".{:016x}.tmp", rng());
+    return tempPath;
+}
+} // namespace
+
+struct FileDependencyRecorder::State
+{
+    Context pParent;            ///< Enclosing recorder, which also receives all files.
+    std::atomic<bool> active{true};
+    std::mutex mutex;
+    std::set<std::filesystem::path> files;
+};
+
+// FileDependencyRecorder
+
+FileDependencyRecorder::Scope::Scope(Context context) : mPrevious(std::move(tContext))
+{
+    tContext = std::move(context);
+}
+
+FileDependencyRecorder::Scope::~Scope()
+{
+    tContext = std::move(mPrevious);
+}
+
+FileDependencyRecorder::FileDependencyRecorder() : mpState(std::make_shared<State>())
+{
+    mpState->pParent = tContext;
+    tContext = mpState;
+}
+
+FileDependencyRecorder::~FileDependencyRecorder()
+{
+    mpState->active = false;
+
+    // Restore the enclosing recorder if this recorder is the active one on the calling thread. Recorders that were
+    // destroyed out of order are skipped.
+    if (tContext == mpState)
+    {
+        Context pContext = mpState->pParent;
+        while (pContext && !pContext->active)
+            pContext = pContext->pParent;
+        tContext = std::move(pContext);
+    }
+}
+
+void FileDependencyRecorder::record(const std::filesystem::path& path)
+{
+    // Fast path, this is called for every file that is resolved in the data directories.
+    if (!tContext)
+        return;
+
+    std::error_code ec;
+    std::filesystem::path absolutePath = std::filesystem::absolute(path, ec);
+    if (ec)
+        return;
+    absolutePath = absolutePath.lexically_normal();
+
+    for (State* pState = tContext.get(); pState; pState = pState->pParent.get())
+    {
+        if (!pState->active)
+            continue;
+        std::lock_guard<std::mutex> lock(pState->mutex);
+        pState->files.insert(absolutePath);
+    }
+}
+
+bool FileDependencyRecorder::isRecording()
+{
+    return tContext != nullptr;
+}
+
+FileDependencyRecorder::Context FileDependencyRecorder::getContext()
+{
+    return tContext;
+}
+
+std::vector<std::filesystem::path> FileDependencyRecorder::getFiles() const
+{
+    std::lock_guard<std::mutex> lock(mpState->mutex);
+    return std::vector<std::filesystem::path>(mpState->files.begin(), mpState->files.end());
+}
+
+// FileDependencyManifest
+
+FileDependencyManifest FileDependencyManifest::create(const std::vector<std::filesystem::path>& files, const FileDependencyManifest* pPrevious)
+{
+    std::set<std::filesystem::path> uniqueFiles(files.begin(), files.end());
+    std::vector<Entry> entries(uniqueFiles.size());
+    std::vector<uint8_t> exists(entries.size());
+    {
+        size_t i = 0;
+        for (const auto& path : uniqueFiles)
+            entries[i++].path = path;
+    }
+
+    Threading::parallelFor(
+        0, entries.size(),
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                auto& entry = entries[i];
+                exists[i] = statFile(entry.path, entry.size, entry.lastWriteTime);
+            }
+        },
+        64
+    );
+
+    // Only hash files that are new or changed since the previous manifest. Both entry lists are sorted by path.
+    std::vector<size_t> hashIndices;
+    std::vector<std::filesystem::path> hashPaths;
+    std::vector<uint64_t> hashSizes;
+    const std::vector<Entry> noEntries;
+    const auto& previousEntries = pPrevious ? pPrevious->mEntries : noEntries;
+    auto it = previousEntries.begin();
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (!exists[i])
+            continue;
+        auto& entry = entries[i];
+        while (it != previousEntries.end() && it->path < entry.path)
+            ++it;
+        if (it != previousEntries.end() && it->path == entry.path && it->size == entry.size && it->lastWriteTime == entry.lastWriteTime)
+        {
+            entry.hash = it->hash;
+            continue;
+        }
+        hashIndices.push_back(i);
+        hashPaths.push_back(entry.path);
+        hashSizes.push_back(entry.size);
+    }
+
+    auto hashes = hashFiles(hashPaths, hashSizes);
+    for (size_t i = 0; i < hashIndices.size(); i++)
+        entries[hashIndices[i]].hash = hashes[i];
+
+    FileDependencyManifest manifest;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (!exists[i])
+            entries[i] = {entries[i].path, false};
+        manifest.mEntries.push_back(std::move(entries[i]));
+    }
+    return manifest;
+}
+
+FileDependencyManifest FileDependencyManifest::read(const std::filesystem::path& path)
+{
+    std::ifstream stream(path);
+    if (!stream)
+        throw RuntimeError("Failed to open file dependency manifest '{}'.", path);
+
+    FileDependencyManifest manifest;
+    try
+    {
+        nlohmann::json json = nlohmann::json::parse(stream);
+        if (json.at("version").get<uint32_t>() != kManifestVersion)
+            throw RuntimeError("Unsupported version.");
+        for (const auto& file : json.at("files"))
+        {
+            Entry entry;
+            entry.path = file.at("path").get<std::string>();
+            entry.exists = file.at("exists").get<bool>();
+            entry.size = file.at("size").get<uint64_t>();
+            entry.lastWriteTime = file.at("lastWriteTime").get<int64_t>();
+            entry.hash = file.at("hash").get<uint64_t>();
+            manifest.mEntries.push_back(std::move(entry));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        throw RuntimeError("Failed to read file dependency manifest '{}': {}", path, e.what());
+    }
+
+    std::sort(manifest.mEntries.begin(), manifest.mEntries.end(), [](const Entry& a, const Entry& b) { return a.path < b.path; });
+    return manifest;
+}
+
+void FileDependencyManifest::write(const std::filesystem::path& path) const
+{
+    nlohmann::json files = nlohmann::json::array();
+    for (const auto& entry : mEntries)
+    {
+        files.push_back({
+            {"path", entry.path.string()},
+            {"exists", entry.exists},
+            {"size", entry.size},
+            {"lastWriteTime", entry.lastWriteTime},
+            {"hash", entry.hash},
+        });
+    }
+    nlohmann::json json = {{"version", kManifestVersion}, {"files", std::move(files)}};
+
+    // Write to a temporary file first and rename it, so that readers never see a partially written manifest.
+    const auto tempPath = getUniqueTempPath(path);
+    std::error_code ec;
+    {
+        std::ofstream stream(tempPath, std::ios::trunc);
+        stream << json.dump(1);
+        stream.close();
+        if (!stream)
+        {
+            std::filesystem::remove(tempPath, ec);
+            throw RuntimeError("Failed to write file dependency manifest '{}'.", path);
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        throw RuntimeError("Failed to write file dependency manifest '{}'.", path);
+    }
+}
+
+bool FileDependencyManifest::validate(bool& updated)
+{
+    updated = false;
+
+    // Check size and last write time of all files in parallel. A changed size or a created missing file invalidates the
+    // manifest right away.
+    std::vector<int64_t> lastWriteTimes(mEntries.size());
+    std::vector<uint8_t> touched(mEntries.size());
+    std::atomic<bool> changed{false};
+    Threading::parallelFor(
+        0, mEntries.size(),
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end && !changed; i++)
+            {
+                if (!mEntries[i].exists)
+                {
+                    std::error_code ec;
+                    if (std::filesystem::exists(mEntries[i].path, ec) || ec)
+                        changed = true;
+                    continue;
+                }
+                uint64_t size;
+                if (!statFile(mEntries[i].path, size, lastWriteTimes[i]) || size != mEntries[i].size)
+                    changed = true;
+                touched[i] = lastWriteTimes[i] != mEntries[i].lastWriteTime;
+            }
+        },
+        64
+    );
+    if (changed)
+        return false;
+
+    // Re-hash files with a changed last write time only.
+    std::vector<size_t> hashIndices;
+    std::vector<std::filesystem::path> hashPaths;
+    std::vector<uint64_t> hashSizes;
+    for (size_t i = 0; i < mEntries.size(); i++)
+    {
+        if (!touched[i])
+            continue;
+        hashIndices.push_back(i);
+        hashPaths.push_back(mEntries[i].path);
+        hashSizes.push_back(mEntries[i].size);
+    }
+    if (hashIndices.empty())
+        return true;
+
+    std::vector<uint64_t> hashes;
+    try
+    {
+        hashes = hashFiles(hashPaths, hashSizes);
+    }
+    catch (const RuntimeError&)
+    {
+        // The file changed or disappeared while hashing.
+        return false;
+    }
+
+    for (size_t i = 0; i < hashIndices.size(); i++)
+    {
+        if (hashes[i] != mEntries[hashIndices[i]].hash)
+            return false;
+    }
+
+    // Contents are unchanged, remember the new last write times to skip hashing next time.
+    for (size_t index : hashIndices)
+        mEntries[index].lastWriteTime = lastWriteTimes[index];
+    updated = true;
+    return true;
+}
+
+uint64_t FileDependencyManifest::computeFileHash(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+        throw RuntimeError("Failed to read file '{}'.", path);
+    return hashFiles({path}, {size})[0];
+}
+} // namespace Falcor
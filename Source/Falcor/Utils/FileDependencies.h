@@ -0,0 +1,174 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Records the files that are read while the recorder is alive.
+ * Loaders report every input file with FileDependencyRecorder::record(). Files resolved through
+ * findFileInDataDirectories() are reported automatically, including the candidate paths that were searched and did not
+ * exist. A recorder is active on the thread that created it and on all tasks dispatched from that thread through
+ * Threading (e.g. materials that are loaded in parallel), so concurrent loads on different threads record their files
+ * separately. Files reported to a nested recorder are also reported to the enclosing recorders.
+ */
+class FALCOR_API FileDependencyRecorder
+{
+public:
+    struct State;
+
+    /// Handle to the recorder that is active on a thread. Tasks use it to record to the recorder of the dispatching thread.
+    using Context = std::shared_ptr<State>;
+
+    /**
+     * Makes a recording context active on the calling thread for the lifetime of the scope.
+     */
+    class FALCOR_API Scope
+    {
+    public:
+        Scope(Context context);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Context mPrevious;
+    };
+
+    /// Create a recorder and make it the active recorder of the calling thread. Recording starts immediately.
+    FileDependencyRecorder();
+
+    /// Destroy the recorder. Recording stops and the enclosing recorder becomes active again.
+    ~FileDependencyRecorder();
+
+    FileDependencyRecorder(const FileDependencyRecorder&) = delete;
+    FileDependencyRecorder& operator=(const FileDependencyRecorder&) = delete;
+
+    /**
+     * Report a file that is read by a loader. This is a no-op if no recorder is active on the calling thread.
+     * The file does not need to exist. Files that are missing when the manifest is created invalidate the manifest
+     * once they are created (see FileDependencyManifest).
+     * @param[in] path File path. Relative paths are made absolute.
+     */
+    static void record(const std::filesystem::path& path);
+
+    /// Returns true if a recorder is active on the calling thread.
+    static bool isRecording();
+
+    /// Returns the recording context of the calling thread, or nullptr if no recorder is active.
+    static Context getContext();
+
+    /**
+     * Get the recorded files.
+     * @return Returns the sorted list of absolute file paths.
+     */
+    std::vector<std::filesystem::path> getFiles() const;
+
+private:
+    Context mpState;
+};
+
+/**
+ * Manifest of the files an asset was built from.
+ * For each file the manifest stores its size, last write time and a 64-bit content hash. A manifest is valid as long as
+ * the contents of all files are unchanged. Files that did not exist when the manifest was created (e.g. data directories
+ * that were searched before a file was found) are stored as missing, the manifest becomes invalid if they are created. Validation is incremental: files with unchanged size and last write time are
+ * not read, only files with a changed last write time are re-hashed. Files are hashed in parallel in fixed-size blocks,
+ * so a few large files are spread over all threads.
+ */
+class FALCOR_API FileDependencyManifest
+{
+public:
+    struct Entry
+    {
+        std::filesystem::path path;
+        bool exists = true;        ///< False if the file must not exist.
+        uint64_t size = 0;
+        int64_t lastWriteTime = 0; ///< Last write time in ticks of the file clock.
+        uint64_t hash = 0;         ///< Content hash (see computeFileHash()).
+
+        bool operator==(const Entry& other) const
+        {
+            return path == other.path && exists == other.exists && size == other.size && lastWriteTime == other.lastWriteTime && hash == other.hash;
+        }
+    };
+
+    /**
+     * Create a manifest for a list of files. Files that do not exist are stored as missing.
+     * @param[in] files List of file paths.
+     * @param[in] pPrevious Optional previous manifest. Hashes of files with unchanged size and last write time are reused.
+     * @return Returns the new manifest.
+     */
+    static FileDependencyManifest create(const std::vector<std::filesystem::path>& files, const FileDependencyManifest* pPrevious = nullptr);
+
+    /**
+     * Read a manifest from a file.
+     * Throws a RuntimeError if the file cannot be read or is not a valid manifest.
+     * @param[in] path File path.
+     * @return Returns the manifest.
+     */
+    static FileDependencyManifest read(const std::filesystem::path& path);
+
+    /**
+     * Write the manifest to a file. Throws a RuntimeError if writing fails.
+     * The manifest is written to a temporary file that replaces the file once complete, so readers never see a partially
+     * written manifest.
+     * @param[in] path File path.
+     */
+    void write(const std::filesystem::path& path) const;
+
+    /**
+     * Check if all files are unchanged.
+     * Files whose last write time changed but whose contents are identical (e.g. after a touch or a checkout) are
+     * updated in the manifest, so they are not re-hashed next time.
+     * @param[out] updated Set to true if the manifest was updated and should be written back.
+     * @return Returns true if the contents of all files are unchanged and no missing file was created.
+     */
+    bool validate(bool& updated);
+
+    /// Get the manifest entries, sorted by path.
+    const std::vector<Entry>& getEntries() const { return mEntries; }
+
+    /**
+     * Compute the content hash of a file.
+     * Throws a RuntimeError if the file cannot be read.
+     * @param[in] path File path.
+     * @return Returns a 64-bit hash of the file contents.
+     */
+    static uint64_t computeFileHash(const std::filesystem::path& path);
+
+private:
+    std::vector<Entry> mEntries;
+};
+} // namespace Falcor
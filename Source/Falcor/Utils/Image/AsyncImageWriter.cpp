@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AsyncImageWriter.h"
+#include "Core/Assert.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/TraceRecorder.h"
+#include <algorithm>
+
+namespace Falcor
+{
+AsyncImageWriter::AsyncImageWriter(const Options& options) : mOptions(options)
+{
+    mOptions.maxPendingImages = std::max(1u, mOptions.maxPendingImages);
+
+    size_t threadCount = mOptions.threadCount;
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    for (size_t i = 0; i < threadCount; ++i)
+        mThreads.emplace_back(&AsyncImageWriter::runWorker, this);
+}
+
+AsyncImageWriter::AsyncImageWriter() : AsyncImageWriter(Options{}) {}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTerminate = true;
+    }
+    mWorkCondition.notify_all();
+
+    for (auto& thread : mThreads)
+        thread.join();
+}
+
+void AsyncImageWriter::write(Image image, WriteCallback callback)
+{
+    FALCOR_ASSERT(image.pData || image.dataSize == 0);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // Wait for queue space. A single image larger than the byte budget is accepted once the queue is empty.
+    auto hasSpace = [&]()
+    {
+        if (mStats.queueDepth == 0)
+            return true;
+        return mStats.queueDepth < mOptions.maxPendingImages && mStats.pendingBytes + image.dataSize <= mOptions.maxPendingBytes;
+    };
+    if (!hasSpace())
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        mDoneCondition.wait(lock, hasSpace);
+        mStats.stallTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+    }
+
+    mStats.imageBytes += image.dataSize;
+    mStats.pendingBytes += image.dataSize;
+    mStats.queueDepth++;
+    mStats.peakQueueDepth = std::max(mStats.peakQueueDepth, mStats.queueDepth);
+    mQueue.push(Request{std::move(image), std::move(callback)});
+
+    mWorkCondition.notify_one();
+}
+
+void AsyncImageWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [&]() { return mStats.queueDepth == 0; });
+}
+
+AsyncImageWriter::Stats AsyncImageWriter::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void AsyncImageWriter::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats;
+    stats.queueDepth = mStats.queueDepth;
+    stats.peakQueueDepth = mStats.queueDepth;
+    stats.pendingBytes = mStats.pendingBytes;
+    mStats = stats;
+}
+
+void AsyncImageWriter::runWorker()
+{
+    // This function is the entry point for worker threads.
+    // The workers wait on the request queue and encode one image at a time.
+
+    TraceRecorder::setThreadName("Image writer");
+    static const uint32_t kWriteTraceNameID = TraceRecorder::internString("Write image");
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWorkCondition.wait(lock, [&]() { return mTerminate || !mQueue.empty(); });
+
+        // Terminate thread once all queued images have been written.
+        if (mQueue.empty())
+            break;
+
+        Request request = std::move(mQueue.front());
+        mQueue.pop();
+
+        lock.unlock();
+
+        // Encode and write the image (this part is running in parallel).
+        Image& image = request.image;
+        uint64_t fileSize = 0;
+        {
+            uint32_t detailID =
+                TraceRecorder::isEnabled() ? TraceRecorder::internString(image.path.string()) : TraceRecorder::kInvalidStringID;
+            ScopedTraceEvent traceEvent(kWriteTraceNameID, detailID);
+
+            try
+            {
+                Bitmap::saveImage(
+                    image.path, image.width, image.height, image.fileFormat, image.exportFlags, image.resourceFormat, true, image.pData.get()
+                );
+                std::error_code ec;
+                fileSize = std::filesystem::file_size(image.path, ec);
+                if (ec)
+                    fileSize = 0;
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write image '{}': {}", image.path.string(), e.what());
+            }
+        }
+
+        // Return the pixel data to the pool before signaling that queue space is available.
+        const size_t dataSize = image.dataSize;
+        image.pData.reset();
+
+        if (request.callback)
+            request.callback(image.path, fileSize);
+
+        lock.lock();
+        if (fileSize > 0)
+        {
+            mStats.imageCount++;
+            mStats.bytesWritten += fileSize;
+        }
+        else
+        {
+            mStats.failedCount++;
+        }
+        FALCOR_ASSERT(mStats.queueDepth > 0 && mStats.pendingBytes >= dataSize);
+        mStats.queueDepth--;
+        mStats.pendingBytes -= dataSize;
+        lock.unlock();
+
+        mDoneCondition.notify_all();
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "BitmapBufferPool.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Utility class to encode and write images to disk asynchronously using multiple worker threads.
+ *
+ * Images are queued together with their pixel data, which is moved into the writer and returned
+ * to the buffer pool after encoding. The queue is bounded both in number of images and in bytes of
+ * pixel data. Calls to write() block while the queue is full, which throttles the producer to the
+ * rate at which images can be encoded instead of letting memory grow without bounds.
+ */
+class FALCOR_API AsyncImageWriter
+{
+public:
+    struct Options
+    {
+        size_t threadCount = 0;                  ///< Number of encoder threads. Zero uses half the hardware threads.
+        uint32_t maxPendingImages = 32;          ///< Maximum number of images queued or being encoded.
+        uint64_t maxPendingBytes = 1ull << 30;   ///< Maximum size of pixel data queued or being encoded. A single larger image is always accepted.
+    };
+
+    struct Stats
+    {
+        uint64_t imageCount = 0;      ///< Number of images written.
+        uint64_t failedCount = 0;     ///< Number of images that failed to write.
+        uint64_t imageBytes = 0;      ///< Size of pixel data of all submitted images in bytes.
+        uint64_t bytesWritten = 0;    ///< Size of all written files in bytes.
+        uint32_t queueDepth = 0;      ///< Number of images currently queued or being encoded.
+        uint32_t peakQueueDepth = 0;  ///< Maximum queue depth.
+        uint64_t pendingBytes = 0;    ///< Size of pixel data currently queued or being encoded in bytes.
+        double stallTime = 0.0;       ///< Time spent in write() waiting for the queue to drain in seconds.
+    };
+
+    /// Image to write. The pixel data is tightly packed and stored top-down.
+    struct Image
+    {
+        std::filesystem::path path;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        Bitmap::FileFormat fileFormat = Bitmap::FileFormat::PngFile;
+        Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None;
+        ResourceFormat resourceFormat = ResourceFormat::Unknown;
+        BitmapBufferPool::Buffer pData;
+        size_t dataSize = 0;
+    };
+
+    /// Callback called from a worker thread after an image was written. The file size is zero if writing failed.
+    using WriteCallback = std::function<void(const std::filesystem::path& path, uint64_t fileSize)>;
+
+    /**
+     * Constructor.
+     * @param[in] options Writer options.
+     */
+    AsyncImageWriter(const Options& options);
+
+    /// Constructor using the default options.
+    AsyncImageWriter();
+
+    /**
+     * Destructor.
+     * Blocks until all queued images have been written.
+     */
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    /**
+     * Queue an image for writing. Blocks while the queue is full.
+     * @param[in] image Image to write. The pixel data is moved into the writer.
+     * @param[in] callback Function called after the image has been written.
+     */
+    void write(Image image, WriteCallback callback = {});
+
+    /// Block until all queued images have been written.
+    void flush();
+
+    const Options& getOptions() const { return mOptions; }
+
+    Stats getStats() const;
+
+    /// Reset the accumulated statistics. The current queue state is kept.
+    void resetStats();
+
+private:
+    void runWorker();
+
+    struct Request
+    {
+        Image image;
+        WriteCallback callback;
+    };
+
+    Options mOptions;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWorkCondition;  ///< Condition variable for workers to wait on.
+    std::condition_variable mDoneCondition;  ///< Condition variable for producers waiting on queue space or flush.
+    std::vector<std::thread> mThreads;       ///< Worker threads.
+
+    // Internal state. Do not access outside of critical section.
+    std::queue<Request> mQueue;
+    Stats mStats;
+    bool mTerminate = false;
+};
+} // namespace Falcor
@@ -28,6 +28,7 @@
 #include "AsyncTextureLoader.h"
 #include "Core/API/Device.h"
 #include "Utils/Threading.h"
+#include "Utils/Timing/TraceRecorder.h"
 
 namespace Falcor
 {
@@ -57,6 +58,7 @@ std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
 {
     std::lock_guard<std::mutex> lock(mMutex);
     mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, callback});
+    mLoadRequestQueue.back().flowID = TraceRecorder::beginFlow();
     mCondition.notify_one();
     return mLoadRequestQueue.back().promise.get_future();
 }
@@ -71,6 +73,7 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
 {
     std::lock_guard<std::mutex> lock(mMutex);
     mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, callback});
+    mLoadRequestQueue.back().flowID = TraceRecorder::beginFlow();
     mCondition.notify_one();
     return mLoadRequestQueue.back().promise.get_future();
 }
@@ -101,6 +104,9 @@ void AsyncTextureLoader::runWorker()
     // To avoid the upload heap growing too large, we synchronize the threads and
     // issue a global GPU flush at regular intervals.
 
+    TraceRecorder::setThreadName("Texture loader");
+    static const uint32_t kLoadTraceNameID = TraceRecorder::internString("Load texture");
+
     while (true)
     {
         // Wait on condition until more work is ready.
@@ -132,14 +138,22 @@ void AsyncTextureLoader::runWorker()
 
         // Load the textures (this part is running in parallel).
         ref<Texture> pTexture;
-        if (request.paths.size() == 1)
-        {
-            pTexture =
-                Texture::createFromFile(mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
-        }
-        else
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags);
+            // Record the load with the texture path as detail so that slow textures can be identified in the trace.
+            uint32_t detailID = TraceRecorder::isEnabled() ? TraceRecorder::internString(request.paths[0].string())
+                                                           : TraceRecorder::kInvalidStringID;
+            ScopedTraceEvent traceEvent(kLoadTraceNameID, detailID);
+            TraceRecorder::endFlow(request.flowID);
+
+            if (request.paths.size() == 1)
+            {
+                pTexture =
+                    Texture::createFromFile(mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            }
+            else
+            {
+                pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags);
+            }
         }
 
         request.promise.set_value(pTexture);
@@ -109,6 +109,7 @@ private:
         Resource::BindFlags bindFlags;
         LoadCallback callback;
         std::promise<ref<Texture>> promise;
+        uint64_t flowID = 0;
     };
 
     ref<Device> mpDevice;
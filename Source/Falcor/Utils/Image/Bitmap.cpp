@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "PixelConversion.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
@@ -61,37 +62,14 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
     return isHalfFormat || isLargeIntFormat;
 }
 
-/**
- * Converts half float image to RGBA float image.
- */
-static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-{
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
-
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++);
-        }
-        pDst += (4 - channelCount);
-    }
-
-    return newData;
-}
-
 /**
  * Converts integer image to RGBA float image.
  * Unsigned integers are normalized to [0,1], signed integers to [-1,1].
  */
 template<typename SrcT>
-static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
+static void convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData, float* pDst)
 {
-    std::vector<float> newData(width * height * 4u, 0.f);
     const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
-    float* pDst = newData.data();
 
     for (uint32_t i = 0; i < width * height; ++i)
     {
@@ -99,16 +77,18 @@ static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t heigh
         {
             *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
         }
-        pDst += (4 - channelCount);
+        for (uint32_t c = channelCount; c < 4; ++c)
+        {
+            *pDst++ = c == 3 ? 1.f : 0.f;
+        }
     }
-
-    return newData;
 }
 
 /**
  * Converts an image of the given format to an RGBA float image.
+ * Missing color channels are set to 0 and a missing alpha channel to 1.
  */
-static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
+static BitmapBufferPool::Buffer convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
 {
     FALCOR_ASSERT(isConvertibleToRGBA32Float(format));
 
@@ -116,80 +96,37 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
     uint32_t channelCount = getFormatChannelCount(format);
     uint32_t channelBits = getNumChannelBits(format, 0);
 
-    std::vector<float> floatData;
+    auto floatData = BitmapBufferPool::get().acquire(size_t(width) * height * 4 * sizeof(float));
+    float* pDst = reinterpret_cast<float*>(floatData.get());
 
     if (type == FormatType::Float && channelBits == 16)
     {
-        floatData = convertHalfToRGBA32Float(width, height, channelCount, pData);
+        convertFloat16ToRGBA32Float(reinterpret_cast<const uint16_t*>(pData), pDst, size_t(width) * height, channelCount);
     }
     else if (type == FormatType::Uint && channelBits == 16)
     {
-        floatData = convertIntToRGBA32Float<uint16_t>(width, height, channelCount, pData);
+        convertIntToRGBA32Float<uint16_t>(width, height, channelCount, pData, pDst);
     }
     else if (type == FormatType::Uint && channelBits == 32)
     {
-        floatData = convertIntToRGBA32Float<uint32_t>(width, height, channelCount, pData);
+        convertIntToRGBA32Float<uint32_t>(width, height, channelCount, pData, pDst);
     }
     else if (type == FormatType::Sint && channelBits == 16)
     {
-        floatData = convertIntToRGBA32Float<int16_t>(width, height, channelCount, pData);
+        convertIntToRGBA32Float<int16_t>(width, height, channelCount, pData, pDst);
     }
     else if (type == FormatType::Sint && channelBits == 32)
     {
-        floatData = convertIntToRGBA32Float<int32_t>(width, height, channelCount, pData);
+        convertIntToRGBA32Float<int32_t>(width, height, channelCount, pData, pDst);
     }
     else
     {
         FALCOR_UNREACHABLE();
     }
 
-    // Default alpha channel to 1.
-    if (channelCount < 4)
-    {
-        for (uint32_t i = 0; i < width * height; ++i)
-            floatData[i * 4 + 3] = 1.f;
-    }
-
     return floatData;
 }
 
-/**
- * Converts 96bpp to 128bpp RGBA without clamping.
- * Note that we can't use FreeImage_ConvertToRGBAF() as it clamps to [0,1].
- */
-static FIBITMAP* convertToRGBAF(FIBITMAP* pDib)
-{
-    const unsigned width = FreeImage_GetWidth(pDib);
-    const unsigned height = FreeImage_GetHeight(pDib);
-
-    auto pNew = FreeImage_AllocateT(FIT_RGBAF, width, height);
-    FreeImage_CloneMetadata(pNew, pDib);
-
-    const unsigned src_pitch = FreeImage_GetPitch(pDib);
-    const unsigned dst_pitch = FreeImage_GetPitch(pNew);
-
-    const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
-    BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
-
-    for (unsigned y = 0; y < height; y++)
-    {
-        const FIRGBF* src_pixel = (FIRGBF*)src_bits;
-        FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
-
-        for (unsigned x = 0; x < width; x++)
-        {
-            // Convert pixels directly, while adding a "dummy" alpha of 1.0
-            dst_pixel[x].red = src_pixel[x].red;
-            dst_pixel[x].green = src_pixel[x].green;
-            dst_pixel[x].blue = src_pixel[x].blue;
-            dst_pixel[x].alpha = 1.0F;
-        }
-        src_bits += src_pitch;
-        dst_bits += dst_pitch;
-    }
-    return pNew;
-}
-
 Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData)
 {
     return Bitmap::UniqueConstPtr(new Bitmap(width, height, format, pData));
@@ -299,30 +236,34 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         return nullptr;
     }
 
-    // Convert the image to RGBX image
-    if (bpp == 24)
-    {
-        bpp = 32;
-        auto pNew = FreeImage_ConvertTo32Bits(pDib);
-        FreeImage_Unload(pDib);
-        pDib = pNew;
-    }
-    else if (bpp == 96 && (isRGB32fSupported() == false))
-    {
-        bpp = 128;
-        auto pNew = convertToRGBAF(pDib);
-        FreeImage_Unload(pDib);
-        pDib = pNew;
-    }
-
     // PFM images are loaded y-flipped, fix this by inverting the isTopDown flag.
     if (fifFormat == FIF_PFM)
         isTopDown = !isTopDown;
 
+    // Write the decoded pixels straight into the bitmap storage.
+    // 3-channel formats are expanded to 4 channels on the fly instead of going through an intermediate FreeImage bitmap.
     UniqueConstPtr pBmp = UniqueConstPtr(new Bitmap(width, height, format));
-    FreeImage_ConvertToRawBits(
-        pBmp->getData(), pDib, pBmp->getRowPitch(), bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown
-    );
+    if (bpp == 24 || (bpp == 96 && !isRGB32fSupported()))
+    {
+        uint8_t* pDst = pBmp->getData();
+        const uint32_t rowPitch = pBmp->getRowPitch();
+        for (uint32_t y = 0; y < height; y++)
+        {
+            // FreeImage stores scanlines bottom-up.
+            const BYTE* pSrcRow = FreeImage_GetScanLine(pDib, isTopDown ? height - y - 1 : y);
+            uint8_t* pDstRow = pDst + size_t(y) * rowPitch;
+            if (bpp == 24)
+                expandRGB8ToRGBA8(pSrcRow, pDstRow, width);
+            else
+                expandRGB32FloatToRGBA32Float(reinterpret_cast<const float*>(pSrcRow), reinterpret_cast<float*>(pDstRow), width);
+        }
+    }
+    else
+    {
+        FreeImage_ConvertToRawBits(
+            pBmp->getData(), pDib, pBmp->getRowPitch(), bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown
+        );
+    }
     FreeImage_Unload(pDib);
     return pBmp;
 }
@@ -341,7 +282,7 @@ Bitmap::Bitmap(uint32_t width, uint32_t height, ResourceFormat format)
         mSize = height * mRowPitch;
     }
 
-    mpData = std::unique_ptr<uint8_t[]>(new uint8_t[mSize]);
+    mpData = BitmapBufferPool::get().acquire(mSize);
 }
 
 Bitmap::Bitmap(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData) : Bitmap(width, height, format)
@@ -510,11 +451,11 @@ void Bitmap::saveImage(
 
     if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
     {
-        std::vector<float> floatData;
+        BitmapBufferPool::Buffer floatData;
         if (isConvertibleToRGBA32Float(resourceFormat))
         {
             floatData = convertToRGBA32Float(resourceFormat, width, height, pData);
-            pData = floatData.data();
+            pData = floatData.get();
             resourceFormat = ResourceFormat::RGBA32Float;
             bytesPerPixel = 16;
         }
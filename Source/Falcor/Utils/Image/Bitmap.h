@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "BitmapBufferPool.h"
 #include "Core/Macros.h"
 #include "Core/Platform/OS.h"
 #include "Core/API/Formats.h"
@@ -155,7 +156,7 @@ protected:
     Bitmap(uint32_t width, uint32_t height, ResourceFormat format);
     Bitmap(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData);
 
-    std::unique_ptr<uint8_t[]> mpData;
+    BitmapBufferPool::Buffer mpData;
     uint32_t mWidth = 0;
     uint32_t mHeight = 0;
     uint32_t mRowPitch = 0;
@@ -0,0 +1,177 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BitmapBufferPool.h"
+#include "Core/Assert.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+
+namespace Falcor
+{
+namespace
+{
+uint32_t floorLog2(uint64_t value)
+{
+    uint32_t result = 0;
+    while (value >>= 1)
+        result++;
+    return result;
+}
+} // namespace
+
+void BitmapBufferPool::Deleter::operator()(uint8_t* pData) const
+{
+    if (pPool && sizeClass != kUnpooled)
+        pPool->release(pData, sizeClass);
+    else
+        delete[] pData;
+}
+
+BitmapBufferPool& BitmapBufferPool::get()
+{
+    static BitmapBufferPool sInstance; // TODO: REMOVEGLOBAL
+    return sInstance;
+}
+
+BitmapBufferPool::~BitmapBufferPool()
+{
+    clear();
+}
+
+uint32_t BitmapBufferPool::getSizeClass(size_t size, size_t& classSize)
+{
+    size = std::max<size_t>(size, size_t(1) << (kMinLog2 + 1));
+    if (size > (size_t(1) << kMaxLog2))
+    {
+        classSize = size;
+        return kUnpooled;
+    }
+
+    // Sizes in (2^p, 2^(p+1)] are split into kClassesPerLog2 classes of equal step.
+    uint32_t p = floorLog2(size - 1);
+    size_t step = size_t(1) << (p - 2);
+    classSize = align_to(step, size);
+    return (p - kMinLog2) * kClassesPerLog2 + uint32_t(classSize / step) - (kClassesPerLog2 + 1);
+}
+
+size_t BitmapBufferPool::getClassSize(uint32_t sizeClass)
+{
+    uint32_t p = sizeClass / kClassesPerLog2 + kMinLog2;
+    size_t step = size_t(1) << (p - 2);
+    return step * (sizeClass % kClassesPerLog2 + kClassesPerLog2 + 1);
+}
+
+BitmapBufferPool::Buffer BitmapBufferPool::acquire(size_t size)
+{
+    size_t classSize;
+    uint32_t sizeClass = getSizeClass(size, classSize);
+    FALCOR_ASSERT(sizeClass == kUnpooled || getClassSize(sizeClass) == classSize);
+
+    if (sizeClass != kUnpooled)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto& freeList = mFreeLists[sizeClass];
+        if (!freeList.empty())
+        {
+            uint8_t* pData = freeList.back();
+            freeList.pop_back();
+            mStats.retainedSize -= classSize;
+            mStats.reuseCount++;
+            return Buffer(pData, Deleter{this, sizeClass});
+        }
+        mStats.allocationCount++;
+    }
+
+    return Buffer(new uint8_t[classSize], Deleter{sizeClass != kUnpooled ? this : nullptr, sizeClass});
+}
+
+void BitmapBufferPool::release(uint8_t* pData, uint32_t sizeClass)
+{
+    FALCOR_ASSERT(sizeClass < kSizeClassCount);
+    size_t classSize = getClassSize(sizeClass);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStats.retainedSize + classSize <= mMaxRetainedSize)
+        {
+            mFreeLists[sizeClass].push_back(pData);
+            mStats.retainedSize += classSize;
+            return;
+        }
+    }
+
+    delete[] pData;
+}
+
+void BitmapBufferPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& freeList : mFreeLists)
+    {
+        for (uint8_t* pData : freeList)
+            delete[] pData;
+        freeList.clear();
+    }
+    mStats.retainedSize = 0;
+}
+
+void BitmapBufferPool::setMaxRetainedSize(uint64_t maxRetainedSize)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMaxRetainedSize = maxRetainedSize;
+    trim();
+}
+
+void BitmapBufferPool::trim()
+{
+    // Free the largest buffers first until the retained size is within budget.
+    for (uint32_t sizeClass = kSizeClassCount; sizeClass-- > 0 && mStats.retainedSize > mMaxRetainedSize;)
+    {
+        auto& freeList = mFreeLists[sizeClass];
+        size_t classSize = getClassSize(sizeClass);
+        while (!freeList.empty() && mStats.retainedSize > mMaxRetainedSize)
+        {
+            delete[] freeList.back();
+            freeList.pop_back();
+            mStats.retainedSize -= classSize;
+        }
+    }
+}
+
+BitmapBufferPool::Stats BitmapBufferPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void BitmapBufferPool::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.allocationCount = 0;
+    mStats.reuseCount = 0;
+}
+} // namespace Falcor
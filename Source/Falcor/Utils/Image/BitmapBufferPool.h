@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Size-bucketed pool of CPU buffers used as bitmap storage.
+ *
+ * Decoding a texture typically allocates a large buffer, uploads it to the GPU and frees it again.
+ * Loading many textures therefore spends a significant amount of time in the allocator and in
+ * page faults for freshly committed memory. The pool keeps released buffers around and hands them
+ * out again for requests of a similar size.
+ *
+ * Requests are rounded up to size classes with four classes per power of two, bounding the wasted
+ * space to 25%. Released buffers are retained up to a configurable total size, after which they
+ * are freed. The pool is thread-safe.
+ */
+class FALCOR_API BitmapBufferPool
+{
+public:
+    /// Deleter returning a buffer to the pool.
+    struct Deleter
+    {
+        BitmapBufferPool* pPool = nullptr;
+        uint32_t sizeClass = kUnpooled;
+        void operator()(uint8_t* pData) const;
+    };
+
+    using Buffer = std::unique_ptr<uint8_t[], Deleter>;
+
+    struct Stats
+    {
+        uint64_t allocationCount = 0; ///< Number of buffers allocated from the system.
+        uint64_t reuseCount = 0;      ///< Number of requests served from retained buffers.
+        uint64_t retainedSize = 0;    ///< Total size of currently retained buffers in bytes.
+    };
+
+    static constexpr uint64_t kDefaultMaxRetainedSize = 256ull << 20;
+
+    /// Get the global pool.
+    static BitmapBufferPool& get();
+
+    BitmapBufferPool(uint64_t maxRetainedSize = kDefaultMaxRetainedSize) : mMaxRetainedSize(maxRetainedSize) {}
+    ~BitmapBufferPool();
+
+    BitmapBufferPool(const BitmapBufferPool&) = delete;
+    BitmapBufferPool& operator=(const BitmapBufferPool&) = delete;
+
+    /**
+     * Acquire a buffer of at least the given size. The content of the buffer is undefined.
+     * @param[in] size Size in bytes.
+     * @return Buffer that is returned to the pool on destruction.
+     */
+    Buffer acquire(size_t size);
+
+    /// Free all retained buffers.
+    void clear();
+
+    /// Set the maximum total size of retained buffers in bytes. Excess buffers are freed.
+    void setMaxRetainedSize(uint64_t maxRetainedSize);
+    uint64_t getMaxRetainedSize() const { return mMaxRetainedSize; }
+
+    Stats getStats() const;
+    void resetStats();
+
+    /**
+     * Get the size class for a requested size.
+     * @param[in] size Requested size in bytes.
+     * @param[out] classSize Allocated size for the class in bytes.
+     * @return Size class index, or kUnpooled if the size is too large to be pooled.
+     */
+    static uint32_t getSizeClass(size_t size, size_t& classSize);
+
+    static constexpr uint32_t kUnpooled = ~0u;
+
+private:
+    static constexpr uint32_t kMinLog2 = 11; ///< Sizes up to 4 KB share a single size class.
+    static constexpr uint32_t kMaxLog2 = 30; ///< Sizes above 1 GB are not pooled.
+    static constexpr uint32_t kClassesPerLog2 = 4;
+    static constexpr uint32_t kSizeClassCount = (kMaxLog2 - kMinLog2) * kClassesPerLog2;
+
+    void release(uint8_t* pData, uint32_t sizeClass);
+    void trim();
+
+    static size_t getClassSize(uint32_t sizeClass);
+
+    mutable std::mutex mMutex;
+    std::array<std::vector<uint8_t*>, kSizeClassCount> mFreeLists;
+    uint64_t mMaxRetainedSize;
+    Stats mStats;
+};
+} // namespace Falcor
@@ -0,0 +1,392 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FLIP.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+const float kPi = 3.14159265358979323846f;
+
+// FLIP constants, see FLIPPass.cs.slang.
+const float kGqc = 0.7f;
+const float kGpc = 0.4f;
+const float kGpt = 0.95f;
+const float kGw = 0.082f;
+const float kGqf = 0.5f;
+
+struct Color
+{
+    float x, y, z;
+};
+
+// Color conversions, see Utils/Color/ColorHelpers.slang.
+
+Color linearRGBToXYZ(Color c)
+{
+    const float a11 = 10135552.0f / 24577794.0f;
+    const float a12 = 8788810.0f / 24577794.0f;
+    const float a13 = 4435075.0f / 24577794.0f;
+    const float a21 = 2613072.0f / 12288897.0f;
+    const float a22 = 8788810.0f / 12288897.0f;
+    const float a23 = 887015.0f / 12288897.0f;
+    const float a31 = 1425312.0f / 73733382.0f;
+    const float a32 = 8788810.0f / 73733382.0f;
+    const float a33 = 70074185.0f / 73733382.0f;
+    return {
+        a11 * c.x + a12 * c.y + a13 * c.z,
+        a21 * c.x + a22 * c.y + a23 * c.z,
+        a31 * c.x + a32 * c.y + a33 * c.z,
+    };
+}
+
+Color XYZToLinearRGB(Color c)
+{
+    const float a11 = 3.241003275f;
+    const float a12 = -1.537398934f;
+    const float a13 = -0.498615861f;
+    const float a21 = -0.969224334f;
+    const float a22 = 1.875930071f;
+    const float a23 = 0.041554224f;
+    const float a31 = 0.055639423f;
+    const float a32 = -0.204011202f;
+    const float a33 = 1.057148933f;
+    return {
+        a11 * c.x + a12 * c.y + a13 * c.z,
+        a21 * c.x + a22 * c.y + a23 * c.z,
+        a31 * c.x + a32 * c.y + a33 * c.z,
+    };
+}
+
+// D65 reference illuminant.
+const Color kReferenceIlluminant = {0.950428545f, 1.000000000f, 1.088900371f};
+const Color kInvReferenceIlluminant = {1.052156925f, 1.000000000f, 0.918357670f};
+
+Color XYZToCIELab(Color c)
+{
+    const float delta = 6.0f / 29.0f;
+    const float deltaSquare = delta * delta;
+    const float deltaCube = delta * deltaSquare;
+    const float factor = 1.0f / (3.0f * deltaSquare);
+    const float term = 4.0f / 29.0f;
+    auto f = [&](float v) { return v > deltaCube ? std::pow(v, 1.0f / 3.0f) : factor * v + term; };
+
+    float x = f(c.x * kInvReferenceIlluminant.x);
+    float y = f(c.y * kInvReferenceIlluminant.y);
+    float z = f(c.z * kInvReferenceIlluminant.z);
+    return {116.0f * y - 16.0f, 500.0f * (x - y), 200.0f * (y - z)};
+}
+
+Color XYZToYCxCz(Color c)
+{
+    float x = c.x * kInvReferenceIlluminant.x;
+    float y = c.y * kInvReferenceIlluminant.y;
+    float z = c.z * kInvReferenceIlluminant.z;
+    return {116.0f * y - 16.0f, 500.0f * (x - y), 200.0f * (y - z)};
+}
+
+Color YCxCzToXYZ(Color c)
+{
+    float y = (c.x + 16.0f) / 116.0f;
+    float x = c.y / 500.0f + y;
+    float z = y - c.z / 200.0f;
+    return {x * kReferenceIlluminant.x, y * kReferenceIlluminant.y, z * kReferenceIlluminant.z};
+}
+
+Color hunt(Color c)
+{
+    float huntValue = 0.01f * c.x;
+    return {c.x, huntValue * c.y, huntValue * c.z};
+}
+
+float HyAB(Color a, Color b)
+{
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    float dz = a.z - b.z;
+    return std::fabs(dx) + std::sqrt(dy * dy + dz * dz);
+}
+
+Color clampColor(Color c)
+{
+    return {std::clamp(c.x, 0.f, 1.f), std::clamp(c.y, 0.f, 1.f), std::clamp(c.z, 0.f, 1.f)};
+}
+
+const float kMaxDistance =
+    std::pow(HyAB(hunt(XYZToCIELab(linearRGBToXYZ({0.f, 1.f, 0.f}))), hunt(XYZToCIELab(linearRGBToXYZ({0.f, 0.f, 1.f})))), kGqc);
+
+float redistributeErrors(float colorDifference, float featureDifference)
+{
+    float error = std::pow(colorDifference, kGqc);
+
+    // Normalization.
+    float perceptualCutoff = kGpc * kMaxDistance;
+    if (error < perceptualCutoff)
+        error *= kGpt / perceptualCutoff;
+    else
+        error = kGpt + ((error - perceptualCutoff) / (kMaxDistance - perceptualCutoff)) * (1.0f - kGpt);
+
+    return std::pow(error, 1.0f - featureDifference);
+}
+
+/// Convolve a padded row (width + taps - 1 values) with a kernel. The loop over pixels is innermost so it vectorizes.
+void convolveRow(const float* pSrc, const std::vector<float>& kernel, uint32_t width, float* pDst)
+{
+    std::fill(pDst, pDst + width, 0.f);
+    for (size_t i = 0; i < kernel.size(); ++i)
+    {
+        const float w = kernel[i];
+        const float* pTap = pSrc + i;
+        for (uint32_t x = 0; x < width; ++x)
+            pDst[x] += w * pTap[x];
+    }
+}
+
+/// Convolve a column of rows in a plane with a kernel. Accumulates into the destination row.
+void convolveColumn(const float* pSrc, const std::vector<float>& kernel, uint32_t width, float* pDst)
+{
+    for (size_t i = 0; i < kernel.size(); ++i)
+    {
+        const float w = kernel[i];
+        const float* pRow = pSrc + i * width;
+        for (uint32_t x = 0; x < width; ++x)
+            pDst[x] += w * pRow[x];
+    }
+}
+
+float length(float x, float y)
+{
+    return std::sqrt(x * x + y * y);
+}
+} // namespace
+
+struct FLIP::Planes
+{
+    // Horizontally filtered planes with (rowCount + 2 * radius) rows.
+    std::vector<float> Y;  ///< Achromatic channel, filtered with the CSF.
+    std::vector<float> Cx; ///< Red-green channel, filtered with the CSF.
+    std::vector<float> Cz1; ///< Blue-yellow channel, filtered with the first CSF Gaussian.
+    std::vector<float> Cz2; ///< Blue-yellow channel, filtered with the second CSF Gaussian.
+    std::vector<float> point; ///< Normalized luminance, filtered with the point kernel.
+    std::vector<float> gaussian; ///< Normalized luminance, filtered with the Gaussian.
+    std::vector<float> edge; ///< Normalized luminance, filtered with the edge kernel.
+
+    // Vertically filtered values of the current row.
+    std::vector<float> rowY, rowCx, rowCz;
+    std::vector<float> rowPointX, rowPointY;
+    std::vector<float> rowEdgeX, rowEdgeY;
+};
+
+FLIP::FLIP(const FLIPOptions& options)
+{
+    // Pixels per degree.
+    const float ppd = options.monitorDistanceMeters * (options.monitorWidthPixels / options.monitorWidthMeters) * (kPi / 180.0f);
+    const float dx = 1.0f / ppd;
+
+    // Radius of the spatial filter kernel, which is always greater than or equal to the radius of the feature detection kernel.
+    const int radius = int(std::ceil(3.0f * std::sqrt(0.04f / (2.0f * kPi * kPi)) * ppd));
+    mRadius = uint32_t(radius);
+    const size_t tapCount = 2 * mRadius + 1;
+
+    // CSF. Each channel is filtered with a weighted sum of Gaussians a * sqrt(pi / b) * exp(-pi^2 * d^2 / b).
+    // The weights and the normalization by the 2D kernel sum are folded into the vertical kernels.
+    auto gaussian = [&](float b)
+    {
+        std::vector<float> kernel(tapCount);
+        for (int x = -radius; x <= radius; ++x)
+        {
+            float p = x * dx;
+            kernel[x + radius] = std::exp(-(p * p) * kPi * kPi / b);
+        }
+        return kernel;
+    };
+    auto sum = [](const std::vector<float>& kernel)
+    {
+        double result = 0.0;
+        for (float w : kernel)
+            result += w;
+        return result;
+    };
+    auto scaled = [](const std::vector<float>& kernel, double scale)
+    {
+        std::vector<float> result(kernel.size());
+        for (size_t i = 0; i < kernel.size(); ++i)
+            result[i] = float(kernel[i] * scale);
+        return result;
+    };
+
+    mCSFA = gaussian(0.0047f);
+    mCSFRG = gaussian(0.0053f);
+    mCSFBY1 = gaussian(0.04f);
+    mCSFBY2 = gaussian(0.025f);
+
+    const double weightBY1 = 34.1 * std::sqrt(kPi / 0.04);
+    const double weightBY2 = 13.5 * std::sqrt(kPi / 0.025);
+    const double sumA = sum(mCSFA);
+    const double sumRG = sum(mCSFRG);
+    const double sumBY = weightBY1 * sum(mCSFBY1) * sum(mCSFBY1) + weightBY2 * sum(mCSFBY2) * sum(mCSFBY2);
+    mCSFAV = scaled(mCSFA, 1.0 / (sumA * sumA));
+    mCSFRGV = scaled(mCSFRG, 1.0 / (sumRG * sumRG));
+    mCSFBY1V = scaled(mCSFBY1, weightBY1 / sumBY);
+    mCSFBY2V = scaled(mCSFBY2, weightBY2 / sumBY);
+
+    // Feature detection. The 2D kernels are products of a 1D derivative kernel and a 1D Gaussian.
+    const float sigmaFeatures = 0.5f * kGw * ppd;
+    const float sigmaFeaturesSquared = sigmaFeatures * sigmaFeatures;
+    mGaussian.resize(tapCount);
+    for (int x = -radius; x <= radius; ++x)
+        mGaussian[x + radius] = std::exp(-float(x * x) / (2.0f * sigmaFeaturesSquared));
+
+    // The point kernel is normalized separately for its positive and negative parts.
+    double positiveKernelSum = 0.0;
+    double negativeKernelSum = 0.0;
+    double edgeKernelSum = 0.0;
+    for (int y = -radius; y <= radius; ++y)
+    {
+        for (int x = -radius; x <= radius; ++x)
+        {
+            float g = mGaussian[x + radius] * mGaussian[y + radius];
+            float pointWeight = (float(x * x) / sigmaFeaturesSquared - 1.0f) * g;
+            positiveKernelSum += std::max(pointWeight, 0.0f);
+            negativeKernelSum += std::max(-pointWeight, 0.0f);
+            edgeKernelSum += std::max(-x * g, 0.0f);
+        }
+    }
+
+    mPoint.resize(tapCount);
+    mEdge.resize(tapCount);
+    for (int x = -radius; x <= radius; ++x)
+    {
+        float pointWeight = (float(x * x) / sigmaFeaturesSquared - 1.0f) * mGaussian[x + radius];
+        mPoint[x + radius] = float(pointWeight / (pointWeight >= 0.0f ? positiveKernelSum : negativeKernelSum));
+        mEdge[x + radius] = float(-x * mGaussian[x + radius] / edgeKernelSum);
+    }
+}
+
+void FLIP::filter(uint32_t width, uint32_t rowCount, const float* pImage, Planes& planes) const
+{
+    const uint32_t paddedWidth = width + 2 * mRadius;
+    const size_t planeSize = size_t(rowCount + 2 * mRadius) * width;
+    for (auto pPlane : {&planes.Y, &planes.Cx, &planes.Cz1, &planes.Cz2, &planes.point, &planes.gaussian, &planes.edge})
+        pPlane->resize(planeSize);
+
+    std::vector<float> paddedY(paddedWidth);
+    std::vector<float> paddedCx(paddedWidth);
+    std::vector<float> paddedCz(paddedWidth);
+    std::vector<float> paddedL(paddedWidth);
+
+    for (uint32_t row = 0; row < rowCount + 2 * mRadius; ++row)
+    {
+        // Convert to YCxCz and replicate the edge pixels into the padding.
+        const float* pRow = pImage + size_t(row) * width * 4;
+        for (uint32_t x = 0; x < paddedWidth; ++x)
+        {
+            uint32_t srcX = uint32_t(std::clamp(int(x) - int(mRadius), 0, int(width) - 1));
+            const float* pPixel = pRow + size_t(srcX) * 4;
+            Color c = XYZToYCxCz(linearRGBToXYZ({pPixel[0], pPixel[1], pPixel[2]}));
+            paddedY[x] = c.x;
+            paddedCx[x] = c.y;
+            paddedCz[x] = c.z;
+            paddedL[x] = (c.x + 16.0f) / 116.0f; // Normalized Y from YCxCz.
+        }
+
+        const size_t offset = size_t(row) * width;
+        convolveRow(paddedY.data(), mCSFA, width, planes.Y.data() + offset);
+        convolveRow(paddedCx.data(), mCSFRG, width, planes.Cx.data() + offset);
+        convolveRow(paddedCz.data(), mCSFBY1, width, planes.Cz1.data() + offset);
+        convolveRow(paddedCz.data(), mCSFBY2, width, planes.Cz2.data() + offset);
+        convolveRow(paddedL.data(), mPoint, width, planes.point.data() + offset);
+        convolveRow(paddedL.data(), mGaussian, width, planes.gaussian.data() + offset);
+        convolveRow(paddedL.data(), mEdge, width, planes.edge.data() + offset);
+    }
+
+    for (auto pRow :
+         {&planes.rowY, &planes.rowCx, &planes.rowCz, &planes.rowPointX, &planes.rowPointY, &planes.rowEdgeX, &planes.rowEdgeY})
+        pRow->resize(width);
+}
+
+double FLIP::compute(uint32_t width, uint32_t rowCount, const float* pReference, const float* pTest, float* pErrors) const
+{
+    Planes reference;
+    Planes test;
+    filter(width, rowCount, pReference, reference);
+    filter(width, rowCount, pTest, test);
+
+    auto filterColumns = [&](Planes& planes, uint32_t y)
+    {
+        const size_t offset = size_t(y) * width;
+        for (auto pRow :
+             {&planes.rowY, &planes.rowCx, &planes.rowCz, &planes.rowPointX, &planes.rowPointY, &planes.rowEdgeX, &planes.rowEdgeY})
+            std::fill(pRow->begin(), pRow->end(), 0.f);
+
+        convolveColumn(planes.Y.data() + offset, mCSFAV, width, planes.rowY.data());
+        convolveColumn(planes.Cx.data() + offset, mCSFRGV, width, planes.rowCx.data());
+        convolveColumn(planes.Cz1.data() + offset, mCSFBY1V, width, planes.rowCz.data());
+        convolveColumn(planes.Cz2.data() + offset, mCSFBY2V, width, planes.rowCz.data());
+        convolveColumn(planes.point.data() + offset, mGaussian, width, planes.rowPointX.data());
+        convolveColumn(planes.gaussian.data() + offset, mPoint, width, planes.rowPointY.data());
+        convolveColumn(planes.edge.data() + offset, mGaussian, width, planes.rowEdgeX.data());
+        convolveColumn(planes.gaussian.data() + offset, mEdge, width, planes.rowEdgeY.data());
+    };
+
+    double errorSum = 0.0;
+    for (uint32_t y = 0; y < rowCount; ++y)
+    {
+        filterColumns(reference, y);
+        filterColumns(test, y);
+
+        float* pRowErrors = pErrors + size_t(y) * width;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            // Color pipeline.
+            Color referenceColor = clampColor(XYZToLinearRGB(YCxCzToXYZ({reference.rowY[x], reference.rowCx[x], reference.rowCz[x]})));
+            Color testColor = clampColor(XYZToLinearRGB(YCxCzToXYZ({test.rowY[x], test.rowCx[x], test.rowCz[x]})));
+            float colorDifference = HyAB(hunt(XYZToCIELab(linearRGBToXYZ(referenceColor))), hunt(XYZToCIELab(linearRGBToXYZ(testColor))));
+
+            // Feature pipeline.
+            float edgeDifference =
+                std::fabs(length(reference.rowEdgeX[x], reference.rowEdgeY[x]) - length(test.rowEdgeX[x], test.rowEdgeY[x]));
+            float pointDifference =
+                std::fabs(length(reference.rowPointX[x], reference.rowPointY[x]) - length(test.rowPointX[x], test.rowPointY[x]));
+            float featureDifference = std::pow(std::max(pointDifference, edgeDifference) * 0.70710678118654752f, kGqf);
+
+            float value = redistributeErrors(colorDifference, featureDifference);
+            if (!std::isfinite(value) || value < 0.0f || value > 1.0f)
+                value = 1.0f;
+
+            pRowErrors[x] = value;
+            errorSum += value;
+        }
+    }
+
+    return errorSum;
+}
+} // namespace Falcor
@@ -0,0 +1,94 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/// Viewing conditions used by FLIP to compute pixels per degree. The defaults match FLIPPass.
+struct FLIPOptions
+{
+    uint32_t monitorWidthPixels = 3840;
+    float monitorWidthMeters = 0.7f;
+    float monitorDistanceMeters = 0.7f;
+};
+
+/**
+ * CPU implementation of LDR-FLIP, matching the FLIPPass render pass with its default settings.
+ *
+ * FLIP filters both images with a contrast sensitivity function (CSF) and a set of feature detection kernels.
+ * All kernels are sums of separable Gaussians, so instead of gathering the full 2D footprint per pixel like the
+ * shader does, the filters are applied as a horizontal and a vertical pass over rows of pixels. Results agree with
+ * the GPU implementation up to floating point summation order.
+ *
+ * Images are processed in bands of rows. Each band needs getRadius() rows of context above and below.
+ */
+class FALCOR_API FLIP
+{
+public:
+    FLIP(const FLIPOptions& options = {});
+
+    /// Returns the filter radius in pixels.
+    uint32_t getRadius() const { return mRadius; }
+
+    /**
+     * Compute FLIP errors for a band of rows.
+     * @param[in] width Image width in pixels.
+     * @param[in] rowCount Number of rows in the band.
+     * @param[in] pReference Reference image rows in RGBA float format. Contains rowCount + 2 * getRadius() rows, starting
+     * getRadius() rows above the band. Rows outside of the image are expected to replicate the closest edge row.
+     * @param[in] pTest Test image rows, same layout as the reference.
+     * @param[out] pErrors Per-pixel FLIP errors of the band (width * rowCount values). Invalid results are set to 1.
+     * @return Sum of the FLIP errors of the band.
+     */
+    double compute(uint32_t width, uint32_t rowCount, const float* pReference, const float* pTest, float* pErrors) const;
+
+private:
+    /// Filtered image planes of a band.
+    struct Planes;
+
+    void filter(uint32_t width, uint32_t rowCount, const float* pImage, Planes& planes) const;
+
+    uint32_t mRadius;
+
+    // 1D kernels with 2 * mRadius + 1 taps.
+    std::vector<float> mCSFA;      ///< CSF for the achromatic channel.
+    std::vector<float> mCSFRG;     ///< CSF for the red-green channel.
+    std::vector<float> mCSFBY1;    ///< First Gaussian of the CSF for the blue-yellow channel.
+    std::vector<float> mCSFBY2;    ///< Second Gaussian of the CSF for the blue-yellow channel.
+    std::vector<float> mCSFAV;     ///< Vertical CSF for the achromatic channel, including normalization.
+    std::vector<float> mCSFRGV;    ///< Vertical CSF for the red-green channel, including normalization.
+    std::vector<float> mCSFBY1V;   ///< Vertical first blue-yellow Gaussian, including weight and normalization.
+    std::vector<float> mCSFBY2V;   ///< Vertical second blue-yellow Gaussian, including weight and normalization.
+    std::vector<float> mGaussian;  ///< Feature detection Gaussian.
+    std::vector<float> mPoint;     ///< Normalized point detection kernel (second derivative of the Gaussian).
+    std::vector<float> mEdge;      ///< Normalized edge detection kernel (first derivative of the Gaussian).
+};
+} // namespace Falcor
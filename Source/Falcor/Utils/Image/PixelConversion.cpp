@@ -0,0 +1,174 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PixelConversion.h"
+#include "Core/Assert.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FALCOR_PIXEL_CONVERSION_SSE 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if FALCOR_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define FALCOR_PIXEL_CONVERSION_SSE 0
+#endif
+
+// SSE2 is part of x86-64 and always available. SSSE3 kernels are compiled with a target attribute and selected at runtime.
+#if FALCOR_PIXEL_CONVERSION_SSE && !FALCOR_MSVC
+#define FALCOR_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define FALCOR_TARGET_SSSE3
+#endif
+
+namespace Falcor
+{
+namespace
+{
+void expandRGB8ToRGBA8Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        pDst[0] = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[2];
+        pDst[3] = alpha;
+        pSrc += 3;
+        pDst += 4;
+    }
+}
+
+#if FALCOR_PIXEL_CONVERSION_SSE
+bool hasSSSE3()
+{
+    static const bool sHasSSSE3 = []()
+    {
+#if FALCOR_MSVC
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ecx & bit_SSSE3) != 0;
+#endif
+    }();
+    return sHasSSSE3;
+}
+
+FALCOR_TARGET_SSSE3 void expandRGB8ToRGBA8SSSE3(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphaMask = _mm_set1_epi32(int(uint32_t(alpha) << 24));
+
+    // Each iteration converts 4 pixels but loads 16 source bytes, so stop early enough to not read past the end.
+    size_t i = 0;
+    for (; i + 6 <= pixelCount; i += 4)
+    {
+        __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+        __m128i dst = _mm_or_si128(_mm_shuffle_epi8(src, shuffle), alphaMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), dst);
+        pSrc += 12;
+        pDst += 16;
+    }
+
+    expandRGB8ToRGBA8Scalar(pSrc, pDst, pixelCount - i, alpha);
+}
+#endif // FALCOR_PIXEL_CONVERSION_SSE
+} // namespace
+
+void expandRGB8ToRGBA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+#if FALCOR_PIXEL_CONVERSION_SSE
+    if (hasSSSE3())
+        return expandRGB8ToRGBA8SSSE3(pSrc, pDst, pixelCount, alpha);
+#endif
+    expandRGB8ToRGBA8Scalar(pSrc, pDst, pixelCount, alpha);
+}
+
+void expandRGB32FloatToRGBA32Float(const float* pSrc, float* pDst, size_t pixelCount, float alpha)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE
+    // Each iteration loads 4 floats for a 3 float pixel, so the last pixel is handled by the scalar loop.
+    const __m128 alphaVec = _mm_set1_ps(alpha);
+    for (; i + 1 < pixelCount; ++i)
+    {
+        __m128 rgbx = _mm_loadu_ps(pSrc);
+        __m128 bbaa = _mm_shuffle_ps(rgbx, alphaVec, _MM_SHUFFLE(0, 0, 2, 2));
+        _mm_storeu_ps(pDst, _mm_shuffle_ps(rgbx, bbaa, _MM_SHUFFLE(2, 0, 1, 0)));
+        pSrc += 3;
+        pDst += 4;
+    }
+#endif
+    for (; i < pixelCount; ++i)
+    {
+        pDst[0] = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[2];
+        pDst[3] = alpha;
+        pSrc += 3;
+        pDst += 4;
+    }
+}
+
+void convertFloat16ToRGBA32Float(const uint16_t* pSrc, float* pDst, size_t pixelCount, uint32_t channelCount)
+{
+    FALCOR_ASSERT(channelCount >= 1 && channelCount <= 4);
+    const uint16_t kOne = 0x3c00;
+
+    // Four channels map one-to-one and use the bulk conversion.
+    if (channelCount == 4)
+        return math::float16ToFloat32(fstd::span<const uint16_t>(pSrc, pixelCount * 4), fstd::span<float>(pDst, pixelCount * 4));
+
+    // Otherwise gather the available channels and fill in the defaults in chunks, then use the bulk conversion on each chunk.
+    // This keeps a single conversion kernel for all channel counts.
+    const size_t kChunkSize = 256;
+    uint16_t pixels[kChunkSize * 4];
+    for (size_t i = 0; i < pixelCount; i += kChunkSize)
+    {
+        size_t count = std::min(kChunkSize, pixelCount - i);
+        for (size_t j = 0; j < count; ++j)
+        {
+            uint16_t* pPixel = pixels + j * 4;
+            pPixel[0] = pPixel[1] = pPixel[2] = 0;
+            pPixel[3] = kOne;
+            std::memcpy(pPixel, pSrc, channelCount * sizeof(uint16_t));
+            pSrc += channelCount;
+        }
+        math::float16ToFloat32(fstd::span<const uint16_t>(pixels, count * 4), fstd::span<float>(pDst, count * 4));
+        pDst += count * 4;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,69 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Bulk pixel conversion kernels used by the bitmap decoder.
+ * These use SIMD instructions where available and fall back to scalar code otherwise.
+ * Source and destination buffers must not overlap and need no particular alignment.
+ */
+
+/**
+ * Expand 3-channel 8-bit pixels to 4-channel 8-bit pixels. The channel order is preserved.
+ * @param[in] pSrc Source pixels (3 bytes per pixel).
+ * @param[out] pDst Destination pixels (4 bytes per pixel).
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] alpha Value written to the fourth channel.
+ */
+FALCOR_API void expandRGB8ToRGBA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha = 0xff);
+
+/**
+ * Expand 3-channel 32-bit float pixels to 4-channel 32-bit float pixels without clamping.
+ * @param[in] pSrc Source pixels (3 floats per pixel).
+ * @param[out] pDst Destination pixels (4 floats per pixel).
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] alpha Value written to the fourth channel.
+ */
+FALCOR_API void expandRGB32FloatToRGBA32Float(const float* pSrc, float* pDst, size_t pixelCount, float alpha = 1.f);
+
+/**
+ * Convert 16-bit float pixels with 1-4 channels to 4-channel 32-bit float pixels.
+ * Missing color channels are set to zero and a missing alpha channel is set to one.
+ * The conversion is exact and matches math::float16ToFloat32() for all inputs.
+ * @param[in] pSrc Source pixels (channelCount halfs per pixel).
+ * @param[out] pDst Destination pixels (4 floats per pixel).
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] channelCount Number of source channels (1-4).
+ */
+FALCOR_API void convertFloat16ToRGBA32Float(const uint16_t* pSrc, float* pDst, size_t pixelCount, uint32_t channelCount);
+} // namespace Falcor
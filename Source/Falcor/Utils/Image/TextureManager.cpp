@@ -27,10 +27,14 @@
  **************************************************************************/
 #include "TextureManager.h"
 #include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Math/FNVHash.h"
 
 #include <execution>
+#include <queue>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
@@ -42,10 +46,164 @@ namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::TextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+/// Evicted textures keep the mip levels up to this dimension resident.
+const uint32_t kEvictedTextureMaxDimension = 32;
+
+/**
+ * Get the number of top mip levels that can be dropped from a texture.
+ * Mip levels are dropped down to the first level not larger than kEvictedTextureMaxDimension,
+ * as long as the remaining levels have dimensions aligned to the compression block size.
+ */
+uint32_t getMaxDropCount(const Texture* pTexture)
+{
+    if (pTexture->getArraySize() != 1)
+        return 0;
+
+    const uint32_t blockWidth = getFormatWidthCompressionRatio(pTexture->getFormat());
+    const uint32_t blockHeight = getFormatHeightCompressionRatio(pTexture->getFormat());
+
+    uint32_t dropCount = 0;
+    while (dropCount + 1 < pTexture->getMipCount())
+    {
+        if (std::max(pTexture->getWidth(dropCount), pTexture->getHeight(dropCount)) <= kEvictedTextureMaxDimension)
+            break;
+        if (pTexture->getWidth(dropCount + 1) % blockWidth != 0 || pTexture->getHeight(dropCount + 1) % blockHeight != 0)
+            break;
+        dropCount++;
+    }
+    return dropCount;
+}
+
+/**
+ * Estimate the memory used by a texture after dropping its top mip levels.
+ * The memory is assumed to be proportional to the number of texels.
+ */
+uint64_t estimateReducedSize(const Texture* pTexture, uint64_t sizeInBytes, uint32_t dropCount)
+{
+    uint64_t totalTexelCount = 0;
+    uint64_t remainingTexelCount = 0;
+    for (uint32_t mip = 0; mip < pTexture->getMipCount(); ++mip)
+    {
+        const uint64_t texelCount = uint64_t(pTexture->getWidth(mip)) * pTexture->getHeight(mip);
+        totalTexelCount += texelCount;
+        if (mip >= dropCount)
+            remainingTexelCount += texelCount;
+    }
+    return totalTexelCount > 0 ? sizeInBytes * remainingTexelCount / totalTexelCount : 0;
+}
+
+/**
+ * Lock a mutex, counting the lock as contended if it can't be acquired immediately.
+ */
+std::unique_lock<std::mutex> lockCounted(std::mutex& mutex, std::atomic<uint64_t>& contentionCount)
+{
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        contentionCount.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+    return lock;
+}
 } // namespace
 
+TextureManager::TextureKey::TextureKey(const std::vector<std::filesystem::path>& paths, bool mips, bool srgb, Resource::BindFlags flags)
+    : fullPaths(paths), generateMipLevels(mips), loadAsSRGB(srgb), bindFlags(flags)
+{
+    FNVHash64 hasher;
+    for (const auto& path : fullPaths)
+    {
+        const auto& native = path.native();
+        hasher.insert(native.data(), native.size() * sizeof(native[0]));
+        // Separator so that different splits of the same characters hash differently.
+        const uint8_t separator = 0;
+        hasher.insert(&separator, sizeof(separator));
+    }
+    const uint32_t flagBits = (generateMipLevels ? 1u : 0u) | (loadAsSRGB ? 2u : 0u);
+    hasher.insert(&flagBits, sizeof(flagBits));
+    hasher.insert(&bindFlags, sizeof(bindFlags));
+
+    // FNV mixes poorly into the high bits, which are used for shard selection. Apply a final avalanche step.
+    uint64_t h = hasher.get();
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    hash = h;
+}
+
+TextureManager::DescTable::DescTable(size_t maxCount)
+{
+    mChunkCount = (maxCount + kChunkSize - 1) / kChunkSize;
+    mChunks = std::make_unique<std::atomic<Chunk*>[]>(mChunkCount);
+    for (size_t i = 0; i < mChunkCount; ++i)
+        mChunks[i].store(nullptr, std::memory_order_relaxed);
+}
+
+TextureManager::DescTable::~DescTable()
+{
+    for (size_t i = 0; i < mChunkCount; ++i)
+        delete mChunks[i].load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const TextureManager::TextureDesc> TextureManager::DescTable::load(uint32_t id) const
+{
+    if (id >= size())
+        return nullptr;
+    const Chunk* pChunk = mChunks[id >> kChunkBits].load(std::memory_order_acquire);
+    FALCOR_ASSERT(pChunk);
+    return std::atomic_load(&pChunk->slots[id & (kChunkSize - 1)].pDesc);
+}
+
+void TextureManager::DescTable::store(uint32_t id, const TextureDesc& desc)
+{
+    FALCOR_ASSERT(id < size());
+    Chunk* pChunk = mChunks[id >> kChunkBits].load(std::memory_order_relaxed);
+    std::atomic_store(&pChunk->slots[id & (kChunkSize - 1)].pDesc, std::shared_ptr<const TextureDesc>(std::make_shared<TextureDesc>(desc)));
+}
+
+uint32_t TextureManager::DescTable::append(const TextureDesc& desc)
+{
+    const size_t id = mSize.load(std::memory_order_relaxed);
+    FALCOR_ASSERT((id >> kChunkBits) < mChunkCount);
+
+    // Chunks are allocated on first use and never moved, so concurrent readers always see stable slots.
+    std::atomic<Chunk*>& chunk = mChunks[id >> kChunkBits];
+    Chunk* pChunk = chunk.load(std::memory_order_relaxed);
+    if (!pChunk)
+    {
+        pChunk = new Chunk();
+        chunk.store(pChunk, std::memory_order_release);
+    }
+    std::atomic_store(&pChunk->slots[id & (kChunkSize - 1)].pDesc, std::shared_ptr<const TextureDesc>(std::make_shared<TextureDesc>(desc)));
+
+    // Publish the new slot after it has been written.
+    mSize.store(id + 1, std::memory_order_release);
+    return static_cast<uint32_t>(id);
+}
+
+void TextureManager::DescTable::touch(uint32_t id, uint64_t frame)
+{
+    if (id >= size())
+        return;
+    Chunk* pChunk = mChunks[id >> kChunkBits].load(std::memory_order_acquire);
+    pChunk->slots[id & (kChunkSize - 1)].lastUsedFrame.store(frame, std::memory_order_relaxed);
+}
+
+uint64_t TextureManager::DescTable::getLastUsedFrame(uint32_t id) const
+{
+    FALCOR_ASSERT(id < size());
+    const Chunk* pChunk = mChunks[id >> kChunkBits].load(std::memory_order_acquire);
+    return pChunk->slots[id & (kChunkSize - 1)].lastUsedFrame.load(std::memory_order_relaxed);
+}
+
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
-    : mpDevice(pDevice), mAsyncTextureLoader(pDevice, threadCount), mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
+    : mpDevice(pDevice)
+    , mTextureDescs(std::min(maxTextureCount, kMaxTextureHandleCount))
+    , mAsyncTextureLoader(pDevice, threadCount)
+    , mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
 {}
 
 TextureManager::~TextureManager() {}
@@ -58,7 +216,20 @@ TextureManager::TextureHandle TextureManager::addTexture(const ref<Texture>& pTe
         throw ArgumentError("Only single-sample 2D textures can be added");
     }
 
-    std::unique_lock<std::mutex> lock(mMutex);
+    // If texture was originally loaded from disk, it is added to the key-to-handle map to avoid loading it again later if requested
+    // in loadTexture(). The key shard is locked before the manager lock to respect the lock order.
+    std::optional<TextureKey> textureKey;
+    std::unique_lock<std::mutex> shardLock;
+    if (!pTexture->getSourcePath().empty())
+    {
+        bool hasMips = pTexture->getMipCount() > 1;
+        bool isSrgb = isSrgbFormat(pTexture->getFormat());
+        textureKey.emplace(std::vector<std::filesystem::path>{pTexture->getSourcePath().string()}, hasMips, isSrgb, pTexture->getBindFlags());
+        mKeyLookupCount.fetch_add(1, std::memory_order_relaxed);
+        shardLock = lockCounted(getKeyShard(*textureKey).mutex, mKeyShardContentionCount);
+    }
+
+    auto lock = lockManager();
     TextureHandle handle;
 
     if (auto it = mTextureToHandle.find(pTexture.get()); it != mTextureToHandle.end())
@@ -75,18 +246,15 @@ TextureManager::TextureHandle TextureManager::addTexture(const ref<Texture>& pTe
         // Add to texture-to-handle map.
         mTextureToHandle[pTexture.get()] = handle;
 
-        // If texture was originally loaded from disk, add to key-to-handle map to avoid loading it again later if requested in
-        // loadTexture(). It's possible the user-provided texture has already been loaded by us. In that case, log a warning as the
+        // It's possible the user-provided texture has already been loaded by us. In that case, log a warning as the
         // redundant load should be fixed.
-        if (!pTexture->getSourcePath().empty())
+        if (textureKey)
         {
-            bool hasMips = pTexture->getMipCount() > 1;
-            bool isSrgb = isSrgbFormat(pTexture->getFormat());
-            TextureKey textureKey({pTexture->getSourcePath().string()}, hasMips, isSrgb, pTexture->getBindFlags());
-
-            if (mKeyToHandle.find(textureKey) == mKeyToHandle.end())
+            auto& keyToHandle = getKeyShard(*textureKey).keyToHandle;
+            if (keyToHandle.find(*textureKey) == keyToHandle.end())
             {
-                mKeyToHandle[textureKey] = handle;
+                keyToHandle.emplace(*textureKey, handle);
+                mHandleInfos[handle.getID()].key = std::move(textureKey);
             }
             else
             {
@@ -236,95 +404,47 @@ TextureManager::TextureHandle TextureManager::loadTexture(
         return handle;
     }
 
-    std::unique_lock<std::mutex> lock(mMutex);
     const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags);
-    if (auto it = mKeyToHandle.find(textureKey); it != mKeyToHandle.end())
-    {
-        // Texture is already managed. Return its handle.
-        handle = it->second;
-    }
-    else
-    {
-        if (mUseDeferredLoading)
-        {
-            // Add new texture desc.
-            TextureDesc desc = {TextureState::Referenced, nullptr};
-            handle = addDesc(desc);
-
-            // Add to key-to-handle map.
-            mKeyToHandle[textureKey] = handle;
-
-            // Return early.
-            return handle;
-        }
-
-#ifndef DISABLE_ASYNC_TEXTURE_LOADER
-        mLoadRequestsInProgress++;
-
-        // Texture is not already managed. Add new texture desc.
-        TextureDesc desc = {TextureState::Referenced, nullptr};
-        handle = addDesc(desc);
-
-        // Add to key-to-handle map.
-        mKeyToHandle[textureKey] = handle;
-
-        // Function called by the async texture loader when loading finishes.
-        // It's called by a worker thread so needs to acquire the mutex before changing any state.
-        auto callback = [=](ref<Texture> pTexture)
-        {
-            std::unique_lock<std::mutex> lock(mMutex);
+    mKeyLookupCount.fetch_add(1, std::memory_order_relaxed);
 
-            // Mark texture as loaded.
-            auto& desc = getDesc(handle);
-            desc.state = TextureState::Loaded;
-            desc.pTexture = pTexture;
-
-            // Add to texture-to-handle map.
-            if (pTexture)
-                mTextureToHandle[pTexture.get()] = handle;
-
-            mLoadRequestsInProgress--;
-            mCondition.notify_all();
-        };
-
-        // Issue load request to texture loader.
-        if (paths.size() > 1)
-        {
-            mAsyncTextureLoader.loadMippedFromFiles(paths, loadAsSRGB, bindFlags, callback);
-        }
-        else
-        {
-            mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, callback);
-        }
-#else
-        // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
+    // Look up the key in its shard. The shard stays locked until the new texture has been registered,
+    // so concurrent requests for the same texture resolve to the same handle.
+    KeyShard& shard = getKeyShard(textureKey);
+    {
+        auto shardLock = lockCounted(shard.mutex, mKeyShardContentionCount);
+        if (auto it = shard.keyToHandle.find(textureKey); it != shard.keyToHandle.end())
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags);
+            // Texture is already managed. Return its handle.
+            handle = it->second;
+            markTextureUsed(handle);
         }
         else
         {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags);
-        }
-
-        // Add new texture desc.
-        TextureDesc desc = {TextureState::Loaded, pTexture};
-        handle = addDesc(desc);
+            // Texture is not already managed. Add new texture desc in referenced state.
+            {
+                auto lock = lockManager();
+                TextureDesc desc = {TextureState::Referenced, nullptr};
+                handle = addDesc(desc);
+                mHandleInfos[handle.getID()].key = textureKey;
+
+                if (mUseDeferredLoading)
+                    mDeferredHandles.push_back(handle);
+                else
+                    mLoadRequestsInProgress++;
+            }
 
-        // Add to key-to-handle map.
-        mKeyToHandle[textureKey] = handle;
+            // Add to key-to-handle map.
+            shard.keyToHandle.emplace(textureKey, handle);
 
-        // Add to texture-to-handle map.
-        if (pTexture)
-            mTextureToHandle[pTexture.get()] = handle;
+            // Return early, the texture is loaded in endDeferredLoading().
+            if (mUseDeferredLoading)
+                return handle;
 
-        mCondition.notify_all();
-#endif
+            shardLock.unlock();
+            loadTextureData(handle, textureKey);
+        }
     }
 
-    lock.unlock();
-
     if (!mUseDeferredLoading && !async)
     {
         waitForTextureLoading(handle);
@@ -339,7 +459,7 @@ void TextureManager::waitForTextureLoading(const TextureHandle& handle)
         return;
 
     // Acquire mutex and wait for texture state to change.
-    std::unique_lock<std::mutex> lock(mMutex);
+    auto lock = lockManager();
     mCondition.wait(lock, [&]() { return getDesc(handle).state == TextureState::Loaded; });
 
     mpDevice->flushAndSync();
@@ -348,7 +468,7 @@ void TextureManager::waitForTextureLoading(const TextureHandle& handle)
 void TextureManager::waitForAllTexturesLoading()
 {
     // Acquire mutex and wait for all in-progress requests to finish.
-    std::unique_lock<std::mutex> lock(mMutex);
+    auto lock = lockManager();
     mCondition.wait(lock, [&]() { return mLoadRequestsInProgress == 0; });
 
     mpDevice->flushAndSync();
@@ -369,11 +489,15 @@ void TextureManager::endDeferredLoading()
 
     // Get a list of textures to load.
     std::vector<Job> jobs;
-    for (auto& [key, handle] : mKeyToHandle)
     {
-        auto& desc = getDesc(handle);
-        if (desc.state == TextureState::Referenced)
-            jobs.push_back(Job{key, handle});
+        auto lock = lockManager();
+        for (const auto& handle : mDeferredHandles)
+        {
+            const auto& textureKey = mHandleInfos[handle.getID()].key;
+            if (textureKey && getDesc(handle).state == TextureState::Referenced)
+                jobs.push_back(Job{*textureKey, handle});
+        }
+        mDeferredHandles.clear();
     }
 
     // Early out if there are no textures to load.
@@ -382,6 +506,7 @@ void TextureManager::endDeferredLoading()
         return;
 
     // Load textures in parallel.
+    std::vector<ref<Texture>> textures(jobs.size());
     std::atomic<size_t> texturesLoaded;
     NumericRange<size_t> jobRange(0, jobs.size());
     std::for_each(
@@ -389,17 +514,16 @@ void TextureManager::endDeferredLoading()
         [&](size_t i)
         {
             const auto& job = jobs[i];
-            auto& desc = getDesc(job.handle);
             if (job.key.fullPaths.size() == 1)
             {
-                desc.pTexture = Texture::createFromFile(
+                textures[i] = Texture::createFromFile(
                     mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags
                 );
                 logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
             }
             else
             {
-                desc.pTexture = Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags);
+                textures[i] = Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags);
                 logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
             }
             if (texturesLoaded.fetch_add(1) % 10 == 9)
@@ -413,12 +537,15 @@ void TextureManager::endDeferredLoading()
     mpDevice->flushAndSync();
 
     // Mark loaded textures and add them to lookup table.
-    for (const auto& job : jobs)
+    auto lock = lockManager();
+    for (size_t i = 0; i < jobs.size(); ++i)
     {
-        auto& desc = getDesc(job.handle);
-        desc.state = desc.pTexture ? TextureState::Loaded : TextureState::Invalid;
-        mTextureToHandle[desc.pTexture.get()] = job.handle;
+        const ref<Texture>& pTexture = textures[i];
+        setDesc(jobs[i].handle, {pTexture ? TextureState::Loaded : TextureState::Invalid, pTexture});
+        if (pTexture)
+            mTextureToHandle[pTexture.get()] = jobs[i].handle;
     }
+    mCondition.notify_all();
 }
 
 void TextureManager::removeTexture(const TextureHandle& handle)
@@ -426,24 +553,42 @@ void TextureManager::removeTexture(const TextureHandle& handle)
     if (handle.isUdim())
     {
         removeUdimTexture(handle);
+        return;
     }
     if (!handle)
         return;
 
     waitForTextureLoading(handle);
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    // Get the texture key, if any. It determines which key shard needs to be locked before the manager lock.
+    std::optional<TextureKey> textureKey;
+    {
+        auto lock = lockManager();
+        if (!getDesc(handle).isValid())
+            return;
+        textureKey = mHandleInfos[handle.getID()].key;
+    }
+
+    std::unique_lock<std::mutex> shardLock;
+    if (textureKey)
+        shardLock = lockCounted(getKeyShard(*textureKey).mutex, mKeyShardContentionCount);
+    auto lock = lockManager();
+
+    // Wait for a pending reload of a reduced or evicted texture to finish.
+    mCondition.wait(lock, [&]() { return !mHandleInfos[handle.getID()].reloadPending; });
 
-    // Get texture desc. If it's already cleared, we're done.
-    auto& desc = getDesc(handle);
-    if (!desc.isValid())
+    // Get texture desc. If it's already cleared or the handle has been reused in the meantime, we're done.
+    const TextureDesc desc = getDesc(handle);
+    if (!desc.isValid() || mHandleInfos[handle.getID()].key != textureKey)
         return;
 
     // Remove handle from maps.
-    // Note not all handles exist in key-to-handle map so search for it. This can be optimized if needed.
-    auto it = std::find_if(mKeyToHandle.begin(), mKeyToHandle.end(), [handle](const auto& keyVal) { return keyVal.second == handle; });
-    if (it != mKeyToHandle.end())
-        mKeyToHandle.erase(it);
+    if (textureKey)
+    {
+        auto& keyToHandle = getKeyShard(*textureKey).keyToHandle;
+        if (auto it = keyToHandle.find(*textureKey); it != keyToHandle.end() && it->second == handle)
+            keyToHandle.erase(it);
+    }
 
     if (desc.pTexture)
     {
@@ -452,7 +597,8 @@ void TextureManager::removeTexture(const TextureHandle& handle)
     }
 
     // Clear texture desc.
-    desc = {};
+    setDesc(handle, {});
+    mHandleInfos[handle.getID()] = {};
 
     // Return handle to the free list.
     mFreeList.push_back(handle);
@@ -466,34 +612,35 @@ TextureManager::TextureDesc TextureManager::getTextureDesc(const TextureHandle&
     if (!handle)
         return {};
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    FALCOR_ASSERT(handle && handle.getID() < mTextureDescs.size());
-    return mTextureDescs[handle.getID()];
+    // Read the published desc snapshot without taking the manager lock.
+    FALCOR_ASSERT(handle.getID() < mTextureDescs.size());
+    auto pDesc = mTextureDescs.load(handle.getID());
+    return pDesc ? *pDesc : TextureDesc{};
 }
 
 size_t TextureManager::getTextureDescCount() const
 {
-    std::lock_guard<std::mutex> lock(mMutex);
     return mTextureDescs.size();
 }
 
 void TextureManager::setShaderData(const ShaderVar& texturesVar, const size_t descCount, const ShaderVar& udimsVar) const
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto lock = lockManager();
 
-    if (mTextureDescs.size() > descCount)
+    const size_t textureDescCount = mTextureDescs.size();
+    if (textureDescCount > descCount)
     {
         throw RuntimeError(
-            "Descriptor array size ({}) is too small for the required number of textures ({})", descCount, mTextureDescs.size()
+            "Descriptor array size ({}) is too small for the required number of textures ({})", descCount, textureDescCount
         );
     }
 
     ref<Texture> nullTexture;
-    for (size_t i = 0; i < mTextureDescs.size(); i++)
+    for (size_t i = 0; i < textureDescCount; i++)
     {
-        texturesVar[i] = mTextureDescs[i].pTexture;
+        texturesVar[i] = mTextureDescs.load(static_cast<uint32_t>(i))->pTexture;
     }
-    for (size_t i = mTextureDescs.size(); i < descCount; i++)
+    for (size_t i = textureDescCount; i < descCount; i++)
     {
         texturesVar[i] = nullTexture;
     }
@@ -522,14 +669,103 @@ void TextureManager::setShaderData(const ShaderVar& texturesVar, const size_t de
     udimsVar = mpUdimIndirection;
 }
 
+void TextureManager::setResidencyBudget(uint64_t budgetInBytes)
+{
+    auto lock = lockManager();
+    mResidencyBudget = budgetInBytes;
+}
+
+uint64_t TextureManager::getResidencyBudget() const
+{
+    auto lock = lockManager();
+    return mResidencyBudget;
+}
+
+void TextureManager::markTextureUsed(const TextureHandle& handle)
+{
+    const uint64_t frame = mFrameIndex.load(std::memory_order_relaxed);
+    if (handle.isUdim())
+    {
+        // Mark all textures in the UDIM range.
+        size_t rangeStart = handle.getID();
+        for (size_t i = rangeStart; i < rangeStart + mUdimIndirectionSize[rangeStart]; ++i)
+        {
+            if (mUdimIndirection[i] >= 0)
+                mTextureDescs.touch(static_cast<uint32_t>(mUdimIndirection[i]), frame);
+        }
+        return;
+    }
+
+    if (handle)
+        mTextureDescs.touch(handle.getID(), frame);
+}
+
+std::vector<TextureManager::TextureReplacement> TextureManager::updateResidency()
+{
+    // Request reloads of reduced or evicted textures that have been used since, as long as they fit within the budget.
+    // Textures that don't fit stay reduced, otherwise they would be reduced again right after reloading.
+    std::vector<std::pair<TextureHandle, TextureKey>> reloads;
+    {
+        auto lock = lockManager();
+
+        // Memory used once the reloads in progress have finished.
+        uint64_t committedBytes = mResidentBytes;
+        for (uint32_t id = 0; mNonResidentCount > 0 && id < mTextureDescs.size(); ++id)
+        {
+            const auto& info = mHandleInfos[id];
+            if (info.reloadPending && info.fullSizeInBytes > info.sizeInBytes)
+                committedBytes += info.fullSizeInBytes - info.sizeInBytes;
+        }
+
+        for (uint32_t id = 0; mNonResidentCount > 0 && id < mTextureDescs.size(); ++id)
+        {
+            auto& info = mHandleInfos[id];
+            if (!info.key || info.reloadPending)
+                continue;
+            const auto pDesc = mTextureDescs.load(id);
+            if (pDesc->state != TextureState::Loaded || pDesc->residency == ResidencyState::Resident)
+                continue;
+            if (mTextureDescs.getLastUsedFrame(id) <= info.residencyFrame)
+                continue;
+
+            const uint64_t growth = info.fullSizeInBytes > info.sizeInBytes ? info.fullSizeInBytes - info.sizeInBytes : 0;
+            if (mResidencyBudget > 0 && committedBytes + growth > mResidencyBudget)
+                continue;
+            committedBytes += growth;
+
+            info.reloadPending = true;
+            mLoadRequestsInProgress++;
+            reloads.emplace_back(TextureHandle(id), *info.key);
+        }
+    }
+
+    for (const auto& [handle, key] : reloads)
+        loadTextureData(handle, key);
+
+    auto lock = lockManager();
+    std::vector<TextureReplacement> replacements = std::move(mPendingReplacements);
+    mPendingReplacements.clear();
+
+    if (mResidencyBudget > 0 && mResidentBytes > mResidencyBudget)
+        evictOverBudget(replacements);
+
+    mFrameIndex.fetch_add(1, std::memory_order_relaxed);
+    return replacements;
+}
+
 TextureManager::Stats TextureManager::getStats() const
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto lock = lockManager();
     TextureManager::Stats s;
-    for (const auto& t : mTextureDescs)
+    for (size_t i = 0; i < mTextureDescs.size(); i++)
     {
+        const auto& t = *mTextureDescs.load(static_cast<uint32_t>(i));
         if (!t.pTexture)
             continue;
+        if (t.residency == ResidencyState::Reduced)
+            s.reducedTextureCount++;
+        else if (t.residency == ResidencyState::Evicted)
+            s.evictedTextureCount++;
         uint64_t texelCount = t.pTexture->getTexelCount();
         uint32_t channelCount = getFormatChannelCount(t.pTexture->getFormat());
         s.textureCount++;
@@ -539,6 +775,12 @@ TextureManager::Stats TextureManager::getStats() const
         if (isCompressedFormat(t.pTexture->getFormat()))
             s.textureCompressedCount++;
     }
+    s.keyLookupCount = mKeyLookupCount.load(std::memory_order_relaxed);
+    s.keyShardContentionCount = mKeyShardContentionCount.load(std::memory_order_relaxed);
+    s.managerLockContentionCount = mManagerLockContentionCount.load(std::memory_order_relaxed);
+    s.residencyBudgetInBytes = mResidencyBudget;
+    s.residencyEvictionCount = mResidencyEvictionCount;
+    s.residencyReloadCount = mResidencyReloadCount;
     return s;
 }
 
@@ -551,7 +793,6 @@ TextureManager::TextureHandle TextureManager::addDesc(const TextureDesc& desc)
     {
         handle = mFreeList.back();
         mFreeList.pop_back();
-        getDesc(handle) = desc;
     }
     else
     {
@@ -559,20 +800,264 @@ TextureManager::TextureHandle TextureManager::addDesc(const TextureDesc& desc)
         {
             throw RuntimeError("Out of texture handles");
         }
-        handle = TextureHandle{static_cast<uint32_t>(mTextureDescs.size())};
-        mTextureDescs.emplace_back(desc);
+        handle = TextureHandle{mTextureDescs.append({})};
+        mHandleInfos.emplace_back();
     }
 
+    setDesc(handle, desc);
+    markTextureUsed(handle);
+
     return handle;
 }
 
-TextureManager::TextureDesc& TextureManager::getDesc(const TextureHandle& handle)
+TextureManager::TextureDesc TextureManager::getDesc(const TextureHandle& handle) const
 {
     if (handle.isUdim())
         return getDesc(resolveUdimTexture(handle));
 
     FALCOR_ASSERT(handle && handle.getID() < mTextureDescs.size());
-    return mTextureDescs[handle.getID()];
+    return *mTextureDescs.load(handle.getID());
+}
+
+void TextureManager::setDesc(const TextureHandle& handle, const TextureDesc& desc)
+{
+    FALCOR_ASSERT(handle && !handle.isUdim() && handle.getID() < mTextureDescs.size());
+
+    // Update residency bookkeeping.
+    const TextureDesc prevDesc = getDesc(handle);
+    if (prevDesc.residency != ResidencyState::Resident)
+        mNonResidentCount--;
+    if (desc.residency != ResidencyState::Resident)
+        mNonResidentCount++;
+
+    auto& info = mHandleInfos[handle.getID()];
+    mResidentBytes -= info.sizeInBytes;
+    info.sizeInBytes = desc.pTexture ? desc.pTexture->getTextureSizeInBytes() : 0;
+    mResidentBytes += info.sizeInBytes;
+
+    mTextureDescs.store(handle.getID(), desc);
+}
+
+void TextureManager::loadTextureData(const TextureHandle& handle, const TextureKey& key)
+{
+    // The caller is responsible for incrementing mLoadRequestsInProgress.
+#ifndef DISABLE_ASYNC_TEXTURE_LOADER
+    // Function called by the async texture loader when loading finishes.
+    auto callback = [=](ref<Texture> pTexture) { finishLoading(handle, pTexture); };
+
+    // Issue load request to texture loader.
+    if (key.fullPaths.size() > 1)
+    {
+        mAsyncTextureLoader.loadMippedFromFiles(key.fullPaths, key.loadAsSRGB, key.bindFlags, callback);
+    }
+    else
+    {
+        mAsyncTextureLoader.loadFromFile(key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, callback);
+    }
+#else
+    // Load texture from the calling thread. No locks are held while loading.
+    ref<Texture> pTexture;
+    if (key.fullPaths.size() > 1)
+    {
+        pTexture = Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags);
+    }
+    else
+    {
+        pTexture = Texture::createFromFile(mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags);
+    }
+    finishLoading(handle, pTexture);
+#endif
+}
+
+void TextureManager::finishLoading(const TextureHandle& handle, const ref<Texture>& pTexture)
+{
+    // This may be called by a worker thread so needs to acquire the mutex before changing any state.
+    auto lock = lockManager();
+
+    auto& info = mHandleInfos[handle.getID()];
+    if (pTexture)
+        info.fullSizeInBytes = pTexture->getTextureSizeInBytes();
+
+    if (!info.reloadPending)
+    {
+        // Textures loaded from file that don't fit within the residency budget are reduced right away,
+        // so that the full resolution textures of a large scene are never resident at the same time.
+        ref<Texture> pResident = pTexture;
+        ResidencyState residency = ResidencyState::Resident;
+        if (pTexture && info.key && mResidencyBudget > 0)
+        {
+            const uint64_t availableBytes = mResidencyBudget > mResidentBytes ? mResidencyBudget - mResidentBytes : 0;
+            const uint32_t maxDropCount = getMaxDropCount(pTexture.get());
+            uint32_t dropCount = 0;
+            while (dropCount < maxDropCount && estimateReducedSize(pTexture.get(), info.fullSizeInBytes, dropCount) > availableBytes)
+                dropCount++;
+            if (dropCount > 0)
+            {
+                pResident = createReducedTexture(pTexture, dropCount);
+                residency = dropCount == maxDropCount ? ResidencyState::Evicted : ResidencyState::Reduced;
+                info.residencyFrame = mFrameIndex.load(std::memory_order_relaxed);
+                mResidencyEvictionCount++;
+            }
+        }
+
+        // Mark texture as loaded.
+        setDesc(handle, {TextureState::Loaded, pResident, residency});
+
+        // Add to texture-to-handle map.
+        if (pResident)
+            mTextureToHandle[pResident.get()] = handle;
+    }
+    else if (pTexture)
+    {
+        // Replace the reduced or evicted texture by the reloaded one.
+        // The replacement is returned by the next call to updateResidency().
+        const TextureDesc prevDesc = getDesc(handle);
+        FALCOR_ASSERT(prevDesc.pTexture);
+        mTextureToHandle.erase(prevDesc.pTexture.get());
+        setDesc(handle, {TextureState::Loaded, pTexture});
+        mTextureToHandle[pTexture.get()] = handle;
+        mPendingReplacements.push_back({handle, prevDesc.pTexture, pTexture});
+        mResidencyReloadCount++;
+        info.reloadPending = false;
+    }
+    else
+    {
+        // Keep the reduced texture if reloading failed. Don't retry until the texture is reduced again.
+        logWarning("TextureManager: Failed to reload texture '{}'.", info.key ? info.key->fullPaths[0] : std::filesystem::path());
+        info.residencyFrame = std::numeric_limits<uint64_t>::max();
+        info.reloadPending = false;
+    }
+
+    mLoadRequestsInProgress--;
+    mCondition.notify_all();
+}
+
+void TextureManager::evictOverBudget(std::vector<TextureReplacement>& replacements)
+{
+    const uint64_t frame = mFrameIndex.load(std::memory_order_relaxed);
+
+    // Gather textures that can be reduced, i.e. reloadable textures with droppable mip levels.
+    struct Candidate
+    {
+        uint32_t id;
+        uint64_t lastUsedFrame;
+        uint64_t sizeInBytes;
+    };
+
+    std::vector<Candidate> unusedCandidates;
+    std::vector<Candidate> usedCandidates;
+    for (uint32_t id = 0; id < mTextureDescs.size(); ++id)
+    {
+        const auto& info = mHandleInfos[id];
+        if (!info.key || info.reloadPending)
+            continue;
+        const auto pDesc = mTextureDescs.load(id);
+        if (pDesc->state != TextureState::Loaded || !pDesc->pTexture || getMaxDropCount(pDesc->pTexture.get()) == 0)
+            continue;
+        const uint64_t lastUsedFrame = mTextureDescs.getLastUsedFrame(id);
+        auto& candidates = lastUsedFrame >= frame ? usedCandidates : unusedCandidates;
+        candidates.push_back({id, lastUsedFrame, info.sizeInBytes});
+    }
+
+    // Drop the top mip levels of a texture, replacing the texture object.
+    auto reduce = [&](uint32_t id, bool evict)
+    {
+        const TextureHandle handle(id);
+        const TextureDesc desc = getDesc(handle);
+        const uint32_t maxDropCount = getMaxDropCount(desc.pTexture.get());
+        FALCOR_ASSERT(maxDropCount > 0);
+
+        const uint32_t dropCount = evict ? maxDropCount : 1;
+        ref<Texture> pReduced = createReducedTexture(desc.pTexture, dropCount);
+        const ResidencyState residency = dropCount == maxDropCount ? ResidencyState::Evicted : ResidencyState::Reduced;
+
+        mTextureToHandle.erase(desc.pTexture.get());
+        setDesc(handle, {TextureState::Loaded, pReduced, residency});
+        mTextureToHandle[pReduced.get()] = handle;
+
+        mHandleInfos[id].residencyFrame = frame;
+        mResidencyEvictionCount++;
+        replacements.push_back({handle, desc.pTexture, pReduced});
+    };
+
+    // Textures not used in the current frame go first, least recently used first. Prefer larger textures among equally old ones.
+    std::sort(
+        unusedCandidates.begin(), unusedCandidates.end(),
+        [](const Candidate& lhs, const Candidate& rhs)
+        {
+            if (lhs.lastUsedFrame != rhs.lastUsedFrame)
+                return lhs.lastUsedFrame < rhs.lastUsedFrame;
+            return lhs.sizeInBytes > rhs.sizeInBytes;
+        }
+    );
+
+    // The first pass drops the top mip level of each texture. If that is not enough, the second pass evicts them.
+    for (bool evict : {false, true})
+    {
+        for (const auto& candidate : unusedCandidates)
+        {
+            if (mResidentBytes <= mResidencyBudget)
+                return;
+            if (getMaxDropCount(getDesc(TextureHandle(candidate.id)).pTexture.get()) > 0)
+                reduce(candidate.id, evict);
+        }
+    }
+
+    // If the textures in use exceed the budget on their own, drop the top mip level of the largest texture in use
+    // one at a time. This keeps the resolution of the textures in use as balanced as the budget allows.
+    // The textures are reloaded by updateResidency() once they fit within the budget again.
+    auto compareSize = [](const Candidate& lhs, const Candidate& rhs) { return lhs.sizeInBytes < rhs.sizeInBytes; };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(compareSize)> largestUsed(
+        compareSize, std::move(usedCandidates)
+    );
+    while (mResidentBytes > mResidencyBudget && !largestUsed.empty())
+    {
+        Candidate candidate = largestUsed.top();
+        largestUsed.pop();
+        reduce(candidate.id, false);
+
+        if (getMaxDropCount(getDesc(TextureHandle(candidate.id)).pTexture.get()) > 0)
+        {
+            candidate.sizeInBytes = mHandleInfos[candidate.id].sizeInBytes;
+            largestUsed.push(candidate);
+        }
+    }
+
+    if (mResidentBytes > mResidencyBudget)
+    {
+        logDebug(
+            "TextureManager: Texture memory ({}) exceeds the residency budget ({}) after eviction.", formatByteSize(mResidentBytes),
+            formatByteSize(mResidencyBudget)
+        );
+    }
+}
+
+ref<Texture> TextureManager::createReducedTexture(const ref<Texture>& pTexture, uint32_t dropCount) const
+{
+    FALCOR_ASSERT(dropCount > 0 && dropCount < pTexture->getMipCount());
+    const uint32_t mipCount = pTexture->getMipCount() - dropCount;
+
+    ref<Texture> pReduced = Texture::create2D(
+        mpDevice, pTexture->getWidth(dropCount), pTexture->getHeight(dropCount), pTexture->getFormat(), 1, mipCount, nullptr,
+        pTexture->getBindFlags()
+    );
+    pReduced->setSourcePath(pTexture->getSourcePath());
+
+    // Copy the remaining mip levels on the GPU.
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        pRenderContext->copySubresource(
+            pReduced.get(), pReduced->getSubresourceIndex(0, mip), pTexture.get(), pTexture->getSubresourceIndex(0, mip + dropCount)
+        );
+    }
+
+    return pReduced;
+}
+
+std::unique_lock<std::mutex> TextureManager::lockManager() const
+{
+    return lockCounted(mMutex, mManagerLockContentionCount);
 }
 
 size_t TextureManager::getUdimRange(size_t requiredSize)
@@ -32,12 +32,17 @@
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
 #include "Core/Program/ShaderVar.h"
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace Falcor
 {
@@ -49,6 +54,15 @@ class SearchDirectories;
  * This class manages a collection of textures and implements
  * asynchronous texture loading. All operations are thread-safe.
  *
+ * Texture keys are stored in a sharded hash index so that concurrent loads of
+ * different textures do not serialize on a single lock. Texture descs are published
+ * as immutable snapshots, which allows getTextureDesc() to run without locking.
+ *
+ * Optionally, the memory used by textures can be limited to a residency budget.
+ * Textures loaded from file that have not been used recently are then reduced to
+ * fewer mip levels or evicted, and reloaded when they are used again. If the textures
+ * in use exceed the budget on their own, the largest of them are reduced as well.
+ *
  * Each managed texture is assigned a unique handle upon loading.
  * This handle is used in shader code to reference the given texture
  * in the array of GPU texture descriptors.
@@ -64,6 +78,14 @@ public:
         Loaded,     ///< Texture has finished loading.
     };
 
+    /// Residency of a loaded texture.
+    enum class ResidencyState
+    {
+        Resident, ///< All mip levels are resident.
+        Reduced,  ///< Top mip levels have been dropped to stay within the residency budget.
+        Evicted,  ///< Texture has been evicted. Only the smallest mip levels are resident until it is reloaded.
+    };
+
     struct Stats
     {
         uint64_t textureCount = 0;             ///< Number of unique textures. A texture can be referenced by multiple materials.
@@ -71,6 +93,14 @@ public:
         uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
         uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
         uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t keyLookupCount = 0;           ///< Number of texture key lookups performed by loadTexture() and addTexture().
+        uint64_t keyShardContentionCount = 0;  ///< Number of key lookups that had to wait for a contended key shard lock.
+        uint64_t managerLockContentionCount = 0; ///< Number of times the manager lock was contended.
+        uint64_t residencyBudgetInBytes = 0;   ///< Residency budget in bytes, or zero if unlimited.
+        uint64_t reducedTextureCount = 0;      ///< Number of textures with top mip levels dropped.
+        uint64_t evictedTextureCount = 0;      ///< Number of evicted textures.
+        uint64_t residencyEvictionCount = 0;   ///< Total number of times textures were reduced or evicted.
+        uint64_t residencyReloadCount = 0;     ///< Total number of textures reloaded after being reduced or evicted.
     };
 
     /**
@@ -103,12 +133,21 @@ public:
     /// Struct describing a managed texture.
     struct TextureDesc
     {
-        TextureState state = TextureState::Invalid; ///< Current state of the texture.
-        ref<Texture> pTexture;                      ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        TextureState state = TextureState::Invalid;             ///< Current state of the texture.
+        ref<Texture> pTexture;                                  ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        ResidencyState residency = ResidencyState::Resident;    ///< Residency of the texture data when state is 'Loaded'.
 
         bool isValid() const { return state != TextureState::Invalid; }
     };
 
+    /// Texture object replaced by updateResidency(). The texture handle stays the same.
+    struct TextureReplacement
+    {
+        TextureHandle handle;      ///< Handle of the replaced texture.
+        ref<Texture> pOldTexture;  ///< Previous texture object.
+        ref<Texture> pNewTexture;  ///< New texture object.
+    };
+
     /**
      * Constructor.
      * @param[in] pDevice GPU device.
@@ -232,6 +271,41 @@ public:
      */
     void setShaderData(const ShaderVar& texturesVar, const size_t descCount, const ShaderVar& udimsVar) const;
 
+    /**
+     * Set the residency budget.
+     * When the memory used by managed textures exceeds the budget, updateResidency() reduces or evicts the least
+     * recently used textures. Only textures loaded from file are affected, as only those can be reloaded.
+     * Textures loaded while the budget is exceeded are reduced right after loading.
+     * @param[in] budgetInBytes Memory budget in bytes, or zero for unlimited.
+     */
+    void setResidencyBudget(uint64_t budgetInBytes);
+
+    /**
+     * Get the residency budget.
+     * @return Memory budget in bytes, or zero if unlimited.
+     */
+    uint64_t getResidencyBudget() const;
+
+    /**
+     * Mark a texture as used in the current frame.
+     * Used textures are reduced only after all textures not in use, and reduced or evicted textures that are used are
+     * reloaded by the next updateResidency() once they fit within the budget.
+     * This function does not take any locks and can be called from any thread.
+     * @param[in] handle Texture handle.
+     */
+    void markTextureUsed(const TextureHandle& handle);
+
+    /**
+     * Update texture residency. This should be called once per frame.
+     * Reduced and evicted textures that have been used since are reloaded if their full size fits within the budget.
+     * Then, while the memory used exceeds the budget, textures not used in the current frame are reduced by dropping
+     * their top mip level, or evicted down to their smallest mip levels, in least recently used order. If that is not
+     * enough, the top mip level of the largest texture in use is dropped until the budget is met.
+     * Reduced and evicted textures are replaced by new texture objects but keep their handles.
+     * @return List of replaced textures. Holders of the old texture objects should switch to the new ones.
+     */
+    std::vector<TextureReplacement> updateResidency();
+
     /**
      * Returns stats for the textures
      */
@@ -246,6 +320,7 @@ private:
 
     /**
      * Key to uniquely identify a managed texture.
+     * The hash is computed once on construction, so lookups and shard selection don't rehash the paths.
      */
     struct TextureKey
     {
@@ -253,36 +328,118 @@ private:
         bool generateMipLevels;
         bool loadAsSRGB;
         Resource::BindFlags bindFlags;
+        uint64_t hash;
 
-        TextureKey(const std::vector<std::filesystem::path>& paths, bool mips, bool srgb, Resource::BindFlags flags)
-            : fullPaths(paths), generateMipLevels(mips), loadAsSRGB(srgb), bindFlags(flags)
-        {}
+        TextureKey(const std::vector<std::filesystem::path>& paths, bool mips, bool srgb, Resource::BindFlags flags);
 
-        bool operator<(const TextureKey& rhs) const
+        bool operator==(const TextureKey& rhs) const
         {
-            if (fullPaths != rhs.fullPaths)
-                return fullPaths < rhs.fullPaths;
-            else if (generateMipLevels != rhs.generateMipLevels)
-                return generateMipLevels < rhs.generateMipLevels;
-            else if (loadAsSRGB != rhs.loadAsSRGB)
-                return loadAsSRGB < rhs.loadAsSRGB;
-            else
-                return bindFlags < rhs.bindFlags;
+            return hash == rhs.hash && generateMipLevels == rhs.generateMipLevels && loadAsSRGB == rhs.loadAsSRGB &&
+                   bindFlags == rhs.bindFlags && fullPaths == rhs.fullPaths;
         }
+        bool operator!=(const TextureKey& rhs) const { return !(*this == rhs); }
+    };
+
+    struct TextureKeyHash
+    {
+        size_t operator()(const TextureKey& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    static constexpr size_t kKeyShardBits = 6;
+    static constexpr size_t kKeyShardCount = size_t(1) << kKeyShardBits;
+
+    /// Shard of the key-to-handle index. Each shard is protected by its own mutex.
+    struct alignas(64) KeyShard
+    {
+        std::mutex mutex;
+        std::unordered_map<TextureKey, TextureHandle, TextureKeyHash> keyToHandle;
+    };
+
+    /**
+     * Table of texture descs indexed by handle ID.
+     * Descs are stored as immutable snapshots in fixed-size chunks that are never reallocated,
+     * so readers can access them without holding the manager mutex. Writers must hold the manager mutex.
+     */
+    class DescTable
+    {
+    public:
+        explicit DescTable(size_t maxCount);
+        ~DescTable();
+
+        DescTable(const DescTable&) = delete;
+        DescTable& operator=(const DescTable&) = delete;
+
+        /// Number of published descs. Safe to call without holding the manager mutex.
+        size_t size() const { return mSize.load(std::memory_order_acquire); }
+
+        /// Load the desc snapshot for an ID, or nullptr if the ID is out of range. Safe to call without holding the manager mutex.
+        std::shared_ptr<const TextureDesc> load(uint32_t id) const;
+
+        /// Replace the desc for an existing ID.
+        void store(uint32_t id, const TextureDesc& desc);
+
+        /// Append a desc and return its ID.
+        uint32_t append(const TextureDesc& desc);
+
+        /// Record that the texture with the given ID was used in a frame. Safe to call without holding the manager mutex.
+        void touch(uint32_t id, uint64_t frame);
+
+        /// Get the last frame the texture with the given ID was used in.
+        uint64_t getLastUsedFrame(uint32_t id) const;
+
+    private:
+        static constexpr size_t kChunkBits = 12;
+        static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+
+        struct Slot
+        {
+            std::shared_ptr<const TextureDesc> pDesc;
+            std::atomic<uint64_t> lastUsedFrame{0};
+        };
+
+        struct Chunk
+        {
+            std::array<Slot, kChunkSize> slots;
+        };
+
+        std::unique_ptr<std::atomic<Chunk*>[]> mChunks;
+        size_t mChunkCount = 0;
+        std::atomic<size_t> mSize{0};
     };
 
     TextureHandle addDesc(const TextureDesc& desc);
-    TextureDesc& getDesc(const TextureHandle& handle);
+    TextureDesc getDesc(const TextureHandle& handle) const;
+    void setDesc(const TextureHandle& handle, const TextureDesc& desc);
+    void loadTextureData(const TextureHandle& handle, const TextureKey& key);
+    void finishLoading(const TextureHandle& handle, const ref<Texture>& pTexture);
+    void evictOverBudget(std::vector<TextureReplacement>& replacements);
+    ref<Texture> createReducedTexture(const ref<Texture>& pTexture, uint32_t dropCount) const;
+
+    KeyShard& getKeyShard(const TextureKey& key) { return mKeyShards[key.hash >> (64 - kKeyShardBits)]; }
+    std::unique_lock<std::mutex> lockManager() const;
 
     ref<Device> mpDevice;
 
     mutable std::mutex mMutex;          ///< Mutex for synchronizing access to shared resources.
     std::condition_variable mCondition; ///< Condition variable to wait on for loading to finish.
 
+    DescTable mTextureDescs;                        ///< Table of all texture descs, indexed by handle ID. Readable without locking.
+    std::array<KeyShard, kKeyShardCount> mKeyShards; ///< Sharded map from texture key to handle. Lock order is shard, then mMutex.
+
     // Internal state. Do not access outside of critical section.
-    std::vector<TextureDesc> mTextureDescs;                   ///< Array of all texture descs, indexed by handle ID.
     std::vector<TextureHandle> mFreeList;                     ///< List of unused handles.
-    std::map<TextureKey, TextureHandle> mKeyToHandle;         ///< Map from texture key to handle.
+    /// Bookkeeping for each handle.
+    struct HandleInfo
+    {
+        std::optional<TextureKey> key; ///< Texture key, if the texture was added to the key index.
+        uint64_t sizeInBytes = 0;      ///< Memory used by the current texture object.
+        uint64_t fullSizeInBytes = 0;  ///< Memory used by the texture with all mip levels.
+        uint64_t residencyFrame = 0;   ///< Frame at which the texture was last reduced or evicted.
+        bool reloadPending = false;    ///< True while the full texture is being reloaded.
+    };
+
+    std::vector<HandleInfo> mHandleInfos;                     ///< Bookkeeping for each handle, indexed by handle ID.
+    std::vector<TextureHandle> mDeferredHandles;              ///< Handles queued up for deferred loading.
     std::map<const Texture*, TextureHandle> mTextureToHandle; ///< Map from texture ptr to handle.
     /// Map from UDIM-1001 to an actual textureID, -1 if the texture does not exist (e.g., there is 1001 and 1003, so 1002 [1] == -1)
     std::vector<int32_t> mUdimIndirection;
@@ -299,6 +456,18 @@ private:
     AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
 
+    uint64_t mResidencyBudget = 0;                    ///< Residency budget in bytes, or zero if unlimited.
+    uint64_t mResidentBytes = 0;                      ///< Memory used by all managed textures.
+    size_t mNonResidentCount = 0;                     ///< Number of reduced or evicted textures.
+    uint64_t mResidencyEvictionCount = 0;             ///< Total number of times textures were reduced or evicted.
+    uint64_t mResidencyReloadCount = 0;               ///< Total number of textures reloaded after being reduced or evicted.
+    std::vector<TextureReplacement> mPendingReplacements; ///< Replacements by completed reloads, returned by the next updateResidency().
+    std::atomic<uint64_t> mFrameIndex{1};             ///< Current frame for tracking texture usage.
+
     const size_t mMaxTextureCount; ///< Maximum number of textures that can be simultaneously managed.
+
+    mutable std::atomic<uint64_t> mKeyLookupCount{0};             ///< Number of texture key lookups.
+    mutable std::atomic<uint64_t> mKeyShardContentionCount{0};    ///< Number of contended key shard locks.
+    mutable std::atomic<uint64_t> mManagerLockContentionCount{0}; ///< Number of contended manager locks.
 };
 } // namespace Falcor
@@ -33,6 +33,24 @@
  */
 
 #include "Float16.h"
+#include "Core/Errors.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FALCOR_FLOAT16_SIMD 1
+#include <immintrin.h>
+#if FALCOR_MSVC
+#include <intrin.h>
+#endif
+#else
+#define FALCOR_FLOAT16_SIMD 0
+#endif
+
+// SSE2 is part of x86-64 and always available. AVX2/F16C kernels are compiled with a target attribute and selected at runtime.
+#if FALCOR_FLOAT16_SIMD && !FALCOR_MSVC
+#define FALCOR_TARGET_AVX2_F16C __attribute__((target("avx2,f16c")))
+#else
+#define FALCOR_TARGET_AVX2_F16C
+#endif
 
 namespace Falcor
 {
@@ -261,5 +279,234 @@ float float16ToFloat32(uint16_t value)
     return result.f;
 }
 
+//
+// Bulk conversion.
+//
+// The SIMD kernels implement the same rounding as the scalar code above (round to nearest, ties away from zero),
+// which differs from the round to nearest even of the F16C instructions. Conversion to half is therefore done with
+// integer operations, whereas conversion to float, which is exact, uses F16C with a fix-up for signaling NaNs.
+//
+
+namespace
+{
+thread_local bool tAVX2Enabled = true;
+
+#if FALCOR_FLOAT16_SIMD
+bool hasAVX2F16C()
+{
+    static const bool sHasAVX2F16C = []()
+    {
+#if FALCOR_MSVC
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        const bool hasF16C = (info[2] & (1 << 29)) != 0;
+        const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+        if (!hasF16C || !hasOSXSAVE || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        // Also checks that the OS saves the AVX state.
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+    }();
+    return tAVX2Enabled && sHasAVX2F16C;
+}
+
+/**
+ * Convert four floats to halfs stored in the low 16 bits of each lane.
+ */
+inline __m128i float32ToFloat16SSE2(__m128 value)
+{
+    const __m128i bits = _mm_castps_si128(value);
+    const __m128i abs = _mm_and_si128(bits, _mm_set1_epi32(0x7fffffff));
+    const __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+
+    // Normalized half: rebias the exponent and round the significand. Overflow is clamped to infinity.
+    __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(abs, _mm_set1_epi32(112 << 23)), _mm_set1_epi32(0x1000)), 13);
+    const __m128i overflow = _mm_cmpgt_epi32(normal, _mm_set1_epi32(0x7bff));
+    normal = _mm_or_si128(_mm_andnot_si128(overflow, normal), _mm_and_si128(overflow, _mm_set1_epi32(0x7c00)));
+
+    // Denormalized half: shift the significand right by 1 - e and round. The variable shift is done exactly by
+    // scaling with a power of two in floating-point, and all intermediate values are normalized floats.
+    const __m128i significand = _mm_or_si128(_mm_and_si128(abs, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x00800000));
+    const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_srli_epi32(abs, 23), _mm_set1_epi32(14)), 23));
+    __m128i denormal = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(significand), scale));
+    denormal = _mm_srli_epi32(_mm_add_epi32(denormal, _mm_set1_epi32(0x1000)), 13);
+
+    // Infinity and NaN. NaNs keep the upper significand bits with at least one bit set.
+    const __m128i nanSignificand = _mm_srli_epi32(_mm_and_si128(abs, _mm_set1_epi32(0x007fffff)), 13);
+    const __m128i isNaN = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7f800000));
+    const __m128i nanBit = _mm_and_si128(_mm_and_si128(isNaN, _mm_cmpeq_epi32(nanSignificand, _mm_setzero_si128())), _mm_set1_epi32(1));
+    const __m128i infNaN = _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0x7c00), nanSignificand), nanBit);
+
+    // Select the result. Values too small for a denormalized half become zero.
+    const __m128i isDenormal = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x32ffffff));
+    const __m128i isNormal = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x387fffff));
+    const __m128i isInfNaN = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7f7fffff));
+    __m128i result = _mm_and_si128(_mm_andnot_si128(isNormal, isDenormal), denormal);
+    result = _mm_or_si128(result, _mm_and_si128(_mm_andnot_si128(isInfNaN, isNormal), normal));
+    result = _mm_or_si128(result, _mm_and_si128(isInfNaN, infNaN));
+    return _mm_or_si128(result, sign);
+}
+
+/**
+ * Convert four halfs stored in the low 16 bits of each lane to floats.
+ */
+inline __m128 float16ToFloat32SSE2(__m128i value)
+{
+    const __m128i expMant = _mm_and_si128(value, _mm_set1_epi32(0x7fff));
+    const __m128i sign = _mm_slli_epi32(_mm_xor_si128(value, expMant), 16);
+
+    // Normalized numbers, infinities and NaNs: rebias the exponent, by 112 or by 224 for the maximum exponent.
+    const __m128i isInfNaN = _mm_cmpgt_epi32(expMant, _mm_set1_epi32(0x7bff));
+    const __m128i bias = _mm_add_epi32(_mm_set1_epi32(112 << 23), _mm_and_si128(isInfNaN, _mm_set1_epi32(112 << 23)));
+    const __m128i normal = _mm_add_epi32(_mm_slli_epi32(expMant, 13), bias);
+
+    // Zeros and denormalized numbers: the value is the significand times 2^-24.
+    const __m128i denormal = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(expMant), _mm_castsi128_ps(_mm_set1_epi32((127 - 24) << 23))));
+    const __m128i isDenormal = _mm_cmplt_epi32(expMant, _mm_set1_epi32(0x0400));
+
+    const __m128i result = _mm_or_si128(_mm_andnot_si128(isDenormal, normal), _mm_and_si128(isDenormal, denormal));
+    return _mm_castsi128_ps(_mm_or_si128(result, sign));
+}
+
+void float32ToFloat16SSE2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = float32ToFloat16SSE2(_mm_loadu_ps(pSrc + i));
+        __m128i hi = float32ToFloat16SSE2(_mm_loadu_ps(pSrc + i + 4));
+        // Sign-extend from 16 bits so that the signed saturating pack keeps all bits.
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packs_epi32(lo, hi));
+    }
+    for (; i < count; ++i)
+        pDst[i] = float32ToFloat16(pSrc[i]);
+}
+
+void float16ToFloat32SSE2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm_storeu_ps(pDst + i, float16ToFloat32SSE2(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(pDst + i + 4, float16ToFloat32SSE2(_mm_unpackhi_epi16(h, zero)));
+    }
+    for (; i < count; ++i)
+        pDst[i] = float16ToFloat32(pSrc[i]);
+}
+
+/**
+ * Convert eight floats to halfs stored in the low 16 bits of each lane. Same algorithm as the SSE2 version.
+ */
+FALCOR_TARGET_AVX2_F16C inline __m256i float32ToFloat16AVX2(__m256 value)
+{
+    const __m256i bits = _mm256_castps_si256(value);
+    const __m256i abs = _mm256_and_si256(bits, _mm256_set1_epi32(0x7fffffff));
+    const __m256i sign = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x8000));
+
+    __m256i normal = _mm256_srli_epi32(_mm256_add_epi32(_mm256_sub_epi32(abs, _mm256_set1_epi32(112 << 23)), _mm256_set1_epi32(0x1000)), 13);
+    normal = _mm256_min_epi32(normal, _mm256_set1_epi32(0x7c00));
+
+    // The variable shift is available as an instruction, but the shift amount may be out of range for lanes not using the result.
+    const __m256i significand = _mm256_or_si256(_mm256_and_si256(abs, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x00800000));
+    const __m256i shift = _mm256_sub_epi32(_mm256_set1_epi32(113), _mm256_srli_epi32(abs, 23));
+    __m256i denormal = _mm256_srlv_epi32(significand, shift);
+    denormal = _mm256_srli_epi32(_mm256_add_epi32(denormal, _mm256_set1_epi32(0x1000)), 13);
+
+    const __m256i nanSignificand = _mm256_srli_epi32(_mm256_and_si256(abs, _mm256_set1_epi32(0x007fffff)), 13);
+    const __m256i isNaN = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7f800000));
+    const __m256i nanBit = _mm256_and_si256(_mm256_and_si256(isNaN, _mm256_cmpeq_epi32(nanSignificand, _mm256_setzero_si256())), _mm256_set1_epi32(1));
+    const __m256i infNaN = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32(0x7c00), nanSignificand), nanBit);
+
+    const __m256i isDenormal = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x32ffffff));
+    const __m256i isNormal = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x387fffff));
+    const __m256i isInfNaN = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7f7fffff));
+    __m256i result = _mm256_and_si256(isDenormal, denormal);
+    result = _mm256_blendv_epi8(result, normal, isNormal);
+    result = _mm256_blendv_epi8(result, infNaN, isInfNaN);
+    return _mm256_or_si256(result, sign);
+}
+
+FALCOR_TARGET_AVX2_F16C void float32ToFloat16AVX2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i lo = float32ToFloat16AVX2(_mm256_loadu_ps(pSrc + i));
+        __m256i hi = float32ToFloat16AVX2(_mm256_loadu_ps(pSrc + i + 8));
+        // The pack operates on 128-bit lanes, restore the element order afterwards.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), packed);
+    }
+    float32ToFloat16SSE2(pSrc + i, pDst + i, count - i);
+}
+
+FALCOR_TARGET_AVX2_F16C void float16ToFloat32AVX2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m256 f = _mm256_cvtph_ps(h);
+
+        // F16C converts signaling NaNs to quiet NaNs. Redo the conversion bit by bit if there are any NaNs.
+        __m128i isNaN = _mm_cmpgt_epi16(_mm_and_si128(h, _mm_set1_epi16(0x7fff)), _mm_set1_epi16(0x7c00));
+        if (_mm_movemask_epi8(isNaN) != 0)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            f = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(float16ToFloat32SSE2(_mm_unpacklo_epi16(h, zero))), float16ToFloat32SSE2(_mm_unpackhi_epi16(h, zero)), 1
+            );
+        }
+
+        _mm256_storeu_ps(pDst + i, f);
+    }
+    float16ToFloat32SSE2(pSrc + i, pDst + i, count - i);
+}
+#endif // FALCOR_FLOAT16_SIMD
+} // namespace
+
+void setFloat16AVX2Enabled(bool enabled)
+{
+    tAVX2Enabled = enabled;
+}
+
+void float32ToFloat16(fstd::span<const float> src, fstd::span<uint16_t> dst)
+{
+    checkArgument(src.size() == dst.size(), "Source and destination sizes must match ({} != {}).", src.size(), dst.size());
+
+#if FALCOR_FLOAT16_SIMD
+    if (hasAVX2F16C())
+        return float32ToFloat16AVX2(src.data(), dst.data(), src.size());
+    return float32ToFloat16SSE2(src.data(), dst.data(), src.size());
+#else
+    for (size_t i = 0; i < src.size(); ++i)
+        dst[i] = float32ToFloat16(src[i]);
+#endif
+}
+
+void float16ToFloat32(fstd::span<const uint16_t> src, fstd::span<float> dst)
+{
+    checkArgument(src.size() == dst.size(), "Source and destination sizes must match ({} != {}).", src.size(), dst.size());
+
+#if FALCOR_FLOAT16_SIMD
+    if (hasAVX2F16C())
+        return float16ToFloat32AVX2(src.data(), dst.data(), src.size());
+    return float16ToFloat32SSE2(src.data(), dst.data(), src.size());
+#else
+    for (size_t i = 0; i < src.size(); ++i)
+        dst[i] = float16ToFloat32(src[i]);
+#endif
+}
+
 } // namespace math
 } // namespace Falcor
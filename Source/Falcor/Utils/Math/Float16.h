@@ -29,6 +29,8 @@
 
 #include "Core/Macros.h"
 
+#include <fstd/span.h>
+
 #include <cstdint>
 #include <limits>
 
@@ -40,6 +42,29 @@ namespace math
 FALCOR_API uint16_t float32ToFloat16(float value);
 FALCOR_API float float16ToFloat32(uint16_t value);
 
+/**
+ * Convert an array of floats to halfs.
+ * The result is bit-exact with the scalar float32ToFloat16() for all inputs. Uses SIMD instructions if supported by the CPU.
+ * @param[in] src Source values.
+ * @param[out] dst Destination values. Must have the same size as the source.
+ */
+FALCOR_API void float32ToFloat16(fstd::span<const float> src, fstd::span<uint16_t> dst);
+
+/**
+ * Convert an array of halfs to floats.
+ * The result is bit-exact with the scalar float16ToFloat32() for all inputs. Uses SIMD instructions if supported by the CPU.
+ * @param[in] src Source values.
+ * @param[out] dst Destination values. Must have the same size as the source.
+ */
+FALCOR_API void float16ToFloat32(fstd::span<const uint16_t> src, fstd::span<float> dst);
+
+/**
+ * Enable or disable the AVX2/F16C kernels of the bulk conversions on the calling thread.
+ * When disabled, the bulk conversions use the SSE2 kernels on x86-64. This is used by the unit tests to cover both kernels.
+ * @param[in] enabled True to use the AVX2/F16C kernels if supported by the CPU (default).
+ */
+FALCOR_API void setFloat16AVX2Enabled(bool enabled);
+
 struct float16_t
 {
     float16_t() = default;
@@ -27,119 +27,264 @@
  **************************************************************************/
 #include "AliasTable.h"
 #include "Core/Errors.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cmath>
 
 namespace Falcor
 {
-// This builds an alias table via the O(N) algorithm from Vose 1991, "A linear algorithm for generating random
-// numbers with a given distribution," IEEE Transactions on Software Engineering 17(9), 972-975.
+namespace
+{
+/// Number of items processed per task during construction. The chunking is fixed so that the result does not depend
+/// on the number of threads.
+const size_t kGrainSize = 1 << 16;
+
+/**
+ * Compute the exclusive prefix sum of value(i) for i in [0, count) in parallel.
+ * Each chunk is scanned locally and offset by the sum of the preceding chunks. The result is non-decreasing
+ * for non-negative values, which the binary searches during construction rely on.
+ * @return Prefix sums with count + 1 elements, the last element holds the total.
+ */
+template<typename ValueFunc>
+std::vector<double> parallelExclusiveScan(size_t count, ValueFunc value)
+{
+    std::vector<double> result(count + 1);
+    const size_t chunkCount = div_round_up(count, kGrainSize);
+
+    std::vector<double> offsets(chunkCount + 1, 0.0);
+    Threading::parallelFor(
+        0, chunkCount,
+        [&](size_t chunkBegin, size_t chunkEnd)
+        {
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+            {
+                double sum = 0.0;
+                for (size_t i = chunk * kGrainSize; i < std::min(count, (chunk + 1) * kGrainSize); ++i)
+                    sum += value(i);
+                offsets[chunk + 1] = sum;
+            }
+        },
+        1
+    );
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        offsets[chunk + 1] += offsets[chunk];
+
+    Threading::parallelFor(
+        0, chunkCount,
+        [&](size_t chunkBegin, size_t chunkEnd)
+        {
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+            {
+                double sum = 0.0;
+                for (size_t i = chunk * kGrainSize; i < std::min(count, (chunk + 1) * kGrainSize); ++i)
+                {
+                    result[i] = offsets[chunk] + sum;
+                    sum += value(i);
+                }
+            }
+        },
+        1
+    );
+    result[count] = offsets[chunkCount];
+
+    return result;
+}
+} // namespace
+
+// This builds an alias table by sweeping over the below-average ("light") and above-average ("heavy") items, as in
+// Hübschle-Schneider and Sanders 2019, "Parallel Weighted Random Sampling," ESA 2019. Each item i owns table entry i.
+//
+// The sequential sweep fills the entries of the light items in order with the excess weight of the current heavy item.
+// When a heavy item has given away so much weight that it is no longer above average, its own entry is filled with
+// the excess weight of the next heavy item. Let D[i] be the sum of the deficits (avg - weight) of lights 0..i-1 and
+// E[j] the sum of the excesses (weight - avg) of heavies 0..j-1. Both are non-decreasing, and the sweep state can be
+// derived from them directly:
 //
-// Basic idea:  creating each alias table entry combines one overweighted sample and one underweighted sample
-// into one alias table entry plus a residual sample (the overweighted sample minus some of its weight).
+//   - Light i is filled by the first heavy j with E[j+1] > D[i].
+//   - Heavy j is used up after the first light i with D[i] >= E[j+1]. Its own entry keeps the residual
+//     avg + E[j+1] - D[i] and is filled by heavy j+1.
 //
-// By first separating all inputs into 2 temporary buffer (one overweighted set, with weights above the
-// average; one underweighted set, with weights below average), we can simply walk through the lists once,
-// merging the first elements in each temporary buffer.  The residual sample is interted into either the
-// overweighted or underweighted set, depending on its residual weight.
+// D and E are computed with parallel prefix sums and the entries of each chunk of lights or heavies are computed
+// independently by a binary search for the starting position followed by a merge.
 //
-// The main complexity is dealing with corner cases, thanks to numerical precision issues, where you don't
-// have 2 valid entries to combine.  By definition, in these corner cases, all remaining unhandled samples
-// actually have the average weight (within numerical precision limits)
-AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng) : mCount((uint32_t)weights.size())
+// The corner cases are due to numerical precision, when the lights or heavies run out before the other set.
+// By definition, the remaining items then have the average weight (within numerical precision limits) and are
+// picked with 100% probability from their own entry.
+AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng, bool keepCpuData)
+    : AliasTable(std::move(weights))
 {
-    // Use >= since we reserve 0xFFFFFFFFu as an invalid flag marker during construction.
-    if (weights.size() >= std::numeric_limits<uint32_t>::max())
-        throw RuntimeError("Too many entries for alias table.");
+    mpWeights = Buffer::createStructured(
+        pDevice, sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mWeights.data()
+    );
 
-    std::uniform_int_distribution<uint32_t> rngDist;
+    std::vector<AliasTable::Item> items(mCount);
+    Threading::parallelFor(
+        0, mCount,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                items[i] = {mEntries[i].threshold, mEntries[i].alias, (uint32_t)i, 0};
+        },
+        kGrainSize
+    );
 
-    mpWeights = Buffer::createStructured(
-        pDevice, sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data()
+    // Stash the alias table in our GPU buffer
+    mpItems = Buffer::createStructured(
+        pDevice, sizeof(AliasTable::Item), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, items.data()
     );
 
-    // Our working set / intermediate buffers (underweight & overweight); initialize to "invalid"
-    std::vector<uint32_t> lowIdx(mCount, 0xFFFFFFFFu);
-    std::vector<uint32_t> highIdx(mCount, 0xFFFFFFFFu);
+    // The GPU buffers hold all data needed for sampling. Release the CPU copies, which are as large as the buffers.
+    if (!keepCpuData)
+    {
+        mWeights = std::vector<float>();
+        mEntries = std::vector<Entry>();
+        mHasCpuData = false;
+    }
+}
+
+AliasTable::AliasTable(std::vector<float> weights) : mCount((uint32_t)weights.size()), mWeights(std::move(weights))
+{
+    // Use >= since we reserve 0xFFFFFFFFu as an invalid index.
+    if (mWeights.size() >= std::numeric_limits<uint32_t>::max())
+        throw RuntimeError("Too many entries for alias table.");
+
+    build();
+}
+
+void AliasTable::build()
+{
+    const size_t count = mCount;
+    mEntries.resize(count);
+    if (count == 0)
+        return;
 
     // Sum element weights, use double to minimize precision issues
-    mWeightSum = 0.0;
-    for (float f : weights)
-        mWeightSum += f;
+    mWeightSum = Threading::parallelReduce(
+        size_t(0), count, 0.0,
+        [&](size_t begin, size_t end)
+        {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i)
+                sum += mWeights[i];
+            return sum;
+        },
+        [](double a, double b) { return a + b; },
+        kGrainSize
+    );
 
     // Find the average weight
-    float avgWeight = float(mWeightSum / double(mCount));
+    const double avgWeight = mWeightSum / double(count);
 
-    // Initialize working set. Inset inputs into our lists of above-average or below-average weight elements.
-    int lowCount = 0;
-    int highCount = 0;
-    for (uint32_t i = 0; i < mCount; ++i)
+    // All weights are zero (or invalid), fall back to uniform sampling.
+    if (!(avgWeight > 0.0) || !std::isfinite(avgWeight))
     {
-        if (weights[i] < avgWeight)
-            lowIdx[lowCount++] = i;
-        else
-            highIdx[highCount++] = i;
+        for (size_t i = 0; i < count; ++i)
+            mEntries[i] = {1.f, (uint32_t)i};
+        return;
     }
 
-    // Create alias table entries by merging above- and below-average samples
-    std::vector<AliasTable::Item> items(mCount);
-    for (uint32_t i = 0; i < mCount; ++i)
-    {
-        // Usual case:  We have an above-average and below-average sample we can combine into one alias table entry
-        if ((lowIdx[i] != 0xFFFFFFFFu) && (highIdx[i] != 0xFFFFFFFFu))
+    // Partition the items into lights and heavies, keeping the index order within each set.
+    const size_t chunkCount = div_round_up(count, kGrainSize);
+    std::vector<size_t> lightOffsets(chunkCount + 1, 0);
+    Threading::parallelFor(
+        0, chunkCount,
+        [&](size_t chunkBegin, size_t chunkEnd)
         {
-            // Create an alias table tuple:
-            items[i] = {weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i], 0};
-
-            // We've removed some weight from element highIdx[i]; update it's weight, then re-enter it
-            // on the end of either the above-average or below-average lists.
-            float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
-            weights[highIdx[i]] = updatedWeight;
-            if (updatedWeight < avgWeight)
-                lowIdx[lowCount++] = highIdx[i];
-            else
-                highIdx[highCount++] = highIdx[i];
-        }
-
-        // The next two cases can only occur towards the end of table creation, because either:
-        //    (a) all the remaining possible alias table entries have weight *exactly* equal to avgWeight,
-        //        which means these alias table entries only have one input item that is selected
-        //        with 100% probability
-        //    (b) all the remaining alias table entires have *almost* avgWeight, but due to (compounding)
-        //        precision issues throughout the process, they don't have *quite* that value.  In this case
-        //        treating these entries as having exactly avgWeight (as in case (a)) is the only right
-        //        thing to do mathematically (other than re-generating the alias table using higher precision
-        //        or trying to reduce catasrophic numerical cancellation in the "updatedWeight" computation above).
-        else if (highIdx[i] != 0xFFFFFFFFu)
-        {
-            items[i] = {1.0f, highIdx[i], highIdx[i], 0};
-        }
-        else if (lowIdx[i] != 0xFFFFFFFFu)
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+            {
+                size_t lightCount = 0;
+                for (size_t i = chunk * kGrainSize; i < std::min(count, (chunk + 1) * kGrainSize); ++i)
+                    lightCount += mWeights[i] < avgWeight ? 1 : 0;
+                lightOffsets[chunk + 1] = lightCount;
+            }
+        },
+        1
+    );
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        lightOffsets[chunk + 1] += lightOffsets[chunk];
+
+    const size_t lightCount = lightOffsets[chunkCount];
+    const size_t heavyCount = count - lightCount;
+    std::vector<uint32_t> lights(lightCount);
+    std::vector<uint32_t> heavies(heavyCount);
+    Threading::parallelFor(
+        0, chunkCount,
+        [&](size_t chunkBegin, size_t chunkEnd)
         {
-            items[i] = {1.0f, lowIdx[i], lowIdx[i], 0};
-        }
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+            {
+                size_t lightIndex = lightOffsets[chunk];
+                size_t heavyIndex = chunk * kGrainSize - lightOffsets[chunk];
+                for (size_t i = chunk * kGrainSize; i < std::min(count, (chunk + 1) * kGrainSize); ++i)
+                {
+                    if (mWeights[i] < avgWeight)
+                        lights[lightIndex++] = (uint32_t)i;
+                    else
+                        heavies[heavyIndex++] = (uint32_t)i;
+                }
+            }
+        },
+        1
+    );
+
+    // Prefix sums of the light deficits and heavy excesses.
+    const std::vector<double> D = parallelExclusiveScan(lightCount, [&](size_t i) { return avgWeight - mWeights[lights[i]]; });
+    const std::vector<double> E = parallelExclusiveScan(heavyCount, [&](size_t j) { return mWeights[heavies[j]] - avgWeight; });
 
-        // If there is neither a highIdx[i] or lowIdx[i] for some array element(s).  By construction,
-        // this cannot occur (without some logic bug above).
-        else
+    // Fill the entries of the lights.
+    Threading::parallelFor(
+        0, lightCount,
+        [&](size_t begin, size_t end)
         {
-            FALCOR_ASSERT(false); // Should not occur
-        }
-    }
+            // First heavy j with E[j+1] > D[begin].
+            size_t j = std::upper_bound(E.begin() + 1, E.end(), D[begin]) - (E.begin() + 1);
+            for (size_t i = begin; i < end; ++i)
+            {
+                while (j < heavyCount && E[j + 1] <= D[i])
+                    ++j;
 
-    // TODO: We can simplify the alias table to implicitly store indexB (aka lowIdx[i]), so the AliasTable::Item
-    // structure would be 1 float + 1 uint32_t, rather than 128 bits.  This, of course, would change usage in shaders
-    // and elsewhere.  To do this, here you'd need to sort elements by indexB so that when looking up mpItems[j],
-    // indexB==j.  This works since, by construction, only one element in the table has indexB==j (for any j
-    // in [0...mCount-1]).  Alternatively, during the loop above, you could directly enter elements into the
-    // correct location in the alias table.
+                const uint32_t index = lights[i];
+                if (j < heavyCount)
+                    mEntries[index] = {float(mWeights[index] / avgWeight), heavies[j]};
+                else
+                    mEntries[index] = {1.f, index};
+            }
+        },
+        kGrainSize
+    );
 
-    // Stash the alias table in our GPU buffer
-    mpItems = Buffer::createStructured(
-        pDevice, sizeof(AliasTable::Item), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, items.data()
+    // Fill the entries of the heavies.
+    Threading::parallelFor(
+        0, heavyCount,
+        [&](size_t begin, size_t end)
+        {
+            // First light i with D[i] >= E[begin+1].
+            size_t i = std::lower_bound(D.begin(), D.end(), E[begin + 1]) - D.begin();
+            for (size_t j = begin; j < end; ++j)
+            {
+                while (i <= lightCount && D[i] < E[j + 1])
+                    ++i;
+
+                const uint32_t index = heavies[j];
+                if (i <= lightCount && j + 1 < heavyCount)
+                {
+                    float threshold = float((avgWeight + E[j + 1] - D[i]) / avgWeight);
+                    mEntries[index] = {std::clamp(threshold, 0.f, 1.f), heavies[j + 1]};
+                }
+                else
+                {
+                    mEntries[index] = {1.f, index};
+                }
+            }
+        },
+        kGrainSize
     );
 }
 
 void AliasTable::setShaderData(const ShaderVar& var) const
 {
+    FALCOR_ASSERT(mpItems && mpWeights);
     var["items"] = mpItems;
     var["weights"] = mpWeights;
     var["count"] = mCount;
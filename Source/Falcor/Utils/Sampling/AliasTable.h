@@ -27,34 +27,99 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include "Core/Assert.h"
 #include "Core/API/Buffer.h"
 #include "Core/Program/ShaderVar.h"
+#include "Utils/Math/Vector.h"
+#include <algorithm>
 #include <memory>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
 /**
  * Implements the alias method for sampling from a discrete probability distribution.
+ * The table is built on the CPU in parallel and can be sampled both on the CPU and on the GPU (see AliasTable.slang).
+ * Tables created for the GPU release their CPU data after upload unless it is explicitly kept.
  */
 class FALCOR_API AliasTable
 {
 public:
+    /// Table entry for item i. Item i is picked if rnd < threshold, otherwise the alias is picked.
+    struct Entry
+    {
+        float threshold;
+        uint32_t alias;
+    };
+
     /**
-     * Create an alias table.
+     * Create an alias table and upload it to the GPU.
      * The weights don't need to be normalized to sum up to 1.
      * @param[in] pDevice GPU device.
      * @param[in] weights The weights we'd like to sample each entry proportional to.
-     * @param[in] rng The random number generator to use when creating the table.
+     * @param[in] rng The random number generator to use when creating the table (unused, the construction is deterministic).
+     * @param[in] keepCpuData Keep the weights and table entries on the CPU for sampling with sample() and getWeight().
+     */
+    AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng, bool keepCpuData = false);
+
+    /**
+     * Create an alias table on the CPU only.
+     * The weights don't need to be normalized to sum up to 1.
+     * @param[in] weights The weights we'd like to sample each entry proportional to.
      */
-    AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng);
+    explicit AliasTable(std::vector<float> weights);
 
     /**
      * Bind the alias table data to a given shader var.
+     * The table must have been created with a GPU device.
      * @param[in] var The shader variable to set the data into.
      */
     void setShaderData(const ShaderVar& var) const;
 
+    /**
+     * Sample from the table proportional to the weights.
+     * @param[in] index Uniform random index in [0..count).
+     * @param[in] rnd Uniform random number in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(uint32_t index, float rnd) const
+    {
+        FALCOR_ASSERT(mHasCpuData);
+        const Entry& entry = mEntries[index];
+        return rnd >= entry.threshold ? entry.alias : index;
+    }
+
+    /**
+     * Sample from the table proportional to the weights.
+     * @param[in] u Two uniform random numbers in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(float2 u) const
+    {
+        uint32_t index = std::min(mCount - 1, (uint32_t)(u.x * mCount));
+        return sample(index, u.y);
+    }
+
+    /**
+     * Get the original weight at a given index.
+     */
+    float getWeight(uint32_t index) const
+    {
+        FALCOR_ASSERT(mHasCpuData);
+        return mWeights[index];
+    }
+
+    /**
+     * Get the table entries. Empty if the CPU data was released.
+     */
+    const std::vector<Entry>& getEntries() const { return mEntries; }
+
+    /**
+     * Check if the weights and table entries are available on the CPU.
+     */
+    bool hasCpuData() const { return mHasCpuData; }
+
     /**
      * Get the number of weights in the table.
      */
@@ -66,6 +131,8 @@ public:
     double getWeightSum() const { return mWeightSum; }
 
 private:
+    void build();
+
     // Item structure for the mpItems buffer.
     struct Item
     {
@@ -75,9 +142,12 @@ private:
         uint32_t _pad;
     };
 
-    uint32_t mCount;       ///< Number of items in the alias table.
-    double mWeightSum;     ///< Total weight of all elements used to create the alias table.
-    ref<Buffer> mpItems;   ///< Buffer containing table items.
-    ref<Buffer> mpWeights; ///< Buffer containing item weights.
+    uint32_t mCount;             ///< Number of items in the alias table.
+    double mWeightSum = 0.0;     ///< Total weight of all elements used to create the alias table.
+    bool mHasCpuData = true;     ///< True if mWeights and mEntries are available.
+    std::vector<float> mWeights; ///< Item weights.
+    std::vector<Entry> mEntries; ///< Table entries.
+    ref<Buffer> mpItems;         ///< Buffer containing table items.
+    ref<Buffer> mpWeights;       ///< Buffer containing item weights.
 };
 } // namespace Falcor
@@ -27,17 +27,215 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Assert.h"
+#include "Utils/FileDependencies.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/TraceRecorder.h"
+#include <fmt/format.h>
+#include <chrono>
+#include <deque>
+#include <utility>
 
 namespace Falcor
 {
+struct Threading::TaskState
+{
+    std::function<void(void)> func;
+    std::atomic<bool> done{false};
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::shared_ptr<TaskState>> continuations;
+    uint64_t flowID = 0; ///< Trace flow from the dispatching thread to the executing thread.
+    FileDependencyRecorder::Context recorderContext; ///< File dependency recorder of the dispatching thread.
+};
+
 namespace
 {
+using TaskStatePtr = std::shared_ptr<Threading::TaskState>;
+
+/// Interval after which waiting threads re-check the queues for work they can help with.
+constexpr std::chrono::microseconds kWaitInterval{100};
+
+/// Number of chunks per thread created by parallelFor() if no grain size is given.
+constexpr size_t kChunksPerThread = 4;
+
+struct Worker
+{
+    std::mutex mutex;
+    std::deque<TaskStatePtr> queue; ///< Owner pushes/pops at the back, thieves steal from the front.
+    std::thread thread;
+};
+
 struct ThreadingData
 {
     bool initialized = false;
-    std::vector<std::thread> threads;
-    uint32_t current;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> terminate{false};
+    std::atomic<size_t> queuedCount{0};  ///< Number of tasks sitting in worker queues.
+    std::atomic<size_t> pendingCount{0}; ///< Number of tasks queued or executing.
+    std::atomic<uint32_t> nextWorker{0}; ///< Round-robin index for tasks submitted from outside the pool.
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
 } gData; // TODO: REMOVEGLOBAL
+
+thread_local int32_t tWorkerIndex = -1;
+thread_local uint32_t tTaskDepth = 0; ///< Number of tasks executing on the calling thread, including tasks run inline.
+
+void executeTask(const TaskStatePtr& pTask);
+
+void pushTask(TaskStatePtr pTask)
+{
+    gData.pendingCount.fetch_add(1);
+    pTask->flowID = TraceRecorder::beginFlow();
+
+    if (!gData.initialized)
+    {
+        executeTask(pTask);
+        return;
+    }
+
+    const size_t workerCount = gData.workers.size();
+    size_t index = tWorkerIndex >= 0 ? (size_t)tWorkerIndex : gData.nextWorker.fetch_add(1) % workerCount;
+
+    // Account for the task before it becomes visible so that thieves never decrement the counter below zero.
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        gData.queuedCount.fetch_add(1);
+    }
+    {
+        Worker& worker = *gData.workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(std::move(pTask));
+    }
+    gData.workAvailable.notify_one();
+}
+
+TaskStatePtr tryPopTask()
+{
+    const size_t workerCount = gData.workers.size();
+    if (workerCount == 0)
+        return nullptr;
+
+    TaskStatePtr pTask;
+    const int32_t self = tWorkerIndex;
+
+    // Pop from the back of our own queue first (most recently pushed, likely hot in cache).
+    if (self >= 0)
+    {
+        Worker& worker = *gData.workers[self];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.queue.empty())
+        {
+            pTask = std::move(worker.queue.back());
+            worker.queue.pop_back();
+        }
+    }
+
+    // Steal from the front of the other queues.
+    if (!pTask)
+    {
+        size_t start = self >= 0 ? (size_t)self + 1 : gData.nextWorker.load();
+        for (size_t i = 0; i < workerCount && !pTask; ++i)
+        {
+            size_t index = (start + i) % workerCount;
+            if ((int32_t)index == self)
+                continue;
+            Worker& worker = *gData.workers[index];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (!worker.queue.empty())
+            {
+                pTask = std::move(worker.queue.front());
+                worker.queue.pop_front();
+            }
+        }
+    }
+
+    if (pTask)
+        gData.queuedCount.fetch_sub(1);
+
+    return pTask;
+}
+
+void executeTask(const TaskStatePtr& pTask)
+{
+    {
+        FALCOR_TRACE_SCOPE("Task");
+        FileDependencyRecorder::Scope recorderScope(std::move(pTask->recorderContext));
+        tTaskDepth++;
+        TraceRecorder::endFlow(pTask->flowID);
+        try
+        {
+            pTask->func();
+        }
+        catch (...)
+        {
+            pTask->exception = std::current_exception();
+        }
+        pTask->func = nullptr;
+        tTaskDepth--;
+    }
+
+    std::vector<TaskStatePtr> continuations;
+    {
+        std::lock_guard<std::mutex> lock(pTask->mutex);
+        pTask->done = true;
+        continuations.swap(pTask->continuations);
+    }
+    pTask->condition.notify_all();
+
+    // Continuations are queued before this task is retired so that Threading::finish() also waits for them.
+    for (auto& pContinuation : continuations)
+        pushTask(std::move(pContinuation));
+
+    if (gData.pendingCount.fetch_sub(1) == 1)
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        gData.allDone.notify_all();
+    }
+}
+
+void workerMain(int32_t index)
+{
+    tWorkerIndex = index;
+    TraceRecorder::setThreadName(fmt::format("Worker {}", index));
+
+    while (true)
+    {
+        if (TaskStatePtr pTask = tryPopTask())
+        {
+            executeTask(pTask);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gData.mutex);
+        gData.workAvailable.wait(lock, []() { return gData.terminate || gData.queuedCount > 0; });
+        if (gData.terminate && gData.queuedCount == 0)
+            break;
+    }
+
+    tWorkerIndex = -1;
+}
+
+/// Execute queued tasks on the calling thread until done() returns true.
+/// Blocks on the given condition when there is nothing to help with.
+/// Any thread can help: workers pop from their own queue first, other threads steal from all queues. This keeps
+/// nested waits from deadlocking, also on threads outside the pool that execute a task inline.
+template<typename DoneFunc>
+void helpUntil(std::mutex& mutex, std::condition_variable& condition, DoneFunc done)
+{
+    while (!done())
+    {
+        if (TaskStatePtr pTask = tryPopTask())
+        {
+            executeTask(pTask);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait_for(lock, kWaitInterval, done);
+    }
+}
 } // namespace
 
 void Threading::start(uint32_t threadCount)
@@ -45,52 +243,225 @@ void Threading::start(uint32_t threadCount)
     if (gData.initialized)
         return;
 
-    gData.threads.resize(threadCount);
+    if (threadCount == 0)
+        threadCount = getLogicalThreadCount();
+
+    gData.terminate = false;
+    gData.workers.resize(threadCount);
+    for (auto& pWorker : gData.workers)
+        pWorker = std::make_unique<Worker>();
     gData.initialized = true;
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+        gData.workers[i]->thread = std::thread(workerMain, (int32_t)i);
 }
 
 void Threading::shutdown()
 {
-    for (auto& t : gData.threads)
+    if (!gData.initialized)
+        return;
+
+    finish();
+
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        gData.terminate = true;
+    }
+    gData.workAvailable.notify_all();
+
+    for (auto& pWorker : gData.workers)
     {
-        if (t.joinable())
-            t.join();
+        if (pWorker->thread.joinable())
+            pWorker->thread.join();
     }
 
+    gData.workers.clear();
     gData.initialized = false;
 }
 
-Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+uint32_t Threading::getThreadCount()
 {
-    FALCOR_ASSERT(gData.initialized);
+    return gData.initialized ? (uint32_t)gData.workers.size() : 0;
+}
 
-    std::thread& t = gData.threads[gData.current];
-    if (t.joinable())
-        t.join();
-    t = std::thread(func);
-    gData.current = (gData.current + 1) % gData.threads.size();
+int32_t Threading::getCurrentThreadIndex()
+{
+    return tWorkerIndex;
+}
 
-    return Task();
+Threading::Task Threading::dispatchTask(std::function<void(void)> func)
+{
+    auto pState = std::make_shared<TaskState>();
+    pState->func = std::move(func);
+    pState->recorderContext = FileDependencyRecorder::getContext();
+    pushTask(pState);
+    return Task(pState);
 }
 
 void Threading::finish()
 {
-    for (auto& t : gData.threads)
+    // Waiting for all tasks from within a task would wait for the calling task itself.
+    FALCOR_ASSERT(tTaskDepth == 0);
+
+    if (!gData.initialized)
+        return;
+
+    helpUntil(gData.mutex, gData.allDone, []() { return gData.pendingCount == 0; });
+}
+
+void Threading::parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize)
+{
+    if (begin >= end)
+        return;
+
+    if (grainSize == 0)
+        grainSize = getDefaultGrainSize(end - begin);
+
+    const size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+    const size_t helperCount = std::min<size_t>(getThreadCount(), chunkCount - 1);
+
+    // Chunks are handed out through a shared counter. The calling thread and up to one helper task per worker
+    // process chunks until the range is exhausted, so only a handful of tasks are allocated per call.
+    std::atomic<size_t> nextChunk{0};
+    auto processChunks = [&]()
+    {
+        size_t chunk;
+        while ((chunk = nextChunk.fetch_add(1)) < chunkCount)
+        {
+            size_t first = begin + chunk * grainSize;
+            size_t last = std::min(first + grainSize, end);
+            func(first, last);
+        }
+    };
+
+    if (helperCount == 0)
     {
-        if (t.joinable())
-            t.join();
+        processChunks();
+        return;
     }
+
+    TaskGroup group;
+    for (size_t i = 0; i < helperCount; ++i)
+        group.run(processChunks);
+
+    std::exception_ptr exception;
+    try
+    {
+        processChunks();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+        nextChunk = chunkCount;
+    }
+
+    group.finish();
+    if (exception)
+        std::rethrow_exception(exception);
 }
 
-Threading::Task::Task() {}
+size_t Threading::getDefaultGrainSize(size_t count)
+{
+    // Workers plus the calling thread.
+    size_t threadCount = getThreadCount() + 1;
+    size_t chunkCount = threadCount * kChunksPerThread;
+    return std::max<size_t>(1, (count + chunkCount - 1) / chunkCount);
+}
 
-bool Threading::Task::isRunning()
+bool Threading::Task::isRunning() const
 {
-    FALCOR_UNIMPLEMENTED();
+    return mpState && !mpState->done;
 }
 
 void Threading::Task::finish()
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return;
+
+    TaskState& state = *mpState;
+    helpUntil(state.mutex, state.condition, [&state]() { return state.done.load(); });
+
+    if (state.exception)
+        std::rethrow_exception(state.exception);
+}
+
+Threading::Task Threading::Task::then(std::function<void(void)> func)
+{
+    auto pNext = std::make_shared<TaskState>();
+    pNext->func = std::move(func);
+    pNext->recorderContext = FileDependencyRecorder::getContext();
+
+    if (mpState)
+    {
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        if (!mpState->done)
+        {
+            mpState->continuations.push_back(pNext);
+            return Task(pNext);
+        }
+    }
+
+    pushTask(pNext);
+    return Task(pNext);
+}
+
+Threading::TaskGroup::~TaskGroup()
+{
+    // Destructors must not throw, report task failures that were not observed through finish().
+    try
+    {
+        finish();
+    }
+    catch (const std::exception& e)
+    {
+        logError("Unhandled exception in task group: {}", e.what());
+    }
+    catch (...)
+    {
+        logError("Unhandled exception in task group.");
+    }
+}
+
+void Threading::TaskGroup::run(std::function<void(void)> func)
+{
+    mPendingCount.fetch_add(1);
+    dispatchTask(
+        [this, func = std::move(func)]()
+        {
+            std::exception_ptr exception;
+            try
+            {
+                func();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            onTaskDone(exception);
+        }
+    );
+}
+
+void Threading::TaskGroup::finish()
+{
+    helpUntil(mMutex, mCondition, [this]() { return mPendingCount == 0; });
+
+    // Synchronize with the last onTaskDone() call before the group can be destroyed.
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        exception = std::exchange(mException, nullptr);
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void Threading::TaskGroup::onTaskDone(std::exception_ptr exception)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (exception && !mException)
+        mException = exception;
+    if (mPendingCount.fetch_sub(1) == 1)
+        mCondition.notify_all();
 }
 } // namespace Falcor
@@ -27,10 +27,15 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <cstdint>
 
 namespace Falcor
@@ -38,35 +43,91 @@ namespace Falcor
 class FALCOR_API Threading
 {
 public:
-    const static uint32_t kDefaultThreadCount = 16;
+    /// Default thread count used by start(). A value of 0 creates one worker per logical core.
+    const static uint32_t kDefaultThreadCount = 0;
+
+    /// Internal state shared between a task and its handles (defined in Threading.cpp).
+    struct TaskState;
 
     /**
-     * Handle to a dispatched task
-     *
-     * TODO: Implementation
+     * Handle to a dispatched task.
+     * Handles are cheap to copy, all copies refer to the same task.
      */
-    class Task
+    class FALCOR_API Task
     {
     public:
-        ///  Check if task is still executing
-        bool isRunning();
+        Task() = default;
+
+        /// Returns true if the handle refers to a task.
+        bool isValid() const { return mpState != nullptr; }
+
+        /// Check if task is still executing (or waiting to be executed).
+        bool isRunning() const;
 
-        /// Wait for task to finish executing
+        /**
+         * Wait for task to finish executing.
+         * While waiting, the calling thread helps executing other queued tasks. This applies to any thread,
+         * so threads outside the pool can wait on tasks from within tasks they execute inline.
+         * If the task has thrown an exception, it is rethrown here.
+         */
         void finish();
 
+        /**
+         * Schedule a continuation that runs after this task has finished.
+         * If the task has already finished, the continuation is dispatched immediately.
+         * @return Handle to the continuation task.
+         */
+        Task then(std::function<void(void)> func);
+
     private:
-        Task();
+        Task(std::shared_ptr<TaskState> pState) : mpState(std::move(pState)) {}
+        std::shared_ptr<TaskState> mpState;
         friend class Threading;
     };
 
     /**
-     * Initializes the global thread pool
-     * @param[in] threadCount Number of threads in the pool
+     * Group of tasks that can be waited on as a whole.
+     * The group must outlive all of its tasks, the destructor waits for completion.
+     * Exceptions thrown by the tasks are rethrown by finish(). If the group is destroyed without calling finish(),
+     * they are logged instead.
+     */
+    class FALCOR_API TaskGroup
+    {
+    public:
+        TaskGroup() = default;
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        /// Dispatch a task as part of this group.
+        void run(std::function<void(void)> func);
+
+        /**
+         * Wait for all tasks in the group to finish.
+         * While waiting, the calling thread helps executing other queued tasks, see Task::finish().
+         * If any task has thrown an exception, the first one is rethrown here.
+         */
+        void finish();
+
+    private:
+        void onTaskDone(std::exception_ptr exception);
+
+        std::atomic<size_t> mPendingCount{0};
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::exception_ptr mException;
+    };
+
+    /**
+     * Initializes the global thread pool.
+     * @param[in] threadCount Number of worker threads in the pool. If 0, one worker per logical core is created.
      */
     static void start(uint32_t threadCount = kDefaultThreadCount);
 
     /**
-     * Waits for all currently executing threads to finish
+     * Waits for all currently queued and executing tasks to finish.
+     * Must not be called from within a task, regardless of whether the task runs on a worker or inline on another thread.
      */
     static void finish();
 
@@ -78,13 +139,81 @@ public:
     /**
      * Returns the maximum number of concurrent threads supported by the hardware
      */
-    static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
+    static uint32_t getLogicalThreadCount() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+    /**
+     * Returns the number of worker threads in the pool (0 if the pool is not running).
+     */
+    static uint32_t getThreadCount();
+
+    /**
+     * Returns the index of the calling worker thread or -1 if called from a thread that is not part of the pool.
+     */
+    static int32_t getCurrentThreadIndex();
 
     /**
      * Starts a task on an available thread.
+     * Tasks dispatched from a worker thread are pushed to that worker's queue, idle workers steal from other queues.
+     * If the pool is not running, the task is executed synchronously on the calling thread.
      * @return Handle to the task
      */
-    static Task dispatchTask(const std::function<void(void)>& func);
+    static Task dispatchTask(std::function<void(void)> func);
+
+    /**
+     * Run a function over the range [begin, end) in parallel.
+     * The range is split into chunks of grainSize elements and func(chunkBegin, chunkEnd) is called for each chunk.
+     * The calling thread participates in the work. If the pool is not running, the range is processed serially.
+     * @param[in] begin First index.
+     * @param[in] end One past the last index.
+     * @param[in] func Function called for each chunk.
+     * @param[in] grainSize Number of elements per chunk. If 0, a chunk size is chosen based on the thread count.
+     */
+    static void parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize = 0);
+
+    /**
+     * Reduce the range [begin, end) in parallel.
+     * Each chunk is reduced with mapFunc(chunkBegin, chunkEnd) and the chunk results are combined in order with
+     * reduceFunc(a, b), so the result is deterministic for a fixed grain size even for non-associative operations (e.g. float addition).
+     * @param[in] begin First index.
+     * @param[in] end One past the last index.
+     * @param[in] identity Identity value of the reduction.
+     * @param[in] mapFunc Function returning the reduced value for a chunk.
+     * @param[in] reduceFunc Function combining two reduced values.
+     * @param[in] grainSize Number of elements per chunk. If 0, a chunk size is chosen based on the thread count.
+     * @return The reduced value.
+     */
+    template<typename T, typename MapFunc, typename ReduceFunc>
+    static T parallelReduce(size_t begin, size_t end, T identity, MapFunc mapFunc, ReduceFunc reduceFunc, size_t grainSize = 0)
+    {
+        if (begin >= end)
+            return identity;
+        if (grainSize == 0)
+            grainSize = getDefaultGrainSize(end - begin);
+        const size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+        std::vector<T> results(chunkCount, identity);
+        parallelFor(
+            0, chunkCount,
+            [&](size_t chunkBegin, size_t chunkEnd)
+            {
+                for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+                {
+                    size_t first = begin + chunk * grainSize;
+                    size_t last = std::min(first + grainSize, end);
+                    results[chunk] = mapFunc(first, last);
+                }
+            },
+            1
+        );
+        T result = identity;
+        for (const T& value : results)
+            result = reduceFunc(result, value);
+        return result;
+    }
+
+    /**
+     * Returns the grain size used by parallelFor() and parallelReduce() if none is specified.
+     */
+    static size_t getDefaultGrainSize(size_t count);
 };
 
 /**
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Profiler.h"
+#include "TraceRecorder.h"
 #include "Core/API/Device.h"
 #include "Core/API/GpuTimer.h"
 #include "Utils/Logger.h"
@@ -312,7 +313,10 @@ Profiler::Profiler(ref<Device> pDevice) : mpDevice(pDevice)
 
 void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
 {
-    if (mEnabled && is_set(flags, Flags::Internal))
+    // The event stack is maintained even if the profiler is disabled, so that events which are started before and ended
+    // after enabling or disabling the profiler or the trace recorder stay balanced.
+    const bool trace = TraceRecorder::isEnabled();
+    if (is_set(flags, Flags::Internal))
     {
         // '/' is used as a "path delimiter", so it cannot be used in the event name.
         if (name.find('/') != std::string::npos)
@@ -321,17 +325,27 @@ void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name
             return;
         }
 
-        mCurrentEventName = mCurrentEventName + "/" + name;
-
-        Event* pEvent = getEvent(mCurrentEventName);
+        Event* pEvent = getChildEvent(mEventStack.empty() ? nullptr : mEventStack.back().pEvent, name);
         FALCOR_ASSERT(pEvent != nullptr);
-        if (!mPaused)
-            pEvent->start(*this, mFrameIndex);
 
-        if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
+        ActiveEvent activeEvent{pEvent};
+        if (mEnabled)
+        {
+            activeEvent.timed = !mPaused;
+            if (!mPaused)
+                pEvent->start(*this, mFrameIndex);
+
+            if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
+            {
+                mCurrentFrameEvents.push_back(pEvent);
+            }
+        }
+        if (trace)
         {
-            mCurrentFrameEvents.push_back(pEvent);
+            activeEvent.traced = true;
+            activeEvent.traceStartTime = TraceRecorder::getTimestamp();
         }
+        mEventStack.push_back(activeEvent);
     }
     if (is_set(flags, Flags::Pix))
     {
@@ -342,18 +356,19 @@ void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name
 
 void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
 {
-    if (mEnabled && is_set(flags, Flags::Internal))
+    if (is_set(flags, Flags::Internal) && !mEventStack.empty())
     {
         // '/' is used as a "path delimiter", so it cannot be used in the event name.
         if (name.find('/') != std::string::npos)
             return;
 
-        Event* pEvent = getEvent(mCurrentEventName);
-        FALCOR_ASSERT(pEvent != nullptr);
-        if (!mPaused)
-            pEvent->end(mFrameIndex);
+        ActiveEvent activeEvent = mEventStack.back();
+        mEventStack.pop_back();
 
-        mCurrentEventName.erase(mCurrentEventName.find_last_of("/"));
+        if (activeEvent.timed)
+            activeEvent.pEvent->end(mFrameIndex);
+        if (activeEvent.traced)
+            TraceRecorder::recordSlice(activeEvent.pEvent->mTraceNameID, activeEvent.traceStartTime, TraceRecorder::getTimestamp());
     }
 
     if (is_set(flags, Flags::Pix))
@@ -423,6 +438,19 @@ Profiler::Event* Profiler::createEvent(const std::string& name)
     return pEvent.get();
 }
 
+Profiler::Event* Profiler::getChildEvent(Event* pParent, const std::string& name)
+{
+    auto& children = pParent ? pParent->mChildren : mRootEvents;
+    auto it = children.find(name);
+    if (it != children.end())
+        return it->second;
+
+    Event* pEvent = getEvent((pParent ? pParent->getName() : std::string()) + "/" + name);
+    pEvent->mTraceNameID = TraceRecorder::internString(name);
+    children.emplace(name, pEvent);
+    return pEvent;
+}
+
 Profiler::Event* Profiler::findEvent(const std::string& name)
 {
     auto event = mEvents.find(name);
@@ -104,6 +104,9 @@ public:
 
         uint32_t mTriggered = 0; ///< Keeping track of nested calls to start().
 
+        std::unordered_map<std::string, Event*> mChildren; ///< Nested events by (non-nested) name.
+        uint32_t mTraceNameID = 0;                         ///< Interned (non-nested) name for the trace recorder.
+
         struct FrameData
         {
             CpuTimer::TimePoint cpuStartTime; ///< Last event CPU start time.
@@ -244,6 +247,15 @@ private:
      */
     Event* createEvent(const std::string& name);
 
+    /**
+     * Get a nested event, or create a new one if the event does not yet exist.
+     * The nested event name is only built when the event is created.
+     * @param[in] pParent The parent event or nullptr for top-level events.
+     * @param[in] name The (non-nested) event name.
+     * @return Returns the event.
+     */
+    Event* getChildEvent(Event* pParent, const std::string& name);
+
     /**
      * Find an event that was previously created.
      * @param[in] name The event name.
@@ -256,11 +268,19 @@ private:
     bool mEnabled = false;
     bool mPaused = false;
 
+    struct ActiveEvent
+    {
+        Event* pEvent = nullptr;
+        bool timed = false;          ///< True if the event is timed by the profiler.
+        bool traced = false;         ///< True if the event is recorded by the trace recorder.
+        uint64_t traceStartTime = 0; ///< Trace recorder start timestamp.
+    };
+
     std::unordered_map<std::string, std::shared_ptr<Event>> mEvents; ///< Events by name.
+    std::unordered_map<std::string, Event*> mRootEvents;             ///< Top-level events by name.
     std::vector<Event*> mCurrentFrameEvents;                         ///< Events registered for current frame.
     std::vector<Event*> mLastFrameEvents;                            ///< Events from last frame.
-    std::string mCurrentEventName;                                   ///< Current nested event name.
-    uint32_t mCurrentLevel = 0;                                      ///< Current nesting level.
+    std::vector<ActiveEvent> mEventStack;                            ///< Currently active (nested) events.
     uint32_t mFrameIndex = 0;                                        ///< Current frame index.
 
     std::shared_ptr<Capture> mpCapture; ///< Currently active capture.
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TimeReport.h"
+#include "TraceRecorder.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 #include <numeric>
@@ -65,6 +66,12 @@ void TimeReport::measure(const std::string& name)
 {
     auto currentTime = CpuTimer::getCurrentTimePoint();
     std::chrono::duration<double> duration = currentTime - mLastMeasureTime;
+    if (TraceRecorder::isEnabled())
+    {
+        TraceRecorder::recordSlice(
+            TraceRecorder::internString(name), TraceRecorder::toTimestamp(mLastMeasureTime), TraceRecorder::toTimestamp(currentTime)
+        );
+    }
     mLastMeasureTime = currentTime;
     mMeasurements.push_back({name, duration.count()});
 }
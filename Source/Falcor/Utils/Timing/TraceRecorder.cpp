@@ -0,0 +1,375 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TraceRecorder.h"
+#include "Core/Errors.h"
+#include "Utils/StringFormatters.h"
+#include "Utils/Scripting/ScriptBindings.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+enum class EventType : uint8_t
+{
+    Slice,
+    Instant,
+    FlowBegin,
+    FlowEnd,
+};
+
+struct Event
+{
+    uint64_t timestamp; ///< Start time in nanoseconds.
+    uint64_t value;     ///< Duration in nanoseconds (slices) or flow ID (flows).
+    uint32_t nameID;    ///< Interned name.
+    uint32_t detailID;  ///< Interned detail string.
+    EventType type;
+};
+
+/// Ring buffer of events recorded by a single thread.
+/// The owning thread is the only writer. Buffers are kept alive after the thread exits so that its events can be exported.
+struct ThreadBuffer
+{
+    uint32_t threadID = 0;
+    std::string name; ///< Thread name (guarded by TraceData::bufferMutex).
+    size_t capacity = 0;
+    std::unique_ptr<Event[]> events; ///< Allocated on first record.
+    std::atomic<uint64_t> writeCount{0};
+    std::atomic<uint64_t> readStart{0}; ///< Index of the first event not discarded by clear().
+};
+
+struct TraceData
+{
+    std::atomic<bool> enabled{false};
+    std::atomic<size_t> bufferCapacity{TraceRecorder::kDefaultBufferCapacity};
+    std::atomic<uint64_t> nextFlowID{1};
+    CpuTimer::TimePoint epoch = CpuTimer::getCurrentTimePoint();
+
+    std::mutex bufferMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    std::shared_mutex stringMutex;
+    std::unordered_map<std::string, uint32_t> stringToID;
+    std::vector<std::string> strings{""}; ///< Strings by ID. ID 0 is reserved for kInvalidStringID.
+} gData; // TODO: REMOVEGLOBAL
+
+thread_local ThreadBuffer* tpBuffer = nullptr;
+
+ThreadBuffer& getThreadBuffer()
+{
+    if (!tpBuffer)
+    {
+        auto pBuffer = std::make_shared<ThreadBuffer>();
+        pBuffer->capacity = gData.bufferCapacity.load();
+
+        std::lock_guard<std::mutex> lock(gData.bufferMutex);
+        pBuffer->threadID = (uint32_t)gData.buffers.size() + 1;
+        pBuffer->name = "Thread " + std::to_string(pBuffer->threadID);
+        gData.buffers.push_back(pBuffer);
+        tpBuffer = pBuffer.get();
+    }
+    return *tpBuffer;
+}
+
+void record(const Event& event)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    if (!buffer.events)
+        buffer.events = std::make_unique<Event[]>(buffer.capacity);
+
+    // Write the event before publishing it. Readers treat the slot following the published range as
+    // possibly being overwritten, see readEvents().
+    uint64_t index = buffer.writeCount.load(std::memory_order_relaxed);
+    buffer.events[index & (buffer.capacity - 1)] = event;
+    buffer.writeCount.store(index + 1, std::memory_order_release);
+}
+
+uint64_t getFirstAvailableIndex(const ThreadBuffer& buffer, uint64_t writeCount)
+{
+    // The slot at writeCount may be in the process of being written, which overwrites event (writeCount - capacity).
+    return writeCount >= buffer.capacity ? writeCount - buffer.capacity + 1 : 0;
+}
+
+/// Copy the events of a buffer. Events that are overwritten while copying are skipped.
+std::vector<Event> readEvents(const ThreadBuffer& buffer)
+{
+    std::vector<Event> events;
+
+    uint64_t end = buffer.writeCount.load(std::memory_order_acquire);
+    uint64_t begin = std::max(buffer.readStart.load(), getFirstAvailableIndex(buffer, end));
+    if (begin >= end)
+        return events;
+
+    events.reserve(end - begin);
+    for (uint64_t i = begin; i < end; ++i)
+        events.push_back(buffer.events[i & (buffer.capacity - 1)]);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t firstValid = getFirstAvailableIndex(buffer, buffer.writeCount.load(std::memory_order_relaxed));
+    if (firstValid > begin)
+        events.erase(events.begin(), events.begin() + std::min<uint64_t>(firstValid - begin, events.size()));
+
+    return events;
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>> getBuffers()
+{
+    std::lock_guard<std::mutex> lock(gData.bufferMutex);
+    return gData.buffers;
+}
+} // namespace
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    gData.enabled.store(enabled);
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return gData.enabled.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::setBufferCapacity(size_t capacity)
+{
+    checkArgument(capacity > 0, "'capacity' must be greater than zero.");
+    size_t powerOf2Capacity = 1;
+    while (powerOf2Capacity < capacity)
+        powerOf2Capacity <<= 1;
+    gData.bufferCapacity.store(powerOf2Capacity);
+}
+
+uint32_t TraceRecorder::internString(std::string_view str)
+{
+    std::string key(str);
+    {
+        std::shared_lock<std::shared_mutex> lock(gData.stringMutex);
+        auto it = gData.stringToID.find(key);
+        if (it != gData.stringToID.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(gData.stringMutex);
+    auto [it, inserted] = gData.stringToID.try_emplace(key, (uint32_t)gData.strings.size());
+    if (inserted)
+        gData.strings.push_back(std::move(key));
+    return it->second;
+}
+
+std::string TraceRecorder::getString(uint32_t id)
+{
+    std::shared_lock<std::shared_mutex> lock(gData.stringMutex);
+    return id < gData.strings.size() ? gData.strings[id] : std::string();
+}
+
+void TraceRecorder::setThreadName(std::string_view name)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(gData.bufferMutex);
+    buffer.name = name;
+}
+
+uint64_t TraceRecorder::toTimestamp(CpuTimer::TimePoint timePoint)
+{
+    return (uint64_t)std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint - gData.epoch).count());
+}
+
+void TraceRecorder::recordSlice(uint32_t nameID, uint64_t startTime, uint64_t endTime, uint32_t detailID)
+{
+    if (!isEnabled())
+        return;
+    record({startTime, endTime >= startTime ? endTime - startTime : 0, nameID, detailID, EventType::Slice});
+}
+
+void TraceRecorder::recordInstant(uint32_t nameID)
+{
+    if (!isEnabled())
+        return;
+    record({getTimestamp(), 0, nameID, kInvalidStringID, EventType::Instant});
+}
+
+uint64_t TraceRecorder::beginFlow()
+{
+    if (!isEnabled())
+        return 0;
+    uint64_t flowID = gData.nextFlowID.fetch_add(1, std::memory_order_relaxed);
+    record({getTimestamp(), flowID, kInvalidStringID, kInvalidStringID, EventType::FlowBegin});
+    return flowID;
+}
+
+void TraceRecorder::endFlow(uint64_t flowID)
+{
+    if (flowID == 0 || !isEnabled())
+        return;
+    record({getTimestamp(), flowID, kInvalidStringID, kInvalidStringID, EventType::FlowEnd});
+}
+
+void TraceRecorder::clear()
+{
+    for (const auto& pBuffer : getBuffers())
+        pBuffer->readStart.store(pBuffer->writeCount.load());
+}
+
+uint64_t TraceRecorder::getDroppedEventCount()
+{
+    uint64_t droppedCount = 0;
+    for (const auto& pBuffer : getBuffers())
+    {
+        uint64_t readStart = pBuffer->readStart.load();
+        uint64_t firstAvailable = getFirstAvailableIndex(*pBuffer, pBuffer->writeCount.load());
+        if (firstAvailable > readStart)
+            droppedCount += firstAvailable - readStart;
+    }
+    return droppedCount;
+}
+
+std::string TraceRecorder::toChromeTraceJson()
+{
+    // Chrome trace timestamps are in microseconds.
+    auto toMicroseconds = [](uint64_t ns) { return (double)ns * 1e-3; };
+    const uint32_t pid = 1;
+
+    std::vector<std::pair<uint32_t, std::string>> threads;
+    std::vector<std::vector<Event>> threadEvents;
+    {
+        std::lock_guard<std::mutex> lock(gData.bufferMutex);
+        for (const auto& pBuffer : gData.buffers)
+            threads.emplace_back(pBuffer->threadID, pBuffer->name);
+    }
+    auto buffers = getBuffers();
+    for (size_t i = 0; i < threads.size(); ++i)
+        threadEvents.push_back(readEvents(*buffers[i]));
+
+    nlohmann::json traceEvents = nlohmann::json::array();
+    traceEvents.push_back({{"ph", "M"}, {"name", "process_name"}, {"pid", pid}, {"tid", 0}, {"args", {{"name", "Falcor"}}}});
+
+    std::shared_lock<std::shared_mutex> stringLock(gData.stringMutex);
+    const auto& strings = gData.strings;
+    auto getName = [&strings](uint32_t id) -> const std::string& { return strings[id < strings.size() ? id : 0]; };
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        auto& events = threadEvents[i];
+        if (events.empty())
+            continue;
+
+        const uint32_t tid = threads[i].first;
+        traceEvents.push_back({{"ph", "M"}, {"name", "thread_name"}, {"pid", pid}, {"tid", tid}, {"args", {{"name", threads[i].second}}}}
+        );
+        traceEvents.push_back({{"ph", "M"}, {"name", "thread_sort_index"}, {"pid", pid}, {"tid", tid}, {"args", {{"sort_index", tid}}}});
+
+        // Slices are recorded when they end. Sort by start time and put enclosing slices first.
+        std::stable_sort(
+            events.begin(),
+            events.end(),
+            [](const Event& a, const Event& b)
+            {
+                if (a.timestamp != b.timestamp)
+                    return a.timestamp < b.timestamp;
+                uint64_t durationA = a.type == EventType::Slice ? a.value : 0;
+                uint64_t durationB = b.type == EventType::Slice ? b.value : 0;
+                return durationA > durationB;
+            }
+        );
+
+        for (const Event& event : events)
+        {
+            nlohmann::json e = {{"pid", pid}, {"tid", tid}, {"ts", toMicroseconds(event.timestamp)}};
+            switch (event.type)
+            {
+            case EventType::Slice:
+                e["ph"] = "X";
+                e["name"] = getName(event.nameID);
+                e["cat"] = "cpu";
+                e["dur"] = toMicroseconds(event.value);
+                if (event.detailID != kInvalidStringID)
+                    e["args"] = {{"detail", getName(event.detailID)}};
+                break;
+            case EventType::Instant:
+                e["ph"] = "i";
+                e["name"] = getName(event.nameID);
+                e["cat"] = "cpu";
+                e["s"] = "t";
+                break;
+            case EventType::FlowBegin:
+            case EventType::FlowEnd:
+                e["ph"] = event.type == EventType::FlowBegin ? "s" : "f";
+                e["name"] = "flow";
+                e["cat"] = "flow";
+                e["id"] = event.value;
+                if (event.type == EventType::FlowEnd)
+                    e["bp"] = "e";
+                break;
+            }
+            traceEvents.push_back(std::move(e));
+        }
+    }
+
+    nlohmann::json trace = {
+        {"traceEvents", std::move(traceEvents)},
+        {"displayTimeUnit", "ms"},
+        {"otherData", {{"droppedEventCount", getDroppedEventCount()}}},
+    };
+    return trace.dump();
+}
+
+void TraceRecorder::writeChromeTrace(const std::filesystem::path& path)
+{
+    std::string json = toChromeTraceJson();
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.good())
+        throw RuntimeError("Failed to open '{}' for writing.", path);
+    ofs.write(json.data(), json.size());
+}
+
+FALCOR_SCRIPT_BINDING(TraceRecorder)
+{
+    using namespace pybind11::literals;
+
+    pybind11::class_<TraceRecorder> traceRecorder(m, "TraceRecorder");
+    traceRecorder.def_property_static(
+        "enabled", [](pybind11::object) { return TraceRecorder::isEnabled(); },
+        [](pybind11::object, bool enabled) { TraceRecorder::setEnabled(enabled); }
+    );
+    traceRecorder.def_property_readonly_static(
+        "dropped_event_count", [](pybind11::object) { return TraceRecorder::getDroppedEventCount(); }
+    );
+    traceRecorder.def_static("clear", &TraceRecorder::clear);
+    traceRecorder.def_static("write_chrome_trace", &TraceRecorder::writeChromeTrace, "path"_a);
+}
+} // namespace Falcor
@@ -0,0 +1,200 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "CpuTimer.h"
+#include "Core/Macros.h"
+#include "Core/FalcorConfig.h"
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Multithreaded CPU event recorder with Chrome trace export.
+ * Each thread records events into its own ring buffer. Recording is lock-free: the owning thread is the only writer
+ * and the buffer is only read when exporting. If a buffer overflows, the oldest events of that thread are overwritten.
+ * Event names are interned once and referred to by ID, so recording an event does not allocate.
+ * Flow events connect a slice on one thread (e.g. dispatching a task) with a slice on another thread (e.g. executing it).
+ * The recorded events can be exported to the Chrome trace event format, which can be opened in chrome://tracing or Perfetto.
+ *
+ * Use the FALCOR_TRACE_SCOPE macro to record the duration of a scope. The recorder is disabled by default.
+ */
+class FALCOR_API TraceRecorder
+{
+public:
+    /// Default number of events per thread ring buffer.
+    static constexpr size_t kDefaultBufferCapacity = 1 << 16;
+
+    /// Interned string ID denoting "no string".
+    static constexpr uint32_t kInvalidStringID = 0;
+
+    /**
+     * Enable/disable recording.
+     * @param[in] enabled True to enable recording.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Check if recording is enabled.
+     * @return Returns true if recording is enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * Set the ring buffer capacity per thread.
+     * The capacity only applies to threads that have not recorded any events yet.
+     * @param[in] capacity Number of events per thread (rounded up to the next power of two).
+     */
+    static void setBufferCapacity(size_t capacity);
+
+    /**
+     * Intern a string.
+     * @param[in] str The string.
+     * @return Returns a unique ID for the string. The same string always returns the same ID.
+     */
+    static uint32_t internString(std::string_view str);
+
+    /**
+     * Get the string for an interned string ID.
+     * @param[in] id Interned string ID.
+     * @return Returns the string or an empty string if the ID is invalid.
+     */
+    static std::string getString(uint32_t id);
+
+    /**
+     * Set the name of the calling thread, shown as the track name in the exported trace.
+     * @param[in] name Thread name.
+     */
+    static void setThreadName(std::string_view name);
+
+    /**
+     * Get the current timestamp used for recording events.
+     * @return Returns the time in nanoseconds since the recorder was initialized.
+     */
+    static uint64_t getTimestamp() { return toTimestamp(CpuTimer::getCurrentTimePoint()); }
+
+    /**
+     * Convert a CPU time point to a trace timestamp.
+     * @param[in] timePoint Time point.
+     * @return Returns the time in nanoseconds since the recorder was initialized.
+     */
+    static uint64_t toTimestamp(CpuTimer::TimePoint timePoint);
+
+    /**
+     * Record a slice on the calling thread. Does nothing if recording is disabled.
+     * @param[in] nameID Interned name of the slice.
+     * @param[in] startTime Start timestamp.
+     * @param[in] endTime End timestamp.
+     * @param[in] detailID Optional interned detail string, exported as the "detail" argument of the slice.
+     */
+    static void recordSlice(uint32_t nameID, uint64_t startTime, uint64_t endTime, uint32_t detailID = kInvalidStringID);
+
+    /**
+     * Record an instant event on the calling thread. Does nothing if recording is disabled.
+     * @param[in] nameID Interned name of the event.
+     */
+    static void recordInstant(uint32_t nameID);
+
+    /**
+     * Start a flow on the calling thread. The flow is attached to the enclosing slice.
+     * @return Returns the flow ID to pass to endFlow(), or 0 if recording is disabled.
+     */
+    static uint64_t beginFlow();
+
+    /**
+     * End a flow on the calling thread. The flow is attached to the enclosing slice, or the slice starting at the same time.
+     * @param[in] flowID Flow ID returned by beginFlow(). Does nothing if 0.
+     */
+    static void endFlow(uint64_t flowID);
+
+    /**
+     * Discard all events recorded so far.
+     * Events that are recorded concurrently with this call may or may not be discarded.
+     */
+    static void clear();
+
+    /**
+     * Get the number of events lost due to ring buffer overflows since the last clear().
+     */
+    static uint64_t getDroppedEventCount();
+
+    /**
+     * Export the recorded events in Chrome trace event format.
+     * Exporting while other threads are recording is safe, events overwritten during the export are skipped.
+     * @return Returns the JSON string.
+     */
+    static std::string toChromeTraceJson();
+
+    /**
+     * Write the recorded events in Chrome trace event format to a file.
+     * @param[in] path File path.
+     */
+    static void writeChromeTrace(const std::filesystem::path& path);
+};
+
+/**
+ * Helper class for recording a slice using RAII.
+ * The FALCOR_TRACE_SCOPE macro should be used instead of directly creating ScopedTraceEvent objects.
+ */
+class FALCOR_API ScopedTraceEvent
+{
+public:
+    ScopedTraceEvent(uint32_t nameID, uint32_t detailID = TraceRecorder::kInvalidStringID)
+        : mNameID(nameID), mDetailID(detailID), mActive(TraceRecorder::isEnabled())
+    {
+        if (mActive)
+            mStartTime = TraceRecorder::getTimestamp();
+    }
+
+    ~ScopedTraceEvent()
+    {
+        if (mActive)
+            TraceRecorder::recordSlice(mNameID, mStartTime, TraceRecorder::getTimestamp(), mDetailID);
+    }
+
+    ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+    ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+
+private:
+    uint32_t mNameID;
+    uint32_t mDetailID;
+    bool mActive;
+    uint64_t mStartTime = 0;
+};
+} // namespace Falcor
+
+#if FALCOR_ENABLE_PROFILER
+/// Record the duration of the enclosing scope. The name must be a constant string, it is interned on first use.
+#define FALCOR_TRACE_SCOPE(_name)                                                                                          \
+    static const uint32_t FALCOR_CONCAT_STRINGS(_traceName, __LINE__) = Falcor::TraceRecorder::internString(_name); \
+    Falcor::ScopedTraceEvent FALCOR_CONCAT_STRINGS(_traceEvent, __LINE__)(FALCOR_CONCAT_STRINGS(_traceName, __LINE__))
+#else
+#define FALCOR_TRACE_SCOPE(_name)
+#endif
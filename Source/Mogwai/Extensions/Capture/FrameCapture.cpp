@@ -28,6 +28,7 @@
 #include "Falcor.h"
 #include "FrameCapture.h"
 #include "Utils/Scripting/ScriptWriter.h"
+#include "Utils/StringUtils.h"
 #include <filesystem>
 
 namespace Mogwai
@@ -41,6 +42,10 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kStats = "stats";
+        const std::string kFrameStats = "frameStats";
+        const std::string kClearStats = "clearStats";
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -63,6 +68,7 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
+        mpImageWriter = std::make_unique<AsyncImageWriter>();
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -77,6 +83,15 @@ namespace Mogwai
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
             if (w.button("Capture Current Frame")) capture();
+
+            auto stats = mpImageWriter->getStats();
+            std::string msg = fmt::format("Images written: {}", stats.imageCount);
+            if (stats.failedCount > 0) msg += fmt::format(" ({} failed)", stats.failedCount);
+            msg += fmt::format("\nBytes written: {}", formatByteSize(stats.bytesWritten));
+            msg += fmt::format("\nQueue depth: {} (peak {}), {} pending", stats.queueDepth, stats.peakQueueDepth, formatByteSize(stats.pendingBytes));
+            msg += fmt::format("\nStall time: {:.3f} s", stats.stallTime);
+            w.text(msg);
+            if (w.button("Clear Stats")) clearStats();
         }
     }
 
@@ -102,6 +117,44 @@ namespace Mogwai
             pybind11::print(s.empty() ? "Empty" : s);
         };
         frameCapture.def(kPrintFrames.c_str(), printAllGraphs);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
+        frameCapture.def(kClearStats.c_str(), &FrameCapture::clearStats);
+
+        // Statistics
+        auto getStats = [](FrameCapture* pFC)
+        {
+            auto stats = pFC->mpImageWriter->getStats();
+            pybind11::dict d;
+            d["imageCount"] = stats.imageCount;
+            d["failedCount"] = stats.failedCount;
+            d["imageBytes"] = stats.imageBytes;
+            d["bytesWritten"] = stats.bytesWritten;
+            d["queueDepth"] = stats.queueDepth;
+            d["peakQueueDepth"] = stats.peakQueueDepth;
+            d["pendingBytes"] = stats.pendingBytes;
+            d["stallTime"] = stats.stallTime;
+            return d;
+        };
+        frameCapture.def_property_readonly(kStats.c_str(), getStats);
+
+        auto getFrameStats = [](FrameCapture* pFC)
+        {
+            std::lock_guard<std::mutex> lock(pFC->mFrameStatsMutex);
+            pybind11::list l;
+            for (const auto& stats : pFC->mFrameStats)
+            {
+                pybind11::dict d;
+                d["frame"] = stats.frameID;
+                d["imageCount"] = stats.imageCount;
+                d["imageBytes"] = stats.imageBytes;
+                d["bytesWritten"] = stats.bytesWritten;
+                d["queueDepth"] = stats.queueDepth;
+                d["stallTime"] = stats.stallTime;
+                l.append(d);
+            }
+            return l;
+        };
+        frameCapture.def_property_readonly(kFrameStats.c_str(), getFrameStats);
 
         // Settings
         auto getUI = [](FrameCapture* pFC) { return pFC->mShowUI; };
@@ -111,6 +164,17 @@ namespace Mogwai
         frameCapture.def_property("captureAllOutputs",
             [](FrameCapture* pFC){ return pFC->mCaptureAllOutputs;},
             [](FrameCapture* pFC, bool all){ pFC->mCaptureAllOutputs = all; });
+
+        // Image writer settings
+        frameCapture.def_property("maxPendingImages",
+            [](FrameCapture* pFC) { return pFC->mpImageWriter->getOptions().maxPendingImages; },
+            [](FrameCapture* pFC, uint32_t count) { auto options = pFC->mpImageWriter->getOptions(); options.maxPendingImages = count; pFC->setWriterOptions(options); });
+        frameCapture.def_property("maxPendingBytes",
+            [](FrameCapture* pFC) { return pFC->mpImageWriter->getOptions().maxPendingBytes; },
+            [](FrameCapture* pFC, uint64_t size) { auto options = pFC->mpImageWriter->getOptions(); options.maxPendingBytes = size; pFC->setWriterOptions(options); });
+        frameCapture.def_property("writerThreadCount",
+            [](FrameCapture* pFC) { return pFC->mpImageWriter->getOptions().threadCount; },
+            [](FrameCapture* pFC, size_t count) { auto options = pFC->mpImageWriter->getOptions(); options.threadCount = count; pFC->setWriterOptions(options); });
     }
 
     std::string FrameCapture::getScriptVar() const
@@ -144,9 +208,27 @@ namespace Mogwai
             pGraph->execute(pRenderContext);
         }
 
+        // Account the captured images to this frame. The written bytes are added by the image writer as files are written.
+        const auto prevWriterStats = mpImageWriter->getStats();
+        size_t frameStatsIndex = 0;
+        {
+            std::lock_guard<std::mutex> lock(mFrameStatsMutex);
+            frameStatsIndex = mFrameStats.size();
+            mFrameStats.push_back({ frameID });
+        }
+
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
-            captureOutput(pRenderContext, pGraph, i);
+            captureOutput(pRenderContext, pGraph, i, frameStatsIndex);
+        }
+
+        {
+            const auto writerStats = mpImageWriter->getStats();
+            std::lock_guard<std::mutex> lock(mFrameStatsMutex);
+            auto& frameStats = mFrameStats[frameStatsIndex];
+            frameStats.imageBytes = writerStats.imageBytes - prevWriterStats.imageBytes;
+            frameStats.queueDepth = writerStats.queueDepth;
+            frameStats.stallTime = writerStats.stallTime - prevWriterStats.stallTime;
         }
 
         if (mCaptureAllOutputs && !unmarkedOutputs.empty())
@@ -156,7 +238,7 @@ namespace Mogwai
         }
     }
 
-    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex)
+    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, const size_t frameStatsIndex)
     {
         const std::string outputName = pGraph->getOutputName(outputIndex);
         const std::string basename = getOutputNamePrefix(outputName) + std::to_string(mpRenderer->getGlobalClock().getFrame());
@@ -248,7 +330,16 @@ namespace Mogwai
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            auto onWritten = [this, frameStatsIndex](const std::filesystem::path& path, uint64_t fileSize)
+            {
+                std::lock_guard<std::mutex> lock(mFrameStatsMutex);
+                mFrameStats[frameStatsIndex].bytesWritten += fileSize;
+            };
+            {
+                std::lock_guard<std::mutex> lock(mFrameStatsMutex);
+                mFrameStats[frameStatsIndex].imageCount++;
+            }
+            pTex->captureToFile(0, 0, filename, fileformat, flags, *mpImageWriter, onWritten);
         }
     }
 
@@ -272,6 +363,27 @@ namespace Mogwai
         return s;
     }
 
+    void FrameCapture::flush()
+    {
+        mpImageWriter->flush();
+    }
+
+    void FrameCapture::setWriterOptions(const AsyncImageWriter::Options& options)
+    {
+        // Pending images are written by the previous writer before it is destroyed.
+        mpImageWriter = nullptr;
+        mpImageWriter = std::make_unique<AsyncImageWriter>(options);
+    }
+
+    void FrameCapture::clearStats()
+    {
+        // Wait for pending writes as they update the frame statistics.
+        mpImageWriter->flush();
+        mpImageWriter->resetStats();
+        std::lock_guard<std::mutex> lock(mFrameStatsMutex);
+        mFrameStats.clear();
+    }
+
     void FrameCapture::capture()
     {
         auto pGraph = mpRenderer->getActiveGraph();
@@ -28,7 +28,9 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include "Utils/Image/AsyncImageWriter.h"
 #include "Utils/Image/ImageProcessing.h"
+#include <mutex>
 
 namespace Mogwai
 {
@@ -43,16 +45,38 @@ namespace Mogwai
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
         void capture();
 
+        /** Block until all captured images have been written.
+        */
+        void flush();
+
     private:
         FrameCapture(Renderer* pRenderer);
 
+        /** Capture statistics for a single frame.
+        */
+        struct FrameStats
+        {
+            uint64_t frameID = 0;
+            uint32_t imageCount = 0;        ///< Number of captured images.
+            uint64_t imageBytes = 0;        ///< Size of the read back image data in bytes.
+            uint64_t bytesWritten = 0;      ///< Size of the written files in bytes. This is updated as the images are written.
+            uint32_t queueDepth = 0;        ///< Number of images waiting to be written at the end of the frame.
+            double stallTime = 0.0;         ///< Time spent waiting for the image writer in seconds.
+        };
+
         using uint64_vec = std::vector<uint64_t>;
         void addFrames(const RenderGraph* pGraph, const uint64_vec& frames);
         void addFrames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
-        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
+        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, const size_t frameStatsIndex);
+        void setWriterOptions(const AsyncImageWriter::Options& options);
+        void clearStats();
 
         bool mCaptureAllOutputs = false;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+
+        std::mutex mFrameStatsMutex;
+        std::vector<FrameStats> mFrameStats;                ///< Per-frame statistics. Accessed from the image writer threads.
+        std::unique_ptr<AsyncImageWriter> mpImageWriter;    ///< Image writer. Declared last as pending writes access the frame statistics.
     };
 }
@@ -33,7 +33,9 @@
 #include "RenderGraph/RenderGraphImportExport.h"
 #include "RenderGraph/RenderPassStandardFlags.h"
 #include "Utils/Scripting/Scripting.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/Timing/TraceRecorder.h"
 #include "Utils/Settings.h"
 
 #include <args.hxx>
@@ -598,6 +600,31 @@ namespace Mogwai
         return mpScene;
     }
 
+    void Renderer::warmUpPrograms()
+    {
+        // Compile all graphs so that the render passes create their programs for the current scene.
+        for (auto& g : mGraphs)
+        {
+            std::string log;
+            if (!g.pGraph->compile(getRenderContext(), log)) logWarning("Failed to compile render graph '{}':\n{}", g.pGraph->getName(), log);
+        }
+
+        // Compile all programs concurrently instead of on first use in the first frame.
+        CpuTimer timer;
+        timer.update();
+        auto futures = getDevice()->getProgramManager()->warmUpLoadedPrograms();
+        size_t failedCount = 0;
+        for (const auto& future : futures)
+        {
+            if (!future.get()) failedCount++;
+        }
+        timer.update();
+
+        const auto& stats = getDevice()->getProgramManager()->getCompilationStats();
+        logInfo("Warmed up {} programs in {:.2f} s ({} failed, {:.2f} s saved compared to serial compilation).",
+            futures.size(), timer.delta(), failedCount, stats.getAsyncTimeSaved());
+    }
+
     void Renderer::applyEditorChanges()
     {
         if (!mEditorProcess) return;
@@ -842,6 +869,7 @@ int main(int argc, char** argv)
     args::Flag generateShaderDebugInfoFlag(parser, "", "Generate shader debug info.", {"debug-shaders"});
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag preciseProgramFlag(parser, "", "Force all slang programs to run in precise mode", { "precise" });
+    args::ValueFlag<std::string> traceFlag(parser, "path", "Record a CPU trace of all threads and write it to a Chrome trace file on exit.", {"trace"});
 
     args::CompletionFlag completionFlag(parser, {"complete"});
 
@@ -942,10 +970,17 @@ int main(int argc, char** argv)
     if (useSceneCacheFlag) options.useSceneCache = true;
     if (rebuildSceneCacheFlag) options.rebuildSceneCache = true;
 
+    if (traceFlag) TraceRecorder::setEnabled(true);
+
     try
     {
-        Mogwai::Renderer renderer(config, options);
-        return renderer.run();
+        int result;
+        {
+            Mogwai::Renderer renderer(config, options);
+            result = renderer.run();
+        }
+        if (traceFlag) TraceRecorder::writeChromeTrace(args::get(traceFlag));
+        return result;
     }
     catch (const std::exception& e)
     {
@@ -168,6 +168,7 @@ namespace Mogwai
         void unloadScene();
         void setScene(const ref<Scene>& pScene);
         ref<Scene> getScene() const;
+        void warmUpPrograms();
         void executeActiveGraph(RenderContext* pRenderContext);
         void beginFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
         void endFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
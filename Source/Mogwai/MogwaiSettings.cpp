@@ -229,7 +229,11 @@ namespace Mogwai
                 << "Program version time (total): " << s.programVersionTotalTime << " s" << std::endl
                 << "Program kernels time (total): " << s.programKernelsTotalTime << " s" << std::endl
                 << "Program version time (max): " << s.programVersionMaxTime << " s" << std::endl
-                << "Program kernels time (max): " << s.programKernelsMaxTime << " s" << std::endl;
+                << "Program kernels time (max): " << s.programKernelsMaxTime << " s" << std::endl
+                << "Kernel cache hits: " << s.kernelCacheHitCount << std::endl
+                << "Kernel cache misses: " << s.kernelCacheMissCount << std::endl
+                << "Background program version count: " << s.asyncProgramVersionCount << std::endl
+                << "Background compilation time saved: " << s.getAsyncTimeSaved() << " s" << std::endl;
             g.text(oss.str());
 
             if (g.button("Reset"))
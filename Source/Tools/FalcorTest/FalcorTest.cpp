@@ -43,7 +43,9 @@ int main(int argc, char** argv)
     args::ArgumentParser parser("Falcor unit tests.");
     parser.helpParams.programName = "FalcorTest";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
-    args::ValueFlag<uint32_t> parallelFlag(parser, "N", "EXPERIMENTAL: Number of worker threads (default: 1).", {'p', "parallel"});
+    args::ValueFlag<uint32_t> parallelFlag(
+        parser, "N", "EXPERIMENTAL: Number of worker threads (default: 1). Benchmarks run serially after the other tests.", {'p', "parallel"}
+    );
     args::ValueFlag<std::string> deviceTypeFlag(parser, "d3d12|vulkan", "Graphics device type.", {'d', "device-type"});
     args::Flag listGPUsFlag(parser, "", "List available GPUs", {"list-gpus"});
     args::ValueFlag<uint32_t> gpuFlag(parser, "index", "Select specific GPU to use", {"gpu"});
@@ -55,6 +57,15 @@ int main(int argc, char** argv)
     args::ValueFlag<std::string> tagFilterFlag(parser, "tags", "Filter test cases by tags.", {'t', "tags"});
     args::ValueFlag<std::string> xmlReportFlag(parser, "path", "XML report output file.", {'x', "xml-report"});
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
+    args::ValueFlag<std::string> benchmarkReportFlag(parser, "path", "Benchmark JSON report output file.", {"benchmark-report"});
+    args::ValueFlag<std::string> benchmarkBaselineFlag(
+        parser, "path", "Benchmark JSON report to compare against. Regressions fail the benchmark.", {"benchmark-baseline"}
+    );
+    args::ValueFlag<double> benchmarkThresholdFlag(
+        parser, "fraction", "Allowed benchmark slowdown relative to the baseline (default: 0.1).", {"benchmark-threshold"}
+    );
+    args::ValueFlag<uint32_t> benchmarkRepetitionsFlag(parser, "N", "Number of timed benchmark repetitions (default: 5).", {"benchmark-repetitions"});
+    args::ValueFlag<uint32_t> benchmarkWarmupFlag(parser, "N", "Number of benchmark warmup iterations (default: 1).", {"benchmark-warmup"});
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag enableAftermathFlag(parser, "", "Enable Aftermath GPU crash dump.", {"enable-aftermath"});
 
@@ -128,6 +139,16 @@ int main(int argc, char** argv)
         options.parallel = args::get(parallelFlag);
     if (repeatFlag)
         options.repeat = args::get(repeatFlag);
+    if (benchmarkReportFlag)
+        options.benchmarkReportPath = args::get(benchmarkReportFlag);
+    if (benchmarkBaselineFlag)
+        options.benchmarkBaselinePath = args::get(benchmarkBaselineFlag);
+    if (benchmarkThresholdFlag)
+        options.benchmarkThreshold = args::get(benchmarkThresholdFlag);
+    if (benchmarkRepetitionsFlag)
+        options.benchmarkRepetitions = args::get(benchmarkRepetitionsFlag);
+    if (benchmarkWarmupFlag)
+        options.benchmarkWarmup = args::get(benchmarkWarmupFlag);
 
     if (listTestSuites || listTestCases || listTags)
     {
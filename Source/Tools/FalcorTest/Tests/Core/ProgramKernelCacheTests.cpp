@@ -0,0 +1,297 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramKernelCache.h"
+#include "Core/Program/ProgramManager.h"
+#include "Core/Program/ComputeProgram.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const std::filesystem::path kCacheDirectory = "test_kernel_cache";
+
+ProgramKernelCache::Key makeKey(uint32_t i)
+{
+    return SHA1::compute(&i, sizeof(i));
+}
+
+std::vector<uint8_t> makeData(size_t size, uint8_t seed)
+{
+    std::vector<uint8_t> data(size);
+    std::iota(data.begin(), data.end(), seed);
+    return data;
+}
+
+const char kShader[] =
+    "RWStructuredBuffer<uint> result;\n"
+    "[numthreads(32, 1, 1)]\n"
+    "void main(uint3 threadID : SV_DispatchThreadID)\n"
+    "{\n"
+    "    result[threadID.x] = threadID.x * VALUE;\n"
+    "}\n";
+
+/// Create the compute kernel of a new program and return its code, loaded through the kernel cache.
+std::vector<uint8_t> getKernelCode(const ref<Device>& pDevice, const Program::Desc& desc, const DefineList& defines)
+{
+    ref<ComputeProgram> pProgram = ComputeProgram::create(pDevice, desc, defines);
+    auto pKernels = pProgram->getActiveVersion()->getKernels(pDevice.get(), nullptr);
+    auto blob = pKernels->getKernel(ShaderType::Compute)->getBlobData();
+    const uint8_t* pData = static_cast<const uint8_t*>(blob.data);
+    return std::vector<uint8_t>(pData, pData + blob.size);
+}
+} // namespace
+
+CPU_TEST(ProgramKernelCache_PutGet)
+{
+    std::filesystem::remove_all(kCacheDirectory);
+    {
+        auto pCache = make_ref<ProgramKernelCache>(kCacheDirectory, 0);
+
+        EXPECT(!pCache->get(makeKey(0)));
+
+        auto data = makeData(1000, 1);
+        pCache->put(makeKey(0), data.data(), data.size());
+        auto cached = pCache->get(makeKey(0));
+        EXPECT(cached && *cached == data);
+        EXPECT(!pCache->get(makeKey(1)));
+
+        // Overwrite existing entry.
+        auto data2 = makeData(500, 2);
+        pCache->put(makeKey(0), data2.data(), data2.size());
+        cached = pCache->get(makeKey(0));
+        EXPECT(cached && *cached == data2);
+
+        // Entries are visible to other cache instances using the same directory.
+        auto pCache2 = make_ref<ProgramKernelCache>(kCacheDirectory, 0);
+        cached = pCache2->get(makeKey(0));
+        EXPECT(cached && *cached == data2);
+
+        auto stats = pCache->getStats();
+        EXPECT_EQ(stats.hitCount, 2);
+        EXPECT_EQ(stats.missCount, 2);
+        EXPECT_EQ(stats.writeCount, 2);
+
+        pCache->resetStats();
+        EXPECT_EQ(pCache->getStats().hitCount, 0);
+
+        pCache->clear();
+        EXPECT(!pCache->get(makeKey(0)));
+        EXPECT_EQ(pCache->getSize(), 0);
+    }
+    std::filesystem::remove_all(kCacheDirectory);
+}
+
+CPU_TEST(ProgramKernelCache_Corrupted)
+{
+    std::filesystem::remove_all(kCacheDirectory);
+    {
+        auto pCache = make_ref<ProgramKernelCache>(kCacheDirectory, 0);
+        auto data = makeData(1000, 3);
+        pCache->put(makeKey(0), data.data(), data.size());
+
+        // Truncate the entry.
+        auto path = kCacheDirectory / (SHA1::toString(makeKey(0)) + ".bin");
+        EXPECT(std::filesystem::exists(path));
+        std::filesystem::resize_file(path, 500);
+        EXPECT(!pCache->get(makeKey(0)));
+
+        // Corrupt the payload.
+        pCache->put(makeKey(0), data.data(), data.size());
+        {
+            std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+            stream.seekp(-1, std::ios::end);
+            stream.put(0x55);
+        }
+        EXPECT(!pCache->get(makeKey(0)));
+        EXPECT_EQ(pCache->getStats().hitCount, 0);
+    }
+    std::filesystem::remove_all(kCacheDirectory);
+}
+
+CPU_TEST(ProgramKernelCache_Eviction)
+{
+    std::filesystem::remove_all(kCacheDirectory);
+    {
+        // Each entry is slightly larger than 1000 bytes due to the header, so at most 3 entries fit.
+        auto pCache = make_ref<ProgramKernelCache>(kCacheDirectory, 4000);
+        auto data = makeData(1000, 4);
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            pCache->put(makeKey(i), data.data(), data.size());
+            // Make sure the modification times are distinct.
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        EXPECT_EQ(pCache->getStats().evictionCount, 0);
+
+        // Access the first entry to make it the most recently used.
+        EXPECT(pCache->get(makeKey(0)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        // Adding a new entry evicts the least recently used entry.
+        pCache->put(makeKey(3), data.data(), data.size());
+        EXPECT_EQ(pCache->getStats().evictionCount, 1);
+        EXPECT(pCache->get(makeKey(0)));
+        EXPECT(!pCache->get(makeKey(1)));
+        EXPECT(pCache->get(makeKey(2)));
+        EXPECT(pCache->get(makeKey(3)));
+        EXPECT_LE(pCache->getSize(), 4000);
+    }
+    std::filesystem::remove_all(kCacheDirectory);
+}
+
+CPU_TEST(ProgramKernelCache_Size)
+{
+    std::filesystem::remove_all(kCacheDirectory);
+    {
+        auto directorySize = []()
+        {
+            uint64_t size = 0;
+            for (const auto& entry : std::filesystem::directory_iterator(kCacheDirectory))
+                if (entry.path().extension() == ".bin")
+                    size += entry.file_size();
+            return size;
+        };
+
+        auto pCache = make_ref<ProgramKernelCache>(kCacheDirectory, 0);
+        EXPECT_EQ(pCache->getSize(), 0);
+
+        // The tracked size follows new and replaced entries.
+        auto data = makeData(1000, 5);
+        pCache->put(makeKey(0), data.data(), data.size());
+        pCache->put(makeKey(1), data.data(), data.size());
+        EXPECT_EQ(pCache->getSize(), directorySize());
+        auto data2 = makeData(300, 6);
+        pCache->put(makeKey(0), data2.data(), data2.size());
+        EXPECT_EQ(pCache->getSize(), directorySize());
+
+        // Existing entries are accounted for when the cache is opened.
+        auto pCache2 = make_ref<ProgramKernelCache>(kCacheDirectory, 0);
+        EXPECT_EQ(pCache2->getSize(), directorySize());
+
+        // Entries written by another instance are picked up on eviction.
+        auto pCache3 = make_ref<ProgramKernelCache>(kCacheDirectory, 2000);
+        pCache2->put(makeKey(2), data.data(), data.size());
+        pCache3->put(makeKey(3), data.data(), data.size());
+        EXPECT_GE(pCache3->getStats().evictionCount, 1);
+        EXPECT_EQ(pCache3->getSize(), directorySize());
+        EXPECT_LE(pCache3->getSize(), 2000);
+    }
+    std::filesystem::remove_all(kCacheDirectory);
+}
+
+CPU_TEST(ProgramKernelCache_Concurrent)
+{
+    std::filesystem::remove_all(kCacheDirectory);
+    {
+        auto pCache = make_ref<ProgramKernelCache>(kCacheDirectory, 0);
+
+        // Multiple threads reading and writing the same entries must never observe partially written entries.
+        std::vector<std::thread> threads;
+        std::atomic<size_t> invalidCount = 0;
+        for (uint32_t t = 0; t < 4; ++t)
+        {
+            threads.emplace_back(
+                [&, t]()
+                {
+                    for (uint32_t i = 0; i < 50; ++i)
+                    {
+                        auto key = makeKey(i % 5);
+                        auto data = makeData(2000 + (i % 5), (uint8_t)(i % 5));
+                        if ((i + t) % 2 == 0)
+                            pCache->put(key, data.data(), data.size());
+                        else if (auto cached = pCache->get(key); cached && *cached != data)
+                            invalidCount++;
+                    }
+                }
+            );
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        EXPECT_EQ(invalidCount, 0);
+    }
+    std::filesystem::remove_all(kCacheDirectory);
+}
+
+GPU_TEST(ProgramKernelCache_ProgramKernels)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ProgramKernelCache* pCache = pDevice->getProgramManager()->getKernelCache();
+    if (!pCache)
+        ctx.skip("Kernel cache is disabled");
+
+    Program::Desc desc;
+    desc.addShaderString(kShader, "ProgramKernelCacheTest").csEntry("main");
+
+    // Add a define that is unique to this run, so the first compilation is not in the cache yet.
+    auto runId = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    DefineList defines{{"RUN_ID", runId}, {"VALUE", "1"}};
+
+    // The first program generates the kernel code with Slang and stores it.
+    auto stats = pCache->getStats();
+    auto code = getKernelCode(pDevice, desc, defines);
+    EXPECT(!code.empty());
+    EXPECT_EQ(pCache->getStats().missCount, stats.missCount + 1);
+    EXPECT_EQ(pCache->getStats().writeCount, stats.writeCount + 1);
+
+    // A new program with the same source loads the code from the cache without generating it again.
+    stats = pCache->getStats();
+    EXPECT(getKernelCode(pDevice, desc, defines) == code);
+    EXPECT_EQ(pCache->getStats().hitCount, stats.hitCount + 1);
+    EXPECT_EQ(pCache->getStats().missCount, stats.missCount);
+    EXPECT_EQ(pCache->getStats().writeCount, stats.writeCount);
+
+    // A program version compiled in the background uses the same key.
+    {
+        ref<ComputeProgram> pProgram = ComputeProgram::create(pDevice, desc, defines);
+        auto futures = pDevice->getProgramManager()->compileProgramVersionsAsync({{pProgram, defines, Program::TypeConformanceList()}});
+        ASSERT_EQ(futures.size(), 1);
+        auto pVersion = futures[0].get();
+        ASSERT(pVersion != nullptr);
+        stats = pCache->getStats();
+        pVersion->getKernels(pDevice.get(), nullptr)->getKernel(ShaderType::Compute)->getBlobData();
+        EXPECT_EQ(pCache->getStats().hitCount, stats.hitCount + 1);
+        EXPECT_EQ(pCache->getStats().writeCount, stats.writeCount);
+    }
+
+    // Different defines result in a different key.
+    stats = pCache->getStats();
+    EXPECT(getKernelCode(pDevice, desc, DefineList{{"RUN_ID", runId}, {"VALUE", "2"}}) != code);
+    EXPECT_EQ(pCache->getStats().missCount, stats.missCount + 1);
+}
+
+} // namespace Falcor
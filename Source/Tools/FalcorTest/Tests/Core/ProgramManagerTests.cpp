@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramManager.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShader[] =
+    "RWStructuredBuffer<uint> result;\n"
+    "[numthreads(32, 1, 1)]\n"
+    "void main(uint3 threadID : SV_DispatchThreadID)\n"
+    "{\n"
+    "    result[threadID.x] = threadID.x * VALUE;\n"
+    "}\n";
+
+const char kShaderTypeConformances[] =
+    "interface IScale { uint scale(uint x); };\n"
+    "struct Double : IScale { uint scale(uint x) { return 2 * x; } };\n"
+    "struct Triple : IScale { uint scale(uint x) { return 3 * x; } };\n"
+    "RWStructuredBuffer<uint> result;\n"
+    "[numthreads(32, 1, 1)]\n"
+    "void main(uint3 threadID : SV_DispatchThreadID)\n"
+    "{\n"
+    "    IScale s = createDynamicObject<IScale, uint>(0, 0);\n"
+    "    result[threadID.x] = s.scale(threadID.x);\n"
+    "}\n";
+
+const uint32_t kSize = 32;
+const uint32_t kPermutationCount = 4;
+} // namespace
+
+GPU_TEST(ProgramManager_CompileAsync)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ProgramManager* pProgramManager = pDevice->getProgramManager();
+
+    Program::Desc desc;
+    desc.addShaderString(kShader, "ProgramManagerAsyncTest").csEntry("main");
+    ctx.createProgram(desc, DefineList{{"VALUE", "1"}}, false);
+    ref<Program> pProgram(ctx.getProgram());
+
+    // Compile all permutations in the background.
+    std::vector<ProgramManager::ProgramPermutation> permutations;
+    for (uint32_t i = 0; i < kPermutationCount; ++i)
+        permutations.push_back({pProgram, DefineList{{"VALUE", std::to_string(i + 1)}}, Program::TypeConformanceList()});
+
+    auto futures = pProgramManager->compileProgramVersionsAsync(permutations);
+    ASSERT_EQ(futures.size(), kPermutationCount);
+    for (const auto& future : futures)
+        EXPECT(future.get() != nullptr);
+
+    // Compiling the same permutations again returns the existing program versions.
+    auto futures2 = pProgramManager->compileProgramVersionsAsync(permutations);
+    ASSERT_EQ(futures2.size(), kPermutationCount);
+    for (uint32_t i = 0; i < kPermutationCount; ++i)
+        EXPECT(futures2[i].get() == futures[i].get());
+
+    // Switching to the permutations uses the compiled program versions and kernels without compiling them again.
+    size_t programVersionCount = pProgramManager->getCompilationStats().programVersionCount;
+    size_t programKernelsCount = pProgramManager->getCompilationStats().programKernelsCount;
+    for (uint32_t i = 0; i < kPermutationCount; ++i)
+    {
+        pProgram->addDefine("VALUE", std::to_string(i + 1));
+        EXPECT(pProgram->getActiveVersion() == futures[i].get());
+
+        ctx.createVars();
+        ctx.allocateStructuredBuffer("result", kSize);
+        ctx.runProgram(kSize, 1, 1);
+
+        std::vector<uint32_t> result = ctx.readBuffer<uint32_t>("result");
+        for (uint32_t j = 0; j < kSize; ++j)
+            EXPECT_EQ(result[j], j * (i + 1)) << "i = " << i << " j = " << j;
+    }
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, programVersionCount);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programKernelsCount, programKernelsCount);
+}
+
+GPU_TEST(ProgramManager_CompileAsyncTypeConformances)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ProgramManager* pProgramManager = pDevice->getProgramManager();
+
+    Program::Desc desc;
+    desc.addShaderString(kShaderTypeConformances, "ProgramManagerAsyncTypeConformancesTest").csEntry("main");
+    ctx.createProgram(desc, DefineList(), false);
+    ref<Program> pProgram(ctx.getProgram());
+
+    // The permutations differ only in the type conformances, which select the implementation with type id 0.
+    const std::vector<std::pair<std::string, uint32_t>> kTypes = {{"Double", 2}, {"Triple", 3}};
+    std::vector<ProgramManager::ProgramPermutation> permutations;
+    for (const auto& [typeName, scale] : kTypes)
+        permutations.push_back({pProgram, DefineList(), Program::TypeConformanceList().add(typeName, "IScale", 0)});
+
+    auto futures = pProgramManager->compileProgramVersionsAsync(permutations);
+
+    // Changing the type conformances of the program while compiling must not affect the permutations.
+    pProgram->setTypeConformances(permutations.back().typeConformances);
+
+    ASSERT_EQ(futures.size(), kTypes.size());
+    for (const auto& future : futures)
+        EXPECT(future.get() != nullptr);
+
+    for (size_t i = 0; i < kTypes.size(); ++i)
+    {
+        pProgram->setTypeConformances(permutations[i].typeConformances);
+        EXPECT(pProgram->getActiveVersion() == futures[i].get());
+
+        ctx.createVars();
+        ctx.allocateStructuredBuffer("result", kSize);
+        ctx.runProgram(kSize, 1, 1);
+
+        std::vector<uint32_t> result = ctx.readBuffer<uint32_t>("result");
+        for (uint32_t j = 0; j < kSize; ++j)
+            EXPECT_EQ(result[j], j * kTypes[i].second) << "type = " << kTypes[i].first << " j = " << j;
+    }
+}
+
+} // namespace Falcor
@@ -0,0 +1,217 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/ResourceAliasingPlanner.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using Request = ResourceAliasingPlanner::Request;
+using Plan = ResourceAliasingPlanner::Plan;
+
+Request makeRequest(uint32_t firstUse, uint32_t lastUse, uint64_t size, uint32_t compatibilityClass = 0, bool aliasable = true)
+{
+    Request request;
+    request.firstUse = firstUse;
+    request.lastUse = lastUse;
+    request.size = size;
+    request.compatibilityClass = compatibilityClass;
+    request.aliasable = aliasable;
+    return request;
+}
+
+bool overlaps(const Request& a, const Request& b)
+{
+    return a.firstUse <= b.lastUse && b.firstUse <= a.lastUse;
+}
+
+/// Check that a plan is valid: requests sharing a resource are compatible, aliasable, fit and have disjoint lifetimes.
+void validatePlan(CPUUnitTestContext& ctx, const std::vector<Request>& requests, const Plan& plan)
+{
+    ASSERT_EQ(plan.resourceIndices.size(), requests.size());
+
+    uint64_t naiveSize = 0;
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        naiveSize += requests[i].size;
+        ASSERT_LT(plan.resourceIndices[i], plan.getResourceCount());
+        EXPECT_GE(plan.resourceSizes[plan.resourceIndices[i]], requests[i].size);
+
+        for (size_t j = i + 1; j < requests.size(); j++)
+        {
+            if (plan.resourceIndices[i] != plan.resourceIndices[j])
+                continue;
+            EXPECT(requests[i].aliasable && requests[j].aliasable);
+            EXPECT_EQ(requests[i].compatibilityClass, requests[j].compatibilityClass);
+            EXPECT(!overlaps(requests[i], requests[j])) << "requests " << i << " and " << j;
+        }
+    }
+
+    uint64_t plannedSize = 0;
+    for (uint64_t size : plan.resourceSizes)
+        plannedSize += size;
+
+    EXPECT_EQ(plan.naiveSize, naiveSize);
+    EXPECT_EQ(plan.plannedSize, plannedSize);
+    EXPECT_LE(plan.peakLiveSize, plan.plannedSize);
+    EXPECT_LE(plan.plannedSize, plan.naiveSize);
+}
+} // namespace
+
+CPU_TEST(ResourceAliasingPlanner_Chain)
+{
+    // Linear chain of passes where each output is consumed by the next pass: 0 -> 1 -> 2 -> 3 -> 4.
+    std::vector<Request> requests = {
+        makeRequest(0, 1, 100),
+        makeRequest(1, 2, 100),
+        makeRequest(2, 3, 100),
+        makeRequest(3, 4, 100),
+    };
+    Plan plan = ResourceAliasingPlanner::plan(requests);
+    validatePlan(ctx, requests, plan);
+
+    // Ping-pong between two resources.
+    EXPECT_EQ(plan.getResourceCount(), 2);
+    EXPECT_EQ(plan.resourceIndices[0], plan.resourceIndices[2]);
+    EXPECT_EQ(plan.resourceIndices[1], plan.resourceIndices[3]);
+    EXPECT_NE(plan.resourceIndices[0], plan.resourceIndices[1]);
+    EXPECT_EQ(plan.naiveSize, 400);
+    EXPECT_EQ(plan.plannedSize, 200);
+    EXPECT_EQ(plan.peakLiveSize, 200);
+}
+
+CPU_TEST(ResourceAliasingPlanner_Overlapping)
+{
+    // All resources are live at time point 2, so nothing can be shared.
+    std::vector<Request> requests = {
+        makeRequest(0, 2, 10),
+        makeRequest(1, 3, 20),
+        makeRequest(2, 2, 30),
+    };
+    Plan plan = ResourceAliasingPlanner::plan(requests);
+    validatePlan(ctx, requests, plan);
+
+    EXPECT_EQ(plan.getResourceCount(), 3);
+    EXPECT_EQ(plan.plannedSize, 60);
+    EXPECT_EQ(plan.peakLiveSize, 60);
+}
+
+CPU_TEST(ResourceAliasingPlanner_Constraints)
+{
+    std::vector<Request> requests = {
+        makeRequest(0, 0, 100, 0),
+        makeRequest(1, 1, 100, 1),        // Different class than request 0.
+        makeRequest(2, 2, 100, 0, false), // Not aliasable.
+        makeRequest(3, 3, 100, 0),        // Can share with request 0.
+    };
+    Plan plan = ResourceAliasingPlanner::plan(requests);
+    validatePlan(ctx, requests, plan);
+
+    EXPECT_EQ(plan.getResourceCount(), 3);
+    EXPECT_EQ(plan.resourceIndices[0], plan.resourceIndices[3]);
+    EXPECT_EQ(plan.peakLiveSize, 100);
+}
+
+CPU_TEST(ResourceAliasingPlanner_BestFit)
+{
+    // Two free resources of different sizes, the request picks the smallest that fits.
+    std::vector<Request> requests = {
+        makeRequest(0, 0, 1000),
+        makeRequest(0, 0, 100),
+        makeRequest(1, 1, 80),
+        makeRequest(1, 1, 900),
+    };
+    Plan plan = ResourceAliasingPlanner::plan(requests);
+    validatePlan(ctx, requests, plan);
+
+    EXPECT_EQ(plan.getResourceCount(), 2);
+    EXPECT_EQ(plan.resourceIndices[0], plan.resourceIndices[3]);
+    EXPECT_EQ(plan.resourceIndices[1], plan.resourceIndices[2]);
+    EXPECT_EQ(plan.plannedSize, 1100);
+}
+
+CPU_TEST(ResourceAliasingPlanner_InvalidLifetime)
+{
+    try
+    {
+        ResourceAliasingPlanner::plan({makeRequest(2, 1, 100)});
+        EXPECT(false);
+    }
+    catch (const ArgumentError&)
+    {
+        EXPECT(true);
+    }
+}
+
+CPU_TEST(ResourceAliasingPlanner_Random)
+{
+    // Random synthetic graphs. The number of resources per class must equal the maximum number of requests of that class
+    // live at the same time, which is optimal for interval graphs.
+    std::mt19937 rng;
+    for (uint32_t graph = 0; graph < 50; graph++)
+    {
+        const uint32_t passCount = 1 + rng() % 40;
+        const uint32_t requestCount = rng() % 100;
+        const uint32_t classCount = 1 + rng() % 4;
+
+        std::vector<Request> requests;
+        for (uint32_t i = 0; i < requestCount; i++)
+        {
+            uint32_t firstUse = rng() % passCount;
+            uint32_t lastUse = firstUse + rng() % std::min(8u, passCount - firstUse);
+            requests.push_back(makeRequest(firstUse, lastUse, 1 + rng() % 1000, rng() % classCount, rng() % 8 != 0));
+        }
+
+        Plan plan = ResourceAliasingPlanner::plan(requests);
+        validatePlan(ctx, requests, plan);
+
+        std::map<uint32_t, uint32_t> dedicatedCount;
+        std::map<uint32_t, std::vector<Request>> aliasablePerClass;
+        for (const auto& request : requests)
+        {
+            if (request.aliasable)
+                aliasablePerClass[request.compatibilityClass].push_back(makeRequest(request.firstUse, request.lastUse, 1));
+            else
+                dedicatedCount[request.compatibilityClass]++;
+        }
+
+        uint32_t expectedCount = 0;
+        for (const auto& [compatibilityClass, count] : dedicatedCount)
+            expectedCount += count;
+        for (const auto& [compatibilityClass, classRequests] : aliasablePerClass)
+            expectedCount += (uint32_t)ResourceAliasingPlanner::computePeakLiveSize(classRequests);
+        EXPECT_EQ(plan.getResourceCount(), expectedCount) << "graph " << graph;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,229 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Creates a mix of randomly placed triangles and triangles snapped to a coarse grid, which produces many equal centroids.
+std::vector<LightCollection::MeshLightTriangle> createTriangles(uint32_t triangleCount)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<LightCollection::MeshLightTriangle> triangles(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        auto& triangle = triangles[i];
+        float3 center = (i % 7 == 0) ? float3(std::floor(u(rng) * 8.f), std::floor(u(rng) * 8.f), 0.f)
+                                     : float3(u(rng), 4.f * u(rng), u(rng)) * 100.f;
+        for (uint32_t j = 0; j < 3; ++j)
+            triangle.vtx[j].pos = center + float3(u(rng), u(rng), u(rng));
+        triangle.normal = normalize(float3(u(rng) - 0.5f, u(rng) - 0.5f, u(rng) - 0.5f));
+        triangle.flux = (i % 13 == 0) ? 0.f : 10.f * u(rng);
+    }
+    return triangles;
+}
+
+/** Checks the invariants of a light BVH that hold for every split heuristic.
+    Node attributes are stored with fp16 extents and quantized cones, so bounds and cones are checked with a small tolerance.
+*/
+class BVHValidator
+{
+public:
+    BVHValidator(
+        CPUUnitTestContext& ctx,
+        const LightBVHBuilder::Options& options,
+        const std::vector<LightCollection::MeshLightTriangle>& triangles,
+        const std::vector<PackedNode>& nodes,
+        const std::vector<uint32_t>& triangleIndices,
+        const std::vector<uint64_t>& triangleBitmasks
+    )
+        : mCtx(ctx), mOptions(options), mTriangles(triangles), mNodes(nodes), mTriangleIndices(triangleIndices), mTriangleBitmasks(triangleBitmasks)
+    {}
+
+    void validate()
+    {
+        auto& ctx = mCtx;
+
+        // Triangles without flux are culled by pre-integration, all others are referenced exactly once.
+        std::vector<uint32_t> referenceCount(mTriangles.size(), 0);
+        for (uint32_t triangleIndex : mTriangleIndices)
+        {
+            ASSERT_LT(triangleIndex, (uint32_t)mTriangles.size());
+            referenceCount[triangleIndex]++;
+        }
+        for (size_t i = 0; i < mTriangles.size(); ++i)
+        {
+            const bool included = !mOptions.usePreintegration || mTriangles[i].flux > 0.f;
+            EXPECT_EQ(referenceCount[i], included ? 1u : 0u) << "triangle " << i;
+        }
+        ASSERT_EQ(mTriangleBitmasks.size(), mTriangles.size());
+
+        ASSERT(!mNodes.empty());
+        mVisited.assign(mNodes.size(), false);
+        uint32_t triangleEnd = validateNode(0, 0, 0ull, 0);
+        EXPECT_EQ(triangleEnd, (uint32_t)mTriangleIndices.size());
+        EXPECT_EQ(std::count(mVisited.begin(), mVisited.end(), true), (std::ptrdiff_t)mNodes.size());
+
+        // Culled triangles keep the invalid bitmask.
+        for (size_t i = 0; i < mTriangles.size(); ++i)
+        {
+            if (referenceCount[i] == 0)
+                EXPECT_EQ(mTriangleBitmasks[i], std::numeric_limits<uint64_t>::max()) << "triangle " << i;
+        }
+    }
+
+private:
+    /** Validates the subtree at a node.
+        Nodes are stored in depth-first order, so the triangles of a subtree are contiguous and leaves appear in triangle order.
+        \param[in] nodeIndex Index of the node.
+        \param[in] depth Depth of the node.
+        \param[in] bitmask Expected bitmask of the triangles in the subtree.
+        \param[in] triangleBegin Expected triangle offset of the first leaf in the subtree.
+        \return One past the last triangle offset of the subtree.
+    */
+    uint32_t validateNode(uint32_t nodeIndex, uint32_t depth, uint64_t bitmask, uint32_t triangleBegin)
+    {
+        auto& ctx = mCtx;
+        ASSERT_LT(nodeIndex, (uint32_t)mNodes.size());
+        ASSERT(!mVisited[nodeIndex]) << "node " << nodeIndex << " is referenced twice";
+        ASSERT_LT(depth, 64u);
+        mVisited[nodeIndex] = true;
+
+        const PackedNode& node = mNodes[nodeIndex];
+        uint32_t triangleEnd = triangleBegin;
+        float childFlux = 0.f;
+        if (node.isLeaf())
+        {
+            LeafNode leaf = node.getLeafNode();
+            EXPECT_EQ(leaf.triangleOffset, triangleBegin) << "node " << nodeIndex;
+            EXPECT_GE(leaf.triangleCount, 1u) << "node " << nodeIndex;
+            EXPECT_LE(leaf.triangleCount, mOptions.maxTriangleCountPerLeaf) << "node " << nodeIndex;
+            triangleEnd = triangleBegin + leaf.triangleCount;
+            ASSERT_LE(triangleEnd, (uint32_t)mTriangleIndices.size());
+            for (uint32_t i = triangleBegin; i < triangleEnd; ++i)
+            {
+                uint32_t triangleIndex = mTriangleIndices[i];
+                EXPECT_EQ(mTriangleBitmasks[triangleIndex], bitmask) << "triangle " << triangleIndex;
+                childFlux += mTriangles[triangleIndex].flux;
+            }
+        }
+        else
+        {
+            // The left child immediately follows its parent.
+            InternalNode internal = node.getInternalNode();
+            EXPECT_GT(internal.rightChildIdx, nodeIndex + 1) << "node " << nodeIndex;
+            uint32_t leftEnd = validateNode(nodeIndex + 1, depth + 1, bitmask, triangleBegin);
+            triangleEnd = validateNode(internal.rightChildIdx, depth + 1, bitmask | (1ull << depth), leftEnd);
+            childFlux = mNodes[nodeIndex + 1].getNodeAttributes().flux + mNodes[internal.rightChildIdx].getNodeAttributes().flux;
+        }
+
+        // The node bounds and normal cone must enclose all triangles in the subtree. The flux is the sum over the subtree.
+        SharedNodeAttributes attribs = node.getNodeAttributes();
+        float3 aabbMin, aabbMax;
+        attribs.getAABB(aabbMin, aabbMax);
+        const float3 tolerance = 1e-3f * (abs(attribs.extent) + float3(1.f));
+        for (uint32_t i = triangleBegin; i < triangleEnd; ++i)
+        {
+            const auto& triangle = mTriangles[mTriangleIndices[i]];
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                EXPECT(all(triangle.vtx[j].pos >= aabbMin - tolerance) && all(triangle.vtx[j].pos <= aabbMax + tolerance))
+                    << "node " << nodeIndex << " does not enclose triangle " << mTriangleIndices[i];
+            }
+            if (attribs.cosConeAngle != kInvalidCosConeAngle)
+            {
+                EXPECT_GE(dot(attribs.coneDirection, triangle.normal), attribs.cosConeAngle - 1e-3f)
+                    << "node " << nodeIndex << " cone does not enclose triangle " << mTriangleIndices[i];
+            }
+        }
+        EXPECT_LE(std::abs(attribs.flux - childFlux), 1e-3f * std::max(attribs.flux, 1.f)) << "node " << nodeIndex;
+
+        return triangleEnd;
+    }
+
+    CPUUnitTestContext& mCtx;
+    const LightBVHBuilder::Options& mOptions;
+    const std::vector<LightCollection::MeshLightTriangle>& mTriangles;
+    const std::vector<PackedNode>& mNodes;
+    const std::vector<uint32_t>& mTriangleIndices;
+    const std::vector<uint64_t>& mTriangleBitmasks;
+    std::vector<bool> mVisited;
+};
+
+void testBuild(CPUUnitTestContext& ctx, LightBVHBuilder::SplitHeuristic splitHeuristic, uint32_t triangleCount)
+{
+    const auto triangles = createTriangles(triangleCount);
+
+    LightBVHBuilder::Options options;
+    options.splitHeuristicSelection = splitHeuristic;
+    LightBVHBuilder builder(options);
+
+    std::vector<PackedNode> serialNodes, parallelNodes;
+    std::vector<uint32_t> serialIndices, parallelIndices;
+    std::vector<uint64_t> serialBitmasks, parallelBitmasks;
+    builder.buildNodes(triangles, serialNodes, serialIndices, serialBitmasks, false);
+    builder.buildNodes(triangles, parallelNodes, parallelIndices, parallelBitmasks, true);
+
+    // The single threaded build must be a valid BVH.
+    BVHValidator(ctx, options, triangles, serialNodes, serialIndices, serialBitmasks).validate();
+
+    // The parallel build must be bit-identical to it.
+    ASSERT_EQ(parallelNodes.size(), serialNodes.size());
+    EXPECT(std::memcmp(parallelNodes.data(), serialNodes.data(), serialNodes.size() * sizeof(PackedNode)) == 0);
+    EXPECT(parallelIndices == serialIndices);
+    EXPECT(parallelBitmasks == serialBitmasks);
+}
+} // namespace
+
+CPU_TEST(LightBVHBuilder_Equal)
+{
+    testBuild(ctx, LightBVHBuilder::SplitHeuristic::Equal, 200000);
+}
+
+CPU_TEST(LightBVHBuilder_BinnedSAH)
+{
+    testBuild(ctx, LightBVHBuilder::SplitHeuristic::BinnedSAH, 200000);
+}
+
+CPU_TEST(LightBVHBuilder_BinnedSAOH)
+{
+    testBuild(ctx, LightBVHBuilder::SplitHeuristic::BinnedSAOH, 200000);
+}
+} // namespace Falcor
@@ -30,7 +30,9 @@
 
 #include <hypothesis/hypothesis.h>
 
+#include <cmath>
 #include <iostream>
+#include <random>
 
 namespace Falcor
 {
@@ -66,6 +68,10 @@ void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> spec
     EXPECT_EQ(aliasTable.getCount(), weights.size());
     EXPECT_EQ(aliasTable.getWeightSum(), weightSum);
 
+    // The CPU data is released after upload by default.
+    EXPECT(!aliasTable.hasCpuData());
+    EXPECT(aliasTable.getEntries().empty());
+
     // Test sampling the alias table.
     {
         const uint32_t samplesPerWeight = 10000;
@@ -137,8 +143,139 @@ void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> spec
         }
     }
 }
+
+std::vector<float> generateWeights(uint32_t N, bool lognormal, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> uniform;
+    std::lognormal_distribution<float> logNormal(0.f, 2.f);
+
+    std::vector<float> weights(N);
+    for (auto& weight : weights)
+        weight = lognormal ? logNormal(rng) : uniform(rng);
+
+    // Add a few zero weights.
+    for (uint32_t i = 0; i < N / 100; ++i)
+        weights[(size_t)(uniform(rng) * N)] = 0.f;
+
+    return weights;
+}
+
+/// Verify that the table entries reproduce the distribution exactly (up to the float precision of the thresholds).
+void testAliasTableEntries(CPUUnitTestContext& ctx, const std::vector<float>& weights)
+{
+    AliasTable aliasTable(weights);
+    const uint32_t N = (uint32_t)weights.size();
+    ASSERT_EQ(aliasTable.getCount(), N);
+
+    double weightSum = 0.0;
+    for (float weight : weights)
+        weightSum += weight;
+    EXPECT_LE(std::abs(aliasTable.getWeightSum() - weightSum), 1e-9 * weightSum);
+
+    std::vector<double> probabilities(N, 0.0);
+    const auto& entries = aliasTable.getEntries();
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        EXPECT_GE(entries[i].threshold, 0.f);
+        EXPECT_LE(entries[i].threshold, 1.f);
+        ASSERT_LT(entries[i].alias, N);
+        probabilities[i] += entries[i].threshold / (double)N;
+        probabilities[entries[i].alias] += (1.0 - entries[i].threshold) / (double)N;
+    }
+
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        double expected = weights[i] / weightSum;
+        EXPECT_LE(std::abs(probabilities[i] - expected), 1e-6 * expected + 1e-7 / N) << "i = " << i;
+        EXPECT_EQ(aliasTable.getWeight(i), weights[i]);
+    }
+}
 } // namespace
 
+CPU_TEST(AliasTable_Entries)
+{
+    std::mt19937 rng;
+    testAliasTableEntries(ctx, {1.f});
+    testAliasTableEntries(ctx, {1.f, 2.f});
+    testAliasTableEntries(ctx, {0.f, 0.f, 1.f});
+    testAliasTableEntries(ctx, std::vector<float>(1000, 1.f));
+    testAliasTableEntries(ctx, generateWeights(1000, false, rng));
+    testAliasTableEntries(ctx, generateWeights(1000, true, rng));
+    // Large enough to be built in multiple chunks.
+    testAliasTableEntries(ctx, generateWeights(300000, false, rng));
+    testAliasTableEntries(ctx, generateWeights(300000, true, rng));
+}
+
+CPU_TEST(AliasTable_ZeroWeights)
+{
+    // All-zero weights fall back to uniform sampling.
+    AliasTable aliasTable(std::vector<float>(4, 0.f));
+    for (uint32_t i = 0; i < 4; ++i)
+        EXPECT_EQ(aliasTable.sample(i, 0.5f), i);
+}
+
+CPU_TEST(AliasTable_Sample)
+{
+    const uint32_t N = 100;
+    const uint32_t samplesPerWeight = 10000;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    std::vector<float> weights = generateWeights(N, false, rng);
+    AliasTable aliasTable(weights);
+
+    std::vector<uint32_t> histogram(N, 0);
+    for (uint32_t i = 0; i < N * samplesPerWeight; ++i)
+    {
+        uint32_t item = aliasTable.sample(float2(uniform(rng), uniform(rng)));
+        ASSERT_LT(item, N);
+        histogram[item]++;
+    }
+
+    std::vector<double> expFrequencies(N);
+    std::vector<double> obsFrequencies(N);
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        expFrequencies[i] = (weights[i] / aliasTable.getWeightSum()) * N * samplesPerWeight;
+        obsFrequencies[i] = (double)histogram[i];
+    }
+
+    const auto& [success, report] = hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), N * samplesPerWeight, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+}
+
+CPU_BENCHMARK(AliasTable_Build)
+{
+    std::mt19937 rng;
+    for (uint32_t N : {1u << 16, 1u << 20, 1u << 24})
+    {
+        std::vector<float> weights = generateWeights(N, true, rng);
+        ctx.measure(
+            fmt::format("Build/{}", N), [&]() { AliasTable aliasTable(weights); }, Throughput::items((double)N)
+        );
+    }
+}
+
+GPU_TEST(AliasTable_KeepCpuData)
+{
+    std::mt19937 rng;
+    std::vector<float> weights = generateWeights(1000, false, rng);
+    AliasTable aliasTable(ctx.getDevice(), weights, rng, true);
+    AliasTable cpuTable(weights);
+
+    // The kept CPU data is identical to a table built on the CPU only.
+    ASSERT(aliasTable.hasCpuData());
+    ASSERT_EQ(aliasTable.getEntries().size(), cpuTable.getEntries().size());
+    for (uint32_t i = 0; i < aliasTable.getCount(); ++i)
+    {
+        EXPECT_EQ(aliasTable.getEntries()[i].threshold, cpuTable.getEntries()[i].threshold);
+        EXPECT_EQ(aliasTable.getEntries()[i].alias, cpuTable.getEntries()[i].alias);
+        EXPECT_EQ(aliasTable.getWeight(i), weights[i]);
+    }
+}
+
 GPU_TEST(AliasTable)
 {
     testAliasTable(ctx, 1, {1.f});
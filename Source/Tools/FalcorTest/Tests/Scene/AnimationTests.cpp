@@ -0,0 +1,220 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include "Scene/Animation/AnimationController.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/SceneBuilder.h"
+
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+ref<Animation> createAnimation(NodeID nodeID, size_t keyframeCount, double duration)
+{
+    ref<Animation> pAnimation = Animation::create("test", nodeID, duration);
+    // Add keyframes in reverse order to exercise sorted insertion.
+    for (size_t i = keyframeCount; i-- > 0;)
+    {
+        Animation::Keyframe keyframe;
+        keyframe.time = duration * i / (keyframeCount - 1);
+        keyframe.translation = float3((float)i, 2.f * (float)i, 0.f);
+        pAnimation->addKeyframe(keyframe);
+    }
+    return pAnimation;
+}
+
+/// Reference keyframe lookup scanning linearly from the first keyframe, as done when time moves backwards.
+size_t findKeyframeLinear(const std::vector<double>& times, double time)
+{
+    size_t frameIndex = 0;
+    while (frameIndex < times.size() - 1 && times[frameIndex + 1] <= time)
+        frameIndex++;
+    return frameIndex;
+}
+} // namespace
+
+CPU_TEST(Animation_Keyframes)
+{
+    ref<Animation> pAnimation = createAnimation(NodeID(0), 11, 10.0);
+    EXPECT_EQ(pAnimation->getKeyframeCount(), 11u);
+    EXPECT(pAnimation->doesKeyframeExists(3.0));
+    EXPECT(!pAnimation->doesKeyframeExists(3.5));
+    EXPECT_EQ(pAnimation->getKeyframe(3.0).translation.x, 3.f);
+
+    // Replace an existing keyframe.
+    Animation::Keyframe keyframe;
+    keyframe.time = 3.0;
+    keyframe.translation = float3(-1.f);
+    pAnimation->addKeyframe(keyframe);
+    EXPECT_EQ(pAnimation->getKeyframeCount(), 11u);
+    EXPECT_EQ(pAnimation->getKeyframe(3.0).translation.x, -1.f);
+
+    bool threw = false;
+    try
+    {
+        pAnimation->getKeyframe(3.5);
+    }
+    catch (const ArgumentError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+}
+
+CPU_TEST(Animation_Scrubbing)
+{
+    ref<Animation> pAnimation = createAnimation(NodeID(0), 101, 10.0);
+
+    // Results must not depend on the order of evaluation.
+    std::vector<float4x4> forward, backward;
+    for (int i = 0; i <= 200; ++i)
+        forward.push_back(pAnimation->animate(i * 0.05));
+    for (int i = 200; i >= 0; --i)
+        backward.push_back(pAnimation->animate(i * 0.05));
+    for (size_t i = 0; i < forward.size(); ++i)
+        EXPECT(forward[i] == backward[forward.size() - 1 - i]) << "i = " << i;
+
+    // Linear interpolation between keyframes at t = 1.0 (x = 10) and t = 1.1 (x = 11).
+    float4x4 transform = pAnimation->animate(1.05);
+    EXPECT_LE(std::abs(transform[0][3] - 10.5f), 1e-3f);
+}
+
+CPU_TEST(Animation_Batch)
+{
+    std::vector<ref<Animation>> animations;
+    for (uint32_t i = 0; i < 1000; ++i)
+        animations.push_back(createAnimation(NodeID(i), 16 + i % 32, 5.0 + i % 7));
+
+    std::vector<float4x4> transforms;
+    Animation::animate(animations, 3.3, transforms);
+    ASSERT_EQ(transforms.size(), animations.size());
+    for (size_t i = 0; i < animations.size(); ++i)
+        EXPECT(transforms[i] == animations[i]->animate(3.3)) << "i = " << i;
+}
+
+GPU_TEST(AnimationController_NodeChangedTwice)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    // Animated root node with a static child holding a mesh instance.
+    SceneBuilder builder(pDevice, Settings(), SceneBuilder::Flags::DontOptimizeGraph);
+    NodeID rootID = builder.addNode(SceneBuilder::Node{"root", float4x4::identity(), float4x4::identity(), float4x4::identity()});
+    NodeID childID = builder.addNode(SceneBuilder::Node{"child", float4x4::identity(), float4x4::identity(), float4x4::identity(), rootID});
+    MeshID meshID = builder.addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create(pDevice, "cube"));
+    builder.addMeshInstance(childID, meshID);
+    builder.addAnimation(createAnimation(rootID, 11, 10.0));
+    ref<Scene> pScene = builder.getScene();
+
+    const AnimationController* pController = pScene->getAnimationController();
+    auto checkWorldMatrices = [&](const char* step)
+    {
+        const auto& local = pController->getLocalMatrices();
+        const auto& global = pController->getGlobalMatrices();
+        EXPECT(global[rootID.get()] == local[rootID.get()]) << step;
+        EXPECT(global[childID.get()] == mul(global[rootID.get()], local[childID.get()])) << step;
+    };
+
+    pScene->update(pRenderContext, 1.0);
+    checkWorldMatrices("animated");
+
+    // Disabling animations re-initializes all matrices from the scene graph. The edited child additionally triggers an
+    // incremental update in the same frame, which animates the root node a second time.
+    pScene->setIsAnimated(false);
+    pScene->updateNodeTransform(childID.get(), math::matrixFromTranslation(float3(0.f, 1.f, 0.f)));
+    pScene->update(pRenderContext, 2.0);
+    checkWorldMatrices("edited");
+    EXPECT(pController->isMatrixChanged(rootID));
+    EXPECT(pController->isMatrixChanged(childID));
+
+    pScene->setIsAnimated(true);
+    pScene->update(pRenderContext, 3.0);
+    checkWorldMatrices("re-enabled");
+}
+
+CPU_BENCHMARK(Animation_Benchmark)
+{
+    const size_t kAnimationCount = 8192;
+    const size_t kKeyframeCount = 4096;
+    const size_t kFrameCount = 64;
+    const double kDuration = 100.0;
+
+    std::vector<ref<Animation>> animations;
+    for (uint32_t i = 0; i < kAnimationCount; ++i)
+        animations.push_back(createAnimation(NodeID(i), kKeyframeCount, kDuration));
+
+    std::vector<double> times(kKeyframeCount);
+    for (size_t i = 0; i < kKeyframeCount; ++i)
+        times[i] = kDuration * i / (kKeyframeCount - 1);
+
+    // Scrub backwards through the animation, which previously restarted the keyframe search from the first keyframe.
+    auto frameTime = [&](size_t frame) { return kDuration * (kFrameCount - frame) / (kFrameCount + 1); };
+
+    // The linear keyframe search is measured on its own as a reference for the cost of the old lookup.
+    size_t checksum = 0;
+    ctx.measure(
+        "LinearKeyframeSearch",
+        [&]()
+        {
+            for (size_t frame = 0; frame < kFrameCount; ++frame)
+                for (size_t i = 0; i < kAnimationCount; ++i)
+                    checksum += findKeyframeLinear(times, frameTime(frame));
+        },
+        Throughput::items(kFrameCount * kAnimationCount)
+    );
+
+    double sum = 0.0;
+    ctx.measure(
+        "Serial",
+        [&]()
+        {
+            for (size_t frame = 0; frame < kFrameCount; ++frame)
+                for (const auto& pAnimation : animations)
+                    sum += pAnimation->animate(frameTime(frame))[0][3];
+        },
+        Throughput::items(kFrameCount * kAnimationCount)
+    );
+
+    std::vector<float4x4> transforms;
+    ctx.measure(
+        "Batched",
+        [&]()
+        {
+            for (size_t frame = 0; frame < kFrameCount; ++frame)
+                Animation::animate(animations, frameTime(frame), transforms);
+        },
+        Throughput::items(kFrameCount * kAnimationCount)
+    );
+
+    EXPECT(checksum != 0);
+    EXPECT(sum != 0.0);
+}
+} // namespace Falcor
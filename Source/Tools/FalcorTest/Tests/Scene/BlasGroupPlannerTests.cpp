@@ -0,0 +1,228 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasGroupPlanner.h"
+#include "Utils/Math/Common.h"
+
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+const uint64_t kMB = 1ull << 20;
+const uint64_t kBudget = 512 * kMB;
+
+/// Generate BLAS sizes with a log-normal distribution, which resembles the sizes recorded for typical scenes:
+/// many small meshes and a few large ones. Scratch is roughly a quarter of the result size.
+std::vector<BlasGroupPlanner::BlasDesc> generateBlases(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::lognormal_distribution<double> sizeDist(12.0, 2.5);
+    std::uniform_real_distribution<double> scratchDist(0.15, 0.35);
+    std::uniform_int_distribution<uint32_t> typeDist(0, 9);
+
+    std::vector<BlasGroupPlanner::BlasDesc> blases(count);
+    for (auto& blas : blases)
+    {
+        uint64_t resultByteSize = std::min<uint64_t>((uint64_t)sizeDist(rng), 256 * kMB);
+        blas.resultByteSize = align_to<uint64_t>(256, std::max<uint64_t>(resultByteSize, 256));
+        blas.scratchByteSize = align_to<uint64_t>(256, std::max<uint64_t>((uint64_t)(resultByteSize * scratchDist(rng)), 256));
+        uint32_t type = typeDist(rng);
+        blas.isDynamic = type == 0;
+        blas.useCompaction = type >= 3;
+    }
+    return blases;
+}
+
+/// Peak build memory when appending BLASes in index order until the budget was exceeded.
+uint64_t computeSequentialPeakBuildMemory(const std::vector<BlasGroupPlanner::BlasDesc>& blases, uint64_t budget)
+{
+    uint64_t maxResult = 0, maxScratch = 0;
+    uint64_t groupResult = 0, groupScratch = 0;
+    for (const auto& blas : blases)
+    {
+        uint64_t size = blas.resultByteSize + blas.scratchByteSize;
+        if (groupResult + groupScratch > 0 && groupResult + groupScratch + size > budget)
+        {
+            groupResult = groupScratch = 0;
+        }
+        groupResult += blas.resultByteSize;
+        groupScratch += blas.scratchByteSize;
+        maxResult = std::max(maxResult, groupResult);
+        maxScratch = std::max(maxScratch, groupScratch);
+    }
+    return maxResult + maxScratch;
+}
+
+void validatePlan(UnitTestContext& ctx, const std::vector<BlasGroupPlanner::BlasDesc>& blases, const BlasGroupPlanner::Plan& plan, uint64_t budget)
+{
+    ASSERT_EQ(plan.placements.size(), blases.size());
+    EXPECT_EQ(plan.submitCount, plan.groups.size());
+
+    std::set<uint32_t> blasIndices;
+    uint64_t maxResult = 0, maxScratch = 0, maxDynamicScratch = 0;
+    for (uint32_t groupIndex = 0; groupIndex < plan.groups.size(); groupIndex++)
+    {
+        const auto& group = plan.groups[groupIndex];
+        ASSERT(!group.blasIndices.empty());
+        if (groupIndex > 0)
+            EXPECT_LE((uint32_t)plan.groups[groupIndex - 1].type, (uint32_t)group.type);
+
+        uint64_t resultOffset = 0, scratchOffset = 0;
+        for (size_t i = 0; i < group.blasIndices.size(); i++)
+        {
+            uint32_t blasIndex = group.blasIndices[i];
+            ASSERT_LT(blasIndex, blases.size());
+            EXPECT(blasIndices.insert(blasIndex).second);
+            if (i > 0)
+                EXPECT_LT(group.blasIndices[i - 1], blasIndex);
+
+            const auto& blas = blases[blasIndex];
+            const auto& placement = plan.placements[blasIndex];
+            EXPECT(BlasGroupPlanner::getGroupType(blas) == group.type);
+            EXPECT_EQ(placement.groupIndex, groupIndex);
+            EXPECT_EQ(placement.resultByteOffset, resultOffset);
+            EXPECT_EQ(placement.scratchByteOffset, scratchOffset);
+            resultOffset += blas.resultByteSize;
+            scratchOffset += blas.scratchByteSize;
+        }
+        EXPECT_EQ(group.resultByteSize, resultOffset);
+        EXPECT_EQ(group.scratchByteSize, scratchOffset);
+
+        // Only a single oversized BLAS may exceed the budget.
+        if (group.resultByteSize + group.scratchByteSize > budget)
+            EXPECT_EQ(group.blasIndices.size(), 1);
+
+        maxResult = std::max(maxResult, group.resultByteSize);
+        maxScratch = std::max(maxScratch, group.scratchByteSize);
+        if (group.type == BlasGroupPlanner::GroupType::Dynamic)
+            maxDynamicScratch = std::max(maxDynamicScratch, group.scratchByteSize);
+    }
+
+    EXPECT_EQ(blasIndices.size(), blases.size());
+    EXPECT_EQ(plan.resultBufferByteSize, maxResult);
+    EXPECT_EQ(plan.scratchBufferByteSize, maxScratch);
+    EXPECT_EQ(plan.retainedScratchByteSize, maxDynamicScratch);
+    EXPECT_EQ(plan.peakBuildMemory, maxResult + maxScratch);
+}
+} // namespace
+
+CPU_TEST(BlasGroupPlanner_Empty)
+{
+    auto plan = BlasGroupPlanner::plan({}, kBudget);
+    EXPECT(plan.groups.empty());
+    EXPECT(plan.placements.empty());
+    EXPECT_EQ(plan.peakBuildMemory, 0);
+    EXPECT_EQ(plan.submitCount, 0);
+}
+
+CPU_TEST(BlasGroupPlanner_Balanced)
+{
+    // Six equally sized BLASes that exceed the budget. Appending in order fills the first group with five
+    // BLASes, while the planner splits them evenly over the minimum of two groups.
+    std::vector<BlasGroupPlanner::BlasDesc> blases(6);
+    for (auto& blas : blases)
+    {
+        blas.resultByteSize = 80 * kMB;
+        blas.scratchByteSize = 20 * kMB;
+    }
+
+    auto plan = BlasGroupPlanner::plan(blases, kBudget);
+    validatePlan(ctx, blases, plan, kBudget);
+    ASSERT_EQ(plan.groups.size(), 2);
+    EXPECT_EQ(plan.groups[0].blasIndices.size(), 3);
+    EXPECT_EQ(plan.groups[1].blasIndices.size(), 3);
+    EXPECT_EQ(plan.peakBuildMemory, 300 * kMB);
+    EXPECT_EQ(computeSequentialPeakBuildMemory(blases, kBudget), 500 * kMB);
+}
+
+CPU_TEST(BlasGroupPlanner_Types)
+{
+    std::vector<BlasGroupPlanner::BlasDesc> blases(6);
+    for (size_t i = 0; i < blases.size(); i++)
+    {
+        blases[i].resultByteSize = (i + 1) * kMB;
+        blases[i].scratchByteSize = (i + 1) * kMB;
+        blases[i].isDynamic = i % 3 == 0;
+        blases[i].useCompaction = i % 3 == 1;
+    }
+
+    auto plan = BlasGroupPlanner::plan(blases, kBudget);
+    validatePlan(ctx, blases, plan, kBudget);
+    ASSERT_EQ(plan.groups.size(), 3);
+    EXPECT(plan.groups[0].type == BlasGroupPlanner::GroupType::StaticCompacted);
+    EXPECT(plan.groups[0].blasIndices == std::vector<uint32_t>({1, 4}));
+    EXPECT(plan.groups[1].type == BlasGroupPlanner::GroupType::Static);
+    EXPECT(plan.groups[1].blasIndices == std::vector<uint32_t>({2, 5}));
+    EXPECT(plan.groups[2].type == BlasGroupPlanner::GroupType::Dynamic);
+    EXPECT(plan.groups[2].blasIndices == std::vector<uint32_t>({0, 3}));
+    EXPECT_EQ(plan.retainedScratchByteSize, 5 * kMB);
+}
+
+CPU_TEST(BlasGroupPlanner_Oversized)
+{
+    std::vector<BlasGroupPlanner::BlasDesc> blases(3);
+    blases[0] = {600 * kMB, 100 * kMB};
+    blases[1] = {10 * kMB, 10 * kMB};
+    blases[2] = {10 * kMB, 10 * kMB};
+
+    auto plan = BlasGroupPlanner::plan(blases, kBudget);
+    validatePlan(ctx, blases, plan, kBudget);
+    ASSERT_EQ(plan.groups.size(), 2);
+    EXPECT(plan.groups[0].blasIndices == std::vector<uint32_t>({0}));
+    EXPECT(plan.groups[1].blasIndices == std::vector<uint32_t>({1, 2}));
+}
+
+CPU_TEST(BlasGroupPlanner_Distribution)
+{
+    for (uint32_t seed = 0; seed < 8; seed++)
+    {
+        auto blases = generateBlases(5000, seed);
+        auto plan = BlasGroupPlanner::plan(blases, kBudget);
+        validatePlan(ctx, blases, plan, kBudget);
+
+        // The plan is deterministic.
+        auto plan2 = BlasGroupPlanner::plan(blases, kBudget);
+        ASSERT_EQ(plan2.groups.size(), plan.groups.size());
+        for (size_t i = 0; i < plan.groups.size(); i++)
+            EXPECT(plan2.groups[i].blasIndices == plan.groups[i].blasIndices);
+    }
+}
+
+CPU_BENCHMARK(BlasGroupPlanner_Plan)
+{
+    auto blases = generateBlases(100000, 1);
+
+    BlasGroupPlanner::Plan plan;
+    ctx.measure("Plan", [&]() { plan = BlasGroupPlanner::plan(blases, kBudget); }, Throughput::items((double)blases.size()));
+
+    validatePlan(ctx, blases, plan, kBudget);
+}
+} // namespace Falcor
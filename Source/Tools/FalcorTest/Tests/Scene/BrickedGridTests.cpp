@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/BrickedGrid.h"
+
+#include <fstream>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+BrickedGridData createTestData()
+{
+    BrickedGridData data;
+    data.rangeSize = uint3(2, 2, 2);
+    data.atlasSize = uint3(16, 16, 8);
+    data.atlasFormat = ResourceFormat::R8Unorm;
+    data.range.resize(8 + 1 + 1 + 1);
+    data.indirection.resize(8);
+    data.atlas.resize(16 * 16 * 8);
+    for (size_t i = 0; i < data.range.size(); i++)
+        data.range[i] = uint32_t(i * 0x01010101u);
+    for (size_t i = 0; i < data.indirection.size(); i++)
+        data.indirection[i] = uint32_t(i);
+    for (size_t i = 0; i < data.atlas.size(); i++)
+        data.atlas[i] = uint8_t(i * 7);
+    return data;
+}
+
+void writeSource(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+} // namespace
+
+CPU_TEST(BrickedGridCache)
+{
+    const auto dir = getRuntimeDirectory() / "test_bricked_grid_cache";
+    std::filesystem::create_directories(dir);
+    const auto sourcePath = dir / "grid.nvdb";
+    writeSource(sourcePath, "source grid");
+
+    const BrickedGridData data = createTestData();
+    BrickedGridData cached;
+
+    // Nothing is cached yet.
+    EXPECT(!BrickedGridCache::read(sourcePath, "density", cached));
+
+    BrickedGridCache::write(sourcePath, "density", data);
+    EXPECT(std::filesystem::exists(BrickedGridCache::getCachePath(sourcePath, "density")));
+
+    ASSERT(BrickedGridCache::read(sourcePath, "density", cached));
+    EXPECT(cached.rangeSize == data.rangeSize);
+    EXPECT(cached.atlasSize == data.atlasSize);
+    EXPECT(cached.atlasFormat == data.atlasFormat);
+    EXPECT(cached.range == data.range);
+    EXPECT(cached.indirection == data.indirection);
+    EXPECT(cached.atlas == data.atlas);
+
+    // Cache entries are per grid.
+    EXPECT(!BrickedGridCache::read(sourcePath, "temperature", cached));
+
+    // Modifying the source invalidates the cache. Wait a bit so the write time is guaranteed to change.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    writeSource(sourcePath, "modified source grid");
+    EXPECT(!BrickedGridCache::read(sourcePath, "density", cached));
+
+    std::filesystem::remove_all(dir);
+}
+} // namespace Falcor
@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridConverter.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996 4456)
+#endif
+// GridBuilder.h uses the std::result_of type trait which is removed in C++20 (see Grid.cpp).
+#define result_of invoke_result
+#include <nanovdb/util/GridBuilder.h>
+#undef result_of
+#include <nanovdb/util/Primitives.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+
+namespace Falcor
+{
+namespace
+{
+template<typename Converter>
+void testConverter(CPUUnitTestContext& ctx, const nanovdb::FloatGrid* pGrid)
+{
+    // The parallel conversion must match the conversion on a single thread bit for bit.
+    BrickedGridData serial = Converter(pGrid).convertToData(false);
+    BrickedGridData parallel = Converter(pGrid).convertToData(true);
+
+    EXPECT(parallel.rangeSize == serial.rangeSize);
+    EXPECT(parallel.atlasSize == serial.atlasSize);
+    EXPECT(parallel.atlasFormat == serial.atlasFormat);
+    EXPECT(parallel.range == serial.range);
+    EXPECT(parallel.indirection == serial.indirection);
+    EXPECT(parallel.atlas == serial.atlas);
+
+    // Check the ranges of the finest level against the min/max of each brick including its 1-voxel halo, read voxel by voxel.
+    // The halos of bricks at the ends of rows, and thus on the boundaries of parallel chunks, are read from neighbouring rows.
+    auto a = pGrid->getAccessor();
+    const auto& bbox = pGrid->indexBBox();
+    const int3 bbMin = int3(bbox.min().x(), bbox.min().y(), bbox.min().z()) & (~7);
+    const uint3 dim = serial.rangeSize;
+    uint32_t nonEmptyCount = 0;
+    for (uint32_t z = 0; z < dim.z; ++z)
+    {
+        for (uint32_t y = 0; y < dim.y; ++y)
+        {
+            for (uint32_t x = 0; x < dim.x; ++x)
+            {
+                const nanovdb::Coord ijk(bbMin.x + 8 * x, bbMin.y + 8 * y, bbMin.z + 8 * z);
+                float minorant = a.getValue(ijk);
+                float majorant = minorant;
+                if (a.probeLeaf(ijk))
+                {
+                    for (int k = -1; k <= 8; ++k)
+                    {
+                        for (int j = -1; j <= 8; ++j)
+                        {
+                            for (int i = -1; i <= 8; ++i)
+                            {
+                                float value = a.getValue(ijk + nanovdb::Coord(i, j, k));
+                                minorant = std::min(minorant, value);
+                                majorant = std::max(majorant, value);
+                            }
+                        }
+                    }
+                }
+
+                uint32_t expected = f32tof16(majorant) + (f32tof16(majorant) << 16);
+                if (minorant != majorant)
+                {
+                    expected = (f32tof16(majorant) + 1) + (f32tof16(minorant) << 16);
+                    ++nonEmptyCount;
+                }
+                const size_t index = (size_t(z) * dim.y + y) * dim.x + x;
+                EXPECT_EQ(serial.range[index], expected) << fmt::format("brick ({}, {}, {})", x, y, z);
+            }
+        }
+    }
+    EXPECT_GT(nonEmptyCount, 0u);
+}
+} // namespace
+
+CPU_TEST(GridConverter_ParallelMatchesSerial)
+{
+    // A fog volume sphere has constant interior leaves, bricks on its boundary and constant tiles around it.
+    auto handle = nanovdb::createFogVolumeSphere<float>(60.f, nanovdb::Vec3f(3.f, -5.f, 7.f), 1.f, 3.f);
+    const nanovdb::FloatGrid* pGrid = handle.grid<float>();
+    ASSERT(pGrid != nullptr);
+
+    testConverter<NanoVDBConverterUNORM8>(ctx, pGrid);
+    testConverter<NanoVDBConverterUNORM16>(ctx, pGrid);
+    testConverter<NanoVDBConverterBC4>(ctx, pGrid);
+}
+} // namespace Falcor
@@ -0,0 +1,194 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/Material/ClothMaterial.h"
+#include "Scene/Material/HairMaterial.h"
+#include "Scene/Material/MERLMaterial.h"
+#include "Scene/Material/MERLMixMaterial.h"
+#include "Scene/Material/PBRT/PBRTDiffuseMaterial.h"
+#include "Scene/Material/PBRT/PBRTDiffuseTransmissionMaterial.h"
+#include "Scene/Material/PBRT/PBRTConductorMaterial.h"
+#include "Scene/Material/PBRT/PBRTDielectricMaterial.h"
+#include "Scene/Material/PBRT/PBRTCoatedConductorMaterial.h"
+#include "Scene/Material/PBRT/PBRTCoatedDiffuseMaterial.h"
+
+namespace Falcor
+{
+namespace
+{
+const std::filesystem::path kMERLPath = "test_scenes/materials/data/gray-lambert.binary";
+
+using BasicMaterialFactory = std::function<ref<BasicMaterial>(const std::string& name)>;
+
+struct Mutation
+{
+    std::string name;
+    bool hashed; ///< True if the mutated property is included in the hash, false if it is only compared.
+    std::function<void(BasicMaterial& material)> apply;
+};
+
+/**
+ * Check that materials that are equal according to isEqual() have the same hash.
+ * All pairs are checked, including materials of different types.
+ */
+void testHashConsistency(GPUUnitTestContext& ctx, const std::vector<std::pair<std::string, ref<Material>>>& materials)
+{
+    for (const auto& [nameA, pA] : materials)
+    {
+        for (const auto& [nameB, pB] : materials)
+        {
+            if (pA->isEqual(pB))
+                EXPECT_EQ(pA->computeHash(), pB->computeHash()) << nameA << " == " << nameB;
+        }
+    }
+}
+} // namespace
+
+GPU_TEST(MaterialHash_BasicMaterials)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::vector<std::pair<std::string, BasicMaterialFactory>> factories = {
+        {"Standard", [&](const std::string& name) { return StandardMaterial::create(pDevice, name); }},
+        {"Cloth", [&](const std::string& name) { return ClothMaterial::create(pDevice, name); }},
+        {"Hair", [&](const std::string& name) { return HairMaterial::create(pDevice, name); }},
+        {"PBRTDiffuse", [&](const std::string& name) { return PBRTDiffuseMaterial::create(pDevice, name); }},
+        {"PBRTDiffuseTransmission", [&](const std::string& name) { return PBRTDiffuseTransmissionMaterial::create(pDevice, name); }},
+        {"PBRTConductor", [&](const std::string& name) { return PBRTConductorMaterial::create(pDevice, name); }},
+        {"PBRTDielectric", [&](const std::string& name) { return PBRTDielectricMaterial::create(pDevice, name); }},
+        {"PBRTCoatedConductor", [&](const std::string& name) { return PBRTCoatedConductorMaterial::create(pDevice, name); }},
+        {"PBRTCoatedDiffuse", [&](const std::string& name) { return PBRTCoatedDiffuseMaterial::create(pDevice, name); }},
+    };
+
+    ref<Texture> pTexture = Texture::createFromFile(pDevice, getRuntimeDirectory() / "data/tests/BC1Unorm-ref.png", false, false);
+    ASSERT(pTexture != nullptr);
+    ref<Sampler> pPointSampler =
+        Sampler::create(pDevice, Sampler::Desc().setFilterMode(Sampler::Filter::Point, Sampler::Filter::Point, Sampler::Filter::Point));
+    Transform textureTransform;
+    textureTransform.setScaling(float3(2.f));
+
+    std::vector<Mutation> mutations = {
+        {"none", true, [](BasicMaterial&) {}},
+        {"baseColor", true, [](BasicMaterial& m) { m.setBaseColor(float4(0.2f, 0.4f, 0.6f, 1.f)); }},
+        {"specular", true, [](BasicMaterial& m) { m.setSpecularParams(float4(0.1f, 0.7f, 0.3f, 0.f)); }},
+        {"emissive",
+         true,
+         [](BasicMaterial& m)
+         {
+             if (auto pStandard = dynamic_cast<StandardMaterial*>(&m))
+                 pStandard->setEmissiveColor(float3(1.f, 0.5f, 0.f));
+         }},
+        {"doubleSided", true, [](BasicMaterial& m) { m.setDoubleSided(!m.isDoubleSided()); }},
+        {"thinSurface", true, [](BasicMaterial& m) { m.setThinSurface(!m.isThinSurface()); }},
+        {"indexOfRefraction", true, [](BasicMaterial& m) { m.setIndexOfRefraction(1.33f); }},
+        {"nestedPriority", true, [](BasicMaterial& m) { m.setNestedPriority(3); }},
+        {"displacementScale", true, [](BasicMaterial& m) { m.setDisplacementScale(0.25f); }},
+        {"transmission", true, [](BasicMaterial& m) { m.setTransmissionColor(float3(0.5f)); }},
+        {"volumeAbsorption", true, [](BasicMaterial& m) { m.setVolumeAbsorption(float3(0.1f, 0.2f, 0.3f)); }},
+        {"baseColorTexture", true, [&](BasicMaterial& m) { m.setBaseColorTexture(pTexture); }},
+        {"textureTransform", false, [&](BasicMaterial& m) { m.setTextureTransform(textureTransform); }},
+        {"sampler", false, [&](BasicMaterial& m) { m.setDefaultTextureSampler(pPointSampler); }},
+    };
+
+    std::vector<std::pair<std::string, ref<Material>>> materials;
+    for (const auto& [typeName, factory] : factories)
+    {
+        ref<BasicMaterial> pOriginal = factory(typeName);
+
+        for (const auto& mutation : mutations)
+        {
+            // Mutate the material and a clone with a different name. The clone is equal to the mutated material.
+            std::string name = typeName + "." + mutation.name;
+            ref<BasicMaterial> pMutated = factory(name);
+            ref<BasicMaterial> pClone = factory(name + ".clone");
+            mutation.apply(*pMutated);
+            mutation.apply(*pClone);
+
+            EXPECT(pMutated->isEqual(pClone)) << name;
+            EXPECT_EQ(pMutated->computeHash(), pClone->computeHash()) << name;
+
+            // Mutations of hashed properties that change the material also change the hash.
+            if (mutation.hashed && !pMutated->isEqual(pOriginal))
+                EXPECT_NE(pMutated->computeHash(), pOriginal->computeHash()) << name;
+
+            materials.emplace_back(name, pMutated);
+            materials.emplace_back(name + ".clone", pClone);
+        }
+
+        // Negative zero compares equal to zero and must hash the same.
+        ref<BasicMaterial> pZero = factory(typeName + ".zero");
+        ref<BasicMaterial> pNegativeZero = factory(typeName + ".negativeZero");
+        pZero->setBaseColor(float4(0.f, 0.5f, 0.5f, 1.f));
+        pNegativeZero->setBaseColor(float4(-0.f, 0.5f, 0.5f, 1.f));
+        EXPECT(pZero->isEqual(pNegativeZero)) << typeName;
+        EXPECT_EQ(pZero->computeHash(), pNegativeZero->computeHash()) << typeName;
+        materials.emplace_back(typeName + ".zero", pZero);
+        materials.emplace_back(typeName + ".negativeZero", pNegativeZero);
+    }
+
+    testHashConsistency(ctx, materials);
+}
+
+GPU_TEST(MaterialHash_MERLMaterials)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    ref<MERLMaterial> pMERL = MERLMaterial::create(pDevice, "MERL", kMERLPath);
+    ref<MERLMaterial> pMERLClone = MERLMaterial::create(pDevice, "MERL.clone", kMERLPath);
+    ref<MERLMaterial> pMERLDoubleSided = MERLMaterial::create(pDevice, "MERL.doubleSided", kMERLPath);
+    pMERLDoubleSided->setDoubleSided(!pMERL->isDoubleSided());
+
+    ref<MERLMixMaterial> pMix = MERLMixMaterial::create(pDevice, "MERLMix", {kMERLPath, kMERLPath});
+    ref<MERLMixMaterial> pMixClone = MERLMixMaterial::create(pDevice, "MERLMix.clone", {kMERLPath, kMERLPath});
+    ref<MERLMixMaterial> pMixSingle = MERLMixMaterial::create(pDevice, "MERLMix.single", {kMERLPath});
+
+    EXPECT(pMERL->isEqual(pMERLClone));
+    EXPECT_EQ(pMERL->computeHash(), pMERLClone->computeHash());
+    EXPECT(!pMERL->isEqual(pMERLDoubleSided));
+    EXPECT_NE(pMERL->computeHash(), pMERLDoubleSided->computeHash());
+
+    EXPECT(pMix->isEqual(pMixClone));
+    EXPECT_EQ(pMix->computeHash(), pMixClone->computeHash());
+    EXPECT(!pMix->isEqual(pMixSingle));
+    EXPECT_NE(pMix->computeHash(), pMixSingle->computeHash());
+
+    testHashConsistency(
+        ctx,
+        {
+            {"MERL", pMERL},
+            {"MERL.clone", pMERLClone},
+            {"MERL.doubleSided", pMERLDoubleSided},
+            {"MERLMix", pMix},
+            {"MERLMix.clone", pMixClone},
+            {"MERLMix.single", pMixSingle},
+            {"Standard", StandardMaterial::create(pDevice, "Standard")},
+        }
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,77 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+GPU_TEST(MaterialSystem_ResidencyKeepsTexturesInUse)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    MaterialSystem materialSystem(pDevice);
+    auto& textureManager = materialSystem.getTextureManager();
+
+    // Two materials with one texture each. Only the first material is in use.
+    std::vector<MaterialID> materialIDs;
+    std::vector<TextureManager::TextureHandle> handles;
+    for (const char* name : {"BC1Unorm-ref.png", "BC4Unorm-ref.png"})
+    {
+        auto handle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests" / name, true, false, ResourceBindFlags::ShaderResource, false);
+        ASSERT(handle.isValid());
+        handles.push_back(handle);
+
+        ref<StandardMaterial> pMaterial = StandardMaterial::create(pDevice, name);
+        pMaterial->setTexture(Material::TextureSlot::BaseColor, textureManager.getTexture(handle));
+        materialIDs.push_back(materialSystem.addMaterial(pMaterial));
+    }
+    materialSystem.setMaterialsInUse({materialIDs[0]});
+
+    // Render frames over budget. Reducing the texture of the material not in use is enough to meet the budget,
+    // so the texture of the material in use must stay resident, without any explicit usage marking.
+    const uint64_t textureSize = textureManager.getTexture(handles[0])->getTextureSizeInBytes();
+    textureManager.setResidencyBudget(textureSize + textureSize / 2);
+    for (uint32_t frame = 0; frame < 20; ++frame)
+    {
+        materialSystem.update(frame == 0);
+
+        EXPECT(textureManager.getTextureDesc(handles[0]).residency == TextureManager::ResidencyState::Resident);
+        auto pTexture = materialSystem.getMaterial(materialIDs[0])->getTexture(Material::TextureSlot::BaseColor);
+        ASSERT(pTexture != nullptr);
+        EXPECT_EQ(pTexture->getWidth(), 256);
+    }
+
+    // The texture of the material not in use is reduced to fit the budget, and the material is switched to the reduced texture.
+    EXPECT(textureManager.getTextureDesc(handles[1]).residency != TextureManager::ResidencyState::Resident);
+    auto pReduced = materialSystem.getMaterial(materialIDs[1])->getTexture(Material::TextureSlot::BaseColor);
+    ASSERT(pReduced != nullptr);
+    EXPECT(pReduced == textureManager.getTexture(handles[1]));
+    EXPECT_LT(pReduced->getWidth(), 256);
+}
+} // namespace Falcor
@@ -0,0 +1,221 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshInstanceDetector.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct TestMesh
+{
+    uint32_t materialID = 0;
+    std::vector<uint32_t> indices;
+    std::vector<StaticVertexData> vertices;
+};
+
+/// Generate a mesh with random vertices. Indices form a triangle fan, which is enough for matching.
+TestMesh generateMesh(uint32_t vertexCount, uint32_t materialID, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    auto randomDirection = [&]() { return normalize(float3(dist(rng), dist(rng), dist(rng)) + float3(0.f, 0.f, 2.f)); };
+
+    TestMesh mesh;
+    mesh.materialID = materialID;
+    mesh.vertices.resize(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        auto& v = mesh.vertices[i];
+        v.position = float3(dist(rng), dist(rng), dist(rng)) * 10.f;
+        v.normal = randomDirection();
+        v.tangent = float4(randomDirection(), i % 2 ? 1.f : -1.f);
+        v.texCrd = float2(dist(rng), dist(rng));
+        v.curveRadius = 0.f;
+    }
+    for (uint32_t i = 1; i + 1 < vertexCount; i++)
+    {
+        mesh.indices.insert(mesh.indices.end(), {0, i, i + 1});
+    }
+    return mesh;
+}
+
+TestMesh transformMesh(const TestMesh& mesh, const float4x4& transform)
+{
+    TestMesh result = mesh;
+    for (auto& v : result.vertices)
+    {
+        v.position = transformPoint(transform, v.position);
+        v.normal = transformVector(transform, v.normal);
+        v.tangent = float4(transformVector(transform, v.tangent.xyz()), v.tangent.w);
+    }
+    return result;
+}
+
+float4x4 randomRigidTransform(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    float3 axis = normalize(float3(dist(rng), dist(rng), dist(rng)));
+    float4x4 transform = math::matrixFromRotation(dist(rng) * 3.f, axis);
+    transform[0][3] = dist(rng) * 100.f;
+    transform[1][3] = dist(rng) * 100.f;
+    transform[2][3] = dist(rng) * 100.f;
+    return transform;
+}
+
+std::vector<MeshInstanceDetector::MeshDesc> createMeshDescs(const std::vector<TestMesh>& meshes)
+{
+    std::vector<MeshInstanceDetector::MeshDesc> descs(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        auto& desc = descs[i];
+        desc.materialID = meshes[i].materialID;
+        desc.indexCount = (uint32_t)meshes[i].indices.size();
+        desc.pIndexData = meshes[i].indices.data();
+        desc.indexDataSize = meshes[i].indices.size();
+        desc.pVertices = meshes[i].vertices.data();
+        desc.vertexCount = (uint32_t)meshes[i].vertices.size();
+    }
+    return descs;
+}
+} // namespace
+
+CPU_TEST(MeshInstanceDetector_Empty)
+{
+    EXPECT(MeshInstanceDetector::findInstances({}).empty());
+}
+
+CPU_TEST(MeshInstanceDetector_FindInstances)
+{
+    std::mt19937 rng(1);
+    std::vector<TestMesh> meshes;
+    meshes.push_back(generateMesh(100, 0, rng));
+    meshes.push_back(generateMesh(100, 0, rng));
+    const float4x4 transform = randomRigidTransform(rng);
+
+    meshes.push_back(meshes[0]);                              // 2: Identical to 0.
+    meshes.push_back(transformMesh(meshes[1], transform));    // 3: Rigid transform of 1.
+    meshes.push_back(meshes[0]);                              // 4: Different material.
+    meshes.back().materialID = 1;
+    meshes.push_back(meshes[0]);                              // 5: Different texture coordinates.
+    meshes.back().vertices[10].texCrd.x += 0.5f;
+    meshes.push_back(transformMesh(meshes[1], transform));    // 6: Perturbed position.
+    meshes.back().vertices[20].position.y += 0.1f;
+    meshes.push_back(transformMesh(meshes[0], math::matrixFromScaling(float3(-1.f, 1.f, 1.f)))); // 7: Mirrored.
+    meshes.push_back(meshes[4]);                              // 8: Identical to 4.
+
+    auto matches = MeshInstanceDetector::findInstances(createMeshDescs(meshes));
+    ASSERT_EQ(matches.size(), meshes.size());
+
+    const uint32_t expected[] = {0, 1, 0, 1, 4, 5, 6, 7, 4};
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        EXPECT_EQ(matches[i].meshIndex, expected[i]) << "mesh " << i;
+    }
+
+    // Identical meshes and unique meshes use the identity transform.
+    for (size_t i : {0, 1, 2, 4, 8})
+    {
+        EXPECT(matches[i].transform == float4x4::identity());
+    }
+
+    // The transform maps the vertices of the matched mesh onto the instance.
+    for (size_t i = 0; i < meshes[3].vertices.size(); i++)
+    {
+        float3 p = transformPoint(matches[3].transform, meshes[1].vertices[i].position);
+        EXPECT_LT(length(p - meshes[3].vertices[i].position), 1e-3f);
+    }
+}
+
+CPU_TEST(MeshInstanceDetector_Degenerate)
+{
+    // Meshes with all vertices on a line only match under translation.
+    std::mt19937 rng(2);
+    TestMesh line = generateMesh(10, 0, rng);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        line.vertices[i].position = float3((float)i, 0.f, 0.f);
+    }
+    float4x4 translation = math::matrixFromTranslation(float3(5.f, 6.f, 7.f));
+    std::vector<TestMesh> meshes = {line, transformMesh(line, translation), TestMesh{}, TestMesh{}};
+
+    auto matches = MeshInstanceDetector::findInstances(createMeshDescs(meshes));
+    ASSERT_EQ(matches.size(), meshes.size());
+    EXPECT_EQ(matches[1].meshIndex, 0u);
+    EXPECT_LT(std::abs(matches[1].transform[1][3] - 6.f), 1e-4f);
+    EXPECT_EQ(matches[3].meshIndex, 2u);
+}
+
+CPU_TEST(MeshInstanceDetector_Skip)
+{
+    // Skipped meshes are unique and never used as the reference of another mesh.
+    std::mt19937 rng(4);
+    std::vector<TestMesh> meshes;
+    meshes.push_back(generateMesh(50, 0, rng));
+    meshes.push_back(meshes[0]);
+    meshes.push_back(meshes[0]);
+    meshes.push_back(meshes[0]);
+
+    auto descs = createMeshDescs(meshes);
+    descs[0].skip = true;
+    descs[2].skip = true;
+
+    auto matches = MeshInstanceDetector::findInstances(descs);
+    ASSERT_EQ(matches.size(), meshes.size());
+
+    const uint32_t expected[] = {0, 1, 2, 1};
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        EXPECT_EQ(matches[i].meshIndex, expected[i]) << "mesh " << i;
+        EXPECT(matches[i].transform == float4x4::identity()) << "mesh " << i;
+    }
+}
+
+CPU_BENCHMARK(MeshInstanceDetector_Throughput)
+{
+    // 2000 meshes of which every tenth is unique, the rest are rigid transforms of them.
+    const size_t kMeshCount = 2000;
+    const uint32_t kVertexCount = 1000;
+    std::mt19937 rng(3);
+    std::vector<TestMesh> meshes;
+    for (size_t i = 0; i < kMeshCount; i++)
+    {
+        if (i % 10 == 0) meshes.push_back(generateMesh(kVertexCount, (uint32_t)(i % 7), rng));
+        else meshes.push_back(transformMesh(meshes[i - i % 10], randomRigidTransform(rng)));
+    }
+    auto descs = createMeshDescs(meshes);
+
+    std::vector<MeshInstanceDetector::Match> matches;
+    ctx.measure("FindInstances", [&]() { matches = MeshInstanceDetector::findInstances(descs); }, Throughput::items(kMeshCount));
+
+    size_t instanceCount = 0;
+    for (size_t i = 0; i < matches.size(); i++) instanceCount += matches[i].meshIndex != i ? 1 : 0;
+    EXPECT_EQ(instanceCount, kMeshCount - kMeshCount / 10);
+}
+} // namespace Falcor
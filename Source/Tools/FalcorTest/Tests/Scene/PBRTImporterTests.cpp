@@ -0,0 +1,179 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Utils/Settings.h"
+
+#include <pybind11/pytypes.h>
+
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+const std::filesystem::path kSceneDirectory = "test_pbrt_import";
+const uint32_t kPartCount = 4;
+
+const char kMainFile[] = R"(
+LookAt 0 0 10  0 0 0  0 1 0
+Camera "perspective" "float fov" [ 45 ]
+WorldBegin
+LightSource "distant" "point3 from" [ 0 0 0 ] "point3 to" [ 0 0 -1 ] "rgb L" [ 1 1 1 ]
+MakeNamedMaterial "shared" "string type" [ "diffuse" ] "rgb reflectance" [ 0.5 0.5 0.5 ]
+Include "defs.pbrt"
+Material "conductor"
+AttributeBegin
+    Translate 0 0 -1
+    Shape "trianglemesh" "integer indices" [ 0 1 2 ] "point3 P" [ 0 0 0  2 0 0  0 2 0 ]
+AttributeEnd
+Import "part0.pbrt"
+NamedMaterial "shared"
+Shape "sphere" "float radius" [ 0.5 ]
+Import "part1.pbrt"
+Import "part2.pbrt"
+)";
+
+const char kDefsFile[] = R"(
+ObjectBegin "tri"
+    Material "diffuse" "rgb reflectance" [ 0.1 0.7 0.1 ]
+    Shape "trianglemesh" "integer indices" [ 0 1 2 ] "point3 P" [ 0 0 0  1 0 0  0 1 0 ]
+    Shape "trianglemesh" "integer indices" [ 0 1 2 1 3 2 ] "point3 P" [ 0 0 1  1 0 1  0 1 1  1 1 1 ]
+ObjectEnd
+)";
+
+/// Generate an imported file with its own materials, an area light and instances of an inherited object.
+std::string generatePart(uint32_t index)
+{
+    return fmt::format(
+        R"(
+AttributeBegin
+    Translate {0} 0 0
+    Material "diffuse" "rgb reflectance" [ 0.{0} 0.2 0.3 ]
+    Shape "trianglemesh" "integer indices" [ 0 1 2 ] "point3 P" [ 0 0 0  1 0 0  0 1 0 ]
+    MakeNamedMaterial "part{0}" "string type" [ "coateddiffuse" ] "rgb reflectance" [ 0.3 0.{0} 0.2 ]
+    NamedMaterial "part{0}"
+    Shape "disk" "float radius" [ 0.25 ]
+    NamedMaterial "shared"
+    Shape "trianglemesh" "integer indices" [ 0 1 2 ] "point3 P" [ 0 0 2  1 0 2  0 1 2 ]
+    ObjectInstance "tri"
+    Translate 0 2 0
+    ObjectInstance "tri"
+    AttributeBegin
+        AreaLightSource "diffuse" "rgb L" [ {1} 1 1 ]
+        Shape "trianglemesh" "integer indices" [ 0 1 2 ] "point3 P" [ 0 0 3  1 0 3  0 1 3 ]
+    AttributeEnd
+{2}
+AttributeEnd
+)",
+        index,
+        index + 1,
+        // The last part is imported from within another imported file.
+        index == kPartCount - 2 ? fmt::format("Import \"part{}.pbrt\"", kPartCount - 1) : ""
+    );
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& contents)
+{
+    std::ofstream stream(path, std::ios::trunc);
+    stream << contents;
+}
+
+ref<Scene> importScene(ref<Device> pDevice, const std::filesystem::path& path, bool parallelImport)
+{
+    pybind11::dict importerOptions;
+    importerOptions["parallelImport"] = parallelImport;
+    pybind11::dict options;
+    options["PBRTImporter"] = importerOptions;
+
+    Settings settings;
+    settings.addOptions(options);
+    SceneBuilder builder(pDevice, path, settings);
+    return builder.getScene();
+}
+} // namespace
+
+GPU_TEST(PBRTImporter_ParallelImport)
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+
+    std::filesystem::remove_all(kSceneDirectory);
+    std::filesystem::create_directories(kSceneDirectory);
+    writeFile(kSceneDirectory / "main.pbrt", kMainFile);
+    writeFile(kSceneDirectory / "defs.pbrt", kDefsFile);
+    for (uint32_t i = 0; i < kPartCount; ++i)
+        writeFile(kSceneDirectory / fmt::format("part{}.pbrt", i), generatePart(i));
+
+    // Importing files in parallel must produce the same scene as importing them one after another.
+    const auto path = std::filesystem::absolute(kSceneDirectory / "main.pbrt");
+    ref<Scene> pSerial = importScene(ctx.getDevice(), path, false);
+    ref<Scene> pParallel = importScene(ctx.getDevice(), path, true);
+    std::filesystem::remove_all(kSceneDirectory);
+
+    EXPECT_EQ(pSerial->getLightCount(), 1);
+
+    ASSERT_EQ(pParallel->getMaterialCount(), pSerial->getMaterialCount());
+    uint32_t emissiveCount = 0;
+    for (uint32_t i = 0; i < pSerial->getMaterialCount(); ++i)
+    {
+        const auto& pSerialMaterial = pSerial->getMaterial(MaterialID(i));
+        const auto& pParallelMaterial = pParallel->getMaterial(MaterialID(i));
+        EXPECT_EQ(pParallelMaterial->getName(), pSerialMaterial->getName());
+        EXPECT(pParallelMaterial->getType() == pSerialMaterial->getType());
+        EXPECT_EQ(pParallelMaterial->isEmissive(), pSerialMaterial->isEmissive());
+        if (pSerialMaterial->isEmissive())
+            emissiveCount++;
+    }
+    EXPECT_EQ(emissiveCount, kPartCount);
+
+    ASSERT_EQ(pParallel->getMeshCount(), pSerial->getMeshCount());
+    for (uint32_t i = 0; i < pSerial->getMeshCount(); ++i)
+    {
+        const auto& serialMesh = pSerial->getMesh(MeshID(i));
+        const auto& parallelMesh = pParallel->getMesh(MeshID(i));
+        EXPECT_EQ(parallelMesh.vbOffset, serialMesh.vbOffset);
+        EXPECT_EQ(parallelMesh.ibOffset, serialMesh.ibOffset);
+        EXPECT_EQ(parallelMesh.vertexCount, serialMesh.vertexCount);
+        EXPECT_EQ(parallelMesh.indexCount, serialMesh.indexCount);
+        EXPECT_EQ(parallelMesh.materialID, serialMesh.materialID);
+    }
+
+    ASSERT_EQ(pParallel->getGeometryInstanceCount(), pSerial->getGeometryInstanceCount());
+    for (uint32_t i = 0; i < pSerial->getGeometryInstanceCount(); ++i)
+    {
+        const auto& serialInstance = pSerial->getGeometryInstance(i);
+        const auto& parallelInstance = pParallel->getGeometryInstance(i);
+        EXPECT_EQ(parallelInstance.flags, serialInstance.flags);
+        EXPECT_EQ(parallelInstance.globalMatrixID, serialInstance.globalMatrixID);
+        EXPECT_EQ(parallelInstance.materialID, serialInstance.materialID);
+        EXPECT_EQ(parallelInstance.geometryID, serialInstance.geometryID);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,308 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/PLYReader.h"
+#include "Utils/Threading.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const char kAsciiQuad[] =
+    "ply\n"
+    "format ascii 1.0\n"
+    "comment quad with texture coordinates\n"
+    "element vertex 4\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "property float u\n"
+    "property float v\n"
+    "element face 1\n"
+    "property list uchar int vertex_indices\n"
+    "end_header\n"
+    "0 0 0 0 0\n"
+    "1 0 0 1 0\n"
+    "1 1 0 1 1\n"
+    "0 1 0 0 1\n"
+    "4 0 1 2 3\n";
+
+/// Append values to a string, optionally swapping each value to big endian byte order.
+template<typename T, size_t N>
+void append(std::string& str, const T (&values)[N], bool bigEndian = false)
+{
+    for (const T& value : values)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        if (bigEndian)
+            std::reverse(bytes, bytes + sizeof(T));
+        str.append(bytes, sizeof(T));
+    }
+}
+
+/// Generate a binary PLY grid with positions, normals and texture coordinates.
+std::string generateGrid(uint32_t resolution, bool bigEndian = false)
+{
+    const uint32_t vertexCount = (resolution + 1) * (resolution + 1);
+    const uint32_t faceCount = resolution * resolution * 2;
+
+    std::string ply = fmt::format(
+        "ply\n"
+        "format {} 1.0\n"
+        "element vertex {}\n"
+        "property float x\nproperty float y\nproperty float z\n"
+        "property float nx\nproperty float ny\nproperty float nz\n"
+        "property float u\nproperty float v\n"
+        "element face {}\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n",
+        bigEndian ? "binary_big_endian" : "binary_little_endian", vertexCount, faceCount
+    );
+
+    for (uint32_t y = 0; y <= resolution; ++y)
+    {
+        for (uint32_t x = 0; x <= resolution; ++x)
+        {
+            float u = (float)x / resolution, v = (float)y / resolution;
+            float values[8] = {u, 0.1f * std::sin(8.f * u) * std::cos(8.f * v), v, 0.f, 1.f, 0.f, u, v};
+            append(ply, values, bigEndian);
+        }
+    }
+
+    for (uint32_t y = 0; y < resolution; ++y)
+    {
+        for (uint32_t x = 0; x < resolution; ++x)
+        {
+            int32_t i = y * (resolution + 1) + x;
+            int32_t triangles[2][3] = {{i, i + 1, i + (int32_t)resolution + 2}, {i, i + (int32_t)resolution + 2, i + (int32_t)resolution + 1}};
+            for (const auto& triangle : triangles)
+            {
+                const uint8_t count[1] = {3};
+                append(ply, count);
+                append(ply, triangle, bigEndian);
+            }
+        }
+    }
+
+    return ply;
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& data)
+{
+    std::ofstream fs(path, std::ios_base::binary);
+    fs.write(data.data(), data.size());
+}
+
+void writeGzipFile(const std::filesystem::path& path, const std::string& data)
+{
+    gzFile file = gzopen(path.string().c_str(), "wb");
+    FALCOR_ASSERT(file);
+    gzwrite(file, data.data(), (unsigned)data.size());
+    gzclose(file);
+}
+
+void expectEqual(CPUUnitTestContext& ctx, const TriangleMesh& mesh, const TriangleMesh& reference)
+{
+    ASSERT_EQ(mesh.getVertices().size(), reference.getVertices().size());
+    ASSERT(mesh.getIndices() == reference.getIndices());
+    for (size_t i = 0; i < mesh.getVertices().size(); ++i)
+    {
+        const auto& vertex = mesh.getVertices()[i];
+        const auto& refVertex = reference.getVertices()[i];
+        EXPECT(all(vertex.position == refVertex.position) && all(vertex.normal == refVertex.normal) && all(vertex.texCoord == refVertex.texCoord))
+            << "vertex " << i;
+    }
+}
+} // namespace
+
+CPU_TEST(PLYReader_Ascii)
+{
+    TriangleMesh::VertexList vertices;
+    TriangleMesh::IndexList indices;
+    PLYReader::readFromMemory(kAsciiQuad, std::strlen(kAsciiQuad), vertices, indices);
+
+    // The quad is triangulated and un-indexed to get facet normals.
+    ASSERT_EQ(indices.size(), 6u);
+    ASSERT_EQ(vertices.size(), 6u);
+    const uint32_t expected[6] = {0, 1, 2, 0, 2, 3};
+    const float3 positions[4] = {float3(0, 0, 0), float3(1, 0, 0), float3(1, 1, 0), float3(0, 1, 0)};
+    for (size_t i = 0; i < 6; ++i)
+    {
+        const auto& vertex = vertices[indices[i]];
+        EXPECT(all(vertex.position == positions[expected[i]]));
+        EXPECT(all(vertex.normal == float3(0, 0, 1)));
+        // Texture coordinates are flipped to match the ASSIMP importer.
+        EXPECT(all(vertex.texCoord == float2(positions[expected[i]].x, 1.f - positions[expected[i]].y)));
+    }
+}
+
+CPU_TEST(PLYReader_Binary)
+{
+    std::string ply = generateGrid(4);
+
+    TriangleMesh::VertexList vertices;
+    TriangleMesh::IndexList indices;
+    PLYReader::readFromMemory(ply.data(), ply.size(), vertices, indices);
+    EXPECT_EQ(vertices.size(), 25u);
+    EXPECT_EQ(indices.size(), 4u * 4 * 2 * 3);
+    EXPECT(vertices[6].position.x == 0.25f && vertices[6].position.z == 0.25f);
+    EXPECT(all(vertices[6].normal == float3(0, 1, 0)));
+
+    // Truncated data must be reported.
+    bool threw = false;
+    try
+    {
+        PLYReader::readFromMemory(ply.data(), ply.size() - 1, vertices, indices);
+    }
+    catch (const RuntimeError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+}
+
+CPU_TEST(PLYReader_BigEndian)
+{
+    std::string littleEndian = generateGrid(8);
+    std::string bigEndian = generateGrid(8, true);
+
+    TriangleMesh::VertexList refVertices, vertices;
+    TriangleMesh::IndexList refIndices, indices;
+    PLYReader::readFromMemory(littleEndian.data(), littleEndian.size(), refVertices, refIndices);
+    PLYReader::readFromMemory(bigEndian.data(), bigEndian.size(), vertices, indices);
+    expectEqual(ctx, *TriangleMesh::create(vertices, indices), *TriangleMesh::create(refVertices, refIndices));
+}
+
+CPU_TEST(PLYReader_Gzip)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_ply_reader.ply");
+    const std::filesystem::path gzPath = std::filesystem::absolute("test_ply_reader.ply.gz");
+    writeFile(path, generateGrid(16, true));
+    writeGzipFile(gzPath, generateGrid(16, true));
+
+    auto pReference = PLYReader::createTriangleMesh(path);
+    auto pMesh = PLYReader::createTriangleMesh(gzPath);
+    ASSERT(pReference);
+    ASSERT(pMesh);
+    EXPECT_EQ(pMesh->getIndices().size(), 16u * 16 * 2 * 3);
+    expectEqual(ctx, *pMesh, *pReference);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(gzPath);
+}
+
+CPU_TEST(PLYReader_MatchesAssimp)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_ply_reader.ply");
+    writeFile(path, generateGrid(16));
+
+    auto pReference = TriangleMesh::createFromFile(path);
+    auto pMesh = PLYReader::createTriangleMesh(path);
+    ASSERT(pReference);
+    ASSERT(pMesh);
+
+    // Compare triangle by triangle as ASSIMP may not preserve the vertex indexing.
+    const auto& refIndices = pReference->getIndices();
+    const auto& indices = pMesh->getIndices();
+    ASSERT_EQ(refIndices.size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const auto& refVertex = pReference->getVertices()[refIndices[i]];
+        const auto& vertex = pMesh->getVertices()[indices[i]];
+        EXPECT(all(refVertex.position == vertex.position)) << "index " << i;
+        EXPECT(all(refVertex.normal == vertex.normal)) << "index " << i;
+        EXPECT(all(refVertex.texCoord == vertex.texCoord)) << "index " << i;
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_BENCHMARK(PLYReader_LoadBenchmark)
+{
+    const std::filesystem::path directory = std::filesystem::absolute("test_ply_corpus");
+    const size_t kFileCount = 512;
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::filesystem::path> paths(kFileCount);
+    for (size_t i = 0; i < kFileCount; ++i)
+    {
+        paths[i] = directory / fmt::format("mesh{}.ply", i);
+        writeFile(paths[i], generateGrid(16 + (uint32_t)(i % 8) * 8));
+    }
+
+    size_t assimpTriangles = 0;
+    ctx.measure(
+        "Assimp",
+        [&]()
+        {
+            assimpTriangles = 0;
+            for (const auto& path : paths)
+            {
+                auto pMesh = TriangleMesh::createFromFile(path);
+                assimpTriangles += pMesh ? pMesh->getIndices().size() / 3 : 0;
+            }
+        },
+        Throughput::items(kFileCount)
+    );
+
+    std::vector<ref<TriangleMesh>> meshes(kFileCount);
+    ctx.measure(
+        "PLYReader",
+        [&]()
+        {
+            Threading::parallelFor(
+                0, kFileCount,
+                [&](size_t first, size_t last)
+                {
+                    for (size_t i = first; i < last; ++i)
+                        meshes[i] = PLYReader::createTriangleMesh(paths[i]);
+                },
+                1
+            );
+        },
+        Throughput::items(kFileCount)
+    );
+
+    size_t plyTriangles = 0;
+    for (const auto& pMesh : meshes)
+        plyTriangles += pMesh ? pMesh->getIndices().size() / 3 : 0;
+    EXPECT_EQ(assimpTriangles, plyTriangles);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SparseBrickSet/SDFSBS.h"
+#include "Scene/SDFs/SparseBrickSet/SDFSBSBuilder.h"
+#include "Utils/Math/AABB.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kGridWidth = 60;
+
+/// Create a normalized signed distance field of a sphere.
+std::vector<int8_t> createSphereSDField(uint32_t gridWidth, float radius)
+{
+    const uint32_t gridWidthInValues = gridWidth + 1;
+    std::vector<int8_t> sdField(gridWidthInValues * gridWidthInValues * gridWidthInValues);
+    for (uint32_t z = 0; z < gridWidthInValues; z++)
+    {
+        for (uint32_t y = 0; y < gridWidthInValues; y++)
+        {
+            for (uint32_t x = 0; x < gridWidthInValues; x++)
+            {
+                float3 p = float3(float(x), float(y), float(z)) / float(gridWidth) - 0.5f;
+                float d = std::clamp((length(p) - radius) * 2.0f * gridWidth, -1.0f, 1.0f);
+                sdField[x + gridWidthInValues * (y + gridWidthInValues * z)] = int8_t(std::lround(d * 127.0f));
+            }
+        }
+    }
+    return sdField;
+}
+
+/// Read back a buffer of AABBs.
+std::vector<AABB> readAABBs(const ref<Buffer>& pBuffer, uint32_t count)
+{
+    std::vector<AABB> aabbs(count);
+    const AABB* pData = reinterpret_cast<const AABB*>(pBuffer->map(Buffer::MapType::Read));
+    std::memcpy(aabbs.data(), pData, count * sizeof(AABB));
+    pBuffer->unmap();
+    return aabbs;
+}
+
+void testBuilderMatchesGPU(GPUUnitTestContext& ctx, uint32_t brickWidth, bool compressed)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    ref<SDFSBS> pGPUGrid = SDFSBS::create(pDevice, brickWidth, compressed);
+    pGPUGrid->setCpuBuildEnabled(false);
+    pGPUGrid->generateCheeseValues(kGridWidth, 1);
+    pGPUGrid->createResources(pRenderContext);
+
+    ref<SDFSBS> pCPUGrid = SDFSBS::create(pDevice, brickWidth, compressed);
+    pCPUGrid->generateCheeseValues(kGridWidth, 1);
+    pCPUGrid->createResources(pRenderContext);
+
+    const uint32_t brickCount = pGPUGrid->getAABBCount();
+    ASSERT_EQ(pCPUGrid->getAABBCount(), brickCount);
+    ASSERT_GT(brickCount, 0u);
+
+    // Indirection.
+    ASSERT_EQ(pCPUGrid->getIndirectionTexture()->getWidth(), pGPUGrid->getIndirectionTexture()->getWidth());
+    EXPECT(
+        pRenderContext->readTextureSubresource(pCPUGrid->getIndirectionTexture().get(), 0) ==
+        pRenderContext->readTextureSubresource(pGPUGrid->getIndirectionTexture().get(), 0)
+    );
+
+    // AABBs.
+    std::vector<AABB> cpuAABBs = readAABBs(pCPUGrid->getAABBBuffer(), brickCount);
+    std::vector<AABB> gpuAABBs = readAABBs(pGPUGrid->getAABBBuffer(), brickCount);
+    for (uint32_t i = 0; i < brickCount; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            EXPECT_LE(std::abs(cpuAABBs[i].minPoint[j] - gpuAABBs[i].minPoint[j]), 1e-6f) << "brick " << i;
+            EXPECT_LE(std::abs(cpuAABBs[i].maxPoint[j] - gpuAABBs[i].maxPoint[j]), 1e-6f) << "brick " << i;
+        }
+    }
+
+    // Bricks. Only compare the texels of the used bricks, the rest of the GPU brick texture is undefined.
+    const ref<Texture>& pCPUBricks = pCPUGrid->getBrickTexture();
+    const ref<Texture>& pGPUBricks = pGPUGrid->getBrickTexture();
+    ASSERT_EQ(pCPUBricks->getWidth(), pGPUBricks->getWidth());
+    ASSERT_EQ(pCPUBricks->getHeight(), pGPUBricks->getHeight());
+    std::vector<uint8_t> cpuBricks = pRenderContext->readTextureSubresource(pCPUBricks.get(), 0);
+    std::vector<uint8_t> gpuBricks = pRenderContext->readTextureSubresource(pGPUBricks.get(), 0);
+    ASSERT_EQ(cpuBricks.size(), gpuBricks.size());
+
+    const uint32_t blockWidth = compressed ? 4 : 1;
+    const uint32_t bytesPerBlock = compressed ? 8 : 1;
+    const uint32_t brickWidthInValues = brickWidth + 1;
+    const uint32_t bricksAlongX = pCPUBricks->getWidth() / (brickWidthInValues * brickWidthInValues);
+    const size_t rowPitch = size_t(pCPUBricks->getWidth() / blockWidth) * bytesPerBlock;
+    const size_t brickRowSize = size_t(brickWidthInValues * brickWidthInValues / blockWidth) * bytesPerBlock;
+    for (uint32_t brickID = 0; brickID < brickCount; brickID++)
+    {
+        uint32_t blockX = (brickID % bricksAlongX) * brickWidthInValues * brickWidthInValues / blockWidth;
+        uint32_t blockY = (brickID / bricksAlongX) * brickWidthInValues / blockWidth;
+        for (uint32_t row = 0; row < brickWidthInValues / blockWidth; row++)
+        {
+            size_t offset = (blockY + row) * rowPitch + blockX * bytesPerBlock;
+            EXPECT(std::memcmp(cpuBricks.data() + offset, gpuBricks.data() + offset, brickRowSize) == 0) << "brick " << brickID;
+        }
+    }
+}
+} // namespace
+
+GPU_TEST(SDFSBSBuilder_MatchesGPU)
+{
+    testBuilderMatchesGPU(ctx, 7, false);
+    testBuilderMatchesGPU(ctx, 8, false);
+}
+
+GPU_TEST(SDFSBSBuilder_MatchesGPUCompressed)
+{
+    testBuilderMatchesGPU(ctx, 7, true);
+}
+
+CPU_TEST(SDFSBSBuilder_File)
+{
+    const std::vector<int8_t> sdField = createSphereSDField(kGridWidth, 0.3f);
+    const SDFSBSBrickData data = SDFSBSBuilder::build(sdField, kGridWidth, 7, true);
+
+    EXPECT_EQ(data.virtualBricksPerAxis, 9u);
+    EXPECT_GT(data.brickCount, 0u);
+    EXPECT_LT(data.brickCount, 9u * 9u * 9u);
+    EXPECT_EQ(data.sdFieldHash, SDFSBSBuilder::hashSDField(sdField));
+
+    // Every brick is referenced exactly once.
+    std::vector<uint32_t> references(data.brickCount, 0);
+    for (uint32_t brickID : data.indirection)
+    {
+        if (brickID != std::numeric_limits<uint32_t>::max())
+            references[brickID]++;
+    }
+    for (uint32_t count : references)
+        EXPECT_EQ(count, 1u);
+
+    const auto path = getRuntimeDirectory() / "test_sdfsbs_builder.sbs";
+    SDFSBSBuilder::writeToFile(path, data);
+
+    SDFSBSBrickData readData;
+    ASSERT(SDFSBSBuilder::readFromFile(path, readData));
+    EXPECT_EQ(readData.gridWidth, data.gridWidth);
+    EXPECT_EQ(readData.brickWidth, data.brickWidth);
+    EXPECT_EQ(readData.compressed, data.compressed);
+    EXPECT_EQ(readData.sdFieldHash, data.sdFieldHash);
+    EXPECT_EQ(readData.brickCount, data.brickCount);
+    EXPECT(readData.bricksPerAxis == data.bricksPerAxis);
+    EXPECT(readData.brickTextureDimensions == data.brickTextureDimensions);
+    EXPECT(readData.indirection == data.indirection);
+    EXPECT(readData.brickTexels == data.brickTexels);
+    ASSERT_EQ(readData.brickAABBs.size(), data.brickAABBs.size());
+    EXPECT(std::memcmp(readData.brickAABBs.data(), data.brickAABBs.data(), data.brickAABBs.size() * sizeof(AABB)) == 0);
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
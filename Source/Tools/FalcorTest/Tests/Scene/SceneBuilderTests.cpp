@@ -0,0 +1,334 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/SceneBuilder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMaterialCount = 3;
+
+struct MeshData
+{
+    std::string name;
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+    uint32_t materialIndex = 0;
+};
+
+/// Creates height field grids of varying resolution. Every other mesh uses face-varying texture coordinates.
+std::vector<MeshData> createMeshData(uint32_t meshCount)
+{
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<MeshData> meshData(meshCount);
+    for (uint32_t i = 0; i < meshCount; ++i)
+    {
+        auto& data = meshData[i];
+        const uint32_t resolution = 2 + i % 13;
+
+        data.name = fmt::format("mesh{}", i);
+        data.materialIndex = i % kMaterialCount;
+        for (uint32_t y = 0; y <= resolution; ++y)
+        {
+            for (uint32_t x = 0; x <= resolution; ++x)
+            {
+                data.positions.push_back(float3((float)x, 0.25f * u(rng), (float)y));
+                data.normals.push_back(normalize(float3(u(rng) - 0.5f, 1.f, u(rng) - 0.5f)));
+            }
+        }
+        for (uint32_t y = 0; y < resolution; ++y)
+        {
+            for (uint32_t x = 0; x < resolution; ++x)
+            {
+                uint32_t v = y * (resolution + 1) + x;
+                for (uint32_t index : {v, v + resolution + 1, v + 1, v + 1, v + resolution + 1, v + resolution + 2})
+                    data.indices.push_back(index);
+            }
+        }
+        const size_t texCrdCount = i % 2 == 0 ? data.positions.size() : data.indices.size();
+        for (size_t j = 0; j < texCrdCount; ++j)
+            data.texCrds.push_back(float2(u(rng), u(rng)));
+    }
+    return meshData;
+}
+
+/// Builds a scene with one instance per mesh, adding the meshes either in one batch or one at a time.
+ref<Scene> buildScene(ref<Device> pDevice, const std::vector<MeshData>& meshData, bool batched, std::vector<MeshID>& meshIDs)
+{
+    SceneBuilder builder(pDevice, Settings());
+
+    std::vector<ref<Material>> materials;
+    for (uint32_t i = 0; i < kMaterialCount; ++i)
+        materials.push_back(StandardMaterial::create(pDevice, fmt::format("material{}", i)));
+
+    std::vector<SceneBuilder::Mesh> meshes(meshData.size());
+    for (size_t i = 0; i < meshData.size(); ++i)
+    {
+        const auto& data = meshData[i];
+        auto& mesh = meshes[i];
+        mesh.name = data.name;
+        mesh.faceCount = (uint32_t)data.indices.size() / 3;
+        mesh.vertexCount = (uint32_t)data.positions.size();
+        mesh.indexCount = (uint32_t)data.indices.size();
+        mesh.pIndices = data.indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = materials[data.materialIndex];
+        mesh.positions = {data.positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {data.normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.texCrds = {
+            data.texCrds.data(),
+            data.texCrds.size() == data.positions.size() ? SceneBuilder::Mesh::AttributeFrequency::Vertex
+                                                         : SceneBuilder::Mesh::AttributeFrequency::FaceVarying};
+    }
+
+    meshIDs.clear();
+    if (batched)
+    {
+        meshIDs = builder.addMeshes(meshes);
+    }
+    else
+    {
+        for (const auto& mesh : meshes)
+            meshIDs.push_back(builder.addMesh(mesh));
+    }
+
+    for (size_t i = 0; i < meshIDs.size(); ++i)
+    {
+        float4x4 transform = math::matrixFromTranslation(float3(0.f, 0.f, 20.f * (float)i));
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{meshData[i].name, transform, float4x4::identity(), float4x4::identity()});
+        builder.addMeshInstance(nodeID, meshIDs[i]);
+    }
+
+    return builder.getScene();
+}
+
+std::vector<uint8_t> readBuffer(const ref<Buffer>& pBuffer)
+{
+    const uint8_t* pData = reinterpret_cast<const uint8_t*>(pBuffer->map(Buffer::MapType::Read));
+    std::vector<uint8_t> data(pData, pData + pBuffer->getSize());
+    pBuffer->unmap();
+    return data;
+}
+
+struct InstanceVertices
+{
+    float3 centroid = float3(0.f);
+    std::vector<float3> positions;
+};
+
+/// Returns the world-space vertex positions of all triangle mesh instances in the scene.
+std::vector<InstanceVertices> getInstanceVertices(const ref<Scene>& pScene)
+{
+    // The static vertex data is the first vertex buffer of the mesh VAO.
+    const auto vertexData = readBuffer(pScene->getMeshVao()->getVertexBuffer(0));
+    const auto* pVertices = reinterpret_cast<const PackedStaticVertexData*>(vertexData.data());
+    const auto& globalMatrices = pScene->getAnimationController()->getGlobalMatrices();
+
+    std::vector<InstanceVertices> instances;
+    for (uint32_t i = 0; i < pScene->getGeometryInstanceCount(); ++i)
+    {
+        const GeometryInstanceData& instance = pScene->getGeometryInstance(i);
+        if (instance.getType() != GeometryType::TriangleMesh)
+            continue;
+
+        const MeshDesc& mesh = pScene->getMesh(MeshID(instance.geometryID));
+        const float4x4& transform = globalMatrices[instance.globalMatrixID];
+        auto& result = instances.emplace_back();
+        for (uint32_t j = 0; j < mesh.vertexCount; ++j)
+        {
+            float3 p = transformPoint(transform, pVertices[mesh.vbOffset + j].unpack().position);
+            result.positions.push_back(p);
+            result.centroid += p / (float)mesh.vertexCount;
+        }
+    }
+    return instances;
+}
+
+uint32_t getAnimatedMeshCount(const ref<Scene>& pScene)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < pScene->getMeshCount(); ++i)
+        count += pScene->getMesh(MeshID(i)).isAnimated() ? 1 : 0;
+    return count;
+}
+} // namespace
+
+GPU_TEST(SceneBuilder_AddMeshes)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const auto meshData = createMeshData(200);
+
+    // Adding meshes in a batch processes them in parallel, which must give the same result as adding them one at a time.
+    std::vector<MeshID> sequentialIDs, batchedIDs;
+    ref<Scene> pSequential = buildScene(pDevice, meshData, false, sequentialIDs);
+    ref<Scene> pBatched = buildScene(pDevice, meshData, true, batchedIDs);
+
+    ASSERT_EQ(batchedIDs.size(), sequentialIDs.size());
+    for (size_t i = 0; i < sequentialIDs.size(); ++i)
+    {
+        EXPECT_EQ(sequentialIDs[i].get(), i);
+        EXPECT_EQ(batchedIDs[i].get(), sequentialIDs[i].get());
+    }
+
+    ASSERT_EQ(pBatched->getMeshCount(), pSequential->getMeshCount());
+    for (uint32_t i = 0; i < pSequential->getMeshCount(); ++i)
+    {
+        const MeshDesc& sequentialMesh = pSequential->getMesh(MeshID(i));
+        const MeshDesc& batchedMesh = pBatched->getMesh(MeshID(i));
+        EXPECT(std::memcmp(&batchedMesh, &sequentialMesh, sizeof(MeshDesc)) == 0) << "mesh " << i;
+    }
+
+    // Compare the vertex and index data of the global scene buffers.
+    const auto& pSequentialVao = pSequential->getMeshVao();
+    const auto& pBatchedVao = pBatched->getMeshVao();
+    ASSERT(pSequentialVao && pBatchedVao);
+    ASSERT_EQ(pBatchedVao->getVertexBuffersCount(), pSequentialVao->getVertexBuffersCount());
+    for (uint32_t i = 0; i < pSequentialVao->getVertexBuffersCount(); ++i)
+    {
+        const auto& pSequentialVB = pSequentialVao->getVertexBuffer(i);
+        const auto& pBatchedVB = pBatchedVao->getVertexBuffer(i);
+        ASSERT_EQ(pBatchedVB == nullptr, pSequentialVB == nullptr);
+        if (pSequentialVB)
+            EXPECT(readBuffer(pBatchedVB) == readBuffer(pSequentialVB)) << "vertex buffer " << i;
+    }
+    ASSERT_EQ(pBatchedVao->getIndexBuffer() == nullptr, pSequentialVao->getIndexBuffer() == nullptr);
+    if (pSequentialVao->getIndexBuffer())
+        EXPECT(readBuffer(pBatchedVao->getIndexBuffer()) == readBuffer(pSequentialVao->getIndexBuffer()));
+}
+
+GPU_TEST(SceneBuilder_DetectMeshInstancing)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Two grids of different resolution with per-vertex texture coordinates. All meshes share a material so that only the
+    // geometry decides the matching.
+    auto meshData = createMeshData(3);
+    MeshData grid = meshData[0];
+    MeshData other = meshData[2];
+    other.materialIndex = grid.materialIndex;
+
+    const float4x4 rotation = mul(math::matrixFromTranslation(float3(3.f, 1.f, -2.f)), math::matrixFromRotation(0.7f, normalize(float3(1.f, 2.f, 3.f))));
+    MeshData rotated = grid;
+    for (auto& p : rotated.positions)
+        p = transformPoint(rotation, p);
+    for (auto& n : rotated.normals)
+        n = normalize(transformVector(rotation, n));
+
+    // 0: grid, 1: rigid transform of 0, 2: unique, 3: identical to 0, 4: identical to 0 but vertex-animated.
+    meshData = {grid, rotated, other, grid, grid};
+    const MeshID animatedMeshID{4};
+
+    auto build = [&](SceneBuilder::Flags flags)
+    {
+        SceneBuilder builder(pDevice, Settings(), flags | SceneBuilder::Flags::DontOptimizeGraph);
+        auto pMaterial = StandardMaterial::create(pDevice, "material");
+        for (size_t i = 0; i < meshData.size(); ++i)
+        {
+            const auto& data = meshData[i];
+            SceneBuilder::Mesh mesh;
+            mesh.name = fmt::format("mesh{}", i);
+            mesh.faceCount = (uint32_t)data.indices.size() / 3;
+            mesh.vertexCount = (uint32_t)data.positions.size();
+            mesh.indexCount = (uint32_t)data.indices.size();
+            mesh.pIndices = data.indices.data();
+            mesh.topology = Vao::Topology::TriangleList;
+            mesh.pMaterial = pMaterial;
+            mesh.positions = {data.positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+            mesh.normals = {data.normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+            mesh.texCrds = {data.texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+            MeshID meshID = builder.addMesh(mesh);
+
+            float4x4 transform = math::matrixFromTranslation(float3(0.f, 0.f, 20.f * (float)i));
+            NodeID nodeID = builder.addNode(SceneBuilder::Node{mesh.name, transform, float4x4::identity(), float4x4::identity()});
+            builder.addMeshInstance(nodeID, meshID);
+        }
+
+        // The vertex cache keeps the mesh in place. Its mesh ID must follow the mesh when duplicates are removed.
+        CachedMesh cachedMesh;
+        cachedMesh.meshID = animatedMeshID;
+        cachedMesh.timeSamples = {0.0, 1.0};
+        std::vector<PackedStaticVertexData> vertices(meshData[animatedMeshID.get()].positions.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const auto& data = meshData[animatedMeshID.get()];
+            vertices[i].pack(StaticVertexData{data.positions[i], data.normals[i], float4(1.f, 0.f, 0.f, 1.f), data.texCrds[i], 0.f});
+        }
+        cachedMesh.vertexData = {vertices, vertices};
+        builder.setCachedMeshes({cachedMesh});
+
+        return builder.getScene();
+    };
+
+    ref<Scene> pReference = build(SceneBuilder::Flags::Default);
+    ref<Scene> pScene = build(SceneBuilder::Flags::DetectMeshInstancing);
+
+    // Meshes 1 and 3 are replaced by instances of mesh 0. The animated mesh is kept and remapped.
+    EXPECT_EQ(pReference->getMeshCount(), 5u);
+    EXPECT_EQ(pScene->getMeshCount(), 3u);
+    EXPECT_EQ(getAnimatedMeshCount(pReference), 1u);
+    EXPECT_EQ(getAnimatedMeshCount(pScene), 1u);
+
+    // Only the rigid transform needs a new child node; the identical mesh is instanced in its own node.
+    const size_t referenceNodeCount = pReference->getAnimationController()->getGlobalMatrices().size();
+    const size_t nodeCount = pScene->getAnimationController()->getGlobalMatrices().size();
+    EXPECT_EQ(nodeCount, referenceNodeCount + 1);
+
+    // Every instance must end up at the same world-space vertex positions as without instancing.
+    const auto referenceInstances = getInstanceVertices(pReference);
+    const auto instances = getInstanceVertices(pScene);
+    ASSERT_EQ(referenceInstances.size(), meshData.size());
+    ASSERT_EQ(instances.size(), referenceInstances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const auto& instance = instances[i];
+        auto it = std::min_element(
+            referenceInstances.begin(),
+            referenceInstances.end(),
+            [&](const InstanceVertices& a, const InstanceVertices& b)
+            { return length(a.centroid - instance.centroid) < length(b.centroid - instance.centroid); }
+        );
+        EXPECT_LT(length(it->centroid - instance.centroid), 1e-3f) << "instance " << i;
+        ASSERT_EQ(it->positions.size(), instance.positions.size()) << "instance " << i;
+        for (size_t j = 0; j < instance.positions.size(); ++j)
+        {
+            EXPECT_LT(length(it->positions[j] - instance.positions[j]), 1e-3f) << "instance " << i << " vertex " << j;
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Platform/OS.h"
+#include "Scene/SceneCache.h"
+#include "Scene/Material/StandardMaterial.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMeshCount = 16;
+const uint32_t kGridResolution = 255; // 65536 vertices per mesh.
+const uint32_t kMaterialCount = 64;
+
+/// Creates scene data with height field grid meshes, similar to what the importers produce for a large asset.
+Scene::SceneData createSceneData(ref<Device> pDevice)
+{
+    Scene::SceneData sceneData;
+    sceneData.path = "SceneCacheBenchmark";
+    sceneData.sceneGraph.push_back(Scene::Node("root", NodeID::Invalid(), float4x4::identity(), float4x4::identity(), float4x4::identity()));
+
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+    for (uint32_t i = 0; i < kMaterialCount; ++i)
+    {
+        auto pMaterial = StandardMaterial::create(pDevice, fmt::format("material{}", i));
+        pMaterial->setBaseColor(float4((float)i / kMaterialCount, 0.5f, 0.25f, 1.f));
+        sceneData.pMaterials->addMaterial(pMaterial);
+    }
+
+    const uint32_t vertexCount = (kGridResolution + 1) * (kGridResolution + 1);
+    const uint32_t indexCount = kGridResolution * kGridResolution * 6;
+    for (uint32_t meshIndex = 0; meshIndex < kMeshCount; ++meshIndex)
+    {
+        MeshDesc meshDesc = {};
+        meshDesc.vbOffset = (uint32_t)sceneData.meshStaticData.size();
+        meshDesc.ibOffset = (uint32_t)sceneData.meshIndexData.size();
+        meshDesc.vertexCount = vertexCount;
+        meshDesc.indexCount = indexCount;
+        meshDesc.materialID = meshIndex % kMaterialCount;
+
+        for (uint32_t y = 0; y <= kGridResolution; ++y)
+        {
+            for (uint32_t x = 0; x <= kGridResolution; ++x)
+            {
+                StaticVertexData vertex = {};
+                vertex.position = float3((float)x, std::sin(0.1f * x + meshIndex) * std::cos(0.1f * y), (float)y);
+                vertex.normal = normalize(float3(-std::cos(0.1f * x), 1.f, std::sin(0.1f * y)));
+                vertex.tangent = float4(1.f, 0.f, 0.f, 1.f);
+                vertex.texCrd = float2((float)x, (float)y) / (float)kGridResolution;
+                sceneData.meshStaticData.push_back(PackedStaticVertexData(vertex));
+            }
+        }
+        for (uint32_t y = 0; y < kGridResolution; ++y)
+        {
+            for (uint32_t x = 0; x < kGridResolution; ++x)
+            {
+                uint32_t v = y * (kGridResolution + 1) + x;
+                for (uint32_t index : {v, v + kGridResolution + 1, v + 1, v + 1, v + kGridResolution + 1, v + kGridResolution + 2})
+                    sceneData.meshIndexData.push_back(index);
+            }
+        }
+
+        GeometryInstanceData instance(GeometryType::TriangleMesh);
+        instance.globalMatrixID = 0;
+        instance.materialID = meshDesc.materialID;
+        instance.geometryID = meshIndex;
+        instance.vbOffset = meshDesc.vbOffset;
+        instance.ibOffset = meshDesc.ibOffset;
+        instance.instanceIndex = meshIndex;
+        instance.geometryIndex = 0;
+
+        sceneData.meshDesc.push_back(meshDesc);
+        sceneData.meshNames.push_back(fmt::format("mesh{}", meshIndex));
+        sceneData.meshBBs.push_back(AABB(float3(0.f, -1.f, 0.f), float3((float)kGridResolution, 1.f, (float)kGridResolution)));
+        sceneData.meshInstanceData.push_back(instance);
+        sceneData.meshIdToInstanceIds.push_back({meshIndex});
+        sceneData.meshGroups.push_back({{MeshID(meshIndex)}, true, false});
+    }
+    sceneData.has32BitIndices = true;
+    sceneData.meshDrawCount = kMeshCount;
+
+    return sceneData;
+}
+} // namespace
+
+GPU_BENCHMARK(SceneCache_LoadBenchmark)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const Scene::SceneData sceneData = createSceneData(pDevice);
+    const std::string keyName = "SceneCache_LoadBenchmark";
+    const SceneCache::Key key = SHA1::compute(keyName.data(), keyName.size());
+
+    const double totalSize = double(
+        sceneData.meshStaticData.size() * sizeof(PackedStaticVertexData) + sceneData.meshIndexData.size() * sizeof(uint32_t)
+    );
+
+    ctx.measure("Write", [&]() { SceneCache::writeCache(sceneData, key, {}); }, Throughput::bytes(totalSize));
+
+    Scene::SceneData loaded;
+    ctx.measure("Read", [&]() { loaded = SceneCache::readCache(pDevice, key); }, Throughput::bytes(totalSize));
+
+    // Validate the last loaded copy outside of the timed functions.
+    EXPECT(SceneCache::hasValidCache(key));
+    EXPECT_EQ(loaded.meshDesc.size(), sceneData.meshDesc.size());
+    EXPECT(loaded.meshNames == sceneData.meshNames);
+    EXPECT_EQ(loaded.pMaterials->getMaterialCount(), sceneData.pMaterials->getMaterialCount());
+    EXPECT(loaded.meshIndexData == sceneData.meshIndexData);
+    ASSERT_EQ(loaded.meshStaticData.size(), sceneData.meshStaticData.size());
+    EXPECT(
+        std::memcmp(
+            loaded.meshStaticData.data(), sceneData.meshStaticData.data(), sceneData.meshStaticData.size() * sizeof(PackedStaticVertexData)
+        ) == 0
+    );
+
+    // Remove the cache files (see SceneCache::getCachePath()).
+    std::filesystem::path cachePath = getAppDataDirectory() / "NVIDIA/Falcor/SceneCache" / SHA1::toString(key);
+    std::filesystem::path manifestPath = cachePath;
+    manifestPath += ".deps";
+    std::filesystem::remove(cachePath);
+    std::filesystem::remove(manifestPath);
+}
+} // namespace Falcor
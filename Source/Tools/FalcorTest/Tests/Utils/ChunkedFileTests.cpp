@@ -0,0 +1,232 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/ChunkedFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const char* kMagic = "TestFile";
+const uint32_t kVersion = 1;
+
+/// Generate data that compresses roughly like packed vertex data (smooth positions, mostly constant attributes).
+std::vector<uint8_t> generateVertexLikeData(size_t floatCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-0.01f, 0.01f);
+    std::vector<float> values(floatCount);
+    float p = 0.f;
+    for (size_t i = 0; i < floatCount; ++i)
+    {
+        if (i % 8 < 3)
+            p += dist(rng);
+        values[i] = i % 8 < 3 ? p : (float)(i % 8) * 0.25f;
+    }
+    std::vector<uint8_t> data(floatCount * sizeof(float));
+    std::memcpy(data.data(), values.data(), data.size());
+    return data;
+}
+
+/// Count the temporary files of a chunked file left in its directory.
+size_t countTempFiles(const std::filesystem::path& path)
+{
+    const std::string prefix = path.filename().string() + ".";
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path()))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 && entry.path().extension() == ".tmp")
+            ++count;
+    }
+    return count;
+}
+
+bool equal(const ChunkedFileReader::ChunkView& view, const std::vector<uint8_t>& data)
+{
+    return view.size == data.size() && (data.empty() || std::memcmp(view.pData, data.data(), data.size()) == 0);
+}
+} // namespace
+
+CPU_TEST(ChunkedFile_RoundTrip)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_chunked_file.bin");
+
+    std::vector<uint8_t> large = generateVertexLikeData(3 * 1024 * 1024 + 17, 1);
+    std::vector<uint8_t> small = {1, 2, 3, 4, 5};
+    std::vector<uint8_t> empty;
+
+    // Data spanning several LZ4 blocks, written in pieces that don't line up with the blocks.
+    std::vector<uint8_t> streamed = generateVertexLikeData(5 * 1024 * 1024 + 3, 2);
+    const size_t kPieceSize = 1000003;
+
+    {
+        ChunkedFileWriter writer(path, kMagic, kVersion);
+        writer.addChunk(0, large.data(), large.size());
+        writer.addChunk(7, small.data(), small.size(), ChunkedFileWriter::Compression::None);
+        writer.addChunk(3, large.data(), large.size(), ChunkedFileWriter::Compression::None);
+        writer.addChunk(42, empty.data(), empty.size());
+        for (auto compression : {ChunkedFileWriter::Compression::LZ4, ChunkedFileWriter::Compression::None})
+        {
+            writer.beginChunk(compression == ChunkedFileWriter::Compression::LZ4 ? 10 : 11, compression);
+            for (size_t offset = 0; offset < streamed.size(); offset += kPieceSize)
+                writer.write(streamed.data() + offset, std::min(kPieceSize, streamed.size() - offset));
+            writer.endChunk();
+        }
+
+        // Nothing is visible at the destination until the file is closed.
+        EXPECT(!std::filesystem::exists(path));
+        writer.close();
+    }
+
+    EXPECT(ChunkedFileReader::isValid(path, kMagic, kVersion));
+    EXPECT(!ChunkedFileReader::isValid(path, kMagic, kVersion + 1));
+    EXPECT(!ChunkedFileReader::isValid(path, "Other", kVersion));
+    EXPECT(!ChunkedFileReader::isValid("__file_that_does_not_exist__", kMagic, kVersion));
+
+    {
+        ChunkedFileReader reader(path, kMagic, kVersion);
+        EXPECT(reader.hasChunk(0));
+        EXPECT(!reader.hasChunk(1));
+        EXPECT(equal(reader.getChunk(0), large));
+        EXPECT(equal(reader.getChunk(7), small));
+        EXPECT(equal(reader.getChunk(3), large));
+        EXPECT(equal(reader.getChunk(42), empty));
+        EXPECT(equal(reader.getChunk(10), streamed));
+        EXPECT(equal(reader.getChunk(11), streamed));
+
+        // Uncompressed chunks are views into the memory mapped file.
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(reader.getChunk(3).pData) % 4096, uintptr_t(0));
+    }
+
+    // A writer that is not closed leaves no file behind.
+    std::filesystem::remove(path);
+    {
+        ChunkedFileWriter writer(path, kMagic, kVersion);
+        writer.addChunk(0, small.data(), small.size());
+    }
+    EXPECT(!std::filesystem::exists(path));
+    EXPECT_EQ(countTempFiles(path), 0);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ChunkedFile_ConcurrentWriters)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_chunked_file_concurrent.bin");
+
+    // Two writers of the same file use separate temporary files. The file closed last wins.
+    std::vector<uint8_t> first = {1, 2, 3};
+    std::vector<uint8_t> second = {4, 5, 6, 7};
+    {
+        ChunkedFileWriter writer1(path, kMagic, kVersion);
+        ChunkedFileWriter writer2(path, kMagic, kVersion);
+        EXPECT_EQ(countTempFiles(path), 2);
+        writer1.addChunk(0, first.data(), first.size());
+        writer2.addChunk(0, second.data(), second.size());
+        writer1.close();
+        writer2.close();
+    }
+    EXPECT_EQ(countTempFiles(path), 0);
+
+    {
+        ChunkedFileReader reader(path, kMagic, kVersion);
+        EXPECT(equal(reader.getChunk(0), second));
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ChunkedFile_Corrupt)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_chunked_file_corrupt.bin");
+
+    // Two LZ4 blocks of 4 MB.
+    const uint64_t kBlockSize = 4 * 1024 * 1024;
+    std::vector<uint8_t> data = generateVertexLikeData(2 * kBlockSize / sizeof(float), 1);
+    std::vector<uint8_t> original;
+    {
+        ChunkedFileWriter writer(path, kMagic, kVersion);
+        writer.addChunk(0, data.data(), data.size());
+        writer.close();
+        EXPECT_EQ(countTempFiles(path), 0);
+
+        std::ifstream fs(path, std::ios_base::binary);
+        original.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+    }
+
+    // Patch a field of the table of contents and check that the file is rejected.
+    // The offset of the table of contents is stored at byte 24 of the header, the fields are at the given offsets of the first entry.
+    uint64_t tocOffset = 0;
+    std::memcpy(&tocOffset, original.data() + 24, sizeof(tocOffset));
+    auto expectCorrupt = [&](size_t fieldOffset, auto value)
+    {
+        std::vector<uint8_t> patched = original;
+        std::memcpy(patched.data() + tocOffset + fieldOffset, &value, sizeof(value));
+        {
+            std::ofstream fs(path, std::ios_base::binary | std::ios_base::trunc);
+            fs.write(reinterpret_cast<const char*>(patched.data()), patched.size());
+        }
+
+        bool caught = false;
+        try
+        {
+            ChunkedFileReader reader(path, kMagic, kVersion);
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught) << fmt::format("fieldOffset={}", fieldOffset);
+    };
+
+    const size_t kUncompressedSizeOffset = 24;
+    const size_t kBlockCountOffset = 32;
+    const size_t kBlockSizeOffset = 36;
+
+    // Too many blocks for the uncompressed size. The last block would be decompressed past the end of the chunk data.
+    expectCorrupt(kUncompressedSizeOffset, kBlockSize - 1);
+    expectCorrupt(kUncompressedSizeOffset, kBlockSize);
+    expectCorrupt(kUncompressedSizeOffset, uint64_t(0));
+    expectCorrupt(kBlockSizeOffset, uint32_t(2 * kBlockSize));
+    // Too few blocks or an invalid block size.
+    expectCorrupt(kUncompressedSizeOffset, 2 * kBlockSize + 1);
+    expectCorrupt(kUncompressedSizeOffset, uint64_t(1) << 40);
+    expectCorrupt(kBlockCountOffset, uint32_t(1));
+    expectCorrupt(kBlockSizeOffset, uint32_t(0));
+    expectCorrupt(kBlockSizeOffset, uint32_t(16));
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,232 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/FileDependencies.h"
+#include "Utils/Threading.h"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const std::filesystem::path kTestDirectory = std::filesystem::absolute("test_file_dependencies");
+
+void writeRandomFile(const std::filesystem::path& path, size_t size, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<char> data(size);
+    for (auto& c : data)
+        c = (char)rng();
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), data.size());
+}
+
+/// Move the last write time of a file forward without changing its contents.
+void touchFile(const std::filesystem::path& path)
+{
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(1));
+}
+
+/// Create the test directory with a large file (spanning multiple hash blocks), a small file and an empty file.
+std::vector<std::filesystem::path> createTestFiles()
+{
+    std::filesystem::remove_all(kTestDirectory);
+    std::filesystem::create_directories(kTestDirectory);
+    std::vector<std::filesystem::path> files = {kTestDirectory / "large.bin", kTestDirectory / "small.bin", kTestDirectory / "empty.bin"};
+    writeRandomFile(files[0], 10 * 1024 * 1024 + 17, 1);
+    writeRandomFile(files[1], 100, 2);
+    writeRandomFile(files[2], 0, 3);
+    return files;
+}
+
+const FileDependencyManifest::Entry& findEntry(const FileDependencyManifest& manifest, const std::filesystem::path& path)
+{
+    const auto& entries = manifest.getEntries();
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const auto& entry) { return entry.path == path; });
+    FALCOR_ASSERT(it != entries.end());
+    return *it;
+}
+} // namespace
+
+CPU_TEST(FileDependencies_Recorder)
+{
+    const std::filesystem::path path = kTestDirectory / "file.bin";
+
+    // Nothing is recorded without an active recorder.
+    FileDependencyRecorder::record(path);
+
+    {
+        FileDependencyRecorder recorder;
+        FileDependencyRecorder::record(path);
+        FileDependencyRecorder::record(kTestDirectory / "." / "file.bin");
+        Threading::dispatchTask([]() { FileDependencyRecorder::record(kTestDirectory / "other.bin"); }).finish();
+
+        {
+            FileDependencyRecorder nested;
+            FileDependencyRecorder::record(kTestDirectory / "nested.bin");
+            EXPECT_EQ(nested.getFiles().size(), size_t(1));
+        }
+
+        // A recorder on another thread belongs to a different load and does not see the files recorded here.
+        std::vector<std::filesystem::path> threadFiles;
+        std::thread thread(
+            [&threadFiles]()
+            {
+                FileDependencyRecorder threadRecorder;
+                FileDependencyRecorder::record(kTestDirectory / "thread.bin");
+                threadFiles = threadRecorder.getFiles();
+            }
+        );
+        thread.join();
+        ASSERT_EQ(threadFiles.size(), size_t(1));
+        EXPECT_EQ(threadFiles[0], kTestDirectory / "thread.bin");
+
+        auto files = recorder.getFiles();
+        EXPECT_EQ(files.size(), size_t(3));
+        EXPECT(std::is_sorted(files.begin(), files.end()));
+        for (const auto& file : files)
+            EXPECT(file.is_absolute());
+        EXPECT(std::find(files.begin(), files.end(), kTestDirectory / "thread.bin") == files.end());
+    }
+
+    EXPECT(!FileDependencyRecorder::isRecording());
+}
+
+CPU_TEST(FileDependencies_Manifest)
+{
+    auto files = createTestFiles();
+    files.push_back(kTestDirectory / "missing.bin");
+
+    auto manifest = FileDependencyManifest::create(files);
+    const auto& entries = manifest.getEntries();
+    ASSERT_EQ(entries.size(), size_t(4));
+    for (const auto& entry : entries)
+    {
+        if (entry.path == files[3])
+        {
+            EXPECT(!entry.exists);
+            continue;
+        }
+        EXPECT(entry.exists);
+        EXPECT_EQ(entry.size, std::filesystem::file_size(entry.path));
+        EXPECT_EQ(entry.hash, FileDependencyManifest::computeFileHash(entry.path));
+    }
+    EXPECT_NE(findEntry(manifest, files[0]).hash, findEntry(manifest, files[1]).hash);
+
+    const std::filesystem::path manifestPath = kTestDirectory / "manifest.deps";
+    manifest.write(manifestPath);
+    auto readManifest = FileDependencyManifest::read(manifestPath);
+    EXPECT(readManifest.getEntries() == entries);
+
+    // The manifest is written through a temporary file that replaces the previous manifest.
+    manifest.write(manifestPath);
+    EXPECT(FileDependencyManifest::read(manifestPath).getEntries() == entries);
+    size_t fileCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(kTestDirectory))
+    {
+        if (entry.path().filename().string().rfind("manifest.deps", 0) == 0)
+            fileCount++;
+    }
+    EXPECT_EQ(fileCount, size_t(1));
+
+    std::filesystem::remove_all(kTestDirectory);
+}
+
+CPU_TEST(FileDependencies_Validate)
+{
+    auto files = createTestFiles();
+    auto manifest = FileDependencyManifest::create(files);
+
+    bool updated = false;
+    EXPECT(manifest.validate(updated));
+    EXPECT(!updated);
+
+    // Touching a file re-hashes it once and updates the manifest.
+    touchFile(files[0]);
+    EXPECT(manifest.validate(updated));
+    EXPECT(updated);
+    EXPECT(manifest.validate(updated));
+    EXPECT(!updated);
+
+    // Changing the contents (even with the same size) invalidates the manifest.
+    writeRandomFile(files[0], 10 * 1024 * 1024 + 17, 4);
+    touchFile(files[0]);
+    EXPECT(!manifest.validate(updated));
+
+    // A new manifest only hashes the changed file, hashes of unchanged files are reused.
+    auto newManifest = FileDependencyManifest::create(files, &manifest);
+    EXPECT_EQ(findEntry(newManifest, files[0]).hash, FileDependencyManifest::computeFileHash(files[0]));
+    EXPECT_NE(findEntry(newManifest, files[0]).hash, findEntry(manifest, files[0]).hash);
+    EXPECT_EQ(findEntry(newManifest, files[1]).hash, findEntry(manifest, files[1]).hash);
+    EXPECT(newManifest.validate(updated));
+
+    // Changing the size or removing a file invalidates the manifest.
+    writeRandomFile(files[1], 101, 2);
+    EXPECT(!newManifest.validate(updated));
+    writeRandomFile(files[1], 100, 2);
+    newManifest = FileDependencyManifest::create(files, &newManifest);
+    EXPECT(newManifest.validate(updated));
+    std::filesystem::remove(files[2]);
+    EXPECT(!newManifest.validate(updated));
+
+    // Creating a file that was missing when the manifest was created invalidates the manifest.
+    const std::filesystem::path missing = kTestDirectory / "missing.bin";
+    auto missingManifest = FileDependencyManifest::create({files[0], missing});
+    EXPECT(missingManifest.validate(updated));
+    writeRandomFile(missing, 0, 5);
+    EXPECT(!missingManifest.validate(updated));
+
+    std::filesystem::remove_all(kTestDirectory);
+}
+
+CPU_BENCHMARK(FileDependencies_Hash)
+{
+    std::filesystem::remove_all(kTestDirectory);
+    std::filesystem::create_directories(kTestDirectory);
+    const std::filesystem::path path = kTestDirectory / "large.bin";
+    const size_t size = 256 * 1024 * 1024;
+    writeRandomFile(path, size, 1);
+
+    uint64_t hash = 0;
+    ctx.measure("ComputeFileHash", [&]() { hash = FileDependencyManifest::computeFileHash(path); }, Throughput::bytes((double)size));
+    EXPECT_EQ(hash, FileDependencyManifest::computeFileHash(path));
+
+    // Validating an unchanged manifest only queries file metadata.
+    auto manifest = FileDependencyManifest::create({path});
+    bool updated = false;
+    ctx.measure("ValidateUnchanged", [&]() { manifest.validate(updated); });
+    EXPECT(!updated);
+
+    std::filesystem::remove_all(kTestDirectory);
+}
+} // namespace Falcor
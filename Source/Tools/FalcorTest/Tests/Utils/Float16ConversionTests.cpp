@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Math/Float16.h"
+#include <fstd/bit.h> // TODO C++20: Replace with <bit>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<float> createFloatInputs()
+{
+    std::vector<float> inputs;
+
+    // All exponents and signs with significands around the rounding points of normalized and denormalized halfs.
+    const uint32_t kSignificands[] = {
+        0x000000, 0x000001, 0x000fff, 0x001000, 0x001001, 0x001fff, 0x002000, 0x003000,
+        0x005000, 0x1ff000, 0x200000, 0x3ff000, 0x400000, 0x7fe000, 0x7ff000, 0x7fffff,
+    };
+    for (uint32_t exponent = 0; exponent < 256; ++exponent)
+        for (uint32_t significand : kSignificands)
+            for (uint32_t sign : {0u, 0x80000000u})
+                inputs.push_back(fstd::bit_cast<float>(sign | (exponent << 23) | significand));
+
+    // NaNs with significand bits only below the half precision.
+    for (uint32_t bits : {0x7f800001u, 0x7f801fffu, 0xff800001u, 0x7fc00000u, 0x7fa00000u})
+        inputs.push_back(fstd::bit_cast<float>(bits));
+
+    // Random bit patterns.
+    std::mt19937 rng;
+    for (size_t i = 0; i < 1000000; ++i)
+        inputs.push_back(fstd::bit_cast<float>((uint32_t)rng()));
+
+    return inputs;
+}
+
+/**
+ * Disables the AVX2/F16C kernels on the current thread for the lifetime of the object.
+ */
+struct ScopedSSE2Only
+{
+    ScopedSSE2Only() { math::setFloat16AVX2Enabled(false); }
+    ~ScopedSSE2Only() { math::setFloat16AVX2Enabled(true); }
+};
+
+void testToFloat32(CPUUnitTestContext& ctx)
+{
+    std::vector<uint16_t> src(0x10000);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = (uint16_t)i;
+
+    // All halfs must convert bit-exact with the scalar conversion.
+    std::vector<float> dst(src.size());
+    math::float16ToFloat32(src, dst);
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(dst[i]), fstd::bit_cast<uint32_t>(math::float16ToFloat32(src[i]))) << fmt::format("half={:#06x}", src[i]);
+
+    // Unaligned ranges with remainders.
+    for (size_t offset = 0; offset < 4; ++offset)
+    {
+        for (size_t count = 0; count < 40; ++count)
+        {
+            std::vector<float> part(count + 1, -1.f);
+            math::float16ToFloat32(fstd::span<const uint16_t>(src.data() + 0x7bf0 + offset, count), fstd::span<float>(part.data(), count));
+            for (size_t i = 0; i < count; ++i)
+                EXPECT_EQ(fstd::bit_cast<uint32_t>(part[i]), fstd::bit_cast<uint32_t>(math::float16ToFloat32(src[0x7bf0 + offset + i])));
+            EXPECT_EQ(part[count], -1.f);
+        }
+    }
+}
+
+void testToFloat16(CPUUnitTestContext& ctx)
+{
+    std::vector<float> src = createFloatInputs();
+
+    // All inputs must convert bit-exact with the scalar conversion.
+    std::vector<uint16_t> dst(src.size());
+    math::float32ToFloat16(src, dst);
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(dst[i], math::float32ToFloat16(src[i])) << fmt::format("float={:#010x}", fstd::bit_cast<uint32_t>(src[i]));
+
+    // Unaligned ranges with remainders.
+    for (size_t offset = 0; offset < 4; ++offset)
+    {
+        for (size_t count = 0; count < 40; ++count)
+        {
+            std::vector<uint16_t> part(count + 1, 0xcdcd);
+            math::float32ToFloat16(fstd::span<const float>(src.data() + offset, count), fstd::span<uint16_t>(part.data(), count));
+            for (size_t i = 0; i < count; ++i)
+                EXPECT_EQ(part[i], math::float32ToFloat16(src[offset + i]));
+            EXPECT_EQ(part[count], 0xcdcd);
+        }
+    }
+}
+} // namespace
+
+CPU_TEST(Float16BulkToFloat32)
+{
+    testToFloat32(ctx);
+}
+
+CPU_TEST(Float16BulkToFloat32SSE2)
+{
+    ScopedSSE2Only sse2Only;
+    testToFloat32(ctx);
+}
+
+CPU_TEST(Float16BulkToFloat16)
+{
+    testToFloat16(ctx);
+}
+
+CPU_TEST(Float16BulkToFloat16SSE2)
+{
+    ScopedSSE2Only sse2Only;
+    testToFloat16(ctx);
+}
+
+CPU_TEST(Float16BulkSizeMismatch)
+{
+    std::vector<float> f(8);
+    std::vector<uint16_t> h(7);
+
+    bool caught = false;
+    try
+    {
+        math::float32ToFloat16(f, h);
+    }
+    catch (const ArgumentError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+
+    caught = false;
+    try
+    {
+        math::float16ToFloat32(h, f);
+    }
+    catch (const ArgumentError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+}
+
+CPU_BENCHMARK(Float16BulkThroughput)
+{
+    const size_t kCount = 1 << 22;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-65504.f, 65504.f);
+    std::vector<float> floats(kCount);
+    for (auto& f : floats)
+        f = dist(rng);
+    std::vector<uint16_t> halfs(kCount);
+
+    ctx.measure(
+        "Float32ToFloat16Scalar",
+        [&]()
+        {
+            for (size_t i = 0; i < kCount; ++i)
+                halfs[i] = math::float32ToFloat16(floats[i]);
+        },
+        Throughput::items(kCount)
+    );
+
+    ctx.measure("Float32ToFloat16Bulk", [&]() { math::float32ToFloat16(floats, halfs); }, Throughput::items(kCount));
+
+    ctx.measure(
+        "Float16ToFloat32Scalar",
+        [&]()
+        {
+            for (size_t i = 0; i < kCount; ++i)
+                floats[i] = math::float16ToFloat32(halfs[i]);
+        },
+        Throughput::items(kCount)
+    );
+
+    ctx.measure("Float16ToFloat32Bulk", [&]() { math::float16ToFloat32(halfs, floats); }, Throughput::items(kCount));
+}
+} // namespace Falcor
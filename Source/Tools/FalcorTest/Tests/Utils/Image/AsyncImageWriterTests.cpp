@@ -0,0 +1,188 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncImageWriter.h"
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 256;
+const uint32_t kHeight = 256;
+
+AsyncImageWriter::Image createImage(const std::filesystem::path& path, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    AsyncImageWriter::Image image;
+    image.path = path;
+    image.width = kWidth;
+    image.height = kHeight;
+    image.fileFormat = Bitmap::FileFormat::PngFile;
+    image.resourceFormat = ResourceFormat::RGBA8Unorm;
+    image.dataSize = size_t(kWidth) * kHeight * 4;
+    image.pData = BitmapBufferPool::get().acquire(image.dataSize);
+    for (size_t i = 0; i < image.dataSize; i++)
+        image.pData[i] = uint8_t((i / 4) % kWidth + (rng() & 0xf));
+    return image;
+}
+
+std::filesystem::path getImagePath(uint32_t index)
+{
+    return getRuntimeDirectory() / fmt::format("test_async_image_writer_{}.png", index);
+}
+} // namespace
+
+CPU_TEST(AsyncImageWriter_Write)
+{
+    const uint32_t kImageCount = 16;
+
+    AsyncImageWriter::Options options;
+    options.threadCount = 2;
+    options.maxPendingImages = 3;
+    AsyncImageWriter writer(options);
+
+    std::atomic<uint64_t> callbackBytes{0};
+    std::atomic<uint32_t> callbackCount{0};
+    for (uint32_t i = 0; i < kImageCount; i++)
+    {
+        writer.write(
+            createImage(getImagePath(i), i),
+            [&](const std::filesystem::path& path, uint64_t fileSize)
+            {
+                callbackBytes += fileSize;
+                callbackCount++;
+            }
+        );
+        EXPECT_LE(writer.getStats().queueDepth, options.maxPendingImages);
+    }
+    writer.flush();
+
+    auto stats = writer.getStats();
+    EXPECT_EQ(stats.imageCount, kImageCount);
+    EXPECT_EQ(stats.failedCount, 0);
+    EXPECT_EQ(stats.queueDepth, 0);
+    EXPECT_EQ(stats.pendingBytes, 0);
+    EXPECT_LE(stats.peakQueueDepth, options.maxPendingImages);
+    EXPECT_EQ(stats.imageBytes, uint64_t(kImageCount) * kWidth * kHeight * 4);
+    EXPECT_EQ(callbackCount.load(), kImageCount);
+    EXPECT_EQ(callbackBytes.load(), stats.bytesWritten);
+
+    uint64_t totalFileSize = 0;
+    for (uint32_t i = 0; i < kImageCount; i++)
+    {
+        auto path = getImagePath(i);
+        EXPECT(std::filesystem::exists(path));
+        if (std::filesystem::exists(path))
+        {
+            totalFileSize += std::filesystem::file_size(path);
+            std::filesystem::remove(path);
+        }
+    }
+    EXPECT_EQ(totalFileSize, stats.bytesWritten);
+
+    writer.resetStats();
+    EXPECT_EQ(writer.getStats().imageCount, 0);
+}
+
+CPU_TEST(AsyncImageWriter_ByteBudget)
+{
+    // With a byte budget of less than two images, at most one image is pending at any time.
+    AsyncImageWriter::Options options;
+    options.threadCount = 4;
+    options.maxPendingBytes = size_t(kWidth) * kHeight * 4 * 3 / 2;
+    AsyncImageWriter writer(options);
+
+    for (uint32_t i = 0; i < 8; i++)
+        writer.write(createImage(getImagePath(i), i));
+    writer.flush();
+
+    auto stats = writer.getStats();
+    EXPECT_EQ(stats.imageCount, 8);
+    EXPECT_EQ(stats.peakQueueDepth, 1);
+
+    for (uint32_t i = 0; i < 8; i++)
+        std::filesystem::remove(getImagePath(i));
+}
+
+CPU_TEST(AsyncImageWriter_Failure)
+{
+    AsyncImageWriter writer;
+    uint64_t reportedSize = ~0ull;
+    writer.write(
+        createImage(getRuntimeDirectory() / "nonexistent_directory" / "image.png", 0),
+        [&](const std::filesystem::path& path, uint64_t fileSize) { reportedSize = fileSize; }
+    );
+    writer.flush();
+
+    auto stats = writer.getStats();
+    EXPECT_EQ(stats.imageCount, 0);
+    EXPECT_EQ(stats.failedCount, 1);
+    EXPECT_EQ(reportedSize, 0);
+}
+
+CPU_BENCHMARK(AsyncImageWriter_Throughput)
+{
+    // Compare writing images on the calling thread with the asynchronous writer.
+    const uint32_t kImageCount = 32;
+    const uint64_t kImageBytes = uint64_t(kImageCount) * kWidth * kHeight * 4;
+
+    ctx.measure(
+        "Sequential",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kImageCount; i++)
+            {
+                auto image = createImage(getImagePath(i), i);
+                Bitmap::saveImage(
+                    image.path, image.width, image.height, image.fileFormat, image.exportFlags, image.resourceFormat, true, image.pData.get()
+                );
+            }
+        },
+        Throughput::bytes(kImageBytes)
+    );
+
+    AsyncImageWriter writer;
+    ctx.measure(
+        "AsyncImageWriter",
+        [&]()
+        {
+            for (uint32_t i = 0; i < kImageCount; i++)
+                writer.write(createImage(getImagePath(i), i));
+            writer.flush();
+        },
+        Throughput::bytes(kImageBytes)
+    );
+
+    for (uint32_t i = 0; i < kImageCount; i++)
+        std::filesystem::remove(getImagePath(i));
+}
+} // namespace Falcor
@@ -27,9 +27,36 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/Bitmap.h"
+#include "Utils/Logger.h"
+
+#include <random>
+#include <vector>
 
 namespace Falcor
 {
+namespace
+{
+/// Generate a smooth RGBA8 test image with some noise, roughly resembling natural image content.
+std::vector<uint8_t> generateImageRGBA8(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* pPixel = &data[(size_t(y) * width + x) * 4];
+            uint32_t noise = rng() & 0xf;
+            pPixel[0] = uint8_t((x * 255) / width + noise);
+            pPixel[1] = uint8_t((y * 255) / height + noise);
+            pPixel[2] = uint8_t(((x + y) * 127) / (width + height) + seed * 16);
+            pPixel[3] = 0xff;
+        }
+    }
+    return data;
+}
+} // namespace
+
 GPU_TEST(Bitmap_LinearRamp_PNG)
 {
     const auto path = getRuntimeDirectory() / "test_linear_ramp.png";
@@ -74,4 +101,159 @@ GPU_TEST(Bitmap_LinearRamp_PNG)
     // Delete the test file.
     std::filesystem::remove(path);
 }
+
+CPU_TEST(Bitmap_RGB_PNG)
+{
+    const auto path = getRuntimeDirectory() / "test_rgb.png";
+
+    // Use an odd width to exercise the tail of the RGB to RGBX expansion.
+    const uint32_t width = 37;
+    const uint32_t height = 13;
+    const std::vector<uint8_t> data = generateImageRGBA8(width, height, 1);
+
+    // Saving without alpha stores a 24-bit PNG. Note that saveImage() swaps channels in-place, so pass a copy.
+    std::vector<uint8_t> tmp = data;
+    Bitmap::saveImage(
+        path, width, height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true /* top-down */,
+        tmp.data()
+    );
+
+    for (bool isTopDown : {true, false})
+    {
+        auto bmp = Bitmap::createFromFile(path, isTopDown);
+        EXPECT(bmp != nullptr);
+        if (!bmp)
+            continue;
+
+        EXPECT_EQ(bmp->getWidth(), width);
+        EXPECT_EQ(bmp->getHeight(), height);
+        EXPECT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::BGRX8Unorm);
+        EXPECT_EQ(bmp->getSize(), width * height * 4);
+
+        const uint8_t* pData = bmp->getData();
+        size_t mismatchCount = 0;
+        for (uint32_t y = 0; y < height; y++)
+        {
+            uint32_t srcY = isTopDown ? y : height - y - 1;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* pSrc = &data[(size_t(srcY) * width + x) * 4];
+                const uint8_t* pDst = &pData[(size_t(y) * width + x) * 4];
+                if (pDst[0] != pSrc[2] || pDst[1] != pSrc[1] || pDst[2] != pSrc[0] || pDst[3] != 0xff)
+                    mismatchCount++;
+            }
+        }
+        EXPECT_EQ(mismatchCount, 0) << "isTopDown=" << isTopDown;
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(Bitmap_RGB_EXR)
+{
+    const auto path = getRuntimeDirectory() / "test_rgb.exr";
+
+    const uint32_t width = 21;
+    const uint32_t height = 5;
+    std::vector<float> data(width * height * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (i % 4) == 3 ? 0.5f : float(i) * 1.25f - 7.f; // Values outside [0,1] must not be clamped.
+
+    // Saving without alpha stores an RGB float EXR file, which is expanded to RGBA on load.
+    Bitmap::saveImage(
+        path, width, height, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::Uncompressed, ResourceFormat::RGBA32Float,
+        true /* top-down */, data.data()
+    );
+
+    auto bmp = Bitmap::createFromFile(path, true /* top-down */);
+    EXPECT(bmp != nullptr);
+    if (bmp)
+    {
+        EXPECT_EQ(bmp->getWidth(), width);
+        EXPECT_EQ(bmp->getHeight(), height);
+        EXPECT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::RGBA32Float);
+
+        const float* pData = reinterpret_cast<const float*>(bmp->getData());
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            float expected = (i % 4) == 3 ? 1.f : data[i];
+            EXPECT_EQ(pData[i], expected) << "i=" << i;
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_BENCHMARK(Bitmap_DecodeThroughput)
+{
+    const uint32_t kImageSize = 1024;
+    const uint32_t kImageCount = 4;
+
+    struct Corpus
+    {
+        const char* name;
+        Bitmap::FileFormat fileFormat;
+        ResourceFormat resourceFormat;
+    };
+    const Corpus kCorpora[] = {
+        {"png", Bitmap::FileFormat::PngFile, ResourceFormat::RGBA8Unorm},
+        {"jpg", Bitmap::FileFormat::JpegFile, ResourceFormat::RGBA8Unorm},
+        {"exr", Bitmap::FileFormat::ExrFile, ResourceFormat::RGBA16Float},
+    };
+
+    const auto dir = getRuntimeDirectory() / "test_bitmap_decode";
+    std::filesystem::create_directories(dir);
+
+    for (const auto& corpus : kCorpora)
+    {
+        // Write the corpus. EXR images are stored as RGB half, the others as 8-bit RGB.
+        std::vector<std::filesystem::path> paths;
+        uint64_t fileSize = 0;
+        for (uint32_t i = 0; i < kImageCount; i++)
+        {
+            std::vector<uint8_t> data = generateImageRGBA8(kImageSize, kImageSize, i);
+            std::vector<float16_t> halfData;
+            void* pData = data.data();
+            if (corpus.resourceFormat == ResourceFormat::RGBA16Float)
+            {
+                halfData.resize(data.size());
+                for (size_t j = 0; j < data.size(); j++)
+                    halfData[j] = float16_t(data[j] / 64.f);
+                pData = halfData.data();
+            }
+
+            auto path = dir / fmt::format("image{}.{}", i, corpus.name);
+            Bitmap::saveImage(
+                path, kImageSize, kImageSize, corpus.fileFormat, Bitmap::ExportFlags::None, corpus.resourceFormat, true /* top-down */,
+                pData
+            );
+            fileSize += std::filesystem::file_size(path);
+            paths.push_back(path);
+        }
+
+        // Decode the corpus. Bitmaps are released right away like in texture loading, so storage is recycled by the pool.
+        // Throughput is reported in file bytes.
+        auto poolStats = BitmapBufferPool::get().getStats();
+        ctx.measure(
+            corpus.name,
+            [&]()
+            {
+                for (const auto& path : paths)
+                {
+                    auto bmp = Bitmap::createFromFile(path, true /* top-down */);
+                    EXPECT(bmp != nullptr);
+                }
+            },
+            Throughput::bytes((double)fileSize)
+        );
+        auto poolStatsAfter = BitmapBufferPool::get().getStats();
+
+        logInfo(
+            "Bitmap decode {}: {} pool allocations, {} pool reuses", corpus.name, poolStatsAfter.allocationCount - poolStats.allocationCount,
+            poolStatsAfter.reuseCount - poolStats.reuseCount
+        );
+    }
+
+    std::filesystem::remove_all(dir);
+}
 } // namespace Falcor
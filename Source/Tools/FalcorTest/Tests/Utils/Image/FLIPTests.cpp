@@ -0,0 +1,155 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Core/Plugin.h"
+#include "Testing/UnitTest.h"
+#include "RenderGraph/RenderGraph.h"
+#include "Utils/Image/FLIP.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 96;
+const uint32_t kHeight = 64;
+
+// The CPU implementation filters separably in single precision, while FLIPPass gathers the full 2D footprint per pixel.
+const float kMaxError = 2e-3f;
+const double kMaxMeanError = 1e-4;
+
+/**
+ * Create an RGBA image with smooth gradients and a sharp edge, optionally with noise added.
+ */
+std::vector<float> createImage(std::mt19937& rng, float noise, float edgeOffset)
+{
+    std::uniform_real_distribution<float> dist(-noise, noise);
+    std::vector<float> image(kWidth * kHeight * 4);
+    for (uint32_t y = 0; y < kHeight; ++y)
+    {
+        for (uint32_t x = 0; x < kWidth; ++x)
+        {
+            float u = float(x) / kWidth;
+            float v = float(y) / kHeight;
+            float edge = float(x) + edgeOffset > 0.5f * kWidth ? 0.6f : 0.f;
+            float* pPixel = image.data() + (y * kWidth + x) * 4;
+            pPixel[0] = std::clamp(0.2f + 0.6f * u * v + dist(rng), 0.f, 1.f);
+            pPixel[1] = std::clamp(0.1f + 0.3f * edge + 0.5f * std::sin(6.f * v) * std::sin(6.f * v) + dist(rng), 0.f, 1.f);
+            pPixel[2] = std::clamp(0.8f - 0.7f * u + 0.3f * edge + dist(rng), 0.f, 1.f);
+            pPixel[3] = 1.f;
+        }
+    }
+    return image;
+}
+
+/**
+ * Compute the FLIP error map on the CPU. Rows outside of the image replicate the closest edge row.
+ */
+std::vector<float> computeFLIP(const std::vector<float>& reference, const std::vector<float>& test)
+{
+    FLIP flip;
+    const uint32_t radius = flip.getRadius();
+
+    auto pad = [&](const std::vector<float>& image)
+    {
+        std::vector<float> padded((kHeight + 2 * radius) * kWidth * 4);
+        for (uint32_t row = 0; row < kHeight + 2 * radius; ++row)
+        {
+            uint32_t srcRow = uint32_t(std::clamp(int(row) - int(radius), 0, int(kHeight) - 1));
+            std::copy_n(image.data() + srcRow * kWidth * 4, kWidth * 4, padded.data() + row * kWidth * 4);
+        }
+        return padded;
+    };
+
+    std::vector<float> paddedReference = pad(reference);
+    std::vector<float> paddedTest = pad(test);
+    std::vector<float> errors(kWidth * kHeight);
+    flip.compute(kWidth, kHeight, paddedReference.data(), paddedTest.data(), errors.data());
+    return errors;
+}
+} // namespace
+
+GPU_TEST(FLIP_MatchesFLIPPass)
+{
+    PluginManager::instance().loadPluginByName("FLIPPass");
+
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    std::mt19937 rng;
+    std::vector<float> reference = createImage(rng, 0.f, 0.f);
+    std::vector<float> test = createImage(rng, 0.05f, 3.f);
+
+    // Run FLIPPass with its default settings.
+    ref<Fbo> pTargetFbo = Fbo::create2D(pDevice, kWidth, kHeight, ResourceFormat::RGBA32Float);
+    ref<Texture> pReference = Texture::create2D(pDevice, kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, reference.data());
+    ref<Texture> pTest = Texture::create2D(pDevice, kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, test.data());
+    ref<RenderGraph> pGraph = RenderGraph::create(pDevice, "FLIP");
+    ref<RenderPass> pPass = RenderPass::create("FLIPPass", pDevice);
+    if (!pPass)
+        throw RuntimeError("Could not create render pass 'FLIPPass'");
+    pGraph->addPass(pPass, "FLIP");
+    pGraph->setInput("FLIP.referenceImage", pReference);
+    pGraph->setInput("FLIP.testImage", pTest);
+    pGraph->markOutput("FLIP.errorMap");
+    pGraph->onResize(pTargetFbo.get());
+    pGraph->execute(pRenderContext);
+    ref<Resource> pOutput = pGraph->getOutput("FLIP.errorMap");
+    std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pOutput->asTexture().get(), 0);
+    ASSERT_EQ(data.size(), kWidth * kHeight * 4 * sizeof(float));
+    const float* pGPUErrors = reinterpret_cast<const float*>(data.data());
+
+    std::vector<float> cpuErrors = computeFLIP(reference, test);
+
+    // The FLIP value is stored in the alpha channel of the error map.
+    double cpuSum = 0.0;
+    double gpuSum = 0.0;
+    float maxDiff = 0.f;
+    uint32_t maxDiffIndex = 0;
+    for (uint32_t i = 0; i < kWidth * kHeight; ++i)
+    {
+        float gpuError = pGPUErrors[i * 4 + 3];
+        float diff = std::abs(cpuErrors[i] - gpuError);
+        if (diff > maxDiff)
+        {
+            maxDiff = diff;
+            maxDiffIndex = i;
+        }
+        cpuSum += cpuErrors[i];
+        gpuSum += gpuError;
+    }
+    const double pixelCount = double(kWidth * kHeight);
+
+    EXPECT_LE(maxDiff, kMaxError) << fmt::format("pixel=({}, {})", maxDiffIndex % kWidth, maxDiffIndex / kWidth);
+    EXPECT_LE(std::abs(cpuSum - gpuSum) / pixelCount, kMaxMeanError);
+
+    // Make sure the images actually differ, so that the comparison is meaningful.
+    EXPECT_GE(gpuSum / pixelCount, 0.01);
+}
+} // namespace Falcor
@@ -0,0 +1,178 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/PixelConversion.h"
+#include "Utils/Image/BitmapBufferPool.h"
+#include "Utils/Math/Float16.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// Pixel counts covering the empty case, the scalar tails and the SIMD loops.
+const size_t kPixelCounts[] = {0, 1, 2, 3, 5, 6, 7, 8, 9, 31, 1000, 1001};
+} // namespace
+
+CPU_TEST(PixelConversion_RGB8ToRGBA8)
+{
+    std::mt19937 rng;
+    for (size_t pixelCount : kPixelCounts)
+    {
+        std::vector<uint8_t> src(pixelCount * 3);
+        for (auto& v : src)
+            v = (uint8_t)rng();
+
+        // Add a guard byte to detect writes past the end.
+        std::vector<uint8_t> dst(pixelCount * 4 + 1, 0xcd);
+        expandRGB8ToRGBA8(src.data(), dst.data(), pixelCount, 0x7f);
+
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                EXPECT_EQ(dst[i * 4 + c], src[i * 3 + c]);
+            EXPECT_EQ(dst[i * 4 + 3], 0x7f);
+        }
+        EXPECT_EQ(dst[pixelCount * 4], 0xcd);
+    }
+}
+
+CPU_TEST(PixelConversion_RGB32FloatToRGBA32Float)
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-1e6f, 1e6f);
+    for (size_t pixelCount : kPixelCounts)
+    {
+        std::vector<float> src(pixelCount * 3);
+        for (auto& v : src)
+            v = dist(rng);
+
+        std::vector<float> dst(pixelCount * 4 + 1, -5.f);
+        expandRGB32FloatToRGBA32Float(src.data(), dst.data(), pixelCount);
+
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                EXPECT_EQ(dst[i * 4 + c], src[i * 3 + c]);
+            EXPECT_EQ(dst[i * 4 + 3], 1.f);
+        }
+        EXPECT_EQ(dst[pixelCount * 4], -5.f);
+    }
+}
+
+CPU_TEST(PixelConversion_Float16ToRGBA32Float)
+{
+    // Convert all possible half values with every channel count and compare bit patterns against the scalar conversion.
+    std::vector<uint16_t> src(65536);
+    for (uint32_t i = 0; i < 65536; ++i)
+        src[i] = (uint16_t)i;
+
+    for (uint32_t channelCount = 1; channelCount <= 4; ++channelCount)
+    {
+        size_t pixelCount = src.size() / channelCount;
+        std::vector<float> dst(pixelCount * 4);
+        convertFloat16ToRGBA32Float(src.data(), dst.data(), pixelCount, channelCount);
+
+        size_t mismatchCount = 0;
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                float ref = c < channelCount ? math::float16ToFloat32(src[i * channelCount + c]) : (c == 3 ? 1.f : 0.f);
+                if (std::memcmp(&ref, &dst[i * 4 + c], sizeof(float)) != 0)
+                    mismatchCount++;
+            }
+        }
+        EXPECT_EQ(mismatchCount, 0) << "channelCount=" << channelCount;
+    }
+}
+
+CPU_TEST(BitmapBufferPool_SizeClasses)
+{
+    size_t classSize;
+    EXPECT_EQ(BitmapBufferPool::getSizeClass(1, classSize), 3);
+    EXPECT_EQ(classSize, 4096);
+    EXPECT_EQ(BitmapBufferPool::getSizeClass(4096, classSize), 3);
+    EXPECT_EQ(classSize, 4096);
+    EXPECT_EQ(BitmapBufferPool::getSizeClass(4097, classSize), 4);
+    EXPECT_EQ(classSize, 5120);
+
+    // Size classes are monotonic and waste at most 25%.
+    uint32_t prevSizeClass = 0;
+    for (size_t size = 4096; size <= (size_t(1) << 30); size += size / 7 + 1)
+    {
+        uint32_t sizeClass = BitmapBufferPool::getSizeClass(size, classSize);
+        EXPECT_NE(sizeClass, BitmapBufferPool::kUnpooled);
+        EXPECT_GE(sizeClass, prevSizeClass);
+        EXPECT_GE(classSize, size);
+        EXPECT_LE(classSize - size, size / 4);
+        prevSizeClass = sizeClass;
+    }
+
+    EXPECT_EQ(BitmapBufferPool::getSizeClass((size_t(1) << 30) + 1, classSize), BitmapBufferPool::kUnpooled);
+}
+
+CPU_TEST(BitmapBufferPool_Reuse)
+{
+    BitmapBufferPool pool(1 << 20);
+
+    const uint8_t* pFirst = nullptr;
+    {
+        auto buffer = pool.acquire(100000);
+        pFirst = buffer.get();
+        std::memset(buffer.get(), 0xab, 100000);
+    }
+    EXPECT_EQ(pool.getStats().allocationCount, 1);
+    EXPECT_GT(pool.getStats().retainedSize, 0);
+
+    // A request in the same size class reuses the released buffer.
+    {
+        auto buffer = pool.acquire(99000);
+        EXPECT_EQ(buffer.get(), pFirst);
+        EXPECT_EQ(pool.getStats().reuseCount, 1);
+        EXPECT_EQ(pool.getStats().retainedSize, 0);
+
+        // A second live request needs a new allocation.
+        auto buffer2 = pool.acquire(99000);
+        EXPECT_NE(buffer2.get(), pFirst);
+        EXPECT_EQ(pool.getStats().allocationCount, 2);
+    }
+
+    // Buffers exceeding the retained size budget are freed.
+    {
+        auto buffer = pool.acquire(2 << 20);
+    }
+    EXPECT_LE(pool.getStats().retainedSize, 1 << 20);
+
+    pool.setMaxRetainedSize(0);
+    EXPECT_EQ(pool.getStats().retainedSize, 0);
+}
+} // namespace Falcor
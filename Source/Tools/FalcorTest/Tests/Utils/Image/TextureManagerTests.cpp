@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureManager.h"
+#include <thread>
 
 namespace Falcor
 {
@@ -51,4 +52,191 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_KeyLookup)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_<MIP>.png";
+
+    // Identical requests resolve to the same handle, differing load options create a new texture.
+    auto handle = textureManager.loadTexture(path, false, false, ResourceBindFlags::ShaderResource, false);
+    auto handle2 = textureManager.loadTexture(path, false, false, ResourceBindFlags::ShaderResource, false);
+    auto handleSrgb = textureManager.loadTexture(path, false, true, ResourceBindFlags::ShaderResource, false);
+    EXPECT(handle.isValid());
+    EXPECT(handle == handle2);
+    EXPECT(!(handle == handleSrgb));
+
+    // Adding an already managed texture returns its existing handle.
+    EXPECT(textureManager.addTexture(textureManager.getTexture(handle)) == handle);
+
+    // Look up descs from multiple threads concurrently.
+    const size_t threadCount = 4;
+    std::atomic<size_t> loadedCount{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (size_t j = 0; j < 1000; ++j)
+                {
+                    auto desc = textureManager.getTextureDesc(j % 2 ? handle : handleSrgb);
+                    if (desc.state == TextureManager::TextureState::Loaded && desc.pTexture)
+                        loadedCount++;
+                }
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(loadedCount.load(), threadCount * 1000);
+
+    auto stats = textureManager.getStats();
+    EXPECT_EQ(stats.textureCount, 2);
+    EXPECT_EQ(stats.keyLookupCount, 4);
+
+    // Removing a texture removes its key, so the next request loads it again.
+    textureManager.removeTexture(handleSrgb);
+    EXPECT(!textureManager.getTextureDesc(handleSrgb).isValid());
+    EXPECT_EQ(textureManager.getStats().textureCount, 1);
+    handleSrgb = textureManager.loadTexture(path, false, true, ResourceBindFlags::ShaderResource, false);
+    EXPECT(textureManager.getTexture(handleSrgb) != nullptr);
+    EXPECT_EQ(textureManager.getStats().textureCount, 2);
+}
+
+GPU_TEST(TextureManager_Residency)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+
+    // Load 256x256 textures with full mip chains.
+    std::vector<TextureManager::TextureHandle> handles;
+    for (const char* name : {"BC1Unorm-ref.png", "BC4Unorm-ref.png", "BC7Unorm-ref.png"})
+    {
+        auto handle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests" / name, true, false, ResourceBindFlags::ShaderResource, false);
+        ASSERT(handle.isValid());
+        handles.push_back(handle);
+    }
+
+    // Without a budget nothing is evicted.
+    EXPECT(textureManager.updateResidency().empty());
+    const uint64_t textureSize = textureManager.getTexture(handles[0])->getTextureSizeInBytes();
+    EXPECT_EQ(textureManager.getStats().textureMemoryInBytes, 3 * textureSize);
+
+    // Set a budget that requires reducing the textures not used in the current frame.
+    textureManager.setResidencyBudget(2 * textureSize);
+    textureManager.markTextureUsed(handles[0]);
+    auto replacements = textureManager.updateResidency();
+    EXPECT(!replacements.empty());
+    for (const auto& r : replacements)
+    {
+        EXPECT(!(r.handle == handles[0]));
+        EXPECT_LT(r.pNewTexture->getWidth(), r.pOldTexture->getWidth());
+        EXPECT(textureManager.getTexture(r.handle) == r.pNewTexture);
+        EXPECT(textureManager.addTexture(r.pNewTexture) == r.handle);
+    }
+
+    auto stats = textureManager.getStats();
+    EXPECT_LE(stats.textureMemoryInBytes, 2 * textureSize);
+    EXPECT_EQ(stats.residencyBudgetInBytes, 2 * textureSize);
+    EXPECT_GT(stats.reducedTextureCount + stats.evictedTextureCount, 0);
+    EXPECT(textureManager.getTextureDesc(handles[0]).residency == TextureManager::ResidencyState::Resident);
+    EXPECT_EQ(textureManager.getTexture(handles[0])->getWidth(), 256);
+
+    // Using a reduced texture reloads it once the budget allows.
+    textureManager.setResidencyBudget(0);
+    textureManager.markTextureUsed(handles[1]);
+    replacements = textureManager.updateResidency();
+    ASSERT_EQ(replacements.size(), 1);
+    EXPECT(replacements[0].handle == handles[1]);
+    EXPECT_EQ(replacements[0].pNewTexture->getWidth(), 256);
+    EXPECT(textureManager.getTextureDesc(handles[1]).residency == TextureManager::ResidencyState::Resident);
+    EXPECT_EQ(textureManager.getStats().residencyReloadCount, 1);
+}
+
+GPU_TEST(TextureManager_ResidencyUsedOverBudget)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+
+    std::vector<TextureManager::TextureHandle> handles;
+    for (const char* name : {"BC1Unorm-ref.png", "BC4Unorm-ref.png", "BC7Unorm-ref.png"})
+    {
+        auto handle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests" / name, true, false, ResourceBindFlags::ShaderResource, false);
+        ASSERT(handle.isValid());
+        handles.push_back(handle);
+    }
+
+    // Loading counts as use. Advance a frame, so that only textures marked below are in use.
+    EXPECT(textureManager.updateResidency().empty());
+
+    // The first two textures are used every frame, and together they exceed the budget.
+    const uint64_t textureSize = textureManager.getTexture(handles[0])->getTextureSizeInBytes();
+    const uint64_t budget = textureSize + textureSize / 2 + textureSize / 8;
+    textureManager.setResidencyBudget(budget);
+    for (uint32_t frame = 0; frame < 20; ++frame)
+    {
+        textureManager.markTextureUsed(handles[0]);
+        textureManager.markTextureUsed(handles[1]);
+        auto replacements = textureManager.updateResidency();
+
+        // The budget is met on the first frame. Afterwards the textures are not reloaded, as they don't fit.
+        EXPECT_LE(textureManager.getStats().textureMemoryInBytes, budget) << "frame = " << frame;
+        if (frame > 0)
+            EXPECT(replacements.empty()) << "frame = " << frame;
+    }
+
+    // The unused texture is evicted first. One used texture keeps its full resolution, the other has its top mip dropped.
+    EXPECT(textureManager.getTextureDesc(handles[2]).residency == TextureManager::ResidencyState::Evicted);
+    const uint32_t width0 = textureManager.getTexture(handles[0])->getWidth();
+    const uint32_t width1 = textureManager.getTexture(handles[1])->getWidth();
+    EXPECT_EQ(std::max(width0, width1), 256);
+    EXPECT_EQ(std::min(width0, width1), 128);
+    EXPECT_EQ(textureManager.getStats().reducedTextureCount, 1);
+
+    // Raising the budget streams the used texture back in, but not the unused one.
+    textureManager.setResidencyBudget(4 * textureSize);
+    textureManager.markTextureUsed(handles[0]);
+    textureManager.markTextureUsed(handles[1]);
+    auto replacements = textureManager.updateResidency();
+    ASSERT_EQ(replacements.size(), 1);
+    EXPECT_EQ(replacements[0].pNewTexture->getWidth(), 256);
+    EXPECT(textureManager.getTextureDesc(handles[0]).residency == TextureManager::ResidencyState::Resident);
+    EXPECT(textureManager.getTextureDesc(handles[1]).residency == TextureManager::ResidencyState::Resident);
+    EXPECT(textureManager.getTextureDesc(handles[2]).residency == TextureManager::ResidencyState::Evicted);
+}
+
+GPU_TEST(TextureManager_ResidencyInitialLoad)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+    auto path = getRuntimeDirectory() / "data/tests";
+
+    // All textures have the same size when loaded at full resolution.
+    auto pFullTexture = Texture::createFromFile(pDevice, path / "BC1Unorm-ref.png", true, false);
+    ASSERT(pFullTexture != nullptr);
+    const uint64_t textureSize = pFullTexture->getTextureSizeInBytes();
+    const uint64_t budget = textureSize * 7 / 4;
+
+    // Textures loaded while over budget are reduced right away instead of being resident at full resolution first.
+    textureManager.setResidencyBudget(budget);
+    std::vector<TextureManager::TextureHandle> handles;
+    for (const char* name : {"BC1Unorm-ref.png", "BC4Unorm-ref.png", "BC7Unorm-ref.png"})
+    {
+        auto handle = textureManager.loadTexture(path / name, true, false, ResourceBindFlags::ShaderResource, false);
+        ASSERT(handle.isValid());
+        handles.push_back(handle);
+        EXPECT_LE(textureManager.getStats().textureMemoryInBytes, budget) << name;
+    }
+    EXPECT(textureManager.getTextureDesc(handles[0]).residency == TextureManager::ResidencyState::Resident);
+    EXPECT(textureManager.getTextureDesc(handles[1]).residency != TextureManager::ResidencyState::Resident);
+    EXPECT(textureManager.getTextureDesc(handles[2]).residency != TextureManager::ResidencyState::Resident);
+    EXPECT_LT(textureManager.getTexture(handles[1])->getWidth(), 256);
+}
 } // namespace Falcor
@@ -0,0 +1,364 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const size_t kTaskCount = 10000;
+
+/// Reference implementation of the previous dispatcher: one std::thread per task, oldest slot joined round-robin.
+class ThreadPerTaskDispatcher
+{
+public:
+    ThreadPerTaskDispatcher(size_t threadCount) : mThreads(threadCount) {}
+    ~ThreadPerTaskDispatcher() { finish(); }
+
+    void dispatch(const std::function<void(void)>& func)
+    {
+        std::thread& t = mThreads[mCurrent];
+        if (t.joinable())
+            t.join();
+        t = std::thread(func);
+        mCurrent = (mCurrent + 1) % mThreads.size();
+    }
+
+    void finish()
+    {
+        for (auto& t : mThreads)
+        {
+            if (t.joinable())
+                t.join();
+        }
+    }
+
+private:
+    std::vector<std::thread> mThreads;
+    size_t mCurrent = 0;
+};
+} // namespace
+
+CPU_TEST(Threading_DispatchTask)
+{
+    std::atomic<size_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    for (size_t i = 0; i < kTaskCount; ++i)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+
+    for (auto& task : tasks)
+    {
+        task.finish();
+        EXPECT(!task.isRunning());
+    }
+    EXPECT_EQ(counter.load(), kTaskCount);
+
+    // Default constructed handles are not running and finish immediately.
+    Threading::Task empty;
+    EXPECT(!empty.isValid());
+    EXPECT(!empty.isRunning());
+    empty.finish();
+}
+
+CPU_TEST(Threading_Continuation)
+{
+    std::atomic<int> order{0};
+    int first = -1, second = -1, third = -1;
+
+    Threading::Task task = Threading::dispatchTask([&]() { first = order++; });
+    Threading::Task last = task.then([&]() { second = order++; }).then([&]() { third = order++; });
+    last.finish();
+
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 1);
+    EXPECT_EQ(third, 2);
+
+    // Continuation on a finished task runs right away.
+    int late = -1;
+    task.then([&]() { late = order++; }).finish();
+    EXPECT_EQ(late, 3);
+}
+
+CPU_TEST(Threading_Exception)
+{
+    Threading::Task task = Threading::dispatchTask([]() { throw RuntimeError("Task failed"); });
+    bool caught = false;
+    try
+    {
+        task.finish();
+    }
+    catch (const RuntimeError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+
+    caught = false;
+    try
+    {
+        Threading::parallelFor(
+            0, 1000,
+            [](size_t begin, size_t end)
+            {
+                if (begin <= 500 && 500 < end)
+                    throw RuntimeError("Chunk failed");
+            }
+        );
+    }
+    catch (const RuntimeError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+}
+
+CPU_TEST(Threading_TaskGroup)
+{
+    std::atomic<size_t> counter{0};
+    {
+        Threading::TaskGroup group;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            group.run(
+                [&counter]()
+                {
+                    // Nested groups must not deadlock when all workers are waiting.
+                    Threading::TaskGroup inner;
+                    for (size_t j = 0; j < 10; ++j)
+                        inner.run([&counter]() { counter++; });
+                    inner.finish();
+                }
+            );
+        }
+        group.finish();
+    }
+    EXPECT_EQ(counter.load(), size_t(1000));
+}
+
+CPU_TEST(Threading_TaskGroupHelping)
+{
+    // Occupy all workers, so the calling thread, which is not part of the pool, has to execute all tasks of the
+    // nested groups itself while waiting.
+    const uint32_t workerCount = Threading::getThreadCount();
+    if (workerCount == 0)
+        return;
+
+    std::atomic<uint32_t> blockedCount{0};
+    std::atomic<bool> release{false};
+    std::vector<Threading::Task> blockers;
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        blockers.push_back(Threading::dispatchTask(
+            [&]()
+            {
+                blockedCount++;
+                while (!release)
+                    std::this_thread::yield();
+            }
+        ));
+    }
+    while (blockedCount < workerCount)
+        std::this_thread::yield();
+
+    std::atomic<size_t> counter{0};
+    Threading::TaskGroup group;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        group.run(
+            [&counter]()
+            {
+                Threading::TaskGroup inner;
+                for (size_t j = 0; j < 10; ++j)
+                    inner.run([&counter]() { counter++; });
+                inner.finish();
+            }
+        );
+    }
+    group.finish();
+    EXPECT_EQ(counter.load(), size_t(100));
+
+    release = true;
+    for (auto& blocker : blockers)
+        blocker.finish();
+}
+
+CPU_TEST(Threading_TaskGroupException)
+{
+    bool caught = false;
+    {
+        Threading::TaskGroup group;
+        for (size_t i = 0; i < 10; ++i)
+        {
+            group.run(
+                [i]()
+                {
+                    if (i == 5)
+                        throw RuntimeError("Task failed");
+                }
+            );
+        }
+        try
+        {
+            group.finish();
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+
+        // The exception is only reported once.
+        group.finish();
+    }
+    EXPECT(caught);
+
+    // Destroying a group with a failed task logs the exception instead of throwing.
+    {
+        Threading::TaskGroup group;
+        group.run([]() { throw RuntimeError("Task failed"); });
+    }
+}
+
+CPU_TEST(Threading_ParallelFor)
+{
+    for (size_t count : {0, 1, 7, 1000, 100000})
+    {
+        for (size_t grainSize : {0, 1, 13, 4096})
+        {
+            std::vector<std::atomic<uint32_t>> visited(count);
+            std::atomic<bool> chunkTooLarge{false};
+            Threading::parallelFor(
+                0, count,
+                [&](size_t begin, size_t end)
+                {
+                    if (grainSize > 0 && end - begin > grainSize)
+                        chunkTooLarge = true;
+                    for (size_t i = begin; i < end; ++i)
+                        visited[i]++;
+                },
+                grainSize
+            );
+
+            EXPECT(!chunkTooLarge);
+            for (size_t i = 0; i < count; ++i)
+                EXPECT_EQ(visited[i].load(), 1u) << fmt::format("count={} grainSize={} i={}", count, grainSize, i);
+        }
+    }
+}
+
+CPU_TEST(Threading_ParallelReduce)
+{
+    std::vector<float> values(1 << 20);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = 1.f / (float)(i + 1);
+
+    auto sumRange = [&](size_t begin, size_t end)
+    {
+        float sum = 0.f;
+        for (size_t i = begin; i < end; ++i)
+            sum += values[i];
+        return sum;
+    };
+    auto add = [](float a, float b) { return a + b; };
+
+    // Chunk results are combined in order, the result must be identical to a serial chunked reduction.
+    const size_t grainSize = 1000;
+    float expected = 0.f;
+    for (size_t begin = 0; begin < values.size(); begin += grainSize)
+        expected += sumRange(begin, std::min(begin + grainSize, values.size()));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        float result = Threading::parallelReduce(size_t(0), values.size(), 0.f, sumRange, add, grainSize);
+        EXPECT_EQ(result, expected);
+    }
+
+    std::vector<uint64_t> ints(100000);
+    std::iota(ints.begin(), ints.end(), 0);
+    uint64_t sum = Threading::parallelReduce(
+        size_t(0), ints.size(), uint64_t(0),
+        [&](size_t begin, size_t end) { return std::accumulate(ints.begin() + begin, ints.begin() + end, uint64_t(0)); },
+        [](uint64_t a, uint64_t b) { return a + b; }
+    );
+    EXPECT_EQ(sum, uint64_t(99999) * 100000 / 2);
+}
+
+CPU_BENCHMARK(Threading_DispatchOverhead)
+{
+    std::atomic<size_t> counter{0};
+    auto func = [&counter]() { counter++; };
+
+    ctx.measure(
+        "ThreadPerTask",
+        [&]()
+        {
+            ThreadPerTaskDispatcher dispatcher(std::max(1u, Threading::getThreadCount()));
+            for (size_t i = 0; i < kTaskCount; ++i)
+                dispatcher.dispatch(func);
+        },
+        Throughput::items(kTaskCount)
+    );
+
+    ctx.measure(
+        "ThreadPool",
+        [&]()
+        {
+            for (size_t i = 0; i < kTaskCount; ++i)
+                Threading::dispatchTask(func);
+            Threading::finish();
+        },
+        Throughput::items(kTaskCount)
+    );
+
+    ctx.measure(
+        "ParallelFor",
+        [&]()
+        {
+            Threading::parallelFor(
+                0, kTaskCount,
+                [&](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                        func();
+                },
+                1
+            );
+        },
+        Throughput::items(kTaskCount)
+    );
+
+    // Every measured iteration must have run all of its tasks.
+    EXPECT_GT(counter.load(), 0);
+    EXPECT_EQ(counter.load() % kTaskCount, 0);
+}
+} // namespace Falcor
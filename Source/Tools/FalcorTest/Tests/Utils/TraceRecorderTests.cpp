@@ -0,0 +1,270 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/TraceRecorder.h"
+
+#include <nlohmann/json.hpp>
+
+#include <map>
+#include <set>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+/// Enables the trace recorder for the lifetime of the object and restores the previous state afterwards.
+class ScopedTraceRecording
+{
+public:
+    ScopedTraceRecording() : mWasEnabled(TraceRecorder::isEnabled())
+    {
+        TraceRecorder::clear();
+        TraceRecorder::setEnabled(true);
+    }
+
+    ~ScopedTraceRecording()
+    {
+        TraceRecorder::setEnabled(mWasEnabled);
+        TraceRecorder::setBufferCapacity(TraceRecorder::kDefaultBufferCapacity);
+        TraceRecorder::clear();
+    }
+
+private:
+    bool mWasEnabled;
+};
+
+nlohmann::json exportTrace()
+{
+    return nlohmann::json::parse(TraceRecorder::toChromeTraceJson());
+}
+
+/// Returns the thread ID of the track with the given name, or -1 if it does not exist.
+int64_t findThread(const nlohmann::json& trace, const std::string& name)
+{
+    for (const auto& e : trace["traceEvents"])
+    {
+        if (e["ph"] == "M" && e["name"] == "thread_name" && e["args"]["name"] == name)
+            return e["tid"].get<int64_t>();
+    }
+    return -1;
+}
+
+size_t countSlices(const nlohmann::json& trace, const std::string& name, int64_t tid = -1)
+{
+    size_t count = 0;
+    for (const auto& e : trace["traceEvents"])
+    {
+        if (e["ph"] == "X" && e["name"] == name && (tid < 0 || e["tid"].get<int64_t>() == tid))
+            count++;
+    }
+    return count;
+}
+} // namespace
+
+CPU_TEST(TraceRecorder_InternString)
+{
+    uint32_t a = TraceRecorder::internString("TraceRecorderTest_A");
+    uint32_t b = TraceRecorder::internString("TraceRecorderTest_B");
+    EXPECT_NE(a, TraceRecorder::kInvalidStringID);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(TraceRecorder::internString(std::string("TraceRecorderTest_") + "A"), a);
+    EXPECT_EQ(TraceRecorder::getString(a), "TraceRecorderTest_A");
+    EXPECT_EQ(TraceRecorder::getString(b), "TraceRecorderTest_B");
+    EXPECT_EQ(TraceRecorder::getString(TraceRecorder::kInvalidStringID), "");
+}
+
+CPU_TEST(TraceRecorder_Disabled)
+{
+    ScopedTraceRecording recording;
+    TraceRecorder::setEnabled(false);
+
+    {
+        FALCOR_TRACE_SCOPE("TraceRecorderTest_Disabled");
+    }
+    EXPECT_EQ(TraceRecorder::beginFlow(), 0);
+
+    EXPECT_EQ(countSlices(exportTrace(), "TraceRecorderTest_Disabled"), 0);
+}
+
+CPU_TEST(TraceRecorder_Nesting)
+{
+    ScopedTraceRecording recording;
+
+    std::thread thread(
+        []()
+        {
+            TraceRecorder::setThreadName("TraceRecorderTest_Nesting");
+            FALCOR_TRACE_SCOPE("Outer");
+            for (int i = 0; i < 3; ++i)
+            {
+                FALCOR_TRACE_SCOPE("Inner");
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }
+        }
+    );
+    thread.join();
+
+    auto trace = exportTrace();
+    int64_t tid = findThread(trace, "TraceRecorderTest_Nesting");
+    ASSERT_GE(tid, 0);
+    EXPECT_EQ(countSlices(trace, "Outer", tid), 1);
+    EXPECT_EQ(countSlices(trace, "Inner", tid), 3);
+
+    // Slices are sorted by start time with the enclosing slice first, and inner slices lie within the outer slice.
+    double outerBegin = 0.0, outerEnd = 0.0, lastBegin = -1.0;
+    bool foundOuter = false;
+    for (const auto& e : trace["traceEvents"])
+    {
+        if (e["ph"] != "X" || e["tid"].get<int64_t>() != tid)
+            continue;
+        double begin = e["ts"].get<double>();
+        double end = begin + e["dur"].get<double>();
+        EXPECT_GE(begin, lastBegin);
+        lastBegin = begin;
+        if (e["name"] == "Outer")
+        {
+            foundOuter = true;
+            outerBegin = begin;
+            outerEnd = end;
+        }
+        else
+        {
+            EXPECT(foundOuter);
+            EXPECT_GE(begin, outerBegin);
+            EXPECT_LE(end, outerEnd);
+        }
+    }
+}
+
+CPU_TEST(TraceRecorder_ThreadPool)
+{
+    ScopedTraceRecording recording;
+
+    const size_t kTaskCount = 64;
+    {
+        FALCOR_TRACE_SCOPE("TraceRecorderTest_Dispatch");
+        std::vector<Threading::Task> tasks;
+        for (size_t i = 0; i < kTaskCount; ++i)
+        {
+            tasks.push_back(Threading::dispatchTask(
+                []()
+                {
+                    FALCOR_TRACE_SCOPE("TraceRecorderTest_Work");
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            ));
+        }
+        for (auto& task : tasks)
+            task.finish();
+    }
+
+    auto trace = exportTrace();
+    EXPECT_EQ(countSlices(trace, "TraceRecorderTest_Dispatch"), 1);
+    EXPECT_EQ(countSlices(trace, "TraceRecorderTest_Work"), kTaskCount);
+    EXPECT_GE(countSlices(trace, "Task"), kTaskCount);
+    if (Threading::getThreadCount() > 0)
+        EXPECT_GE(findThread(trace, "Worker 0"), 0);
+
+    // Every task has a flow from the dispatching thread to the thread executing it.
+    std::map<uint64_t, std::set<std::string>> flows;
+    for (const auto& e : trace["traceEvents"])
+    {
+        if (e["ph"] == "s" || e["ph"] == "f")
+            flows[e["id"].get<uint64_t>()].insert(e["ph"].get<std::string>());
+    }
+    EXPECT_GE(flows.size(), kTaskCount);
+    for (const auto& [id, phases] : flows)
+        EXPECT_EQ(phases.size(), 2);
+}
+
+CPU_TEST(TraceRecorder_Overflow)
+{
+    ScopedTraceRecording recording;
+
+    // The capacity only applies to threads that have not recorded yet, so record from a new thread.
+    const size_t kCapacity = 16;
+    const size_t kSliceCount = 100;
+    TraceRecorder::setBufferCapacity(kCapacity);
+    std::thread thread(
+        [&]()
+        {
+            TraceRecorder::setThreadName("TraceRecorderTest_Overflow");
+            for (size_t i = 0; i < kSliceCount; ++i)
+            {
+                FALCOR_TRACE_SCOPE("Slice");
+            }
+        }
+    );
+    thread.join();
+
+    auto trace = exportTrace();
+    int64_t tid = findThread(trace, "TraceRecorderTest_Overflow");
+    ASSERT_GE(tid, 0);
+    size_t sliceCount = countSlices(trace, "Slice", tid);
+    EXPECT_GT(sliceCount, 0);
+    EXPECT_LE(sliceCount, kCapacity);
+    EXPECT_GE(TraceRecorder::getDroppedEventCount(), kSliceCount - kCapacity);
+
+    TraceRecorder::clear();
+    EXPECT_EQ(TraceRecorder::getDroppedEventCount(), 0);
+    EXPECT_EQ(countSlices(exportTrace(), "Slice", tid), 0);
+}
+
+CPU_BENCHMARK(TraceRecorder_ScopeOverhead)
+{
+    ScopedTraceRecording recording;
+
+    const size_t kScopeCount = 1000000;
+    ctx.measure(
+        "Enabled",
+        [&]()
+        {
+            for (size_t i = 0; i < kScopeCount; ++i)
+            {
+                FALCOR_TRACE_SCOPE("TraceRecorderTest_Scope");
+            }
+        },
+        Throughput::items((double)kScopeCount)
+    );
+
+    TraceRecorder::setEnabled(false);
+    ctx.measure(
+        "Disabled",
+        [&]()
+        {
+            for (size_t i = 0; i < kScopeCount; ++i)
+            {
+                FALCOR_TRACE_SCOPE("TraceRecorderTest_Scope");
+            }
+        },
+        Throughput::items((double)kScopeCount)
+    );
+}
+} // namespace Falcor
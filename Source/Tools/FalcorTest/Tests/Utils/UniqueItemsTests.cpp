@@ -0,0 +1,167 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/UniqueItems.h"
+#include "Utils/Math/FNVHash.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Polymorphic item mimicking a material with a virtual equality test.
+struct Item
+{
+    virtual ~Item() = default;
+    virtual bool isEqual(const Item& other) const = 0;
+    virtual uint64_t computeHash() const = 0;
+};
+
+struct ParamItem : Item
+{
+    float params[16] = {};
+
+    bool isEqual(const Item& other) const override
+    {
+        auto pOther = dynamic_cast<const ParamItem*>(&other);
+        if (!pOther)
+            return false;
+        for (size_t i = 0; i < std::size(params); ++i)
+            if (params[i] != pOther->params[i])
+                return false;
+        return true;
+    }
+
+    uint64_t computeHash() const override { return fnvHashArray64(params, sizeof(params)); }
+};
+
+/// Generate items where roughly half of the items are duplicates of earlier items.
+std::vector<std::unique_ptr<Item>> generateItems(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    std::vector<std::unique_ptr<Item>> items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto pItem = std::make_unique<ParamItem>();
+        if (i > 0 && rng() % 2 == 0)
+        {
+            *pItem = static_cast<const ParamItem&>(*items[rng() % i]);
+        }
+        else
+        {
+            for (auto& p : pItem->params)
+                p = dist(rng);
+        }
+        items.push_back(std::move(pItem));
+    }
+    return items;
+}
+
+/// Reference implementation: compare each item against all unique items found so far.
+std::vector<size_t> findUniqueItemsQuadratic(const std::vector<std::unique_ptr<Item>>& items, std::vector<size_t>& uniqueMap)
+{
+    std::vector<size_t> uniqueItems;
+    uniqueMap.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        auto it = std::find_if(uniqueItems.begin(), uniqueItems.end(), [&](size_t u) { return items[u]->isEqual(*items[i]); });
+        uniqueMap[i] = it == uniqueItems.end() ? uniqueItems.size() : (size_t)std::distance(uniqueItems.begin(), it);
+        if (it == uniqueItems.end())
+            uniqueItems.push_back(i);
+    }
+    return uniqueItems;
+}
+
+std::vector<size_t> findUniqueItemsHashed(const std::vector<std::unique_ptr<Item>>& items, std::vector<size_t>& uniqueMap)
+{
+    std::vector<uint64_t> hashes(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+        hashes[i] = items[i]->computeHash();
+    return findUniqueItems(hashes, [&](size_t a, size_t b) { return items[a]->isEqual(*items[b]); }, uniqueMap);
+}
+} // namespace
+
+CPU_TEST(UniqueItems_Empty)
+{
+    std::vector<size_t> uniqueMap = {1, 2, 3};
+    auto uniqueItems = findUniqueItems({}, [](size_t, size_t) { return true; }, uniqueMap);
+    EXPECT(uniqueItems.empty());
+    EXPECT(uniqueMap.empty());
+}
+
+CPU_TEST(UniqueItems_MatchesQuadratic)
+{
+    auto items = generateItems(2000, 1);
+
+    std::vector<size_t> expectedMap;
+    auto expected = findUniqueItemsQuadratic(items, expectedMap);
+
+    std::vector<size_t> uniqueMap;
+    auto uniqueItems = findUniqueItemsHashed(items, uniqueMap);
+    EXPECT(uniqueItems == expected);
+    EXPECT(uniqueMap == expectedMap);
+    EXPECT_LT(uniqueItems.size(), items.size());
+
+    // All items colliding in one bucket must give the same result.
+    std::vector<uint64_t> hashes(items.size(), 0);
+    uniqueItems = findUniqueItems(hashes, [&](size_t a, size_t b) { return items[a]->isEqual(*items[b]); }, uniqueMap);
+    EXPECT(uniqueItems == expected);
+    EXPECT(uniqueMap == expectedMap);
+}
+
+CPU_BENCHMARK(UniqueItems_Scaling)
+{
+    for (size_t count : {1000, 10000, 50000})
+    {
+        auto items = generateItems(count, 2);
+        std::vector<size_t> uniqueMap;
+        size_t uniqueCount = 0;
+
+        // The quadratic search is too slow for the largest size.
+        if (count <= 10000)
+        {
+            ctx.measure(
+                fmt::format("Quadratic/{}", count), [&]() { uniqueCount = findUniqueItemsQuadratic(items, uniqueMap).size(); },
+                Throughput::items(count)
+            );
+        }
+
+        size_t hashedCount = 0;
+        ctx.measure(
+            fmt::format("Hashed/{}", count), [&]() { hashedCount = findUniqueItemsHashed(items, uniqueMap).size(); }, Throughput::items(count)
+        );
+        if (uniqueCount > 0)
+            EXPECT_EQ(hashedCount, uniqueCount);
+    }
+}
+} // namespace Falcor
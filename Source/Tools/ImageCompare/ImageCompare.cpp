@@ -25,21 +25,46 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
+#include "Utils/Image/FLIP.h"
+#include "Utils/Threading.h"
+
 #include <FreeImage.h>
 #include <args.hxx>
+#include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <map>
+#include <set>
 #include <functional>
 #include <filesystem>
 
 #include <cmath>
 #include <cstring>
 
+#if defined(_M_X64) || defined(__x86_64__)
+#define IMAGE_COMPARE_SSE 1
+#include <emmintrin.h>
+#else
+#define IMAGE_COMPARE_SSE 0
+#endif
+
+using namespace Falcor;
+using json = nlohmann::json;
+
+/// Number of image rows processed per tile.
+static const uint32_t kTileRows = 64;
+
+/// Maximum number of image pairs that are compared at the same time when comparing directories.
+/// Each pair holds both images and its heat map in memory, the threads are kept busy by the tiles of each comparison.
+static const size_t kMaxPairsInFlight = 4;
+
 template<typename T>
 T sqr(T x)
 {
@@ -70,44 +95,6 @@ public:
 
     static std::shared_ptr<Image> create(uint32_t width, uint32_t height) { return std::make_shared<Image>(width, height); }
 
-    static std::shared_ptr<Image> loadFromFile(const std::filesystem::path& path)
-    {
-        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
-
-        auto pathStr = path.string();
-
-        // Determine file format.
-        fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
-        if (fifFormat == FIF_UNKNOWN)
-            fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
-        if (fifFormat == FIF_UNKNOWN)
-            throw std::runtime_error("Unknown image format");
-        if (!FreeImage_FIFSupportsReading(fifFormat))
-            throw std::runtime_error("Unsupported image format");
-
-        // Read image.
-        FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, pathStr.c_str());
-        if (!srcBitmap)
-            throw std::runtime_error("Cannot read image");
-
-        // Convert to RGBA32F.
-        FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
-        FreeImage_Unload(srcBitmap);
-        if (!floatBitmap)
-            throw std::runtime_error("Cannot convert to RGBA float format");
-
-        // Create image.
-        auto image = create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
-        int bytesPerPixel = 4 * sizeof(float);
-        FreeImage_ConvertToRawBits(
-            reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK,
-            FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true
-        );
-        FreeImage_Unload(floatBitmap);
-
-        return image;
-    }
-
     void saveToFile(const std::filesystem::path& path, bool writeAlpha = true) const
     {
         FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
@@ -182,84 +169,351 @@ private:
     std::unique_ptr<float[]> mData;
 };
 
+/**
+ * Image loaded from a file.
+ * Pixels are kept in the decoded format and converted to RGBA float one row at a time,
+ * so comparing images never requires a full float copy of either image.
+ */
+class ImageFile
+{
+public:
+    ~ImageFile() { FreeImage_Unload(mpBitmap); }
+
+    uint32_t getWidth() const { return mWidth; }
+    uint32_t getHeight() const { return mHeight; }
+
+    static std::shared_ptr<ImageFile> loadFromFile(const std::filesystem::path& path)
+    {
+        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+        auto pathStr = path.string();
+
+        // Determine file format.
+        fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
+        if (fifFormat == FIF_UNKNOWN)
+            fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
+        if (fifFormat == FIF_UNKNOWN)
+            throw std::runtime_error("Unknown image format");
+        if (!FreeImage_FIFSupportsReading(fifFormat))
+            throw std::runtime_error("Unsupported image format");
+
+        // Read image.
+        FIBITMAP* bitmap = FreeImage_Load(fifFormat, pathStr.c_str());
+        if (!bitmap)
+            throw std::runtime_error("Cannot read image");
+
+        // Formats without a row converter are converted to 32-bit or RGBA32F once.
+        if (!isNativeFormat(bitmap))
+        {
+            FIBITMAP* convertedBitmap =
+                FreeImage_GetImageType(bitmap) == FIT_BITMAP ? FreeImage_ConvertTo32Bits(bitmap) : FreeImage_ConvertToRGBAF(bitmap);
+            FreeImage_Unload(bitmap);
+            if (!convertedBitmap)
+                throw std::runtime_error("Cannot convert to RGBA float format");
+            bitmap = convertedBitmap;
+        }
+
+        return std::shared_ptr<ImageFile>(new ImageFile(bitmap));
+    }
+
+    /**
+     * Convert a row of the image to RGBA float format.
+     * @param[in] y Row index, counted from the top of the image.
+     * @param[out] dst Destination for getWidth() RGBA float pixels.
+     */
+    void readRow(uint32_t y, float* dst) const
+    {
+        const BYTE* src = FreeImage_GetScanLine(mpBitmap, mHeight - y - 1);
+        switch (FreeImage_GetImageType(mpBitmap))
+        {
+        case FIT_RGBAF:
+            std::memcpy(dst, src, mWidth * 4 * sizeof(float));
+            break;
+        case FIT_RGBF:
+        {
+            const FIRGBF* pixels = reinterpret_cast<const FIRGBF*>(src);
+            for (uint32_t x = 0; x < mWidth; ++x, dst += 4)
+            {
+                dst[0] = pixels[x].red;
+                dst[1] = pixels[x].green;
+                dst[2] = pixels[x].blue;
+                dst[3] = 1.f;
+            }
+            break;
+        }
+        case FIT_FLOAT:
+        {
+            const float* pixels = reinterpret_cast<const float*>(src);
+            for (uint32_t x = 0; x < mWidth; ++x, dst += 4)
+            {
+                dst[0] = dst[1] = dst[2] = pixels[x];
+                dst[3] = 1.f;
+            }
+            break;
+        }
+        case FIT_RGBA16:
+        {
+            const FIRGBA16* pixels = reinterpret_cast<const FIRGBA16*>(src);
+            for (uint32_t x = 0; x < mWidth; ++x, dst += 4)
+            {
+                dst[0] = pixels[x].red / 65535.f;
+                dst[1] = pixels[x].green / 65535.f;
+                dst[2] = pixels[x].blue / 65535.f;
+                dst[3] = pixels[x].alpha / 65535.f;
+            }
+            break;
+        }
+        case FIT_RGB16:
+        {
+            const FIRGB16* pixels = reinterpret_cast<const FIRGB16*>(src);
+            for (uint32_t x = 0; x < mWidth; ++x, dst += 4)
+            {
+                dst[0] = pixels[x].red / 65535.f;
+                dst[1] = pixels[x].green / 65535.f;
+                dst[2] = pixels[x].blue / 65535.f;
+                dst[3] = 1.f;
+            }
+            break;
+        }
+        default: // 24-bit or 32-bit bitmap.
+        {
+            const uint32_t bytesPerPixel = FreeImage_GetBPP(mpBitmap) / 8;
+            for (uint32_t x = 0; x < mWidth; ++x)
+            {
+                dst[0] = src[FI_RGBA_RED] / 255.f;
+                dst[1] = src[FI_RGBA_GREEN] / 255.f;
+                dst[2] = src[FI_RGBA_BLUE] / 255.f;
+                dst[3] = bytesPerPixel == 4 ? src[FI_RGBA_ALPHA] / 255.f : 1.f;
+                src += bytesPerPixel;
+                dst += 4;
+            }
+            break;
+        }
+        }
+    }
+
+private:
+    ImageFile(FIBITMAP* bitmap) : mpBitmap(bitmap), mWidth(FreeImage_GetWidth(bitmap)), mHeight(FreeImage_GetHeight(bitmap)) {}
+
+    static bool isNativeFormat(FIBITMAP* bitmap)
+    {
+        switch (FreeImage_GetImageType(bitmap))
+        {
+        case FIT_RGBAF:
+        case FIT_RGBF:
+        case FIT_FLOAT:
+        case FIT_RGBA16:
+        case FIT_RGB16:
+            return true;
+        case FIT_BITMAP:
+            return FreeImage_GetBPP(bitmap) == 24 || FreeImage_GetBPP(bitmap) == 32;
+        default:
+            return false;
+        }
+    }
+
+    FIBITMAP* mpBitmap;
+    uint32_t mWidth;
+    uint32_t mHeight;
+};
+
+/// Rows of two images in RGBA float format, with haloRows rows of context above and below the tile.
+/// Context rows outside of the image replicate the closest edge row.
+struct Tile
+{
+    uint32_t width;
+    uint32_t rowCount;
+    uint32_t haloRows;
+    const float* a;
+    const float* b;
+};
+
+// Per-channel error functions. The SSE versions compute the same error for all four channels of a pixel at once.
+
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static float error(float a, float b) { return sqr(a - b); }
+#if IMAGE_COMPARE_SSE
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_mul_ps(d, d);
     }
+#endif
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static float error(float a, float b) { return sqr(a - b) / (sqr(a) + 1e-3f); }
+#if IMAGE_COMPARE_SSE
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_div_ps(_mm_mul_ps(d, d), _mm_add_ps(_mm_mul_ps(a, a), _mm_set1_ps(1e-3f)));
     }
+#endif
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static float error(float a, float b) { return std::fabs(a - b); }
+#if IMAGE_COMPARE_SSE
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        return _mm_and_ps(_mm_sub_ps(a, b), absMask);
     }
+#endif
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 100.f;
+    static float error(float a, float b) { return std::fabs((a - b) / (a + 1e-3f)); }
+#if IMAGE_COMPARE_SSE
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        return _mm_and_ps(_mm_div_ps(_mm_sub_ps(a, b), _mm_add_ps(a, _mm_set1_ps(1e-3f))), absMask);
     }
+#endif
 };
 
+/// Computes the per-pixel error (mean over channels) of a tile. Returns the sum of the per-pixel errors.
 template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+double compare(const Tile& tile, bool alpha, float* errorMap)
 {
-    Metric metric;
+    const size_t offset = size_t(tile.haloRows) * tile.width * 4;
+    const float* a = tile.a + offset;
+    const float* b = tile.b + offset;
+    const size_t count = size_t(tile.width) * tile.rowCount;
+    const float scale = Metric::kScale / (alpha ? 4.f : 3.f);
+
+#if IMAGE_COMPARE_SSE
+    const __m128 channelMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, alpha ? -1 : 0));
+#endif
+
     double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
     for (size_t i = 0; i < count; ++i)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
+#if IMAGE_COMPARE_SSE
+        __m128 errors = _mm_and_ps(Metric::error(_mm_loadu_ps(a), _mm_loadu_ps(b)), channelMask);
+        __m128 shuffled = _mm_shuffle_ps(errors, errors, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(errors, shuffled);
+        sums = _mm_add_ss(sums, _mm_movehl_ps(shuffled, sums));
+        float error = _mm_cvtss_f32(sums) * scale;
+#else
+        float error = Metric::error(a[0], b[0]) + Metric::error(a[1], b[1]) + Metric::error(a[2], b[2]);
+        if (alpha)
+            error += Metric::error(a[3], b[3]);
+        error *= scale;
+#endif
         if (errorMap)
-            *errorMap++ = float(error);
+            *errorMap++ = error;
         sum += error;
         a += 4;
         b += 4;
     }
-    return sum / count;
+    return sum;
+}
+
+static const FLIP kFLIP;
+
+static double compareFLIP(const Tile& tile, bool /* alpha */, float* errorMap)
+{
+    std::vector<float> errors(errorMap ? 0 : size_t(tile.width) * tile.rowCount);
+    return kFLIP.compute(tile.width, tile.rowCount, tile.a, tile.b, errorMap ? errorMap : errors.data());
 }
 
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    uint32_t haloRows; ///< Number of rows of context needed above and below each tile.
+    std::function<double(const Tile& tile, bool alpha, float* errorMap)> compare;
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
-    {"mse", "Mean Squared Error", compare<MSE>},
-    {"rmse", "Relative Mean Squared Error", compare<RMSE>},
-    {"mae", "Mean Absolute Error", compare<MAE>},
-    {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"mse", "Mean Squared Error", 0, compare<MSE>},
+    {"rmse", "Relative Mean Squared Error", 0, compare<RMSE>},
+    {"mae", "Mean Absolute Error", 0, compare<MAE>},
+    {"mape", "Mean Absolute Percentage Error", 0, compare<MAPE>},
+    {"flip", "FLIP perceptual error (LDR, alpha is ignored)", kFLIP.getRadius(), compareFLIP},
 };
 
+/**
+ * Compute a set of error metrics in a single pass over two images.
+ * The images are processed in tiles of rows in parallel.
+ * @param[in] imageA First image.
+ * @param[in] imageB Second image, must have the same resolution.
+ * @param[in] metrics Metrics to compute.
+ * @param[in] alpha Include the alpha channel.
+ * @param[out] errorMap Optional per-pixel error of the first metric (width * height values).
+ * @return Mean error per metric.
+ */
+static std::vector<double> compareImages(
+    const ImageFile& imageA,
+    const ImageFile& imageB,
+    const std::vector<ErrorMetric>& metrics,
+    bool alpha,
+    float* errorMap
+)
+{
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const uint32_t tileCount = (height + kTileRows - 1) / kTileRows;
+
+    uint32_t haloRows = 0;
+    for (const auto& metric : metrics)
+        haloRows = std::max(haloRows, metric.haloRows);
+
+    // Partial sums are stored per tile and reduced in order, so results do not depend on the thread count.
+    std::vector<double> tileSums(size_t(tileCount) * metrics.size());
+
+    Threading::parallelFor(
+        0, tileCount,
+        [&](size_t first, size_t last)
+        {
+            std::vector<float> rowsA;
+            std::vector<float> rowsB;
+            for (size_t tileIndex = first; tileIndex < last; ++tileIndex)
+            {
+                const uint32_t firstRow = uint32_t(tileIndex) * kTileRows;
+                const uint32_t rowCount = std::min(kTileRows, height - firstRow);
+                const uint32_t totalRows = rowCount + 2 * haloRows;
+                rowsA.resize(size_t(totalRows) * width * 4);
+                rowsB.resize(size_t(totalRows) * width * 4);
+                for (uint32_t row = 0; row < totalRows; ++row)
+                {
+                    uint32_t y = uint32_t(clamp(int(firstRow + row) - int(haloRows), 0, int(height) - 1));
+                    imageA.readRow(y, rowsA.data() + size_t(row) * width * 4);
+                    imageB.readRow(y, rowsB.data() + size_t(row) * width * 4);
+                }
+
+                Tile tile{width, rowCount, haloRows, rowsA.data(), rowsB.data()};
+                for (size_t i = 0; i < metrics.size(); ++i)
+                {
+                    float* tileErrorMap = (i == 0 && errorMap) ? errorMap + size_t(firstRow) * width : nullptr;
+                    tileSums[tileIndex * metrics.size() + i] = metrics[i].compare(tile, alpha, tileErrorMap);
+                }
+            }
+        },
+        1
+    );
+
+    std::vector<double> errors(metrics.size(), 0.0);
+    for (size_t tileIndex = 0; tileIndex < tileCount; ++tileIndex)
+        for (size_t i = 0; i < metrics.size(); ++i)
+            errors[i] += tileSums[tileIndex * metrics.size() + i];
+    for (double& error : errors)
+        error /= double(width) * height;
+
+    return errors;
+}
+
 static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
 {
     auto writeColor = [](float t, float* dst)
@@ -292,76 +546,210 @@ static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, c
     return image;
 }
 
-static bool compareImages(
+struct CompareResult
+{
+    bool success = false;
+    std::vector<double> errors; ///< Mean error per metric, empty if the images could not be compared.
+    std::string message;        ///< Reason the images could not be compared.
+};
+
+/**
+ * Compare two image files.
+ * The comparison succeeds if the error of the first metric is finite and within the threshold.
+ */
+static CompareResult compareImageFiles(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
-    ErrorMetric metric,
+    const std::vector<ErrorMetric>& metrics,
     float threshold,
     bool alpha,
     const std::filesystem::path& heatMapPath
 )
 {
-    auto loadImage = [](const std::filesystem::path& path)
-    {
-        try
-        {
-            return Image::loadFromFile(path);
-        }
-        catch (const std::runtime_error& e)
-        {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
-            return std::shared_ptr<Image>{};
-        }
-    };
+    CompareResult result;
 
-    auto saveImage = [](const Image& image, const std::filesystem::path& path)
+    // Load images.
+    std::shared_ptr<ImageFile> imageA;
+    std::shared_ptr<ImageFile> imageB;
+    for (auto [pImage, pPath] : {std::make_pair(&imageA, &pathA), std::make_pair(&imageB, &pathB)})
     {
         try
         {
-            image.saveToFile(path);
+            *pImage = ImageFile::loadFromFile(*pPath);
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot save image to '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot load image from '" + pPath->string() + "' (Error: " + e.what() + ").";
+            return result;
         }
-    };
-
-    // Load images.
-    auto imageA = loadImage(pathA);
-    if (!imageA)
-        return false;
-    auto imageB = loadImage(pathB);
-    if (!imageB)
-        return false;
+    }
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
-    uint32_t height = imageB->getHeight();
+    uint32_t height = imageA->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.errors = compareImages(*imageA, *imageB, metrics, alpha, errorMap.get());
 
     // Generate heat map.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
-        saveImage(*heatMap, heatMapPath);
+        try
+        {
+            heatMap->saveToFile(heatMapPath);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << "Cannot save image to '" << heatMapPath.string() << "' (Error: " << e.what() << ")." << std::endl;
+        }
     }
 
-    std::cout << error << std::endl;
-
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
-        return false;
+    double error = result.errors.front();
+    result.success = std::isfinite(error) && error <= threshold;
+
+    return result;
+}
 
-    return error <= threshold;
+/// Collect all readable image files in a directory, as paths relative to the directory.
+static std::set<std::filesystem::path> collectImages(const std::filesystem::path& dir)
+{
+    std::set<std::filesystem::path> images;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        FREE_IMAGE_FORMAT fifFormat = FreeImage_GetFIFFromFilename(entry.path().string().c_str());
+        if (fifFormat != FIF_UNKNOWN && FreeImage_FIFSupportsReading(fifFormat))
+            images.insert(std::filesystem::relative(entry.path(), dir));
+    }
+    return images;
+}
+
+/**
+ * Write a JSON report of compared images.
+ * @param[in] path File path.
+ * @param[in] metrics Metrics that were computed.
+ * @param[in] threshold Error threshold of the first metric.
+ * @param[in] results Results indexed by image name.
+ */
+static void writeReport(
+    const std::filesystem::path& path,
+    const std::vector<ErrorMetric>& metrics,
+    float threshold,
+    const std::map<std::string, CompareResult>& results
+)
+{
+    json report;
+    report["metrics"] = json::array();
+    for (const auto& metric : metrics)
+        report["metrics"].push_back(metric.name);
+    report["threshold"] = threshold;
+
+    bool success = true;
+    report["images"] = json::array();
+    for (const auto& [name, result] : results)
+    {
+        json image;
+        image["name"] = name;
+        image["success"] = result.success;
+        json errors = json::object();
+        for (size_t i = 0; i < result.errors.size(); ++i)
+            errors[metrics[i].name] = result.errors[i];
+        image["errors"] = errors;
+        if (!result.message.empty())
+            image["message"] = result.message;
+        report["images"].push_back(image);
+        success = success && result.success;
+    }
+    report["success"] = success;
+
+    std::ofstream file(path);
+    if (!file.good())
+        throw std::runtime_error("Cannot write report to '" + path.string() + "'");
+    file << report.dump(4);
+}
+
+/**
+ * Compare all images in two directories. Images are matched by their relative path.
+ * Heat maps are written to heatMapDir using the relative image path with a ".error.png" suffix.
+ * @return True if all images exist in both directories and all comparisons succeeded.
+ */
+static bool compareDirectories(
+    const std::filesystem::path& dirA,
+    const std::filesystem::path& dirB,
+    const std::vector<ErrorMetric>& metrics,
+    float threshold,
+    bool alpha,
+    const std::filesystem::path& heatMapDir,
+    const std::filesystem::path& reportPath
+)
+{
+    auto imagesA = collectImages(dirA);
+    auto imagesB = collectImages(dirB);
+    std::vector<std::filesystem::path> images(imagesA.begin(), imagesA.end());
+    images.insert(images.end(), imagesB.begin(), imagesB.end());
+    std::sort(images.begin(), images.end());
+    images.erase(std::unique(images.begin(), images.end()), images.end());
+
+    // A few image pairs are compared at a time, each comparison processes its tiles in parallel. Every lane takes the
+    // next pair when it is done with its current one, so at most kMaxPairsInFlight image pairs are loaded at once.
+    std::vector<CompareResult> results(images.size());
+    std::atomic<size_t> nextImage{0};
+    Threading::parallelFor(
+        0, std::min(kMaxPairsInFlight, images.size()),
+        [&](size_t, size_t)
+        {
+            size_t i;
+            while ((i = nextImage.fetch_add(1)) < images.size())
+            {
+                const auto& image = images[i];
+                if (!imagesA.count(image) || !imagesB.count(image))
+                {
+                    results[i].message = "Image is missing in '" + (imagesA.count(image) ? dirB : dirA).string() + "'.";
+                    continue;
+                }
+
+                std::filesystem::path heatMapPath;
+                if (!heatMapDir.empty())
+                {
+                    heatMapPath = heatMapDir / (image.string() + ".error.png");
+                    std::filesystem::create_directories(heatMapPath.parent_path());
+                }
+                results[i] = compareImageFiles(dirA / image, dirB / image, metrics, threshold, alpha, heatMapPath);
+            }
+        },
+        1
+    );
+
+    bool success = true;
+    std::map<std::string, CompareResult> report;
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        const auto& result = results[i];
+        std::cout << images[i].generic_string() << ":";
+        for (size_t j = 0; j < result.errors.size(); ++j)
+            std::cout << " " << metrics[j].name << "=" << result.errors[j];
+        if (!result.message.empty())
+            std::cout << " " << result.message;
+        std::cout << (result.success ? "" : " FAILED") << std::endl;
+
+        success = success && result.success;
+        report[images[i].generic_string()] = result;
+    }
+
+    if (!reportPath.empty())
+        writeReport(reportPath, metrics, threshold, report);
+
+    return success;
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -379,12 +767,18 @@ int main(int argc, char** argv)
     parser.helpParams.programName = "ImageCompare";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::Flag listMetricsFlag(parser, "", "List available error metrics.", {'l'});
-    args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
-    args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
+    args::ValueFlag<std::string> metricFlag(
+        parser, "metric", "The error metric. Multiple metrics can be computed in one pass with a comma separated list.", {'m'}
+    );
+    args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold. Applies to the first metric.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(
+        parser, "filename", "Generate error heat map of the first metric. A directory when comparing directories.", {'e'}
+    );
+    args::ValueFlag<std::string> reportFlag(parser, "filename", "Write a JSON report of the comparison.", {'r', "report"});
+    args::ValueFlag<uint32_t> jobsFlag(parser, "N", "Number of worker threads (default: one per logical core).", {'j', "jobs"});
+    args::Positional<std::string> image1(parser, "image1", "The first image or directory.", args::Options::Required);
+    args::Positional<std::string> image2(parser, "image2", "The second image or directory.", args::Options::Required);
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -420,24 +814,65 @@ int main(int argc, char** argv)
         return 0;
     }
 
-    ErrorMetric metric = errorMetrics.front();
-    if (metricFlag)
+    std::vector<ErrorMetric> metrics;
+    std::string metricNames = metricFlag ? args::get(metricFlag) : errorMetrics.front().name;
+    for (size_t begin = 0; begin <= metricNames.size();)
     {
-        auto name = args::get(metricFlag);
+        size_t end = std::min(metricNames.find(',', begin), metricNames.size());
+        auto name = metricNames.substr(begin, end - begin);
         auto it =
             std::find_if(errorMetrics.begin(), errorMetrics.end(), [&name](const ErrorMetric& metric) { return metric.name == name; });
         if (it == errorMetrics.end())
         {
-            std::cerr << "Unknown error metric '" << args::get(metricFlag) << "'." << std::endl;
+            std::cerr << "Unknown error metric '" << name << "'." << std::endl;
             printMetrics(std::cerr);
             return 1;
         }
-        metric = *it;
+        metrics.push_back(*it);
+        begin = end + 1;
     }
 
-    bool success = compareImages(
-        args::get(image1), args::get(image2), metric, thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false, heatMapFlag ? args::get(heatMapFlag) : ""
-    );
+    const std::filesystem::path path1 = args::get(image1);
+    const std::filesystem::path path2 = args::get(image2);
+    const float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    const bool alpha = alphaFlag ? args::get(alphaFlag) : false;
+    const std::filesystem::path heatMapPath = heatMapFlag ? args::get(heatMapFlag) : "";
+    const std::filesystem::path reportPath = reportFlag ? args::get(reportFlag) : "";
+
+    Threading::start(jobsFlag ? args::get(jobsFlag) : Threading::kDefaultThreadCount);
+
+    bool success = false;
+    try
+    {
+        if (std::filesystem::is_directory(path1) && std::filesystem::is_directory(path2))
+        {
+            success = compareDirectories(path1, path2, metrics, threshold, alpha, heatMapPath, reportPath);
+        }
+        else
+        {
+            CompareResult result = compareImageFiles(path1, path2, metrics, threshold, alpha, heatMapPath);
+            if (!result.message.empty())
+                std::cerr << result.message << std::endl;
+
+            // A single metric prints the bare error for compatibility with existing scripts.
+            for (size_t i = 0; i < result.errors.size(); ++i)
+            {
+                if (metrics.size() > 1)
+                    std::cout << metrics[i].name << " ";
+                std::cout << result.errors[i] << std::endl;
+            }
+
+            if (!reportPath.empty())
+                writeReport(reportPath, metrics, threshold, {{path2.generic_string(), result}});
+            success = result.success;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
+    Threading::shutdown();
+
     return success ? 0 : 1;
 }
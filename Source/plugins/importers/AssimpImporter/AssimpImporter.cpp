@@ -28,6 +28,7 @@
 #include "AssimpImporter.h"
 #include "Core/Assert.h"
 #include "Core/API/Device.h"
+#include "Utils/FileDependencies.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 #include "Utils/NumericRange.h"
@@ -39,6 +40,7 @@
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -62,6 +64,22 @@ const bool kCameraEnableWarping = true;
 using BoneMeshMap = std::map<std::string, std::vector<uint32_t>>;
 using MeshInstanceList = std::vector<std::vector<const aiNode*>>;
 
+/**
+ * Assimp IO system that reports all files opened by Assimp as scene dependencies.
+ * This includes files referenced by the scene file, such as OBJ material libraries or glTF buffers.
+ */
+class DependencyRecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    Assimp::IOStream* Open(const char* pFile, const char* pMode) override
+    {
+        Assimp::IOStream* pStream = DefaultIOSystem::Open(pFile, pMode);
+        if (pStream)
+            FileDependencyRecorder::record(pFile);
+        return pStream;
+    }
+};
+
 /**
  * Converts specular power to roughness. Note there is no "the conversion".
  * Reference: http://simonstechblog.blogspot.com/2011/12/microfacet-brdf.html
@@ -1123,6 +1141,7 @@ void importInternal(const void* buffer, size_t byteSize, const std::filesystem::
         FALCOR_ASSERT(buffer == nullptr && byteSize == 0);
         if (!path.is_absolute())
             throw ImporterError(path, "Expected absolute path.");
+        importer.SetIOHandler(new DependencyRecordingIOSystem()); // Importer takes ownership.
         pScene = importer.ReadFile(path.string().c_str(), assimpFlags);
     }
     else
@@ -36,6 +36,8 @@
 #include "Core/Assert.h"
 #include "Utils/Logger.h"
 
+#include <algorithm>
+
 namespace Falcor::pbrt
 {
 
@@ -57,6 +59,77 @@ std::string to_string(const MaterialRef& materialRef)
 
 BasicScene::BasicScene(const std::filesystem::path& searchPath) : mSearchPath(searchPath) {}
 
+std::unique_ptr<BasicScene> BasicScene::createImportScene() const
+{
+    auto pImportScene = std::make_unique<BasicScene>(mSearchPath);
+    pImportScene->mMaterialIndexBase = mMaterialIndexBase + (uint32_t)mMaterials.size();
+    pImportScene->mAreaLightIndexBase = mAreaLightIndexBase + (uint32_t)mAreaLights.size();
+    return pImportScene;
+}
+
+void BasicScene::mergeImport(BasicScene& importScene)
+{
+    // Indices below the base of the import scene reference entities that existed in this scene when the import
+    // scene was created. Indices above are local to the import scene and are appended to this scene.
+    const uint32_t materialBase = importScene.mMaterialIndexBase;
+    const uint32_t materialOffset = mMaterialIndexBase + (uint32_t)mMaterials.size();
+    const int areaLightBase = (int)importScene.mAreaLightIndexBase;
+    const int areaLightOffset = (int)(mAreaLightIndexBase + mAreaLights.size());
+
+    auto remapShape = [&](ShapeSceneEntity& shape)
+    {
+        if (uint32_t* pIndex = std::get_if<uint32_t>(&shape.materialRef); pIndex && *pIndex >= materialBase)
+            *pIndex = *pIndex - materialBase + materialOffset;
+        if (shape.lightIndex >= areaLightBase)
+            shape.lightIndex = shape.lightIndex - areaLightBase + areaLightOffset;
+    };
+
+    for (auto& [name, material] : importScene.mNamedMaterials)
+    {
+        if (!mNamedMaterials.try_emplace(name, std::move(material)).second)
+            throwError(material.loc, "{}: named material redefined.", name);
+    }
+    std::move(importScene.mMaterials.begin(), importScene.mMaterials.end(), std::back_inserter(mMaterials));
+
+    for (auto& medium : importScene.mMedia)
+    {
+        auto it = std::find_if(mMedia.begin(), mMedia.end(), [&](const MediumSceneEntity& m) { return m.name == medium.name; });
+        if (it != mMedia.end())
+            throwError(medium.loc, "{}: named medium redefined.", medium.name);
+        mMedia.push_back(std::move(medium));
+    }
+
+    for (auto& [name, texture] : importScene.mFloatTextures)
+    {
+        if (!mFloatTextures.try_emplace(name, std::move(texture)).second)
+            throwError(texture.loc, "{}: float texture redefined.", name);
+    }
+    for (auto& [name, texture] : importScene.mSpectrumTextures)
+    {
+        if (!mSpectrumTextures.try_emplace(name, std::move(texture)).second)
+            throwError(texture.loc, "{}: spectrum texture redefined.", name);
+    }
+
+    std::move(importScene.mLights.begin(), importScene.mLights.end(), std::back_inserter(mLights));
+    std::move(importScene.mAreaLights.begin(), importScene.mAreaLights.end(), std::back_inserter(mAreaLights));
+
+    for (auto& shape : importScene.mShapes)
+    {
+        remapShape(shape);
+        mShapes.push_back(std::move(shape));
+    }
+
+    for (auto& [name, instanceDefinition] : importScene.mInstanceDefinitions)
+    {
+        for (auto& shape : instanceDefinition.shapes)
+            remapShape(shape);
+        if (!mInstanceDefinitions.try_emplace(name, std::move(instanceDefinition)).second)
+            throwError(instanceDefinition.loc, "{}: object instance redefined.", name);
+    }
+
+    std::move(importScene.mInstances.begin(), importScene.mInstances.end(), std::back_inserter(mInstances));
+}
+
 void BasicScene::setOptions(
     SceneEntity filter,
     SceneEntity film,
@@ -82,7 +155,7 @@ void BasicScene::addNamedMaterial(std::string name, MaterialSceneEntity material
 uint32_t BasicScene::addMaterial(MaterialSceneEntity material)
 {
     mMaterials.push_back(material);
-    return (uint32_t)(mMaterials.size() - 1);
+    return mMaterialIndexBase + (uint32_t)(mMaterials.size() - 1);
 }
 
 void BasicScene::addMedium(MediumSceneEntity medium)
@@ -108,7 +181,7 @@ void BasicScene::addLight(LightSceneEntity light)
 uint32_t BasicScene::addAreaLight(SceneEntity light)
 {
     mAreaLights.push_back(light);
-    return (uint32_t)(mAreaLights.size() - 1);
+    return mAreaLightIndexBase + (uint32_t)(mAreaLights.size() - 1);
 }
 
 void BasicScene::addShapes(std::vector<ShapeSceneEntity>& shapes)
@@ -214,6 +287,20 @@ std::string BasicScene::toString() const
 
 BasicSceneBuilder::BasicSceneBuilder(BasicScene& scene) : mScene(scene) {}
 
+BasicSceneBuilder::BasicSceneBuilder(const BasicSceneBuilder& parent, std::unique_ptr<BasicScene> pImportScene)
+    : mpImportScene(std::move(pImportScene))
+    , mScene(*mpImportScene)
+    , mCurrentBlock(parent.mCurrentBlock)
+    , mGraphicsState(parent.mGraphicsState)
+    , mNamedCoordinateSystems(parent.mNamedCoordinateSystems)
+    , mUnamedMaterialIndex(parent.mUnamedMaterialIndex)
+    , mNamedMaterialNames(parent.mNamedMaterialNames)
+    , mMediumNames(parent.mMediumNames)
+    , mFloatTextureNames(parent.mFloatTextureNames)
+    , mSpectrumTextureNames(parent.mSpectrumTextureNames)
+    , mInstanceNames(parent.mInstanceNames)
+{}
+
 void BasicSceneBuilder::onReverseOrientation(FileLoc loc)
 {
     VERIFY_WORLD("ReverseOrientation");
@@ -455,6 +542,42 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+std::unique_ptr<ParserTarget> BasicSceneBuilder::createImportTarget(FileLoc loc)
+{
+    VERIFY_WORLD("Import");
+
+    if (mpActiveInstanceDefinition)
+    {
+        throwError(loc, "Import can't be called inside instance definition.");
+    }
+
+    return std::unique_ptr<BasicSceneBuilder>(new BasicSceneBuilder(*this, mScene.createImportScene()));
+}
+
+void BasicSceneBuilder::mergeImportTarget(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc)
+{
+    auto pImportBuilder = dynamic_cast<BasicSceneBuilder*>(pImportTarget.get());
+    FALCOR_ASSERT(pImportBuilder && pImportBuilder->mpImportScene);
+
+    // Graphics state changes in imported files are not visible to the importing file.
+    if (!pImportBuilder->mStack.empty())
+    {
+        throwError(loc, "Missing end to AttributeBegin in imported file.");
+    }
+
+    pImportBuilder->mScene.addShapes(pImportBuilder->mShapes);
+    pImportBuilder->mScene.addInstances(pImportBuilder->mInstances);
+    mScene.mergeImport(*pImportBuilder->mpImportScene);
+
+    auto mergeNames = [](std::set<std::string>& names, const std::set<std::string>& importedNames)
+    { names.insert(importedNames.begin(), importedNames.end()); };
+    mergeNames(mNamedMaterialNames, pImportBuilder->mNamedMaterialNames);
+    mergeNames(mMediumNames, pImportBuilder->mMediumNames);
+    mergeNames(mFloatTextureNames, pImportBuilder->mFloatTextureNames);
+    mergeNames(mSpectrumTextureNames, pImportBuilder->mSpectrumTextureNames);
+    mergeNames(mInstanceNames, pImportBuilder->mInstanceNames);
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
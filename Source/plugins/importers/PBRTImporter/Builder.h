@@ -39,6 +39,7 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <variant>
@@ -226,6 +227,21 @@ class BasicScene
 public:
     BasicScene(const std::filesystem::path& searchPath);
 
+    /**
+     * Create a scene for collecting the entities of an imported file.
+     * Material and area light indices allocated in the import scene continue after the ones
+     * allocated in this scene so far, which keeps references to inherited materials valid.
+     * The import scene is later merged back into this scene using mergeImport().
+     */
+    std::unique_ptr<BasicScene> createImportScene() const;
+
+    /**
+     * Merge the entities of an import scene created with createImportScene() into this scene.
+     * Material and area light indices of the imported shapes are remapped accordingly.
+     * The entities are moved out of the import scene.
+     */
+    void mergeImport(BasicScene& importScene);
+
     void setOptions(
         SceneEntity filter,
         SceneEntity film,
@@ -272,6 +288,9 @@ public:
 private:
     std::filesystem::path mSearchPath;
 
+    uint32_t mMaterialIndexBase = 0;  ///< Index of the first material when used as an import scene.
+    uint32_t mAreaLightIndexBase = 0; ///< Index of the first area light when used as an import scene.
+
     SceneEntity mFilter;
     SceneEntity mFilm;
     CameraSceneEntity mCamera;
@@ -379,9 +398,18 @@ public:
     void onObjectEnd(FileLoc loc) override;
     void onObjectInstance(const std::string& name, FileLoc loc) override;
 
+    std::unique_ptr<ParserTarget> createImportTarget(FileLoc loc) override;
+    void mergeImportTarget(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc) override;
+
     void onEndOfFiles() override;
 
 private:
+    /**
+     * Create a builder for an imported file. The builder inherits the current state of the parent builder
+     * and collects its entities in the given import scene.
+     */
+    BasicSceneBuilder(const BasicSceneBuilder& parent, std::unique_ptr<BasicScene> pImportScene);
+
     float4x4 getTransform() const { return mGraphicsState.ctm[0]; }
 
     static constexpr int kStartTransformBits = 1 << 0;
@@ -420,6 +448,7 @@ private:
         Float transformStartTime = 0, transformEndTime = 1;
     };
 
+    std::unique_ptr<BasicScene> mpImportScene; ///< Scene owned by builders of imported files.
     BasicScene& mScene;
 
     enum class BlockState
@@ -69,10 +69,12 @@
 #include "Core/API/Device.h"
 #include "Utils/Settings.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
 #include "Scene/Importer.h"
+#include "Scene/PLYReader.h"
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
 #include "Scene/Material/RGLMaterial.h"
@@ -107,6 +109,9 @@ const float4x4 kInvertZ = {
     0.f, 0.f, 0.f,  1.f, //
 };
 
+/// Number of shapes handed to the scene builder at once.
+const size_t kMeshBatchSize = 1024;
+
 /**
  * Holds the results from creating a camera.
  */
@@ -223,6 +228,13 @@ struct BuilderContext
 
     std::map<std::string, InstanceDefinition> instanceDefinitions;
 
+    struct PLYMesh
+    {
+        Falcor::ref<Falcor::TriangleMesh> pTriangleMesh;
+        size_t useCount = 0;
+    };
+    std::map<std::filesystem::path, PLYMesh> plyMeshes; ///< PLY meshes of the current batch of shapes, keyed by resolved path.
+
     size_t curveCount = 0;
 
     bool usePBRTMaterials = false;
@@ -1571,7 +1583,22 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         auto filename = params.getString("filename", "");
         auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        // Use the mesh loaded for the current batch. Shapes referencing the same file get their own copy, as the mesh is modified below.
+        if (auto it = ctx.plyMeshes.find(path); it != ctx.plyMeshes.end())
+        {
+            auto& plyMesh = it->second;
+            FALCOR_ASSERT(plyMesh.useCount > 0);
+            if (!plyMesh.pTriangleMesh)
+                shape.pTriangleMesh = nullptr;
+            else if (--plyMesh.useCount == 0)
+                shape.pTriangleMesh = std::move(plyMesh.pTriangleMesh);
+            else
+                shape.pTriangleMesh = Falcor::TriangleMesh::create(plyMesh.pTriangleMesh->getVertices(), plyMesh.pTriangleMesh->getIndices());
+        }
+        else
+        {
+            shape.pTriangleMesh = Falcor::PLYReader::createTriangleMesh(path);
+        }
         if (shape.pTriangleMesh)
             shape.pTriangleMesh->setName(filename);
         shape.transform = entity.transform;
@@ -1719,9 +1746,14 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
 {
     InstanceDefinition instanceDefinition;
 
-    for (const auto& shapeEntity : entity.shapes)
+    for (size_t i = 0; i < entity.shapes.size(); ++i)
     {
+        // Load the PLY files of the next batch of shapes.
+        if (i % kMeshBatchSize == 0)
+            loadPLYMeshes(ctx, entity.shapes.data() + i, std::min(kMeshBatchSize, entity.shapes.size() - i));
+
         // Process shapes and create meshes.
+        const auto& shapeEntity = entity.shapes[i];
         auto shape = createShape(ctx, shapeEntity);
         if (shape.pTriangleMesh)
         {
@@ -1748,10 +1780,40 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
         }
         ctx.curveAggregates.clear();
     }
+    ctx.plyMeshes.clear();
 
     return instanceDefinition;
 }
 
+/** Load the PLY files referenced by a range of shapes in parallel, one file per task.
+    The meshes are consumed by createShape(). Loading is done per batch of shapes, so only the PLY meshes of one batch are
+    kept in memory at a time.
+*/
+void loadPLYMeshes(BuilderContext& ctx, const ShapeSceneEntity* pShapes, size_t shapeCount)
+{
+    ctx.plyMeshes.clear();
+    for (size_t i = 0; i < shapeCount; ++i)
+    {
+        if (pShapes[i].name == "plymesh")
+            ctx.plyMeshes[ctx.resolver(pShapes[i].params.getString("filename", ""))].useCount++;
+    }
+
+    std::vector<std::pair<const std::filesystem::path, BuilderContext::PLYMesh>*> plyMeshes;
+    for (auto& it : ctx.plyMeshes)
+        plyMeshes.push_back(&it);
+
+    Threading::parallelFor(
+        0,
+        plyMeshes.size(),
+        [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i)
+                plyMeshes[i]->second.pTriangleMesh = Falcor::PLYReader::createTriangleMesh(plyMeshes[i]->first);
+        },
+        1
+    );
+}
+
 void buildScene(BuilderContext& ctx)
 {
     // Load float textures.
@@ -1804,16 +1866,37 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
-    for (const auto& entity : ctx.scene.getShapes())
+    // The meshes are added in batches so that the scene builder can pre-process them in parallel.
+    std::vector<NodeID> batchNodeIDs;
+    std::vector<std::pair<ref<TriangleMesh>, ref<Material>>> batchMeshes;
+    auto addBatchMeshes = [&]()
+    {
+        auto meshIDs = ctx.builder.addTriangleMeshes(batchMeshes);
+        for (size_t i = 0; i < meshIDs.size(); ++i)
+            ctx.builder.addMeshInstance(batchNodeIDs[i], meshIDs[i]);
+        batchNodeIDs.clear();
+        batchMeshes.clear();
+    };
+
+    const auto& shapes = ctx.scene.getShapes();
+    for (size_t first = 0; first < shapes.size(); first += kMeshBatchSize)
     {
-        auto shape = createShape(ctx, entity);
-        if (shape.pTriangleMesh)
+        const size_t last = std::min(first + kMeshBatchSize, shapes.size());
+        loadPLYMeshes(ctx, shapes.data() + first, last - first);
+
+        for (size_t i = first; i < last; ++i)
         {
-            auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            ctx.builder.addMeshInstance(nodeID, meshID);
+            const auto& entity = shapes[i];
+            auto shape = createShape(ctx, entity);
+            if (shape.pTriangleMesh)
+            {
+                batchNodeIDs.push_back(ctx.builder.addNode({entity.name, shape.transform}));
+                batchMeshes.emplace_back(shape.pTriangleMesh, shape.pMaterial);
+            }
         }
+        addBatchMeshes();
     }
+    ctx.plyMeshes.clear();
 
     // Create curves from curve aggregates assembled during the processing step above.
     for (const auto& [_, curveAggregate] : ctx.curveAggregates)
@@ -1882,7 +1965,8 @@ void PBRTImporter::importScene(const std::filesystem::path& path, SceneBuilder&
         TimeReport timeReport;
         pbrt::BasicScene pbrtScene(path.parent_path());
         pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
-        pbrt::parseFile(pbrtBuilder, path);
+        bool parallelImport = builder.getSettings().getOption("PBRTImporter:parallelImport", true);
+        pbrt::parseFile(pbrtBuilder, path, parallelImport);
         timeReport.measure("Parsing pbrt scene");
 
         pbrt::BuilderContext ctx{pbrtScene, builder};
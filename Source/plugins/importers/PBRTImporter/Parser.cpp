@@ -35,11 +35,14 @@
 #include "Helpers.h"
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
+#include "Utils/FileDependencies.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
 #include <fast_float/fast_float.h>
 
 #include <atomic>
+#include <mutex>
 #include <utility>
 #include <charconv>
 
@@ -88,16 +91,22 @@ static char decodeEscaped(int ch, const FileLoc& loc)
 
 std::unique_ptr<Tokenizer> Tokenizer::createFromFile(const std::filesystem::path& path)
 {
+    FileDependencyRecorder::record(path);
+
     if (hasExtension(path, "gz"))
     {
         std::string str = decompressFile(path);
         return std::make_unique<Tokenizer>(std::move(str), path);
     }
-    else
-    {
-        std::string str = readFile(path);
-        return std::make_unique<Tokenizer>(std::move(str), path);
-    }
+
+    // Tokenize directly from the memory mapped file. Fall back to reading the file
+    // if mapping fails (e.g. empty files can't be mapped), which also reports missing files.
+    auto pFile = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (pFile->isOpen())
+        return std::make_unique<Tokenizer>(std::move(pFile), path);
+
+    std::string str = readFile(path);
+    return std::make_unique<Tokenizer>(std::move(str), path);
 }
 
 std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
@@ -107,13 +116,32 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
 
 Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath(path), mContents(std::move(str))
 {
-    auto pFilename = std::make_unique<std::string>(path.string());
-    mLoc = FileLoc(*pFilename);
-    getFilenames().push_back(std::move(pFilename));
+    init(mContents.data(), mContents.size());
+}
 
-    mPos = mContents.data();
-    mEnd = mPos + mContents.size();
-    if (isUTF16(mContents.data(), mContents.size()))
+Tokenizer::Tokenizer(std::unique_ptr<MemoryMappedFile> pFile, const std::filesystem::path& path) : mPath(path), mpFile(std::move(pFile))
+{
+    FALCOR_ASSERT(mpFile && mpFile->isOpen());
+    init(static_cast<const char*>(mpFile->getData()), mpFile->getMappedSize());
+}
+
+std::string_view Tokenizer::registerFilename(std::string filename)
+{
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<std::string>> filenames;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    filenames.push_back(std::make_unique<std::string>(std::move(filename)));
+    return *filenames.back();
+}
+
+void Tokenizer::init(const char* pData, size_t size)
+{
+    mLoc = FileLoc(registerFilename(mPath.string()));
+
+    mPos = pData;
+    mEnd = pData + size;
+    if (isUTF16(pData, size))
         throwError("File is encoded with UTF-16, which is not currently supported.");
 }
 
@@ -448,14 +476,67 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
     return parameterVector;
 }
 
-void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+/**
+ * Imported file that is parsed concurrently.
+ */
+struct PendingImport
+{
+    std::unique_ptr<ParserTarget> pTarget;
+    Threading::Task task;
+    FileLoc loc;
+};
+
+void parseTokens(
+    ParserTarget& target,
+    std::unique_ptr<Tokenizer> tokenizer,
+    const std::filesystem::path& searchPath,
+    bool parallelImport,
+    std::vector<PendingImport>& imports
+);
+
+void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, const std::filesystem::path& searchPath, bool parallelImport)
+{
+    std::vector<PendingImport> imports;
+
+    try
+    {
+        parseTokens(target, std::move(tokenizer), searchPath, parallelImport, imports);
+    }
+    catch (...)
+    {
+        // Wait for all imports as they reference the import targets.
+        for (auto& import : imports)
+        {
+            try
+            {
+                import.task.finish();
+            }
+            catch (...)
+            {}
+        }
+        throw;
+    }
+
+    // Merge imports in the order in which they appear in the file.
+    for (auto& import : imports)
+    {
+        import.task.finish();
+        target.mergeImportTarget(std::move(import.pTarget), import.loc);
+    }
+}
+
+void parseTokens(
+    ParserTarget& target,
+    std::unique_ptr<Tokenizer> tokenizer,
+    const std::filesystem::path& searchPath,
+    bool parallelImport,
+    std::vector<PendingImport>& imports
+)
 {
     static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
 
     logInfo("PBRTImporter: Started parsing '{}'.", tokenizer->getPath().string());
 
-    auto searchPath = tokenizer->getPath().parent_path();
-
     std::vector<std::unique_ptr<Tokenizer>> fileStack;
     fileStack.push_back(std::move(tokenizer));
 
@@ -639,7 +720,21 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             }
             else if (tok->token == "Import")
             {
-                throwError(tok->loc, "'Import' directive not supported yet.");
+                Token filenameToken = *nextToken(TokenRequired);
+                std::string filename = toString(dequoteString(filenameToken));
+                auto path = searchPath / filename;
+
+                // Imported files are parsed into a separate target on the thread pool and merged when parsing of this file completes.
+                // Without parallel import they are parsed in place, which yields the same result.
+                PendingImport import{target.createImportTarget(tok->loc), {}, tok->loc};
+                ParserTarget* pImportTarget = import.pTarget.get();
+                auto parseImport = [pImportTarget, path, searchPath, parallelImport]()
+                { parse(*pImportTarget, Tokenizer::createFromFile(path), searchPath, parallelImport); };
+                if (parallelImport)
+                    import.task = Threading::dispatchTask(std::move(parseImport));
+                else
+                    parseImport();
+                imports.push_back(std::move(import));
             }
             else if (tok->token == "Identity")
             {
@@ -876,17 +971,19 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
     }
 }
 
-void parseFile(ParserTarget& target, const std::filesystem::path& path)
+void parseFile(ParserTarget& target, const std::filesystem::path& path, bool parallelImport)
 {
     auto tokenizer = Tokenizer::createFromFile(path);
-    parse(target, std::move(tokenizer));
+    auto searchPath = tokenizer->getPath().parent_path();
+    parse(target, std::move(tokenizer), searchPath, parallelImport);
     target.onEndOfFiles();
 }
 
-void parseString(ParserTarget& target, std::string str)
+void parseString(ParserTarget& target, std::string str, bool parallelImport)
 {
     auto tokenizer = Tokenizer::createFromString(std::move(str));
-    parse(target, std::move(tokenizer));
+    auto searchPath = tokenizer->getPath().parent_path();
+    parse(target, std::move(tokenizer), searchPath, parallelImport);
     target.onEndOfFiles();
 }
 
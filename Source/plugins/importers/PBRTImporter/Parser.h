@@ -35,6 +35,7 @@
 
 #include "Types.h"
 #include "Parameters.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include <functional>
 #include <filesystem>
 #include <memory>
@@ -98,11 +99,24 @@ public:
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
 
+    /**
+     * Create a target for parsing a file referenced by an 'Import' directive.
+     * Imported files are parsed concurrently on the thread pool, unless parallel import is disabled. The returned target starts
+     * with a copy of the current graphics state and must not modify this target.
+     */
+    virtual std::unique_ptr<ParserTarget> createImportTarget(FileLoc loc) = 0;
+
+    /**
+     * Merge the results of parsing an imported file into this target.
+     * Imports are merged in the order in which they appear in the file.
+     */
+    virtual void mergeImportTarget(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc) = 0;
+
     virtual void onEndOfFiles() = 0;
 };
 
-void parseFile(ParserTarget& target, const std::filesystem::path& path);
-void parseString(ParserTarget& target, std::string str);
+void parseFile(ParserTarget& target, const std::filesystem::path& path, bool parallelImport = true);
+void parseString(ParserTarget& target, std::string str, bool parallelImport = true);
 
 struct Token
 {
@@ -116,8 +130,12 @@ struct Token
 class Tokenizer
 {
 public:
+    /// Create a tokenizer reading from a string.
     Tokenizer(std::string str, const std::filesystem::path& path);
 
+    /// Create a tokenizer reading directly from a memory mapped file.
+    Tokenizer(std::unique_ptr<MemoryMappedFile> pFile, const std::filesystem::path& path);
+
     static std::unique_ptr<Tokenizer> createFromFile(const std::filesystem::path& path);
     static std::unique_ptr<Tokenizer> createFromString(std::string str);
 
@@ -131,14 +149,12 @@ public:
 
 private:
     /**
-     * Static list of filenames to allow file locations (FileLoc::filename) to be valid
-     * even after the tokenizer is destroyed.
+     * Register a filename in a static list to allow file locations (FileLoc::filename) to be valid
+     * even after the tokenizer is destroyed. This is thread-safe as files may be tokenized concurrently.
      */
-    static std::vector<std::unique_ptr<std::string>>& getFilenames()
-    {
-        static std::vector<std::unique_ptr<std::string>> filenames;
-        return filenames;
-    }
+    static std::string_view registerFilename(std::string filename);
+
+    void init(const char* pData, size_t size);
 
     bool isUTF16(const void* ptr, size_t len) const;
 
@@ -172,7 +188,8 @@ private:
 
     std::filesystem::path mPath; ///< File path we're reading from.
     FileLoc mLoc;                ///< File location.
-    std::string mContents;       ///< File contents we're parsing.
+    std::string mContents;       ///< File contents we're parsing (if not memory mapped).
+    std::unique_ptr<MemoryMappedFile> mpFile; ///< Memory mapped file we're parsing (if not read into mContents).
 
     const char* mPos; ///< Current position in the file.
     const char* mEnd; ///< End of the file (one past).
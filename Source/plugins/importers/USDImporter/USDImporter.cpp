@@ -29,6 +29,7 @@
 #include "USDHelpers.h"
 #include "ImporterContext.h"
 #include "Core/Platform/OS.h"
+#include "Utils/FileDependencies.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Settings.h"
 #include "Scene/Importer.h"
@@ -332,6 +333,13 @@ namespace Falcor
 
         timeReport.measure("Open stage");
 
+        // Sublayers, references and payloads are read by USD directly, report them as scene dependencies.
+        for (const auto& pLayer : pStage->GetUsedLayers())
+        {
+            const std::string& realPath = pLayer->GetRealPath();
+            if (!realPath.empty()) FileDependencyRecorder::record(realPath);
+        }
+
         Falcor::addDataDirectory(path.parent_path());
         ImporterContext ctx(path, pStage, builder, dict, timeReport);
 